@@ -1,18 +1,61 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Mar  4 21:17:35 PST 2018
-// Last Modified: Sun Mar  4 21:17:38 PST 2018
+// Last Modified: Sun Oct 18 20:47:18 PDT 2026
 // Filename:      cli/binroll.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/cli/binroll.cpp
 // Syntax:        C++11
 // vim:           ts=3 noexpandtab nowrap
 //
 // Description:   Extract a binary pinao roll of note in a score.
+//                With the -s option, the roll is written to standard
+//                output while the input is being processed rather than
+//                being stored until all input files have been read.
 //
 
 #include "humlib.h"
 
-STREAM_INTERFACE(Tool_binroll)
+using namespace hum;
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+	Tool_binroll interface;
+	if (!interface.process(argc, argv)) {
+		interface.getError(cerr);
+		return -1;
+	}
+
+	HumFdSink sink(1);
+	if (interface.getBoolean("stream")) {
+		interface.setFreeTextSink(&sink);
+	}
+
+	HumdrumFileStream instream(static_cast<Options&>(interface));
+	HumdrumFileSet infiles;
+	bool status = true;
+	while (instream.readSingleSegment(infiles)) {
+		status &= interface.run(infiles);
+		if (interface.hasError()) {
+			break;
+		}
+	}
+	interface.clearOutputSinks();
+
+	if (interface.hasWarning()) {
+		interface.getWarning(cerr);
+	}
+	if (interface.hasAnyText()) {
+	   interface.getAllText(cout);
+	}
+	if (interface.hasError()) {
+		interface.getError(cerr);
+		return -1;
+	}
+	interface.clearOutput();
+	return !status;
+}
 
 
 
@@ -1,18 +1,62 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Dec 24 15:39:34 PST 2016
-// Last Modified: Sat Dec 24 15:39:38 PST 2016
+// Last Modified: Sun Oct 18 11:40:05 PDT 2026
 // Filename:      cli/dissonant.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/cli/dissonant.cpp
 // Syntax:        C++11
 // vim:           ts=3 noexpandtab nowrap
 //
-// Description:   Add beams to Humdrum file(s).
+// Description:   Identify and label dissonances in Humdrum file(s).  The
+//                --statistics option reads all input files before
+//                analyzing them in parallel.
 //
 
 #include "humlib.h"
 
-STREAM_INTERFACE(Tool_dissonant)
+#include <iostream>
 
+using namespace std;
+using namespace hum;
 
+int main(int argc, char** argv) {
+	Tool_dissonant interface;
+	if (!interface.process(argc, argv)) {
+		interface.getError(cerr);
+		return -1;
+	}
 
+	HumdrumFileStream instream(static_cast<Options&>(interface));
+	HumdrumFileSet infiles;
+	bool status = true;
+	bool statisticsQ = interface.getBoolean("statistics");
+	bool reading;
+	if (statisticsQ) {
+		// analyze all input files together so they can be processed in parallel:
+		instream.read(infiles);
+		reading = true;
+	} else {
+		reading = instream.readSingleSegment(infiles);
+	}
+	while (reading) {
+		status &= interface.run(infiles);
+		if (interface.hasWarning()) {
+			interface.getWarning(cerr);
+		}
+		if (interface.hasError()) {
+			interface.getError(cerr);
+			return -1;
+		}
+		if (interface.hasAnyText()) {
+			interface.getAllText(cout);
+		} else {
+			for (int i=0; i<infiles.getCount(); i++) {
+				cout << infiles[i];
+			}
+		}
+		interface.clearOutput();
+		reading = statisticsQ ? false : instream.readSingleSegment(infiles);
+	}
+	interface.finally();
+	return !status;
+}
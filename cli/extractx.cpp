@@ -1,18 +1,80 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Dec  5 23:07:22 PST 2016
-// Last Modified: Mon Dec  5 23:07:25 PST 2016
+// Last Modified: Sun Oct 18 10:12:44 PDT 2026
 // Filename:      cli/extractx.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/cli/extractx.cpp
 // Syntax:        C++11
 // vim:           ts=3 noexpandtab nowrap
 //
-// Description:   Extract spines from multispine data.
+// Description:   Extract spines from multispine data.  The --stream option
+//                processes the input line-by-line without storing it
+//                in memory.
 //
 
 #include "humlib.h"
 
-STREAM_INTERFACE(Tool_extract)
+#include <fstream>
+#include <iostream>
 
+using namespace std;
+using namespace hum;
 
+int main(int argc, char** argv) {
+	Tool_extract interface;
+	if (!interface.process(argc, argv)) {
+		interface.getError(cerr);
+		return -1;
+	}
 
+	bool status = true;
+	if (interface.getBoolean("stream")) {
+		if (interface.getArgCount() == 0) {
+			status = interface.run(cin, cout);
+		}
+		for (int i=1; i<=interface.getArgCount(); i++) {
+			ifstream input(interface.getArgument(i));
+			if (!input.is_open()) {
+				cerr << "Cannot read file " << interface.getArgument(i) << endl;
+				return -1;
+			}
+			status &= interface.run(input, cout);
+			if (interface.hasError()) {
+				break;
+			}
+		}
+		interface.finally();
+		if (interface.hasWarning()) {
+			interface.getWarning(cerr);
+		}
+		if (interface.hasError()) {
+			interface.getError(cerr);
+			return -1;
+		}
+		return !status;
+	}
+
+	HumdrumFileStream instream(static_cast<Options&>(interface));
+	HumdrumFileSet infiles;
+	while (instream.readSingleSegment(infiles)) {
+		status &= interface.run(infiles);
+	}
+	interface.finally();
+	if (interface.hasWarning()) {
+		interface.getWarning(cerr);
+	}
+	if (interface.hasAnyText()) {
+		interface.getAllText(cout);
+	}
+	if (interface.hasError()) {
+		interface.getError(cerr);
+		return -1;
+	}
+	if (!interface.hasAnyText()) {
+		for (int i=0; i<infiles.getCount(); i++) {
+			cout << infiles[i];
+		}
+	}
+	interface.clearOutput();
+	return !status;
+}
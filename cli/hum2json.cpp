@@ -0,0 +1,85 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 21:48:20 PDT 2026
+// Last Modified: Sun Oct 18 21:48:24 PDT 2026
+// Filename:      cli/hum2json.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/cli/hum2json.cpp
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab nowrap
+//
+// Description:   Write the token graph and analyses of a Humdrum file in
+//                JSON or CBOR format (see HumJsonWriter.h for the
+//                structure of the output).
+//
+// Usage:         hum2json file.krn
+//                hum2json -s links,rhythm,slurs,ties file.krn
+//                hum2json -c -o file.cbor file.krn
+//
+// Options:       -c        :: write CBOR rather than JSON.
+//                -o file   :: write to a file (to stdout if not given).
+//                -s list   :: comma-separated list of sections to write
+//                             (default: all).
+//                --sections:: list the names of the sections.
+//
+
+#include "humlib.h"
+
+#include <fstream>
+#include <iostream>
+
+using namespace hum;
+using namespace std;
+
+int main(int argc, char** argv) {
+	Options options;
+	options.define("c|cbor=b",     "write CBOR rather than JSON");
+	options.define("o|output=s",   "output file");
+	options.define("s|select=s",   "sections to write");
+	options.define("sections=b",   "list section names");
+	options.process(argc, argv);
+
+	if (options.getBoolean("sections")) {
+		cout << HumJsonWriter::getSectionNames() << endl;
+		return 0;
+	}
+
+	HumJsonWriter writer;
+	if (options.getBoolean("cbor")) {
+		writer.setFormat(HumJsonWriter::FORMAT_CBOR);
+	}
+	if (options.getBoolean("select") && !writer.setSections(options.getString("select"))) {
+		cerr << "Error: unknown section in " << options.getString("select") << endl;
+		cerr << "Sections: " << HumJsonWriter::getSectionNames() << endl;
+		return 1;
+	}
+
+	HumdrumFile infile;
+	bool status;
+	if (options.getArgCount() == 0) {
+		status = infile.read(cin);
+	} else {
+		status = infile.read(options.getArg(1));
+	}
+	if (!status) {
+		return 1;
+	}
+
+	if (options.getBoolean("output")) {
+		ofstream output(options.getString("output"), ios::binary);
+		if (!output.is_open() || !writer.write(output, infile)) {
+			cerr << "Error: cannot write " << options.getString("output") << endl;
+			return 1;
+		}
+	} else {
+		HumFdSink sink(1);
+		ostream output(&sink);
+		if (!writer.write(output, infile)) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+
+
@@ -0,0 +1,304 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 20:21:50 PDT 2026
+// Last Modified: Sun Oct 18 20:21:55 PDT 2026
+// Filename:      cli/humfeatures.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/cli/humfeatures.cpp
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab nowrap
+//
+// Description:   Extract note features from a corpus of Humdrum files into
+//                columnar feature tables (see HumFeatureTable.h for the file
+//                format).  Files are processed on several threads, and the
+//                rows are stored in the order of the input files.
+//
+// Usage:         humfeatures -o corpus.hft *.krn
+//                humfeatures -j 16 -s 10000 -o corpus.hft -l filelist.txt
+//                humfeatures -f onset,duration,midi,metlev file.krn
+//                humfeatures --read corpus.hft
+//                humfeatures --features
+//
+// Options:       -o file   :: write binary feature table (TSV to stdout if
+//                             not given).
+//                -s count  :: files per output table; tables are named
+//                             file-00000.hft, file-00001.hft, ...
+//                -j count  :: number of threads (default: number of cores).
+//                -l file   :: file containing input filenames, one per line.
+//                -f list   :: comma-separated list of features to extract.
+//                --read    :: print binary feature tables as TSV.
+//                --features:: list the names of the features.
+//
+
+#include "humlib.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+using namespace hum;
+using namespace std;
+
+bool   extractShard        (HumFeatureTable& output, vector<string>& filenames,
+                            int start, int end, HumFeatureExtractor& extractor,
+                            int threads);
+bool   writeTable          (HumFeatureTable& table, const string& filename);
+bool   printMappedTable    (const string& filename);
+string getShardName        (const string& filename, int shard);
+
+
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+	Options options;
+	options.define("o|output=s",      "output binary feature table");
+	options.define("s|shard=i:0",     "number of files in each output table");
+	options.define("j|threads=i:0",   "number of threads to use");
+	options.define("l|list=s",        "file containing list of input files");
+	options.define("f|feature=s",     "comma-separated list of features to extract");
+	options.define("r|read=b",        "print binary feature tables as TSV");
+	options.define("features=b",      "list feature names");
+	options.process(argc, argv);
+
+	if (options.getBoolean("features")) {
+		HumFeatureExtractor::printFeatureList(cout);
+		return 0;
+	}
+
+	vector<string> filenames;
+	for (int i=1; i<=options.getArgCount(); i++) {
+		filenames.push_back(options.getArg(i));
+	}
+	if (options.getBoolean("list")) {
+		ifstream list(options.getString("list"));
+		if (!list.is_open()) {
+			cerr << "Error: cannot read " << options.getString("list") << endl;
+			return 1;
+		}
+		string line;
+		while (getline(list, line)) {
+			if (!line.empty()) {
+				filenames.push_back(line);
+			}
+		}
+	}
+
+	if (options.getBoolean("read")) {
+		bool status = true;
+		for (int i=0; i<(int)filenames.size(); i++) {
+			status &= printMappedTable(filenames[i]);
+		}
+		return status ? 0 : 1;
+	}
+
+	HumFeatureExtractor extractor;
+	if (!extractor.setFeatures(options.getString("feature"))) {
+		cerr << "Error: unknown feature in list: " << options.getString("feature") << endl;
+		cerr << "Use --features to list the feature names" << endl;
+		return 1;
+	}
+
+	int threads = options.getInteger("threads");
+	if (threads <= 0) {
+		threads = max(1, (int)thread::hardware_concurrency());
+	}
+	int shardsize = options.getInteger("shard");
+	if ((shardsize <= 0) || !options.getBoolean("output")) {
+		shardsize = max(1, (int)filenames.size());
+	}
+
+	bool status = true;
+	int shard = 0;
+	for (int start=0; start<(int)filenames.size(); start+=shardsize) {
+		int end = min((int)filenames.size(), start + shardsize);
+		HumFeatureTable table;
+		status &= extractShard(table, filenames, start, end, extractor, threads);
+		if (!options.getBoolean("output")) {
+			table.printTsv(cout);
+		} else {
+			string name = options.getString("output");
+			if (options.getInteger("shard") > 0) {
+				name = getShardName(name, shard);
+			}
+			status &= writeTable(table, name);
+		}
+		shard++;
+	}
+
+	return status ? 0 : 1;
+}
+
+
+
+//////////////////////////////
+//
+// extractShard -- Extract the features of a range of files on several
+//     threads.  Each file is extracted into its own table, and the tables
+//     are then appended in the order of the files.
+//
+
+bool extractShard(HumFeatureTable& output, vector<string>& filenames, int start,
+		int end, HumFeatureExtractor& extractor, int threads) {
+	vector<HumFeatureTable> tables(end - start);
+	vector<char> failed(end - start, 0);
+	atomic<int> next(start);
+
+	auto worker = [&]() {
+		HumdrumFile infile;
+		int index;
+		while ((index = next++) < end) {
+			if (!infile.read(filenames[index])) {
+				failed[index - start] = 1;
+				continue;
+			}
+			extractor.extract(infile, tables[index - start], filenames[index]);
+		}
+	};
+
+	vector<thread> pool;
+	for (int i=0; i<min(threads, end - start); i++) {
+		pool.emplace_back(worker);
+	}
+	for (int i=0; i<(int)pool.size(); i++) {
+		pool[i].join();
+	}
+
+	bool status = true;
+	output.clear();
+	extractor.prepareTable(output);
+	for (int i=0; i<(int)tables.size(); i++) {
+		if (failed[i]) {
+			cerr << "Error: cannot read " << filenames[start + i] << endl;
+			status = false;
+			continue;
+		}
+		output.append(tables[i]);
+		tables[i] = HumFeatureTable();
+	}
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// writeTable --
+//
+
+bool writeTable(HumFeatureTable& table, const string& filename) {
+	if (!table.writeFile(filename)) {
+		cerr << "Error: cannot write " << filename << endl;
+		return false;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// getShardName -- Insert the shard number before the extension of the
+//     output filename.
+//
+
+string getShardName(const string& filename, int shard) {
+	char number[32];
+	snprintf(number, sizeof(number), "-%05d", shard);
+	size_t dot = filename.rfind('.');
+	size_t slash = filename.rfind('/');
+	if ((dot == string::npos) || ((slash != string::npos) && (dot < slash))) {
+		return filename + number;
+	}
+	return filename.substr(0, dot) + number + filename.substr(dot);
+}
+
+
+
+//////////////////////////////
+//
+// printMappedTable -- Print a binary feature table as TSV, reading the
+//     columns in place from a memory-mapped file.
+//
+
+bool printMappedTable(const string& filename) {
+#ifdef _WIN32
+	HumFeatureTable table;
+	if (!table.readFile(filename)) {
+		cerr << "Error: cannot read feature table " << filename << endl;
+		return false;
+	}
+	table.printTsv(cout);
+	return true;
+#else
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		cerr << "Error: cannot open " << filename << endl;
+		return false;
+	}
+	struct stat info;
+	if ((fstat(fd, &info) != 0) || (info.st_size == 0)) {
+		close(fd);
+		cerr << "Error: cannot read feature table " << filename << endl;
+		return false;
+	}
+	size_t size = (size_t)info.st_size;
+	void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		cerr << "Error: cannot map " << filename << endl;
+		return false;
+	}
+
+	HumFeatureView view;
+	bool status = view.open((const char*)data, size);
+	if (!status) {
+		cerr << "Error: " << filename << " is not a feature table" << endl;
+	} else {
+		int columns = view.getColumnCount();
+		for (int i=0; i<columns; i++) {
+			cout << (i ? "\t" : "") << view.getColumnName(i);
+		}
+		cout << '\n';
+		cout.precision(15);
+		for (int64_t r=0; r<view.getRowCount(); r++) {
+			for (int i=0; i<columns; i++) {
+				if (i > 0) {
+					cout << '\t';
+				}
+				switch (view.getColumnType(i)) {
+					case HumFeatureTable::TYPE_FLOAT64:
+						if (!std::isnan(view.getFloatColumn(i)[r])) {
+							cout << view.getFloatColumn(i)[r];
+						}
+						break;
+					case HumFeatureTable::TYPE_STRING:
+						cout << view.getString(r, i);
+						break;
+					default:
+						if (view.getIntColumn(i)[r] != HumFeatureTable::MISSING_INT) {
+							cout << view.getIntColumn(i)[r];
+						}
+				}
+			}
+			cout << '\n';
+		}
+	}
+	munmap(data, size);
+	return status;
+#endif
+}
+
+
+
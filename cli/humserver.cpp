@@ -0,0 +1,223 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 17:31:08 PDT 2026
+// Last Modified: Sun Oct 18 23:59:31 PDT 2026
+// Filename:      cli/humserver.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/cli/humserver.cpp
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab nowrap
+//
+// Description:   Run Humdrum tools as a long-running service.  Requests
+//                are read from standard input (or from connections to a
+//                local socket with the -s option), and responses are
+//                written to standard output (or back to the socket).
+//                See HumToolServer.h for the request format.
+//
+// Example:       (printf 'tool: transpose\noptions: -k e-\nlength: %d\n\n'
+//                   $(wc -c < file.krn); cat file.krn) | humserver
+//
+
+#include "humlib.h"
+
+#include <iostream>
+#include <thread>
+
+#ifndef _WIN32
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <unistd.h>
+	#include <cerrno>
+	#include <csignal>
+	#include <cstring>
+#endif
+
+using namespace std;
+using namespace hum;
+
+int  serveStdio   (HumToolServer& server);
+int  serveSocket  (HumToolServer& server, const string& path);
+
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+	Options options;
+	options.define("s|socket=s", "listen for connections on the given local socket");
+	options.define("t|threads=i:0", "number of worker threads (0 = number of cores)");
+	options.define("q|queue=i:0", "number of requests which can wait for a worker (0 = 4 per thread)");
+	options.define("l|list=b", "list the tools which can be run");
+	options.process(argc, argv);
+
+	if (options.getBoolean("list")) {
+		for (const string& name : HumToolServer::getToolNames()) {
+			cout << name << endl;
+		}
+		return 0;
+	}
+
+	HumToolServer server(options.getInteger("threads"));
+	server.setQueueSize(options.getInteger("queue"));
+	if (options.getBoolean("socket")) {
+		return serveSocket(server, options.getString("socket"));
+	}
+	return serveStdio(server);
+}
+
+///////////////////////////////////////////////////////////////////////////
+
+
+
+//////////////////////////////
+//
+// serveStdio -- Read requests from standard input and write responses
+//     to standard output.  Some tools print messages directly to cout,
+//     so cout is redirected to cerr to keep the responses readable.
+//
+
+int serveStdio(HumToolServer& server) {
+	ios_base::sync_with_stdio(false);
+	ostream output(cout.rdbuf());
+	cout.rdbuf(cerr.rdbuf());
+	bool status = server.serve(cin, output);
+	output.flush();
+	return status ? 0 : 1;
+}
+
+
+
+#ifndef _WIN32
+
+//////////////////////////////
+//
+// FdStreamBuf -- Stream buffer for reading from and writing to a
+//     socket connection.
+//
+
+class FdStreamBuf : public streambuf {
+	public:
+		FdStreamBuf(int fd) : m_fd(fd) {
+			setg(m_inbuf, m_inbuf, m_inbuf);
+			setp(m_outbuf, m_outbuf + sizeof(m_outbuf));
+		}
+
+		~FdStreamBuf() {
+			sync();
+		}
+
+	protected:
+		int underflow(void) {
+			ssize_t count = ::read(m_fd, m_inbuf, sizeof(m_inbuf));
+			if (count <= 0) {
+				return traits_type::eof();
+			}
+			setg(m_inbuf, m_inbuf, m_inbuf + count);
+			return traits_type::to_int_type(m_inbuf[0]);
+		}
+
+		int overflow(int ch) {
+			if (sync() != 0) {
+				return traits_type::eof();
+			}
+			if (ch != traits_type::eof()) {
+				*pptr() = (char)ch;
+				pbump(1);
+			}
+			return traits_type::not_eof(ch);
+		}
+
+		int sync(void) {
+			char* data = pbase();
+			while (data < pptr()) {
+				ssize_t count = ::write(m_fd, data, pptr() - data);
+				if (count <= 0) {
+					return -1;
+				}
+				data += count;
+			}
+			setp(m_outbuf, m_outbuf + sizeof(m_outbuf));
+			return 0;
+		}
+
+	private:
+		int  m_fd;
+		char m_inbuf[65536];
+		char m_outbuf[65536];
+};
+
+
+
+//////////////////////////////
+//
+// serveSocket -- Listen for connections on a local socket, and serve
+//     each connection in its own thread.  The worker threads of the
+//     server are shared by all connections.
+//
+
+int serveSocket(HumToolServer& server, const string& path) {
+	struct sockaddr_un address;
+	if (path.size() >= sizeof(address.sun_path)) {
+		cerr << "Socket path is too long: " << path << endl;
+		return 1;
+	}
+	int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0) {
+		cerr << "Cannot create socket: " << strerror(errno) << endl;
+		return 1;
+	}
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+	unlink(path.c_str());
+	if (::bind(listener, (struct sockaddr*)&address, sizeof(address)) < 0) {
+		cerr << "Cannot bind socket " << path << ": " << strerror(errno) << endl;
+		close(listener);
+		return 1;
+	}
+	if (listen(listener, 16) < 0) {
+		cerr << "Cannot listen on socket " << path << ": " << strerror(errno) << endl;
+		close(listener);
+		return 1;
+	}
+
+	// Clients which disconnect early should not stop the server:
+	signal(SIGPIPE, SIG_IGN);
+
+	// Tools which print directly to cout should not mix their output
+	// with anything that a client might be reading.
+	cout.rdbuf(cerr.rdbuf());
+
+	while (true) {
+		int connection = accept(listener, NULL, NULL);
+		if (connection < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			cerr << "Cannot accept connection: " << strerror(errno) << endl;
+			break;
+		}
+		thread([&server, connection](void) {
+			FdStreamBuf buffer(connection);
+			istream input(&buffer);
+			ostream output(&buffer);
+			server.serve(input, output);
+			output.flush();
+			close(connection);
+		}).detach();
+	}
+
+	close(listener);
+	unlink(path.c_str());
+	return 1;
+}
+
+#else
+
+int serveSocket(HumToolServer& server, const string& path) {
+	cerr << "Socket connections are not available on this system." << endl;
+	return 1;
+}
+
+#endif
+
+
+
@@ -0,0 +1,206 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 21:36:40 PDT 2026
+// Last Modified: Sun Oct 18 21:36:44 PDT 2026
+// Filename:      cli/textindex.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/cli/textindex.cpp
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab nowrap
+//
+// Description:   Build an inverted index of the words in the lyrics of a
+//                corpus of Humdrum files (see HumTextIndex.h for the file
+//                format), and search the index for words and phrases
+//                without reading the files again.  Files are indexed on
+//                several threads.
+//
+// Usage:         textindex -o lyrics.hti *.krn
+//                textindex -j 16 -o lyrics.hti -l filelist.txt
+//                textindex -i lyrics.hti "kyrie eleison" gloria
+//                textindex -i lyrics.hti -p allel
+//                textindex -i lyrics.hti --words
+//
+// Options:       -o file   :: write the index (to stdout if not given).
+//                -j count  :: number of threads (default: number of cores).
+//                -l file   :: file containing input filenames, one per line.
+//                -i file   :: search an index for the words or phrases
+//                             given as arguments.
+//                -p        :: match words starting with the query words.
+//                --words   :: list the words of an index with their counts.
+//
+
+#include "humlib.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace hum;
+using namespace std;
+
+bool   buildIndex       (HumTextIndex& output, vector<string>& filenames,
+                         int threads);
+void   printMatches     (HumTextIndex& index, const string& query,
+                         vector<HumTextPosting>& matches);
+void   printWords       (HumTextIndex& index);
+
+
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+	Options options;
+	options.define("o|output=s",    "output index file");
+	options.define("j|threads=i:0", "number of threads to use");
+	options.define("l|list=s",      "file containing list of input files");
+	options.define("i|index=s",     "index to search");
+	options.define("p|prefix=b",    "match words starting with the query words");
+	options.define("words=b",       "list words in index");
+	options.process(argc, argv);
+
+	if (options.getBoolean("index")) {
+		HumTextIndex index;
+		if (!index.readFile(options.getString("index"))) {
+			cerr << "Error: cannot read text index " << options.getString("index") << endl;
+			return 1;
+		}
+		if (options.getBoolean("words")) {
+			printWords(index);
+			return 0;
+		}
+		vector<HumTextPosting> matches;
+		cout << "query\tfile\tline\tfield\ttrack\tnotes\n";
+		for (int i=1; i<=options.getArgCount(); i++) {
+			index.search(matches, options.getArg(i), options.getBoolean("prefix"));
+			printMatches(index, options.getArg(i), matches);
+		}
+		return 0;
+	}
+
+	vector<string> filenames;
+	for (int i=1; i<=options.getArgCount(); i++) {
+		filenames.push_back(options.getArg(i));
+	}
+	if (options.getBoolean("list")) {
+		ifstream list(options.getString("list"));
+		if (!list.is_open()) {
+			cerr << "Error: cannot read " << options.getString("list") << endl;
+			return 1;
+		}
+		string line;
+		while (getline(list, line)) {
+			if (!line.empty()) {
+				filenames.push_back(line);
+			}
+		}
+	}
+
+	int threads = options.getInteger("threads");
+	if (threads <= 0) {
+		threads = max(1, (int)thread::hardware_concurrency());
+	}
+
+	HumTextIndex index;
+	bool status = buildIndex(index, filenames, threads);
+	if (!options.getBoolean("output")) {
+		index.write(cout);
+	} else if (!index.writeFile(options.getString("output"))) {
+		cerr << "Error: cannot write " << options.getString("output") << endl;
+		status = false;
+	}
+
+	return status ? 0 : 1;
+}
+
+
+
+//////////////////////////////
+//
+// buildIndex -- Index the files on several threads.  Each thread indexes
+//     a contiguous block of the files, and the indexes of the blocks are
+//     then appended in the order of the files.
+//
+
+bool buildIndex(HumTextIndex& output, vector<string>& filenames, int threads) {
+	int count = (int)filenames.size();
+	threads = max(1, min(threads, count));
+	vector<HumTextIndex> indexes(threads);
+	vector<char> failed(count, 0);
+
+	auto worker = [&](int block) {
+		int start = (int)((int64_t)count * block / threads);
+		int end = (int)((int64_t)count * (block + 1) / threads);
+		for (int i=start; i<end; i++) {
+			HumdrumFile infile;
+			if (!infile.read(filenames[i])) {
+				// Unreadable files are added without words so that the
+				// file numbers match the input list.
+				failed[i] = 1;
+				HumdrumFile empty;
+				indexes[block].addFile(empty, filenames[i]);
+				continue;
+			}
+			indexes[block].addFile(infile, filenames[i]);
+		}
+	};
+
+	vector<thread> pool;
+	for (int i=0; i<threads; i++) {
+		pool.emplace_back(worker, i);
+	}
+	for (int i=0; i<(int)pool.size(); i++) {
+		pool[i].join();
+	}
+
+	bool status = true;
+	output.clear();
+	for (int i=0; i<(int)indexes.size(); i++) {
+		output.append(indexes[i]);
+		indexes[i].clear();
+	}
+	for (int i=0; i<count; i++) {
+		if (failed[i]) {
+			cerr << "Error: cannot read " << filenames[i] << endl;
+			status = false;
+		}
+	}
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// printMatches -- Print the matches of a query, with line and field
+//     numbers counted from 1.
+//
+
+void printMatches(HumTextIndex& index, const string& query,
+		vector<HumTextPosting>& matches) {
+	for (int i=0; i<(int)matches.size(); i++) {
+		HumTextPosting& p = matches[i];
+		cout << query << '\t' << index.getFilename(p.file) << '\t' << p.line + 1
+		     << '\t' << p.field + 1 << '\t' << p.track << '\t' << p.notes << '\n';
+	}
+}
+
+
+
+//////////////////////////////
+//
+// printWords -- Print the words of the index and the number of times that
+//     they occur.
+//
+
+void printWords(HumTextIndex& index) {
+	vector<string> words;
+	index.getWordList(words);
+	for (int i=0; i<(int)words.size(); i++) {
+		cout << words[i] << '\t' << index.find(words[i])->size() << '\n';
+	}
+}
+
+
+
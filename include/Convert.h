@@ -263,11 +263,13 @@ class Convert {
 
 		// instrument related functions defined in Convert-instrument.cpp
 		static std::vector<std::pair<std::string, std::string>> getInstrumentList(void);
+		static std::string getInstrumentClass(const std::string& code);
 
 		// Reference record functions defined in Convert-reference.cpp
 		static std::string getReferenceKeyMeaning(HTp token);
 		static std::string getReferenceKeyMeaning(const std::string& token);
 		static std::string getLanguageName(const std::string& abbreviation);
+		static std::string getCurrentDate(const std::string& format = "%Y/%m/%d");
 };
 
 
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
-// Last Modified: Sun Aug  9 21:19:53 PDT 2015
+// Last Modified: Sun Oct 18 23:20:41 PDT 2026
 // Filename:      HumAddress.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/HumAddress.h
 // Syntax:        C++11; humlib
@@ -13,6 +13,7 @@
 #ifndef _HUMADDRESS_H_INCLUDED
 #define _HUMADDRESS_H_INCLUDED
 
+#include <memory>
 #include <string>
 
 namespace hum {
@@ -46,10 +47,13 @@ class HumAddress {
 		HLp                 getOwner          (void) const { return getLine(); }
 		bool                hasOwner          (void) const;
 
+		static std::shared_ptr<const std::string> makeSpineInfo(const std::string& spineinfo);
+
 	protected:
 		void                setOwner          (HLp aLine);
 		void                setFieldIndex     (int fieldlindex);
 		void                setSpineInfo      (const std::string& spineinfo);
+		void                setSpineInfo      (const std::shared_ptr<const std::string>& spineinfo);
 		void                setTrack          (int aTrack, int aSubtrack);
 		void                setTrack          (int aTrack);
 		void                setSubtrack       (int aSubtrack);
@@ -71,7 +75,10 @@ class HumAddress {
 		// But in this case there is a spine info simplification which will
 		// convert "(#)a (#)b" into "#" where # is the original spine number.
 		// Other more complicated mergers may be simplified in the future.
-		std::string m_spining;
+		// Common spine info strings point into a fixed table, and others
+		// are shared by the tokens that use them (see makeSpineInfo()),
+		// so each token does not need its own copy of the string.
+		std::shared_ptr<const std::string> m_spining;
 
 		// track: This is the track number of the spine.  It is the first
 		// number found in the spineinfo string.
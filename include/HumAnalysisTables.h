@@ -0,0 +1,127 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 12:24:31 PDT 2026
+// Last Modified: Sun Oct 18 23:59:59 PDT 2026
+// Filename:      HumAnalysisTables.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/include/HumAnalysisTables.h
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Typed storage for the results of HumdrumFileContent analyses
+//                (accidental display, slur, beam, tie and phrase links, rest
+//                positions, null-token resolution and sonorities), indexed
+//                by the position of each token in the file.
+//
+
+#ifndef _HUMANALYSISTABLES_H_INCLUDED
+#define _HUMANALYSISTABLES_H_INCLUDED
+
+#include "HumSonorityTable.h"
+#include "HumSpanTable.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace hum {
+
+class HumdrumToken;
+typedef HumdrumToken* HTp;
+class HumdrumFileBase;
+
+// START_MERGE
+
+// HumAnalysisTables: per-file analysis results of HumdrumFileContent,
+// indexed by token id (the position of the token in the file when read
+// line by line).  The token index is created when the first analysis
+// using the tables is run, so tokens added after that are not indexed.
+// The analyses which have filled the tables are tracked by the analysis
+// pass registry of the file (see HumFileAnalysis).  Stem lengths and
+// barline comparisons are only stored as "auto" HumHash parameters (of
+// tokens and lines), since they are single values for a few tokens or
+// lines of a file.
+
+class HumAnalysisTables {
+	public:
+		             HumAnalysisTables   (void);
+		void         clear               (void);
+		void         indexTokens         (HumdrumFileBase& infile);
+		bool         isIndexCurrent      (HumdrumFileBase& infile) const;
+		int          getLineCount        (void) const;
+		int          getTokenCount       (void) const;
+		int          getTokenId          (HTp token) const;
+		int          getTokenId          (int line, int field) const;
+		HTp          getToken            (int id) const;
+		int          getTokenLine        (int id) const;
+		int          getTokenField       (int id) const;
+
+		// Accidental analysis:
+		enum {
+			ACCID_VISUAL     = 1,
+			ACCID_CAUTIONARY = 2,
+			ACCID_OBLIGATORY = 4
+		};
+		bool         setAccidentalFlags  (int id, int subtoken, int flags);
+		int          getAccidentalFlags  (int id, int subtoken) const;
+
+		// Slur, beam, tie and phrase analyses:
+		HumSpanTable& getSlurs           (void) { return m_slurs; }
+		HumSpanTable& getBeams           (void) { return m_beams; }
+		HumSpanTable& getTies            (void) { return m_ties; }
+		HumSpanTable& getPhrases         (void) { return m_phrases; }
+
+		// Rest vertical positions:
+		void         setRestPosition     (int id, int diatonic, int octave);
+		bool         getRestPosition     (int id, int& diatonic, int& octave) const;
+
+		// Null-token resolution:
+		void         setNullResolution   (int id, int resolved, int attackline);
+		int          getNullResolution   (int id) const;
+		int          getAttackLine       (int id) const;
+
+		// Sonorities of data lines:
+		HumSonorityTable& getSonorities  (void) { return m_sonorities; }
+
+	protected:
+		int          getAccidentalIndex  (int id, int subtoken) const;
+
+	private:
+		// Token index:
+		std::vector<int>      m_lineOffsets;  // token id of first token on each line
+		std::vector<HTp>      m_tokens;       // token for each token id
+		std::vector<int>      m_tokenLines;   // line index for each token id
+
+		// Accidental display (ACCID_* flags) of each subtoken of the data
+		// tokens.  The flags of subtoken n of a token are at
+		// m_accidentals[m_accidentalOffsets[id] + n].
+		std::vector<int>      m_accidentalOffsets;
+		std::vector<uint8_t>  m_accidentals;
+
+		HumSpanTable          m_slurs;
+		HumSpanTable          m_beams;
+		HumSpanTable          m_ties;
+		HumSpanTable          m_phrases;
+
+		// Rest positions: diatonic pitch class (0=C to 6=B, -1 if none) and
+		// octave of the vertical rest position.
+		std::vector<int8_t>   m_restDiatonic;
+		std::vector<int8_t>   m_restOctave;
+
+		// Null-token resolution: token id of the last non-null data token
+		// in the (sub)spine at or before each token (-1 if none), and the
+		// line on which that note was attacked (the start of its tie
+		// group for tied notes).
+		std::vector<int>      m_nullResolution;
+		std::vector<int>      m_attackLines;
+
+		HumSonorityTable      m_sonorities;
+};
+
+
+// END_MERGE
+
+} // end namespace hum
+
+#endif /* _HUMANALYSISTABLES_H_INCLUDED */
+
+
+
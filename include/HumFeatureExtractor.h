@@ -0,0 +1,89 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 20:04:36 PDT 2026
+// Last Modified: Sun Oct 18 20:04:40 PDT 2026
+// Filename:      HumFeatureExtractor.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/include/HumFeatureExtractor.h
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Extraction of note features from **kern data into the
+//                columns of a HumFeatureTable.
+//
+
+#ifndef _HUMFEATUREEXTRACTOR_H_INCLUDED
+#define _HUMFEATUREEXTRACTOR_H_INCLUDED
+
+#include "HumFeatureTable.h"
+#include "HumdrumFile.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace hum {
+
+// START_MERGE
+
+// HumFeatureExtractor: add a row to a feature table for each note attack
+// in the **kern spines of a file (each note of a chord is a separate row;
+// secondary tied notes are not included, and the duration of a note is
+// its tied duration).  All selected features are extracted in a single
+// pass through the file.  An extractor is not modified by extract(), so
+// one extractor can be used by many threads, each with its own table.
+
+class HumFeatureExtractor {
+	public:
+		enum Feature {
+			FEATURE_FILE,       // filename
+			FEATURE_LINE,       // line index of note
+			FEATURE_FIELD,      // field index of note
+			FEATURE_SUBTOKEN,   // index of note in chord
+			FEATURE_TRACK,      // track (spine) number
+			FEATURE_LAYER,      // subtrack number (0 if spine is not split)
+			FEATURE_MEASURE,    // measure number
+			FEATURE_ONSET,      // quarter notes from start of score
+			FEATURE_DURATION,   // tied duration in quarter notes
+			FEATURE_METPOS,     // quarter notes from start of measure
+			FEATURE_BEAT,       // beat in measure (from 1)
+			FEATURE_METLEV,     // metric level (from getMetricLevels())
+			FEATURE_KERN,       // **kern text of note
+			FEATURE_BASE40,     // base-40 pitch
+			FEATURE_MIDI,       // MIDI key number
+			FEATURE_INTERVAL,   // semitones from previous note in layer
+			FEATURE_INTERVAL40, // base-40 interval from previous note in layer
+			FEATURE_TIE,        // 1 if note is tied to following notes
+			FEATURE_CHORD,      // number of notes in the chord
+			FEATURE_LYRIC,      // syllable in first **text spine for note
+			FEATURE_COUNT
+		};
+
+		                   HumFeatureExtractor (void);
+		bool               setFeatures         (const std::string& list);
+		void               setFeature          (Feature feature, bool state);
+		bool               isFeature           (Feature feature) const;
+		static const char* getFeatureName      (Feature feature);
+		static std::ostream& printFeatureList  (std::ostream& out);
+
+		void               prepareTable        (HumFeatureTable& table) const;
+		void               extract             (HumdrumFile& infile,
+		                                        HumFeatureTable& table,
+		                                        const std::string& filename = "") const;
+
+	protected:
+		std::string        getLyric            (HTp token) const;
+		HumNum             getTiedDuration     (HTp token, int base40) const;
+
+	private:
+		std::vector<bool>  m_features;
+};
+
+
+// END_MERGE
+
+} // end namespace hum
+
+#endif /* _HUMFEATUREEXTRACTOR_H_INCLUDED */
+
+
+
@@ -0,0 +1,166 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 19:52:07 PDT 2026
+// Last Modified: Sun Oct 18 19:52:11 PDT 2026
+// Filename:      HumFeatureTable.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/include/HumFeatureTable.h
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Columnar storage of features (one row for each note, for
+//                example), and a binary file format for the columns which
+//                can be read in place from memory-mapped files.
+//
+
+#ifndef _HUMFEATURETABLE_H_INCLUDED
+#define _HUMFEATURETABLE_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace hum {
+
+// START_MERGE
+
+// HumFeatureTable: columns of values for each row of a table.  Each column
+// is a fixed-width array (32-bit integers or 64-bit floats) that can be
+// passed directly to numerical code.  String columns store 32-bit indexes
+// into a dictionary of the distinct strings in the table (index 0 is the
+// empty string).  Missing values are MISSING_INT in integer columns and NAN
+// in float columns.
+//
+// The binary form written by write() contains a header, the string
+// dictionary and then each column as a contiguous array, with every block
+// aligned to 8 bytes, so that HumFeatureView can use the arrays in place
+// from a memory-mapped file.  Numbers are stored in the byte order of the
+// computer that wrote the file (checked when reading).
+//
+//    offset  size  contents
+//         0     8  "HUMFEAT1"
+//         8     4  0x01020304 (byte-order mark)
+//        12     4  column count
+//        16     4  string count
+//        20     4  (zero)
+//        24     8  row count
+//        32     8  byte size of the string text block
+//        40    48  for each column: name (32 bytes, null-terminated),
+//                  type (4 bytes), zero (4 bytes), offset of the column
+//                  data from the start of the file (8 bytes)
+//         .     .  string offsets (8 bytes each, string count + 1) into the
+//                  string text block, followed by the text block (each
+//                  string is null-terminated)
+//         .     .  column data
+//
+
+class HumFeatureTable {
+	public:
+		enum ColumnType {
+			TYPE_INT32   = 1,
+			TYPE_FLOAT64 = 2,
+			TYPE_STRING  = 3
+		};
+
+		static constexpr int32_t MISSING_INT = INT32_MIN;
+		static constexpr int     MAX_NAME_SIZE = 31;
+
+		                   HumFeatureTable     (void);
+		void               clear               (void);
+		void               clearRows           (void);
+
+		int                addColumn           (const std::string& name,
+		                                        ColumnType type);
+		int                getColumnCount      (void) const;
+		int                getColumnIndex      (const std::string& name) const;
+		const std::string& getColumnName       (int column) const;
+		ColumnType         getColumnType       (int column) const;
+		int64_t            getRowCount         (void) const;
+
+		void               addRow              (void);
+		void               setInt              (int column, int32_t value);
+		void               setFloat            (int column, double value);
+		void               setString           (int column, const std::string& value);
+		void               setStringIndex      (int column, int32_t index);
+
+		int32_t            getInt              (int64_t row, int column) const;
+		double             getFloat            (int64_t row, int column) const;
+		const std::string& getString           (int64_t row, int column) const;
+		const int32_t*     getIntColumn        (int column) const;
+		const double*      getFloatColumn      (int column) const;
+
+		int                addString           (const std::string& value);
+		int                getStringCount      (void) const;
+		const std::string& getDictionaryString (int index) const;
+
+		bool               append              (const HumFeatureTable& other);
+		bool               write               (std::ostream& out) const;
+		bool               writeFile           (const std::string& filename) const;
+		bool               read                (const char* data, size_t size);
+		bool               readFile            (const std::string& filename);
+		std::ostream&      printTsv            (std::ostream& out) const;
+
+	private:
+		struct Column {
+			std::string          name;
+			ColumnType           type = TYPE_INT32;
+			std::vector<int32_t> ints;     // for TYPE_INT32 and TYPE_STRING
+			std::vector<double>  floats;   // for TYPE_FLOAT64
+		};
+
+		std::vector<Column>        m_columns;
+		std::vector<std::string>   m_strings;
+		std::map<std::string, int> m_stringIds;
+		int64_t                    m_rows = 0;
+};
+
+
+
+// HumFeatureView: read-only access to a table written by
+// HumFeatureTable::write(), without copying the data.  The memory must
+// stay valid (and mapped) while the view is used, and should be aligned
+// to 8 bytes (as memory from mmap() or new is).
+
+class HumFeatureView {
+	public:
+		                HumFeatureView      (void);
+		bool            open                (const char* data, size_t size);
+		void            close               (void);
+		bool            isOpen              (void) const;
+
+		int             getColumnCount      (void) const;
+		int             getColumnIndex      (const std::string& name) const;
+		const char*     getColumnName       (int column) const;
+		HumFeatureTable::ColumnType getColumnType (int column) const;
+		int64_t         getRowCount         (void) const;
+
+		const int32_t*  getIntColumn        (int column) const;
+		const double*   getFloatColumn      (int column) const;
+		int             getStringCount      (void) const;
+		const char*     getDictionaryString (int index) const;
+		const char*     getString           (int64_t row, int column) const;
+
+	protected:
+		const char*     getColumnData       (int column) const;
+
+	private:
+		const char*     m_data        = NULL;
+		size_t          m_size        = 0;
+		int             m_columnCount = 0;
+		int             m_stringCount = 0;
+		int64_t         m_rows        = 0;
+		const uint64_t* m_stringOffsets = NULL;
+		const char*     m_stringText  = NULL;
+};
+
+
+// END_MERGE
+
+} // end namespace hum
+
+#endif /* _HUMFEATURETABLE_H_INCLUDED */
+
+
+
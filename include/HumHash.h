@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Aug 16 01:23:01 PDT 2015
-// Last Modified: Sun Aug 16 01:23:05 PDT 2015
+// Last Modified: Sun Oct 18 21:47:10 PDT 2026
 // Filename:      HumHash.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/HumHash.h
 // Syntax:        C++11; humlib
@@ -266,6 +266,7 @@ class HumHash {
 
 	friend std::ostream& operator<<(std::ostream& out, const HumHash& hash);
 	friend std::ostream& operator<<(std::ostream& out, HumHash* hash);
+	friend class HumJsonWriter;
 };
 
 
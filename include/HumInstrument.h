@@ -2,7 +2,7 @@
 // Copyright 2000 by Craig Stuart Sapp, All Rights Reserved.
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Nov 25 14:18:01 PST 2000
-// Last Modified: Fri Sep  2 10:16:09 CEST 2016 (added to humlib)
+// Last Modified: Sun Oct 18 23:59:59 PDT 2026
 // Filename:      HumInstrument.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/HumInstrument.h
 // vim:           syntax=cpp ts=3 noexpandtab nowrap
@@ -14,8 +14,7 @@
 #ifndef _HUMINSTRUMENT_H_INCLUDED
 #define _HUMINSTRUMENT_H_INCLUDED
 
-#include <stdlib.h>
-#include <vector>
+#include <map>
 #include <string>
 
 namespace hum {
@@ -33,6 +32,13 @@ class _HumInstrument {
 };
 
 
+// HumInstrument: look up the English name and General MIDI instrument of
+// a Humdrum instrument code such as "*Iflt".  The table of codes is a
+// constant array sorted by code (built at compile time), so lookups are
+// binary searches that need no initialization or locking.  Instruments
+// added or changed with setGM() are only known to the object that they were
+// set in.
+
 class HumInstrument {
 	public:
 		            HumInstrument       (void);
@@ -47,18 +53,23 @@ class HumInstrument {
 		void        setHumdrum          (const std::string& Hname);
 		int         setGM               (const std::string& Hname, int aValue);
 
+		static int  getInstrumentCount  (void);
+		static _HumInstrument getInstrument(int index);
+
 	private:
-		int                            m_index;
-		static std::vector<_HumInstrument>  m_data;
-		static int                     m_classcount;
+		// m_index: index in the instrument table of the code given to
+		// setHumdrum(), or -1 if the code is not in the table.
+		int                        m_index;
+
+		// m_humdrum: code given to setHumdrum() (without *I).
+		std::string                m_humdrum;
+
+		// m_gm: General MIDI instruments given to setGM().
+		std::map<std::string, int> m_gm;
 
 	protected:
-		void       initialize          (void);
-		void       afi                 (const char* humdrum_name, int midinum,
-		                                const char* EN_name);
-		int        find                (const std::string& Hname);
-		void       sortData            (void);
-		static int data_compare_by_humdrum_name(const void* a, const void* b);
+		static int find                (const std::string& Hname);
+		static std::string stripPrefix (const std::string& Hname);
 };
 
 
@@ -0,0 +1,170 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 21:46:02 PDT 2026
+// Last Modified: Sun Oct 18 23:59:59 PDT 2026
+// Filename:      HumJsonWriter.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/include/HumJsonWriter.h
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Write the token graph and analyses of a Humdrum file in
+//                JSON or CBOR format.
+//
+
+#ifndef _HUMJSONWRITER_H_INCLUDED
+#define _HUMJSONWRITER_H_INCLUDED
+
+#include "HumdrumFile.h"
+
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace hum {
+
+// START_MERGE
+
+// HumJsonWriter: write the structure of a Humdrum file (lines, tokens,
+// tracks, subtracks and spine links) together with the results of content
+// analyses, so that other programs do not need to parse the Humdrum data
+// again.  The output is written directly to the output stream while the
+// file is traversed, without building a document in memory.  The format
+// is JSON or CBOR (RFC 8949, using indefinite-length arrays and maps);
+// both formats have the same structure:
+//
+//    { "format": "humdrum", "version": 1,
+//      "lineCount": 12, "trackCount": 2, "tpq": 2, "duration": [4, 1],
+//      "tracks": [ { "track": 1, "dataType": "**kern", "start": [0, 0] },
+//                  ... ],
+//      "lines": [ { "line": 0, "type": "exclusive",
+//                   "durationFromStart": [0, 1], "duration": [0, 1],
+//                   "tokens": [ { "id": "loc0_0", "text": "**kern",
+//                                 "type": "interpretation", "track": 1,
+//                                 "subtrack": 0, "spine": "1",
+//                                 "next": [[1, 0]], "prev": [] }, ... ] },
+//                 ... ] }
+//
+// Durations are [numerator, denominator] pairs in quarter notes, and
+// references to other tokens are [line, field] pairs.  The sections that
+// are written can be limited with setSections(); the analysis needed by a
+// section is run before writing if it has not been done already.  Ties,
+// slurs, phrases, beams, accidentals and rest positions are taken from the
+// analysis tables of the file (see HumAnalysisTables.h):
+//
+//    "slurs": [ { "number": 1, "end": [8, 0], "duration": [3, 2] } ],
+//    "slurHanging": 1,           (+1 for an unmatched start, -1 for an end)
+//    "ties": [ ... ], "phrases": [ ... ], "phraseHanging": 1,
+//    "beams": [ ... ], "beamHanging": -1,
+//    "accidentals": [1, 0, 3],   (HumAnalysisTables::ACCID_* flags for
+//                                 each note of a chord)
+//    "restPosition": [4, 4],     (diatonic pitch class and octave)
+//
+// Other analyses (such as stem lengths) and layout parameters are written
+// as the "parameters" of a token: [namespace1, namespace2, key, value]
+// lists, where token values are given as [line, field] pairs, and the
+// token that a layout parameter came from is added as a fifth element.
+// The "auto" parameters which copy results in the analysis tables are not
+// written.
+
+class HumJsonWriter {
+	public:
+		enum Format {
+			FORMAT_JSON,
+			FORMAT_CBOR
+		};
+
+		enum Section {
+			SECTION_LINKS       = 0x001,  // next/previous tokens in spines
+			SECTION_RHYTHM      = 0x002,  // durations of lines and tokens
+			SECTION_NULLS       = 0x004,  // resolution of null tokens
+			SECTION_TIES        = 0x008,  // tie links
+			SECTION_SLURS       = 0x010,  // slur links
+			SECTION_PHRASES     = 0x020,  // phrase links
+			SECTION_BEAMS       = 0x040,  // beam links
+			SECTION_ACCIDENTALS = 0x080,  // displayed accidentals
+			SECTION_RESTS       = 0x100,  // vertical positions of rests
+			SECTION_PARAMETERS  = 0x200,  // layout parameters and linked tokens
+			SECTION_AUTO        = 0x400,  // other "auto" parameters
+			SECTION_ALL         = 0x7ff
+		};
+
+		              HumJsonWriter       (void);
+
+		void          setFormat           (Format format);
+		Format        getFormat           (void) const;
+		void          setSections         (int sections);
+		bool          setSections         (const std::string& names);
+		int           getSections         (void) const;
+		static std::string getSectionNames(void);
+
+		bool          write               (std::ostream& out, HumdrumFile& infile);
+
+	protected:
+		void          writeHeader         (HumdrumFile& infile);
+		void          writeLine           (HumdrumLine& line);
+		void          writeToken          (HTp token);
+		void          writeTokenLinks     (HTp token);
+		void          writeSpans          (const char* key, const char* hangingkey,
+		                                   HumSpanTable& spans, int id, HTp token);
+		void          writeAnalyses       (HTp token);
+		void          writeParameters     (HTp token);
+		int           getParameterSection (const std::string& ns1,
+		                                   const std::string& ns2,
+		                                   const std::string& key) const;
+		static const char* getLineType    (HumdrumLine& line);
+		static const char* getTokenType   (HTp token);
+
+		// Low-level output shared by the JSON and CBOR formats:
+		void          beginObject         (void);
+		void          endObject           (void);
+		void          beginArray          (void);
+		void          endArray            (void);
+		void          writeKey            (const char* key);
+		void          writeString         (const char* text, size_t size);
+		void          writeString         (const std::string& text);
+		void          writeString         (const char* text);
+		void          writeInteger        (long long value);
+		void          writeRational       (HumNum value);
+		void          writeReference      (HTp token);
+		void          writeNull           (void);
+		void          writeNewline        (void);
+		void          writeSeparator      (void);
+		void          writeCborHead       (int major, unsigned long long value);
+		void          put                 (char ch);
+		void          put                 (const char* data, size_t size);
+
+	private:
+		Format m_format = FORMAT_JSON;
+		int    m_sections = SECTION_ALL;
+
+		// m_tables: analysis tables of the file being written.
+		HumAnalysisTables* m_tables = NULL;
+
+		// m_out: output buffer of the stream being written to.
+		std::streambuf* m_out = NULL;
+
+		// m_failed: true if the stream could not accept some output.
+		bool   m_failed = false;
+
+		// m_first: for each open JSON array or object, true if no value has
+		// been written into it yet (so that no comma is needed).
+		std::vector<char> m_first;
+
+		// m_afterKey: true if a JSON key has been written, so that the next
+		// value does not need a comma.
+		bool   m_afterKey = false;
+
+		// m_newline: true if the next JSON value should start on a new line.
+		bool   m_newline = false;
+};
+
+
+// END_MERGE
+
+} // end namespace hum
+
+#endif /* _HUMJSONWRITER_H_INCLUDED */
+
+
+
@@ -0,0 +1,105 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 12:24:31 PDT 2026
+// Last Modified: Sun Oct 18 23:59:55 PDT 2026
+// Filename:      HumMetricTable.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/include/HumMetricTable.h
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   The metric position of each data line in each track of a
+//                file, filled in by HumdrumFileContent::analyzeMetricGrid().
+//
+
+#ifndef _HUMMETRICTABLE_H_INCLUDED
+#define _HUMMETRICTABLE_H_INCLUDED
+
+#include "HumNum.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace hum {
+
+// START_MERGE
+
+// HumMetricTable: the metric position of each data line in each track of
+// a file, filled in by HumdrumFileContent::analyzeMetricGrid().  The meter
+// of a track is set by time signatures (*M3/4) in the track, and the beat
+// duration can be changed from the default for the meter by *beat:
+// interpretations (such as *beat:4.), which stay active until the next
+// time signature.  Compound meters (such as 6/8, but not 3/8) have
+// dotted beats.  Without a time signature, the beat is a quarter note.
+// Beats are counted from 1 at the previous barline, and the beat fraction
+// is the position within the beat (from 0 up to 1).  The metric level is
+// the one given by HumdrumFileContent::getMetricLevels(), which does not
+// use *beat: interpretations.  Tracks are indexed from 1, and only data
+// lines have entries.
+
+class HumMetricTable {
+	public:
+		             HumMetricTable     (void);
+		void         clear              (void);
+		void         resize             (int lineCount, int trackCount);
+		int          addMeter           (int top, int bottom, int bottom2,
+		                                 HumNum beat);
+		void         addLine            (int line, HumNum position);
+		void         setPosition        (int line, int track, int meter,
+		                                 int beat, HumNum fraction,
+		                                 double level);
+
+		int          getLineCount       (void) const;
+		int          getTrackCount      (void) const;
+		bool         hasPosition        (int line, int track) const;
+		HumNum       getMeasurePosition (int line) const;
+
+		bool         hasMeter           (int line, int track) const;
+		int          getMeterTop        (int line, int track) const;
+		HumNum       getMeterBottom     (int line, int track) const;
+		bool         isCompound         (int line, int track) const;
+		HumNum       getBeatDuration    (int line, int track) const;
+		HumNum       getExplicitBeat    (int line, int track) const;
+
+		int          getBeat            (int line, int track) const;
+		HumNum       getBeatFraction    (int line, int track) const;
+		double       getMetricLevel     (int line, int track,
+		                                 double undefined = NAN) const;
+
+	protected:
+		int          getIndex           (int line, int track) const;
+		int          getMeterIndex      (int line, int track) const;
+
+	private:
+		int                   m_trackCount = 0;
+
+		// Meter arrays (indexed by meter, where meter 0 is used for tracks
+		// without a time signature):
+		std::vector<int>      m_meterTops;
+		std::vector<HumNum>   m_meterBottoms;
+		std::vector<uint8_t>  m_compound;
+		std::vector<HumNum>   m_beatDurations;
+		std::vector<HumNum>   m_explicitBeats; // *beat: duration (0 if none)
+
+		// Line arrays (indexed by line):
+		std::vector<int>      m_rows;         // row of data line (-1 if none)
+
+		// Row arrays (indexed by row, one row for each data line):
+		std::vector<HumNum>   m_positions;    // quarter notes from barline
+
+		// Position arrays (indexed by row * track count + track - 1):
+		std::vector<int>      m_meters;       // meter index
+		std::vector<int>      m_beats;        // beat number (from 1)
+		std::vector<HumNum>   m_fractions;    // position within beat
+		std::vector<double>   m_levels;       // metric level
+};
+
+
+// END_MERGE
+
+} // end namespace hum
+
+#endif /* _HUMMETRICTABLE_H_INCLUDED */
+
+
+
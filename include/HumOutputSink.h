@@ -0,0 +1,179 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 18:10:14 PDT 2026
+// Last Modified: Sun Oct 18 18:10:19 PDT 2026
+// Filename:      HumOutputSink.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/include/HumOutputSink.h
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Destinations for the output of Humdrum tools.  A sink can
+//                be attached to a HumTool with setOutputSink() so that the
+//                tool writes its results directly to a file descriptor, a
+//                preallocated buffer, a string or a callback function,
+//                rather than into the tool's internal stringstreams which
+//                then have to be copied out again.  A sink is also a
+//                std::streambuf, so it can be used with any std::ostream.
+//
+
+#ifndef _HUMOUTPUTSINK_H_INCLUDED
+#define _HUMOUTPUTSINK_H_INCLUDED
+
+#include <functional>
+#include <iostream>
+#include <string>
+
+namespace hum {
+
+class HumdrumFileBase;
+
+// START_MERGE
+
+class HumOutputSink : public std::streambuf {
+	public:
+		                HumOutputSink   (void);
+		virtual        ~HumOutputSink   ();
+
+		bool            write           (const char* data, size_t size);
+		bool            write           (const std::string& text);
+		bool            writeFile       (HumdrumFileBase& infile);
+		bool            flush           (void);
+
+		size_t          getByteCount    (void);
+		bool            isFailed        (void);
+
+	protected:
+		virtual bool    writeData       (const char* data, size_t size) = 0;
+		void            setUnbuffered   (void);
+
+		virtual int             overflow(int ch);
+		virtual std::streamsize xsputn  (const char* data, std::streamsize size);
+		virtual int             sync    (void);
+
+	private:
+		// m_buffer: small writes (such as single tokens) are collected
+		// here before being passed to writeData().  Writes larger than the
+		// buffer are passed on directly.
+		char m_buffer[8192];
+
+		// m_written: number of bytes passed on to writeData().
+		size_t m_written = 0;
+
+		// m_failed: true if writeData() could not store some data.
+		bool m_failed = false;
+};
+
+
+
+//////////////////////////////
+//
+// HumFdSink -- Write to a file descriptor, such as 1 for standard output
+//     or an open socket.
+//
+
+class HumFdSink : public HumOutputSink {
+	public:
+		                HumFdSink       (int fd);
+		               ~HumFdSink       ();
+
+	protected:
+		bool            writeData       (const char* data, size_t size);
+
+	private:
+		int m_fd;
+};
+
+
+
+//////////////////////////////
+//
+// HumBufferSink -- Write into a caller-supplied block of memory.  The text
+//     is stored directly in the block, and writing fails (isFailed()
+//     returns true) if the block is too small.
+//
+
+class HumBufferSink : public HumOutputSink {
+	public:
+		                HumBufferSink   (char* buffer, size_t capacity);
+		               ~HumBufferSink   ();
+
+		const char*     getData         (void);
+		size_t          getSize         (void);
+
+	protected:
+		bool            writeData       (const char* data, size_t size);
+		int             sync            (void);
+
+	private:
+		char* m_data;
+};
+
+
+
+//////////////////////////////
+//
+// HumStringSink -- Append to a caller-supplied string.
+//
+
+class HumStringSink : public HumOutputSink {
+	public:
+		                HumStringSink   (std::string& output);
+		               ~HumStringSink   ();
+
+	protected:
+		bool            writeData       (const char* data, size_t size);
+
+	private:
+		std::string& m_output;
+};
+
+
+
+//////////////////////////////
+//
+// HumStreamSink -- Write to an existing output stream, such as std::cout.
+//
+
+class HumStreamSink : public HumOutputSink {
+	public:
+		                HumStreamSink   (std::ostream& output);
+		               ~HumStreamSink   ();
+
+	protected:
+		bool            writeData       (const char* data, size_t size);
+
+	private:
+		std::ostream& m_output;
+};
+
+
+
+//////////////////////////////
+//
+// HumCallbackSink -- Pass blocks of text to a function.  The function
+//     returns false if it could not accept the data.
+//
+
+class HumCallbackSink : public HumOutputSink {
+	public:
+		typedef std::function<bool(const char* data, size_t size)> Callback;
+
+		                HumCallbackSink (const Callback& callback);
+		               ~HumCallbackSink ();
+
+	protected:
+		bool            writeData       (const char* data, size_t size);
+
+	private:
+		Callback m_callback;
+};
+
+
+// END_MERGE
+
+} // end namespace hum
+
+#endif /* _HUMOUTPUTSINK_H_INCLUDED */
+
+
+
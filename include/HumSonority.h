@@ -0,0 +1,79 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 12:24:31 PDT 2026
+// Last Modified: Sun Oct 18 23:59:55 PDT 2026
+// Filename:      HumSonority.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/include/HumSonority.h
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   The notes sounding on one data line of a file, as a view
+//                into a HumSonorityTable.
+//
+
+#ifndef _HUMSONORITY_H_INCLUDED
+#define _HUMSONORITY_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+namespace hum {
+
+class HumdrumToken;
+typedef HumdrumToken* HTp;
+
+// START_MERGE
+
+class HumSonorityTable;
+
+// HumSonority: the notes sounding on one data line of a file (a vertical
+// slice through the **kern spines), as stored in a HumSonorityTable.
+// Null tokens are resolved to the notes that they sustain, and rests are
+// not included.  Notes are listed in field order, and in chord order
+// within each field.  Pitch-class sets are bitmasks: bit n of the base-40
+// set is base-40 pitch class n (C=2, C#=3, ...), and bit n of the base-12
+// set is chromatic pitch class n (C=0, C#=1, ...).  A note is an attack
+// if it starts on the line (it is not from a null token, and it is not
+// the continuation of a tie).  The sonority is a view into the table,
+// so it is only valid while the table is not changed.
+
+class HumSonority {
+	public:
+		             HumSonority              (const HumSonorityTable* table = NULL,
+		                                       int line = -1);
+		int          getLineIndex             (void) const;
+		bool         isEmpty                  (void) const;
+		int          getNoteCount             (void) const;
+		int          getAttackCount           (void) const;
+		int          getVoiceCount            (void) const;
+
+		int          getBase40                (int index) const;
+		int          getBase40Pc              (int index) const;
+		int          getMidiPitch             (int index) const;
+		HTp          getToken                 (int index) const;
+		int          getFieldIndex            (int index) const;
+		int          getSubtokenIndex         (int index) const;
+		bool         isAttack                 (int index) const;
+		int          getLowestIndex           (void) const;
+
+		uint64_t     getPitchClassSet         (void) const;
+		uint64_t     getAttackPitchClassSet   (void) const;
+		uint16_t     getPitchClassSet12       (void) const;
+		uint16_t     getAttackPitchClassSet12 (void) const;
+
+	private:
+		const HumSonorityTable* m_table;
+		int          m_line;
+		int          m_start;   // index of first note of line in table
+		int          m_count;   // number of notes on line
+};
+
+
+// END_MERGE
+
+} // end namespace hum
+
+#endif /* _HUMSONORITY_H_INCLUDED */
+
+
+
@@ -0,0 +1,107 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 12:24:31 PDT 2026
+// Last Modified: Sun Oct 18 23:59:55 PDT 2026
+// Filename:      HumSonorityTable.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/include/HumSonorityTable.h
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   The sonority of each data line in a file, filled in by
+//                HumdrumFileContent::analyzeSonorities().
+//
+
+#ifndef _HUMSONORITYTABLE_H_INCLUDED
+#define _HUMSONORITYTABLE_H_INCLUDED
+
+#include "HumSonority.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace hum {
+
+class HumdrumToken;
+typedef HumdrumToken* HTp;
+
+// START_MERGE
+
+// HumSonorityTable: the sonority of each data line in a file, filled in
+// by HumdrumFileContent::analyzeSonorities().  The notes of all lines are
+// stored in one set of arrays, and iterating over the table visits the
+// sonority of each data line in order:
+//
+//    for (HumSonority slice : infile.getSonorities()) { ... }
+
+class HumSonorityTable {
+	public:
+		class const_iterator {
+			public:
+				const_iterator(const HumSonorityTable* table, int index)
+					: m_table(table), m_index(index) { }
+				HumSonority operator*(void) const {
+					return m_table->getSonority(m_table->m_dataLines[m_index]);
+				}
+				const_iterator& operator++(void) { m_index++; return *this; }
+				bool operator==(const const_iterator& other) const {
+					return m_index == other.m_index;
+				}
+				bool operator!=(const const_iterator& other) const {
+					return m_index != other.m_index;
+				}
+			private:
+				const HumSonorityTable* m_table;
+				int m_index;
+		};
+
+		             HumSonorityTable   (void);
+		void         clear              (void);
+		void         resize             (int lineCount);
+		void         addSlice           (int line);
+		void         addNote            (int line, HTp token, int field,
+		                                 int subtoken, int base40, bool attack);
+
+		int          getLineCount       (void) const;
+		int          getSliceCount      (void) const;
+		HumSonority  getSonority        (int line) const;
+		HumSonority  operator[]         (int line) const { return getSonority(line); }
+		const_iterator begin            (void) const { return const_iterator(this, 0); }
+		const_iterator end              (void) const {
+			return const_iterator(this, (int)m_dataLines.size());
+		}
+
+	private:
+		friend class HumSonority;
+
+		// Line arrays (indexed by line):
+		std::vector<int>      m_noteStart;    // index of first note on line
+		std::vector<short>    m_noteCount;    // number of notes on line
+		std::vector<short>    m_attackCount;  // number of attacked notes
+		std::vector<short>    m_voiceCount;   // number of fields with notes
+		std::vector<short>    m_lowest;       // index of lowest note on line
+		std::vector<uint64_t> m_pitchClasses;
+		std::vector<uint64_t> m_attackPitchClasses;
+		std::vector<uint16_t> m_pitchClasses12;
+		std::vector<uint16_t> m_attackPitchClasses12;
+
+		// Slice array: line index of each data line.
+		std::vector<int>      m_dataLines;
+
+		// Note arrays (indexed by note):
+		std::vector<short>    m_base40;
+		std::vector<short>    m_midi;
+		std::vector<HTp>      m_tokens;       // token containing note
+		std::vector<short>    m_fields;       // field of note on its line
+		std::vector<uint8_t>  m_subtokens;    // chord index of note
+		std::vector<uint8_t>  m_attacks;      // 1 = attack, 0 = sustain
+};
+
+
+// END_MERGE
+
+} // end namespace hum
+
+#endif /* _HUMSONORITYTABLE_H_INCLUDED */
+
+
+
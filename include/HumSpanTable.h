@@ -0,0 +1,120 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 12:24:31 PDT 2026
+// Last Modified: Sun Oct 18 23:59:59 PDT 2026
+// Filename:      HumSpanTable.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/include/HumSpanTable.h
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Links between the start and end tokens of slurs and beams,
+//                stored in HumAnalysisTables and indexed by token id.
+//
+
+#ifndef _HUMSPANTABLE_H_INCLUDED
+#define _HUMSPANTABLE_H_INCLUDED
+
+#include "HumNum.h"
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace hum {
+
+class HumdrumToken;
+typedef HumdrumToken* HTp;
+
+// START_MERGE
+
+// HumSpanTable: links between the start and end tokens of slurs, beams,
+// ties or phrases.  Each token can start and end more than one span, so
+// the links are stored in a list, and each token has a chain of the links
+// starting and ending on it.  Span numbers are the enumerations used in
+// the "auto" HumHash parameters: for slurs, the start number is the index
+// of the opening character on the start token (counting from the last
+// one), and the end number is the index of the closing character on the
+// end token.  Phrases are numbered in the order that they were linked on
+// each token, and ties by the chord note (subtoken index plus one) that
+// they start or end on.  When spines are analyzed in parallel, a mutex
+// can be given to the table with setMutex() to serialize the additions to
+// the link list and hanging-span maps (all other storage is per token, and
+// each token is written by a single thread).
+
+class HumSpanTable {
+	public:
+		            HumSpanTable     (void);
+		void        clear            (void);
+		void        resize           (int tokenCount);
+
+		void        addLink          (int startid, int endid, HTp starttok,
+		                              HTp endtok, int startnumber, int endnumber,
+		                              HumNum duration);
+		void        addHanging       (int id, bool start, HumNum duration,
+		                              int openindex = -1, bool endingback = false);
+		void        setSpanMember    (int id, HTp spanstart);
+		void        setSpanEndpoints (int startid, int endid);
+		void        setMutex         (std::mutex* mutex) { m_mutex = mutex; }
+
+		HTp         getEndToken      (int id, int startnumber = 1) const;
+		HTp         getStartToken    (int id, int endnumber = 1) const;
+		int         getEndNumber     (int id, int startnumber = 1) const;
+		int         getStartNumber   (int id, int endnumber = 1) const;
+		HumNum      getDuration      (int id, int startnumber = 1) const;
+		int         getStartCount    (int id) const;
+		int         getEndCount      (int id) const;
+		int         getHangingSide   (int id) const;
+		int         getOpenIndex     (int id) const;
+		bool        isEndingBack     (int id) const;
+		HTp         getSpanStart     (int id) const;
+		bool        isSpanStart      (int id) const;
+		bool        isSpanEnd        (int id) const;
+
+	protected:
+		int         findStartLink    (int id, int startnumber) const;
+		int         findEndLink      (int id, int endnumber) const;
+
+	private:
+		enum {
+			FLAG_HANGING_START = 1,
+			FLAG_HANGING_STOP  = 2,
+			FLAG_ENDING_BACK   = 4,
+			FLAG_SPAN_START    = 8,
+			FLAG_SPAN_END      = 16
+		};
+
+		// Token arrays (indexed by token id):
+		std::vector<int>     m_firstStart;  // first link starting on token
+		std::vector<int>     m_firstEnd;    // first link ending on token
+		std::vector<short>   m_startCount;  // number of links starting on token
+		std::vector<short>   m_endCount;    // number of links ending on token
+		std::vector<uint8_t> m_flags;       // hanging/span states
+		std::vector<HTp>     m_spanStart;   // start of span containing token
+
+		// Link arrays (indexed by link):
+		std::vector<HTp>     m_startTokens;
+		std::vector<HTp>     m_endTokens;
+		std::vector<int>     m_startNumbers;
+		std::vector<int>     m_endNumbers;
+		std::vector<HumNum>  m_durations;
+		std::vector<int>     m_nextStart;   // next link starting on same token
+		std::vector<int>     m_nextEnd;     // next link ending on same token
+
+		// Hanging spans are rare, so store their parameters sparsely:
+		std::map<int, HumNum> m_hangingDurations;
+		std::map<int, int>    m_openIndexes;
+
+		// Lock for addLink() and addHanging() during parallel analyses:
+		std::mutex*           m_mutex = NULL;
+};
+
+
+// END_MERGE
+
+} // end namespace hum
+
+#endif /* _HUMSPANTABLE_H_INCLUDED */
+
+
+
@@ -0,0 +1,105 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 12:24:31 PDT 2026
+// Last Modified: Sun Oct 18 23:59:55 PDT 2026
+// Filename:      HumStrandTable.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/include/HumStrandTable.h
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   The tokens of each spine strand of a file stored in
+//                contiguous arrays, filled in by
+//                HumdrumFileContent::analyzeStrandTable().
+//
+
+#ifndef _HUMSTRANDTABLE_H_INCLUDED
+#define _HUMSTRANDTABLE_H_INCLUDED
+
+#include "HumNum.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace hum {
+
+class HumdrumToken;
+typedef HumdrumToken* HTp;
+
+// START_MERGE
+
+// HumStrandTable: the tokens of each spine strand of a file stored in
+// contiguous arrays, filled in by HumdrumFileContent::analyzeStrandTable().
+// Strands are numbered as in HumdrumFileStructure::getStrandStart(): by
+// spine, then by starting line, where each subspine created by a spine
+// split is a separate strand.  The entries of a strand are its tokens from
+// the start to the end of the strand in line order, and the entries of
+// strand s are numbered from getStrandOffset(s) up to getStrandOffset(s) +
+// getStrandSize(s) - 1, so a strand can be processed with a loop over its
+// entries rather than by following getNextToken().  Each entry stores the
+// line and field of its token, the start time of the token (quarter notes
+// from the start of the file) and the strophe that contains it (see
+// HumdrumToken::getStrophe()), where strophes are numbered in the order
+// that they are first found in the strands.
+// The table is not changed after it is filled, so several threads can
+// read different strands at the same time.
+
+class HumStrandTable {
+	public:
+		             HumStrandTable     (void);
+		void         clear              (void);
+		void         setLineCount       (int lineCount);
+		int          addStrand          (int spine);
+		int          addToken           (HTp token);
+
+		int          getLineCount       (void) const;
+		int          getStrandCount     (void) const;
+		int          getStrandOffset    (int strand) const;
+		int          getStrandSize      (int strand) const;
+		int          getStrandSpine     (int strand) const;
+		int          getStrandTrack     (int strand) const;
+
+		int          getEntryCount      (void) const;
+		HTp          getToken           (int entry) const;
+		int          getLine            (int entry) const;
+		int          getField           (int entry) const;
+		HumNum       getStartTime       (int entry) const;
+		int          getStrophe         (int entry) const;
+		int          getStropheCount    (void) const;
+		HTp          getStropheStart    (int strophe) const;
+		bool         isData             (int entry) const;
+		bool         isNull             (int entry) const;
+
+	private:
+		int                   m_lineCount = 0;
+
+		// Strand arrays (indexed by strand):
+		std::vector<int>      m_offsets;      // first entry of strand
+		std::vector<int>      m_spines;       // spine index of strand
+		std::vector<int>      m_tracks;       // track of strand
+
+		// Entry arrays (indexed by entry):
+		std::vector<HTp>      m_tokens;
+		std::vector<int>      m_lines;
+		std::vector<int>      m_fields;
+		std::vector<HumNum>   m_startTimes;
+		std::vector<int>      m_strophes;     // strophe index (-1 if none)
+		std::vector<uint8_t>  m_types;        // TYPE_DATA and TYPE_NULL bits
+
+		// Strophe arrays (indexed by strophe):
+		std::vector<HTp>      m_stropheStarts; // *S/ token starting strophe
+
+		enum {
+			TYPE_DATA = 1,
+			TYPE_NULL = 2
+		};
+};
+
+
+// END_MERGE
+
+} // end namespace hum
+
+#endif /* _HUMSTRANDTABLE_H_INCLUDED */
+
+
+
@@ -0,0 +1,100 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 21:31:12 PDT 2026
+// Last Modified: Sun Oct 18 21:31:16 PDT 2026
+// Filename:      HumTextIndex.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/include/HumTextIndex.h
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Inverted index of the words in the lyrics of a corpus.
+//
+
+#ifndef _HUMTEXTINDEX_H_INCLUDED
+#define _HUMTEXTINDEX_H_INCLUDED
+
+#include "HumdrumFile.h"
+
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace hum {
+
+// START_MERGE
+
+// HumTextPosting: one occurrence of a word in a HumTextIndex.
+
+class HumTextPosting {
+	public:
+		int file     = 0;  // index of the file in the text index
+		int line     = 0;  // line index of the first syllable of the word
+		int field    = 0;  // field index of the first syllable of the word
+		int track    = 0;  // track of the lyric spine
+		int spine    = 0;  // lyric spine in the file (see HumTextTable)
+		int position = 0;  // position of the word in the spine
+		int notes    = 0;  // number of notes attacked on the word
+};
+
+
+// HumTextIndex: an inverted index of the words in the lyrics of a corpus of
+// files, so that text queries do not need to parse the files again.  Words
+// are taken from the text table of each file (see HumTextTable) and indexed
+// by their normalized form.  A word containing spaces is indexed under
+// each part, with consecutive positions, so that phrases can be found by
+// searching for consecutive positions in a spine.  Indexes of parts of a
+// corpus can be built separately (such as on different threads) and joined
+// in order with append().  The text form of an index (write() and read()):
+//
+//    !!!HUMTEXTINDEX: 1
+//    @file <TAB> filename                   (one line for each file)
+//    word <TAB> posting <TAB> posting ...   (one line for each word)
+//
+// where each posting is "file:line:field:track:spine:position:notes"
+// (indexes from 0).
+
+class HumTextIndex {
+	public:
+		                   HumTextIndex  (void);
+		void               clear         (void);
+		int                addFile       (HumdrumFile& infile,
+		                                  const std::string& filename);
+		void               append        (const HumTextIndex& index);
+
+		int                getFileCount  (void) const;
+		const std::string& getFilename   (int file) const;
+		int                getWordCount  (void) const;
+		void               getWordList   (std::vector<std::string>& words) const;
+		const std::vector<HumTextPosting>* find(const std::string& word) const;
+		int                search        (std::vector<HumTextPosting>& matches,
+		                                  const std::string& query,
+		                                  bool prefix = false) const;
+
+		bool               write         (std::ostream& out) const;
+		bool               writeFile     (const std::string& filename) const;
+		bool               read          (std::istream& in);
+		bool               readFile      (const std::string& filename);
+
+	protected:
+		void               getPostings   (std::vector<HumTextPosting>& postings,
+		                                  const std::string& word,
+		                                  bool prefix) const;
+		static bool        isBefore      (const HumTextPosting& a,
+		                                  const HumTextPosting& b);
+
+	private:
+		std::vector<std::string> m_files;
+		std::map<std::string, std::vector<HumTextPosting>> m_words;
+};
+
+
+// END_MERGE
+
+} // end namespace hum
+
+#endif /* _HUMTEXTINDEX_H_INCLUDED */
+
+
+
@@ -0,0 +1,111 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 12:24:31 PDT 2026
+// Last Modified: Sun Oct 18 23:59:55 PDT 2026
+// Filename:      HumTextTable.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/include/HumTextTable.h
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   The syllables of the lyric spines of a file assembled into
+//                words, filled in by HumdrumFileContent::analyzeText().
+//
+
+#ifndef _HUMTEXTTABLE_H_INCLUDED
+#define _HUMTEXTTABLE_H_INCLUDED
+
+#include "HumNum.h"
+
+#include <string>
+#include <vector>
+
+namespace hum {
+
+class HumdrumToken;
+typedef HumdrumToken* HTp;
+
+// START_MERGE
+
+// HumTextTable: the syllables of the lyric spines of a file (**text,
+// **silbe, **sylb and **sylba) assembled into words, filled in by
+// HumdrumFileContent::analyzeText().  A syllable starting with "-"
+// continues the previous word in its spine, and other syllables start a
+// new word.  Each syllable is linked to the notes of the first **kern spine
+// to the left of its spine: the melisma of the syllable is the number of
+// note attacks from its line up to the line of the next syllable (or the
+// end of the lyric spine), and its end time is the end of the last of these
+// notes (including tied notes).
+// Spines are numbered in the order of the file, and the syllables and
+// words of each spine are numbered consecutively in line order.
+
+class HumTextTable {
+	public:
+		             HumTextTable          (void);
+		void         clear                 (void);
+		void         setLineCount          (int lineCount);
+		int          addSpine              (HTp start);
+		int          addSyllable           (int spine, HTp token);
+		void         setNotes              (int syllable, int count, HTp first,
+		                                    HTp last, HumNum endtime);
+
+		int          getLineCount          (void) const;
+		int          getSpineCount         (void) const;
+		HTp          getSpineStart         (int spine) const;
+		int          getSpineSyllableStart (int spine) const;
+		int          getSpineSyllableCount (int spine) const;
+		int          getSpineWordStart     (int spine) const;
+		int          getSpineWordCount     (int spine) const;
+
+		int          getSyllableCount      (void) const;
+		HTp          getSyllableToken      (int syllable) const;
+		int          getSyllableSpine      (int syllable) const;
+		int          getSyllableWord       (int syllable) const;
+		int          getNoteCount          (int syllable) const;
+		HTp          getFirstNote          (int syllable) const;
+		HTp          getLastNote           (int syllable) const;
+		HumNum       getEndTime            (int syllable) const;
+
+		int          getWordCount          (void) const;
+		const std::string& getWordText     (int word) const;
+		const std::string& getNormalizedWord(int word) const;
+		HTp          getWordToken          (int word) const;
+		int          getWordSpine          (int word) const;
+		int          getWordSyllableStart  (int word) const;
+		int          getWordSyllableCount  (int word) const;
+		int          getWordNoteCount      (int word) const;
+
+		static std::string normalize       (const std::string& text);
+
+	private:
+		int                      m_lineCount = 0;
+
+		// Spine arrays (indexed by spine):
+		std::vector<HTp>         m_spineStarts;
+		std::vector<int>         m_spineSyllables; // first syllable of spine
+		std::vector<int>         m_spineWords;     // first word of spine
+
+		// Syllable arrays (indexed by syllable):
+		std::vector<HTp>         m_syllables;      // token of syllable
+		std::vector<int>         m_syllableWords;  // word containing syllable
+		std::vector<int>         m_noteCounts;     // melisma (attacks)
+		std::vector<HTp>         m_firstNotes;     // first note of syllable
+		std::vector<HTp>         m_lastNotes;      // last note of syllable
+		std::vector<HumNum>      m_endTimes;       // end of last note
+
+		// Word arrays (indexed by word):
+		std::vector<std::string> m_words;          // syllables without hyphens
+		std::vector<std::string> m_normalized;     // see normalize()
+		std::vector<int>         m_wordSpines;
+		std::vector<int>         m_wordSyllables;  // first syllable of word
+		std::vector<int>         m_wordNotes;      // total melisma of word
+};
+
+
+// END_MERGE
+
+} // end namespace hum
+
+#endif /* _HUMTEXTTABLE_H_INCLUDED */
+
+
+
@@ -0,0 +1,72 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 14:02:11 PDT 2026
+// Last Modified: Sun Oct 18 14:02:15 PDT 2026
+// Filename:      HumTokenLinks.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/include/HumTokenLinks.h
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   List of links from a token to the next or previous
+//                tokens in a spine.  Nearly all tokens have exactly one
+//                link in each direction, so a single link is stored inside
+//                of the object, and only spine splits and merges need to
+//                allocate memory for the list.
+//
+
+#ifndef _HUMTOKENLINKS_H_INCLUDED
+#define _HUMTOKENLINKS_H_INCLUDED
+
+#include <vector>
+
+namespace hum {
+
+class HumdrumToken;
+typedef HumdrumToken* HTp;
+
+// START_MERGE
+
+class HumTokenLinks {
+	public:
+		             HumTokenLinks  (void);
+		             HumTokenLinks  (const HumTokenLinks& links);
+		            ~HumTokenLinks  ();
+
+		HumTokenLinks& operator=    (const HumTokenLinks& links);
+		HTp          operator[]     (int index) const { return data()[index]; }
+		HTp&         operator[]     (int index) { return data()[index]; }
+		int          size           (void) const { return m_size; }
+		bool         empty          (void) const { return m_size == 0; }
+		HTp          back           (void) const { return data()[m_size-1]; }
+		void         clear          (void) { m_size = 0; }
+		void         resize         (int newsize);
+		void         push_back      (HTp token);
+		std::vector<HTp> toVector   (void) const;
+
+	protected:
+		const HTp*   data           (void) const
+		                            { return m_capacity > 1 ? m_list : &m_single; }
+		HTp*         data           (void)
+		                            { return m_capacity > 1 ? m_list : &m_single; }
+		void         reserve        (int capacity);
+
+	private:
+		// The link is stored directly in m_single when the capacity is 1,
+		// otherwise the links are stored in the array m_list.
+		union {
+			HTp  m_single;
+			HTp* m_list;
+		};
+		int m_size;
+		int m_capacity;
+};
+
+
+// END_MERGE
+
+} // end namespace hum
+
+#endif /* _HUMTOKENLINKS_H_INCLUDED */
+
+
+
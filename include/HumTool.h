@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Nov 28 08:55:15 PST 2016
-// Last Modified: Mon Nov 28 08:55:38 PST 2016
+// Last Modified: Sun Oct 18 18:10:19 PDT 2026
 // Filename:      HumTool.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/HumTool.h
 // Syntax:        C++11; humlib
@@ -15,6 +15,7 @@
 
 #include "Options.h"
 #include "HumdrumFileSet.h"
+#include "HumOutputSink.h"
 
 #include <sstream>
 #include <string>
@@ -56,6 +57,12 @@ class HumTool : public Options {
 		std::ostream& getError        (std::ostream& out);
 		void          setError        (const std::string& message);
 
+		void          setOutputSink   (HumOutputSink* sink);
+		void          setHumdrumSink  (HumOutputSink* sink);
+		void          setJsonSink     (HumOutputSink* sink);
+		void          setFreeTextSink (HumOutputSink* sink);
+		void          clearOutputSinks(void);
+
 		virtual void  finally         (void) { };
 
 	protected:
@@ -67,6 +74,28 @@ class HumTool : public Options {
 
 		bool m_suppress = false;
 
+	private:
+		static bool   hasStreamText   (std::stringstream& stream);
+		static void   printStreamText (std::ostream& out,
+		                               std::stringstream& stream);
+		static void   attachSink      (std::stringstream& stream,
+		                               HumOutputSink* sink,
+		                               HumOutputSink*& current,
+		                               size_t& start);
+		static bool   hasSinkText     (HumOutputSink* sink, size_t start);
+
+		// Sinks which receive the Humdrum, JSON and free text output
+		// instead of the stringstreams above (NULL if not used).  The
+		// byte count of each sink when it was attached (or when
+		// clearOutput() was last called) is used to check whether the
+		// tool has written anything to it.
+		HumOutputSink* m_humdrum_sink = NULL;
+		HumOutputSink* m_json_sink    = NULL;
+		HumOutputSink* m_free_sink    = NULL;
+		size_t m_humdrum_sink_start   = 0;
+		size_t m_json_sink_start      = 0;
+		size_t m_free_sink_start      = 0;
+
 };
 
 
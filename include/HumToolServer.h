@@ -0,0 +1,148 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 17:31:08 PDT 2026
+// Last Modified: Sun Oct 18 23:59:31 PDT 2026
+// Filename:      HumToolServer.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/include/HumToolServer.h
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Long-running service that runs Humdrum tools on requests
+//                read from a stream (such as standard input or a local
+//                socket).  Requests are processed concurrently by a pool
+//                of worker threads.  A few tools which have been checked
+//                to reset their state on each run are kept between
+//                requests, so that option parsing and setup are not
+//                repeated for every file; other tools are made new for
+//                each request.
+//
+//                Requests and responses are framed by a block of
+//                "key: value" header lines followed by an empty line.
+//                A request looks like this:
+//
+//                   id: 12
+//                   tool: transpose
+//                   options: -k e-
+//                   length: 1234
+//
+//                   <1234 bytes of Humdrum data>
+//
+//                and the response to it:
+//
+//                   id: 12
+//                   status: ok
+//                   humdrum-length: 1300
+//                   json-length: 0
+//                   text-length: 0
+//                   warning-length: 0
+//                   error-length: 0
+//
+//                   <humdrum text><json text><free text><warning><error>
+//
+//                Responses are written as soon as each request finishes, so
+//                they may arrive in a different order than the requests;
+//                use the id to match them up.  When the queue of requests
+//                waiting for a worker thread is full, no more requests are
+//                read until a worker is free.
+//
+
+#ifndef _HUMTOOLSERVER_H_INCLUDED
+#define _HUMTOOLSERVER_H_INCLUDED
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hum {
+
+// START_MERGE
+
+class HumToolRequest {
+	public:
+		std::string id;      // identifier copied into the response
+		std::string tool;    // tool name, such as "transpose"
+		std::string options; // command-line options for the tool
+		std::string input;   // Humdrum data to process
+};
+
+
+class HumToolResponse {
+	public:
+		std::string id;
+		bool        status = true;  // false if the request failed
+		std::string humdrum;        // output data in Humdrum syntax
+		std::string json;           // output data in JSON syntax
+		std::string text;           // free-text output
+		std::string warning;
+		std::string error;
+};
+
+
+class HumToolServer {
+	public:
+		                  HumToolServer   (void);
+		                  HumToolServer   (int threads);
+		                 ~HumToolServer   ();
+
+		void              setThreadCount  (int threads);
+		int               getThreadCount  (void);
+		void              setQueueSize    (int size);
+		int               getQueueSize    (void);
+
+		bool              serve           (std::istream& input,
+		                                   std::ostream& output);
+		bool              run             (const HumToolRequest& request,
+		                                   HumToolResponse& response);
+
+		static bool       hasTool         (const std::string& name);
+		static std::vector<std::string> getToolNames(void);
+
+		static int        readRequest     (std::istream& input,
+		                                   HumToolRequest& request,
+		                                   std::string& error);
+		static std::ostream& writeRequest (std::ostream& output,
+		                                   const HumToolRequest& request);
+		static int        readResponse    (std::istream& input,
+		                                   HumToolResponse& response,
+		                                   std::string& error);
+		static std::ostream& writeResponse(std::ostream& output,
+		                                   const HumToolResponse& response);
+
+	protected:
+		void              startWorkers    (void);
+		void              stopWorkers     (void);
+		void              workerLoop      (void);
+		void              addJob          (std::function<void(void)> job);
+
+	private:
+		// m_threadCount: number of worker threads (0 = number of cores).
+		int m_threadCount = 0;
+
+		// m_workers: threads that process the requests in m_jobs.
+		std::vector<std::thread> m_workers;
+
+		// m_queueSize: maximum number of jobs waiting for a worker thread
+		// (0 = four jobs for each worker thread).
+		int m_queueSize = 0;
+
+		std::deque<std::function<void(void)>> m_jobs;
+		std::mutex              m_jobMutex;
+		std::condition_variable m_jobSignal;
+		std::condition_variable m_queueSignal;
+		bool                    m_stopQ = false;
+};
+
+
+// END_MERGE
+
+} // end namespace hum
+
+#endif /* _HUMTOOLSERVER_H_INCLUDED */
+
+
+
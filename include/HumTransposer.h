@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Tue Dec 03 11:28:21 PDT 2019
-// Last Modified: Thu Jun 18 17:47:07 PDT 2020
+// Last Modified: Sun Oct 18 23:59:59 PDT 2026
 // Filename:      HumHumTransposer.h
 // URL:           https://github.com/craigsapp/hum2ly/blob/master/include/HumHumTransposer.h
 // Related:       https://github.com/rism-ch/verovio/blob/develop/include/vrv/transposition.h
@@ -67,6 +67,13 @@ class HumTransposer {
 		void        transpose            (HumPitch &pitch, int transVal);
 		void        transpose            (HumPitch &pitch, const std::string &transString);
 
+		// Bulk transposition of **kern data with a lookup table for the stored
+		// transposition interval.  The table is rebuilt automatically when the
+		// interval or the base changes.
+		void        prepareKernTable     (void);
+		const std::string& getKernTablePitch (int ipitch);
+		bool        transposeKernToken   (std::string &token);
+
 		// Convert between integer intervals and interval name strings:
 		std::string getIntervalName      (const HumPitch &p1, const HumPitch &p2);
 		std::string getIntervalName      (int intervalClass);
@@ -153,8 +160,14 @@ class HumTransposer {
 		// used to calculate semitones between diatonic pitch classes:
 		static const std::vector<int> m_diatonic2semitone;
 
+		// transposed **kern pitches indexed by integer pitch (see prepareKernTable):
+		std::vector<std::string> m_kernTable;
+		int m_kernTableBase = 0;
+		int m_kernTableTranspose = 0;
+
 	private:
 		void calculateDiatonicMapping(void);
+		bool transposeKernSubtoken(std::string &token, size_t start, size_t end);
 };
 
 
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
-// Last Modified: Thu Jun 13 08:38:17 CEST 2019
+// Last Modified: Sun Oct 18 23:59:50 PDT 2026
 // Filename:      HumdrumFileBase.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/HumdrumFileBase.h
 // Syntax:        C++11; humlib
@@ -93,65 +93,80 @@ class TokenPair {
 };
 
 
-// HumFileAnalysis: class used to manage analysis states for a Humdrum file.
+// HumFileAnalysis: registry of the analysis passes which have been run
+// on a Humdrum file.  Each pass declares the passes that it depends on
+// (see HumFileAnalysis::getDependencies() in HumdrumFileBase.cpp), and
+// invalidating a pass also invalidates all passes which depend on it.
+// The structure passes (PASS_STRANDS to PASS_RHYTHM) are run when the
+// file is read, and the content passes are run on demand by
+// HumdrumFileContent::requireAnalysis().  All content passes are
+// invalidated by HumdrumFileBase::createLinesFromTokens(), since the
+// tokens have usually been changed when it is called.
 
 class HumFileAnalysis {
 	public:
-		HumFileAnalysis(void) {}
+		enum Pass {
+			// Structure passes (HumdrumFileStructure):
+			PASS_STRANDS = 0,     // spine strands
+			PASS_NULLS,           // null token resolution
+			PASS_STROPHES,        // strophe markers
+			PASS_STRUCTURE,       // global/local parameters, token durations
+			PASS_RHYTHM,          // rhythmic positions of lines
+
+			// Content passes (HumdrumFileContent):
+			PASS_TOKEN_INDEX,     // token ids of the analysis tables
+			PASS_OTTAVAS,         // ottava marks ("auto" ottava parameters)
+			PASS_KERN_ACCIDENTALS,
+			PASS_MENS_ACCIDENTALS,
+			PASS_SLURS,
+			PASS_BEAMS,
+			PASS_PHRASES,
+			PASS_TIES,
+			PASS_BARLINES,        // barline differences between staves
+			PASS_MEASURES,        // measure index
+			PASS_REST_POSITIONS,
+			PASS_NULL_TABLE,      // null-token resolution table
+			PASS_SONORITIES,      // sounding pitches on each data line
+			PASS_METRIC_GRID,     // metric positions of data lines
+			PASS_TEXT,            // lyric syllables, words and melismas
+			PASS_STRAND_TABLE,    // tokens of each strand in contiguous arrays
+
+			PASS_COUNT
+		};
+
+		HumFileAnalysis(void) { clear(); }
 		~HumFileAnalysis() { clear(); }
 		void clear(void) {
-			m_structure_analyzed = false;
-			m_rhythm_analyzed    = false;
-			m_strands_analyzed   = false;
-			m_slurs_analyzed     = false;
-			m_beams_analyzed     = false;
-			m_phrases_analyzed   = false;
-			m_nulls_analyzed     = false;
-			m_strophes_analyzed  = false;
-
-			m_barlines_analyzed  = false;
+			m_done = 0;
+			m_version++;
 			m_barlines_different = false;
 		}
+		bool isDone(Pass pass) const { return (m_done >> pass) & 1; }
+		void setDone(Pass pass, bool state = true) {
+			if (state) {
+				m_done |= (1u << pass);
+			} else {
+				m_done &= ~(1u << pass);
+			}
+		}
+		void invalidate(Pass pass);
+		void invalidateContent(void);
+		int  getVersion(void) const { return m_version; }
+		static unsigned int getDependencies(Pass pass);
 
-		// m_structure_analyzed: Used to keep track of whether or not
-		// file structure has been analyzed.
-		bool m_structure_analyzed = false;
-
-		// m_rhythm_analyzed: Used to keep track of whether or not
-		// rhythm structure has been analyzed.
-		bool m_rhythm_analyzed = false;
-
-		// m_strands_analyzed: Used to keep track of whether or not
-		// file strands have been analyzed.
-		bool m_strands_analyzed = false;
-
-		// m_strophes_analyzed: Used to keep track of whether or not
-		// file strands have been analyzed.
-		bool m_strophes_analyzed = false;
-
-		// m_slurs_analyzed: Used to keep track of whether or not
-		// slur endpoints have been linked or not.
-		bool m_slurs_analyzed = false;
-
-		// m_phrases_analyzed: Used to keep track of whether or not
-		// phrase endpoints have been linked or not.
-		bool m_phrases_analyzed = false;
-
-		// m_beams_analyzed: Used to keep track of whether or not
-		// beam endpoints have been linked or not.
-		bool m_beams_analyzed = false;
-
-		// m_nulls_analyzed: Used to keep track of wheter or not
-		// null tokens have been analyzed yet.
-		bool m_nulls_analyzed = false;
-
-		// m_barlines_analyzed: Used to keep track of wheter or not
-		// barlines have beena analyzed yet.
-		bool m_barlines_analyzed = false;
 		// m_barlines_different: Set to true when the file contains
 		// any barlines that are not all of the same at the same
-		// times.
+		// times (result of PASS_BARLINES).
 		bool m_barlines_different = false;
+
+	private:
+		// m_done: bitmask of the passes which have been run since
+		// the last invalidation.
+		unsigned int m_done = 0;
+
+		// m_version: incremented each time analysis results are
+		// invalidated.
+		int m_version = 0;
 };
 
 bool sortTokenPairsByLineIndex(const TokenPair& a, const TokenPair& b);
@@ -379,7 +394,7 @@ class HumdrumFileBase : public HumHash {
 		bool          stitchLinesTogether       (HumdrumLine& previous,
 		                                         HumdrumLine& next);
 		void          addToTrackStarts          (HTp token);
-		void          addUniqueTokens           (std::vector<HTp>& target,
+		void          addUniqueTokens           (HumTokenLinks& target,
 		                                         std::vector<HTp>& source);
 		bool          processNonNullDataTokensForTrackForward(HTp starttoken,
 		                                         std::vector<HTp> ptokens);
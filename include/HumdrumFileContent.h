@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Aug 17 02:39:28 PDT 2015
-// Last Modified: Fri Dec  6 19:27:27 PST 2019
+// Last Modified: Sun Oct 18 23:59:50 PDT 2026
 // Filename:      HumdrumFileContent.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/HumdrumFileContent.h
 // Syntax:        C++11; humlib
@@ -14,10 +14,16 @@
 #ifndef _HUMDRUMFILECONTENT_H_INCLUDED
 #define _HUMDRUMFILECONTENT_H_INCLUDED
 
+#include "HumAnalysisTables.h"
+#include "HumMetricTable.h"
+#include "HumStrandTable.h"
+#include "HumTextTable.h"
 #include "HumdrumFileStructure.h"
 
 #include <iostream>
 #include <cmath>
+#include <functional>
+#include <map>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -27,6 +33,39 @@ namespace hum {
 
 // START_MERGE
 
+// HumMeasureInfo: entry in the measure index of a HumdrumFileContent
+// (see HumdrumFileContent-measure.cpp).
+
+class HumMeasureInfo {
+	public:
+		HumMeasureInfo(void) { clear(); }
+		void clear(void) {
+			number = -1;
+			startline = stopline = -1;
+			clef.clear(); keysig.clear(); key.clear();
+			timesig.clear(); met.clear(); tempo.clear();
+			subtracks.clear();
+		}
+
+		int number;             // measure number (0 for pickup measure)
+		int startline;          // starting barline (first data line for pickup)
+		int stopline;           // ending barline (or terminator line)
+
+		// Active spine layout at the start of the measure: the number of
+		// subspines for each track (indexed by track number).
+		std::vector<int> subtracks;
+
+		// Prevailing interpretations at the start of the measure,
+		// indexed by track number (NULL if none).
+		std::vector<HTp> clef;
+		std::vector<HTp> keysig;
+		std::vector<HTp> key;
+		std::vector<HTp> timesig;
+		std::vector<HTp> met;
+		std::vector<HTp> tempo;
+};
+
+
 class HumdrumFileContent : public HumdrumFileStructure {
 	public:
 		       HumdrumFileContent         (void);
@@ -34,16 +73,41 @@ class HumdrumFileContent : public HumdrumFileStructure {
 		       HumdrumFileContent         (std::istream& contents);
 		      ~HumdrumFileContent         ();
 
+		// Each analysis is run once for each version of the file, and
+		// later calls return without analyzing again.  After changing
+		// tokens, call createLinesFromTokens() or invalidateAnalysis() so
+		// that the next call analyzes the new contents.
 		bool   analyzeSlurs               (void);  // in src/HumdrumFileContents-slur.cpp
 		bool   analyzeBeams               (void);  // in src/HumdrumFileContents-beam.cpp
 		bool   analyzePhrasings           (void);
 		bool   analyzeTextRepetition      (void);
+		bool   analyzeText                (void);
+		const HumTextTable& getTextTable  (void);
 		bool   analyzeKernTies            (void);
 		bool   analyzeAccidentals         (void);
 		bool   analyzeKernAccidentals     (const std::string& dataType = "**kern");
 		bool   analyzeMensAccidentals     (void);
 		bool   analyzeRScale              (void);
 
+		// Analysis pass registry: run a pass and its dependencies if needed.
+		bool   requireAnalysis            (HumFileAnalysis::Pass pass);
+		bool   isAnalyzed                 (HumFileAnalysis::Pass pass) const;
+		void   invalidateAnalysis         (HumFileAnalysis::Pass pass);
+
+		// Typed analysis results (accidentals, slurs, beams, rest positions).
+		// The analyses also store their results as strings in the "auto"
+		// HumHash namespace of each token unless setAnalysisHashValues(false)
+		// is called before running them.
+		HumAnalysisTables& getAnalysisTables(void);
+		void   setAnalysisHashValues      (bool state);
+		bool   getAnalysisHashValues      (void) const;
+
+		// Slur, beam and accidental analyses can analyze each spine in a
+		// separate thread (default 1 for serial analysis; 0 for the number
+		// of cores).
+		void   setAnalysisThreadCount     (int count);
+		int    getAnalysisThreadCount     (void) const;
+
 		// in HumdrumFileContent-hand.cpp
 		bool   doHandAnalysis             (bool attacksOnlyQ = false);
 		bool   doHandAnalysis             (HTp startSpine, bool attacksOnlyQ = false);
@@ -54,6 +118,7 @@ class HumdrumFileContent : public HumdrumFileStructure {
 		// in HumdrumFileContent-midi.cpp
 		void fillMidiInfo(std::vector<std::vector<std::vector<std::pair<HTp, int>>>>& trackMidi);
 		void processStrandNotesForMidi(HTp sstart, HTp send, std::vector<std::vector<std::pair<HTp, int>>>& trackInfo);
+		void processStrandNotesForMidi(int strand, std::vector<std::vector<std::pair<HTp, int>>>& trackInfo);
 
 		// in HumdrumFileContent-rest.cpp
 		void  analyzeRestPositions                  (void);
@@ -64,6 +129,12 @@ class HumdrumFileContent : public HumdrumFileStructure {
 		bool analyzeKernStemLengths       (void);
 
 		// in HumdrumFileContent-metlev.cpp
+		bool  analyzeMetricGrid           (void);
+		const HumMetricTable& getMetricGrid(void);
+
+		// in HumdrumFileContent-strand.cpp
+		bool  analyzeStrandTable          (void);
+		const HumStrandTable& getStrandTable(void);
 		void  getMetricLevels             (std::vector<double>& output, int track = 0,
 		                                   double undefined = NAN);
 		// in HumdrumFileContent-timesig.cpp
@@ -110,6 +181,26 @@ class HumdrumFileContent : public HumdrumFileStructure {
 		bool   hasDifferentBarlines       (void);
 		bool   hasDataStraddle            (int line);
 
+		// in HumdrumFileContent-null.cpp
+		bool   analyzeNullResolution      (void);
+		HTp    getResolvedToken           (int line, int field);
+		bool   getResolvedPosition        (int line, int field, int& rline,
+		                                   int& rfield);
+		int    getAttackLine              (int line, int field);
+
+		// in HumdrumFileContent-sonority.cpp
+		bool   analyzeSonorities          (void);
+		const HumSonorityTable& getSonorities(void);
+		HumSonority getSonority           (int line);
+
+		// in HumdrumFileContent-measure.cpp
+		bool   analyzeMeasureIndex        (void);
+		int    getMeasureIndexCount       (void);
+		const HumMeasureInfo& getMeasureIndexEntry(int index);
+		int    getMeasureIndexForNumber   (int number);
+		int    getMeasureIndexForLine     (int line);
+		int    getBarNumberForLine        (int line);
+
 	protected:
 
 		bool   analyzeKernPhrasings       (HTp spinestart,
@@ -125,6 +216,34 @@ class HumdrumFileContent : public HumdrumFileStructure {
 		                                   const std::string& keysig);
 		void   resetDiatonicStatesWithKeySignature(std::vector<int>& states,
 				                             std::vector<int>& signature);
+		void   analyzeKernAccidentals     (std::vector<int>& rtracks, int kcount,
+		                                   int part);
+		void   setAccidentalState         (int tokenid, HTp token, int subtoken,
+		                                   int flags);
+		HumAnalysisTables& prepareAnalysisTables(void);
+		void   indexAnalysisTables        (void);
+		bool   startAnalysis              (HumFileAnalysis::Pass pass);
+		void   addNotesForMidi            (HTp token,
+		                                   std::vector<std::vector<std::pair<HTp, int>>>& trackInfo);
+
+		// Parallel spine analyses (defined in src/HumdrumFileContent.cpp):
+		typedef bool (HumdrumFileContent::*SpineSpanAnalysis)(HTp spinestart,
+		                                   std::vector<HTp>& linkstarts,
+		                                   std::vector<HTp>& linkends,
+		                                   std::vector<std::pair<HTp, HTp>>& labels,
+		                                   std::vector<int>& endings,
+		                                   const std::string& linksig);
+		bool   useAnalysisThreads         (int count) const;
+		void   runAnalysisThreads         (int count,
+		                                   const std::function<void(int)>& analysis);
+		bool   analyzeSpineSpans          (SpineSpanAnalysis analysis,
+		                                   HumSpanTable& table,
+		                                   std::vector<HTp>& spinestarts,
+		                                   std::vector<HTp>& linkstarts,
+		                                   std::vector<HTp>& linkends,
+		                                   std::vector<std::pair<HTp, HTp>>& labels,
+		                                   std::vector<int>& endings,
+		                                   const std::string& linksig);
 
 		bool   analyzeKernPhrasings       (void);
 
@@ -169,6 +288,7 @@ class HumdrumFileContent : public HumdrumFileStructure {
 		int     getRestPositionBelowNotes (HTp rest, std::vector<int>& vpos);
 		void    setRestOnCenterStaffLine  (HTp rest, int baseline);
 		bool    checkRestForVerticalPositioning(HTp rest, int baseline);
+		void    storeRestPosition         (HTp rest, int pc, int oct);
 
 		// Stem lengths:
 		bool    analyzeKernStemLengths    (HTp stok, HTp etok, std::vector<std::vector<int>>& centerlines);
@@ -178,8 +298,55 @@ class HumdrumFileContent : public HumdrumFileStructure {
 		void    prepareStaffBelowNoteStems (HTp token);
 
 		void    getBaselines              (std::vector<std::vector<int>>& centerlines);
+		static double getMetricLevel      (HumNum position, HumNum pulse,
+		                                   bool compound, int bottom);
+		int     getSyllableNotes          (HTp syllable, int endline, HTp& first,
+		                                   HTp& last, HumNum& endtime);
 		void    createLinkedTies          (std::vector<std::pair<HTp, int>>& starts,
 		                                   std::vector<std::pair<HTp, int>>& ends);
+
+		// Measure index:
+		void    storeMeasureState         (HumMeasureInfo& info,
+		                                   std::vector<std::vector<HTp>>& states);
+
+	protected:
+		// m_measureIndex: list of numbered measures in the file, created
+		// by analyzeMeasureIndex().
+		std::vector<HumMeasureInfo> m_measureIndex;
+
+		// m_measureLines: index into m_measureIndex for each line
+		// in the file (-1 for lines outside of measures).
+		std::vector<int> m_measureLines;
+
+		// m_barNumbers: prevailing bar number for each line in the file.
+		std::vector<int> m_barNumbers;
+
+		// m_measureNumbers: first entry in m_measureIndex for each
+		// measure number.
+		std::map<int, int> m_measureNumbers;
+
+		// m_metricGrid: metric positions of data lines, created by
+		// analyzeMetricGrid().
+		HumMetricTable m_metricGrid;
+
+		// m_textTable: syllables and words of the lyric spines, created by
+		// analyzeText().
+		HumTextTable m_textTable;
+
+		// m_strandTable: tokens of each strand, created by
+		// analyzeStrandTable().
+		HumStrandTable m_strandTable;
+
+		// m_analysisTables: typed results of content analyses, indexed
+		// by token id.
+		HumAnalysisTables m_analysisTables;
+
+		// m_analysisHashValues: also store analysis results as "auto"
+		// parameters in the HumHash of each token.
+		bool m_analysisHashValues = true;
+
+		// m_analysisThreads: number of threads for parallel spine analyses.
+		int m_analysisThreads = 1;
 };
 
 
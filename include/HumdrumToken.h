@@ -15,6 +15,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -24,9 +25,12 @@ class HumParamSet;
 #include "HumAddress.h"
 #include "HumHash.h"
 #include "HumParamSet.h"
+#include "HumTokenLinks.h"
 
 namespace hum {
 
+class HumSpanTable;
+
 // START_MERGE
 
 
@@ -242,7 +246,7 @@ class HumdrumToken : public std::string, public HumHash {
 		bool     isMens                    (void) const;
 		bool     isMensLike                (void) const;
 		bool     isStaffLike               (void) const { return isKernLike() || isMensLike(); }
-		std::string   getSpineInfo         (void) const;
+		const std::string& getSpineInfo    (void) const;
 		int      getTrack                  (void) const;
 		int      getSpineIndex             (void) const;
 		int      getSubtrack               (void) const;
@@ -358,6 +362,7 @@ class HumdrumToken : public std::string, public HumHash {
 		void     setLineIndex              (int lineindex);
 		void     setFieldIndex             (int fieldlindex);
 		void     setSpineInfo              (const std::string& spineinfo);
+		void     setSpineInfo              (const std::shared_ptr<const std::string>& spineinfo);
 		void     setSubtrack               (int aSubtrack);
 		void     setSubtrackCount          (int count);
 		void     setPreviousToken          (HTp aToken);
@@ -372,6 +377,9 @@ class HumdrumToken : public std::string, public HumHash {
 		void     setStrandIndex            (int index);
 
 		bool     analyzeDuration           (void);
+		HumSpanTable* getSlurTable         (void);
+		HumSpanTable* getPhraseTable       (void);
+		int      getSlurTableId            (void);
 		std::ostream& printXmlBaseInfo     (std::ostream& out = std::cout, int level = 0,
 		                                    const std::string& indent = "\t");
 		std::ostream& printXmlContentInfo  (std::ostream& out = std::cout, int level = 0,
@@ -400,22 +408,22 @@ class HumdrumToken : public std::string, public HumHash {
 		// following token, but there can be two tokens if the current
 		// token is *^, and there will be zero following tokens after a
 		// spine terminating token (*-).
-		std::vector<HTp> m_nextTokens;     // link to next token(s) in spine
+		HumTokenLinks m_nextTokens;     // link to next token(s) in spine
 
 		// previousTokens: Simiar to nextTokens, but for the immediately
 		// follow token(s) in the data.  Typically there will be one
 		// preceding token, but there can be multiple tokens when the previous
 		// line has *v merge tokens for the spine.  Exclusive interpretations
 		// have no tokens preceding them.
-		std::vector<HTp> m_previousTokens; // link to last token(s) in spine
+		HumTokenLinks m_previousTokens; // link to last token(s) in spine
 
 		// nextNonNullTokens: This is a list of non-tokens in the spine
 		// that follow this one.
-		std::vector<HTp> m_nextNonNullTokens;
+		HumTokenLinks m_nextNonNullTokens;
 
 		// previousNonNullTokens: This is a list of non-tokens in the spine
 		// that preced this one.
-		std::vector<HTp> m_previousNonNullTokens;
+		HumTokenLinks m_previousNonNullTokens;
 
 		// rhycheck: Used to perfrom HumdrumFileStructure::analyzeRhythm
 		// recursively.
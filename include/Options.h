@@ -3,6 +3,7 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Apr  5 13:07:18 PDT 1998
 // Last Modified: Sat Mar  1 09:27:49 PST 2014 Implemented with STL.
+// Last Modified: Sun Oct 18 17:20:04 PDT 2026 Added setExitOnError().
 // Filename:      Options.h
 // Web Address:   https://github.com/craigsapp/humlib/blob/master/include/Options.h
 // Documentation: http://sig.sapp.org/doc/classes/Options
@@ -113,6 +114,7 @@ class Options {
 		                                   int suppress = 0);
 		void            xverify           (int error_check = 1,
 		                                   int suppress = 0);
+		void            setExitOnError    (bool state);
 		void            setFlag           (char aFlag);
 		void            setModified       (const std::string& optionName,
 		                                   const std::string& optionValue);
@@ -167,6 +169,12 @@ class Options {
 		// m_optionsArgument: indicate that --options was used.
 		bool m_optionsArgQ = false;
 
+		// m_exitQ: true means to exit the program when an unknown option
+		// is given (or to print the option list when --options is given).
+		// Set to false for programs which process more than one command,
+		// such as the humserver tool server.
+		bool m_exitQ = true;
+
 		// m_error: used to store errors in parsing command-line options.
 		std::stringstream m_error;
 
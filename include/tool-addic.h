@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Tue Sep 26 04:25:55 PDT 2023
-// Last Modified: Tue Sep 26 04:25:58 PDT 2023
+// Last Modified: Sun Oct 18 21:54:20 PDT 2026
 // Filename:      tool-addic.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-addic.h
 // Syntax:        C++11; humlib
@@ -47,7 +47,6 @@ class Tool_addic : public HumTool {
 		void     processFile       (HumdrumFile& infile);
 
 	private:
-		std::vector<std::pair<std::string, std::string>> m_instrumentList;
 		bool m_fixQ = false;  // used with -f option: fix incorrect instrument classes
 
 
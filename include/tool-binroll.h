@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Mar  4 21:15:15 PST 2018
-// Last Modified: Sun Mar  4 21:15:19 PST 2018
+// Last Modified: Sun Oct 18 20:47:03 PDT 2026
 // Filename:      tool-binroll.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-binroll.h
 // Syntax:        C++11; humlib
@@ -9,6 +9,23 @@
 //
 // Description:   Extract a binary pinao roll of note in a score.
 //
+// Binary format:  With the -b option, each input file is written as a
+//                32-byte header followed by the time steps of the roll.
+//                All numbers are little-endian:
+//                   bytes  0-7:  "HUMROLL1"
+//                   bytes  8-11: numerator of the duration of a time step
+//                                in quarter notes
+//                   bytes 12-15: denominator of the step duration
+//                   bytes 16-19: lowest MIDI key number in the roll
+//                   bytes 20-23: number of keys in the roll
+//                   bytes 24-31: number of time steps
+//                Each time step is then stored as two bit planes of
+//                (keys+7)/8 bytes: first the attack plane and then the
+//                sustain plane.  Bit k (byte k/8, bit k%8 from the lowest
+//                bit) of a plane is for the k-th key above the lowest key.
+//                An attack bit is the value 2 in the text output, and a
+//                sustain bit without an attack bit is the value 1.
+//
 
 #ifndef _TOOL_BINROLL_H
 #define _TOOL_BINROLL_H
@@ -17,6 +34,7 @@
 #include "HumNum.h"
 #include "HumdrumFile.h"
 
+#include <cstdint>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -25,6 +43,40 @@ namespace hum {
 
 // START_MERGE
 
+// PackedRoll: a piano roll stored as two bits for each key in each time
+// step (attack and sustain).  Only a window of time steps is stored:
+// removeSteps() discards the steps which have already been printed, so
+// the roll does not have to be kept in memory for the entire score.
+
+class PackedRoll {
+	public:
+		            PackedRoll      (void);
+		void        setKeyRange     (int low, int high);
+		int         getLowKey       (void) const { return m_low; }
+		int         getKeyCount     (void) const { return m_count; }
+		void        clear           (void);
+
+		void        addNote         (int key, int64_t start, int64_t end);
+		int         getValue        (int64_t step, int key) const;
+		void        writeStep       (std::ostream& out, int64_t step) const;
+		void        removeSteps     (int64_t end);
+
+	protected:
+		void        extend          (int64_t end);
+		uint64_t*   getStep         (int64_t step);
+		const uint64_t* getStep     (int64_t step) const;
+
+	private:
+		int                   m_low   = 0;   // lowest key in roll
+		int                   m_count = 128; // number of keys in roll
+		int                   m_words = 2;   // 64-bit words in a bit plane
+		int64_t               m_first = 0;   // time step of m_bits[0]
+		std::vector<uint64_t> m_bits;        // attack plane then sustain
+		                                     // plane for each time step
+};
+
+
+
 class Tool_binroll : public HumTool {
 	public:
 		         Tool_binroll      (void);
@@ -36,14 +88,21 @@ class Tool_binroll : public HumTool {
 		bool     run               (HumdrumFile& infile, std::ostream& out);
 
 	protected:
+		bool     initialize        (void);
 		void     processFile       (HumdrumFile& infile);
-		void     processStrand     (std::vector<std::vector<char>>& roll, HTp starting,
-		                            HTp ending);
-		void     printAnalysis     (HumdrumFile& infile,
-		                            std::vector<std::vector<char>>& roll);
+		void     processLine       (HumdrumLine& line);
+		void     printHeader       (HumdrumFile& infile, int count);
+		void     printTrailer      (HumdrumFile& infile);
+		void     printSteps        (int end);
+		void     printComment      (HumdrumLine& line);
+		void     writeInt          (uint64_t value, int bytes);
 
 	private:
-		HumNum    m_duration;
+		HumNum     m_duration;       // duration of a time step
+		PackedRoll m_roll;           // time steps which are not yet printed
+		int        m_printed = 0;    // next time step to print
+		bool       m_binaryQ = false;
+		bool       m_streamQ = false;
 
 };
 
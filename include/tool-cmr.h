@@ -2,7 +2,7 @@
 // Programmer:    Kiana Hu
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Feb 28 11:14:20 PST 2022
-// Last Modified: Sat Jul  2 16:43:26 PDT 2022
+// Last Modified: Sun Oct 18 12:20:31 PDT 2026
 // Filename:      tool-cmr.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-cmr.h
 // Syntax:        C++11; humlib
@@ -49,7 +49,8 @@ class cmr_note_info {
 		std::string   getPitch         (void);
 		HTp      getToken         (void);
 		int      getLineIndex     (void);
-		double   getNoteStrength  (void);
+		double   getNoteStrength  (double syncopationWeight = 1.0,
+		                           double leapWeight = 0.5);
 		bool     hasSyncopation   (void);
 		bool     hasLeapBefore    (void);
 		void     markNote         (const std::string& marker);
@@ -59,9 +60,6 @@ class cmr_note_info {
 		static bool   isSyncopated(HTp token);
 		static bool   isLeapBefore(HTp token);
 
-		static double m_syncopationWeight;
-		static double m_leapWeight;
-
 	private:
 		std::vector<HTp> m_tokens;    // List of tokens for the notes (first entry is note attack);
 
@@ -115,7 +113,8 @@ class cmr_group_info {
 		HumNum  getEndTime         (void);
 		HumNum  getGroupDuration   (void);
 		HumNum  getStartTime       (void);
-		double  getGroupStrength   (void);
+		double  getGroupStrength   (double syncopationWeight = 1.0,
+		                            double leapWeight = 0.5);
 		bool    mergeGroup         (cmr_group_info& group);
 		std::ostream& printNotes   (std::ostream& output = std::cout, const std::string& marker = "");
 
@@ -189,9 +188,13 @@ class Tool_cmr : public HumTool {
 		void             getPartNames            (std::vector<std::string>& partNames, HumdrumFile& infile);
 		void             checkForCmr             (int index, int direction, HumdrumFile& infile);
 		bool             hasHigher               (int pitch, int tolerance,
-		                                          std::vector<int>& midinums,
-		                                          std::vector<std::vector<HTp>>& notelist,
 		                                          int index1, int index2);
+		void             prepareRangeTables      (void);
+		void             buildRangeMaxTable      (std::vector<std::vector<int>>& table,
+		                                          std::vector<int>& values);
+		int              getRangeMax             (std::vector<std::vector<int>>& table,
+		                                          int index1, int index2);
+		void             updatePositiveLines     (cmr_group_info& group, int change);
 		bool             hasGroupUp              (void);
 		bool             hasGroupDown            (void);
 		void             getVocalRange           (std::vector<std::string>& minpitch,
@@ -269,12 +272,24 @@ class Tool_cmr : public HumTool {
 		// m_halfQ == report durations in half note (minims).
 		bool m_halfQ = false;
 
+		// m_syncopationWeight == strength added to syncopated notes.
+		double m_syncopationWeight = 1.0;
+
+		// m_leapWeight == strength added to notes preceded by a leap.
+		double m_leapWeight = 0.5;
+
 		// variables for doing CMR analysis (reset for each part)
 		std::vector<int>         m_midinums;      // MIDI note for first entry for teach tied group
 		std::vector<bool>        m_localpeaks;    // True if higher (or lower for negative search) than adjacent notes.
 		std::vector<double>      m_metlevs;       // True if higher (or lower for negative search) than adjacent notes.
 		std::vector<bool>        m_syncopation;   // True if note is syncopated.
 		std::vector<bool>        m_leapbefore;    // True if note has a leap before it.
+		std::vector<HumNum>      m_starttimes;    // Start time of each note in quarter notes.
+		std::vector<std::vector<int>> m_maxPitchTable;       // Range maximum table for m_midinums.
+		std::vector<std::vector<int>> m_maxStrongPitchTable; // Range maximum table for notes on strong beats.
+
+		// m_positiveLines == number of notes in positive CMR groups on each line.
+		std::vector<int>         m_positiveLines;
 
 		// Summary statistics variables:
 		std::vector<int>         m_cmrCount;       // number of CMRs in each input file
@@ -69,10 +69,10 @@ class Tool_deg : public HumTool {
 				int             getSubtokenCount         (void) const;
 
 				// output options:
-				static void     setShowTies    (bool state) { m_showTiesQ = state;  }
-				static void     setShowZeros   (bool state) { m_showZerosQ = state; }
-				static void     setShowOctaves (bool state) { m_octaveQ = state; }
-				static void     setForcedKey   (const std::string& key) { m_forcedKey = key; }
+				void            setShowTies    (bool state) { m_showTiesQ = state;  }
+				void            setShowZeros   (bool state) { m_showZerosQ = state; }
+				void            setShowOctaves (bool state) { m_octaveQ = state; }
+				void            setForcedKey   (const std::string& key) { m_forcedKeyQ = !key.empty(); }
 
 			protected:  // ScaleDegree class
 				std::string     generateDegDataToken     (void) const;
@@ -149,11 +149,11 @@ class Tool_deg : public HumTool {
 				ScaleDegree* m_prevRest = NULL;
 				ScaleDegree* m_nextRest = NULL;
 
-				// ScaleDegree rendering options:
-				static bool m_showTiesQ;
-				static bool m_showZerosQ;
-				static bool m_octaveQ;
-				static std::string m_forcedKey;
+				// ScaleDegree rendering options (set by Tool_deg::prepareDegSpine):
+				bool m_showTiesQ  = false;
+				bool m_showZerosQ = false;
+				bool m_octaveQ    = false;
+				bool m_forcedKeyQ = false;
 		};
 
 
@@ -250,6 +250,8 @@ class Tool_deg : public HumTool {
 		bool m_recipQ          = false;   // used with -r option
 		bool m_kernQ           = false;   // used with --kern option
 		bool m_degTiesQ        = false;   // used with -t option
+		bool m_degZerosQ       = false;   // used with -z option
+		bool m_degOctaveQ      = false;   // used with -o option
 		bool m_forceKeyQ       = false;   // used with -K option
 
 		std::string m_defaultKey  = "";    // used with --default-key option
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Nov 28 08:55:15 PST 2016
-// Last Modified: Mon Nov 28 08:55:38 PST 2016
+// Last Modified: Sun Oct 18 11:40:05 PDT 2026
 // Filename:      tool-dissonant.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-dissonant.h
 // Syntax:        C++11; humlib
@@ -17,6 +17,8 @@
 #include "HumdrumFile.h"
 #include "NoteGrid.h"
 
+#include <map>
+
 namespace hum {
 
 // START_MERGE
@@ -92,6 +94,15 @@ class Tool_dissonant : public HumTool {
 		void    addSuspensionMarkToNote(HTp start, const string& marks);
 		void    adjustSuspensionColors(HTp speinstart);
 
+		bool    runStatistics        (HumdrumFileSet& infiles);
+		void    prepareStatisticsLabels(void);
+		void    getStatistics        (HumdrumFile& infile, vector<int>& counts,
+		                              int& voices);
+		void    printStatisticsHeader(ostream& out);
+		void    printStatisticsLine  (ostream& out, const string& filename,
+		                              vector<int>& counts, int voices);
+		void    printStatisticsFooter(ostream& out);
+
 	private:
 		vector<HTp> m_kernspines;
 		bool diss2Q = false;
@@ -107,6 +118,11 @@ class Tool_dissonant : public HumTool {
 
 		vector<string> m_labels;
 
+		// --statistics columns:
+		vector<string>   m_statLabels; // unique dissonance labels
+		vector<bool>     m_statAgents; // true if column is for a suspension agent
+		map<string, int> m_statIndex;  // label to column index
+
 		// unaccdented non-harmonic tones:
 		const int PASSING_UP           =  0; // rising passing tone
 		const int PASSING_DOWN         =  1; // downward passing tone
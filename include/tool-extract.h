@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Dec  5 23:09:00 PST 2016
-// Last Modified: Wed Jul  3 21:00:27 CEST 2024
+// Last Modified: Sun Oct 18 10:12:44 PDT 2026
 // Filename:      tool-extract.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-extract.h
 // Syntax:        C++11; humlib
@@ -29,6 +29,7 @@ class Tool_extract : public HumTool {
 		bool     run                    (HumdrumFile& infile);
 		bool     run                    (const std::string& indata, std::ostream& out);
 		bool     run                    (HumdrumFile& infile, std::ostream& out);
+		bool     run                    (std::istream& input, std::ostream& out);
 
 	protected:
 
@@ -104,6 +105,19 @@ class Tool_extract : public HumTool {
 		                                 std::vector<int>& model, const std::string& searchstring,
 		                                 HumdrumFile& infile, int state);
 		void printInterpretationForKernSpine(HumdrumFile& infile, int index);
+		void    printManipulatorLine    (std::vector<std::string>& tempout,
+		                                 std::vector<int>& vserial,
+		                                 std::vector<int>& xserial);
+
+		// streaming functions (--stream option):
+		bool    processStreamLine       (const std::string& line,
+		                                 std::vector<std::string>& tokens);
+		bool    prepareStreamSegment    (const std::string& exinterps, int count);
+		void    printStreamFields       (std::vector<std::string>& tokens);
+		void    printStreamExcludedFields(std::vector<std::string>& tokens);
+		void    printStreamManipulatorFields(std::vector<std::string>& tokens);
+		void    updateStreamTracks      (std::vector<std::string>& tokens);
+		void    flushStreamOutput       (std::ostream& out);
 
 	private:
 
@@ -146,6 +160,9 @@ class Tool_extract : public HumTool {
 		bool        emptyQ      = false;     // used with --empty option
 		bool        spineListQ  = false;     // used with --spine option
 		bool        removerestQ = false;     // used with --no-rest option
+		std::vector<int> m_streamTracks;     // used with --stream option
+		int         m_streamMaxTrack = 0;    // used with --stream option
+		std::vector<std::string> m_streamInterps; // used with --stream option
 
 };
 
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Jul 29 11:38:01 CEST 2019
-// Last Modified: Sat Aug  3 17:48:04 EDT 2019
+// Last Modified: Sun Oct 18 19:20:44 PDT 2026
 // Filename:      tool-humdiff.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-humdiff.h
 // Syntax:        C++11; humlib
@@ -17,8 +17,10 @@
 #include "HumdrumFile.h"
 #include "HumdrumFileSet.h"
 
+#include <map>
 #include <ostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace hum {
@@ -90,6 +92,31 @@ class NotePoint {
 };
 
 
+// SliceSequence: the time points of a file, with an id for the note content
+// of each time point (its position in the measure, and the pitch and
+// duration of each note attacked there) and for each measure (the list of
+// its time point ids).  Equal ids mean equal content, so files can be
+// aligned by comparing ids.
+class SliceSequence {
+	public:
+		HumdrumFile*            file = NULL;
+		std::vector<TimePoint>  timepoints;
+		std::vector<int>        sliceids;      // content id of each time point
+		std::vector<int>        measureids;    // content id of each measure
+		std::vector<int>        measurestarts; // first time point of each measure
+		std::vector<HumNum>     measuretimes;  // start time of each measure
+
+		void clear(void) {
+			file = NULL;
+			timepoints.clear();
+			sliceids.clear();
+			measureids.clear();
+			measurestarts.clear();
+			measuretimes.clear();
+		}
+};
+
+
 // Function declarations:
 
 class Tool_humdiff : public HumTool {
@@ -110,9 +137,30 @@ class Tool_humdiff : public HumTool {
 		void     printNotePoints    (std::vector<NotePoint>& notelist);
 		void     markNote           (NotePoint& np);
 
+		// Alignment of files with inserted or deleted material (-a):
+		void     extractSlices      (SliceSequence& slices, HumdrumFile& infile);
+		int      getContentId       (std::map<std::vector<int>, int>& ids,
+		                             const std::vector<int>& content);
+		void     alignFiles         (SliceSequence& reference, SliceSequence& alternate);
+		void     compareRegion      (SliceSequence& reference, int r1, int r2,
+		                             HumNum rbase, SliceSequence& alternate,
+		                             int a1, int a2, HumNum abase);
+		void     compareRun         (SliceSequence& reference, int r1, int r2,
+		                             HumNum rbase, SliceSequence& alternate,
+		                             int a1, int a2, HumNum abase);
+		bool     diffSequences      (std::vector<std::pair<int, int>>& matches,
+		                             const std::vector<int>& a, int a1, int a2,
+		                             const std::vector<int>& b, int b1, int b2);
+
 	private:
 		int m_marked = 0;
 
+		// m_sliceIds: content ids of time points for alignment.
+		std::map<std::vector<int>, int> m_sliceIds;
+
+		// m_measureIds: content ids of measures for alignment.
+		std::map<std::vector<int>, int> m_measureIds;
+
 
 };
 
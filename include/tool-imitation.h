@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Jun 17 20:18:23 CEST 2017
-// Last Modified: Sat Jun 17 22:40:59 CEST 2017
+// Last Modified: Sun Oct 18 19:02:37 PDT 2026
 // Filename:      tool-imitation.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-imitation.h
 // Syntax:        C++11; humlib
@@ -17,10 +17,37 @@
 #include "HumdrumFile.h"
 #include "NoteGrid.h"
 
+#include <map>
+#include <tuple>
+#include <vector>
+
 namespace hum {
 
 // START_MERGE
 
+//////////////////////////////
+//
+// ImitationSequenceIndex -- Suffix array of the interval sequences of all
+//    voices, used to find the number of matching intervals starting at
+//    any two notes in constant time (the longest common prefix of two
+//    suffixes, from a range-minimum table of the prefix lengths of
+//    neighboring suffixes).
+//
+
+class ImitationSequenceIndex {
+	public:
+		void     build             (vector<vector<int>>& sequences);
+		int      getMatchLength    (int seq1, int index1, int seq2,
+		                            int index2) const;
+
+	private:
+		vector<int>         m_offsets;   // start of each sequence in text
+		vector<int>         m_rank;      // suffix array index of each position
+		vector<vector<int>> m_minimums;  // sparse table of prefix lengths
+};
+
+
+
 class Tool_imitation : public HumTool {
 	public:
 		         Tool_imitation    (void);
@@ -42,9 +69,13 @@ class Tool_imitation : public HumTool {
 		                            int v1, int v2);
 		void    getIntervals       (vector<double>& intervals,
 		                            vector<NoteCell*>& attacks);
+		void    buildSequenceIndex (vector<vector<NoteCell*>>& attacks,
+		                            vector<vector<double>>& intervals);
+		int     getSymbol          (std::map<std::tuple<bool, double, int, int>, int>& symbols,
+		                            double interval, HumNum duration);
 		int     compareSequences   (vector<NoteCell*>& attack1, vector<double>& seq1,
 		                            int i1, vector<NoteCell*>& attack2,
-		                            vector<double>& seq2, int i2);
+		                            vector<double>& seq2, int i2, int length);
 		int     checkForIntervalSequence(vector<int>& m_intervals,
 		                            vector<double>& v1i, int starti, int count);
 		void    markedTiedNotes    (vector<HTp>& tokens);
@@ -61,7 +92,7 @@ class Tool_imitation : public HumTool {
 		bool m_mark;
 		char m_marker = '@';
 		bool m_single = false;
-		static int Enumerator;
+		int m_enumerator = 0;  // number of the current imitation match
 		bool m_first = false;
 		bool m_nozero = false;
 		bool m_onlyzero = false;
@@ -86,6 +117,11 @@ class Tool_imitation : public HumTool {
 		bool m_retrograde = false;
 
 		vector<int> m_barlines;
+
+		// m_sequences: symbol for each interval (and duration) of each
+		// voice, followed by the inverted sequences for inversion searches.
+		vector<vector<int>> m_sequences;
+		ImitationSequenceIndex m_sequenceIndex;
 };
 
 // END_MERGE
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug 24 17:41:44 EDT 2019
-// Last Modified: Sat Aug 24 17:41:47 EDT 2019
+// Last Modified: Sun Oct 18 21:27:38 PDT 2026
 // Filename:      tool-melisma.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-melisma.h
 // Syntax:        C++11; humlib
@@ -73,8 +73,9 @@ class Tool_melisma : public HumTool {
 		void   initialize              (HumdrumFile& infile);
 		void   processFile             (HumdrumFile& infile);
 		void   getNoteCounts           (HumdrumFile& infile, std::vector<std::vector<int>>& counts);
-		void   getNoteCountsForLyric   (std::vector<std::vector<int>>& counts, HTp lyricStart);
-		int    getCountForSyllable     (HTp token);
+		void   getNoteCountsForLyric   (std::vector<std::vector<int>>& counts,
+		                                const HumTextTable& table, int spine);
+		int    getCountForSyllable     (const HumTextTable& table, int syllable);
 		void   replaceLyrics           (HumdrumFile& infile, std::vector<std::vector<int>>& counts);
 		void   markMelismas            (HumdrumFile& infile, std::vector<std::vector<int>>& counts);
 		void   markMelismaNotes        (HTp text, int count);
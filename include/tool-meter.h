@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Sep 10 00:29:24 PDT 2023
-// Last Modified: Mon Sep 18 10:44:09 PDT 2023
+// Last Modified: Sun Oct 18 21:04:12 PDT 2026
 // Filename:      tool-meter.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-meter.h
 // Syntax:        C++11; humlib
@@ -42,9 +42,7 @@ class Tool_meter : public HumTool {
 		void     processFile       (HumdrumFile& infile);
 		void     getMeterData      (HumdrumFile& infile);
 		void     processLine       (HumdrumLine& line,
-		                            std::vector<HumNum>& curNum,
-		                            std::vector<HumNum>& curDen,
-		                            std::vector<HumNum>& curBeat,
+		                            const HumMetricTable& grid,
 		                            std::vector<HumNum>& curBarTime);
 		void     printMeterData    (HumdrumFile& infile);
 		void     printHumdrumLine  (HumdrumLine& line, bool printLabels);
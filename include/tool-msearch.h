@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Aug 27 07:18:04 PDT 2017
-// Last Modified: Sun Aug 27 07:18:07 PDT 2017
+// Last Modified: Sun Oct 18 21:26:02 PDT 2026
 // Filename:      tool-msearch.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-msearch.h
 // Syntax:        C++11; humlib
@@ -76,6 +76,18 @@ class SonorityNoteData {
 			m_base40 = Convert::kernToBase40(m_tok);
 		}
 
+		void setNote(HTp token, int index, int base40, bool attackQ) {
+			// Note data from the sonority table of the file (the note
+			// string is not extracted from the token).
+			m_token   = token;
+			m_index   = index;
+			m_tok.clear();
+			m_attackQ = attackQ;
+			m_base7   = Convert::base40ToDiatonic(base40);
+			m_base12  = Convert::base40ToMidiNoteNumber(base40) - 12;
+			m_base40  = base40;
+		}
+
 		void setString(std::string tok) {
 			// tok cannot be a chord or a null token
 			// This version is for vertical queries not for searching data.
@@ -156,7 +168,7 @@ class SonorityDatabase {
 		HLp getLine(void)      { return m_line; }
 		SonorityNoteData& getLowest(void) { return m_lowest; };
 		void addNote          (const std::string& text);
-		void buildDatabase     (HLp line);
+		void buildDatabase     (HumdrumFile& infile, int line);
 		SonorityNoteData& operator[](int index) {
 			return m_notes.at(index);
 		}
@@ -355,8 +367,6 @@ class Tool_msearch : public HumTool {
 		void    markTextMatch      (HumdrumFile& infile, TextInfo& word);
 		void    fillWords          (HumdrumFile& infile,
 		                            vector<TextInfo*>& words);
-		void    fillWordsForTrack  (vector<TextInfo*>& words,
-		                            HTp starttoken);
 		void    printQuery         (vector<MSearchQueryToken>& query);
 		void    addMusicSearchSummary(HumdrumFile& infile, int mcount, const std::string& marker);
 		void    addTextSearchSummary(HumdrumFile& infile, int mcount, const std::string& marker);
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Wed Nov 30 20:36:38 PST 2016
-// Last Modified: Wed Nov 30 20:36:41 PST 2016
+// Last Modified: Sun Oct 18 11:02:10 PDT 2026
 // Filename:      tool-myank.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-myank.h
 // Syntax:        C++11; humlib
@@ -145,12 +145,9 @@ class Tool_myank : public HumTool {
 		                                int index);
 		void      getMarkString        (std::ostream& out, HumdrumFile& infile);
 		void      printDoubleBarline   (HumdrumFile& infile, int line);
-		void      insertZerothMeasure  (std::vector<MeasureInfo>& measurelist,
-		                                HumdrumFile& infile);
 		void      getMetStates         (std::vector<std::vector<MyCoord> >& metstates,
 		                                HumdrumFile& infile);
 		MyCoord   getLocalMetInfo      (HumdrumFile& infile, int row, int track);
-		int       atEndOfFile          (HumdrumFile& infile, int line);
 		void      processFile          (HumdrumFile& infile);
 		int       getSectionCount      (HumdrumFile& infile);
 		void      getSectionString     (std::string& sstring, HumdrumFile& infile,
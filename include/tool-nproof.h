@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Wed Sep 20 13:05:37 PDT 2023
-// Last Modified: Wed Sep 20 13:05:41 PDT 2023
+// Last Modified: Sun Oct 18 21:54:40 PDT 2026
 // Filename:      tool-nproof.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-nproof.h
 // Syntax:        C++11; humlib
@@ -40,7 +40,7 @@ class Tool_nproof : public HumTool {
 		void     checkInstrumentInformation(HumdrumFile& infile);
 		void     checkKeyInformation(HumdrumFile& infile);
 		void     checkSpineTerminations(HumdrumFile& infile);
-		void     checkForValidInstrumentCode(HTp token, std::vector<std::pair<std::string, std::string>>& instrumentList);
+		void     checkForValidInstrumentCode(HTp token);
 		void     checkReferenceRecords(HumdrumFile& infile);
 
 	protected:
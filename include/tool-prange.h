@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Jul 18 11:23:42 PDT 2005
-// Last Modified: Sat Jun  8 17:37:39 PDT 2024 (ported to humlib)
+// Last Modified: Sun Oct 18 23:16:08 PDT 2026
 // Filename:      include/tool-prange.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-prange.h
 // Syntax:        C++11; humlib
@@ -50,6 +50,54 @@ class _VoiceInfo {
 
 
 
+// PrangeCorpus: pitch histograms of many files, merged by voice name so
+// that a range profile of a corpus can be printed without the source files.
+// Each file (or group of files) can be stored as a partial, which is a
+// Humdrum file with one line for each non-zero histogram bin:
+//
+//    !!!prange-partial: 1
+//    !!!prange-weight: attacks
+//    !!!prange-files: 2
+//    **voice   **key     **value
+//    soprano   name      Soprano
+//    soprano   abbr      S
+//    soprano   midi:72   14
+//    soprano   dia:49:0  14        (diatonic index and accidental)
+//    soprano   final:42:0 1        (diatonic index and accidental)
+//    *-        *-        *-
+//
+// Merging partials adds their bins, so they can be merged in any grouping
+// and order, and a merged partial can be updated later by merging it with
+// partials for new files.
+class PrangeCorpus {
+	public:
+		                PrangeCorpus      (void);
+		void            clear             (void);
+		bool            isEmpty           (void) const;
+		int             getFileCount      (void) const;
+		bool            isDurationWeighted(void) const;
+		void            setDurationWeighted(bool state);
+		void            addFile           (std::vector<_VoiceInfo>& voiceInfo);
+		bool            merge             (const PrangeCorpus& other);
+		static bool     isPartial         (HumdrumFile& infile);
+		bool            readPartial       (HumdrumFile& infile, std::string& error);
+		std::ostream&   printPartial      (std::ostream& out) const;
+		void            getVoiceInfo      (std::vector<_VoiceInfo>& voiceInfo) const;
+		static std::string getVoiceKey    (const std::string& name);
+
+	private:
+		static void     mergeVoice        (_VoiceInfo& target, const _VoiceInfo& source);
+		static void     addFinal          (_VoiceInfo& voice, int diatonic, int acc);
+		static bool     readCount         (const std::string& text, double& count);
+
+		// m_voices: histograms by normalized voice name.
+		std::map<std::string, _VoiceInfo> m_voices;
+		int  m_files     = 0;
+		bool m_durationQ = false;
+};
+
+
+
 class Tool_prange : public HumTool {
 	public:
 		         Tool_prange       (void);
@@ -59,6 +107,9 @@ class Tool_prange : public HumTool {
 		bool        run               (HumdrumFile& infile);
 		bool        run               (const std::string& indata, std::ostream& out);
 		bool        run               (HumdrumFile& infile, std::ostream& out);
+		void        finally           (void);
+
+		PrangeCorpus& getCorpus       (void);
 
 	protected:
 		void        processFile         (HumdrumFile& infile);
@@ -72,7 +123,7 @@ class Tool_prange : public HumTool {
 		void        printReferenceRecords       (std::ostream& out, HumdrumFile& infile);
 		void        printScoreEncodedText       (std::ostream& out, const std::string& strang);
 		void        printXmlEncodedText         (std::ostream& out, const std::string& strang);
-		void        printScoreFile              (std::ostream& out, std::vector<_VoiceInfo>& voiceInfo, HumdrumFile& infile);
+		void        printScoreFile              (std::ostream& out, std::vector<_VoiceInfo>& voiceInfo, int keysig);
 		void        printKeySigCompression      (std::ostream& out, int keysig, int extra);
 		void        assignHorizontalPosition    (std::vector<_VoiceInfo>& voiceInfo, int minval, int maxval);
 		int         getKeySignature             (HumdrumFile& infile);
@@ -144,6 +195,8 @@ class Tool_prange : public HumTool {
 		bool m_scoreQ       = false; // for --score option
 		bool m_titleQ       = false; // for --title option
 		bool m_extremaQ     = false; // for --extrema option
+		bool m_corpusQ      = false; // for --corpus option
+		bool m_partialQ     = false; // for --partial option
 
 		std::string m_highMark = "🌸";
 		std::string m_lowMark  = "🟢";
@@ -162,6 +215,9 @@ class Tool_prange : public HumTool {
 		// m_trackToKernIndex: mapping from track to **kern index
 		std::vector<int> m_trackToKernIndex;
 
+		// m_corpus: histograms merged from all inputs for --corpus option.
+		PrangeCorpus m_corpus;
+
 };
 
 // END_MERGE
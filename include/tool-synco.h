@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Apr 30 10:41:35 PDT 2022
-// Last Modified: Wed May  4 01:03:52 PDT 2022
+// Last Modified: Sun Oct 18 21:59:40 PDT 2026
 // Filename:      tool-synco.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-synco.h
 // Syntax:        C++11; humlib
@@ -37,7 +37,7 @@ class Tool_synco : public HumTool {
 		void      processFile      (HumdrumFile& infile);
 		void      initialize       (void);
 
-		void      processStrand    (HTp stok, HTp etok);
+		void      processStrand    (const HumStrandTable& strands, int strand);
 		bool      isSyncopated     (HTp token);
 		double    getMetricLevel   (HTp token);
 		void      markNote         (HTp token);
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Sep  2 11:58:11 CEST 2023
-// Last Modified: Sat Sep  2 11:58:15 CEST 2023
+// Last Modified: Sun Oct 18 21:28:55 PDT 2026
 // Filename:      tool-textdur.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-textdur.h
 // Syntax:        C++11; humlib
@@ -41,8 +41,9 @@ class Tool_textdur : public HumTool {
 		void     printMelismas     (HumdrumFile& infile);
 		void     printDurations     (HumdrumFile& infile);
 		void     getTextSpineStarts(HumdrumFile& infile, std::vector<HTp>& starts);
-		void     processTextSpine  (std::vector<HTp>& starts, int index);
-		int      getMelisma        (HTp tok1, HTp tok2);
+		void     processTextSpine  (const HumTextTable& table,
+		                            std::vector<HTp>& starts, int index);
+		int      getMelisma        (const HumTextTable& table, int syllable);
 		HumNum   getDuration       (HTp tok1, HTp tok2);
 		HTp      getTandemKernToken(HTp token);
 		void     printInterleaved  (HumdrumFile& infile);
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Dec  5 23:09:00 PST 2016
-// Last Modified: Mon Dec  5 23:09:08 PST 2016
+// Last Modified: Sun Oct 18 11:52:14 PDT 2026
 // Filename:      tool-transpose.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-transpose.h
 // Syntax:        C++11; humlib
@@ -15,7 +15,9 @@
 
 #include "HumTool.h"
 #include "HumdrumFile.h"
+#include "HumTransposer.h"
 
+#include <map>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -38,10 +40,12 @@ class Tool_transpose : public HumTool {
 	protected:
 
 		// auto transpose functions:
-		void     initialize             (HumdrumFile& infile);
+		bool     initialize             (HumdrumFile& infile);
 		void     convertScore           (HumdrumFile& infile, int style);
 		void     processFile            (HumdrumFile& infile,
 		                                 std::vector<bool>& spineprocess);
+		void     processIntervals       (HumdrumFile& infile,
+		                                 std::vector<bool>& spineprocess);
 		void     convertToConcertPitches(HumdrumFile& infile, int line,
 		                                 std::vector<int>& tvals);
 		void     convertToWrittenPitches(HumdrumFile& infile, int line,
@@ -113,6 +117,7 @@ class Tool_transpose : public HumTool {
 		                                 int line, int transval);
 		int      getTransposeInfo       (HumdrumFile& infile, int row, int col);
 		void     printNewKernString     (const std::string& string, int transval);
+		HumTransposer& getTransposer    (int transval);
 
 	private:
 		int      transval     = 0;   // used with -b option
@@ -127,6 +132,9 @@ class Tool_transpose : public HumTool {
 		int      writtenQ     = 0;   // used with -W option
 		int      quietQ       = 0;   // used with -q option
 		int      instrumentQ  = 0;   // used with -I option
+
+		std::map<int, HumTransposer> m_transposers; // lookup tables for each interval
+		std::string   m_kernBuffer;  // reused for transposing **kern tokens
 };
 
 
@@ -1,7 +1,7 @@
 //
 // Programmer:    Katherine Wong
 // Creation Date: Mon Mar 13 23:47:52 PDT 2023
-// Last Modified: Tue Jun  6 19:23:10 PDT 2023
+// Last Modified: Sun Oct 18 18:45:12 PDT 2026
 // Filename:      tool-tspos.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-tspos.h
 // Syntax:        C++11; humlib
@@ -40,7 +40,6 @@ class Tool_tspos : public HumTool {
 	protected:
 		void             initialize        (HumdrumFile& infile);
 		void             processFile       (HumdrumFile& infile);
-		std::vector<int> getMidiNotes(std::vector<HTp>& kernNotes);
 		std::vector<int> getChordPositions(std::vector<int>& midiNotes);
 		std::vector<int> getNoteMods(std::vector<int>& midiNotes);
 		std::vector<int> getThirds(std::vector<int>& midiNotes);
@@ -54,7 +53,6 @@ class Tool_tspos : public HumTool {
 		std::vector<std::string> getTrackNames(HumdrumFile& infile);
 		int              getVectorSum(std::vector<int>& input);
 		void             analyzeVoiceCount(HumdrumFile& infile);
-		int              countVoicesOnLine(HumdrumFile& infile, int line);
 		std::string      generateTable(HumdrumFile& infile, std::vector<std::string>& name);
 		bool             hasFullTriadAttack(HumdrumLine& line);
 		void             avoidRdfCollisions(HumdrumFile& infile);
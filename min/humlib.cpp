@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
-// Last Modified: Tue Mar  4 09:02:49 PST 2025
+// Last Modified: Sun Oct 18 19:08:24 UTC 2026
 // Filename:      min/humlib.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/min/humlib.cpp
 // Syntax:        C++11
@@ -444,237 +444,300 @@ vector<int> Convert::harmToBase40(const string& harm, int keyroot, int keymode)
 
 
 
+// Instrument codes and their instrument classes (from
+// https://bit.ly/humdrum-instrument-codes), sorted by code (in strcmp()
+// order) so that they can be found with a binary search:
+
+static constexpr struct {
+	const char* code;
+	const char* iclass;
+} InstrumentClassList[] = {
+	{ "accor",   "klav" },
+	{ "alto",    "vox" },
+	{ "anvil",   "idio" },
+	{ "archl",   "str" },
+	{ "armon",   "ww" },
+	{ "arpa",    "str" },
+	{ "bagpI",   "ww" },
+	{ "bagpS",   "ww" },
+	{ "banjo",   "str" },
+	{ "bansu",   "ww" },
+	{ "barit",   "vox" },
+	{ "baset",   "ww" },
+	{ "bass",    "vox" },
+	{ "bdrum",   "idio" },
+	{ "bguit",   "str" },
+	{ "biwa",    "str" },
+	{ "brush",   "idio" },
+	{ "bscan",   "vox" },
+	{ "bspro",   "vox" },
+	{ "bugle",   "bras" },
+	{ "calam",   "ww" },
+	{ "calpe",   "ww" },
+	{ "calto",   "vox" },
+	{ "campn",   "idio" },
+	{ "cangl",   "ww" },
+	{ "canto",   "vox" },
+	{ "caril",   "idio" },
+	{ "castr",   "vox" },
+	{ "casts",   "idio" },
+	{ "cbass",   "str" },
+	{ "cello",   "str" },
+	{ "cemba",   "klav" },
+	{ "cetra",   "str" },
+	{ "chain",   "idio" },
+	{ "chcym",   "idio" },
+	{ "chime",   "idio" },
+	{ "chlma",   "ww" },
+	{ "chlms",   "ww" },
+	{ "chlmt",   "ww" },
+	{ "clap",    "idio" },
+	{ "clara",   "ww" },
+	{ "clarb",   "ww" },
+	{ "claro",   "ww" },
+	{ "clarp",   "ww" },
+	{ "clars",   "ww" },
+	{ "clave",   "idio" },
+	{ "clavi",   "klav" },
+	{ "clest",   "klav" },
+	{ "clrno",   "bras" },
+	{ "colsp",   "vox" },
+	{ "conga",   "idio" },
+	{ "cor",     "bras" },
+	{ "cornm",   "ww" },
+	{ "corno",   "ww" },
+	{ "cornt",   "bras" },
+	{ "coro",    "vox" },
+	{ "crshc",   "idio" },
+	{ "ctenor",  "vox" },
+	{ "ctina",   "klav" },
+	{ "drmsp",   "vox" },
+	{ "drum",    "idio" },
+	{ "drumP",   "idio" },
+	{ "dulc",    "str" },
+	{ "eguit",   "str" },
+	{ "fag_c",   "ww" },
+	{ "fagot",   "ww" },
+	{ "false",   "vox" },
+	{ "fdrum",   "idio" },
+	{ "feme",    "vox" },
+	{ "fife",    "ww" },
+	{ "fingc",   "idio" },
+	{ "flex",    "idio" },
+	{ "flt",     "ww" },
+	{ "flt_a",   "ww" },
+	{ "flt_b",   "ww" },
+	{ "fltda",   "ww" },
+	{ "fltdb",   "ww" },
+	{ "fltdn",   "ww" },
+	{ "fltds",   "ww" },
+	{ "fltdt",   "ww" },
+	{ "flugh",   "bras" },
+	{ "forte",   "klav" },
+	{ "gen",     "gen" },
+	{ "genB",    "gen" },
+	{ "genT",    "gen" },
+	{ "glock",   "idio" },
+	{ "gong",    "idio" },
+	{ "guitr",   "str" },
+	{ "hammd",   "klav" },
+	{ "hbell",   "idio" },
+	{ "heck",    "ww" },
+	{ "heltn",   "vox" },
+	{ "hichi",   "ww" },
+	{ "hurdy",   "str" },
+	{ "kitv",    "str" },
+	{ "klav",    "klav" },
+	{ "kokyu",   "str" },
+	{ "komun",   "str" },
+	{ "koto",    "str" },
+	{ "kruma",   "ww" },
+	{ "krumb",   "ww" },
+	{ "krums",   "ww" },
+	{ "krumt",   "ww" },
+	{ "lion",    "idio" },
+	{ "liuto",   "str" },
+	{ "lyrsp",   "vox" },
+	{ "lyrtn",   "vox" },
+	{ "male",    "vox" },
+	{ "mando",   "str" },
+	{ "marac",   "idio" },
+	{ "marim",   "idio" },
+	{ "mbari",   "vox" },
+	{ "mezzo",   "vox" },
+	{ "nfant",   "vox" },
+	{ "nokan",   "ww" },
+	{ "oboe",    "ww" },
+	{ "oboeD",   "ww" },
+	{ "ocari",   "ww" },
+	{ "ondes",   "klav" },
+	{ "ophic",   "bras" },
+	{ "organ",   "klav" },
+	{ "oud",     "str" },
+	{ "paila",   "idio" },
+	{ "panpi",   "ww" },
+	{ "pbell",   "idio" },
+	{ "pguit",   "str" },
+	{ "physh",   "klav" },
+	{ "piano",   "klav" },
+	{ "piatt",   "idio" },
+	{ "picco",   "ww" },
+	{ "pipa",    "str" },
+	{ "piri",    "ww" },
+	{ "porta",   "klav" },
+	{ "psalt",   "str" },
+	{ "qin",     "str" },
+	{ "quinto",  "vox" },
+	{ "quitr",   "str" },
+	{ "rackt",   "ww" },
+	{ "ratch",   "idio" },
+	{ "ratl",    "idio" },
+	{ "rebec",   "str" },
+	{ "recit",   "vox" },
+	{ "reedo",   "klav" },
+	{ "rhode",   "klav" },
+	{ "ridec",   "idio" },
+	{ "sarod",   "str" },
+	{ "sarus",   "ww" },
+	{ "saxA",    "ww" },
+	{ "saxB",    "ww" },
+	{ "saxC",    "ww" },
+	{ "saxN",    "ww" },
+	{ "saxR",    "ww" },
+	{ "saxS",    "ww" },
+	{ "saxT",    "ww" },
+	{ "sbell",   "idio" },
+	{ "sdrum",   "idio" },
+	{ "serp",    "bras" },
+	{ "sesto",   "vox" },
+	{ "shaku",   "ww" },
+	{ "shami",   "str" },
+	{ "sheng",   "ww" },
+	{ "sho",     "ww" },
+	{ "siren",   "idio" },
+	{ "sitar",   "str" },
+	{ "slap",    "idio" },
+	{ "soprn",   "vox" },
+	{ "spok",    "vox" },
+	{ "spokF",   "vox" },
+	{ "spokM",   "vox" },
+	{ "spshc",   "idio" },
+	{ "steel",   "idio" },
+	{ "stim",    "vox" },
+	{ "stimA",   "vox" },
+	{ "stimB",   "vox" },
+	{ "stimC",   "vox" },
+	{ "stimR",   "vox" },
+	{ "stimS",   "vox" },
+	{ "strdr",   "idio" },
+	{ "sxhA",    "bras" },
+	{ "sxhB",    "bras" },
+	{ "sxhC",    "bras" },
+	{ "sxhR",    "bras" },
+	{ "sxhS",    "bras" },
+	{ "sxhT",    "bras" },
+	{ "synth",   "klav" },
+	{ "tabla",   "idio" },
+	{ "tambn",   "idio" },
+	{ "tambu",   "str" },
+	{ "tanbr",   "str" },
+	{ "tblok",   "idio" },
+	{ "tdrum",   "idio" },
+	{ "tenor",   "vox" },
+	{ "timpa",   "idio" },
+	{ "tiorb",   "str" },
+	{ "tom",     "idio" },
+	{ "trngl",   "idio" },
+	{ "tromP",   "bras" },
+	{ "troma",   "bras" },
+	{ "tromb",   "bras" },
+	{ "tromp",   "bras" },
+	{ "tromt",   "bras" },
+	{ "trumB",   "bras" },
+	{ "tuba",    "bras" },
+	{ "tubaB",   "bras" },
+	{ "tubaC",   "bras" },
+	{ "tubaT",   "bras" },
+	{ "tubaU",   "bras" },
+	{ "ukule",   "str" },
+	{ "vibra",   "idio" },
+	{ "vina",    "str" },
+	{ "viola",   "str" },
+	{ "violb",   "str" },
+	{ "viold",   "str" },
+	{ "viole",   "str" },
+	{ "violn",   "str" },
+	{ "violp",   "str" },
+	{ "viols",   "str" },
+	{ "violt",   "str" },
+	{ "vox",     "vox" },
+	{ "wblok",   "idio" },
+	{ "xylo",    "idio" },
+	{ "zithr",   "str" },
+	{ "zurna",   "ww" }
+};
+
+
+static constexpr int InstrumentClassCount =
+		(int)(sizeof(InstrumentClassList) / sizeof(InstrumentClassList[0]));
+
+
+// isSortedInstrumentClassList: used to check at compile time that the
+// instrument class list is sorted and has no duplicate codes.
+
+static constexpr bool isSortedInstrumentClassList(void) {
+	for (int i=1; i<InstrumentClassCount; i++) {
+		const char* a = InstrumentClassList[i-1].code;
+		const char* b = InstrumentClassList[i].code;
+		while ((*a != '\0') && (*a == *b)) {
+			a++;
+			b++;
+		}
+		if ((unsigned char)*a >= (unsigned char)*b) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static_assert(isSortedInstrumentClassList(), "InstrumentClassList must be sorted by code");
+
+
+
 //////////////////////////////
 //
-// Convert::getInstrumentList -- List from https://bit.ly/humdrum-instrument-codes
+// Convert::getInstrumentList -- Return the list of instrument codes
+//     and their instrument classes, sorted by code.
 //
 
 vector<pair<string, string> > Convert::getInstrumentList(void) {
-	return vector<pair<string, string> > {
-		{"accor",	"klav"},
-		{"alto",	"vox"},
-		{"anvil",	"idio"},
-		{"archl",	"str"},
-		{"armon",	"ww"},
-		{"arpa",	"str"},
-		{"bagpI",	"ww"},
-		{"bagpS",	"ww"},
-		{"banjo",	"str"},
-		{"bansu",	"ww"},
-		{"barit",	"vox"},
-		{"baset",	"ww"},
-		{"bass",	"vox"},
-		{"bdrum",	"idio"},
-		{"bguit",	"str"},
-		{"biwa",	"str"},
-		{"brush",	"idio"},
-		{"bscan",	"vox"},
-		{"bspro",	"vox"},
-		{"bugle",	"bras"},
-		{"calam",	"ww"},
-		{"calpe",	"ww"},
-		{"calto",	"vox"},
-		{"campn",	"idio"},
-		{"cangl",	"ww"},
-		{"canto",	"vox"},
-		{"caril",	"idio"},
-		{"castr",	"vox"},
-		{"casts",	"idio"},
-		{"cbass",	"str"},
-		{"cello",	"str"},
-		{"cemba",	"klav"},
-		{"cetra",	"str"},
-		{"chain",	"idio"},
-		{"chcym",	"idio"},
-		{"chime",	"idio"},
-		{"chlma",	"ww"},
-		{"chlms",	"ww"},
-		{"chlmt",	"ww"},
-		{"clap",	"idio"},
-		{"clara",	"ww"},
-		{"clarb",	"ww"},
-		{"claro",	"ww"},
-		{"clarp",	"ww"},
-		{"clars",	"ww"},
-		{"clave",	"idio"},
-		{"clavi",	"klav"},
-		{"clest",	"klav"},
-		{"clrno",	"bras"},
-		{"colsp",	"vox"},
-		{"conga",	"idio"},
-		{"cor",	"bras"},
-		{"cornm",	"ww"},
-		{"corno",	"ww"},
-		{"cornt",	"bras"},
-		{"coro",	"vox"},
-		{"crshc",	"idio"},
-		{"ctenor",	"vox"},
-		{"ctina",	"klav"},
-		{"drmsp",	"vox"},
-		{"drum",	"idio"},
-		{"drumP",	"idio"},
-		{"dulc",	"str"},
-		{"eguit",	"str"},
-		{"fag_c",	"ww"},
-		{"fagot",	"ww"},
-		{"false",	"vox"},
-		{"fdrum",	"idio"},
-		{"feme",	"vox"},
-		{"fife",	"ww"},
-		{"fingc",	"idio"},
-		{"flex",	"idio"},
-		{"flt",	"ww"},
-		{"flt_a",	"ww"},
-		{"flt_b",	"ww"},
-		{"fltda",	"ww"},
-		{"fltdb",	"ww"},
-		{"fltdn",	"ww"},
-		{"fltds",	"ww"},
-		{"fltdt",	"ww"},
-		{"flugh",	"bras"},
-		{"forte",	"klav"},
-		{"gen",	"gen"},
-		{"genB",	"gen"},
-		{"genT",	"gen"},
-		{"glock",	"idio"},
-		{"gong",	"idio"},
-		{"guitr",	"str"},
-		{"hammd",	"klav"},
-		{"hbell",	"idio"},
-		{"heck",	"ww"},
-		{"heltn",	"vox"},
-		{"hichi",	"ww"},
-		{"hurdy",	"str"},
-		{"kitv",	"str"},
-		{"klav",	"klav"},
-		{"kokyu",	"str"},
-		{"komun",	"str"},
-		{"koto",	"str"},
-		{"kruma",	"ww"},
-		{"krumb",	"ww"},
-		{"krums",	"ww"},
-		{"krumt",	"ww"},
-		{"lion",	"idio"},
-		{"liuto",	"str"},
-		{"lyrsp",	"vox"},
-		{"lyrtn",	"vox"},
-		{"male",	"vox"},
-		{"mando",	"str"},
-		{"marac",	"idio"},
-		{"marim",	"idio"},
-		{"mbari",	"vox"},
-		{"mezzo",	"vox"},
-		{"nfant",	"vox"},
-		{"nokan",	"ww"},
-		{"oboe",	"ww"},
-		{"oboeD",	"ww"},
-		{"ocari",	"ww"},
-		{"ondes",	"klav"},
-		{"ophic",	"bras"},
-		{"organ",	"klav"},
-		{"oud",	"str"},
-		{"paila",	"idio"},
-		{"panpi",	"ww"},
-		{"pbell",	"idio"},
-		{"pguit",	"str"},
-		{"physh",	"klav"},
-		{"piano",	"klav"},
-		{"piatt",	"idio"},
-		{"picco",	"ww"},
-		{"pipa",	"str"},
-		{"piri",	"ww"},
-		{"porta",	"klav"},
-		{"psalt",	"str"},
-		{"qin",	"str"},
-		{"quinto",	"vox"},
-		{"quitr",	"str"},
-		{"rackt",	"ww"},
-		{"ratch",	"idio"},
-		{"ratl",	"idio"},
-		{"rebec",	"str"},
-		{"recit",	"vox"},
-		{"reedo",	"klav"},
-		{"rhode",	"klav"},
-		{"ridec",	"idio"},
-		{"sarod",	"str"},
-		{"sarus",	"ww"},
-		{"saxA",	"ww"},
-		{"saxB",	"ww"},
-		{"saxC",	"ww"},
-		{"saxN",	"ww"},
-		{"saxR",	"ww"},
-		{"saxS",	"ww"},
-		{"saxT",	"ww"},
-		{"sbell",	"idio"},
-		{"sdrum",	"idio"},
-		{"serp",	"bras"},
-		{"sesto",	"vox"},
-		{"shaku",	"ww"},
-		{"shami",	"str"},
-		{"sheng",	"ww"},
-		{"sho",	"ww"},
-		{"siren",	"idio"},
-		{"sitar",	"str"},
-		{"slap",	"idio"},
-		{"soprn",	"vox"},
-		{"spok",	"vox"},
-		{"spokF",	"vox"},
-		{"spokM",	"vox"},
-		{"spshc",	"idio"},
-		{"steel",	"idio"},
-		{"stim",	"vox"},
-		{"stimA",	"vox"},
-		{"stimB",	"vox"},
-		{"stimC",	"vox"},
-		{"stimR",	"vox"},
-		{"stimS",	"vox"},
-		{"strdr",	"idio"},
-		{"sxhA",	"bras"},
-		{"sxhB",	"bras"},
-		{"sxhC",	"bras"},
-		{"sxhR",	"bras"},
-		{"sxhS",	"bras"},
-		{"sxhT",	"bras"},
-		{"synth",	"klav"},
-		{"tabla",	"idio"},
-		{"tambn",	"idio"},
-		{"tambu",	"str"},
-		{"tanbr",	"str"},
-		{"tblok",	"idio"},
-		{"tdrum",	"idio"},
-		{"tenor",	"vox"},
-		{"timpa",	"idio"},
-		{"tiorb",	"str"},
-		{"tom",	"idio"},
-		{"trngl",	"idio"},
-		{"tromP",	"bras"},
-		{"troma",	"bras"},
-		{"tromb",	"bras"},
-		{"tromp",	"bras"},
-		{"tromt",	"bras"},
-		{"trumB",	"bras"},
-		{"tuba",	"bras"},
-		{"tubaB",	"bras"},
-		{"tubaC",	"bras"},
-		{"tubaT",	"bras"},
-		{"tubaU",	"bras"},
-		{"ukule",	"str"},
-		{"vibra",	"idio"},
-		{"vina",	"str"},
-		{"viola",	"str"},
-		{"violb",	"str"},
-		{"viold",	"str"},
-		{"viole",	"str"},
-		{"violn",	"str"},
-		{"violp",	"str"},
-		{"viols",	"str"},
-		{"violt",	"str"},
-		{"vox",	"vox"},
-		{"wblok",	"idio"},
-		{"xylo",	"idio"},
-		{"zithr",	"str"},
-		{"zurna",	"ww"}
-	};
+	vector<pair<string, string> > output;
+	output.reserve(InstrumentClassCount);
+	for (int i=0; i<InstrumentClassCount; i++) {
+		output.emplace_back(InstrumentClassList[i].code, InstrumentClassList[i].iclass);
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// Convert::getInstrumentClass -- Return the instrument class of an
+//     instrument code (without *I), such as "str" for "violn", or an empty
+//     string if the code is unknown.
+//
+
+string Convert::getInstrumentClass(const string& code) {
+	auto end = InstrumentClassList + InstrumentClassCount;
+	auto entry = std::lower_bound(InstrumentClassList, end, code.c_str(),
+			[](const decltype(InstrumentClassList[0])& a, const char* b) {
+				return strcmp(a.code, b) < 0;
+			});
+	if ((entry == end) || (strcmp(entry->code, code.c_str()) != 0)) {
+		return "";
+	}
+	return entry->iclass;
 }
 
 
@@ -2858,7 +2921,8 @@ int Convert::kernToBase12(const string& kerndata) {
 //////////////////////////////
 //
 // Convert::base40ToKern -- Convert Base-40 integer pitches into
-//   **kern pitch representation.
+//   **kern pitch representation.  Returns an empty string if the
+//   octave is out of range.
 //
 
 string Convert::base40ToKern(int b40) {
@@ -2886,7 +2950,7 @@ string Convert::base40ToKern(int b40) {
 	}
 	if (repeat > 12) {
 		cerr << "Error: unreasonable octave value: " << octave << " for " << b40 << endl;
-		exit(1);
+		return "";
 	}
 	string output;
 	output += base;
@@ -4976,6 +5040,29 @@ string Convert::getLanguageName(const string& abbreviation) {
 
 
 
+//////////////////////////////
+//
+// Convert::getCurrentDate -- Return the current local date (and/or time)
+//     formatted with strftime().  The default format is "YYYY/MM/DD", which
+//     is the format used in reference records such as !!!ONB and !!!END.
+//     (localtime() is not used since it returns a pointer to shared storage.)
+//
+
+string Convert::getCurrentDate(const string& format) {
+	time_t now = time(NULL);
+	tm local;
+	#ifdef _WIN32
+		localtime_s(&local, &now);
+	#else
+		localtime_r(&now, &local);
+	#endif
+	char buffer[256];
+	size_t length = strftime(buffer, sizeof(buffer), format.c_str(), &local);
+	return string(buffer, length);
+}
+
+
+
 
 
 //////////////////////////////
@@ -9259,16 +9346,16 @@ ostream& operator<<(ostream& output, GridStaff* staff) {
 	}
 	for (int t=0; t<(int)staff->size(); t++) {
 		GridVoice* gt = staff->at(t);
-		cout << "(v" << t << ":)";
+		output << "(v" << t << ":)";
 		if (gt == NULL) {
-			cout << "{gt:n}";
+			output << "{gt:n}";
 			continue;
 		} else {
 			HTp token = gt->getToken();
 			if (token == NULL) {
-				cout << "{n}";
+				output << "{n}";
 			} else {
-				cout << " \"" << *token << "\" ";
+				output << " \"" << *token << "\" ";
 			}
 		}
 	}
@@ -9497,9 +9584,9 @@ string GridVoice::getString(void) {
 	string output;
 	HTp token = getToken();
 	if (token == NULL) {
-		cout << "{n}";
+		output = "{n}";
 	} else {
-		cout << *token;
+		output = *token;
 	}
 	return output;
 }
@@ -9519,9 +9606,9 @@ ostream& operator<<(ostream& output, GridVoice* voice) {
 
 	HTp token = voice->getToken();
 	if (token == NULL) {
-		cout << "{n}";
+		output << "{n}";
 	} else {
-		cout << " \"" << *token << "\" ";
+		output << " \"" << *token << "\" ";
 	}
 	return output;
 }
@@ -9544,6 +9631,7 @@ HumAddress::HumAddress(void) {
 	m_subtrack      = -1;
 	m_subtrackcount = 0;
 	m_fieldindex    = -1;
+	m_spining       = makeSpineInfo("");
 	m_owner         = NULL;
 }
 
@@ -9683,7 +9771,45 @@ HTp HumAddress::getExclusiveInterpretation(void) {
 //
 
 const string& HumAddress::getSpineInfo(void) const {
-	return m_spining;
+	return *m_spining;
+}
+
+
+
+//////////////////////////////
+//
+// HumAddress::makeSpineInfo -- Return a spine info string which can be
+//     shared by several tokens.  Common spine info strings (the first one
+//     hundred spines, split up to two times) are taken from a fixed table
+//     which does not change, so no locking or reference counting is needed
+//     for them.  Other strings are allocated, and freed when the last token
+//     using them is deleted.
+//
+
+std::shared_ptr<const string> HumAddress::makeSpineInfo(const string& spineinfo) {
+	static const std::unordered_set<string> common = [](void) {
+		std::unordered_set<string> output;
+		output.insert("");
+		for (int i=1; i<=100; i++) {
+			string track = to_string(i);
+			for (const string& sub : { track, "(" + track + ")a", "(" + track + ")b" }) {
+				output.insert(sub);
+			}
+			for (const char* split1 : { "a", "b" }) {
+				for (const char* split2 : { "a", "b" }) {
+					output.insert("((" + track + ")" + split1 + ")" + split2);
+				}
+			}
+		}
+		return output;
+	}();
+
+	auto found = common.find(spineinfo);
+	if (found != common.end()) {
+		// Point to the table entry without taking ownership of it:
+		return std::shared_ptr<const string>(std::shared_ptr<const string>(), &*found);
+	}
+	return std::make_shared<const string>(spineinfo);
 }
 
 
@@ -9820,10 +9946,16 @@ void HumAddress::setFieldIndex(int index) {
 //     token.  For example "2" for the second spine (from the left), or
 //     "((2)a)b" for a sub-spine created as the left sub-spine of the main
 //     spine and then as the right sub-spine of that sub-spine.  This function
-//     is used by the HumdrumFileStructure class.
+//     is used by the HumdrumFileStructure class.  The second form shares a
+//     string returned by makeSpineInfo().
 //
 
 void HumAddress::setSpineInfo(const string& spineinfo) {
+	m_spining = makeSpineInfo(spineinfo);
+}
+
+
+void HumAddress::setSpineInfo(const std::shared_ptr<const string>& spineinfo) {
 	m_spining = spineinfo;
 }
 
@@ -9891,6 +10023,1542 @@ void HumAddress::setSubtrackCount(int count) {
 
 
 
+
+//////////////////////////////
+//
+// HumAnalysisTables::HumAnalysisTables -- Constructor.
+//
+
+HumAnalysisTables::HumAnalysisTables(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::clear -- Remove the token index and all analysis data.
+//
+
+void HumAnalysisTables::clear(void) {
+	m_lineOffsets.clear();
+	m_tokens.clear();
+	m_tokenLines.clear();
+	m_accidentalOffsets.clear();
+	m_accidentals.clear();
+	m_slurs.clear();
+	m_beams.clear();
+	m_ties.clear();
+	m_phrases.clear();
+	m_restDiatonic.clear();
+	m_restOctave.clear();
+	m_nullResolution.clear();
+	m_attackLines.clear();
+	m_sonorities.clear();
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::indexTokens -- Assign an id to each token in the file
+//    and prepare empty analysis tables for them.
+//
+
+void HumAnalysisTables::indexTokens(HumdrumFileBase& infile) {
+	clear();
+	int lineCount = infile.getLineCount();
+	m_lineOffsets.resize(lineCount + 1);
+	int count = 0;
+	for (int i=0; i<lineCount; i++) {
+		m_lineOffsets[i] = count;
+		count += infile[i].getFieldCount();
+	}
+	m_lineOffsets[lineCount] = count;
+	m_tokens.resize(count);
+	m_tokenLines.resize(count);
+	m_accidentalOffsets.resize(count + 1);
+	int subtokens = 0;
+	for (int i=0; i<lineCount; i++) {
+		int fieldCount = infile[i].getFieldCount();
+		bool dataQ = infile[i].isData();
+		for (int j=0; j<fieldCount; j++) {
+			HTp token = infile.token(i, j);
+			m_tokens[m_lineOffsets[i] + j] = token;
+			m_tokenLines[m_lineOffsets[i] + j] = i;
+			m_accidentalOffsets[m_lineOffsets[i] + j] = subtokens;
+			if (dataQ && !token->isNull()) {
+				subtokens += 1 + (int)std::count(token->begin(), token->end(), ' ');
+			}
+		}
+	}
+	m_accidentalOffsets[count] = subtokens;
+
+	m_accidentals.assign(subtokens, 0);
+	m_slurs.resize(count);
+	m_beams.resize(count);
+	m_ties.resize(count);
+	m_phrases.resize(count);
+	m_restDiatonic.assign(count, -1);
+	m_restOctave.assign(count, 0);
+	m_nullResolution.assign(count, -1);
+	m_attackLines.assign(count, -1);
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::isIndexCurrent -- Return true if the token index
+//    matches the tokens in the file (i.e., lines or spines have not been
+//    added or removed since the index was created).
+//
+
+bool HumAnalysisTables::isIndexCurrent(HumdrumFileBase& infile) const {
+	int lineCount = infile.getLineCount();
+	if (lineCount + 1 != (int)m_lineOffsets.size()) {
+		return false;
+	}
+	for (int i=0; i<lineCount; i++) {
+		int fieldCount = infile[i].getFieldCount();
+		if (m_lineOffsets[i] + fieldCount != m_lineOffsets[i+1]) {
+			return false;
+		}
+		if ((fieldCount > 0) && (m_tokens[m_lineOffsets[i]] != infile.token(i, 0))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::getLineCount -- Return the number of lines in the
+//    file when the tokens were indexed.
+//
+
+int HumAnalysisTables::getLineCount(void) const {
+	if (m_lineOffsets.empty()) {
+		return 0;
+	}
+	return (int)m_lineOffsets.size() - 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::getTokenCount -- Return the number of indexed tokens.
+//
+
+int HumAnalysisTables::getTokenCount(void) const {
+	return (int)m_tokens.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::getTokenId -- Return the id of a token, or -1 if the
+//    token is not in the index (such as tokens created after the index).
+//
+
+int HumAnalysisTables::getTokenId(HTp token) const {
+	if (token == NULL) {
+		return -1;
+	}
+	int line = token->getLineIndex();
+	if ((line < 0) || (line + 1 >= (int)m_lineOffsets.size())) {
+		return -1;
+	}
+	int id = m_lineOffsets[line] + token->getFieldIndex();
+	if ((id < m_lineOffsets[line]) || (id >= m_lineOffsets[line+1])) {
+		return -1;
+	}
+	if (m_tokens[id] != token) {
+		return -1;
+	}
+	return id;
+}
+
+//
+// Line and field version:
+//
+
+int HumAnalysisTables::getTokenId(int line, int field) const {
+	if ((line < 0) || (line + 1 >= (int)m_lineOffsets.size())) {
+		return -1;
+	}
+	int id = m_lineOffsets[line] + field;
+	if ((field < 0) || (id >= m_lineOffsets[line+1])) {
+		return -1;
+	}
+	return id;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::getToken -- Return the token for a token id.
+//
+
+HTp HumAnalysisTables::getToken(int id) const {
+	if ((id < 0) || (id >= (int)m_tokens.size())) {
+		return NULL;
+	}
+	return m_tokens[id];
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::getTokenLine -- Return the line index of a token id,
+//     or -1 if the id is not valid.
+//
+
+int HumAnalysisTables::getTokenLine(int id) const {
+	if ((id < 0) || (id >= (int)m_tokenLines.size())) {
+		return -1;
+	}
+	return m_tokenLines[id];
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::getTokenField -- Return the field index of a token id
+//     on its line, or -1 if the id is not valid.
+//
+
+int HumAnalysisTables::getTokenField(int id) const {
+	if ((id < 0) || (id >= (int)m_tokenLines.size())) {
+		return -1;
+	}
+	return id - m_lineOffsets[m_tokenLines[id]];
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::setAccidentalFlags -- Add ACCID_VISUAL, ACCID_CAUTIONARY
+//     and/or ACCID_OBLIGATORY states to a subtoken.  Returns false if the
+//     token did not have the subtoken when it was indexed.
+//
+
+bool HumAnalysisTables::setAccidentalFlags(int id, int subtoken, int flags) {
+	int index = getAccidentalIndex(id, subtoken);
+	if (index < 0) {
+		return false;
+	}
+	m_accidentals[index] |= (uint8_t)flags;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::getAccidentalFlags -- Return the accidental states of
+//     a subtoken, or -1 if the subtoken is not stored in the tables.
+//
+
+int HumAnalysisTables::getAccidentalFlags(int id, int subtoken) const {
+	int index = getAccidentalIndex(id, subtoken);
+	if (index < 0) {
+		return -1;
+	}
+	return m_accidentals[index];
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::getAccidentalIndex -- Return the position of the
+//     accidental states of a subtoken in m_accidentals, or -1 if the
+//     token did not have the subtoken when it was indexed.
+//
+
+int HumAnalysisTables::getAccidentalIndex(int id, int subtoken) const {
+	if ((id < 0) || (id + 1 >= (int)m_accidentalOffsets.size()) || (subtoken < 0)) {
+		return -1;
+	}
+	int index = m_accidentalOffsets[id] + subtoken;
+	if (index >= m_accidentalOffsets[id + 1]) {
+		return -1;
+	}
+	return index;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::setRestPosition -- Store the vertical position of
+//     a rest as a diatonic pitch class (0=C to 6=B) and octave.
+//
+
+void HumAnalysisTables::setRestPosition(int id, int diatonic, int octave) {
+	if ((id < 0) || (id >= (int)m_restDiatonic.size())) {
+		return;
+	}
+	m_restDiatonic[id] = (int8_t)diatonic;
+	m_restOctave[id] = (int8_t)octave;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::getRestPosition -- Return the vertical position of a
+//     rest as a diatonic pitch class (0=C to 6=B) and octave.  Returns false
+//     if the rest does not have a vertical position.
+//
+
+bool HumAnalysisTables::getRestPosition(int id, int& diatonic, int& octave) const {
+	if ((id < 0) || (id >= (int)m_restDiatonic.size())) {
+		return false;
+	}
+	if (m_restDiatonic[id] < 0) {
+		return false;
+	}
+	diatonic = m_restDiatonic[id];
+	octave = m_restOctave[id];
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::setNullResolution -- Store the token id of the
+//     non-null data token which a token resolves to, and the line on
+//     which that note was attacked.
+//
+
+void HumAnalysisTables::setNullResolution(int id, int resolved, int attackline) {
+	if ((id < 0) || (id >= (int)m_nullResolution.size())) {
+		return;
+	}
+	m_nullResolution[id] = resolved;
+	m_attackLines[id] = attackline;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::getNullResolution -- Return the token id of the last
+//     non-null data token in the spine at or before the given token, or
+//     -1 if there is none (or the id is not valid).
+//
+
+int HumAnalysisTables::getNullResolution(int id) const {
+	if ((id < 0) || (id >= (int)m_nullResolution.size())) {
+		return -1;
+	}
+	return m_nullResolution[id];
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::getAttackLine -- Return the line on which the note
+//     sounding at the given token was attacked, or -1 if there is none.
+//
+
+int HumAnalysisTables::getAttackLine(int id) const {
+	if ((id < 0) || (id >= (int)m_attackLines.size())) {
+		return -1;
+	}
+	return m_attackLines[id];
+}
+
+
+
+
+
+// Column name, column type and description of each feature, in the order
+// of the HumFeatureExtractor::Feature enumeration:
+
+static const struct {
+	const char* name;
+	HumFeatureTable::ColumnType type;
+	const char* description;
+} HumFeatureList[HumFeatureExtractor::FEATURE_COUNT] = {
+	{ "file",       HumFeatureTable::TYPE_STRING,  "filename" },
+	{ "line",       HumFeatureTable::TYPE_INT32,   "line index of note in file (from 0)" },
+	{ "field",      HumFeatureTable::TYPE_INT32,   "field index of note on line (from 0)" },
+	{ "subtoken",   HumFeatureTable::TYPE_INT32,   "index of note in chord (from 0)" },
+	{ "track",      HumFeatureTable::TYPE_INT32,   "track (spine) number of note (from 1)" },
+	{ "layer",      HumFeatureTable::TYPE_INT32,   "subtrack number of note (0 if spine is not split)" },
+	{ "measure",    HumFeatureTable::TYPE_INT32,   "measure number" },
+	{ "onset",      HumFeatureTable::TYPE_FLOAT64, "quarter notes from start of score" },
+	{ "duration",   HumFeatureTable::TYPE_FLOAT64, "duration in quarter notes (including tied notes)" },
+	{ "metpos",     HumFeatureTable::TYPE_FLOAT64, "quarter notes from start of measure" },
+	{ "beat",       HumFeatureTable::TYPE_FLOAT64, "beat in measure (from 1) in units of the time signature bottom" },
+	{ "metlev",     HumFeatureTable::TYPE_FLOAT64, "metric level of note (0 = beat, 1 = measure, -1 = half beat)" },
+	{ "kern",       HumFeatureTable::TYPE_STRING,  "**kern data for note" },
+	{ "base40",     HumFeatureTable::TYPE_INT32,   "base-40 pitch of note" },
+	{ "midi",       HumFeatureTable::TYPE_INT32,   "MIDI key number of note" },
+	{ "interval",   HumFeatureTable::TYPE_INT32,   "semitones from first note of previous attack in layer" },
+	{ "interval40", HumFeatureTable::TYPE_INT32,   "base-40 interval from first note of previous attack in layer" },
+	{ "tie",        HumFeatureTable::TYPE_INT32,   "1 if note is tied to following notes, otherwise 0" },
+	{ "chord",      HumFeatureTable::TYPE_INT32,   "number of notes in chord (1 for single notes)" },
+	{ "lyric",      HumFeatureTable::TYPE_STRING,  "syllable in first **text spine after note's spine" }
+};
+
+
+
+//////////////////////////////
+//
+// HumFeatureExtractor::HumFeatureExtractor -- Constructor.  All features
+//     are extracted by default.
+//
+
+HumFeatureExtractor::HumFeatureExtractor(void) {
+	m_features.resize(FEATURE_COUNT, true);
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureExtractor::setFeatures -- Select the features to extract from
+//     a list of feature names separated by commas or spaces.  An empty list
+//     selects all features.  Returns false if a name is not recognized
+//     (and no change is made in the selection).
+//
+
+bool HumFeatureExtractor::setFeatures(const string& list) {
+	HumRegex hre;
+	vector<string> names;
+	hre.split(names, list, "[,\\s]+");
+	vector<bool> features(FEATURE_COUNT, false);
+	bool found = false;
+	for (int i=0; i<(int)names.size(); i++) {
+		if (names[i].empty()) {
+			continue;
+		}
+		int index = -1;
+		for (int j=0; j<FEATURE_COUNT; j++) {
+			if (names[i] == HumFeatureList[j].name) {
+				index = j;
+				break;
+			}
+		}
+		if (index < 0) {
+			return false;
+		}
+		features[index] = true;
+		found = true;
+	}
+	if (!found) {
+		fill(features.begin(), features.end(), true);
+	}
+	m_features = features;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureExtractor::setFeature -- Turn the extraction of a feature on
+//     or off.
+//
+
+void HumFeatureExtractor::setFeature(Feature feature, bool state) {
+	m_features.at(feature) = state;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureExtractor::isFeature -- Return true if the feature will be
+//     extracted.
+//
+
+bool HumFeatureExtractor::isFeature(Feature feature) const {
+	return m_features.at(feature);
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureExtractor::getFeatureName -- Return the column name for a
+//     feature.
+//
+
+const char* HumFeatureExtractor::getFeatureName(Feature feature) {
+	if ((feature < 0) || (feature >= FEATURE_COUNT)) {
+		return "";
+	}
+	return HumFeatureList[feature].name;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureExtractor::printFeatureList -- Print the name and description
+//     of each feature.
+//
+
+ostream& HumFeatureExtractor::printFeatureList(ostream& out) {
+	for (int i=0; i<FEATURE_COUNT; i++) {
+		out << HumFeatureList[i].name << "\t" << HumFeatureList[i].description << endl;
+	}
+	return out;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureExtractor::prepareTable -- Add a column to the table for each
+//     selected feature (if the table does not already have the column).
+//
+
+void HumFeatureExtractor::prepareTable(HumFeatureTable& table) const {
+	for (int i=0; i<FEATURE_COUNT; i++) {
+		if (m_features[i]) {
+			table.addColumn(HumFeatureList[i].name, HumFeatureList[i].type);
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureExtractor::extract -- Add a row to the table for each note
+//     attack in the file.  If the filename is empty, the name that the file
+//     was read from is used.
+//
+
+void HumFeatureExtractor::extract(HumdrumFile& infile, HumFeatureTable& table,
+		const string& filename) const {
+	prepareTable(table);
+	vector<int> columns(FEATURE_COUNT, -1);
+	for (int i=0; i<FEATURE_COUNT; i++) {
+		if (m_features[i]) {
+			columns[i] = table.getColumnIndex(HumFeatureList[i].name);
+		}
+	}
+
+	// Analyses done once for the file:
+	vector<int> measures;
+	if (m_features[FEATURE_MEASURE]) {
+		measures = infile.getMeasureNumbers();
+	}
+	vector<double> metlevs;
+	if (m_features[FEATURE_METLEV]) {
+		infile.getMetricLevels(metlevs);
+	}
+	vector<pair<int, HumNum>> timesigs;
+	if (m_features[FEATURE_BEAT]) {
+		infile.getTimeSigs(timesigs);
+	}
+	int fileindex = 0;
+	if (m_features[FEATURE_FILE]) {
+		fileindex = table.addString(filename.empty() ? infile.getFilename() : filename);
+	}
+
+	// previous attacked pitch (base-40) in each track/subtrack:
+	map<pair<int, int>, int> previous;
+
+	for (int i=0; i<infile.getLineCount(); i++) {
+		if (!infile[i].isData()) {
+			continue;
+		}
+		HumNum onset  = infile[i].getDurationFromStart();
+		HumNum metpos = infile[i].getDurationFromBarline();
+		for (int j=0; j<infile[i].getFieldCount(); j++) {
+			HTp token = infile.token(i, j);
+			if (!token->isKern() || token->isNull() || token->isRest()) {
+				continue;
+			}
+			int track = token->getTrack();
+			int layer = token->getSubtrack();
+			int count = token->getSubtokenCount();
+			int first = -1;
+			string lyric;
+			bool lyricQ = false;
+			for (int k=0; k<count; k++) {
+				string subtok = token->getSubtoken(k);
+				if ((subtok.find('r') != string::npos) ||
+						(subtok.find('_') != string::npos) ||
+						(subtok.find(']') != string::npos)) {
+					continue;
+				}
+				int base40 = Convert::kernToBase40(subtok);
+				if (base40 < 0) {
+					continue;
+				}
+				bool tieQ = subtok.find('[') != string::npos;
+				if (first < 0) {
+					first = base40;
+				}
+				table.addRow();
+
+				if (columns[FEATURE_FILE] >= 0) {
+					table.setStringIndex(columns[FEATURE_FILE], fileindex);
+				}
+				if (columns[FEATURE_LINE] >= 0) {
+					table.setInt(columns[FEATURE_LINE], i);
+				}
+				if (columns[FEATURE_FIELD] >= 0) {
+					table.setInt(columns[FEATURE_FIELD], j);
+				}
+				if (columns[FEATURE_SUBTOKEN] >= 0) {
+					table.setInt(columns[FEATURE_SUBTOKEN], k);
+				}
+				if (columns[FEATURE_TRACK] >= 0) {
+					table.setInt(columns[FEATURE_TRACK], track);
+				}
+				if (columns[FEATURE_LAYER] >= 0) {
+					table.setInt(columns[FEATURE_LAYER], layer);
+				}
+				if (columns[FEATURE_MEASURE] >= 0) {
+					table.setInt(columns[FEATURE_MEASURE], measures.at(i));
+				}
+				if (columns[FEATURE_ONSET] >= 0) {
+					table.setFloat(columns[FEATURE_ONSET], onset.getFloat());
+				}
+				if (columns[FEATURE_DURATION] >= 0) {
+					HumNum duration = Convert::recipToDuration(subtok);
+					if (tieQ) {
+						duration += getTiedDuration(token, base40);
+					}
+					table.setFloat(columns[FEATURE_DURATION], duration.getFloat());
+				}
+				if (columns[FEATURE_METPOS] >= 0) {
+					table.setFloat(columns[FEATURE_METPOS], metpos.getFloat());
+				}
+				if ((columns[FEATURE_BEAT] >= 0) && (timesigs.at(i).first > 0)) {
+					HumNum beat = metpos * timesigs[i].second / 4 + 1;
+					table.setFloat(columns[FEATURE_BEAT], beat.getFloat());
+				}
+				if (columns[FEATURE_METLEV] >= 0) {
+					table.setFloat(columns[FEATURE_METLEV], metlevs.at(i));
+				}
+				if (columns[FEATURE_KERN] >= 0) {
+					table.setString(columns[FEATURE_KERN], subtok);
+				}
+				if (columns[FEATURE_BASE40] >= 0) {
+					table.setInt(columns[FEATURE_BASE40], base40);
+				}
+				if (columns[FEATURE_MIDI] >= 0) {
+					table.setInt(columns[FEATURE_MIDI], Convert::base40ToMidiNoteNumber(base40));
+				}
+				auto it = previous.find(std::make_pair(track, layer));
+				if (it != previous.end()) {
+					if (columns[FEATURE_INTERVAL] >= 0) {
+						table.setInt(columns[FEATURE_INTERVAL],
+								Convert::base40ToMidiNoteNumber(base40) -
+								Convert::base40ToMidiNoteNumber(it->second));
+					}
+					if (columns[FEATURE_INTERVAL40] >= 0) {
+						table.setInt(columns[FEATURE_INTERVAL40], base40 - it->second);
+					}
+				}
+				if (columns[FEATURE_TIE] >= 0) {
+					table.setInt(columns[FEATURE_TIE], tieQ ? 1 : 0);
+				}
+				if (columns[FEATURE_CHORD] >= 0) {
+					table.setInt(columns[FEATURE_CHORD], count);
+				}
+				if (columns[FEATURE_LYRIC] >= 0) {
+					if (!lyricQ) {
+						lyric = getLyric(token);
+						lyricQ = true;
+					}
+					table.setString(columns[FEATURE_LYRIC], lyric);
+				}
+			}
+			if (first >= 0) {
+				previous[std::make_pair(track, layer)] = first;
+			}
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureExtractor::getTiedDuration -- Return the duration of the
+//     notes tied to a note (not including the duration of the note
+//     itself), following the notes with the same pitch in the chords of
+//     the following tokens in the spine.
+//
+
+HumNum HumFeatureExtractor::getTiedDuration(HTp token, int base40) const {
+	HumNum output = 0;
+	HTp current = token->getNextToken();
+	while (current) {
+		if (!current->isData() || current->isNull()) {
+			current = current->getNextToken();
+			continue;
+		}
+		string match;
+		for (int k=0; k<current->getSubtokenCount(); k++) {
+			string subtok = current->getSubtoken(k);
+			if ((subtok.find('_') == string::npos) && (subtok.find(']') == string::npos)) {
+				continue;
+			}
+			if (Convert::kernToBase40(subtok) == base40) {
+				match = subtok;
+				break;
+			}
+		}
+		if (match.empty()) {
+			// incomplete tie
+			break;
+		}
+		output += Convert::recipToDuration(match);
+		if (match.find(']') != string::npos) {
+			break;
+		}
+		current = current->getNextToken();
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureExtractor::getLyric -- Return the syllable in the first
+//     **text (or **silbe/**sylb) spine to the right of the token's spine
+//     (skipping other layers of the spine), or an empty string if there is
+//     no syllable on the token's line.
+//
+
+string HumFeatureExtractor::getLyric(HTp token) const {
+	int track = token->getTrack();
+	HTp current = token->getNextFieldToken();
+	while (current && ((current->getTrack() == track) || !current->isKernLike())) {
+		if (current->isDataType("**text") || current->isDataType("**silbe") ||
+				current->isDataType("**sylb")) {
+			return current->isNull() ? "" : (string)*current;
+		}
+		current = current->getNextFieldToken();
+	}
+	return "";
+}
+
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::HumFeatureTable -- Constructor.
+//
+
+HumFeatureTable::HumFeatureTable(void) {
+	clear();
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::clear -- Remove all columns, rows and strings.
+//
+
+void HumFeatureTable::clear(void) {
+	m_columns.clear();
+	clearRows();
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::clearRows -- Remove all rows and strings, but keep
+//     the columns.
+//
+
+void HumFeatureTable::clearRows(void) {
+	for (int i=0; i<(int)m_columns.size(); i++) {
+		m_columns[i].ints.clear();
+		m_columns[i].floats.clear();
+	}
+	m_strings.clear();
+	m_stringIds.clear();
+	m_rows = 0;
+	addString("");
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::addColumn -- Add a column, or return the index of an
+//     existing column with the same name and type.  Existing rows are
+//     given missing values in a new column.  Returns -1 if there is a
+//     column with the same name but a different type, or if the name is
+//     empty or longer than MAX_NAME_SIZE characters.
+//
+
+int HumFeatureTable::addColumn(const string& name, ColumnType type) {
+	int index = getColumnIndex(name);
+	if (index >= 0) {
+		return m_columns[index].type == type ? index : -1;
+	}
+	if (name.empty() || ((int)name.size() > MAX_NAME_SIZE)) {
+		return -1;
+	}
+	m_columns.emplace_back();
+	Column& column = m_columns.back();
+	column.name = name;
+	column.type = type;
+	if (type == TYPE_FLOAT64) {
+		column.floats.resize(m_rows, NAN);
+	} else {
+		column.ints.resize(m_rows, type == TYPE_STRING ? 0 : MISSING_INT);
+	}
+	return (int)m_columns.size() - 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getColumnCount --
+//
+
+int HumFeatureTable::getColumnCount(void) const {
+	return (int)m_columns.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getColumnIndex -- Return -1 if there is no column
+//     with the given name.
+//
+
+int HumFeatureTable::getColumnIndex(const string& name) const {
+	for (int i=0; i<(int)m_columns.size(); i++) {
+		if (m_columns[i].name == name) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getColumnName --
+//
+
+const string& HumFeatureTable::getColumnName(int column) const {
+	return m_columns.at(column).name;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getColumnType --
+//
+
+HumFeatureTable::ColumnType HumFeatureTable::getColumnType(int column) const {
+	return m_columns.at(column).type;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getRowCount --
+//
+
+int64_t HumFeatureTable::getRowCount(void) const {
+	return m_rows;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::addRow -- Add a row with missing values (or empty
+//     strings) in each column.  The set functions fill in the last row.
+//
+
+void HumFeatureTable::addRow(void) {
+	for (int i=0; i<(int)m_columns.size(); i++) {
+		Column& column = m_columns[i];
+		if (column.type == TYPE_FLOAT64) {
+			column.floats.push_back(NAN);
+		} else {
+			column.ints.push_back(column.type == TYPE_STRING ? 0 : MISSING_INT);
+		}
+	}
+	m_rows++;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::setInt -- Set a value in the last row of an integer
+//     column.
+//
+
+void HumFeatureTable::setInt(int column, int32_t value) {
+	m_columns.at(column).ints.back() = value;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::setFloat -- Set a value in the last row of a float
+//     column.
+//
+
+void HumFeatureTable::setFloat(int column, double value) {
+	m_columns.at(column).floats.back() = value;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::setString -- Set a value in the last row of a string
+//     column, adding the string to the dictionary if necessary.
+//
+
+void HumFeatureTable::setString(int column, const string& value) {
+	m_columns.at(column).ints.back() = addString(value);
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::setStringIndex -- Set a value in the last row of a
+//     string column to a string already in the dictionary.  This avoids
+//     looking up strings (such as a filename) which are the same for many
+//     rows.
+//
+
+void HumFeatureTable::setStringIndex(int column, int32_t index) {
+	m_columns.at(column).ints.back() = index;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getInt --
+//
+
+int32_t HumFeatureTable::getInt(int64_t row, int column) const {
+	return m_columns.at(column).ints.at(row);
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getFloat --
+//
+
+double HumFeatureTable::getFloat(int64_t row, int column) const {
+	return m_columns.at(column).floats.at(row);
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getString --
+//
+
+const string& HumFeatureTable::getString(int64_t row, int column) const {
+	return m_strings.at(m_columns.at(column).ints.at(row));
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getIntColumn -- Return the values of an integer column,
+//     or the dictionary indexes of a string column.
+//
+
+const int32_t* HumFeatureTable::getIntColumn(int column) const {
+	return m_columns.at(column).ints.data();
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getFloatColumn --
+//
+
+const double* HumFeatureTable::getFloatColumn(int column) const {
+	return m_columns.at(column).floats.data();
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::addString -- Return the dictionary index of a string,
+//     adding it to the dictionary if it is not already there.
+//
+
+int HumFeatureTable::addString(const string& value) {
+	auto it = m_stringIds.find(value);
+	if (it != m_stringIds.end()) {
+		return it->second;
+	}
+	int index = (int)m_strings.size();
+	m_strings.push_back(value);
+	m_stringIds[value] = index;
+	return index;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getStringCount -- Return the size of the string
+//     dictionary.
+//
+
+int HumFeatureTable::getStringCount(void) const {
+	return (int)m_strings.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getDictionaryString --
+//
+
+const string& HumFeatureTable::getDictionaryString(int index) const {
+	return m_strings.at(index);
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::append -- Add the rows of another table, such as the
+//     table for another file.  If this table has no columns, the columns
+//     of the other table are used.  Returns false if the tables do not have
+//     the same columns.
+//
+
+bool HumFeatureTable::append(const HumFeatureTable& other) {
+	if (m_columns.empty() && (m_rows == 0)) {
+		for (int i=0; i<(int)other.m_columns.size(); i++) {
+			addColumn(other.m_columns[i].name, other.m_columns[i].type);
+		}
+	}
+	if (m_columns.size() != other.m_columns.size()) {
+		return false;
+	}
+	for (int i=0; i<(int)m_columns.size(); i++) {
+		if ((m_columns[i].name != other.m_columns[i].name) ||
+				(m_columns[i].type != other.m_columns[i].type)) {
+			return false;
+		}
+	}
+
+	vector<int32_t> stringmap(other.m_strings.size());
+	for (int i=0; i<(int)other.m_strings.size(); i++) {
+		stringmap[i] = addString(other.m_strings[i]);
+	}
+
+	for (int i=0; i<(int)m_columns.size(); i++) {
+		Column& column = m_columns[i];
+		const Column& source = other.m_columns[i];
+		if (column.type == TYPE_FLOAT64) {
+			column.floats.insert(column.floats.end(), source.floats.begin(),
+					source.floats.end());
+		} else if (column.type == TYPE_STRING) {
+			column.ints.reserve(column.ints.size() + source.ints.size());
+			for (int32_t index : source.ints) {
+				column.ints.push_back(stringmap.at(index));
+			}
+		} else {
+			column.ints.insert(column.ints.end(), source.ints.begin(),
+					source.ints.end());
+		}
+	}
+	m_rows += other.m_rows;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::write -- Write the table in the binary format described
+//     in HumFeatureTable.h.
+//
+
+bool HumFeatureTable::write(ostream& out) const {
+	auto padding = [](uint64_t size) { return (8 - size % 8) % 8; };
+	const char zeros[8] = {0};
+
+	uint64_t textsize = 0;
+	for (int i=0; i<(int)m_strings.size(); i++) {
+		textsize += m_strings[i].size() + 1;
+	}
+	uint64_t offset = 40 + 48 * m_columns.size();
+	offset += 8 * (m_strings.size() + 1);
+	offset += textsize + padding(textsize);
+
+	char header[40] = {0};
+	memcpy(header, "HUMFEAT1", 8);
+	uint32_t bom = 0x01020304;
+	uint32_t columncount = (uint32_t)m_columns.size();
+	uint32_t stringcount = (uint32_t)m_strings.size();
+	memcpy(header + 8,  &bom,         4);
+	memcpy(header + 12, &columncount, 4);
+	memcpy(header + 16, &stringcount, 4);
+	memcpy(header + 24, &m_rows,      8);
+	memcpy(header + 32, &textsize,    8);
+	out.write(header, sizeof(header));
+
+	for (int i=0; i<(int)m_columns.size(); i++) {
+		char descriptor[48] = {0};
+		const Column& column = m_columns[i];
+		memcpy(descriptor, column.name.data(), column.name.size());
+		uint32_t type = (uint32_t)column.type;
+		memcpy(descriptor + 32, &type,   4);
+		memcpy(descriptor + 40, &offset, 8);
+		out.write(descriptor, sizeof(descriptor));
+		uint64_t size = m_rows * (column.type == TYPE_FLOAT64 ? 8 : 4);
+		offset += size + padding(size);
+	}
+
+	uint64_t position = 0;
+	for (int i=0; i<=(int)m_strings.size(); i++) {
+		out.write((const char*)&position, 8);
+		if (i < (int)m_strings.size()) {
+			position += m_strings[i].size() + 1;
+		}
+	}
+	for (int i=0; i<(int)m_strings.size(); i++) {
+		out.write(m_strings[i].c_str(), m_strings[i].size() + 1);
+	}
+	out.write(zeros, padding(textsize));
+
+	for (int i=0; i<(int)m_columns.size(); i++) {
+		const Column& column = m_columns[i];
+		uint64_t size;
+		if (column.type == TYPE_FLOAT64) {
+			size = column.floats.size() * 8;
+			out.write((const char*)column.floats.data(), size);
+		} else {
+			size = column.ints.size() * 4;
+			out.write((const char*)column.ints.data(), size);
+		}
+		out.write(zeros, padding(size));
+	}
+
+	return out.good();
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::writeFile --
+//
+
+bool HumFeatureTable::writeFile(const string& filename) const {
+	std::ofstream output(filename, std::ios::binary);
+	if (!output.is_open()) {
+		return false;
+	}
+	return write(output);
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::read -- Copy a table from data in the binary format.
+//     Returns false if the data is not a valid table.
+//
+
+bool HumFeatureTable::read(const char* data, size_t size) {
+	clear();
+	HumFeatureView view;
+	if (!view.open(data, size) || (view.getDictionaryString(0)[0] != '\0')) {
+		return false;
+	}
+	for (int i=1; i<view.getStringCount(); i++) {
+		addString(view.getDictionaryString(i));
+	}
+	if (getStringCount() != view.getStringCount()) {
+		// duplicate strings in the dictionary
+		clear();
+		return false;
+	}
+	m_rows = view.getRowCount();
+	for (int i=0; i<view.getColumnCount(); i++) {
+		m_columns.emplace_back();
+		Column& column = m_columns.back();
+		column.name = view.getColumnName(i);
+		column.type = view.getColumnType(i);
+		if (column.type == TYPE_FLOAT64) {
+			const double* values = view.getFloatColumn(i);
+			column.floats.assign(values, values + m_rows);
+		} else {
+			const int32_t* values = view.getIntColumn(i);
+			column.ints.assign(values, values + m_rows);
+		}
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::readFile --
+//
+
+bool HumFeatureTable::readFile(const string& filename) {
+	ifstream input(filename, std::ios::binary | std::ios::ate);
+	if (!input.is_open()) {
+		return false;
+	}
+	size_t size = (size_t)input.tellg();
+	input.seekg(0);
+	// uint64_t storage keeps the columns aligned:
+	vector<uint64_t> buffer((size + 7) / 8);
+	input.read((char*)buffer.data(), size);
+	if (!input) {
+		return false;
+	}
+	return read((const char*)buffer.data(), size);
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::printTsv -- Print the table as tab-separated values
+//     with a header line of column names.  Missing values are empty.
+//
+
+ostream& HumFeatureTable::printTsv(ostream& out) const {
+	for (int i=0; i<(int)m_columns.size(); i++) {
+		if (i > 0) {
+			out << '\t';
+		}
+		out << m_columns[i].name;
+	}
+	out << '\n';
+	std::streamsize precision = out.precision(15);
+	for (int64_t r=0; r<m_rows; r++) {
+		for (int i=0; i<(int)m_columns.size(); i++) {
+			if (i > 0) {
+				out << '\t';
+			}
+			const Column& column = m_columns[i];
+			if (column.type == TYPE_FLOAT64) {
+				if (!std::isnan(column.floats[r])) {
+					out << column.floats[r];
+				}
+			} else if (column.type == TYPE_STRING) {
+				out << m_strings[column.ints[r]];
+			} else if (column.ints[r] != MISSING_INT) {
+				out << column.ints[r];
+			}
+		}
+		out << '\n';
+	}
+	out.precision(precision);
+	return out;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::HumFeatureView -- Constructor.
+//
+
+HumFeatureView::HumFeatureView(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::open -- Check that the data is a valid feature table,
+//     and prepare to read it.  Returns false if the data is not valid.
+//
+
+bool HumFeatureView::open(const char* data, size_t size) {
+	close();
+	if ((data == NULL) || (size < 40) || ((uintptr_t)data % 8 != 0)) {
+		return false;
+	}
+	if (memcmp(data, "HUMFEAT1", 8) != 0) {
+		return false;
+	}
+	uint32_t bom;
+	uint32_t columncount;
+	uint32_t stringcount;
+	int64_t rows;
+	uint64_t textsize;
+	memcpy(&bom,         data + 8,  4);
+	memcpy(&columncount, data + 12, 4);
+	memcpy(&stringcount, data + 16, 4);
+	memcpy(&rows,        data + 24, 8);
+	memcpy(&textsize,    data + 32, 8);
+	if ((bom != 0x01020304) || (rows < 0) || (stringcount < 1)) {
+		return false;
+	}
+
+	uint64_t offsets = 40 + 48 * (uint64_t)columncount;
+	uint64_t text = offsets + 8 * ((uint64_t)stringcount + 1);
+	if ((text > size) || (textsize > size - text)) {
+		return false;
+	}
+	const uint64_t* stringoffsets = (const uint64_t*)(data + offsets);
+	for (uint32_t i=0; i<=stringcount; i++) {
+		if ((stringoffsets[i] > textsize) ||
+				((i > 0) && (stringoffsets[i] <= stringoffsets[i-1]))) {
+			return false;
+		}
+	}
+	if ((stringoffsets[0] != 0) || (stringoffsets[stringcount] != textsize) ||
+			(data[text + textsize - 1] != '\0')) {
+		return false;
+	}
+
+	for (uint32_t i=0; i<columncount; i++) {
+		const char* descriptor = data + 40 + 48 * i;
+		if (memchr(descriptor, '\0', 32) == NULL) {
+			return false;
+		}
+		uint32_t type;
+		uint64_t offset;
+		memcpy(&type,   descriptor + 32, 4);
+		memcpy(&offset, descriptor + 40, 8);
+		if ((type < HumFeatureTable::TYPE_INT32) || (type > HumFeatureTable::TYPE_STRING)) {
+			return false;
+		}
+		uint64_t width = (type == HumFeatureTable::TYPE_FLOAT64) ? 8 : 4;
+		if ((offset % 8 != 0) || (offset > size) ||
+				((uint64_t)rows > (size - offset) / width)) {
+			return false;
+		}
+		if (type == HumFeatureTable::TYPE_STRING) {
+			const int32_t* values = (const int32_t*)(data + offset);
+			for (int64_t r=0; r<rows; r++) {
+				if ((values[r] < 0) || ((uint32_t)values[r] >= stringcount)) {
+					return false;
+				}
+			}
+		}
+	}
+
+	m_data          = data;
+	m_size          = size;
+	m_columnCount   = (int)columncount;
+	m_stringCount   = (int)stringcount;
+	m_rows          = rows;
+	m_stringOffsets = stringoffsets;
+	m_stringText    = data + text;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::close -- Stop using the data (which is not freed).
+//
+
+void HumFeatureView::close(void) {
+	m_data          = NULL;
+	m_size          = 0;
+	m_columnCount   = 0;
+	m_stringCount   = 0;
+	m_rows          = 0;
+	m_stringOffsets = NULL;
+	m_stringText    = NULL;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::isOpen --
+//
+
+bool HumFeatureView::isOpen(void) const {
+	return m_data != NULL;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::getColumnCount --
+//
+
+int HumFeatureView::getColumnCount(void) const {
+	return m_columnCount;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::getColumnIndex -- Return -1 if there is no column with
+//     the given name.
+//
+
+int HumFeatureView::getColumnIndex(const string& name) const {
+	for (int i=0; i<m_columnCount; i++) {
+		if (name == getColumnName(i)) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::getColumnName --
+//
+
+const char* HumFeatureView::getColumnName(int column) const {
+	return m_data + 40 + 48 * column;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::getColumnType --
+//
+
+HumFeatureTable::ColumnType HumFeatureView::getColumnType(int column) const {
+	uint32_t type;
+	memcpy(&type, m_data + 40 + 48 * column + 32, 4);
+	return (HumFeatureTable::ColumnType)type;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::getRowCount --
+//
+
+int64_t HumFeatureView::getRowCount(void) const {
+	return m_rows;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::getColumnData -- Return the start of the array for a
+//     column.
+//
+
+const char* HumFeatureView::getColumnData(int column) const {
+	uint64_t offset;
+	memcpy(&offset, m_data + 40 + 48 * column + 40, 8);
+	return m_data + offset;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::getIntColumn -- Return the values of an integer column,
+//     or the dictionary indexes of a string column.
+//
+
+const int32_t* HumFeatureView::getIntColumn(int column) const {
+	return (const int32_t*)getColumnData(column);
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::getFloatColumn --
+//
+
+const double* HumFeatureView::getFloatColumn(int column) const {
+	return (const double*)getColumnData(column);
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::getStringCount -- Return the size of the string
+//     dictionary.
+//
+
+int HumFeatureView::getStringCount(void) const {
+	return m_stringCount;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::getDictionaryString --
+//
+
+const char* HumFeatureView::getDictionaryString(int index) const {
+	return m_stringText + m_stringOffsets[index];
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::getString -- Return a value in a string column.
+//
+
+const char* HumFeatureView::getString(int64_t row, int column) const {
+	return getDictionaryString(getIntColumn(column)[row]);
+}
+
+
+
 //////////////////////////////
 //
 // HumGrid::HumGrid -- Constructor.
@@ -14504,11 +16172,258 @@ ostream& operator<<(ostream& out, HumHash* hash) {
 
 
 
-typedef unsigned long long TEMP64BITFIX;
 
-// declare static variables
-vector<_HumInstrument> HumInstrument::m_data;
-int HumInstrument::m_classcount = 0;
+// _HumInstrumentEntry: storage for the instrument table.  The public
+// _HumInstrument class (with string members) is returned by getInstrument().
+
+struct _HumInstrumentEntry {
+	const char* humdrum;  // instrument code (without the *I prefix)
+	int         gm;       // General MIDI instrument number
+	const char* name;     // English name of the instrument
+};
+
+// Humdrum instrument codes, sorted by code (in strcmp() order) so that they
+// can be found with a binary search:
+
+static constexpr _HumInstrumentEntry HumInstrumentTable[] = {
+	{ "accor",   GM_ACCORDION,              "accordion" },
+	{ "alto",    GM_RECORDER,               "alto" },
+	{ "anvil",   GM_TINKLE_BELL,            "anvil" },
+	{ "archl",   GM_ACOUSTIC_GUITAR_NYLON,  "archlute" },
+	{ "armon",   GM_HARMONICA,              "harmonica" },
+	{ "arpa",    GM_ORCHESTRAL_HARP,        "harp" },
+	{ "bagpI",   GM_BAGPIPE,                "bagpipe (Irish)" },
+	{ "bagpS",   GM_BAGPIPE,                "bagpipe (Scottish)" },
+	{ "banjo",   GM_BANJO,                  "banjo" },
+	{ "bansu",   GM_FLUTE,                  "bansuri" },
+	{ "barit",   GM_CHOIR_AAHS,             "baritone" },
+	{ "baset",   GM_CLARINET,               "bassett horn" },
+	{ "bass",    GM_CHOIR_AAHS,             "bass" },
+	{ "bdrum",   GM_TAIKO_DRUM,             "bass drum" },
+	{ "bguit",   GM_ELECTRIC_BASS_FINGER,   "electric bass guitar" },
+	{ "biwa",    GM_FLUTE,                  "biwa" },
+	{ "bongo",   GM_TAIKO_DRUM,             "bongo" },
+	{ "brush",   GM_BREATH_NOISE,           "brush" },
+	{ "bscan",   GM_CHOIR_AAHS,             "basso cantante" },
+	{ "bspro",   GM_CHOIR_AAHS,             "basso profondo" },
+	{ "bugle",   GM_TRUMPET,                "bugle" },
+	{ "calam",   GM_OBOE,                   "chalumeau" },
+	{ "calpe",   GM_LEAD_CALLIOPE,          "calliope" },
+	{ "calto",   GM_CHOIR_AAHS,             "contralto" },
+	{ "campn",   GM_TUBULAR_BELLS,          "bell" },
+	{ "cangl",   GM_ENGLISH_HORN,           "english horn" },
+	{ "canto",   GM_CHOIR_AAHS,             "canto" },
+	{ "caril",   GM_TUBULAR_BELLS,          "carillon" },
+	{ "castr",   GM_CHOIR_AAHS,             "castrato" },
+	{ "casts",   GM_WOODBLOCKS,             "castanets" },
+	{ "cbass",   GM_CONTRABASS,             "contrabass" },
+	{ "cello",   GM_CELLO,                  "violoncello" },
+	{ "cemba",   GM_HARPSICHORD,            "harpsichord" },
+	{ "cetra",   GM_VIOLIN,                 "cittern" },
+	{ "chain",   GM_TINKLE_BELL,            "chains" },
+	{ "chcym",   GM_REVERSE_CYMBAL,         "China cymbal" },
+	{ "chime",   GM_TUBULAR_BELLS,          "chimes" },
+	{ "chlma",   GM_BASSOON,                "alto shawm" },
+	{ "chlms",   GM_BASSOON,                "soprano shawm" },
+	{ "chlmt",   GM_BASSOON,                "tenor shawm" },
+	{ "clap",    GM_GUNSHOT,                "hand clapping" },
+	{ "clara",   GM_CLARINET,               "alto clarinet" },
+	{ "clarb",   GM_CLARINET,               "bass clarinet" },
+	{ "clarp",   GM_CLARINET,               "piccolo clarinet" },
+	{ "clars",   GM_CLARINET,               "clarinet" },
+	{ "clave",   GM_AGOGO,                  "claves" },
+	{ "clavi",   GM_CLAVI,                  "clavichord" },
+	{ "clest",   GM_CELESTA,                "celesta" },
+	{ "clrno",   GM_TRUMPET,                "clarino" },
+	{ "colsp",   GM_FLUTE,                  "coloratura soprano" },
+	{ "conga",   GM_TAIKO_DRUM,             "conga" },
+	{ "cor",     GM_FRENCH_HORN,            "horn" },
+	{ "cornm",   GM_BAGPIPE,                "French bagpipe" },
+	{ "corno",   GM_TRUMPET,                "cornett" },
+	{ "cornt",   GM_TRUMPET,                "cornet" },
+	{ "coro",    GM_CHOIR_AAHS,             "chorus" },
+	{ "crshc",   GM_REVERSE_CYMBAL,         "crash cymbal" },
+	{ "ctenor",  GM_CHOIR_AAHS,             "counter-tenor" },
+	{ "ctina",   GM_ACCORDION,              "concertina" },
+	{ "drmsp",   GM_FLUTE,                  "dramatic soprano" },
+	{ "drum",    GM_SYNTH_DRUM,             "drum" },
+	{ "drumP",   GM_SYNTH_DRUM,             "small drum" },
+	{ "dulc",    GM_DULCIMER,               "dulcimer" },
+	{ "eguit",   GM_ELECTRIC_GUITAR_CLEAN,  "electric guitar" },
+	{ "fag_c",   GM_BASSOON,                "contrabassoon" },
+	{ "fagot",   GM_BASSOON,                "bassoon" },
+	{ "false",   GM_RECORDER,               "falsetto" },
+	{ "fdrum",   GM_TAIKO_DRUM,             "frame drum" },
+	{ "feme",    GM_CHOIR_AAHS,             "female voice" },
+	{ "fife",    GM_BLOWN_BOTTLE,           "fife" },
+	{ "fingc",   GM_REVERSE_CYMBAL,         "finger cymbal" },
+	{ "flt",     GM_FLUTE,                  "flute" },
+	{ "flt_a",   GM_FLUTE,                  "alto flute" },
+	{ "flt_b",   GM_FLUTE,                  "bass flute" },
+	{ "fltda",   GM_RECORDER,               "alto recorder" },
+	{ "fltdb",   GM_RECORDER,               "bass recorder" },
+	{ "fltdn",   GM_RECORDER,               "sopranino recorder" },
+	{ "fltds",   GM_RECORDER,               "soprano recorder" },
+	{ "fltdt",   GM_RECORDER,               "tenor recorder" },
+	{ "flugh",   GM_FRENCH_HORN,            "flugelhorn" },
+	{ "forte",   GM_HONKYTONK_PIANO,        "fortepiano" },
+	{ "gen",     GM_ACOUSTIC_GRAND_PIANO,   "generic instrument" },
+	{ "genB",    GM_ACOUSTIC_GRAND_PIANO,   "generic bass instrument" },
+	{ "genT",    GM_ACOUSTIC_GRAND_PIANO,   "generic treble instrument" },
+	{ "glock",   GM_GLOCKENSPIEL,           "glockenspiel" },
+	{ "gong",    GM_REVERSE_CYMBAL,         "gong" },
+	{ "guitr",   GM_ACOUSTIC_GUITAR_NYLON,  "guitar" },
+	{ "hammd",   GM_DRAWBAR_ORGAN,          "Hammond electronic organ" },
+	{ "hbell",   GM_TINKLE_BELL,            "handbell" },
+	{ "heck",    GM_BASSOON,                "heckelphone" },
+	{ "heltn",   GM_CHOIR_AAHS,             "Heldentenor" },
+	{ "hichi",   GM_OBOE,                   "hichiriki" },
+	{ "hurdy",   GM_LEAD_CALLIOPE,          "hurdy-gurdy" },
+	{ "kitv",    GM_VIOLIN,                 "kit violin" },
+	{ "klav",    GM_ACOUSTIC_GRAND_PIANO,   "keyboard" },
+	{ "kokyu",   GM_FIDDLE,                 "kokyu" },
+	{ "komun",   GM_KOTO,                   "komun'go" },
+	{ "koto",    GM_KOTO,                   "koto" },
+	{ "kruma",   GM_TRUMPET,                "alto crumhorn" },
+	{ "krumb",   GM_TRUMPET,                "bass crumhorn" },
+	{ "krums",   GM_TRUMPET,                "soprano crumhorn" },
+	{ "krumt",   GM_TRUMPET,                "tenor crumhorn" },
+	{ "lion",    GM_AGOGO,                  "lion's roar" },
+	{ "liuto",   GM_ACOUSTIC_GUITAR_NYLON,  "lute" },
+	{ "lyrsp",   GM_FLUTE,                  "lyric soprano" },
+	{ "lyrtn",   GM_FRENCH_HORN,            "lyric tenor" },
+	{ "male",    GM_CHOIR_AAHS,             "male voice" },
+	{ "mando",   GM_ACOUSTIC_GUITAR_NYLON,  "mandolin" },
+	{ "marac",   GM_AGOGO,                  "maracas" },
+	{ "marim",   GM_MARIMBA,                "marimba" },
+	{ "mbari",   GM_CHOIR_AAHS,             "high baritone" },
+	{ "mezzo",   GM_CHOIR_AAHS,             "mezzo soprano" },
+	{ "nfant",   GM_CHOIR_AAHS,             "child's voice" },
+	{ "nokan",   GM_SHAKUHACHI,             "nokan" },
+	{ "oboe",    GM_OBOE,                   "oboe" },
+	{ "oboeD",   GM_ENGLISH_HORN,           "oboe d'amore" },
+	{ "ocari",   GM_OCARINA,                "ocarina" },
+	{ "ondes",   GM_PAD_SWEEP,              "ondes Martenot" },
+	{ "ophic",   GM_TUBA,                   "ophicleide" },
+	{ "organ",   GM_CHURCH_ORGAN,           "pipe organ" },
+	{ "oud",     GM_ACOUSTIC_GUITAR_NYLON,  "oud" },
+	{ "paila",   GM_AGOGO,                  "timbales" },
+	{ "panpi",   GM_PAN_FLUTE,              "panpipe" },
+	{ "pbell",   GM_TUBULAR_BELLS,          "bell plate" },
+	{ "pguit",   GM_ACOUSTIC_GUITAR_NYLON,  "Portuguese guitar" },
+	{ "physh",   GM_REED_ORGAN,             "physharmonica" },
+	{ "piano",   GM_ACOUSTIC_GRAND_PIANO,   "pianoforte" },
+	{ "piatt",   GM_REVERSE_CYMBAL,         "cymbals" },
+	{ "picco",   GM_PICCOLO,                "piccolo" },
+	{ "pipa",    GM_ACOUSTIC_GUITAR_NYLON,  "Chinese lute" },
+	{ "porta",   GM_TANGO_ACCORDION,        "portative organ" },
+	{ "psalt",   GM_CLAVI,                  "psaltery" },
+	{ "qin",     GM_CLAVI,                  "qin" },
+	{ "quinto",  GM_CHOIR_AAHS,             "quinto" },
+	{ "quitr",   GM_ACOUSTIC_GUITAR_NYLON,  "gittern" },
+	{ "rackt",   GM_TRUMPET,                "racket" },
+	{ "ratl",    GM_WOODBLOCKS,             "rattle" },
+	{ "rebec",   GM_ACOUSTIC_GUITAR_NYLON,  "rebec" },
+	{ "recit",   GM_CHOIR_AAHS,             "recitativo" },
+	{ "reedo",   GM_REED_ORGAN,             "reed organ" },
+	{ "rhode",   GM_ELECTRIC_PIANO_1,       "Fender-Rhodes electric piano" },
+	{ "ridec",   GM_REVERSE_CYMBAL,         "ride cymbal" },
+	{ "sarod",   GM_SITAR,                  "sarod" },
+	{ "sarus",   GM_TUBA,                   "sarrusophone" },
+	{ "saxA",    GM_ALTO_SAX,               "alto saxophone" },
+	{ "saxB",    GM_BARITONE_SAX,           "bass saxophone" },
+	{ "saxC",    GM_BARITONE_SAX,           "contrabass saxophone" },
+	{ "saxN",    GM_SOPRANO_SAX,            "sopranino saxophone" },
+	{ "saxR",    GM_BARITONE_SAX,           "baritone saxophone" },
+	{ "saxS",    GM_SOPRANO_SAX,            "soprano saxophone" },
+	{ "saxT",    GM_TENOR_SAX,              "tenor saxophone" },
+	{ "sbell",   GM_TINKLE_BELL,            "sleigh bells" },
+	{ "sdrum",   GM_SYNTH_DRUM,             "snare drum (kit)" },
+	{ "shaku",   GM_SHAKUHACHI,             "shakuhachi" },
+	{ "shami",   GM_SHAMISEN,               "shamisen" },
+	{ "sheng",   GM_SHANAI,                 "sheng" },
+	{ "sho",     GM_SHANAI,                 "sho" },
+	{ "siren",   GM_FX_SCI_FI,              "siren" },
+	{ "sitar",   GM_SITAR,                  "sitar" },
+	{ "slap",    GM_GUNSHOT,                "slapstick" },
+	{ "soprn",   GM_CHOIR_AAHS,             "soprano" },
+	{ "spshc",   GM_REVERSE_CYMBAL,         "splash cymbal" },
+	{ "steel",   GM_STEEL_DRUMS,            "steel-drum" },
+	{ "stim",    GM_SEASHORE,               "Sprechstimme" },
+	{ "stimA",   GM_SEASHORE,               "Sprechstimme, alto" },
+	{ "stimB",   GM_SEASHORE,               "Sprechstimme, bass" },
+	{ "stimC",   GM_SEASHORE,               "Sprechstimme, contralto" },
+	{ "stimR",   GM_SEASHORE,               "Sprechstimme, baritone" },
+	{ "stimS",   GM_SEASHORE,               "Sprechstimme, soprano" },
+	{ "strdr",   GM_AGOGO,                  "string drum" },
+	{ "sxhA",    GM_ALTO_SAX,               "alto saxhorn" },
+	{ "sxhB",    GM_BARITONE_SAX,           "bass saxhorn" },
+	{ "sxhC",    GM_BARITONE_SAX,           "contrabass saxhorn" },
+	{ "sxhR",    GM_BARITONE_SAX,           "baritone saxhorn" },
+	{ "sxhS",    GM_SOPRANO_SAX,            "soprano saxhorn" },
+	{ "sxhT",    GM_TENOR_SAX,              "tenor saxhorn" },
+	{ "synth",   GM_ELECTRIC_PIANO_2,       "keyboard synthesizer" },
+	{ "tabla",   GM_MELODIC_DRUM,           "tabla" },
+	{ "tambn",   GM_TINKLE_BELL,            "tambourine" },
+	{ "tambu",   GM_MELODIC_DRUM,           "tambura" },
+	{ "tanbr",   GM_MELODIC_DRUM,           "tanbur" },
+	{ "tblok",   GM_WOODBLOCKS,             "temple blocks" },
+	{ "tdrum",   GM_SYNTH_DRUM,             "tenor drum" },
+	{ "tenor",   GM_CHOIR_AAHS,             "tenor" },
+	{ "timpa",   GM_MELODIC_DRUM,           "timpani" },
+	{ "tiorb",   GM_ACOUSTIC_GUITAR_NYLON,  "theorbo" },
+	{ "tom",     GM_TAIKO_DRUM,             "tom-tom drum" },
+	{ "trngl",   GM_TINKLE_BELL,            "triangle" },
+	{ "tromb",   GM_TROMBONE,               "bass trombone" },
+	{ "tromp",   GM_TRUMPET,                "trumpet" },
+	{ "tromt",   GM_TROMBONE,               "tenor trombone" },
+	{ "tuba",    GM_TUBA,                   "tuba" },
+	{ "tubaB",   GM_TUBA,                   "bass tuba" },
+	{ "tubaC",   GM_TUBA,                   "contrabass tuba" },
+	{ "tubaT",   GM_TUBA,                   "tenor tuba" },
+	{ "tubaU",   GM_TUBA,                   "subcontra tuba" },
+	{ "ukule",   GM_ACOUSTIC_GUITAR_NYLON,  "ukulele" },
+	{ "vibra",   GM_VIBRAPHONE,             "vibraphone" },
+	{ "vina",    GM_SITAR,                  "vina" },
+	{ "viola",   GM_VIOLA,                  "viola" },
+	{ "violb",   GM_CONTRABASS,             "bass viola da gamba" },
+	{ "viold",   GM_VIOLA,                  "viola d'amore" },
+	{ "violn",   GM_VIOLIN,                 "violin" },
+	{ "violp",   GM_VIOLIN,                 "piccolo violin" },
+	{ "viols",   GM_VIOLIN,                 "treble viola da gamba" },
+	{ "violt",   GM_CELLO,                  "tenor viola da gamba" },
+	{ "vox",     GM_CHOIR_AAHS,             "generic voice" },
+	{ "wblok",   GM_WOODBLOCKS,             "woodblock" },
+	{ "xylo",    GM_XYLOPHONE,              "xylophone" },
+	{ "zithr",   GM_CLAVI,                  "zither" },
+	{ "zurna",   GM_ACOUSTIC_GUITAR_NYLON,  "zurna" }
+};
+
+
+static constexpr int HumInstrumentCount =
+		(int)(sizeof(HumInstrumentTable) / sizeof(HumInstrumentTable[0]));
+
+
+// isSortedInstrumentTable: used to check at compile time that the
+// instrument table is sorted and has no duplicate codes.
+
+static constexpr bool isSortedInstrumentTable(void) {
+	for (int i=1; i<HumInstrumentCount; i++) {
+		const char* a = HumInstrumentTable[i-1].humdrum;
+		const char* b = HumInstrumentTable[i].humdrum;
+		while ((*a != '\0') && (*a == *b)) {
+			a++;
+			b++;
+		}
+		if ((unsigned char)*a >= (unsigned char)*b) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static_assert(isSortedInstrumentTable(), "HumInstrumentTable must be sorted by code");
+
 
 
 //////////////////////////////
@@ -14517,10 +16432,6 @@ int HumInstrument::m_classcount = 0;
 //
 
 HumInstrument::HumInstrument(void) {
-	if (m_classcount == 0) {
-		initialize();
-	}
-	m_classcount++;
 	m_index = -1;
 }
 
@@ -14532,10 +16443,7 @@ HumInstrument::HumInstrument(void) {
 //
 
 HumInstrument::HumInstrument(const string& Hname) {
-	if (m_classcount == 0) {
-		initialize();
-	}
-
+	m_humdrum = Hname;
 	m_index = find(Hname);
 }
 
@@ -14558,8 +16466,12 @@ HumInstrument::~HumInstrument() {
 //
 
 int HumInstrument::getGM(void) {
-	if (m_index > 0) {
-		return m_data[m_index].gm;
+	auto it = m_gm.find(m_humdrum);
+	if (it != m_gm.end()) {
+		return it->second;
+	}
+	if (m_index >= 0) {
+		return HumInstrumentTable[m_index].gm;
 	} else {
 		return -1;
 	}
@@ -14573,15 +16485,14 @@ int HumInstrument::getGM(void) {
 //
 
 int HumInstrument::getGM(const string& Hname) {
-	int tindex;
-	if (Hname.compare(0, 2, "*I") == 0) {
-		tindex = find(Hname.substr(2));
-	} else {
-		tindex = find(Hname);
+	string code = stripPrefix(Hname);
+	auto it = m_gm.find(code);
+	if (it != m_gm.end()) {
+		return it->second;
 	}
-
-	if (tindex > 0) {
-		return m_data[tindex].gm;
+	int tindex = find(code);
+	if (tindex >= 0) {
+		return HumInstrumentTable[tindex].gm;
 	} else {
 		return -1;
 	}
@@ -14595,8 +16506,10 @@ int HumInstrument::getGM(const string& Hname) {
 //
 
 string HumInstrument::getName(void) {
-	if (m_index > 0) {
-		return m_data[m_index].name;
+	if (m_index >= 0) {
+		return HumInstrumentTable[m_index].name;
+	} else if (m_gm.find(m_humdrum) != m_gm.end()) {
+		return m_humdrum;
 	} else {
 		return "";
 	}
@@ -14610,14 +16523,12 @@ string HumInstrument::getName(void) {
 //
 
 string HumInstrument::getName(const string& Hname) {
-	int tindex;
-	if (Hname.compare(0, 2, "*I") == 0) {
-		tindex = find(Hname.substr(2));
-	} else{
-		tindex = find(Hname);
-	}
-	if (tindex > 0) {
-		return m_data[tindex].name;
+	string code = stripPrefix(Hname);
+	int tindex = find(code);
+	if (tindex >= 0) {
+		return HumInstrumentTable[tindex].name;
+	} else if (m_gm.find(code) != m_gm.end()) {
+		return code;
 	} else {
 		return "";
 	}
@@ -14631,8 +16542,8 @@ string HumInstrument::getName(const string& Hname) {
 //
 
 string HumInstrument::getHumdrum(void) {
-	if (m_index > 0) {
-		return m_data[m_index].humdrum;
+	if ((m_index >= 0) || (m_gm.find(m_humdrum) != m_gm.end())) {
+		return m_humdrum;
 	} else {
 		return "";
 	}
@@ -14642,21 +16553,18 @@ string HumInstrument::getHumdrum(void) {
 
 //////////////////////////////
 //
-// HumInstrument::setGM --
+// HumInstrument::setGM -- Set the General MIDI instrument for an
+//     instrument code in this object, adding the code if it is not in the
+//     table.  Returns the index of the code in the table (or -1 if it is
+//     not in the table), or 0 if the instrument number is invalid.
 //
 
 int HumInstrument::setGM(const string& Hname, int aValue) {
 	if (aValue < 0 || aValue > 127) {
 		return 0;
 	}
-	int rindex = find(Hname);
-	if (rindex > 0) {
-		m_data[rindex].gm = aValue;
-	} else {
-		afi(Hname.c_str(), aValue, Hname.c_str());
-		sortData();
-	}
-	return rindex;
+	m_gm[Hname] = aValue;
+	return find(Hname);
 }
 
 
@@ -14667,314 +16575,1294 @@ int HumInstrument::setGM(const string& Hname, int aValue) {
 //
 
 void HumInstrument::setHumdrum(const string& Hname) {
-	if (Hname.compare(0, 2, "*I") == 0) {
-		m_index = find(Hname.substr(2));
-	} else {
-		m_index = find(Hname);
+	m_humdrum = stripPrefix(Hname);
+	m_index = find(m_humdrum);
+}
+
+
+
+//////////////////////////////
+//
+// HumInstrument::getInstrumentCount -- Return the number of instrument
+//     codes in the table.
+//
+
+int HumInstrument::getInstrumentCount(void) {
+	return HumInstrumentCount;
+}
+
+
+
+//////////////////////////////
+//
+// HumInstrument::getInstrument -- Return a copy of an entry of the
+//     instrument table (in order of instrument code), or an empty entry if
+//     the index is invalid.
+//
+
+_HumInstrument HumInstrument::getInstrument(int index) {
+	_HumInstrument output;
+	if ((index < 0) || (index >= HumInstrumentCount)) {
+		return output;
 	}
-                                             }
+	output.humdrum = HumInstrumentTable[index].humdrum;
+	output.name    = HumInstrumentTable[index].name;
+	output.gm      = HumInstrumentTable[index].gm;
+	return output;
+}
 
 
 
 //////////////////////////////////////////////////////////////////////////
 //
-// private functions
+// protected functions
 //
 
 
 //////////////////////////////
 //
-// HumInstrument::initialize --
-//
-void HumInstrument::initialize(void) {
-   m_data.reserve(500);
-
-	// List has to be sorted by first parameter.  Maybe put in map.
-   afi("accor",   GM_ACCORDION,             "accordion");
-   afi("alto",    GM_RECORDER,              "alto");
-   afi("anvil",   GM_TINKLE_BELL,           "anvil");
-   afi("archl",   GM_ACOUSTIC_GUITAR_NYLON, "archlute");
-   afi("armon",   GM_HARMONICA,             "harmonica");
-   afi("arpa",    GM_ORCHESTRAL_HARP,       "harp");
-   afi("bagpI",   GM_BAGPIPE,               "bagpipe (Irish)");
-   afi("bagpS",   GM_BAGPIPE,               "bagpipe (Scottish)");
-   afi("banjo",   GM_BANJO,                 "banjo");
-   afi("bansu",   GM_FLUTE,                 "bansuri");
-   afi("barit",   GM_CHOIR_AAHS,            "baritone");
-   afi("baset",   GM_CLARINET,              "bassett horn");
-   afi("bass",    GM_CHOIR_AAHS,            "bass");
-   afi("bdrum",   GM_TAIKO_DRUM,            "bass drum");
-   afi("bguit",   GM_ELECTRIC_BASS_FINGER,  "electric bass guitar");
-   afi("biwa",    GM_FLUTE,                 "biwa");
-   afi("bongo",   GM_TAIKO_DRUM,            "bongo");
-   afi("brush",   GM_BREATH_NOISE,          "brush");
-   afi("bscan",   GM_CHOIR_AAHS,            "basso cantante");
-   afi("bspro",   GM_CHOIR_AAHS,            "basso profondo");
-   afi("bugle",   GM_TRUMPET,               "bugle");
-   afi("calam",   GM_OBOE,                  "chalumeau");
-   afi("calpe",   GM_LEAD_CALLIOPE,         "calliope");
-   afi("calto",   GM_CHOIR_AAHS,            "contralto");
-   afi("campn",   GM_TUBULAR_BELLS,         "bell");
-   afi("cangl",   GM_ENGLISH_HORN,          "english horn");
-   afi("canto",   GM_CHOIR_AAHS,            "canto");
-   afi("caril",   GM_TUBULAR_BELLS,         "carillon");
-   afi("castr",   GM_CHOIR_AAHS,            "castrato");
-   afi("casts",   GM_WOODBLOCKS,            "castanets");
-   afi("cbass",   GM_CONTRABASS,            "contrabass");
-   afi("cello",   GM_CELLO,                 "violoncello");
-   afi("cemba",   GM_HARPSICHORD,           "harpsichord");
-   afi("cetra",   GM_VIOLIN,                "cittern");
-   afi("chain",   GM_TINKLE_BELL,           "chains");
-   afi("chcym",   GM_REVERSE_CYMBAL,        "China cymbal");
-   afi("chime",   GM_TUBULAR_BELLS,         "chimes");
-   afi("chlma",   GM_BASSOON,               "alto shawm");
-   afi("chlms",   GM_BASSOON,               "soprano shawm");
-   afi("chlmt",   GM_BASSOON,               "tenor shawm");
-   afi("clap",    GM_GUNSHOT,               "hand clapping");
-   afi("clara",   GM_CLARINET,              "alto clarinet");
-   afi("clarb",   GM_CLARINET,              "bass clarinet");
-   afi("clarp",   GM_CLARINET,              "piccolo clarinet");
-   afi("clars",   GM_CLARINET,              "clarinet");
-   afi("clave",   GM_AGOGO,                 "claves");
-   afi("clavi",   GM_CLAVI,                 "clavichord");
-   afi("clest",   GM_CELESTA,               "celesta");
-   afi("clrno",   GM_TRUMPET,               "clarino");
-   afi("colsp",   GM_FLUTE,                 "coloratura soprano");
-   afi("conga",   GM_TAIKO_DRUM,            "conga");
-   afi("cor",     GM_FRENCH_HORN,           "horn");
-   afi("cornm",   GM_BAGPIPE,               "French bagpipe");
-   afi("corno",   GM_TRUMPET,               "cornett");
-   afi("cornt",   GM_TRUMPET,               "cornet");
-   afi("coro",    GM_CHOIR_AAHS,            "chorus");
-   afi("crshc",   GM_REVERSE_CYMBAL,        "crash cymbal");
-   afi("ctenor",  GM_CHOIR_AAHS,            "counter-tenor");
-   afi("ctina",   GM_ACCORDION,             "concertina");
-   afi("drmsp",   GM_FLUTE,                 "dramatic soprano");
-   afi("drum",    GM_SYNTH_DRUM,            "drum");
-   afi("drumP",   GM_SYNTH_DRUM,            "small drum");
-   afi("dulc",    GM_DULCIMER,              "dulcimer");
-   afi("eguit",   GM_ELECTRIC_GUITAR_CLEAN, "electric guitar");
-   afi("fag_c",   GM_BASSOON,               "contrabassoon");
-   afi("fagot",   GM_BASSOON,               "bassoon");
-   afi("false",   GM_RECORDER,              "falsetto");
-   afi("fdrum",   GM_TAIKO_DRUM,            "frame drum");
-   afi("feme",    GM_CHOIR_AAHS,            "female voice");
-   afi("fife",    GM_BLOWN_BOTTLE,          "fife");
-   afi("fingc",   GM_REVERSE_CYMBAL,        "finger cymbal");
-   afi("flt",     GM_FLUTE,                 "flute");
-   afi("flt_a",   GM_FLUTE,                 "alto flute");
-   afi("flt_b",   GM_FLUTE,                 "bass flute");
-   afi("fltda",   GM_RECORDER,              "alto recorder");
-   afi("fltdb",   GM_RECORDER,              "bass recorder");
-   afi("fltdn",   GM_RECORDER,              "sopranino recorder");
-   afi("fltds",   GM_RECORDER,              "soprano recorder");
-   afi("fltdt",   GM_RECORDER,              "tenor recorder");
-   afi("flugh",   GM_FRENCH_HORN,           "flugelhorn");
-   afi("forte",   GM_HONKYTONK_PIANO,       "fortepiano");
-   afi("gen",     GM_ACOUSTIC_GRAND_PIANO,  "generic instrument");
-   afi("genB",    GM_ACOUSTIC_GRAND_PIANO,  "generic bass instrument");
-   afi("genT",    GM_ACOUSTIC_GRAND_PIANO,  "generic treble instrument");
-   afi("glock",   GM_GLOCKENSPIEL,          "glockenspiel");
-   afi("gong",    GM_REVERSE_CYMBAL,        "gong");
-   afi("guitr",   GM_ACOUSTIC_GUITAR_NYLON, "guitar");
-   afi("hammd",   GM_DRAWBAR_ORGAN,         "Hammond electronic organ");
-   afi("hbell",   GM_TINKLE_BELL,           "handbell");
-   afi("hbell",   GM_TINKLE_BELL,           "handbell");
-   afi("heck",    GM_BASSOON,               "heckelphone");
-   afi("heltn",   GM_CHOIR_AAHS,            "Heldentenor");
-   afi("hichi",   GM_OBOE,                  "hichiriki");
-   afi("hurdy",   GM_LEAD_CALLIOPE,         "hurdy-gurdy");
-   afi("kitv",    GM_VIOLIN,                "kit violin");
-   afi("klav",    GM_ACOUSTIC_GRAND_PIANO,  "keyboard");
-   afi("kokyu",   GM_FIDDLE,                "kokyu");
-   afi("komun",   GM_KOTO,                  "komun'go");
-   afi("koto",    GM_KOTO,                  "koto");
-   afi("kruma",   GM_TRUMPET,               "alto crumhorn");
-   afi("krumb",   GM_TRUMPET,               "bass crumhorn");
-   afi("krums",   GM_TRUMPET,               "soprano crumhorn");
-   afi("krumt",   GM_TRUMPET,               "tenor crumhorn");
-   afi("lion",    GM_AGOGO,                 "lion's roar");
-   afi("liuto",   GM_ACOUSTIC_GUITAR_NYLON, "lute");
-   afi("lyrsp",   GM_FLUTE,                 "lyric soprano");
-   afi("lyrtn",   GM_FRENCH_HORN,           "lyric tenor");
-   afi("male",    GM_CHOIR_AAHS,            "male voice");
-   afi("mando",   GM_ACOUSTIC_GUITAR_NYLON, "mandolin");
-   afi("marac",   GM_AGOGO,                 "maracas");
-   afi("marim",   GM_MARIMBA,               "marimba");
-   afi("mbari",   GM_CHOIR_AAHS,            "high baritone");
-   afi("mezzo",   GM_CHOIR_AAHS,            "mezzo soprano");
-   afi("nfant",   GM_CHOIR_AAHS,            "child's voice");
-   afi("nokan",   GM_SHAKUHACHI,            "nokan");
-   afi("oboe",    GM_OBOE,                  "oboe");
-   afi("oboeD",   GM_ENGLISH_HORN,          "oboe d'amore");
-   afi("ocari",   GM_OCARINA,               "ocarina");
-   afi("ondes",   GM_PAD_SWEEP,             "ondes Martenot");
-   afi("ophic",   GM_TUBA,                  "ophicleide");
-   afi("organ",   GM_CHURCH_ORGAN,          "pipe organ");
-   afi("oud",     GM_ACOUSTIC_GUITAR_NYLON, "oud");
-   afi("paila",   GM_AGOGO,                 "timbales");
-   afi("panpi",   GM_PAN_FLUTE,             "panpipe");
-   afi("pbell",   GM_TUBULAR_BELLS,         "bell plate");
-   afi("pguit",   GM_ACOUSTIC_GUITAR_NYLON, "Portuguese guitar");
-   afi("physh",   GM_REED_ORGAN,            "physharmonica");
-   afi("piano",   GM_ACOUSTIC_GRAND_PIANO,  "pianoforte");
-   afi("piatt",   GM_REVERSE_CYMBAL,        "cymbals");
-   afi("picco",   GM_PICCOLO,               "piccolo");
-   afi("pipa",    GM_ACOUSTIC_GUITAR_NYLON, "Chinese lute");
-   afi("porta",   GM_TANGO_ACCORDION,       "portative organ");
-   afi("psalt",   GM_CLAVI,                 "psaltery");
-   afi("qin",     GM_CLAVI,                 "qin");
-   afi("quinto",  GM_CHOIR_AAHS,            "quinto");
-   afi("quitr",   GM_ACOUSTIC_GUITAR_NYLON, "gittern");
-   afi("rackt",   GM_TRUMPET,               "racket");
-   afi("ratl",    GM_WOODBLOCKS,            "rattle");
-   afi("rebec",   GM_ACOUSTIC_GUITAR_NYLON, "rebec");
-   afi("recit",   GM_CHOIR_AAHS,            "recitativo");
-   afi("reedo",   GM_REED_ORGAN,            "reed organ");
-   afi("rhode",   GM_ELECTRIC_PIANO_1,      "Fender-Rhodes electric piano");
-   afi("ridec",   GM_REVERSE_CYMBAL,        "ride cymbal");
-   afi("sarod",   GM_SITAR,                 "sarod");
-   afi("sarus",   GM_TUBA,                  "sarrusophone");
-   afi("saxA",    GM_ALTO_SAX,              "alto saxophone");
-   afi("saxB",    GM_BARITONE_SAX,          "bass saxophone");
-   afi("saxC",    GM_BARITONE_SAX,          "contrabass saxophone");
-   afi("saxN",    GM_SOPRANO_SAX,           "sopranino saxophone");
-   afi("saxR",    GM_BARITONE_SAX,          "baritone saxophone");
-   afi("saxS",    GM_SOPRANO_SAX,           "soprano saxophone");
-   afi("saxT",    GM_TENOR_SAX,             "tenor saxophone");
-   afi("sbell",   GM_TINKLE_BELL,           "sleigh bells");
-   afi("sdrum",   GM_SYNTH_DRUM,            "snare drum (kit)");
-   afi("shaku",   GM_SHAKUHACHI,            "shakuhachi");
-   afi("shami",   GM_SHAMISEN,              "shamisen");
-   afi("sheng",   GM_SHANAI,                "sheng");
-   afi("sho",     GM_SHANAI,                "sho");
-   afi("siren",   GM_FX_SCI_FI,             "siren");
-   afi("sitar",   GM_SITAR,                 "sitar");
-   afi("slap",    GM_GUNSHOT,               "slapstick");
-   afi("soprn",   GM_CHOIR_AAHS,            "soprano");
-   afi("spshc",   GM_REVERSE_CYMBAL,        "splash cymbal");
-   afi("steel",   GM_STEEL_DRUMS,           "steel-drum");
-   afi("stim",    GM_SEASHORE,              "Sprechstimme");
-   afi("stimA",   GM_SEASHORE,              "Sprechstimme, alto");
-   afi("stimB",   GM_SEASHORE,              "Sprechstimme, bass");
-   afi("stimC",   GM_SEASHORE,              "Sprechstimme, contralto");
-   afi("stimR",   GM_SEASHORE,              "Sprechstimme, baritone");
-   afi("stimS",   GM_SEASHORE,              "Sprechstimme, soprano");
-   afi("strdr",   GM_AGOGO,                 "string drum");
-   afi("sxhA",    GM_ALTO_SAX,              "alto saxhorn");
-   afi("sxhB",    GM_BARITONE_SAX,          "bass saxhorn");
-   afi("sxhC",    GM_BARITONE_SAX,          "contrabass saxhorn");
-   afi("sxhR",    GM_BARITONE_SAX,          "baritone saxhorn");
-   afi("sxhS",    GM_SOPRANO_SAX,           "soprano saxhorn");
-   afi("sxhT",    GM_TENOR_SAX,             "tenor saxhorn");
-   afi("synth",   GM_ELECTRIC_PIANO_2,      "keyboard synthesizer");
-   afi("tabla",   GM_MELODIC_DRUM,          "tabla");
-   afi("tambn",   GM_TINKLE_BELL,           "tambourine");
-   afi("tambu",   GM_MELODIC_DRUM,          "tambura");
-   afi("tanbr",   GM_MELODIC_DRUM,          "tanbur");
-   afi("tblok",   GM_WOODBLOCKS,            "temple blocks");
-   afi("tdrum",   GM_SYNTH_DRUM,            "tenor drum");
-   afi("tenor",   GM_CHOIR_AAHS,            "tenor");
-   afi("timpa",   GM_MELODIC_DRUM,          "timpani");
-   afi("tiorb",   GM_ACOUSTIC_GUITAR_NYLON, "theorbo");
-   afi("tom",     GM_TAIKO_DRUM,            "tom-tom drum");
-   afi("trngl",   GM_TINKLE_BELL,           "triangle");
-   afi("tromb",   GM_TROMBONE,              "bass trombone");
-   afi("tromp",   GM_TRUMPET,               "trumpet");
-   afi("tromt",   GM_TROMBONE,              "tenor trombone");
-   afi("tuba",    GM_TUBA,                  "tuba");
-   afi("tubaB",   GM_TUBA,                  "bass tuba");
-   afi("tubaC",   GM_TUBA,                  "contrabass tuba");
-   afi("tubaT",   GM_TUBA,                  "tenor tuba");
-   afi("tubaU",   GM_TUBA,                  "subcontra tuba");
-   afi("ukule",   GM_ACOUSTIC_GUITAR_NYLON, "ukulele");
-   afi("vibra",   GM_VIBRAPHONE,            "vibraphone");
-   afi("vina",    GM_SITAR,                 "vina");
-   afi("viola",   GM_VIOLA,                 "viola");
-   afi("violb",   GM_CONTRABASS,            "bass viola da gamba");
-   afi("viold",   GM_VIOLA,                 "viola d'amore");
-   afi("violn",   GM_VIOLIN,                "violin");
-   afi("violp",   GM_VIOLIN,                "piccolo violin");
-   afi("viols",   GM_VIOLIN,                "treble viola da gamba");
-   afi("violt",   GM_CELLO,                 "tenor viola da gamba");
-   afi("vox",     GM_CHOIR_AAHS,            "generic voice");
-   afi("wblok",   GM_WOODBLOCKS,            "woodblock");
-   afi("xylo",    GM_XYLOPHONE,             "xylophone");
-   afi("zithr",   GM_CLAVI,                 "zither");
-   afi("zurna",   GM_ACOUSTIC_GUITAR_NYLON, "zurna");
-
-}
-
-
-
-//////////////////////////////
-//
-// HumInstrument::afi --
-//
-
-void HumInstrument::afi(const char* humdrum_name, int midinum,
-		const char* EN_name) {
-	_HumInstrument x;
-	x.name = EN_name;
-	x.humdrum = humdrum_name;
-	x.gm = midinum;
-
-	m_data.push_back(x);
-}
-
-
-
-//////////////////////////////
-//
-// HumInstrument::find --
+// HumInstrument::find -- Return the index of an instrument code in the
+//     table, or -1 if it is not in the table.
 //
 
 int HumInstrument::find(const string& Hname) {
-	void* searchResult;
-	_HumInstrument key;
-	key.humdrum = Hname;
-	key.name = "";
-	key.gm = 0;
+	const _HumInstrumentEntry* end = HumInstrumentTable + HumInstrumentCount;
+	const _HumInstrumentEntry* entry = std::lower_bound(HumInstrumentTable, end,
+			Hname.c_str(), [](const _HumInstrumentEntry& a, const char* b) {
+				return strcmp(a.humdrum, b) < 0;
+			});
+	if ((entry == end) || (strcmp(entry->humdrum, Hname.c_str()) != 0)) {
+		return -1;
+	}
+	return (int)(entry - HumInstrumentTable);
+}
 
-	searchResult = bsearch(&key, m_data.data(),
-			m_data.size(), sizeof(_HumInstrument),
-			&data_compare_by_humdrum_name);
 
-	if (searchResult == NULL) {
-		return -1;
+
+//////////////////////////////
+//
+// HumInstrument::stripPrefix -- Remove "*I" from the start of an
+//     instrument code.
+//
+
+string HumInstrument::stripPrefix(const string& Hname) {
+	if (Hname.compare(0, 2, "*I") == 0) {
+		return Hname.substr(2);
+	}
+	return Hname;
+}
+
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::HumJsonWriter -- Constructor.
+//
+
+HumJsonWriter::HumJsonWriter(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::setFormat -- Set the output format (JSON or CBOR).
+//
+
+void HumJsonWriter::setFormat(HumJsonWriter::Format format) {
+	m_format = format;
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::getFormat --
+//
+
+HumJsonWriter::Format HumJsonWriter::getFormat(void) const {
+	return m_format;
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::setSections -- Set the sections to write, either as a
+//     bitmask of HumJsonWriter::Section values, or as a list of section
+//     names separated by commas or spaces (see getSectionNames(), plus
+//     "all" and "none").  Returns false if a name is not known, in which
+//     case the sections are not changed.
+//
+
+void HumJsonWriter::setSections(int sections) {
+	m_sections = sections & SECTION_ALL;
+}
+
+
+bool HumJsonWriter::setSections(const string& names) {
+	static const struct { const char* name; int section; } table[] = {
+		{ "links",       SECTION_LINKS       },
+		{ "rhythm",      SECTION_RHYTHM      },
+		{ "nulls",       SECTION_NULLS       },
+		{ "ties",        SECTION_TIES        },
+		{ "slurs",       SECTION_SLURS       },
+		{ "phrases",     SECTION_PHRASES     },
+		{ "beams",       SECTION_BEAMS       },
+		{ "accidentals", SECTION_ACCIDENTALS },
+		{ "rests",       SECTION_RESTS       },
+		{ "parameters",  SECTION_PARAMETERS  },
+		{ "auto",        SECTION_AUTO        },
+		{ "all",         SECTION_ALL         },
+		{ "none",        0                   }
+	};
+
+	int sections = 0;
+	size_t start = 0;
+	while (start < names.size()) {
+		size_t end = names.find_first_of(", ", start);
+		if (end == string::npos) {
+			end = names.size();
+		}
+		if (end > start) {
+			string name = names.substr(start, end - start);
+			bool found = false;
+			for (auto& entry : table) {
+				if (name == entry.name) {
+					sections |= entry.section;
+					found = true;
+					break;
+				}
+			}
+			if (!found) {
+				return false;
+			}
+		}
+		start = end + 1;
+	}
+	m_sections = sections;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::getSections -- Return the bitmask of sections to write.
+//
+
+int HumJsonWriter::getSections(void) const {
+	return m_sections;
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::getSectionNames -- Return the names of the sections that
+//     can be given to setSections().
+//
+
+string HumJsonWriter::getSectionNames(void) {
+	return "links, rhythm, nulls, ties, slurs, phrases, beams, accidentals, rests, parameters, auto";
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::write -- Write a file to an output stream.  Returns false
+//     if the stream could not accept all of the output.
+//
+
+bool HumJsonWriter::write(ostream& out, HumdrumFile& infile) {
+	m_out      = out.rdbuf();
+	m_failed   = (m_out == NULL);
+	m_afterKey = false;
+	m_newline  = false;
+	m_first.clear();
+	if (m_failed) {
+		return false;
+	}
+
+	if (m_sections & SECTION_TIES) {
+		infile.requireAnalysis(HumFileAnalysis::PASS_TIES);
+	}
+	if (m_sections & SECTION_SLURS) {
+		infile.requireAnalysis(HumFileAnalysis::PASS_SLURS);
+	}
+	if (m_sections & SECTION_PHRASES) {
+		infile.requireAnalysis(HumFileAnalysis::PASS_PHRASES);
+	}
+	if (m_sections & SECTION_BEAMS) {
+		infile.requireAnalysis(HumFileAnalysis::PASS_BEAMS);
+	}
+	if (m_sections & SECTION_ACCIDENTALS) {
+		infile.requireAnalysis(HumFileAnalysis::PASS_KERN_ACCIDENTALS);
+	}
+	if (m_sections & SECTION_RESTS) {
+		infile.requireAnalysis(HumFileAnalysis::PASS_REST_POSITIONS);
+	}
+	m_tables = &infile.getAnalysisTables();
+
+	beginObject();
+	writeHeader(infile);
+	writeKey("lines");
+	beginArray();
+	for (int i=0; i<infile.getLineCount(); i++) {
+		writeNewline();
+		writeLine(infile[i]);
+	}
+	endArray();
+	endObject();
+	if (m_format == FORMAT_JSON) {
+		put('\n');
+	}
+
+	if (m_out->pubsync() == -1) {
+		m_failed = true;
+	}
+	m_out = NULL;
+	m_tables = NULL;
+	return !m_failed;
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeHeader -- Write the information about the file and
+//     its tracks.
+//
+
+void HumJsonWriter::writeHeader(HumdrumFile& infile) {
+	writeKey("format");
+	writeString("humdrum");
+	writeKey("version");
+	writeInteger(1);
+	writeKey("lineCount");
+	writeInteger(infile.getLineCount());
+	writeKey("trackCount");
+	writeInteger(infile.getMaxTrack());
+	if (m_sections & SECTION_RHYTHM) {
+		writeKey("tpq");
+		writeInteger(infile.tpq());
+		writeKey("duration");
+		writeRational(infile.getScoreDuration());
+	}
+
+	writeKey("tracks");
+	beginArray();
+	for (int i=1; i<=infile.getMaxTrack(); i++) {
+		writeNewline();
+		beginObject();
+		writeKey("track");
+		writeInteger(i);
+		HTp start = infile.getTrackStart(i);
+		if (start) {
+			writeKey("dataType");
+			writeString(start->getDataType());
+			writeKey("start");
+			writeReference(start);
+		}
+		endObject();
+	}
+	endArray();
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeLine -- Write a line and its tokens.
+//
+
+void HumJsonWriter::writeLine(HumdrumLine& line) {
+	beginObject();
+	writeKey("line");
+	writeInteger(line.getLineIndex());
+	writeKey("type");
+	writeString(getLineType(line));
+	if (m_sections & SECTION_RHYTHM) {
+		writeKey("durationFromStart");
+		writeRational(line.getDurationFromStart());
+		writeKey("durationFromBarline");
+		writeRational(line.getDurationFromBarline());
+		writeKey("duration");
+		writeRational(line.getDuration());
+	}
+	writeKey("tokens");
+	beginArray();
+	for (int j=0; j<line.getFieldCount(); j++) {
+		writeToken(line.token(j));
+	}
+	endArray();
+	endObject();
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeToken -- Write a token and the selected analyses
+//     of it.
+//
+
+void HumJsonWriter::writeToken(HTp token) {
+	beginObject();
+	writeKey("id");
+	writeString(token->getXmlId());
+	writeKey("text");
+	writeString(*token);
+	writeKey("type");
+	writeString(getTokenType(token));
+	writeKey("track");
+	writeInteger(token->getTrack());
+	writeKey("subtrack");
+	writeInteger(token->getSubtrack());
+	writeKey("spine");
+	writeString(token->getSpineInfo());
+
+	if (m_sections & SECTION_RHYTHM) {
+		HumNum duration = token->getDuration();
+		if (duration.isNonNegative()) {
+			writeKey("duration");
+			writeRational(duration);
+		}
+	}
+
+	if (m_sections & SECTION_LINKS) {
+		writeTokenLinks(token);
+	}
+
+	if ((m_sections & SECTION_NULLS) && token->isNull() && token->isData()) {
+		HTp resolve = token->resolveNull();
+		if (resolve && (resolve != token)) {
+			writeKey("resolve");
+			writeReference(resolve);
+		}
+	}
+
+	if ((m_sections & SECTION_PARAMETERS) && (token->getLinkedParameterSetCount() > 0)) {
+		writeKey("linked");
+		beginArray();
+		for (int i=0; i<token->getLinkedParameterSetCount(); i++) {
+			HumParamSet* pset = token->getLinkedParameterSet(i);
+			writeReference(pset ? pset->getToken() : NULL);
+		}
+		endArray();
+	}
+
+	writeAnalyses(token);
+	writeParameters(token);
+	endObject();
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeTokenLinks -- Write the next and previous tokens
+//     in the spine.
+//
+
+void HumJsonWriter::writeTokenLinks(HTp token) {
+	writeKey("next");
+	beginArray();
+	for (int i=0; i<token->getNextTokenCount(); i++) {
+		writeReference(token->getNextToken(i));
+	}
+	endArray();
+
+	writeKey("prev");
+	beginArray();
+	for (int i=0; i<token->getPreviousTokenCount(); i++) {
+		writeReference(token->getPreviousToken(i));
+	}
+	endArray();
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeAnalyses -- Write the analyses of a token that are
+//     stored in the analysis tables of the file.
+//
+
+void HumJsonWriter::writeAnalyses(HTp token) {
+	int id = m_tables->getTokenId(token);
+	if ((id < 0) || !token->isData()) {
+		return;
+	}
+
+	if (m_sections & SECTION_TIES) {
+		writeSpans("ties", "tieHanging", m_tables->getTies(), id, token);
+	}
+	if (m_sections & SECTION_SLURS) {
+		writeSpans("slurs", "slurHanging", m_tables->getSlurs(), id, token);
+	}
+	if (m_sections & SECTION_PHRASES) {
+		writeSpans("phrases", "phraseHanging", m_tables->getPhrases(), id, token);
+	}
+	if (m_sections & SECTION_BEAMS) {
+		writeSpans("beams", "beamHanging", m_tables->getBeams(), id, token);
+	}
+
+	if ((m_sections & SECTION_ACCIDENTALS) && token->isKern() && !token->isNull()) {
+		int count = token->getSubtokenCount();
+		int last = -1;
+		for (int i=0; i<count; i++) {
+			if (m_tables->getAccidentalFlags(id, i) > 0) {
+				last = i;
+			}
+		}
+		if (last >= 0) {
+			writeKey("accidentals");
+			beginArray();
+			for (int i=0; i<=last; i++) {
+				writeInteger(m_tables->getAccidentalFlags(id, i));
+			}
+			endArray();
+		}
+	}
+
+	int diatonic;
+	int octave;
+	if ((m_sections & SECTION_RESTS) && m_tables->getRestPosition(id, diatonic, octave)) {
+		writeKey("restPosition");
+		beginArray();
+		writeInteger(diatonic);
+		writeInteger(octave);
+		endArray();
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeSpans -- Write the ties, slurs, phrases or beams
+//     starting on a token, and whether the token has an unmatched start
+//     or end.
+//
+
+void HumJsonWriter::writeSpans(const char* key, const char* hangingkey,
+		HumSpanTable& spans, int id, HTp token) {
+	int count = spans.getStartCount(id);
+	if (count > 0) {
+		writeKey(key);
+		beginArray();
+		// Start numbers are at most the number of opening characters (or
+		// of notes for ties) on the token.
+		int found = 0;
+		for (int number=1; (found < count) && (number <= (int)token->size()); number++) {
+			HTp end = spans.getEndToken(id, number);
+			if (!end) {
+				continue;
+			}
+			found++;
+			beginObject();
+			writeKey("number");
+			writeInteger(number);
+			writeKey("end");
+			writeReference(end);
+			writeKey("duration");
+			writeRational(spans.getDuration(id, number));
+			endObject();
+		}
+		endArray();
+	}
+	int side = spans.getHangingSide(id);
+	if (side) {
+		writeKey(hangingkey);
+		writeInteger(side);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeParameters -- Write the parameters of a token that
+//     belong to the selected sections.  Values that are tokens (stored as
+//     "HT_" followed by the address of the token) are written as
+//     references to the token.
+//
+
+void HumJsonWriter::writeParameters(HTp token) {
+	MapNNKV* parameters = ((HumHash*)token)->parameters;
+	if ((parameters == NULL) || parameters->empty()) {
+		return;
+	}
+	bool found = false;
+	for (auto& it1 : *parameters) {
+		for (auto& it2 : it1.second) {
+			for (auto& it3 : it2.second) {
+				int section = getParameterSection(it1.first, it2.first, it3.first);
+				if (!(m_sections & section)) {
+					continue;
+				}
+				if (!found) {
+					writeKey("parameters");
+					beginArray();
+					found = true;
+				}
+				beginArray();
+				writeString(it1.first);
+				writeString(it2.first);
+				writeString(it3.first);
+				const HumParameter& value = it3.second;
+				if (value.compare(0, 3, "HT_") == 0) {
+					writeReference((HTp)strtoll(value.c_str() + 3, NULL, 10));
+				} else {
+					writeString(value);
+				}
+				if (value.origin) {
+					writeReference(value.origin);
+				}
+				endArray();
+			}
+		}
+	}
+	if (found) {
+		endArray();
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::getParameterSection -- Return the section that a
+//     parameter belongs to, or 0 if the parameter is not written because
+//     it is a copy of a result in the analysis tables (or the "id" of the
+//     token itself).  Analysis results are stored in the "auto" namespace,
+//     and all other parameters come from layout comments.
+//
+
+int HumJsonWriter::getParameterSection(const string& ns1, const string& ns2,
+		const string& key) const {
+	if (ns1.empty() && (ns2 == "auto")) {
+		if ((key.find("tie") != string::npos) || (key.find("Tie") != string::npos) ||
+				(key.find("phrase") != string::npos) || (key.find("Phrase") != string::npos) ||
+				(key.find("slur") != string::npos) || (key.find("Slur") != string::npos) ||
+				(key.find("beam") != string::npos) || (key.find("Beam") != string::npos) ||
+				(key == "id") || (key == "ploc") || (key == "oloc")) {
+			return 0;
+		}
+		return SECTION_AUTO;
+	}
+	if (ns1 == "auto") {
+		// Subtoken parameters, such as "auto", "1", "visualAccidental".
+		// The visual, cautionary and obligatory states are in the analysis
+		// tables.
+		if (key.find("ccidental") != string::npos) {
+			if ((key == "visualAccidental") || (key == "cautionaryAccidental") ||
+					(key == "obligatoryAccidental")) {
+				return 0;
+			}
+			return SECTION_ACCIDENTALS;
+		}
+		return SECTION_AUTO;
+	}
+	return SECTION_PARAMETERS;
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::getLineType --
+//
+
+const char* HumJsonWriter::getLineType(HumdrumLine& line) {
+	if (line.isEmpty()) {
+		return "empty";
+	} else if (line.isReference()) {
+		return "reference";
+	} else if (line.isCommentUniversal()) {
+		return "universal-comment";
+	} else if (line.isCommentGlobal()) {
+		return "global-comment";
+	} else if (line.isExclusive()) {
+		return "exclusive";
+	} else if (line.isTerminator()) {
+		return "terminator";
+	} else if (line.isManipulator()) {
+		return "manipulator";
+	} else if (line.isInterp()) {
+		return "interpretation";
+	} else if (line.isCommentLocal()) {
+		return "local-comment";
+	} else if (line.isBarline()) {
+		return "barline";
+	} else if (line.isData()) {
+		return "data";
+	}
+	return "unknown";
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::getTokenType -- Same categories as the <tokenType> of
+//     HumdrumToken::printXml(), with the tokens of global lines (which
+//     have no track) marked separately.
+//
+
+const char* HumJsonWriter::getTokenType(HTp token) {
+	HLp line = token->getOwner();
+	if (line && !line->hasSpines()) {
+		return "global";
+	} else if (token->isNull()) {
+		return "null";
+	} else if (token->isManipulator()) {
+		return "manipulator";
+	} else if (token->isCommentLocal()) {
+		return "local-comment";
+	} else if (token->isBarline()) {
+		return "barline";
+	} else if (token->isData()) {
+		return "data";
+	}
+	return "interpretation";
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::beginObject -- Start a JSON object or CBOR map.
+//
+
+void HumJsonWriter::beginObject(void) {
+	if (m_format == FORMAT_CBOR) {
+		put((char)0xbf);
+		return;
+	}
+	writeSeparator();
+	put('{');
+	m_first.push_back(1);
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::endObject --
+//
+
+void HumJsonWriter::endObject(void) {
+	if (m_format == FORMAT_CBOR) {
+		put((char)0xff);
+		return;
+	}
+	m_first.pop_back();
+	put('}');
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::beginArray -- Start a JSON or CBOR array.
+//
+
+void HumJsonWriter::beginArray(void) {
+	if (m_format == FORMAT_CBOR) {
+		put((char)0x9f);
+		return;
+	}
+	writeSeparator();
+	put('[');
+	m_first.push_back(1);
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::endArray --
+//
+
+void HumJsonWriter::endArray(void) {
+	if (m_format == FORMAT_CBOR) {
+		put((char)0xff);
+		return;
+	}
+	m_first.pop_back();
+	put(']');
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeKey -- Write the key of the next value in an object.
+//
+
+void HumJsonWriter::writeKey(const char* key) {
+	writeString(key);
+	if (m_format == FORMAT_JSON) {
+		put(':');
+		m_afterKey = true;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeString -- Write a string, escaping quotes,
+//     backslashes and control characters for JSON.
+//
+
+void HumJsonWriter::writeString(const char* text, size_t size) {
+	if (m_format == FORMAT_CBOR) {
+		writeCborHead(3, size);
+		put(text, size);
+		return;
+	}
+	writeSeparator();
+	put('"');
+	size_t start = 0;
+	for (size_t i=0; i<size; i++) {
+		unsigned char ch = (unsigned char)text[i];
+		if ((ch >= 0x20) && (ch != '"') && (ch != '\\')) {
+			continue;
+		}
+		put(text + start, i - start);
+		start = i + 1;
+		switch (ch) {
+			case '"':  put("\\\"", 2); break;
+			case '\\': put("\\\\", 2); break;
+			case '\n': put("\\n", 2);  break;
+			case '\r': put("\\r", 2);  break;
+			case '\t': put("\\t", 2);  break;
+			default: {
+				char buffer[8];
+				snprintf(buffer, sizeof(buffer), "\\u%04x", ch);
+				put(buffer, 6);
+			}
+		}
+	}
+	put(text + start, size - start);
+	put('"');
+}
+
+
+void HumJsonWriter::writeString(const string& text) {
+	writeString(text.data(), text.size());
+}
+
+
+void HumJsonWriter::writeString(const char* text) {
+	writeString(text, strlen(text));
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeInteger --
+//
+
+void HumJsonWriter::writeInteger(long long value) {
+	if (m_format == FORMAT_CBOR) {
+		if (value >= 0) {
+			writeCborHead(0, (unsigned long long)value);
+		} else {
+			writeCborHead(1, (unsigned long long)(-1 - value));
+		}
+		return;
+	}
+	writeSeparator();
+	char buffer[32];
+	int size = snprintf(buffer, sizeof(buffer), "%lld", value);
+	put(buffer, size);
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeRational -- Write a duration as a
+//     [numerator, denominator] array.
+//
+
+void HumJsonWriter::writeRational(HumNum value) {
+	beginArray();
+	writeInteger(value.getNumerator());
+	writeInteger(value.getDenominator());
+	endArray();
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeReference -- Write a reference to a token as a
+//     [line, field] array, or null if there is no token.
+//
+
+void HumJsonWriter::writeReference(HTp token) {
+	if (token == NULL) {
+		writeNull();
+		return;
+	}
+	beginArray();
+	writeInteger(token->getLineIndex());
+	writeInteger(token->getFieldIndex());
+	endArray();
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeNull --
+//
+
+void HumJsonWriter::writeNull(void) {
+	if (m_format == FORMAT_CBOR) {
+		put((char)0xf6);
+		return;
+	}
+	writeSeparator();
+	put("null", 4);
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeNewline -- Start the next JSON value on a new line
+//     (to keep lines of the output to a readable length).
+//
+
+void HumJsonWriter::writeNewline(void) {
+	if (m_format == FORMAT_JSON) {
+		m_newline = true;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeSeparator -- Write the comma before a JSON value
+//     if it is not the first value in its array or object.
+//
+
+void HumJsonWriter::writeSeparator(void) {
+	if (m_afterKey) {
+		m_afterKey = false;
+		return;
+	}
+	if (!m_first.empty()) {
+		if (m_first.back()) {
+			m_first.back() = 0;
+		} else {
+			put(',');
+		}
+	}
+	if (m_newline) {
+		put('\n');
+		m_newline = false;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeCborHead -- Write the initial bytes of a CBOR data
+//     item: the major type and the shortest encoding of the value.
+//
+
+void HumJsonWriter::writeCborHead(int major, unsigned long long value) {
+	char buffer[9];
+	int size;
+	major <<= 5;
+	if (value < 24) {
+		buffer[0] = (char)(major | value);
+		size = 1;
+	} else if (value <= 0xff) {
+		buffer[0] = (char)(major | 24);
+		size = 2;
+	} else if (value <= 0xffff) {
+		buffer[0] = (char)(major | 25);
+		size = 3;
+	} else if (value <= 0xffffffffULL) {
+		buffer[0] = (char)(major | 26);
+		size = 5;
 	} else {
-		return (int)(((TEMP64BITFIX)(searchResult)) - ((TEMP64BITFIX)(m_data.data())))/
-			sizeof(_HumInstrument);
+		buffer[0] = (char)(major | 27);
+		size = 9;
+	}
+	for (int i=size-1; i>0; i--) {
+		buffer[i] = (char)(value & 0xff);
+		value >>= 8;
 	}
+	put(buffer, size);
 }
 
 
+
 //////////////////////////////
 //
-// HumInstrument::data_compare_by_humdrum_name --
+// HumJsonWriter::put -- Write bytes to the output stream.
 //
 
-int HumInstrument::data_compare_by_humdrum_name(const void* a,
-		const void* b) {
-	_HumInstrument& valuea = *((_HumInstrument*)a);
-	_HumInstrument& valueb = *((_HumInstrument*)b);
-	return strcmp(valuea.humdrum.c_str(), valueb.humdrum.c_str());
+void HumJsonWriter::put(char ch) {
+	if (m_out->sputc(ch) == std::char_traits<char>::eof()) {
+		m_failed = true;
+	}
+}
+
+
+void HumJsonWriter::put(const char* data, size_t size) {
+	if (size == 0) {
+		return;
+	}
+	if (m_out->sputn(data, (std::streamsize)size) != (std::streamsize)size) {
+		m_failed = true;
+	}
+}
+
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::HumMetricTable -- Constructor.
+//
+
+HumMetricTable::HumMetricTable(void) {
+	clear();
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::clear -- Remove all positions and meters (except for
+//     meter 0, which is used for tracks without a time signature).
+//
+
+void HumMetricTable::clear(void) {
+	m_trackCount = 0;
+	m_meterTops.clear();
+	m_meterBottoms.clear();
+	m_compound.clear();
+	m_beatDurations.clear();
+	m_explicitBeats.clear();
+	m_rows.clear();
+	m_positions.clear();
+	m_meters.clear();
+	m_beats.clear();
+	m_fractions.clear();
+	m_levels.clear();
+	addMeter(0, 0, 0, 0);
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::resize -- Remove all positions and prepare the table
+//     for the given number of lines and tracks.
+//
+
+void HumMetricTable::resize(int lineCount, int trackCount) {
+	clear();
+	m_trackCount = trackCount;
+	m_rows.assign(lineCount, -1);
 }
 
 
 
 //////////////////////////////
 //
-// HumInstrument::sortData --
+// HumMetricTable::addMeter -- Return the index of a meter, adding it to
+//     the list of meters if it has not been used before.  The bottom of the
+//     time signature is bottom/bottom2 when bottom2 is not zero (such as
+//     *M3/2%3).  A beat of 0 means to use the default beat of the meter.
 //
 
-void HumInstrument::sortData(void) {
-	qsort(m_data.data(), m_data.size(), sizeof(_HumInstrument),
-		&HumInstrument::data_compare_by_humdrum_name);
+int HumMetricTable::addMeter(int top, int bottom, int bottom2, HumNum beat) {
+	HumNum bottomvalue = bottom;
+	if (bottom2 > 0) {
+		bottomvalue.setValue(bottom, bottom2);
+	}
+	// Compound meters such as 6/8, 9/8, 6/4, but not 3/8 or 3/4:
+	bool compound = (top % 3 == 0) && (top != 3) && (top != 0);
+	HumNum explicitbeat = beat > 0 ? beat : HumNum(0);
+	if (beat <= 0) {
+		beat = 1;
+		if (bottom > 0) {
+			beat.setValue(4, bottom);
+			if (compound) {
+				beat *= 3;
+			}
+		}
+	}
+	for (int i=(int)m_meterTops.size()-1; i>=0; i--) {
+		if ((m_meterTops[i] == top) && (m_meterBottoms[i] == bottomvalue) &&
+				(m_beatDurations[i] == beat) && (m_explicitBeats[i] == explicitbeat)) {
+			return i;
+		}
+	}
+	m_meterTops.push_back(top);
+	m_meterBottoms.push_back(bottomvalue);
+	m_compound.push_back(compound ? 1 : 0);
+	m_beatDurations.push_back(beat);
+	m_explicitBeats.push_back(explicitbeat);
+	return (int)m_meterTops.size() - 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::addLine -- Add a row of positions for a data line, which
+//     are then filled in with setPosition().
+//
+
+void HumMetricTable::addLine(int line, HumNum position) {
+	if ((line < 0) || (line >= (int)m_rows.size())) {
+		return;
+	}
+	m_rows[line] = (int)m_positions.size();
+	m_positions.push_back(position);
+	int size = (int)m_positions.size() * m_trackCount;
+	m_meters.resize(size, 0);
+	m_beats.resize(size, 0);
+	m_fractions.resize(size, 0);
+	m_levels.resize(size, NAN);
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::setPosition -- Store the metric position of a track on
+//     a data line added with addLine().
+//
+
+void HumMetricTable::setPosition(int line, int track, int meter, int beat,
+		HumNum fraction, double level) {
+	int index = getIndex(line, track);
+	if (index < 0) {
+		return;
+	}
+	m_meters[index]    = meter;
+	m_beats[index]     = beat;
+	m_fractions[index] = fraction;
+	m_levels[index]    = level;
 }
 
 
 
+//////////////////////////////
+//
+// HumMetricTable::getLineCount -- Return the number of lines in the file
+//     when the table was filled.
+//
+
+int HumMetricTable::getLineCount(void) const {
+	return (int)m_rows.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::getTrackCount -- Return the number of tracks in the
+//     file when the table was filled.
+//
+
+int HumMetricTable::getTrackCount(void) const {
+	return m_trackCount;
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::hasPosition -- Return true if the line is a data line
+//     and the track is in the table.
+//
+
+bool HumMetricTable::hasPosition(int line, int track) const {
+	return getIndex(line, track) >= 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::getMeasurePosition -- Return the duration in quarter
+//     notes from the previous barline to a data line (0 for other lines).
+//
+
+HumNum HumMetricTable::getMeasurePosition(int line) const {
+	if ((line < 0) || (line >= (int)m_rows.size()) || (m_rows[line] < 0)) {
+		return 0;
+	}
+	return m_positions[m_rows[line]];
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::hasMeter -- Return true if there is a time signature
+//     for the track before the line.
+//
+
+bool HumMetricTable::hasMeter(int line, int track) const {
+	return getMeterIndex(line, track) > 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::getMeterTop -- Return the top number of the time
+//     signature (0 if none).
+//
+
+int HumMetricTable::getMeterTop(int line, int track) const {
+	return m_meterTops[getMeterIndex(line, track)];
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::getMeterBottom -- Return the bottom number of the time
+//     signature (0 if none).
+//
+
+HumNum HumMetricTable::getMeterBottom(int line, int track) const {
+	return m_meterBottoms[getMeterIndex(line, track)];
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::isCompound -- Return true if the meter is compound.
+//
+
+bool HumMetricTable::isCompound(int line, int track) const {
+	return m_compound[getMeterIndex(line, track)];
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::getBeatDuration -- Return the duration of the beat in
+//     quarter notes.
+//
+
+HumNum HumMetricTable::getBeatDuration(int line, int track) const {
+	return m_beatDurations[getMeterIndex(line, track)];
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::getExplicitBeat -- Return the beat duration given by a
+//     *beat: interpretation, or 0 if the beat is the default one for the
+//     meter.
+//
+
+HumNum HumMetricTable::getExplicitBeat(int line, int track) const {
+	return m_explicitBeats[getMeterIndex(line, track)];
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::getBeat -- Return the beat number in the measure (from
+//     1), or 0 if there is no position for the line and track.
+//
+
+int HumMetricTable::getBeat(int line, int track) const {
+	int index = getIndex(line, track);
+	return index < 0 ? 0 : m_beats[index];
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::getBeatFraction -- Return the position within the beat
+//     as a fraction of the beat.
+//
+
+HumNum HumMetricTable::getBeatFraction(int line, int track) const {
+	int index = getIndex(line, track);
+	return index < 0 ? HumNum(0) : m_fractions[index];
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::getMetricLevel -- Return the metric level, or the
+//     undefined value if there is no position for the line and track.
+//
+
+double HumMetricTable::getMetricLevel(int line, int track,
+		double undefined) const {
+	int index = getIndex(line, track);
+	return index < 0 ? undefined : m_levels[index];
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::getIndex -- Return the index of a position in the
+//     position arrays, or -1 if there is none.
+//
+
+int HumMetricTable::getIndex(int line, int track) const {
+	if ((line < 0) || (line >= (int)m_rows.size())) {
+		return -1;
+	}
+	if ((track < 1) || (track > m_trackCount) || (m_rows[line] < 0)) {
+		return -1;
+	}
+	return m_rows[line] * m_trackCount + track - 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::getMeterIndex -- Return the meter of a position (0 if
+//     there is no time signature or no position).
+//
+
+int HumMetricTable::getMeterIndex(int line, int track) const {
+	int index = getIndex(line, track);
+	return index < 0 ? 0 : m_meters[index];
+}
+
+
+
+
 //////////////////////////////
 //
 // HumNum::HumNum -- HumNum Constructor.  Set the default value
@@ -15868,6 +18756,420 @@ ostream& operator<<(ostream& out, const HumNum& number) {
 
 
 
+//////////////////////////////
+//
+// HumOutputSink::HumOutputSink -- Constructor.
+//
+
+HumOutputSink::HumOutputSink(void) {
+	setp(m_buffer, m_buffer + sizeof(m_buffer));
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::~HumOutputSink -- Deconstructor.  Derived classes
+//     flush any buffered text in their own deconstructors, since
+//     writeData() cannot be called from here.
+//
+
+HumOutputSink::~HumOutputSink() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::write -- Write a block of text to the sink.  Returns
+//     false if the sink could not accept all of the text.
+//
+
+bool HumOutputSink::write(const char* data, size_t size) {
+	return (size_t)sputn(data, (std::streamsize)size) == size;
+}
+
+
+bool HumOutputSink::write(const string& text) {
+	return write(text.data(), text.size());
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::writeFile -- Write the text of each line in a Humdrum
+//     file.  The line buffers are sent directly to the sink, so nothing
+//     is copied into temporary strings on the way.  If tokens in the file
+//     have been changed, call createLinesFromTokens() on the file first
+//     (as when printing the file to a stream).
+//
+
+bool HumOutputSink::writeFile(HumdrumFileBase& infile) {
+	for (int i=0; i<infile.getLineCount(); i++) {
+		const string& line = infile[i];
+		sputn(line.data(), (std::streamsize)line.size());
+		sputc('\n');
+	}
+	return !m_failed;
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::flush -- Pass any buffered text on to the destination.
+//
+
+bool HumOutputSink::flush(void) {
+	return (pubsync() == 0) && !m_failed;
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::getByteCount -- Return the number of bytes written to
+//     the sink, including any which are still buffered.
+//
+
+size_t HumOutputSink::getByteCount(void) {
+	return m_written + (size_t)(pptr() - pbase());
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::isFailed -- Return true if some text could not be
+//     written to the destination.
+//
+
+bool HumOutputSink::isFailed(void) {
+	return m_failed;
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::setUnbuffered -- Pass all writes directly to writeData()
+//     for destinations that do not benefit from buffering.
+//
+
+void HumOutputSink::setUnbuffered(void) {
+	setp(NULL, NULL);
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::overflow -- Called when the buffer is full.
+//
+
+int HumOutputSink::overflow(int ch) {
+	if (sync() != 0) {
+		return traits_type::eof();
+	}
+	if (ch == traits_type::eof()) {
+		return traits_type::not_eof(ch);
+	}
+	if (pptr() < epptr()) {
+		*pptr() = (char)ch;
+		pbump(1);
+		return ch;
+	}
+	char value = (char)ch;
+	if (!writeData(&value, 1)) {
+		m_failed = true;
+		return traits_type::eof();
+	}
+	m_written++;
+	return ch;
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::xsputn -- Write a block of text.  Blocks that do not fit
+//     into the buffer are passed on without being copied.
+//
+
+std::streamsize HumOutputSink::xsputn(const char* data, std::streamsize size) {
+	if (size <= 0) {
+		return 0;
+	}
+	if (size > epptr() - pptr()) {
+		if (sync() != 0) {
+			return 0;
+		}
+	}
+	if (size <= epptr() - pptr()) {
+		memcpy(pptr(), data, (size_t)size);
+		pbump((int)size);
+		return size;
+	}
+	if (!writeData(data, (size_t)size)) {
+		m_failed = true;
+		return 0;
+	}
+	m_written += (size_t)size;
+	return size;
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::sync -- Pass the buffered text on to writeData().
+//
+
+int HumOutputSink::sync(void) {
+	size_t size = (size_t)(pptr() - pbase());
+	if (size == 0) {
+		return 0;
+	}
+	if (!writeData(pbase(), size)) {
+		m_failed = true;
+		return -1;
+	}
+	m_written += size;
+	setp(pbase(), epptr());
+	return 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumFdSink::HumFdSink -- Constructor.
+//
+
+HumFdSink::HumFdSink(int fd) {
+	m_fd = fd;
+}
+
+
+
+//////////////////////////////
+//
+// HumFdSink::~HumFdSink -- Deconstructor.  The file descriptor is not
+//     closed.
+//
+
+HumFdSink::~HumFdSink() {
+	flush();
+}
+
+
+
+//////////////////////////////
+//
+// HumFdSink::writeData --
+//
+
+bool HumFdSink::writeData(const char* data, size_t size) {
+	while (size > 0) {
+		#ifdef _WIN32
+			int count = _write(m_fd, data, (unsigned int)size);
+		#else
+			ssize_t count = ::write(m_fd, data, size);
+		#endif
+		if (count < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		if (count == 0) {
+			return false;
+		}
+		data += count;
+		size -= (size_t)count;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumBufferSink::HumBufferSink -- Constructor.  The caller's memory is
+//     used as the buffer of the sink, so text is written into it only once.
+//
+
+HumBufferSink::HumBufferSink(char* buffer, size_t capacity) {
+	m_data = buffer;
+	setp(buffer, buffer + capacity);
+}
+
+
+
+//////////////////////////////
+//
+// HumBufferSink::~HumBufferSink -- Deconstructor.
+//
+
+HumBufferSink::~HumBufferSink() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumBufferSink::getData -- Return the start of the caller's buffer.
+//
+
+const char* HumBufferSink::getData(void) {
+	return m_data;
+}
+
+
+
+//////////////////////////////
+//
+// HumBufferSink::getSize -- Return the number of bytes stored in the
+//     caller's buffer.  The text is not null-terminated.
+//
+
+size_t HumBufferSink::getSize(void) {
+	return (size_t)(pptr() - pbase());
+}
+
+
+
+//////////////////////////////
+//
+// HumBufferSink::writeData -- Only called when the buffer is full.
+//
+
+bool HumBufferSink::writeData(const char* data, size_t size) {
+	return false;
+}
+
+
+
+//////////////////////////////
+//
+// HumBufferSink::sync -- The text is already in its final location.
+//
+
+int HumBufferSink::sync(void) {
+	return 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumStringSink::HumStringSink -- Constructor.  The text is appended to
+//     the string as it is written.
+//
+
+HumStringSink::HumStringSink(string& output) : m_output(output) {
+	setUnbuffered();
+}
+
+
+
+//////////////////////////////
+//
+// HumStringSink::~HumStringSink -- Deconstructor.
+//
+
+HumStringSink::~HumStringSink() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumStringSink::writeData --
+//
+
+bool HumStringSink::writeData(const char* data, size_t size) {
+	m_output.append(data, size);
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumStreamSink::HumStreamSink -- Constructor.
+//
+
+HumStreamSink::HumStreamSink(ostream& output) : m_output(output) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumStreamSink::~HumStreamSink -- Deconstructor.
+//
+
+HumStreamSink::~HumStreamSink() {
+	flush();
+}
+
+
+
+//////////////////////////////
+//
+// HumStreamSink::writeData --
+//
+
+bool HumStreamSink::writeData(const char* data, size_t size) {
+	m_output.write(data, (std::streamsize)size);
+	return m_output.good();
+}
+
+
+
+//////////////////////////////
+//
+// HumCallbackSink::HumCallbackSink -- Constructor.
+//
+
+HumCallbackSink::HumCallbackSink(const Callback& callback) {
+	m_callback = callback;
+}
+
+
+
+//////////////////////////////
+//
+// HumCallbackSink::~HumCallbackSink -- Deconstructor.
+//
+
+HumCallbackSink::~HumCallbackSink() {
+	flush();
+}
+
+
+
+//////////////////////////////
+//
+// HumCallbackSink::writeData --
+//
+
+bool HumCallbackSink::writeData(const char* data, size_t size) {
+	if (!m_callback) {
+		return false;
+	}
+	return m_callback(data, size);
+}
+
+
+
+
 //////////////////////////////
 //
 // HumParamSet::HumParamSet --
@@ -17490,6 +20792,2120 @@ HumSignifier* HumSignifiers::getSignifier(int index) {
 
 
 
+//////////////////////////////
+//
+// HumSonority::HumSonority -- Constructor.
+//
+
+HumSonority::HumSonority(const HumSonorityTable* table, int line) {
+	m_table = table;
+	m_line  = line;
+	m_start = 0;
+	m_count = 0;
+	if (table && (line >= 0) && (line < table->getLineCount())) {
+		m_start = table->m_noteStart[line];
+		m_count = table->m_noteCount[line];
+	} else {
+		m_table = NULL;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getLineIndex -- Return the line of the sonority in the file.
+//
+
+int HumSonority::getLineIndex(void) const {
+	return m_line;
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::isEmpty -- Return true if no notes are sounding.
+//
+
+bool HumSonority::isEmpty(void) const {
+	return m_count == 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getNoteCount -- Return the number of notes sounding,
+//     including doubled pitches.
+//
+
+int HumSonority::getNoteCount(void) const {
+	return m_count;
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getAttackCount -- Return the number of notes that start
+//     on the line.
+//
+
+int HumSonority::getAttackCount(void) const {
+	if (!m_table) {
+		return 0;
+	}
+	return m_table->m_attackCount[m_line];
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getVoiceCount -- Return the number of fields containing
+//     sounding notes (a chord counts as one voice).
+//
+
+int HumSonority::getVoiceCount(void) const {
+	if (!m_table) {
+		return 0;
+	}
+	return m_table->m_voiceCount[m_line];
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getBase40 -- Return the base-40 pitch of a note.
+//
+
+int HumSonority::getBase40(int index) const {
+	return m_table->m_base40.at(m_start + index);
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getBase40Pc -- Return the base-40 pitch class of a note.
+//
+
+int HumSonority::getBase40Pc(int index) const {
+	return getBase40(index) % 40;
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getMidiPitch -- Return the MIDI note number of a note.
+//
+
+int HumSonority::getMidiPitch(int index) const {
+	return m_table->m_midi.at(m_start + index);
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getToken -- Return the token containing the note, which is
+//     on an earlier line for sustained notes.
+//
+
+HTp HumSonority::getToken(int index) const {
+	return m_table->m_tokens.at(m_start + index);
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getFieldIndex -- Return the field on the sonority's line
+//     in which the note is sounding.
+//
+
+int HumSonority::getFieldIndex(int index) const {
+	return m_table->m_fields.at(m_start + index);
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getSubtokenIndex -- Return the chord index of the note in
+//     its token.
+//
+
+int HumSonority::getSubtokenIndex(int index) const {
+	return m_table->m_subtokens.at(m_start + index);
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::isAttack -- Return true if the note starts on the line.
+//
+
+bool HumSonority::isAttack(int index) const {
+	return m_table->m_attacks.at(m_start + index) != 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getLowestIndex -- Return the index of the lowest note (the
+//     first one if more than one voice has the lowest pitch), or -1 if
+//     there are no notes.
+//
+
+int HumSonority::getLowestIndex(void) const {
+	if (m_count == 0) {
+		return -1;
+	}
+	return m_table->m_lowest[m_line];
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getPitchClassSet -- Return the set of base-40 pitch classes
+//     sounding on the line.
+//
+
+uint64_t HumSonority::getPitchClassSet(void) const {
+	if (!m_table) {
+		return 0;
+	}
+	return m_table->m_pitchClasses[m_line];
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getAttackPitchClassSet -- Return the set of base-40 pitch
+//     classes attacked on the line.
+//
+
+uint64_t HumSonority::getAttackPitchClassSet(void) const {
+	if (!m_table) {
+		return 0;
+	}
+	return m_table->m_attackPitchClasses[m_line];
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getPitchClassSet12 -- Return the set of chromatic pitch
+//     classes sounding on the line.
+//
+
+uint16_t HumSonority::getPitchClassSet12(void) const {
+	if (!m_table) {
+		return 0;
+	}
+	return m_table->m_pitchClasses12[m_line];
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getAttackPitchClassSet12 -- Return the set of chromatic
+//     pitch classes attacked on the line.
+//
+
+uint16_t HumSonority::getAttackPitchClassSet12(void) const {
+	if (!m_table) {
+		return 0;
+	}
+	return m_table->m_attackPitchClasses12[m_line];
+}
+
+
+
+
+
+//////////////////////////////
+//
+// HumSonorityTable::HumSonorityTable -- Constructor.
+//
+
+HumSonorityTable::HumSonorityTable(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumSonorityTable::clear -- Remove all sonorities.
+//
+
+void HumSonorityTable::clear(void) {
+	m_noteStart.clear();
+	m_noteCount.clear();
+	m_attackCount.clear();
+	m_voiceCount.clear();
+	m_lowest.clear();
+	m_pitchClasses.clear();
+	m_attackPitchClasses.clear();
+	m_pitchClasses12.clear();
+	m_attackPitchClasses12.clear();
+	m_dataLines.clear();
+	m_base40.clear();
+	m_midi.clear();
+	m_tokens.clear();
+	m_fields.clear();
+	m_subtokens.clear();
+	m_attacks.clear();
+}
+
+
+
+//////////////////////////////
+//
+// HumSonorityTable::resize -- Remove all sonorities and prepare empty
+//     sonorities for the given number of lines.
+//
+
+void HumSonorityTable::resize(int lineCount) {
+	clear();
+	m_noteStart.assign(lineCount, 0);
+	m_noteCount.assign(lineCount, 0);
+	m_attackCount.assign(lineCount, 0);
+	m_voiceCount.assign(lineCount, 0);
+	m_lowest.assign(lineCount, -1);
+	m_pitchClasses.assign(lineCount, 0);
+	m_attackPitchClasses.assign(lineCount, 0);
+	m_pitchClasses12.assign(lineCount, 0);
+	m_attackPitchClasses12.assign(lineCount, 0);
+}
+
+
+
+//////////////////////////////
+//
+// HumSonorityTable::addSlice -- Start the sonority of a data line.  The
+//     notes of the line are then added with addNote() before the next
+//     slice is started.
+//
+
+void HumSonorityTable::addSlice(int line) {
+	if ((line < 0) || (line >= (int)m_noteStart.size())) {
+		return;
+	}
+	m_dataLines.push_back(line);
+	m_noteStart[line] = (int)m_base40.size();
+	m_noteCount[line] = 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumSonorityTable::addNote -- Add a note to the sonority of the most
+//     recently added slice.
+//
+
+void HumSonorityTable::addNote(int line, HTp token, int field, int subtoken,
+		int base40, bool attack) {
+	if ((line < 0) || (line >= (int)m_noteStart.size())) {
+		return;
+	}
+	int midi = Convert::base40ToMidiNoteNumber(base40);
+	int pc40 = base40 % 40;
+	int pc12 = ((midi % 12) + 12) % 12;
+	int count = m_noteCount[line];
+	if ((count == 0) || (m_fields.back() != field)) {
+		m_voiceCount[line]++;
+	}
+	if ((count == 0) || (midi < m_midi[m_noteStart[line] + m_lowest[line]])) {
+		m_lowest[line] = (short)count;
+	}
+
+	m_base40.push_back((short)base40);
+	m_midi.push_back((short)midi);
+	m_tokens.push_back(token);
+	m_fields.push_back((short)field);
+	m_subtokens.push_back((uint8_t)subtoken);
+	m_attacks.push_back(attack ? 1 : 0);
+	m_noteCount[line]++;
+
+	m_pitchClasses[line] |= (uint64_t)1 << pc40;
+	m_pitchClasses12[line] |= (uint16_t)(1 << pc12);
+	if (attack) {
+		m_attackCount[line]++;
+		m_attackPitchClasses[line] |= (uint64_t)1 << pc40;
+		m_attackPitchClasses12[line] |= (uint16_t)(1 << pc12);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumSonorityTable::getLineCount -- Return the number of lines in the
+//     file when the table was filled.
+//
+
+int HumSonorityTable::getLineCount(void) const {
+	return (int)m_noteStart.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumSonorityTable::getSliceCount -- Return the number of data lines.
+//
+
+int HumSonorityTable::getSliceCount(void) const {
+	return (int)m_dataLines.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumSonorityTable::getSonority -- Return the sonority on a line (which is
+//     empty for non-data lines).
+//
+
+HumSonority HumSonorityTable::getSonority(int line) const {
+	return HumSonority(this, line);
+}
+
+
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::HumSpanTable -- Constructor.
+//
+
+HumSpanTable::HumSpanTable(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::clear -- Remove all links.
+//
+
+void HumSpanTable::clear(void) {
+	m_firstStart.clear();
+	m_firstEnd.clear();
+	m_startCount.clear();
+	m_endCount.clear();
+	m_flags.clear();
+	m_spanStart.clear();
+	m_startTokens.clear();
+	m_endTokens.clear();
+	m_startNumbers.clear();
+	m_endNumbers.clear();
+	m_durations.clear();
+	m_nextStart.clear();
+	m_nextEnd.clear();
+	m_hangingDurations.clear();
+	m_openIndexes.clear();
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::resize -- Remove all links and prepare the table
+//    for the given number of tokens.
+//
+
+void HumSpanTable::resize(int tokenCount) {
+	clear();
+	m_firstStart.assign(tokenCount, -1);
+	m_firstEnd.assign(tokenCount, -1);
+	m_startCount.assign(tokenCount, 0);
+	m_endCount.assign(tokenCount, 0);
+	m_flags.assign(tokenCount, 0);
+	m_spanStart.assign(tokenCount, NULL);
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::addLink -- Store a link between the start and end of a
+//    span.  The start number is the enumeration of the opening character
+//    on the start token, and the end number is the enumeration of the
+//    closing character on the end token.
+//
+
+void HumSpanTable::addLink(int startid, int endid, HTp starttok, HTp endtok,
+		int startnumber, int endnumber, HumNum duration) {
+	if ((startid < 0) || (startid >= (int)m_firstStart.size())) {
+		return;
+	}
+	if ((endid < 0) || (endid >= (int)m_firstEnd.size())) {
+		return;
+	}
+	std::unique_lock<std::mutex> lock;
+	if (m_mutex) {
+		lock = std::unique_lock<std::mutex>(*m_mutex);
+	}
+	int link = (int)m_startTokens.size();
+	m_startTokens.push_back(starttok);
+	m_endTokens.push_back(endtok);
+	m_startNumbers.push_back(startnumber);
+	m_endNumbers.push_back(endnumber);
+	m_durations.push_back(duration);
+	m_nextStart.push_back(m_firstStart[startid]);
+	m_nextEnd.push_back(m_firstEnd[endid]);
+	m_firstStart[startid] = link;
+	m_firstEnd[endid] = link;
+	m_startCount[startid]++;
+	m_endCount[endid]++;
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::addHanging -- Mark a token as having a span start or end
+//    which does not have a matching end or start.  Spans which end at the
+//    start of a repeat ending are marked with endingback set to true (and
+//    are not considered hanging).
+//
+
+void HumSpanTable::addHanging(int id, bool start, HumNum duration,
+		int openindex, bool endingback) {
+	if ((id < 0) || (id >= (int)m_flags.size())) {
+		return;
+	}
+	std::unique_lock<std::mutex> lock;
+	if (m_mutex) {
+		lock = std::unique_lock<std::mutex>(*m_mutex);
+	}
+	if (endingback) {
+		m_flags[id] |= FLAG_ENDING_BACK;
+	} else {
+		m_flags[id] &= ~(FLAG_HANGING_START | FLAG_HANGING_STOP);
+		m_flags[id] |= start ? FLAG_HANGING_START : FLAG_HANGING_STOP;
+	}
+	m_hangingDurations[id] = duration;
+	if (openindex >= 0) {
+		m_openIndexes[id] = openindex;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::setSpanMember -- Store the start of a span which contains
+//    the token (used for beams which cross barlines).
+//
+
+void HumSpanTable::setSpanMember(int id, HTp spanstart) {
+	if ((id < 0) || (id >= (int)m_flags.size())) {
+		return;
+	}
+	m_spanStart[id] = spanstart;
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::setSpanEndpoints -- Mark the start and end tokens of a
+//    span which crosses a barline.
+//
+
+void HumSpanTable::setSpanEndpoints(int startid, int endid) {
+	if ((startid >= 0) && (startid < (int)m_flags.size())) {
+		m_flags[startid] |= FLAG_SPAN_START;
+	}
+	if ((endid >= 0) && (endid < (int)m_flags.size())) {
+		m_flags[endid] |= FLAG_SPAN_END;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::findStartLink -- Return the link starting on the token
+//    with the given start number, or -1 if none.
+//
+
+int HumSpanTable::findStartLink(int id, int startnumber) const {
+	if ((id < 0) || (id >= (int)m_firstStart.size())) {
+		return -1;
+	}
+	for (int link=m_firstStart[id]; link>=0; link=m_nextStart[link]) {
+		if (m_startNumbers[link] == startnumber) {
+			return link;
+		}
+	}
+	return -1;
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::findEndLink -- Return the link ending on the token
+//    with the given end number, or -1 if none.
+//
+
+int HumSpanTable::findEndLink(int id, int endnumber) const {
+	if ((id < 0) || (id >= (int)m_firstEnd.size())) {
+		return -1;
+	}
+	for (int link=m_firstEnd[id]; link>=0; link=m_nextEnd[link]) {
+		if (m_endNumbers[link] == endnumber) {
+			return link;
+		}
+	}
+	return -1;
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::getEndToken -- Return the end token of the span which
+//    starts on the given token with the given start number, or NULL
+//    if none.
+//
+
+HTp HumSpanTable::getEndToken(int id, int startnumber) const {
+	int link = findStartLink(id, startnumber);
+	return link < 0 ? NULL : m_endTokens[link];
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::getStartToken -- Return the start token of the span which
+//    ends on the given token with the given end number, or NULL if none.
+//
+
+HTp HumSpanTable::getStartToken(int id, int endnumber) const {
+	int link = findEndLink(id, endnumber);
+	return link < 0 ? NULL : m_startTokens[link];
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::getEndNumber -- Return the end number (on the end token)
+//    for the span with the given start number on the token, or 0 if none.
+//
+
+int HumSpanTable::getEndNumber(int id, int startnumber) const {
+	int link = findStartLink(id, startnumber);
+	return link < 0 ? 0 : m_endNumbers[link];
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::getStartNumber -- Return the start number (on the start
+//    token) for the span with the given end number on the token, or 0
+//    if none.
+//
+
+int HumSpanTable::getStartNumber(int id, int endnumber) const {
+	int link = findEndLink(id, endnumber);
+	return link < 0 ? 0 : m_startNumbers[link];
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::getDuration -- Return the duration of the span which
+//    starts on the given token with the given start number.  For hanging
+//    spans, the duration stored with addHanging() is returned.  Returns 0
+//    if there is no span.
+//
+
+HumNum HumSpanTable::getDuration(int id, int startnumber) const {
+	int link = findStartLink(id, startnumber);
+	if (link >= 0) {
+		return m_durations[link];
+	}
+	if (startnumber == 1) {
+		auto it = m_hangingDurations.find(id);
+		if (it != m_hangingDurations.end()) {
+			return it->second;
+		}
+	}
+	return 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::getStartCount -- Return the number of linked spans
+//     starting on the token.
+//
+
+int HumSpanTable::getStartCount(int id) const {
+	if ((id < 0) || (id >= (int)m_startCount.size())) {
+		return 0;
+	}
+	return m_startCount[id];
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::getEndCount -- Return the number of linked spans
+//     ending on the token.
+//
+
+int HumSpanTable::getEndCount(int id) const {
+	if ((id < 0) || (id >= (int)m_endCount.size())) {
+		return 0;
+	}
+	return m_endCount[id];
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::getHangingSide -- Return +1 if the token has an unmatched
+//     span start, -1 if it has an unmatched span end, or 0 otherwise.
+//
+
+int HumSpanTable::getHangingSide(int id) const {
+	if ((id < 0) || (id >= (int)m_flags.size())) {
+		return 0;
+	}
+	if (m_flags[id] & FLAG_HANGING_START) {
+		return +1;
+	} else if (m_flags[id] & FLAG_HANGING_STOP) {
+		return -1;
+	}
+	return 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::getOpenIndex -- Return the index of the closing character
+//     of an unmatched span end on the token, or -1 if none.
+//
+
+int HumSpanTable::getOpenIndex(int id) const {
+	auto it = m_openIndexes.find(id);
+	if (it == m_openIndexes.end()) {
+		return -1;
+	}
+	return it->second;
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::isEndingBack -- Return true if the token ends a span which
+//     starts before a repeat ending.
+//
+
+bool HumSpanTable::isEndingBack(int id) const {
+	if ((id < 0) || (id >= (int)m_flags.size())) {
+		return false;
+	}
+	return m_flags[id] & FLAG_ENDING_BACK;
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::getSpanStart -- Return the start of the barline-crossing
+//     span containing the token, or NULL if none.
+//
+
+HTp HumSpanTable::getSpanStart(int id) const {
+	if ((id < 0) || (id >= (int)m_spanStart.size())) {
+		return NULL;
+	}
+	return m_spanStart[id];
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::isSpanStart -- Return true if the token starts a
+//     barline-crossing span.
+//
+
+bool HumSpanTable::isSpanStart(int id) const {
+	if ((id < 0) || (id >= (int)m_flags.size())) {
+		return false;
+	}
+	return m_flags[id] & FLAG_SPAN_START;
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::isSpanEnd -- Return true if the token ends a
+//     barline-crossing span.
+//
+
+bool HumSpanTable::isSpanEnd(int id) const {
+	if ((id < 0) || (id >= (int)m_flags.size())) {
+		return false;
+	}
+	return m_flags[id] & FLAG_SPAN_END;
+}
+
+
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::HumStrandTable -- Constructor.
+//
+
+HumStrandTable::HumStrandTable(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::clear -- Remove all strands and entries.
+//
+
+void HumStrandTable::clear(void) {
+	m_lineCount = 0;
+	m_offsets.clear();
+	m_spines.clear();
+	m_tracks.clear();
+	m_tokens.clear();
+	m_lines.clear();
+	m_fields.clear();
+	m_startTimes.clear();
+	m_strophes.clear();
+	m_types.clear();
+	m_stropheStarts.clear();
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::setLineCount -- Store the number of lines in the file
+//     being analyzed.
+//
+
+void HumStrandTable::setLineCount(int lineCount) {
+	m_lineCount = lineCount;
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::addStrand -- Add a strand to the table, returning its
+//     index.  The tokens of the strand must be added before the next
+//     strand.
+//
+
+int HumStrandTable::addStrand(int spine) {
+	m_offsets.push_back((int)m_tokens.size());
+	m_spines.push_back(spine);
+	m_tracks.push_back(0);
+	return (int)m_offsets.size() - 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::addToken -- Add a token to the end of the last strand in
+//     the table, returning the index of its entry.
+//
+
+int HumStrandTable::addToken(HTp token) {
+	if (m_offsets.empty()) {
+		return -1;
+	}
+	int strophe = -1;
+	HTp start = token->getStrophe();
+	if (start) {
+		// Search from the last strophe, since tokens of a strophe are
+		// usually added together.
+		for (int i=(int)m_stropheStarts.size()-1; i>=0; i--) {
+			if (m_stropheStarts[i] == start) {
+				strophe = i;
+				break;
+			}
+		}
+		if (strophe < 0) {
+			m_stropheStarts.push_back(start);
+			strophe = (int)m_stropheStarts.size() - 1;
+		}
+	}
+	if ((int)m_tokens.size() == m_offsets.back()) {
+		m_tracks.back() = token->getTrack();
+	}
+	m_tokens.push_back(token);
+	m_lines.push_back(token->getLineIndex());
+	m_fields.push_back(token->getFieldIndex());
+	m_startTimes.push_back(token->getDurationFromStart());
+	m_strophes.push_back(strophe);
+	uint8_t type = 0;
+	if (token->isData()) {
+		type |= TYPE_DATA;
+		if (token->isNull()) {
+			type |= TYPE_NULL;
+		}
+	}
+	m_types.push_back(type);
+	return (int)m_tokens.size() - 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getLineCount -- Return the number of lines in the file
+//     when the table was filled.
+//
+
+int HumStrandTable::getLineCount(void) const {
+	return m_lineCount;
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getStrandCount -- Return the number of strands.
+//
+
+int HumStrandTable::getStrandCount(void) const {
+	return (int)m_offsets.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getStrandOffset -- Return the index of the first entry
+//     of a strand.
+//
+
+int HumStrandTable::getStrandOffset(int strand) const {
+	if ((strand < 0) || (strand >= (int)m_offsets.size())) {
+		return 0;
+	}
+	return m_offsets[strand];
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getStrandSize -- Return the number of entries (tokens)
+//     in a strand.
+//
+
+int HumStrandTable::getStrandSize(int strand) const {
+	if ((strand < 0) || (strand >= (int)m_offsets.size())) {
+		return 0;
+	}
+	if (strand == (int)m_offsets.size() - 1) {
+		return (int)m_tokens.size() - m_offsets[strand];
+	}
+	return m_offsets[strand + 1] - m_offsets[strand];
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getStrandSpine -- Return the index of the spine (in the
+//     order of the exclusive interpretations) that a strand belongs to.
+//
+
+int HumStrandTable::getStrandSpine(int strand) const {
+	if ((strand < 0) || (strand >= (int)m_spines.size())) {
+		return -1;
+	}
+	return m_spines[strand];
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getStrandTrack -- Return the track number of a strand.
+//
+
+int HumStrandTable::getStrandTrack(int strand) const {
+	if ((strand < 0) || (strand >= (int)m_tracks.size())) {
+		return 0;
+	}
+	return m_tracks[strand];
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getEntryCount -- Return the number of entries in all
+//     strands.
+//
+
+int HumStrandTable::getEntryCount(void) const {
+	return (int)m_tokens.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getToken -- Return the token of an entry.
+//
+
+HTp HumStrandTable::getToken(int entry) const {
+	if ((entry < 0) || (entry >= (int)m_tokens.size())) {
+		return NULL;
+	}
+	return m_tokens[entry];
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getLine -- Return the line index of the token of an
+//     entry.
+//
+
+int HumStrandTable::getLine(int entry) const {
+	if ((entry < 0) || (entry >= (int)m_lines.size())) {
+		return -1;
+	}
+	return m_lines[entry];
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getField -- Return the field index of the token of an
+//     entry.
+//
+
+int HumStrandTable::getField(int entry) const {
+	if ((entry < 0) || (entry >= (int)m_fields.size())) {
+		return -1;
+	}
+	return m_fields[entry];
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getStartTime -- Return the start time of the token of
+//     an entry in quarter notes from the start of the file.
+//
+
+HumNum HumStrandTable::getStartTime(int entry) const {
+	if ((entry < 0) || (entry >= (int)m_startTimes.size())) {
+		return 0;
+	}
+	return m_startTimes[entry];
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getStrophe -- Return the index of the strophe
+//     containing the token of an entry, or -1 if the token is not in a
+//     strophe.
+//
+
+int HumStrandTable::getStrophe(int entry) const {
+	if ((entry < 0) || (entry >= (int)m_strophes.size())) {
+		return -1;
+	}
+	return m_strophes[entry];
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getStropheCount -- Return the number of strophes in the
+//     strands.
+//
+
+int HumStrandTable::getStropheCount(void) const {
+	return (int)m_stropheStarts.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getStropheStart -- Return the *S/ interpretation that
+//     starts a strophe.
+//
+
+HTp HumStrandTable::getStropheStart(int strophe) const {
+	if ((strophe < 0) || (strophe >= (int)m_stropheStarts.size())) {
+		return NULL;
+	}
+	return m_stropheStarts[strophe];
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::isData -- Return true if the token of an entry is on a
+//     data line.
+//
+
+bool HumStrandTable::isData(int entry) const {
+	if ((entry < 0) || (entry >= (int)m_types.size())) {
+		return false;
+	}
+	return m_types[entry] & TYPE_DATA;
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::isNull -- Return true if the token of an entry is a
+//     null data token.
+//
+
+bool HumStrandTable::isNull(int entry) const {
+	if ((entry < 0) || (entry >= (int)m_types.size())) {
+		return false;
+	}
+	return m_types[entry] & TYPE_NULL;
+}
+
+
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::HumTextIndex -- Constructor.
+//
+
+HumTextIndex::HumTextIndex(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::clear -- Remove all files and words.
+//
+
+void HumTextIndex::clear(void) {
+	m_files.clear();
+	m_words.clear();
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::addFile -- Add the words of the lyric spines of a file to
+//     the index, returning the index of the file.
+//
+
+int HumTextIndex::addFile(HumdrumFile& infile, const string& filename) {
+	int file = (int)m_files.size();
+	m_files.push_back(filename);
+	if (infile.getLineCount() == 0) {
+		return file;
+	}
+	const HumTextTable& table = infile.getTextTable();
+	HumTextPosting posting;
+	posting.file = file;
+	for (int i=0; i<table.getSpineCount(); i++) {
+		posting.spine = i;
+		posting.position = 0;
+		posting.track = table.getSpineStart(i)->getTrack();
+		int start = table.getSpineWordStart(i);
+		int count = table.getSpineWordCount(i);
+		for (int j=start; j<start+count; j++) {
+			const string& word = table.getNormalizedWord(j);
+			if (word.empty()) {
+				continue;
+			}
+			HTp token = table.getWordToken(j);
+			posting.line  = token->getLineIndex();
+			posting.field = token->getFieldIndex();
+			posting.notes = table.getWordNoteCount(j);
+			size_t begin = 0;
+			while (begin < word.size()) {
+				size_t end = word.find(' ', begin);
+				if (end == string::npos) {
+					end = word.size();
+				}
+				m_words[word.substr(begin, end - begin)].push_back(posting);
+				posting.position++;
+				begin = end + 1;
+			}
+		}
+	}
+	return file;
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::append -- Add the files and words of another index after
+//     the files of this index.
+//
+
+void HumTextIndex::append(const HumTextIndex& index) {
+	int offset = (int)m_files.size();
+	m_files.insert(m_files.end(), index.m_files.begin(), index.m_files.end());
+	for (auto& entry : index.m_words) {
+		vector<HumTextPosting>& postings = m_words[entry.first];
+		postings.reserve(postings.size() + entry.second.size());
+		for (int i=0; i<(int)entry.second.size(); i++) {
+			postings.push_back(entry.second[i]);
+			postings.back().file += offset;
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::getFileCount -- Return the number of files in the index.
+//
+
+int HumTextIndex::getFileCount(void) const {
+	return (int)m_files.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::getFilename -- Return the name of a file in the index.
+//
+
+const string& HumTextIndex::getFilename(int file) const {
+	static const string empty;
+	if ((file < 0) || (file >= (int)m_files.size())) {
+		return empty;
+	}
+	return m_files[file];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::getWordCount -- Return the number of distinct words in
+//     the index.
+//
+
+int HumTextIndex::getWordCount(void) const {
+	return (int)m_words.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::getWordList -- Return the distinct words of the index in
+//     sorted order.
+//
+
+void HumTextIndex::getWordList(vector<string>& words) const {
+	words.clear();
+	words.reserve(m_words.size());
+	for (auto& entry : m_words) {
+		words.push_back(entry.first);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::find -- Return the occurrences of a normalized word, or
+//     NULL if the word is not in the index.
+//
+
+const vector<HumTextPosting>* HumTextIndex::find(const string& word) const {
+	auto it = m_words.find(word);
+	if (it == m_words.end()) {
+		return NULL;
+	}
+	return &it->second;
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::search -- Find the occurrences of a word or phrase.  The
+//     query is normalized, and for a phrase the words must be at
+//     consecutive positions in a lyric spine.  If prefix is true, each
+//     word of the query matches any word starting with it.  The matches
+//     are the postings of the first word of each occurrence, sorted by
+//     file, spine and position.  Returns the number of matches.
+//
+
+int HumTextIndex::search(vector<HumTextPosting>& matches, const string& query,
+		bool prefix) const {
+	matches.clear();
+	string normal = HumTextTable::normalize(query);
+	vector<string> words;
+	stringstream stream(normal);
+	string word;
+	while (stream >> word) {
+		words.push_back(word);
+	}
+	if (words.empty()) {
+		return 0;
+	}
+
+	getPostings(matches, words[0], prefix);
+	vector<HumTextPosting> next;
+	vector<HumTextPosting> kept;
+	for (int i=1; (i<(int)words.size()) && !matches.empty(); i++) {
+		getPostings(next, words[i], prefix);
+		kept.clear();
+		HumTextPosting target;
+		for (int j=0; j<(int)matches.size(); j++) {
+			target.file     = matches[j].file;
+			target.spine    = matches[j].spine;
+			target.position = matches[j].position + i;
+			if (binary_search(next.begin(), next.end(), target, isBefore)) {
+				kept.push_back(matches[j]);
+			}
+		}
+		matches.swap(kept);
+	}
+	return (int)matches.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::getPostings -- Get the occurrences of a word (or of all
+//     words starting with it if prefix is true), sorted by file, spine and
+//     position.
+//
+
+void HumTextIndex::getPostings(vector<HumTextPosting>& postings,
+		const string& word, bool prefix) const {
+	postings.clear();
+	if (!prefix) {
+		const vector<HumTextPosting>* found = find(word);
+		if (found) {
+			postings = *found;
+		}
+		return;
+	}
+	for (auto it = m_words.lower_bound(word); it != m_words.end(); ++it) {
+		if (it->first.compare(0, word.size(), word) != 0) {
+			break;
+		}
+		postings.insert(postings.end(), it->second.begin(), it->second.end());
+	}
+	sort(postings.begin(), postings.end(), isBefore);
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::isBefore -- Order of postings by file, spine and position.
+//
+
+bool HumTextIndex::isBefore(const HumTextPosting& a, const HumTextPosting& b) {
+	if (a.file != b.file) {
+		return a.file < b.file;
+	}
+	if (a.spine != b.spine) {
+		return a.spine < b.spine;
+	}
+	return a.position < b.position;
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::write -- Write the index in its text form.
+//
+
+bool HumTextIndex::write(ostream& out) const {
+	out << "!!!HUMTEXTINDEX: 1\n";
+	for (int i=0; i<(int)m_files.size(); i++) {
+		out << "@file\t" << m_files[i] << '\n';
+	}
+	for (auto& entry : m_words) {
+		out << entry.first;
+		for (const HumTextPosting& p : entry.second) {
+			out << '\t' << p.file << ':' << p.line << ':' << p.field << ':'
+			    << p.track << ':' << p.spine << ':' << p.position << ':' << p.notes;
+		}
+		out << '\n';
+	}
+	out.flush();
+	return (bool)out;
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::writeFile --
+//
+
+bool HumTextIndex::writeFile(const string& filename) const {
+	std::ofstream output(filename);
+	if (!output.is_open()) {
+		return false;
+	}
+	return write(output);
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::read -- Read an index in its text form, replacing the
+//     contents of the index.  Returns false if the input is not a valid
+//     index.
+//
+
+bool HumTextIndex::read(istream& in) {
+	clear();
+	string line;
+	if (!getline(in, line) || (line != "!!!HUMTEXTINDEX: 1")) {
+		return false;
+	}
+	while (getline(in, line)) {
+		if (line.empty()) {
+			continue;
+		}
+		if (line.compare(0, 6, "@file\t") == 0) {
+			m_files.push_back(line.substr(6));
+			continue;
+		}
+		size_t tab = line.find('\t');
+		if ((tab == 0) || (tab == string::npos)) {
+			clear();
+			return false;
+		}
+		vector<HumTextPosting>& postings = m_words[line.substr(0, tab)];
+		while (tab != string::npos) {
+			HumTextPosting p;
+			int count = sscanf(line.c_str() + tab + 1, "%d:%d:%d:%d:%d:%d:%d",
+					&p.file, &p.line, &p.field, &p.track, &p.spine, &p.position,
+					&p.notes);
+			if ((count != 7) || (p.file < 0) || (p.file >= (int)m_files.size())) {
+				clear();
+				return false;
+			}
+			postings.push_back(p);
+			tab = line.find('\t', tab + 1);
+		}
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::readFile --
+//
+
+bool HumTextIndex::readFile(const string& filename) {
+	ifstream input(filename);
+	if (!input.is_open()) {
+		return false;
+	}
+	return read(input);
+}
+
+
+
+
+//////////////////////////////
+//
+// HumTextTable::HumTextTable -- Constructor.
+//
+
+HumTextTable::HumTextTable(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::clear -- Remove all spines, syllables and words.
+//
+
+void HumTextTable::clear(void) {
+	m_lineCount = 0;
+	m_spineStarts.clear();
+	m_spineSyllables.clear();
+	m_spineWords.clear();
+	m_syllables.clear();
+	m_syllableWords.clear();
+	m_noteCounts.clear();
+	m_firstNotes.clear();
+	m_lastNotes.clear();
+	m_endTimes.clear();
+	m_words.clear();
+	m_normalized.clear();
+	m_wordSpines.clear();
+	m_wordSyllables.clear();
+	m_wordNotes.clear();
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::setLineCount -- Store the number of lines in the file
+//     being analyzed.
+//
+
+void HumTextTable::setLineCount(int lineCount) {
+	m_lineCount = lineCount;
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::addSpine -- Add a lyric spine to the table, returning its
+//     index.  The syllables of the spine must be added before the next
+//     spine.
+//
+
+int HumTextTable::addSpine(HTp start) {
+	m_spineStarts.push_back(start);
+	m_spineSyllables.push_back((int)m_syllables.size());
+	m_spineWords.push_back((int)m_words.size());
+	return (int)m_spineStarts.size() - 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::addSyllable -- Add a syllable to the last spine in the
+//     table, either starting a new word or continuing the previous word of
+//     the spine, and return the index of the syllable.  The notes of the
+//     syllable are set later with setNotes().
+//
+
+int HumTextTable::addSyllable(int spine, HTp token) {
+	if ((spine < 0) || (spine != (int)m_spineStarts.size() - 1)) {
+		return -1;
+	}
+	string text = *token;
+	bool continuation = false;
+	if ((!text.empty()) && (text[0] == '-')) {
+		text.erase(0, 1);
+		continuation = (int)m_words.size() > m_spineWords[spine];
+	}
+	if ((!text.empty()) && (text.back() == '-')) {
+		text.pop_back();
+	}
+
+	int syllable = (int)m_syllables.size();
+	if (continuation) {
+		m_words.back() += text;
+		m_normalized.back() = normalize(m_words.back());
+	} else {
+		m_words.push_back(text);
+		m_normalized.push_back(normalize(text));
+		m_wordSpines.push_back(spine);
+		m_wordSyllables.push_back(syllable);
+		m_wordNotes.push_back(0);
+	}
+	m_syllables.push_back(token);
+	m_syllableWords.push_back((int)m_words.size() - 1);
+	m_noteCounts.push_back(0);
+	m_firstNotes.push_back(NULL);
+	m_lastNotes.push_back(NULL);
+	m_endTimes.push_back(token->getDurationFromStart());
+	return syllable;
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::setNotes -- Store the notes that a syllable is sung on:
+//     the number of note attacks, the first and last note tokens (NULL if
+//     none), and the end time of the last note.
+//
+
+void HumTextTable::setNotes(int syllable, int count, HTp first, HTp last,
+		HumNum endtime) {
+	if ((syllable < 0) || (syllable >= (int)m_syllables.size())) {
+		return;
+	}
+	m_wordNotes[m_syllableWords[syllable]] += count - m_noteCounts[syllable];
+	m_noteCounts[syllable] = count;
+	m_firstNotes[syllable] = first;
+	m_lastNotes[syllable]  = last;
+	m_endTimes[syllable]   = endtime;
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getLineCount -- Return the number of lines in the file
+//     when the table was filled.
+//
+
+int HumTextTable::getLineCount(void) const {
+	return m_lineCount;
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getSpineCount -- Return the number of lyric spines.
+//
+
+int HumTextTable::getSpineCount(void) const {
+	return (int)m_spineStarts.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getSpineStart -- Return the exclusive interpretation of
+//     a lyric spine.
+//
+
+HTp HumTextTable::getSpineStart(int spine) const {
+	if ((spine < 0) || (spine >= (int)m_spineStarts.size())) {
+		return NULL;
+	}
+	return m_spineStarts[spine];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getSpineSyllableStart -- Return the index of the first
+//     syllable of a spine.
+//
+
+int HumTextTable::getSpineSyllableStart(int spine) const {
+	if ((spine < 0) || (spine >= (int)m_spineStarts.size())) {
+		return 0;
+	}
+	return m_spineSyllables[spine];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getSpineSyllableCount -- Return the number of syllables
+//     in a spine.
+//
+
+int HumTextTable::getSpineSyllableCount(int spine) const {
+	if ((spine < 0) || (spine >= (int)m_spineStarts.size())) {
+		return 0;
+	}
+	if (spine == (int)m_spineStarts.size() - 1) {
+		return (int)m_syllables.size() - m_spineSyllables[spine];
+	}
+	return m_spineSyllables[spine + 1] - m_spineSyllables[spine];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getSpineWordStart -- Return the index of the first word
+//     of a spine.
+//
+
+int HumTextTable::getSpineWordStart(int spine) const {
+	if ((spine < 0) || (spine >= (int)m_spineStarts.size())) {
+		return 0;
+	}
+	return m_spineWords[spine];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getSpineWordCount -- Return the number of words in a
+//     spine.
+//
+
+int HumTextTable::getSpineWordCount(int spine) const {
+	if ((spine < 0) || (spine >= (int)m_spineStarts.size())) {
+		return 0;
+	}
+	if (spine == (int)m_spineStarts.size() - 1) {
+		return (int)m_words.size() - m_spineWords[spine];
+	}
+	return m_spineWords[spine + 1] - m_spineWords[spine];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getSyllableCount -- Return the number of syllables in
+//     all spines.
+//
+
+int HumTextTable::getSyllableCount(void) const {
+	return (int)m_syllables.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getSyllableToken -- Return the token of a syllable.
+//
+
+HTp HumTextTable::getSyllableToken(int syllable) const {
+	if ((syllable < 0) || (syllable >= (int)m_syllables.size())) {
+		return NULL;
+	}
+	return m_syllables[syllable];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getSyllableSpine -- Return the spine of a syllable.
+//
+
+int HumTextTable::getSyllableSpine(int syllable) const {
+	if ((syllable < 0) || (syllable >= (int)m_syllables.size())) {
+		return -1;
+	}
+	return m_wordSpines[m_syllableWords[syllable]];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getSyllableWord -- Return the word containing a syllable.
+//
+
+int HumTextTable::getSyllableWord(int syllable) const {
+	if ((syllable < 0) || (syllable >= (int)m_syllables.size())) {
+		return -1;
+	}
+	return m_syllableWords[syllable];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getNoteCount -- Return the number of notes attacked
+//     on a syllable (its melisma length).
+//
+
+int HumTextTable::getNoteCount(int syllable) const {
+	if ((syllable < 0) || (syllable >= (int)m_syllables.size())) {
+		return 0;
+	}
+	return m_noteCounts[syllable];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getFirstNote -- Return the **kern token on the line of a
+//     syllable (which may be a null token), or NULL if there is no **kern
+//     spine for the syllable.
+//
+
+HTp HumTextTable::getFirstNote(int syllable) const {
+	if ((syllable < 0) || (syllable >= (int)m_syllables.size())) {
+		return NULL;
+	}
+	return m_firstNotes[syllable];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getLastNote -- Return the last note (or tied note)
+//     sung on a syllable, or NULL if there are no notes.
+//
+
+HTp HumTextTable::getLastNote(int syllable) const {
+	if ((syllable < 0) || (syllable >= (int)m_syllables.size())) {
+		return NULL;
+	}
+	return m_lastNotes[syllable];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getEndTime -- Return the end of the last note sung on a
+//     syllable in quarter notes from the start of the file (the start of
+//     the syllable if there are no notes).
+//
+
+HumNum HumTextTable::getEndTime(int syllable) const {
+	if ((syllable < 0) || (syllable >= (int)m_syllables.size())) {
+		return 0;
+	}
+	return m_endTimes[syllable];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getWordCount -- Return the number of words in all spines.
+//
+
+int HumTextTable::getWordCount(void) const {
+	return (int)m_words.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getWordText -- Return the syllables of a word joined
+//     without their hyphens.
+//
+
+const string& HumTextTable::getWordText(int word) const {
+	static const string empty;
+	if ((word < 0) || (word >= (int)m_words.size())) {
+		return empty;
+	}
+	return m_words[word];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getNormalizedWord -- Return the normalized form of a word
+//     (see normalize()).
+//
+
+const string& HumTextTable::getNormalizedWord(int word) const {
+	static const string empty;
+	if ((word < 0) || (word >= (int)m_normalized.size())) {
+		return empty;
+	}
+	return m_normalized[word];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getWordToken -- Return the token of the first syllable
+//     of a word.
+//
+
+HTp HumTextTable::getWordToken(int word) const {
+	if ((word < 0) || (word >= (int)m_words.size())) {
+		return NULL;
+	}
+	return m_syllables[m_wordSyllables[word]];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getWordSpine -- Return the spine of a word.
+//
+
+int HumTextTable::getWordSpine(int word) const {
+	if ((word < 0) || (word >= (int)m_words.size())) {
+		return -1;
+	}
+	return m_wordSpines[word];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getWordSyllableStart -- Return the first syllable of a
+//     word.
+//
+
+int HumTextTable::getWordSyllableStart(int word) const {
+	if ((word < 0) || (word >= (int)m_words.size())) {
+		return -1;
+	}
+	return m_wordSyllables[word];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getWordSyllableCount -- Return the number of syllables
+//     in a word.
+//
+
+int HumTextTable::getWordSyllableCount(int word) const {
+	if ((word < 0) || (word >= (int)m_words.size())) {
+		return 0;
+	}
+	if (word == (int)m_words.size() - 1) {
+		return (int)m_syllables.size() - m_wordSyllables[word];
+	}
+	return m_wordSyllables[word + 1] - m_wordSyllables[word];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getWordNoteCount -- Return the number of notes attacked
+//     on all syllables of a word.
+//
+
+int HumTextTable::getWordNoteCount(int word) const {
+	if ((word < 0) || (word >= (int)m_words.size())) {
+		return 0;
+	}
+	return m_wordNotes[word];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::normalize -- Return the form of a word used for searching:
+//     ASCII letters are lowercased, punctuation is removed (except for
+//     apostrophes), and spaces are reduced to single spaces between words.
+//     UTF-8 characters are not changed.
+//
+
+string HumTextTable::normalize(const string& text) {
+	string output;
+	output.reserve(text.size());
+	bool space = false;
+	for (int i=0; i<(int)text.size(); i++) {
+		unsigned char ch = (unsigned char)text[i];
+		if (isspace(ch)) {
+			space = !output.empty();
+			continue;
+		}
+		if ((ch < 0x80) && !isalnum(ch) && (ch != '\'')) {
+			continue;
+		}
+		if (space) {
+			output += ' ';
+			space = false;
+		}
+		output += (char)tolower(ch);
+	}
+	return output;
+}
+
+
+
+
+
+//////////////////////////////
+//
+// HumTokenLinks::HumTokenLinks -- Constructor.
+//
+
+HumTokenLinks::HumTokenLinks(void) {
+	m_single   = NULL;
+	m_size     = 0;
+	m_capacity = 1;
+}
+
+
+HumTokenLinks::HumTokenLinks(const HumTokenLinks& links) {
+	m_single   = NULL;
+	m_size     = 0;
+	m_capacity = 1;
+	*this = links;
+}
+
+
+
+//////////////////////////////
+//
+// HumTokenLinks::~HumTokenLinks -- Deconstructor.
+//
+
+HumTokenLinks::~HumTokenLinks() {
+	if (m_capacity > 1) {
+		delete [] m_list;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumTokenLinks::operator= -- Copy the links of another list.
+//
+
+HumTokenLinks& HumTokenLinks::operator=(const HumTokenLinks& links) {
+	if (this == &links) {
+		return *this;
+	}
+	reserve(links.m_size);
+	const HTp* source = links.data();
+	HTp* target = data();
+	for (int i=0; i<links.m_size; i++) {
+		target[i] = source[i];
+	}
+	m_size = links.m_size;
+	return *this;
+}
+
+
+
+//////////////////////////////
+//
+// HumTokenLinks::resize -- Change the number of links in the list.  New
+//     links are set to NULL.
+//
+
+void HumTokenLinks::resize(int newsize) {
+	if (newsize < 0) {
+		newsize = 0;
+	}
+	reserve(newsize);
+	HTp* target = data();
+	for (int i=m_size; i<newsize; i++) {
+		target[i] = NULL;
+	}
+	m_size = newsize;
+}
+
+
+
+//////////////////////////////
+//
+// HumTokenLinks::push_back -- Add a link to the end of the list.
+//
+
+void HumTokenLinks::push_back(HTp token) {
+	if (m_size >= m_capacity) {
+		reserve(m_capacity * 2);
+	}
+	data()[m_size++] = token;
+}
+
+
+
+//////////////////////////////
+//
+// HumTokenLinks::toVector -- Return a copy of the links as a vector.
+//
+
+vector<HTp> HumTokenLinks::toVector(void) const {
+	const HTp* source = data();
+	return vector<HTp>(source, source + m_size);
+}
+
+
+
+//////////////////////////////
+//
+// HumTokenLinks::reserve -- Make sure that there is storage for at least
+//     the given number of links.
+//
+
+void HumTokenLinks::reserve(int capacity) {
+	if (capacity <= m_capacity) {
+		return;
+	}
+	HTp* newlist = new HTp[capacity];
+	const HTp* source = data();
+	for (int i=0; i<m_size; i++) {
+		newlist[i] = source[i];
+	}
+	if (m_capacity > 1) {
+		delete [] m_list;
+	}
+	m_list = newlist;
+	m_capacity = capacity;
+}
+
+
+
+
 //////////////////////////////
 //
 // HumTool::HumTool --
@@ -17507,7 +22923,10 @@ HumTool::HumTool(void) {
 //
 
 HumTool::~HumTool() {
-	// do nothing
+	// Don't flush the sinks, since they may have been deleted already.
+	m_humdrum_text.std::ios::rdbuf(m_humdrum_text.rdbuf());
+	m_json_text.std::ios::rdbuf(m_json_text.rdbuf());
+	m_free_text.std::ios::rdbuf(m_free_text.rdbuf());
 }
 
 
@@ -17522,9 +22941,7 @@ bool HumTool::hasAnyText(void) {
 	if (m_suppress) {
 		return true;
 	}
-	return ((!m_humdrum_text.str().empty())
-			|| (!m_free_text.str().empty())
-			|| (!m_json_text.str().empty()));
+	return hasHumdrumText() || hasJsonText() || hasFreeText();
 }
 
 
@@ -17546,9 +22963,9 @@ string HumTool::getAllText(void) {
 //
 
 ostream& HumTool::getAllText(ostream& out) {
-	out << m_humdrum_text.str();
-	out << m_json_text.str();
-	out << m_free_text.str();
+	printStreamText(out, m_humdrum_text);
+	printStreamText(out, m_json_text);
+	printStreamText(out, m_free_text);
 	return out;
 }
 
@@ -17572,7 +22989,10 @@ void HumTool::suppressHumdrumFileOutput(void) {
 //
 
 bool HumTool::hasHumdrumText(void) {
-	return m_humdrum_text.str().empty() ? false : true;
+	if (m_humdrum_sink) {
+		return hasSinkText(m_humdrum_sink, m_humdrum_sink_start);
+	}
+	return hasStreamText(m_humdrum_text);
 }
 
 
@@ -17592,7 +23012,7 @@ string HumTool::getHumdrumText(void) {
 //
 
 ostream& HumTool::getHumdrumText(ostream& out) {
-	out << m_humdrum_text.str();
+	printStreamText(out, m_humdrum_text);
 	return out;
 }
 
@@ -17604,7 +23024,10 @@ ostream& HumTool::getHumdrumText(ostream& out) {
 //
 
 bool HumTool::hasFreeText(void) {
-	return m_free_text.str().empty() ? false : true;
+	if (m_free_sink) {
+		return hasSinkText(m_free_sink, m_free_sink_start);
+	}
+	return hasStreamText(m_free_text);
 }
 
 
@@ -17624,7 +23047,7 @@ string HumTool::getFreeText(void) {
 //
 
 ostream& HumTool::getFreeText(ostream& out) {
-	out << m_free_text.str();
+	printStreamText(out, m_free_text);
 	return out;
 }
 
@@ -17636,7 +23059,10 @@ ostream& HumTool::getFreeText(ostream& out) {
 //
 
 bool HumTool::hasJsonText(void) {
-	return m_json_text.str().empty() ? false : true;
+	if (m_json_sink) {
+		return hasSinkText(m_json_sink, m_json_sink_start);
+	}
+	return hasStreamText(m_json_text);
 }
 
 
@@ -17656,7 +23082,7 @@ string HumTool::getJsonText(void) {
 //
 
 ostream& HumTool::getJsonText(ostream& out) {
-	out << m_json_text.str();
+	printStreamText(out, m_json_text);
 	return out;
 }
 
@@ -17745,6 +23171,15 @@ void HumTool::clearOutput(void) {
 	m_free_text.str("");
   	m_warning_text.str("");
   	m_error_text.str("");
+	if (m_humdrum_sink) {
+		m_humdrum_sink_start = m_humdrum_sink->getByteCount();
+	}
+	if (m_json_sink) {
+		m_json_sink_start = m_json_sink->getByteCount();
+	}
+	if (m_free_sink) {
+		m_free_sink_start = m_free_sink->getByteCount();
+	}
 }
 
 
@@ -17760,6 +23195,1008 @@ void HumTool::setError(const string& message) {
 
 
 
+//////////////////////////////
+//
+// HumTool::setOutputSink -- Send the Humdrum, JSON and free text output
+//     of the tool directly to the given sink rather than storing it in
+//     the tool.  Text already stored in the tool is not moved to the
+//     sink.  The get*Text() functions return nothing for output that
+//     was sent to a sink, but the has*Text() functions still report
+//     whether there was any output (which is needed to decide whether
+//     to print the input file instead).  If one sink is used for several
+//     types of output, the has*Text() functions cannot tell them apart.
+//     Use NULL to store the output in the tool again.
+//
+
+void HumTool::setOutputSink(HumOutputSink* sink) {
+	setHumdrumSink(sink);
+	setJsonSink(sink);
+	setFreeTextSink(sink);
+}
+
+
+
+//////////////////////////////
+//
+// HumTool::setHumdrumSink -- Send only the Humdrum text output to the
+//     given sink.
+//
+
+void HumTool::setHumdrumSink(HumOutputSink* sink) {
+	attachSink(m_humdrum_text, sink, m_humdrum_sink, m_humdrum_sink_start);
+}
+
+
+
+//////////////////////////////
+//
+// HumTool::setJsonSink -- Send only the JSON text output to the given sink.
+//
+
+void HumTool::setJsonSink(HumOutputSink* sink) {
+	attachSink(m_json_text, sink, m_json_sink, m_json_sink_start);
+}
+
+
+
+//////////////////////////////
+//
+// HumTool::setFreeTextSink -- Send only the free text output to the
+//     given sink.
+//
+
+void HumTool::setFreeTextSink(HumOutputSink* sink) {
+	attachSink(m_free_text, sink, m_free_sink, m_free_sink_start);
+}
+
+
+
+//////////////////////////////
+//
+// HumTool::clearOutputSinks -- Flush and detach all output sinks.
+//
+
+void HumTool::clearOutputSinks(void) {
+	setOutputSink(NULL);
+}
+
+
+
+//////////////////////////////
+//
+// HumTool::attachSink -- Redirect an output stream to a sink, or back to
+//     its own string buffer if the sink is NULL.  The previous sink is
+//     flushed.
+//
+
+void HumTool::attachSink(stringstream& stream, HumOutputSink* sink,
+		HumOutputSink*& current, size_t& start) {
+	if (current) {
+		current->flush();
+	}
+	current = sink;
+	start = sink ? sink->getByteCount() : 0;
+	if (sink) {
+		stream.std::ios::rdbuf(sink);
+	} else {
+		// stringstream::rdbuf() returns the stream's own string buffer:
+		stream.std::ios::rdbuf(stream.rdbuf());
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumTool::hasSinkText -- Return true if anything has been written to
+//     the sink since the given byte count.
+//
+
+bool HumTool::hasSinkText(HumOutputSink* sink, size_t start) {
+	return sink->getByteCount() > start;
+}
+
+
+
+//////////////////////////////
+//
+// HumTool::hasStreamText -- Return true if the string buffer of the
+//     stream is not empty.  This avoids copying the contents with str().
+//
+
+bool HumTool::hasStreamText(stringstream& stream) {
+	return stream.rdbuf()->sgetc() != stringstream::traits_type::eof();
+}
+
+
+
+//////////////////////////////
+//
+// HumTool::printStreamText -- Print the contents of the string buffer
+//     of the stream without copying it into a temporary string.  The
+//     read position is rewound afterwards so that the text can be
+//     printed again.
+//
+
+void HumTool::printStreamText(ostream& out, stringstream& stream) {
+	if (!hasStreamText(stream)) {
+		return;
+	}
+	out << stream.rdbuf();
+	stream.rdbuf()->pubseekpos(0, std::ios::in);
+}
+
+
+
+
+
+
+//////////////////////////////
+//
+// HumServerTool -- Interface for a tool object that is run by the server.
+//     Most tools do not reset all of their member variables when they are
+//     run again, so a new tool object is made for each request unless the
+//     tool has been checked and marked as reusable in the registry (see
+//     getServerToolRegistry()).  Reusable tools are kept between requests.
+//
+
+class HumServerTool {
+	public:
+		virtual         ~HumServerTool () { }
+		virtual HumTool& getTool       (void) = 0;
+		virtual bool     run           (const string& input,
+		                                HumOutputSink& passthrough) = 0;
+
+		bool             isReusable    (void) { return m_reusable; }
+		void             setReusable   (bool state) { m_reusable = state; }
+
+	private:
+		bool m_reusable = false;
+};
+
+
+
+//////////////////////////////
+//
+// HumServerStreamTool -- Run a tool on each segment of the input in turn,
+//     in the same way as STREAM_INTERFACE.
+//
+
+template <class TOOL>
+class HumServerStreamTool : public HumServerTool {
+	public:
+		HumTool& getTool(void) { return m_tool; }
+
+		bool run(const string& input, HumOutputSink& passthrough) {
+			HumdrumFileStream instream(input);
+			HumdrumFileSet infiles;
+			bool status = true;
+			while (instream.readSingleSegment(infiles)) {
+				status &= (bool)m_tool.run(infiles);
+				for (int i=0; i<infiles.getCount(); i++) {
+					passthrough.writeFile(infiles[i]);
+				}
+			}
+			m_tool.finally();
+			return status;
+		}
+
+	private:
+		TOOL m_tool;
+};
+
+
+
+//////////////////////////////
+//
+// HumServerSetTool -- Run a tool on all segments of the input at once,
+//     for tools which compare files with each other.
+//
+
+template <class TOOL>
+class HumServerSetTool : public HumServerTool {
+	public:
+		HumTool& getTool(void) { return m_tool; }
+
+		bool run(const string& input, HumOutputSink& passthrough) {
+			HumdrumFileSet infiles;
+			infiles.readString(input);
+			bool status = (bool)m_tool.run(infiles);
+			m_tool.finally();
+			for (int i=0; i<infiles.getCount(); i++) {
+				passthrough.writeFile(infiles[i]);
+			}
+			return status;
+		}
+
+	private:
+		TOOL m_tool;
+};
+
+
+
+//////////////////////////////
+//
+// getServerToolRegistry -- Return the list of tools that the server can run,
+//     indexed by tool name.  Tools added with HUMSERVER_REUSABLE_TOOL are
+//     kept between requests with the same options, so they must set all of
+//     their member variables again each time that they are run, and must
+//     not collect data across segments in finally().  Check a tool before
+//     adding it that way.
+//
+
+static const map<string, std::function<HumServerTool*(void)>>& getServerToolRegistry(void) {
+	static const map<string, std::function<HumServerTool*(void)>> registry = {
+		#define HUMSERVER_TOOL(NAME, INTERFACE) \
+			{ #NAME, [](void) -> HumServerTool* { return new INTERFACE<Tool_##NAME>; } },
+		#define HUMSERVER_REUSABLE_TOOL(NAME, INTERFACE) \
+			{ #NAME, [](void) -> HumServerTool* { \
+				static_assert(std::is_same<decltype(&Tool_##NAME::finally), void (HumTool::*)(void)>::value, \
+						"Tools which override finally() cannot be reused"); \
+				HumServerTool* tool = new INTERFACE<Tool_##NAME>; \
+				tool->setReusable(true); \
+				return tool; \
+			} },
+		HUMSERVER_TOOL(1520ify, HumServerStreamTool)
+		HUMSERVER_TOOL(addic, HumServerStreamTool)
+		HUMSERVER_TOOL(addkey, HumServerStreamTool)
+		HUMSERVER_TOOL(addlabels, HumServerStreamTool)
+		HUMSERVER_TOOL(addtempo, HumServerStreamTool)
+		HUMSERVER_TOOL(autoaccid, HumServerStreamTool)
+		HUMSERVER_REUSABLE_TOOL(autobeam, HumServerStreamTool)
+		HUMSERVER_TOOL(autocadence, HumServerStreamTool)
+		HUMSERVER_TOOL(autostem, HumServerStreamTool)
+		HUMSERVER_TOOL(binroll, HumServerStreamTool)
+		HUMSERVER_TOOL(bstyle, HumServerStreamTool)
+		HUMSERVER_TOOL(chantize, HumServerStreamTool)
+		HUMSERVER_TOOL(chint, HumServerStreamTool)
+		HUMSERVER_TOOL(chord, HumServerStreamTool)
+		HUMSERVER_TOOL(cint, HumServerStreamTool)
+		HUMSERVER_TOOL(cmr, HumServerStreamTool)
+		HUMSERVER_TOOL(colorgroups, HumServerStreamTool)
+		HUMSERVER_TOOL(colortriads, HumServerStreamTool)
+		HUMSERVER_TOOL(composite, HumServerStreamTool)
+		HUMSERVER_TOOL(compositeold, HumServerStreamTool)
+		HUMSERVER_TOOL(deg, HumServerStreamTool)
+		HUMSERVER_TOOL(dissonant, HumServerStreamTool)
+		HUMSERVER_TOOL(double, HumServerStreamTool)
+		HUMSERVER_REUSABLE_TOOL(extract, HumServerStreamTool)
+		HUMSERVER_TOOL(fb, HumServerStreamTool)
+		HUMSERVER_REUSABLE_TOOL(filter, HumServerStreamTool)
+		HUMSERVER_TOOL(fixps, HumServerStreamTool)
+		HUMSERVER_TOOL(flipper, HumServerStreamTool)
+		HUMSERVER_TOOL(gasparize, HumServerStreamTool)
+		HUMSERVER_TOOL(grep, HumServerStreamTool)
+		HUMSERVER_TOOL(half, HumServerStreamTool)
+		HUMSERVER_TOOL(hands, HumServerStreamTool)
+		HUMSERVER_TOOL(homorhythm, HumServerStreamTool)
+		HUMSERVER_TOOL(homorhythm2, HumServerStreamTool)
+		HUMSERVER_TOOL(hproof, HumServerStreamTool)
+		HUMSERVER_TOOL(humbreak, HumServerStreamTool)
+		HUMSERVER_TOOL(humsheet, HumServerStreamTool)
+		HUMSERVER_TOOL(humsort, HumServerStreamTool)
+		HUMSERVER_TOOL(humtr, HumServerStreamTool)
+		HUMSERVER_TOOL(imitation, HumServerStreamTool)
+		HUMSERVER_TOOL(instinfo, HumServerStreamTool)
+		HUMSERVER_TOOL(kern2mens, HumServerStreamTool)
+		HUMSERVER_TOOL(kernify, HumServerStreamTool)
+		HUMSERVER_TOOL(kernview, HumServerStreamTool)
+		HUMSERVER_TOOL(melisma, HumServerStreamTool)
+		HUMSERVER_TOOL(mens2kern, HumServerStreamTool)
+		HUMSERVER_TOOL(meter, HumServerStreamTool)
+		HUMSERVER_REUSABLE_TOOL(metlev, HumServerStreamTool)
+		HUMSERVER_TOOL(modori, HumServerStreamTool)
+		HUMSERVER_TOOL(msearch, HumServerStreamTool)
+		HUMSERVER_TOOL(myank, HumServerStreamTool)
+		HUMSERVER_TOOL(nproof, HumServerStreamTool)
+		HUMSERVER_TOOL(ordergps, HumServerStreamTool)
+		HUMSERVER_TOOL(pbar, HumServerStreamTool)
+		HUMSERVER_TOOL(pccount, HumServerStreamTool)
+		HUMSERVER_TOOL(periodicity, HumServerStreamTool)
+		HUMSERVER_TOOL(phrase, HumServerStreamTool)
+		HUMSERVER_TOOL(pline, HumServerStreamTool)
+		HUMSERVER_TOOL(pnum, HumServerStreamTool)
+		HUMSERVER_TOOL(prange, HumServerStreamTool)
+		HUMSERVER_REUSABLE_TOOL(recip, HumServerStreamTool)
+		HUMSERVER_TOOL(restfill, HumServerStreamTool)
+		HUMSERVER_TOOL(rid, HumServerStreamTool)
+		HUMSERVER_TOOL(rphrase, HumServerStreamTool)
+		HUMSERVER_TOOL(sab2gs, HumServerStreamTool)
+		HUMSERVER_TOOL(satb2gs, HumServerStreamTool)
+		HUMSERVER_TOOL(scordatura, HumServerStreamTool)
+		HUMSERVER_REUSABLE_TOOL(semitones, HumServerStreamTool)
+		HUMSERVER_TOOL(shed, HumServerStreamTool)
+		HUMSERVER_TOOL(sic, HumServerStreamTool)
+		HUMSERVER_TOOL(simat, HumServerStreamTool)
+		HUMSERVER_TOOL(slurcheck, HumServerStreamTool)
+		HUMSERVER_TOOL(spinetrace, HumServerStreamTool)
+		HUMSERVER_TOOL(strophe, HumServerStreamTool)
+		HUMSERVER_TOOL(synco, HumServerStreamTool)
+		HUMSERVER_TOOL(tabber, HumServerStreamTool)
+		HUMSERVER_TOOL(tandeminfo, HumServerStreamTool)
+		HUMSERVER_TOOL(tassoize, HumServerStreamTool)
+		HUMSERVER_TOOL(textdur, HumServerStreamTool)
+		HUMSERVER_REUSABLE_TOOL(thru, HumServerStreamTool)
+		HUMSERVER_TOOL(tie, HumServerStreamTool)
+		HUMSERVER_TOOL(timebase, HumServerStreamTool)
+		HUMSERVER_REUSABLE_TOOL(transpose, HumServerStreamTool)
+		HUMSERVER_TOOL(tremolo, HumServerStreamTool)
+		HUMSERVER_TOOL(trillspell, HumServerStreamTool)
+		HUMSERVER_TOOL(tspos, HumServerStreamTool)
+		HUMSERVER_TOOL(vcross, HumServerStreamTool)
+		HUMSERVER_TOOL(chooser, HumServerSetTool)
+		HUMSERVER_TOOL(humdiff, HumServerSetTool)
+		#undef HUMSERVER_TOOL
+		#undef HUMSERVER_REUSABLE_TOOL
+	};
+	return registry;
+}
+
+
+
+//////////////////////////////
+//
+// getServerTool -- Return a tool object which has been prepared with the
+//     given options.  Reusable tools are kept in a per-thread cache indexed
+//     by the command, so repeated requests with the same options do not
+//     need to construct the tool and parse the options again.  Other tools
+//     are made new for each request.
+//
+
+static map<string, std::shared_ptr<HumServerTool>>& getServerToolCache(void) {
+	static thread_local map<string, std::shared_ptr<HumServerTool>> cache;
+	return cache;
+}
+
+
+static string getServerToolCommand(const string& name, const string& options) {
+	string command = name;
+	if (!options.empty()) {
+		command += " ";
+		command += options;
+	}
+	return command;
+}
+
+
+static std::shared_ptr<HumServerTool> getServerTool(const string& name,
+		const string& options, string& error) {
+	auto& cache = getServerToolCache();
+	// Maximum number of prepared tools to keep in each thread:
+	const int maxCacheSize = 32;
+
+	string command = getServerToolCommand(name, options);
+
+	auto found = cache.find(command);
+	if (found != cache.end()) {
+		return found->second;
+	}
+
+	auto entry = getServerToolRegistry().find(name);
+	if (entry == getServerToolRegistry().end()) {
+		error = "Unknown tool: " + name + "\n";
+		return NULL;
+	}
+
+	std::shared_ptr<HumServerTool> tool(entry->second());
+	HumTool& interface = tool->getTool();
+	interface.setExitOnError(false);
+	if (!interface.process(command)) {
+		error = interface.getParseError();
+		if (error.empty()) {
+			error = "Error processing options for " + name + "\n";
+		} else if (error.back() != '\n') {
+			error += "\n";
+		}
+		return NULL;
+	}
+
+	if (tool->isReusable()) {
+		if ((int)cache.size() >= maxCacheSize) {
+			cache.clear();
+		}
+		cache[command] = tool;
+	}
+	return tool;
+}
+
+
+
+//////////////////////////////
+//
+// HumToolConnection -- Shared state for the requests read from a single
+//     input stream: responses are written one at a time to the output
+//     stream, and the connection stays open until all of its requests
+//     have been answered.
+//
+
+class HumToolConnection {
+	public:
+		HumToolConnection(ostream& output) : m_output(output) { }
+
+		void addRequest(void) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_pending++;
+		}
+
+		void sendResponse(const HumToolResponse& response, bool finished) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			try {
+				HumToolServer::writeResponse(m_output, response);
+				m_output.flush();
+			} catch (...) {
+				// The output stream has failed, so the response is lost, but
+				// the request still has to be counted as finished.
+			}
+			if (finished) {
+				m_pending--;
+				m_done.notify_all();
+			}
+		}
+
+		void wait(void) {
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_done.wait(lock, [this](void) { return m_pending == 0; });
+		}
+
+	private:
+		ostream&                m_output;
+		std::mutex              m_mutex;
+		std::condition_variable m_done;
+		int                     m_pending = 0;
+};
+
+
+
+//////////////////////////////
+//
+// HumToolServer::HumToolServer -- Constructor.  The default thread count
+//     of 0 uses one worker thread for each processor core.
+//
+
+HumToolServer::HumToolServer(void) {
+	// do nothing
+}
+
+
+HumToolServer::HumToolServer(int threads) {
+	setThreadCount(threads);
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::~HumToolServer -- Deconstructor.  Wait for the worker
+//     threads to finish their current jobs.
+//
+
+HumToolServer::~HumToolServer() {
+	stopWorkers();
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::setThreadCount -- Set the number of worker threads.  Use
+//     0 for one thread per processor core.  The workers are (re)started
+//     when the next stream is served.
+//
+
+void HumToolServer::setThreadCount(int threads) {
+	if (threads < 0) {
+		threads = 0;
+	}
+	if (threads != m_threadCount) {
+		stopWorkers();
+		m_threadCount = threads;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::getThreadCount -- Return the number of worker threads
+//     which will be used to process requests.
+//
+
+int HumToolServer::getThreadCount(void) {
+	if (m_threadCount > 0) {
+		return m_threadCount;
+	}
+	int cores = (int)std::thread::hardware_concurrency();
+	return cores > 0 ? cores : 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::setQueueSize -- Set the maximum number of requests which
+//     can wait for a worker thread.  When the queue is full, serve() stops
+//     reading requests until a worker takes the next one.  Use 0 for four
+//     requests per worker thread.
+//
+
+void HumToolServer::setQueueSize(int size) {
+	if (size < 0) {
+		size = 0;
+	}
+	m_queueSize = size;
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::getQueueSize -- Return the maximum number of requests
+//     which can wait for a worker thread.
+//
+
+int HumToolServer::getQueueSize(void) {
+	if (m_queueSize > 0) {
+		return m_queueSize;
+	}
+	return 4 * getThreadCount();
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::hasTool -- Return true if the server can run the given tool.
+//
+
+bool HumToolServer::hasTool(const string& name) {
+	const auto& registry = getServerToolRegistry();
+	return registry.find(name) != registry.end();
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::getToolNames -- Return a sorted list of the tools which
+//     the server can run.
+//
+
+vector<string> HumToolServer::getToolNames(void) {
+	vector<string> output;
+	for (const auto& entry : getServerToolRegistry()) {
+		output.push_back(entry.first);
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::run -- Process a single request in the current thread.
+//     Returns false if the tool could not be run or reported an error.
+//
+
+bool HumToolServer::run(const HumToolRequest& request, HumToolResponse& response) {
+	response = HumToolResponse();
+	response.id = request.id;
+
+	string error;
+	std::shared_ptr<HumServerTool> tool = getServerTool(request.tool, request.options, error);
+	if (!tool) {
+		response.status = false;
+		response.error = error;
+		return false;
+	}
+
+	// The output of the tool is written directly into the response:
+	HumTool& interface = tool->getTool();
+	HumStringSink humdrumSink(response.humdrum);
+	HumStringSink jsonSink(response.json);
+	HumStringSink textSink(response.text);
+	interface.setHumdrumSink(&humdrumSink);
+	interface.setJsonSink(&jsonSink);
+	interface.setFreeTextSink(&textSink);
+	interface.clearOutput();
+
+	string passthrough;
+	HumStringSink passthroughSink(passthrough);
+	bool status = false;
+	string exception;
+	try {
+		status = tool->run(request.input, passthroughSink);
+	} catch (const std::exception& e) {
+		exception = e.what();
+	} catch (...) {
+		exception = "unknown exception";
+	}
+	bool hasText = interface.hasAnyText();
+	interface.clearOutputSinks();
+
+	if (!exception.empty()) {
+		// The tool may have been left in an inconsistent state, so do not
+		// use it for another request.
+		getServerToolCache().erase(getServerToolCommand(request.tool, request.options));
+		interface.clearOutput();
+		response.humdrum.clear();
+		response.json.clear();
+		response.text.clear();
+		response.status = false;
+		response.error = "Error running " + request.tool + ": " + exception + "\n";
+		return false;
+	}
+
+	if (!hasText && !interface.hasError()) {
+		response.humdrum.swap(passthrough);
+	}
+	response.warning = interface.getWarning();
+	response.error   = interface.getError();
+	response.status  = status && !interface.hasError();
+	interface.clearOutput();
+	return response.status;
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::serve -- Read requests from the input stream until it
+//     ends, and write a response for each one to the output stream.
+//     Requests are processed concurrently by the worker threads, so the
+//     responses can be in a different order than the requests.  Reading
+//     waits while the job queue is full (see setQueueSize()).  Returns
+//     false if the input contained a malformed request (in which case an
+//     error response is sent and no more requests are read).
+//
+
+bool HumToolServer::serve(istream& input, ostream& output) {
+	startWorkers();
+	HumToolConnection connection(output);
+	bool status = true;
+
+	while (true) {
+		auto request = std::make_shared<HumToolRequest>();
+		string error;
+		int state = readRequest(input, *request, error);
+		if (state == 0) {
+			break;
+		}
+		if (state < 0) {
+			HumToolResponse response;
+			response.id = request->id;
+			response.status = false;
+			response.error = error;
+			connection.sendResponse(response, false);
+			status = false;
+			break;
+		}
+		if (!hasTool(request->tool)) {
+			HumToolResponse response;
+			response.id = request->id;
+			response.status = false;
+			response.error = "Unknown tool: " + request->tool + "\n";
+			connection.sendResponse(response, false);
+			continue;
+		}
+		connection.addRequest();
+		addJob([this, request, &connection](void) {
+			HumToolResponse response;
+			try {
+				run(*request, response);
+			} catch (const std::exception& e) {
+				response = HumToolResponse();
+				response.id = request->id;
+				response.status = false;
+				response.error = "Error running " + request->tool + ": " + e.what() + "\n";
+			} catch (...) {
+				response = HumToolResponse();
+				response.id = request->id;
+				response.status = false;
+				response.error = "Error running " + request->tool + ": unknown exception\n";
+			}
+			connection.sendResponse(response, true);
+		});
+	}
+
+	connection.wait();
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// readFrameHeader -- Read "key: value" lines up to an empty line.  Empty
+//     lines before the header are skipped.  Returns 1 if a header was read,
+//     0 if the input ended before a header, or -1 if the header is invalid.
+//
+
+static int readFrameHeader(istream& input, map<string, string>& header,
+		string& error) {
+	header.clear();
+	string line;
+	bool started = false;
+	while (getline(input, line)) {
+		if (!line.empty() && line.back() == '\r') {
+			line.pop_back();
+		}
+		if (line.empty()) {
+			if (started) {
+				return 1;
+			}
+			continue;
+		}
+		started = true;
+		size_t colon = line.find(':');
+		if (colon == string::npos) {
+			error = "Invalid header line: " + line + "\n";
+			return -1;
+		}
+		string key = line.substr(0, colon);
+		size_t start = line.find_first_not_of(" \t", colon + 1);
+		header[key] = start == string::npos ? "" : line.substr(start);
+	}
+	if (started) {
+		error = "Input ended inside of a header\n";
+		return -1;
+	}
+	return 0;
+}
+
+
+
+//////////////////////////////
+//
+// readFrameSection -- Read a section of a frame whose size is given by
+//     a header entry.  Returns false if the size is not a number, if it is
+//     larger than maxFrameSectionSize, if there is not enough memory for
+//     the section, or if the input ends before the end of the section.
+//
+
+static bool readFrameSection(istream& input, const map<string, string>& header,
+		const string& key, string& section, string& error) {
+	// Largest section that will be read (256 MB):
+	const size_t maxFrameSectionSize = (size_t)256 * 1024 * 1024;
+
+	section.clear();
+	auto found = header.find(key);
+	if (found == header.end()) {
+		return true;
+	}
+	const string& value = found->second;
+	if (value.empty() || (value.find_first_not_of("0123456789") != string::npos)) {
+		error = "Invalid " + key + ": " + value + "\n";
+		return false;
+	}
+	size_t size = 0;
+	for (char ch : value) {
+		size = size * 10 + (ch - '0');
+		if (size > maxFrameSectionSize) {
+			error = "Invalid " + key + ": " + value + " (maximum is "
+					+ to_string(maxFrameSectionSize) + ")\n";
+			return false;
+		}
+	}
+	try {
+		section.resize(size);
+	} catch (const std::bad_alloc&) {
+		error = "Not enough memory for " + key + ": " + value + "\n";
+		return false;
+	}
+	if (size > 0) {
+		input.read(&section[0], size);
+		if ((size_t)input.gcount() != size) {
+			error = "Input ended inside of " + key + " section\n";
+			section.resize(input.gcount());
+			return false;
+		}
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::readRequest -- Read a request frame.  Returns 1 if a request
+//     was read, 0 at the end of the input, or -1 if the request is invalid
+//     (with a description of the problem in error).
+//
+
+int HumToolServer::readRequest(istream& input, HumToolRequest& request,
+		string& error) {
+	request = HumToolRequest();
+	map<string, string> header;
+	int state = readFrameHeader(input, header, error);
+	if (state <= 0) {
+		return state;
+	}
+	request.id      = header["id"];
+	request.tool    = header["tool"];
+	request.options = header["options"];
+	if (!readFrameSection(input, header, "length", request.input, error)) {
+		return -1;
+	}
+	if (request.tool.empty()) {
+		error = "Missing tool in request\n";
+		return -1;
+	}
+	return 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::writeRequest -- Write a request frame.
+//
+
+ostream& HumToolServer::writeRequest(ostream& output,
+		const HumToolRequest& request) {
+	if (!request.id.empty()) {
+		output << "id: " << request.id << "\n";
+	}
+	output << "tool: " << request.tool << "\n";
+	if (!request.options.empty()) {
+		output << "options: " << request.options << "\n";
+	}
+	output << "length: " << request.input.size() << "\n";
+	output << "\n";
+	output << request.input;
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::readResponse -- Read a response frame.  Returns 1 if a
+//     response was read, 0 at the end of the input, or -1 if the response
+//     is invalid.
+//
+
+int HumToolServer::readResponse(istream& input, HumToolResponse& response,
+		string& error) {
+	response = HumToolResponse();
+	map<string, string> header;
+	int state = readFrameHeader(input, header, error);
+	if (state <= 0) {
+		return state;
+	}
+	response.id = header["id"];
+	response.status = header["status"] == "ok";
+	if (!readFrameSection(input, header, "humdrum-length", response.humdrum, error)) {
+		return -1;
+	}
+	if (!readFrameSection(input, header, "json-length", response.json, error)) {
+		return -1;
+	}
+	if (!readFrameSection(input, header, "text-length", response.text, error)) {
+		return -1;
+	}
+	if (!readFrameSection(input, header, "warning-length", response.warning, error)) {
+		return -1;
+	}
+	if (!readFrameSection(input, header, "error-length", response.error, error)) {
+		return -1;
+	}
+	return 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::writeResponse -- Write a response frame.
+//
+
+ostream& HumToolServer::writeResponse(ostream& output,
+		const HumToolResponse& response) {
+	if (!response.id.empty()) {
+		output << "id: " << response.id << "\n";
+	}
+	output << "status: " << (response.status ? "ok" : "error") << "\n";
+	output << "humdrum-length: " << response.humdrum.size() << "\n";
+	output << "json-length: "    << response.json.size()    << "\n";
+	output << "text-length: "    << response.text.size()    << "\n";
+	output << "warning-length: " << response.warning.size() << "\n";
+	output << "error-length: "   << response.error.size()   << "\n";
+	output << "\n";
+	output << response.humdrum;
+	output << response.json;
+	output << response.text;
+	output << response.warning;
+	output << response.error;
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::startWorkers -- Start the worker threads if they are not
+//     already running.
+//
+
+void HumToolServer::startWorkers(void) {
+	std::lock_guard<std::mutex> lock(m_jobMutex);
+	if (!m_workers.empty()) {
+		return;
+	}
+	m_stopQ = false;
+	int count = getThreadCount();
+	for (int i=0; i<count; i++) {
+		m_workers.emplace_back(&HumToolServer::workerLoop, this);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::stopWorkers -- Finish the queued jobs and then stop the
+//     worker threads.
+//
+
+void HumToolServer::stopWorkers(void) {
+	{
+		std::lock_guard<std::mutex> lock(m_jobMutex);
+		if (m_workers.empty()) {
+			return;
+		}
+		m_stopQ = true;
+	}
+	m_jobSignal.notify_all();
+	for (auto& worker : m_workers) {
+		worker.join();
+	}
+	m_workers.clear();
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::addJob -- Add a job to the queue for the worker threads.
+//     If the queue is full, wait until a worker takes a job from it.
+//
+
+void HumToolServer::addJob(std::function<void(void)> job) {
+	int limit = getQueueSize();
+	{
+		std::unique_lock<std::mutex> lock(m_jobMutex);
+		m_queueSignal.wait(lock, [this, limit](void) { return (int)m_jobs.size() < limit; });
+		m_jobs.push_back(std::move(job));
+	}
+	m_jobSignal.notify_one();
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::workerLoop -- Process jobs from the queue until the
+//     workers are stopped and the queue is empty.
+//
+
+void HumToolServer::workerLoop(void) {
+	while (true) {
+		std::function<void(void)> job;
+		{
+			std::unique_lock<std::mutex> lock(m_jobMutex);
+			m_jobSignal.wait(lock, [this](void) { return m_stopQ || !m_jobs.empty(); });
+			if (m_jobs.empty()) {
+				return;
+			}
+			job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+		}
+		m_queueSignal.notify_one();
+		job();
+	}
+}
+
 
 
 
@@ -18073,6 +24510,191 @@ void HumTransposer::transpose(HumPitch &pitch, const string &transString) {
 
 
 
+//////////////////////////////
+//
+// HumTransposer::prepareKernTable -- Calculate the transposed **kern pitch
+//    for each integer pitch in the octave range 0 to 9 at the stored
+//    transposition interval.  Pitches that would be transposed outside of
+//    that range are left empty in the table.  This function is called
+//    automatically by the table-based functions when the interval or base
+//    has changed since the last time the table was created.
+//
+
+void HumTransposer::prepareKernTable(void) {
+	int size = 10 * m_base;
+	m_kernTable.resize(size);
+	for (int i=0; i<size; i++) {
+		m_kernTable[i].clear();
+		int target = i + m_transpose;
+		if ((target < 0) || (target >= size)) {
+			continue;
+		}
+		m_kernTable[i] = integerPitchToHumPitch(target).getKernPitch();
+	}
+	m_kernTableBase      = m_base;
+	m_kernTableTranspose = m_transpose;
+}
+
+
+
+//////////////////////////////
+//
+// HumTransposer::getKernTablePitch -- Return the transposed **kern pitch
+//    for the given integer pitch in the current base, or an empty string if
+//    the pitch is not in the table.
+//
+
+const string& HumTransposer::getKernTablePitch(int ipitch) {
+	static const string empty;
+	if ((m_kernTableBase != m_base) || (m_kernTableTranspose != m_transpose)) {
+		prepareKernTable();
+	}
+	if ((ipitch < 0) || (ipitch >= (int)m_kernTable.size())) {
+		return empty;
+	}
+	return m_kernTable[ipitch];
+}
+
+
+
+//////////////////////////////
+//
+// HumTransposer::transposeKernToken -- Transpose the pitches of a **kern
+//    token (including all notes in a chord) at the stored transposition
+//    interval.  The token is modified in place, so no new strings are
+//    created for pitches that are found in the transposition table.  Null
+//    tokens, unpitched notes (R) and rhythm-only tokens are not changed, and
+//    only the vertical position of rests is transposed (without accidentals).
+//    Returns false if any subtoken contained an uninterpretable pitch
+//    (which is left unchanged).
+//
+
+bool HumTransposer::transposeKernToken(string &token) {
+	if ((m_kernTableBase != m_base) || (m_kernTableTranspose != m_transpose)) {
+		prepareKernTable();
+	}
+	bool status = true;
+	size_t start = 0;
+	while (start <= token.size()) {
+		size_t end = token.find(' ', start);
+		if (end == string::npos) {
+			end = token.size();
+		}
+		size_t oldsize = token.size();
+		status &= transposeKernSubtoken(token, start, end);
+		start = end + token.size() - oldsize + 1;
+	}
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// HumTransposer::transposeKernSubtoken -- Transpose the pitch in a single
+//    note or rest of a **kern token between the given string indexes.
+//
+
+bool HumTransposer::transposeKernSubtoken(string &token, size_t start, size_t end) {
+	if ((end == start + 1) && (token[start] == '.')) {
+		return true;
+	}
+
+	bool rest = false;
+	size_t pstart = string::npos;
+	for (size_t i=start; i<end; i++) {
+		char ch = token[i];
+		if (ch == 'R') {
+			// Don't transpose unpitched notes (percussion parts).
+			return true;
+		} else if (ch == 'r') {
+			rest = true;
+		} else if ((pstart == string::npos) && (strchr("ABCDEFGabcdefg", ch) != NULL)) {
+			pstart = i;
+		}
+	}
+	if (pstart == string::npos) {
+		// no pitch (such as an invisible rest containing only a rhythm).
+		return true;
+	}
+
+	// The pitch is extracted from the letters and accidentals in the pitch
+	// portion of a rest, or from the entire note otherwise.
+	size_t pend = pstart;
+	size_t istart = start;
+	size_t iend = end;
+	if (rest) {
+		while ((pend < end) && (strchr("ABCDEFGabcdefg", token[pend]) != NULL)) {
+			pend++;
+		}
+		while ((pend < end) && (strchr("#n-", token[pend]) != NULL)) {
+			pend++;
+		}
+		istart = pstart;
+		iend = pend;
+	} else {
+		pstart = start;
+		while ((pstart < end) && (strchr("ABCDEFGabcdefg#n-", token[pstart]) == NULL)) {
+			pstart++;
+		}
+		pend = pstart;
+		while ((pend < end) && (strchr("ABCDEFGabcdefg#n-", token[pend]) != NULL)) {
+			pend++;
+		}
+	}
+
+	int uc = 0;
+	int lc = 0;
+	int accid = 0;
+	int dpc = -1;
+	for (size_t i=istart; i<iend; i++) {
+		char ch = token[i];
+		if (ch == '#') {
+			accid++;
+		} else if (ch == '-') {
+			accid--;
+		} else if (('A' <= ch) && (ch <= 'G')) {
+			uc++;
+		} else if (('a' <= ch) && (ch <= 'g')) {
+			lc++;
+		} else {
+			continue;
+		}
+		if ((dpc < 0) && isalpha(ch)) {
+			dpc = (tolower(ch) - 'a' + 5) % 7;
+		}
+	}
+	if ((dpc < 0) || ((uc > 0) && (lc > 0))) {
+		return false;
+	}
+	int octave = uc > 0 ? 4 - uc : 3 + lc;
+	int ipitch = octave * m_base + m_diatonicMapping[dpc] + accid;
+
+	const string* newpitch = &getKernTablePitch(ipitch);
+	string fallback;
+	if (newpitch->empty()) {
+		if ((ipitch < 0) || (ipitch + m_transpose < 0)) {
+			return false;
+		}
+		fallback = integerPitchToHumPitch(ipitch + m_transpose).getKernPitch();
+		newpitch = &fallback;
+	}
+
+	if (rest) {
+		// Transpose pitch portion of rest (indicating vertical position).
+		size_t length = newpitch->find_first_of("#-");
+		if (length == string::npos) {
+			length = newpitch->size();
+		}
+		token.replace(pstart, pend - pstart, *newpitch, 0, length);
+	} else {
+		token.replace(pstart, pend - pstart, *newpitch);
+	}
+	return true;
+}
+
+
+
 //////////////////////////////
 //
 // HumTransposer::getBase -- Return the integer interval class representing an octave.
@@ -19701,6 +26323,9 @@ HumdrumFile::~HumdrumFile() {
 
 ostream& HumdrumFile::printXml(ostream& out, int level,
 		const string& indent) {
+	// Slur durations are included in the content information of tokens:
+	requireAnalysis(HumFileAnalysis::PASS_SLURS);
+
 	out << Convert::repeatString(indent, level) << "<sequence>\n";
 	level++;
 
@@ -20375,7 +27000,7 @@ void HumdrumFileBase::clear(void) {
 //
 
 bool HumdrumFileBase::isStructureAnalyzed(void) {
-	return m_analyses.m_structure_analyzed;
+	return m_analyses.isDone(HumFileAnalysis::PASS_STRUCTURE);
 }
 
 
@@ -20386,7 +27011,7 @@ bool HumdrumFileBase::isStructureAnalyzed(void) {
 //
 
 bool HumdrumFileBase::isRhythmAnalyzed(void) {
-	return m_analyses.m_rhythm_analyzed;
+	return m_analyses.isDone(HumFileAnalysis::PASS_RHYTHM);
 }
 
 
@@ -20397,7 +27022,7 @@ bool HumdrumFileBase::isRhythmAnalyzed(void) {
 //
 
 bool HumdrumFileBase::areStrandsAnalyzed(void) {
-	return m_analyses.m_strands_analyzed;
+	return m_analyses.isDone(HumFileAnalysis::PASS_STRANDS);
 }
 
 
@@ -20408,7 +27033,96 @@ bool HumdrumFileBase::areStrandsAnalyzed(void) {
 //
 
 bool HumdrumFileBase::areStrophesAnalyzed(void) {
-	return m_analyses.m_strophes_analyzed;
+	return m_analyses.isDone(HumFileAnalysis::PASS_STROPHES);
+}
+
+
+
+//////////////////////////////
+//
+// HumFileAnalysis::getDependencies -- Return a bitmask of the analysis
+//     passes which must be run before the given pass.
+//
+
+unsigned int HumFileAnalysis::getDependencies(Pass pass) {
+	switch (pass) {
+		case PASS_STRANDS:
+			return 0;
+		case PASS_NULLS:
+		case PASS_STROPHES:
+		case PASS_STRUCTURE:
+			return (1u << PASS_STRANDS);
+		case PASS_RHYTHM:
+		case PASS_TOKEN_INDEX:
+		case PASS_OTTAVAS:
+		case PASS_BARLINES:
+		case PASS_MEASURES:
+			return (1u << PASS_STRUCTURE);
+		case PASS_KERN_ACCIDENTALS:
+		case PASS_MENS_ACCIDENTALS:
+			return (1u << PASS_TOKEN_INDEX) | (1u << PASS_OTTAVAS);
+		case PASS_SLURS:
+		case PASS_BEAMS:
+		case PASS_PHRASES:
+		case PASS_TIES:
+			return (1u << PASS_TOKEN_INDEX) | (1u << PASS_RHYTHM);
+		case PASS_METRIC_GRID:
+		case PASS_TEXT:
+			return (1u << PASS_RHYTHM);
+		case PASS_REST_POSITIONS:
+		case PASS_NULL_TABLE:
+			return (1u << PASS_TOKEN_INDEX);
+		case PASS_SONORITIES:
+			return (1u << PASS_NULL_TABLE);
+		case PASS_STRAND_TABLE:
+			return (1u << PASS_RHYTHM) | (1u << PASS_STROPHES);
+		case PASS_COUNT:
+			break;
+	}
+	return 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumFileAnalysis::invalidate -- Mark the given analysis pass and all
+//     passes which depend on it (directly or indirectly) as not run.
+//
+
+void HumFileAnalysis::invalidate(Pass pass) {
+	unsigned int invalid = (1u << pass);
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		for (int i=0; i<PASS_COUNT; i++) {
+			if (invalid & (1u << i)) {
+				continue;
+			}
+			if (getDependencies((Pass)i) & invalid) {
+				invalid |= (1u << i);
+				changed = true;
+			}
+		}
+	}
+	m_done &= ~invalid;
+	m_version++;
+}
+
+
+
+//////////////////////////////
+//
+// HumFileAnalysis::invalidateContent -- Mark all content passes (the
+//     passes from PASS_TOKEN_INDEX onwards) as not run.  The structure
+//     passes are kept.
+//
+
+void HumFileAnalysis::invalidateContent(void) {
+	for (int i=PASS_TOKEN_INDEX; i<PASS_COUNT; i++) {
+		m_done &= ~(1u << i);
+	}
+	m_version++;
 }
 
 
@@ -20922,7 +27636,7 @@ ostream& HumdrumFileBase::printFieldIndex(int fieldind, ostream& out) {
 			out << infile[i] << endl;
 			continue;
 		}
-		cout << infile.token(i,fieldind) << endl;
+		out << infile.token(i,fieldind) << endl;
 	}
 	return out;
 }
@@ -21029,13 +27743,16 @@ vector<int> HumdrumFileBase::getTrackWidths(void) {
 //////////////////////////////
 //
 // HumdrumFileBase::createLinesFromTokens -- Generate Humdrum lines strings
-//   from the stored list of tokens.
+//   from the stored list of tokens.  The content analyses (accidentals,
+//   slurs, ties, etc.) are marked as needing to be run again, since the
+//   tokens may have been changed.
 //
 
 void HumdrumFileBase::createLinesFromTokens(void) {
 	for (int i=0; i<(int)m_lines.size(); i++) {
 		m_lines[i]->createLineFromTokens();
 	}
+	m_analyses.invalidateContent();
 }
 
 
@@ -21902,6 +28619,7 @@ bool HumdrumFileBase::stitchLinesTogether(HumdrumLine& previous,
 bool HumdrumFileBase::analyzeSpines(void) {
 	vector<string> datatype;
 	vector<string> sinfo;
+	vector<std::shared_ptr<const string>> sshared;
 	vector<vector<HTp> > lastspine;
 	m_trackstarts.resize(0);
 	m_trackends.resize(0);
@@ -21926,12 +28644,14 @@ bool HumdrumFileBase::analyzeSpines(void) {
 			init = true;
 			datatype.resize(m_lines[i]->getTokenCount());
 			sinfo.resize(m_lines[i]->getTokenCount());
+			sshared.resize(m_lines[i]->getTokenCount());
 			lastspine.resize(m_lines[i]->getTokenCount());
 			for (j=0; j<m_lines[i]->getTokenCount(); j++) {
 				datatype[j] = m_lines[i]->getTokenString(j);
 				addToTrackStarts(m_lines[i]->token(j));
 				sinfo[j]    = to_string(j+1);
-				m_lines[i]->token(j)->setSpineInfo(sinfo[j]);
+				sshared[j]  = HumAddress::makeSpineInfo(sinfo[j]);
+				m_lines[i]->token(j)->setSpineInfo(sshared[j]);
 				m_lines[i]->token(j)->setFieldIndex(j);
 				lastspine[j].push_back(m_lines[i]->token(j));
 			}
@@ -21949,13 +28669,17 @@ bool HumdrumFileBase::analyzeSpines(void) {
 			return setParseError(err);
 		}
 		for (j=0; j<m_lines[i]->getTokenCount(); j++) {
-			m_lines[i]->token(j)->setSpineInfo(sinfo[j]);
+			m_lines[i]->token(j)->setSpineInfo(sshared[j]);
 			m_lines[i]->token(j)->setFieldIndex(j);
 		}
 		if (!m_lines[i]->isManipulator()) {
 			continue;
 		}
 		if (!adjustSpines(*m_lines[i], datatype, sinfo)) { return isValid(); }
+		sshared.resize(sinfo.size());
+		for (j=0; j<(int)sinfo.size(); j++) {
+			sshared[j] = HumAddress::makeSpineInfo(sinfo[j]);
+		}
 	}
 	return isValid();
 }
@@ -22374,15 +29098,16 @@ bool HumdrumFileBase::processNonNullDataTokensForTrackForward(HTp starttoken,
 //    variable in HumdrumTokens)
 //
 
-void HumdrumFileBase::addUniqueTokens(vector<HTp>& target,
+void HumdrumFileBase::addUniqueTokens(HumTokenLinks& target,
 		vector<HTp>& source) {
 	int i, j;
 	bool found;
 	for (i=0; i<(int)source.size(); i++) {
 		found = false;
 		for (j=0; j<(int)target.size(); j++) {
-			if (source[i] == target[i]) {
+			if (source[i] == target[j]) {
 				found = true;
+				break;
 			}
 		}
 		if (!found) {
@@ -23107,16 +29832,28 @@ bool HumdrumFileContent::analyzeMensAccidentals(void) {
 //    would not be printed.  Algorithm assumes that all secondary tied notes
 //    will not display their accidental across a system break.  Consideration
 //    about grace-note accidental display still needs to be done.
+//    The analysis is only done once for each version of the file: call
+//    createLinesFromTokens() or invalidateAnalysis() after changing notes
+//    to analyze them again.
 //
 
 bool HumdrumFileContent::analyzeKernAccidentals(const string& dataType) {
-
-	// ottava marks must be analyzed first:
-	this->analyzeOttavas();
+	if ((dataType == "**kern") || dataType.empty()) {
+		if (!startAnalysis(HumFileAnalysis::PASS_KERN_ACCIDENTALS)) {
+			return true;
+		}
+	} else if (dataType == "**mens") {
+		if (!startAnalysis(HumFileAnalysis::PASS_MENS_ACCIDENTALS)) {
+			return true;
+		}
+	} else {
+		// ottava marks must be analyzed first:
+		requireAnalysis(HumFileAnalysis::PASS_OTTAVAS);
+	}
 
 	HumdrumFileContent& infile = *this;
-	int i, j, k;
-	int kindex;
+	prepareAnalysisTables();
+	int i;
 	int track;
 
 	// ktracks == List of **kern spines in data.
@@ -23139,6 +29876,44 @@ bool HumdrumFileContent::analyzeKernAccidentals(const string& dataType) {
 	}
 	int kcount = (int)ktracks.size();
 
+	if (useAnalysisThreads(kcount)) {
+		// The accidental states of each part are independent, so each
+		// part can be analyzed in a separate thread.
+		runAnalysisThreads(kcount, [&](int part) {
+			analyzeKernAccidentals(rtracks, kcount, part);
+		});
+	} else {
+		analyzeKernAccidentals(rtracks, kcount, -1);
+	}
+
+	// Indicate that the accidental analysis has been done:
+	string dataTypeDone = "accidentalAnalysis" + dataType;
+	infile.setValue("auto", dataTypeDone, "true");
+
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::analyzeKernAccidentals -- Analyze the accidentals
+//    of a single part (the index of the spine in the list of analyzed
+//    spines), or all parts if part is negative.  The line-based
+//    interactions between parts (barlines starting a new measure in all
+//    parts, and repeated accidentals in chords split across subspines)
+//    are followed when analyzing a single part, so the results are the
+//    same as when all parts are analyzed together.
+//
+
+void HumdrumFileContent::analyzeKernAccidentals(vector<int>& rtracks,
+		int kcount, int part) {
+	HumdrumFileContent& infile = *this;
+	HumAnalysisTables& tables = m_analysisTables;
+	int i, j, k;
+	int kindex;
+	int track;
+
 	// keysigs == key signature spellings of diatonic pitch classes.  This array
 	// is duplicated into dstates after each barline.
 	vector<vector<int> > keysigs;
@@ -23191,6 +29966,9 @@ bool HumdrumFileContent::analyzeKernAccidentals(const string& dataType) {
 				if (token->compare(0, 3, "*k[") == 0) {
 					track = token->getTrack();
 					kindex = rtracks[track];
+					if ((part >= 0) && (kindex != part)) {
+						continue;
+					}
 					fillKeySignature(keysigs[kindex], *infile[i].token(j));
 					// resetting key states of current measure.  What to do if this
 					// key signature is in the middle of a measure?
@@ -23210,6 +29988,9 @@ bool HumdrumFileContent::analyzeKernAccidentals(const string& dataType) {
 				std::fill(firstinbar.begin(), firstinbar.end(), 1);
 				track = token->getTrack();
 				kindex = rtracks[track];
+				if ((part >= 0) && (kindex != part)) {
+					continue;
+				}
 				// reset the accidental states in dstates to match keysigs.
 				resetDiatonicStatesWithKeySignature(dstates[kindex], keysigs[kindex]);
 				resetDiatonicStatesWithKeySignature(gdstates[kindex], keysigs[kindex]);
@@ -23234,14 +30015,19 @@ bool HumdrumFileContent::analyzeKernAccidentals(const string& dataType) {
 				continue;
 			}
 
-			int subcount = token->getSubtokenCount();
 			track = token->getTrack();
-
 			if (lasttrack != track) {
 				fill(concurrentstate.begin(), concurrentstate.end(), 0);
 			}
 			lasttrack = track;
 			int rindex = rtracks[track];
+			if ((part >= 0) && (rindex != part)) {
+				continue;
+			}
+
+			int subcount = token->getSubtokenCount();
+			int tokenid = tables.getTokenId(token);
+			int octaveadjust = token->getValueInt("auto", "ottava");
 			for (k=0; k<subcount; k++) {
 				// bool tienote = false;
 				string subtok = token->getSubtoken(k);
@@ -23259,7 +30045,6 @@ bool HumdrumFileContent::analyzeKernAccidentals(const string& dataType) {
 				}
 				int b40 = Convert::kernToBase40(subtok);
 				int diatonic = Convert::kernToBase7(subtok);
-				int octaveadjust = token->getValueInt("auto", "ottava");
 				diatonic -= octaveadjust * 7;
 				if (diatonic < 0) {
 					// Deal with extra-low notes later.
@@ -23478,13 +30263,14 @@ bool HumdrumFileContent::analyzeKernAccidentals(const string& dataType) {
 					// accidental is different from the previous state so should be
 					// printed
 					if (!hiddenQ) {
-						token->setValue("auto", to_string(k), "visualAccidental", "true");
+						int flags = HumAnalysisTables::ACCID_VISUAL;
 						if (gdstates[rindex][diatonic] < -900) {
 							// this is an obligatory cautionary accidental
 							// or at least half the time it is (figure that out later)
-							token->setValue("auto", to_string(k), "obligatoryAccidental", "true");
-							token->setValue("auto", to_string(k), "cautionaryAccidental", "true");
+							flags |= HumAnalysisTables::ACCID_OBLIGATORY;
+							flags |= HumAnalysisTables::ACCID_CAUTIONARY;
 						}
+						setAccidentalState(tokenid, token, k, flags);
 					}
 					gdstates[rindex][diatonic] = accid;
 					// regular notes are not affected by grace notes accidental
@@ -23497,36 +30283,32 @@ bool HumdrumFileContent::analyzeKernAccidentals(const string& dataType) {
 					// accidental is different from the previous state so should be
 					// printed, but only print if not supposed to be hidden.
 					if (!hiddenQ) {
-						token->setValue("auto", to_string(k), "visualAccidental", "true");
+						int flags = HumAnalysisTables::ACCID_VISUAL;
 						concurrentstate[diatonic] = accid;
 						if (dstates[rindex][diatonic] < -900) {
 							// this is an obligatory cautionary accidental
 							// or at least half the time it is (figure that out later)
-							token->setValue("auto", to_string(k), "obligatoryAccidental", "true");
-							token->setValue("auto", to_string(k), "cautionaryAccidental", "true");
+							flags |= HumAnalysisTables::ACCID_OBLIGATORY;
+							flags |= HumAnalysisTables::ACCID_CAUTIONARY;
 						}
+						setAccidentalState(tokenid, token, k, flags);
 					}
 					dstates[rindex][diatonic] = accid;
 					gdstates[rindex][diatonic] = accid;
 
 				} else if ((accid == 0) && (subtok.find("n") != string::npos) && !hiddenQ) {
-					token->setValue("auto", to_string(k), "cautionaryAccidental", "true");
-					token->setValue("auto", to_string(k), "visualAccidental", "true");
+					setAccidentalState(tokenid, token, k, HumAnalysisTables::ACCID_VISUAL |
+							HumAnalysisTables::ACCID_CAUTIONARY);
 				} else if (subtok.find("XX") == string::npos) {
 					// The accidental is not necessary. See if there is a single "X"
 					// immediately after the accidental which means to force it to
 					// display.
 					auto loc = subtok.find("X");
 					if ((loc != string::npos) && (loc > 0)) {
-						if (subtok[loc-1] == '#') {
-							token->setValue("auto", to_string(k), "cautionaryAccidental", "true");
-							token->setValue("auto", to_string(k), "visualAccidental", "true");
-						} else if (subtok[loc-1] == '-') {
-							token->setValue("auto", to_string(k), "cautionaryAccidental", "true");
-							token->setValue("auto", to_string(k), "visualAccidental", "true");
-						} else if (subtok[loc-1] == 'n') {
-							token->setValue("auto", to_string(k), "cautionaryAccidental", "true");
-							token->setValue("auto", to_string(k), "visualAccidental", "true");
+						if ((subtok[loc-1] == '#') || (subtok[loc-1] == '-') ||
+								(subtok[loc-1] == 'n')) {
+							setAccidentalState(tokenid, token, k, HumAnalysisTables::ACCID_VISUAL |
+									HumAnalysisTables::ACCID_CAUTIONARY);
 						}
 					}
 				}
@@ -23534,12 +30316,36 @@ bool HumdrumFileContent::analyzeKernAccidentals(const string& dataType) {
 		}
 		std::fill(firstinbar.begin(), firstinbar.end(), 0);
 	}
+}
 
-	// Indicate that the accidental analysis has been done:
-	string dataTypeDone = "accidentalAnalysis" + dataType;
-	infile.setValue("auto", dataTypeDone, "true");
 
-	return true;
+
+//////////////////////////////
+//
+// HumdrumFileContent::setAccidentalState -- Store the display state of
+//    an accidental on a note in the analysis tables, and also in the
+//    token's HumHash ("visualAccidental", "cautionaryAccidental" and
+//    "obligatoryAccidental" parameters in the "auto" namespace for the
+//    subtoken) if analysis hash values are active.  Tokens which are not
+//    in the token index of the tables only store the state in the HumHash.
+//
+
+void HumdrumFileContent::setAccidentalState(int tokenid, HTp token,
+		int subtoken, int flags) {
+	bool stored = m_analysisTables.setAccidentalFlags(tokenid, subtoken, flags);
+	if (stored && !m_analysisHashValues) {
+		return;
+	}
+	string key = to_string(subtoken);
+	if (flags & HumAnalysisTables::ACCID_VISUAL) {
+		token->setValue("auto", key, "visualAccidental", "true");
+	}
+	if (flags & HumAnalysisTables::ACCID_OBLIGATORY) {
+		token->setValue("auto", key, "obligatoryAccidental", "true");
+	}
+	if (flags & HumAnalysisTables::ACCID_CAUTIONARY) {
+		token->setValue("auto", key, "cautionaryAccidental", "true");
+	}
 }
 
 
@@ -23599,11 +30405,10 @@ void HumdrumFileContent::resetDiatonicStatesWithKeySignature(vector<int>&
 //
 
 void HumdrumFileContent::analyzeBarlines(void) {
-	if (m_analyses.m_barlines_analyzed) {
-		// Maybe allow forcing reanalysis.
+	if (!startAnalysis(HumFileAnalysis::PASS_BARLINES)) {
+		// Use invalidateAnalysis() to force reanalysis.
 		return;
 	}
-	m_analyses.m_barlines_analyzed = true;
 	m_analyses.m_barlines_different = false;
 
 	string baseline;
@@ -23736,9 +30541,7 @@ bool HumdrumFileContent::hasDataStraddle(int line) {
 //
 
 bool HumdrumFileContent::hasDifferentBarlines(void) {
-	if (!m_analyses.m_barlines_analyzed) {
-		analyzeBarlines();
-	}
+	requireAnalysis(HumFileAnalysis::PASS_BARLINES);
 	return m_analyses.m_barlines_different;
 }
 
@@ -23755,10 +30558,11 @@ bool HumdrumFileContent::hasDifferentBarlines(void) {
 //
 
 bool HumdrumFileContent::analyzeBeams(void) {
-	if (m_analyses.m_beams_analyzed) {
+	if (!startAnalysis(HumFileAnalysis::PASS_BEAMS)) {
 		return false;
 	}
-	m_analyses.m_beams_analyzed = true;
+	HumAnalysisTables& tables = prepareAnalysisTables();
+	tables.getBeams().resize(tables.getTokenCount());
 	bool output = true;
 	output &= analyzeKernBeams();
 	output &= analyzeMensBeams();
@@ -23828,11 +30632,10 @@ bool HumdrumFileContent::analyzeMensBeams(void) {
 
 	vector<HTp> mensspines;
 	getSpineStartList(mensspines, "**mens");
-	bool output = true;
 	string linkSignifier = m_signifiers.getKernLinkSignifier();
-	for (int i=0; i<(int)mensspines.size(); i++) {
-		output = output && analyzeKernBeams(mensspines[i], beamstarts, beamends, labels, endings, linkSignifier);
-	}
+	SpineSpanAnalysis analysis = &HumdrumFileContent::analyzeKernBeams;
+	bool output = analyzeSpineSpans(analysis, m_analysisTables.getBeams(), mensspines,
+			beamstarts, beamends, labels, endings, linkSignifier);
 	createLinkedBeams(beamstarts, beamends);
 	return output;
 }
@@ -23899,11 +30702,10 @@ bool HumdrumFileContent::analyzeKernBeams(void) {
 
 	vector<HTp> kernspines;
 	getSpineStartList(kernspines, "**kern");
-	bool output = true;
 	string linkSignifier = m_signifiers.getKernLinkSignifier();
-	for (int i=0; i<(int)kernspines.size(); i++) {
-		output = output && analyzeKernBeams(kernspines[i], beamstarts, beamends, labels, endings, linkSignifier);
-	}
+	SpineSpanAnalysis analysis = &HumdrumFileContent::analyzeKernBeams;
+	bool output = analyzeSpineSpans(analysis, m_analysisTables.getBeams(), kernspines,
+			beamstarts, beamends, labels, endings, linkSignifier);
 
 	createLinkedBeams(beamstarts, beamends);
 	return output;
@@ -23997,17 +30799,25 @@ bool HumdrumFileContent::analyzeKernBeams(HTp spinestart,
 							if (labels[token->getLineIndex()].first) {
 								duration -= labels[token->getLineIndex()].first->getDurationFromStart();
 							}
-							token->setValue("auto", "endingBeamBack", "true");
-							token->setValue("auto", "beamSide", "stop");
-							token->setValue("auto", "beamDuration",
-								token->getDurationToEnd());
+							m_analysisTables.getBeams().addHanging(m_analysisTables.getTokenId(token),
+									false, token->getDurationToEnd(), -1, true);
+							if (m_analysisHashValues) {
+								token->setValue("auto", "endingBeamBack", "true");
+								token->setValue("auto", "beamSide", "stop");
+								token->setValue("auto", "beamDuration",
+									token->getDurationToEnd());
+							}
 						} else {
 							// This is a beam closing that does not have a matching opening.
-							token->setValue("auto", "hangingBeam", "true");
-							token->setValue("auto", "beamSide", "stop");
-							token->setValue("auto", "beamOpenIndex", to_string(i));
-							token->setValue("auto", "beamDuration",
-								token->getDurationToEnd());
+							m_analysisTables.getBeams().addHanging(m_analysisTables.getTokenId(token),
+									false, token->getDurationToEnd(), i);
+							if (m_analysisHashValues) {
+								token->setValue("auto", "hangingBeam", "true");
+								token->setValue("auto", "beamSide", "stop");
+								token->setValue("auto", "beamOpenIndex", to_string(i));
+								token->setValue("auto", "beamDuration",
+									token->getDurationToEnd());
+							}
 						}
 					}
 				}
@@ -24032,10 +30842,15 @@ bool HumdrumFileContent::analyzeKernBeams(HTp spinestart,
 	for (int i=0; i<(int)beamopens.size(); i++) {
 		for (int j=0; j<(int)beamopens[i].size(); j++) {
 			for (int k=0; k<(int)beamopens[i][j].size(); k++) {
-				beamopens[i][j][k]->setValue("", "auto", "hangingBeam", "true");
-				beamopens[i][j][k]->setValue("", "auto", "beamSide", "start");
-				beamopens[i][j][k]->setValue("", "auto", "beamDuration",
-						beamopens[i][j][k]->getDurationFromStart());
+				HTp btok = beamopens[i][j][k];
+				m_analysisTables.getBeams().addHanging(m_analysisTables.getTokenId(btok),
+						true, btok->getDurationFromStart());
+				if (m_analysisHashValues) {
+					btok->setValue("", "auto", "hangingBeam", "true");
+					btok->setValue("", "auto", "beamSide", "start");
+					btok->setValue("", "auto", "beamDuration",
+							btok->getDurationFromStart());
+				}
 			}
 		}
 	}
@@ -24135,46 +30950,63 @@ bool HumdrumFileContent::isLinkedBeamBegin(HTp token, int index, const string& p
 //////////////////////////////
 //
 // HumdrumFileContent::linkBeamEndpoints --  Allow up to two beam starts/ends
-//      on a note.
+//      on a note.  The link is stored in the beam analysis table, and also
+//      in the "auto" HumHash parameters of the tokens if analysis hash
+//      values are active.
 //
 
 void HumdrumFileContent::linkBeamEndpoints(HTp beamstart, HTp beamend) {
-	string durtag = "beamDuration";
-	string endtag = "beamEndId";
-	string starttag = "beamStartId";
-	string beamstartnumbertag = "beamStartNumber";
-	string beamendnumbertag = "beamEndNumber";
+	HumSpanTable& beams = m_analysisTables.getBeams();
+	int startid = m_analysisTables.getTokenId(beamstart);
+	int endid   = m_analysisTables.getTokenId(beamend);
 
-	int beamStartCount = beamstart->getValueInt("auto", "beamStartCount");
+	int beamStartCount = beams.getStartCount(startid);
 	int opencount = (int)count(beamstart->begin(), beamstart->end(), 'L');
 	beamStartCount++;
 	int openEnumeration = opencount - beamStartCount + 1;
 
-	if (openEnumeration > 1) {
-		endtag += to_string(openEnumeration);
-		durtag += to_string(openEnumeration);
-		beamendnumbertag += to_string(openEnumeration);
-	}
-
-	int beamEndNumber = beamend->getValueInt("auto", "beamEndCount");
+	int beamEndNumber = beams.getEndCount(endid);
 	beamEndNumber++;
 	int closeEnumeration = beamEndNumber;
-	if (closeEnumeration > 1) {
-		starttag += to_string(closeEnumeration);
-		beamstartnumbertag += to_string(closeEnumeration);
-	}
 
 	HumNum duration = beamend->getDurationFromStart()
 			- beamstart->getDurationFromStart();
 
 	HumNum durToBar = beamstart->getDurationToBarline();
 
+	beams.addLink(startid, endid, beamstart, beamend, openEnumeration,
+			closeEnumeration, duration);
+
 	if (duration >= durToBar) {
-		beamstart->setValue("auto", "beamSpanStart", 1);
-		beamend->setValue("auto", "beamSpanEnd", 1);
+		beams.setSpanEndpoints(startid, endid);
+		if (m_analysisHashValues) {
+			beamstart->setValue("auto", "beamSpanStart", 1);
+			beamend->setValue("auto", "beamSpanEnd", 1);
+		}
 		markBeamSpanMembers(beamstart, beamend);
 	}
 
+	if (!m_analysisHashValues) {
+		return;
+	}
+
+	string durtag = "beamDuration";
+	string endtag = "beamEndId";
+	string starttag = "beamStartId";
+	string beamstartnumbertag = "beamStartNumber";
+	string beamendnumbertag = "beamEndNumber";
+
+	if (openEnumeration > 1) {
+		endtag += to_string(openEnumeration);
+		durtag += to_string(openEnumeration);
+		beamendnumbertag += to_string(openEnumeration);
+	}
+
+	if (closeEnumeration > 1) {
+		starttag += to_string(closeEnumeration);
+		beamstartnumbertag += to_string(closeEnumeration);
+	}
+
 	beamstart->setValue("auto", endtag,            beamend);
 	beamstart->setValue("auto", "id",              beamstart);
 	beamstart->setValue("auto", beamendnumbertag,  closeEnumeration);
@@ -24195,9 +31027,14 @@ void HumdrumFileContent::linkBeamEndpoints(HTp beamstart, HTp beamend) {
 //
 
 void HumdrumFileContent::markBeamSpanMembers(HTp beamstart, HTp beamend) {
+	HumSpanTable& beams = m_analysisTables.getBeams();
 	int endindex = beamend->getLineIndex();
-	beamstart->setValue("auto", "inBeamSpan", beamstart);
-	beamend->setValue("auto", "inBeamSpan", beamstart);
+	beams.setSpanMember(m_analysisTables.getTokenId(beamstart), beamstart);
+	beams.setSpanMember(m_analysisTables.getTokenId(beamend), beamstart);
+	if (m_analysisHashValues) {
+		beamstart->setValue("auto", "inBeamSpan", beamstart);
+		beamend->setValue("auto", "inBeamSpan", beamstart);
+	}
 	HTp current = beamstart->getNextToken();;
 	while (current) {
       int line = current->getLineIndex();
@@ -24221,7 +31058,10 @@ void HumdrumFileContent::markBeamSpanMembers(HTp beamstart, HTp beamend) {
 			current = current->getNextToken();
 			continue;
 		}
-		current->setValue("auto", "inBeamSpan", beamstart);
+		beams.setSpanMember(m_analysisTables.getTokenId(current), beamstart);
+		if (m_analysisHashValues) {
+			current->setValue("auto", "inBeamSpan", beamstart);
+		}
 		current = current->getNextToken();
 	}
 }
@@ -24370,12 +31210,465 @@ vector<int> HumdrumFileContent::getTrackToKernIndex(void) {
 
 
 
+
+//////////////////////////////
+//
+// HumdrumFileContent::analyzeMeasureIndex -- Create a list of the numbered
+//     measures in the file.  Measures start at a barline starting with
+//     "=" and a number, and end at the next barline containing a number
+//     (unnumbered barlines inside of a measure are ignored).  Data before
+//     the first numbered barline is given the measure number 0, and the last
+//     measure ends at the final barline (or the spine terminators if there
+//     is no final barline).  The index is created only once; if the contents
+//     of the file are changed after the index is created, then the file
+//     will need to be reparsed for a new index.
+//
+
+bool HumdrumFileContent::analyzeMeasureIndex(void) {
+	if (!startAnalysis(HumFileAnalysis::PASS_MEASURES)) {
+		return true;
+	}
+
+	HumdrumFileContent& infile = *this;
+	int lineCount = infile.getLineCount();
+	m_measureIndex.clear();
+	m_measureNumbers.clear();
+	m_measureLines.assign(lineCount, -1);
+	m_barNumbers.assign(lineCount, 0);
+
+	HumMeasureInfo current;
+
+	// pickup measure (measure 0):
+	int firstdata = -1;
+	for (int i=0; i<lineCount; i++) {
+		if ((firstdata < 0) && infile[i].isData()) {
+			firstdata = i;
+		}
+		if (!infile[i].isBarline()) {
+			continue;
+		}
+		if (infile.token(i, 0)->find_first_of("0123456789") == string::npos) {
+			continue;
+		}
+		if (firstdata >= 0) {
+			current.number = 0;
+			current.startline = firstdata;
+			current.stopline = i;
+			m_measureIndex.push_back(current);
+		}
+		break;
+	}
+
+	int lastdata = -1;
+	int lastbar  = -1;
+	for (int i=lineCount-1; i>=0; i--) {
+		if ((lastdata < 0) && infile[i].isData()) {
+			lastdata = i;
+		}
+		if ((lastbar < 0) && infile[i].isBarline()) {
+			lastbar = i;
+		}
+		if ((lastbar >= 0) && (lastdata >= 0)) {
+			break;
+		}
+	}
+
+	// numbered measures:
+	int lastend = -1;
+	int lastnum = -1;
+	int dataend = -1;
+	int barnum;
+	for (int i=0; i<lineCount; i++) {
+		if (infile[i].isInterpretation() && (*infile.token(i, 0) == "*-")) {
+			dataend = i;
+			break;
+		}
+		if (!infile[i].isBarline()) {
+			continue;
+		}
+		if (sscanf(infile.token(i, 0)->c_str(), "=%d", &barnum) != 1) {
+			continue;
+		}
+		for (int ii=i+1; ii<lineCount; ii++) {
+			if (!infile[ii].isBarline()) {
+				continue;
+			}
+			HTp token = infile.token(ii, 0);
+			size_t pos = token->find_first_of("0123456789");
+			if (pos == string::npos) {
+				if (ii >= lastdata) {
+					// no more data in the file
+					break;
+				}
+				continue;
+			}
+			current.clear();
+			current.number = barnum;
+			current.startline = i;
+			current.stopline = ii;
+			m_measureIndex.push_back(current);
+			lastend = ii;
+			lastnum = stoi(token->substr(pos));
+			i = ii - 1;
+			break;
+		}
+	}
+
+	// final measure:
+	if ((lastnum >= 0) && (lastend >= 0) && (dataend >= 0)) {
+		current.clear();
+		current.number = lastnum;
+		current.startline = lastend;
+		current.stopline = (lastbar > lastdata) ? lastbar : dataend;
+		m_measureIndex.push_back(current);
+	}
+
+	// Store the line to measure mapping, the bar number for each line and
+	// the prevailing interpretations at the start of each measure:
+	vector<vector<HTp>> states(6);
+	for (int i=0; i<(int)states.size(); i++) {
+		states[i].assign(infile.getMaxTrack() + 1, NULL);
+	}
+	int entry = 0;
+	int currentbar = 0;
+	for (int i=0; i<lineCount; i++) {
+		while ((entry < (int)m_measureIndex.size()) &&
+				(m_measureIndex[entry].startline <= i)) {
+			storeMeasureState(m_measureIndex[entry], states);
+			if (m_measureNumbers.find(m_measureIndex[entry].number) == m_measureNumbers.end()) {
+				m_measureNumbers[m_measureIndex[entry].number] = entry;
+			}
+			entry++;
+		}
+		if ((entry > 0) && (i <= m_measureIndex[entry-1].stopline)) {
+			m_measureLines[i] = entry - 1;
+		}
+
+		if (infile[i].isBarline()) {
+			HTp token = infile.token(i, 0);
+			size_t pos = token->find('=');
+			while (pos != string::npos) {
+				if ((pos + 1 < token->size()) && isdigit((*token)[pos+1])) {
+					currentbar = stoi(token->substr(pos+1));
+					break;
+				}
+				pos = token->find('=', pos + 1);
+			}
+		}
+		m_barNumbers[i] = currentbar;
+
+		if (!infile[i].isInterpretation()) {
+			continue;
+		}
+		for (int j=0; j<infile[i].getFieldCount(); j++) {
+			HTp token = infile.token(i, j);
+			int track = token->getTrack();
+			if ((track < 1) || (track >= (int)states[0].size())) {
+				continue;
+			}
+			if (token->isClef()) {
+				states[0][track] = token;
+			} else if (token->isKeySignature()) {
+				states[1][track] = token;
+			} else if (token->isKeyDesignation()) {
+				states[2][track] = token;
+			} else if (token->isTimeSignature()) {
+				states[3][track] = token;
+			} else if (token->isMensurationSymbol()) {
+				states[4][track] = token;
+			} else if (token->isTempo()) {
+				states[5][track] = token;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::storeMeasureState -- Store the current interpretation
+//    states and the spine layout at the start of a measure.
+//
+
+void HumdrumFileContent::storeMeasureState(HumMeasureInfo& info,
+		vector<vector<HTp>>& states) {
+	info.clef    = states[0];
+	info.keysig  = states[1];
+	info.key     = states[2];
+	info.timesig = states[3];
+	info.met     = states[4];
+	info.tempo   = states[5];
+
+	HumdrumFileContent& infile = *this;
+	info.subtracks.assign(infile.getMaxTrack() + 1, 0);
+	if ((info.startline < 0) || !infile[info.startline].hasSpines()) {
+		return;
+	}
+	for (int j=0; j<infile[info.startline].getFieldCount(); j++) {
+		int track = infile.token(info.startline, j)->getTrack();
+		if ((track > 0) && (track < (int)info.subtracks.size())) {
+			info.subtracks[track]++;
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getMeasureIndexCount -- Return the number of
+//     entries in the measure index.
+//
+
+int HumdrumFileContent::getMeasureIndexCount(void) {
+	analyzeMeasureIndex();
+	return (int)m_measureIndex.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getMeasureIndexEntry -- Return an entry in the
+//     measure index.
+//
+
+const HumMeasureInfo& HumdrumFileContent::getMeasureIndexEntry(int index) {
+	analyzeMeasureIndex();
+	return m_measureIndex.at(index);
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getMeasureIndexForNumber -- Return the index of
+//     the first measure with the given measure number, or -1 if there is
+//     no such measure.
+//
+
+int HumdrumFileContent::getMeasureIndexForNumber(int number) {
+	analyzeMeasureIndex();
+	auto it = m_measureNumbers.find(number);
+	if (it == m_measureNumbers.end()) {
+		return -1;
+	}
+	return it->second;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getMeasureIndexForLine -- Return the index of the
+//     measure containing the given line, or -1 if the line is not within
+//     a measure.  Barlines between two measures belong to the second one.
+//
+
+int HumdrumFileContent::getMeasureIndexForLine(int line) {
+	analyzeMeasureIndex();
+	if ((line < 0) || (line >= (int)m_measureLines.size())) {
+		return -1;
+	}
+	return m_measureLines[line];
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getBarNumberForLine -- Return the number of the
+//     last numbered barline on or before the given line (0 if none).
+//
+
+int HumdrumFileContent::getBarNumberForLine(int line) {
+	analyzeMeasureIndex();
+	if ((line < 0) || (line >= (int)m_barNumbers.size())) {
+		return 0;
+	}
+	return m_barNumbers[line];
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::analyzeMetricGrid -- Fill in the metric table of
+//     the file (see HumMetricTable), with the metric position
+//     of each data line in each track of the file.  Positions are computed
+//     once for each meter on a line, and shared by the tracks using that
+//     meter.  If time signatures or rhythms are changed after the analysis,
+//     call invalidateAnalysis(HumFileAnalysis::PASS_METRIC_GRID) before
+//     using the table again.
+//
+
+bool HumdrumFileContent::analyzeMetricGrid(void) {
+	if (!startAnalysis(HumFileAnalysis::PASS_METRIC_GRID)) {
+		return true;
+	}
+	HumdrumFileContent& infile = *this;
+	HumMetricTable& grid = m_metricGrid;
+	int lineCount = infile.getLineCount();
+	int trackCount = infile.getMaxTrack();
+	grid.resize(lineCount, trackCount);
+
+	// Current time signature and meter of each track, and the line of the
+	// last time signature (only the first one on a line is used):
+	vector<int> tops(trackCount + 1, 0);
+	vector<int> bottoms(trackCount + 1, 0);
+	vector<int> bottoms2(trackCount + 1, 0);
+	vector<int> meters(trackCount + 1, 0);
+	vector<int> meterLines(trackCount + 1, -1);
+
+	// Beat durations, metric-level pulses, compound states and integer
+	// bottoms of each meter in the table:
+	vector<HumNum> beats(1, 1);
+	vector<HumNum> pulses(1, 1);
+	vector<bool> compounds(1, false);
+	vector<int> pulseBottoms(1, 4);
+
+	HumRegex hre;
+	for (int i=0; i<lineCount; i++) {
+		if (infile[i].isInterpretation()) {
+			int fieldCount = infile[i].getFieldCount();
+			for (int j=0; j<fieldCount; j++) {
+				HTp token = infile.token(i, j);
+				int track = token->getTrack();
+				if ((track < 1) || (track > trackCount)) {
+					continue;
+				}
+				int meter = -1;
+				int top = 0;
+				int bot = 0;
+				int bot2 = 0;
+				HumNum beat = 0;
+				if (token->compare(0, 2, "*M") == 0) {
+					int count = sscanf(token->c_str(), "*M%d/%d%%%d", &top, &bot, &bot2);
+					if ((count < 2) || (meterLines[track] == i)) {
+						continue;
+					}
+					meterLines[track] = i;
+					tops[track] = top;
+					bottoms[track] = bot;
+					bottoms2[track] = (count == 3) ? bot2 : 0;
+					meter = grid.addMeter(top, bot, bottoms2[track], 0);
+				} else if (token->compare(0, 6, "*beat:") == 0) {
+					if (!hre.search(token, "^\\*beat:\\s*([\\d.%]+)\\s*$")) {
+						continue;
+					}
+					beat = Convert::recipToDuration(hre.getMatch(1));
+					meter = grid.addMeter(tops[track], bottoms[track], bottoms2[track], beat);
+				} else {
+					continue;
+				}
+				meters[track] = meter;
+				if (meter == (int)beats.size()) {
+					HumNum pulse = 1;
+					bool compound = (tops[track] % 3 == 0) && (tops[track] != 3) && (tops[track] != 0);
+					if (bottoms[track] > 0) {
+						pulse.setValue(4, bottoms[track]);
+						if (compound) {
+							pulse *= 3;
+						}
+					}
+					beats.push_back(beat > 0 ? beat : pulse);
+					pulses.push_back(pulse);
+					compounds.push_back(compound);
+					pulseBottoms.push_back(bottoms[track]);
+				}
+			}
+		}
+		if (!infile[i].isData()) {
+			continue;
+		}
+
+		HumNum position = infile[i].getDurationFromBarline();
+		grid.addLine(i, position);
+		int lastMeter = -1;
+		int beat = 0;
+		HumNum fraction;
+		double level = NAN;
+		for (int track=1; track<=trackCount; track++) {
+			int meter = meters[track];
+			if (meter != lastMeter) {
+				HumNum beatpos = position / beats[meter];
+				int whole = beatpos.getNumerator() / beatpos.getDenominator();
+				beat = whole + 1;
+				fraction = beatpos - whole;
+				level = getMetricLevel(position, pulses[meter], compounds[meter],
+						pulseBottoms[meter]);
+				lastMeter = meter;
+			}
+			grid.setPosition(i, track, meter, beat, fraction, level);
+		}
+	}
+
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getMetricGrid -- Return the metric table for the
+//     file, running the analysis if necessary.
+//
+
+const HumMetricTable& HumdrumFileContent::getMetricGrid(void) {
+	HumMetricTable& grid = m_metricGrid;
+	if (m_analyses.isDone(HumFileAnalysis::PASS_METRIC_GRID) &&
+			(grid.getLineCount() != getLineCount())) {
+		// Lines have been added or removed since the analysis.
+		invalidateAnalysis(HumFileAnalysis::PASS_METRIC_GRID);
+	}
+	requireAnalysis(HumFileAnalysis::PASS_METRIC_GRID);
+	return grid;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getMetricLevel -- Return the metric level of a
+//     position in a measure: the number of binary divisions of the pulse
+//     (or a ternary division followed by binary divisions in compound
+//     meters) needed to reach the position.
+//
+
+double HumdrumFileContent::getMetricLevel(HumNum position, HumNum pulse,
+		bool compound, int bottom) {
+	HumNum measurepos = position / pulse;
+	int denominator = measurepos.getDenominator();
+	if (!compound) {
+		return Convert::nearIntQuantize(log(denominator) / log(2.0));
+	}
+	double output = Convert::nearIntQuantize(log(denominator) / log(3.0));
+	if ((output != 0.0) && (output != 1.0)) {
+		// if not the beat or first level, then calculate
+		// levels above level 1.  In 6/8 this means
+		// to move the 8th note level to be the "beat"
+		// and then use binary levels for rhythmic levels
+		// smaller than a beat.
+		HumNum combeatdur(4, bottom);
+		HumNum commeasurepos = position / combeatdur;
+		denominator = commeasurepos.getDenominator();
+		output = 1.0 + log(denominator)/log(2.0);
+	}
+	return output;
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumFileStructure::getMetricLevels -- Each line in the output
 //     vector matches to the line of the metric analysis data.
 //     undefined is the value to represent undefined analysis data
-//     (for non-data spines).
+//     (for non-data spines).  The levels are read from the metric
+//     grid of the file (see analyzeMetricGrid()).
 //
 //     default value: track = 0: 0 means use the time signature
 //         of the first **kern spines in the file; otherwise, use the
@@ -24390,7 +31683,6 @@ void HumdrumFileContent::getMetricLevels(vector<double>& output,
 	HumdrumFileStructure& infile = *this;
 	int lineCount = infile.getLineCount();
 	output.resize(lineCount);
-	fill(output.begin(), output.end(), undefined);
 	vector<HTp> kernspines = infile.getKernSpineStartList();
 	if ((track == 0) && (kernspines.size() > 0)) {
 		track = kernspines[0]->getTrack();
@@ -24399,62 +31691,9 @@ void HumdrumFileContent::getMetricLevels(vector<double>& output,
 		track = 1;
 	}
 
-	int top = 1;                // top number of time signature (0 for no meter)
-	int bot = 4;                // bottom number of time signature
-	bool compoundQ = false;     // test for compound meters, such as 6/8
-	HumNum beatdur(1 * 4, bot); // duration of a beat in the measure
-	HumNum measurepos;          // quarter notes from the start of barline
-	HumNum combeatdur;          // for adjusting beat level in compound meters
-	HumNum commeasurepos;       // for adjusting beat level in compound meters
-
+	const HumMetricTable& grid = getMetricGrid();
 	for (int i=0; i<lineCount; i++) {
-		if (infile[i].isInterpretation()) {
-			// check for time signature:
-			HumdrumLine& line = *infile.getLine(i);
-			for (int j=0; j<line.getFieldCount(); j++) {
-				int ttrack = line.token(j)->getTrack();
-				if (ttrack != track) {
-					continue;
-				}
-				if (sscanf(infile.token(i,j)->c_str(), "*M%d/%d", &top, &bot)) {
-					beatdur.setValue(1*4, bot); // converted to quarter-note units
-					if ((top % 3 == 0) && (top != 3)) {
-						// if meter top is a multiple of 3 but not 3, then compound
-						// such as 6/8, 9/8, 6/4, but not 3/8, 3/4.
-						compoundQ = true;
-						beatdur *= 3;
-					} else {
-						compoundQ = false;
-					}
-					break;
-				}
-			}
-		}
-		if (!infile[i].isData()) {
-				continue;
-		}
-
-		measurepos = infile[i].getDurationFromBarline();
-		// Might want to handle cases where the time signature changes in
-		// the middle or a measure...
-		measurepos /= beatdur;
-		int denominator = measurepos.getDenominator();
-		if (compoundQ) {
-			output[i] = Convert::nearIntQuantize(log(denominator) / log(3.0));
-			if ((output[i] != 0.0) && (output[i] != 1.0)) {
-				// if not the beat or first level, then calculate
-				// levels above level 1.  In 6/8 this means
-				// to move the 8th note level to be the "beat"
-				// and then use binary levels for rhythmic levels
-				// smaller than a beat.
-				combeatdur.setValue(4,bot);
-				commeasurepos = infile[i].getDurationFromBarline() / combeatdur;
-				denominator = commeasurepos.getDenominator();
-				output[i] = 1.0 + log(denominator)/log(2.0);
-			}
-		} else {
-			output[i] = Convert::nearIntQuantize(log(denominator) / log(2.0));
-		}
+		output[i] = grid.getMetricLevel(i, track, undefined);
 	}
 }
 
@@ -24485,15 +31724,14 @@ void HumdrumFileContent::fillMidiInfo(vector<vector<vector<pair<HTp, int>>>>& tr
 	
 	vector<int> trackToKernIndex = infile.getTrackToKernIndex();
 
-	for (int i=0; i<infile.getStrandCount(); i++) {
-		HTp sstart = infile.getStrandStart(i);
-		if (!sstart->isKern()) {
+	const HumStrandTable& strands = getStrandTable();
+	for (int i=0; i<strands.getStrandCount(); i++) {
+		HTp sstart = strands.getToken(strands.getStrandOffset(i));
+		if (!sstart || !sstart->isKern()) {
 			continue;
 		}
-
-		int track = sstart->getTrack();
-		HTp send = infile.getStrandEnd(i);
-		processStrandNotesForMidi(sstart, send, trackMidi[trackToKernIndex[track]]);
+		int track = strands.getStrandTrack(i);
+		processStrandNotesForMidi(i, trackMidi[trackToKernIndex[track]]);
 	}
 }
 
@@ -24516,26 +31754,54 @@ void HumdrumFileContent::processStrandNotesForMidi(HTp sstart, HTp send, vector<
 			current = current->getNextToken();
 			continue;
 		}
-		vector<string> subtokens = current->getSubtokens();
-		for (int i=0; i<(int)subtokens.size(); i++) {
-			if (subtokens[i] == ".") {
-				// something strange happened (no null tokens expected)
-				continue;
-			}
-			if (subtokens[i].find("r") != string::npos) {
-				// rest, so store in MIDI[0]
-				trackInfo.at(0).emplace_back(current, 0);
-			} else if (subtokens[i].find("R") != string::npos) {
-				// unpitched or quasi-pitched note, so store in MIDI[0]
-				trackInfo.at(0).emplace_back(current, 0);
-			} else {
-				int keyno = Convert::kernToMidiNoteNumber(subtokens[i]);
-				if ((keyno >= 0) && (keyno < 128)) {
-					trackInfo.at(keyno).emplace_back(current, i);
-				}
+		addNotesForMidi(current, trackInfo);
+		current = current->getNextToken();
+	}
+}
+
+
+//
+// Strand given by its index in the strand table (see getStrandTable()):
+//
+
+void HumdrumFileContent::processStrandNotesForMidi(int strand, vector<vector<pair<HTp, int>>>& trackInfo) {
+	const HumStrandTable& strands = getStrandTable();
+	int start = strands.getStrandOffset(strand);
+	int end = start + strands.getStrandSize(strand);
+	for (int i=start; i<end; i++) {
+		if (strands.isData(i) && !strands.isNull(i)) {
+			addNotesForMidi(strands.getToken(i), trackInfo);
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::addNotesForMidi -- store the subtokens of a data
+//     token by MIDI note number (rests and unpitched notes in MIDI[0]).
+//
+
+void HumdrumFileContent::addNotesForMidi(HTp token, vector<vector<pair<HTp, int>>>& trackInfo) {
+	vector<string> subtokens = token->getSubtokens();
+	for (int i=0; i<(int)subtokens.size(); i++) {
+		if (subtokens[i] == ".") {
+			// something strange happened (no null tokens expected)
+			continue;
+		}
+		if (subtokens[i].find("r") != string::npos) {
+			// rest, so store in MIDI[0]
+			trackInfo.at(0).emplace_back(token, 0);
+		} else if (subtokens[i].find("R") != string::npos) {
+			// unpitched or quasi-pitched note, so store in MIDI[0]
+			trackInfo.at(0).emplace_back(token, 0);
+		} else {
+			int keyno = Convert::kernToMidiNoteNumber(subtokens[i]);
+			if ((keyno >= 0) && (keyno < 128)) {
+				trackInfo.at(keyno).emplace_back(token, i);
 			}
 		}
-		current = current->getNextToken();
 	}
 }
 
@@ -24866,28 +32132,23 @@ void HumdrumFileContent::prepareStaffBelowNoteStems(HTp token) {
 //
 
 int HumdrumFileContent::getNoteCount(void) {
-	HumdrumFileContent& infile = *this;
+	const HumStrandTable& strands = getStrandTable();
 	int counter = 0;
 
-	int scount = infile.getStrandCount();
+	int scount = strands.getStrandCount();
 	for (int i=0; i<scount; i++) {
-		HTp sstart = infile.getStrandStart(i);
-		if (!sstart->isKern()) {
+		int start = strands.getStrandOffset(i);
+		int end = start + strands.getStrandSize(i);
+		HTp sstart = strands.getToken(start);
+		if (!sstart || !sstart->isKern()) {
 			continue;
 		}
-		HTp send = infile.getStrandEnd(i);
-		HTp current = sstart;
-		while (current && (current != send)) {
-			if (!current->isData()) {
-				current = current->getNextToken();
-				continue;
-			}
-			if (current->isNull()) {
-				current = current->getNextToken();
+		for (int j=start; j<end; j++) {
+			if (!strands.isData(j) || strands.isNull(j)) {
 				continue;
 			}
+			HTp current = strands.getToken(j);
 			if (current->isRest()) {
-				current = current->getNextToken();
 				continue;
 			}
 			int subcount = current->getSubtokenCount();
@@ -24910,7 +32171,6 @@ int HumdrumFileContent::getNoteCount(void) {
 					counter++;
 				}
 			}
-			current = current->getNextToken();
 		}
 	}
 	return counter;
@@ -24920,12 +32180,117 @@ int HumdrumFileContent::getNoteCount(void) {
 
 
 
+//////////////////////////////
+//
+// HumdrumFileContent::analyzeNullResolution -- Fill in the null-token
+//     resolution table of the analysis tables.  Each token inherits the
+//     resolution of the previous token in its spine (the first spine for
+//     spine merges), so null data tokens and non-data tokens resolve to
+//     the last non-null data token before them.  The attack line of a
+//     secondary tied note is the attack line of the note that it is tied
+//     to.  If the contents of tokens are changed after the analysis, call
+//     invalidateAnalysis(HumFileAnalysis::PASS_NULL_TABLE) before using
+//     the table again.
+//
+
+bool HumdrumFileContent::analyzeNullResolution(void) {
+	if (!startAnalysis(HumFileAnalysis::PASS_NULL_TABLE)) {
+		return true;
+	}
+	HumAnalysisTables& tables = m_analysisTables;
+	HumdrumFileContent& infile = *this;
+
+	for (int i=0; i<infile.getLineCount(); i++) {
+		int fieldCount = infile[i].getFieldCount();
+		for (int j=0; j<fieldCount; j++) {
+			HTp token = infile.token(i, j);
+			int id = tables.getTokenId(i, j);
+			int previd = tables.getTokenId(token->getPreviousToken(0));
+			int resolved = tables.getNullResolution(previd);
+			int attack = tables.getAttackLine(previd);
+			if (token->isData() && !token->isNull()) {
+				if ((resolved < 0) || !token->isSecondaryTiedNote()) {
+					attack = i;
+				}
+				resolved = id;
+			}
+			tables.setNullResolution(id, resolved, attack);
+		}
+	}
+
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getResolvedToken -- Return the last non-null data
+//     token in the spine at or before the given position, or NULL if
+//     there is none.  For many lookups, use getAnalysisTables() directly
+//     after calling analyzeNullResolution().  Like the other accessors
+//     below, this reruns the analysis if lines have been added or removed
+//     since it was done.
+//
+
+HTp HumdrumFileContent::getResolvedToken(int line, int field) {
+	HumAnalysisTables& tables = getAnalysisTables();
+	requireAnalysis(HumFileAnalysis::PASS_NULL_TABLE);
+	return tables.getToken(tables.getNullResolution(tables.getTokenId(line, field)));
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getResolvedPosition -- Return the line and field of
+//     the last non-null data token in the spine at or before the given
+//     position.  Returns false if there is no such token.
+//
+
+bool HumdrumFileContent::getResolvedPosition(int line, int field, int& rline,
+		int& rfield) {
+	HumAnalysisTables& tables = getAnalysisTables();
+	requireAnalysis(HumFileAnalysis::PASS_NULL_TABLE);
+	int resolved = tables.getNullResolution(tables.getTokenId(line, field));
+	if (resolved < 0) {
+		rline = -1;
+		rfield = -1;
+		return false;
+	}
+	rline = tables.getTokenLine(resolved);
+	rfield = tables.getTokenField(resolved);
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getAttackLine -- Return the line on which the note
+//     (or rest) sounding at the given position was attacked, following
+//     ties back to the first note of the tie group.  Returns -1 if there
+//     is no data before the position in the spine.
+//
+
+int HumdrumFileContent::getAttackLine(int line, int field) {
+	HumAnalysisTables& tables = getAnalysisTables();
+	requireAnalysis(HumFileAnalysis::PASS_NULL_TABLE);
+	return tables.getAttackLine(tables.getTokenId(line, field));
+}
+
+
+
+
 //////////////////////////////
 //
 // HumdrumFileContent::analyzeOttavas --
 //
 
 void HumdrumFileContent::analyzeOttavas(void) {
+	if (!startAnalysis(HumFileAnalysis::PASS_OTTAVAS)) {
+		return;
+	}
 	int tcount = getTrackCount();
 	vector<int> activeOttava(tcount+1, 0);
 	vector<int> octavestate(tcount+1, 0);
@@ -25004,10 +32369,11 @@ void HumdrumFileContent::analyzeOttavas(void) {
 //
 
 bool HumdrumFileContent::analyzePhrasings(void) {
-	if (m_analyses.m_phrases_analyzed) {
+	if (!startAnalysis(HumFileAnalysis::PASS_PHRASES)) {
 		return false;
 	}
-	m_analyses.m_phrases_analyzed = true;
+	HumAnalysisTables& tables = prepareAnalysisTables();
+	tables.getPhrases().resize(tables.getTokenCount());
 	bool output = true;
 	output &= analyzeKernPhrasings();
 	return output;
@@ -25173,17 +32539,25 @@ bool HumdrumFileContent::analyzeKernPhrasings(HTp spinestart,
 							if (labels[token->getLineIndex()].first) {
 								duration -= labels[token->getLineIndex()].first->getDurationFromStart();
 							}
-							token->setValue("auto", "endingPhraseBack", "true");
-							token->setValue("auto", "phraseSide", "stop");
-							token->setValue("auto", "phraseDuration",
-								token->getDurationToEnd());
+							m_analysisTables.getPhrases().addHanging(m_analysisTables.getTokenId(token),
+									false, token->getDurationToEnd(), -1, true);
+							if (m_analysisHashValues) {
+								token->setValue("auto", "endingPhraseBack", "true");
+								token->setValue("auto", "phraseSide", "stop");
+								token->setValue("auto", "phraseDuration",
+									token->getDurationToEnd());
+							}
 						} else {
 							// This is a phrase closing that does not have a matching opening.
-							token->setValue("auto", "hangingPhrase", "true");
-							token->setValue("auto", "phraseSide", "stop");
-							token->setValue("auto", "phraseOpenIndex", to_string(i));
-							token->setValue("auto", "phraseDuration",
-								token->getDurationToEnd());
+							m_analysisTables.getPhrases().addHanging(m_analysisTables.getTokenId(token),
+									false, token->getDurationToEnd(), i);
+							if (m_analysisHashValues) {
+								token->setValue("auto", "hangingPhrase", "true");
+								token->setValue("auto", "phraseSide", "stop");
+								token->setValue("auto", "phraseOpenIndex", to_string(i));
+								token->setValue("auto", "phraseDuration",
+									token->getDurationToEnd());
+							}
 						}
 					}
 				}
@@ -25208,10 +32582,15 @@ bool HumdrumFileContent::analyzeKernPhrasings(HTp spinestart,
 	for (int i=0; i<(int)phraseopens.size(); i++) {
 		for (int j=0; j<(int)phraseopens[i].size(); j++) {
 			for (int k=0; k<(int)phraseopens[i][j].size(); k++) {
-				phraseopens[i][j][k]->setValue("", "auto", "hangingPhrase", "true");
-				phraseopens[i][j][k]->setValue("", "auto", "phraseSide", "start");
-				phraseopens[i][j][k]->setValue("", "auto", "phraseDuration",
-						phraseopens[i][j][k]->getDurationFromStart());
+				HTp ptok = phraseopens[i][j][k];
+				m_analysisTables.getPhrases().addHanging(m_analysisTables.getTokenId(ptok),
+						true, ptok->getDurationFromStart());
+				if (m_analysisHashValues) {
+					ptok->setValue("", "auto", "hangingPhrase", "true");
+					ptok->setValue("", "auto", "phraseSide", "start");
+					ptok->setValue("", "auto", "phraseDuration",
+							ptok->getDurationFromStart());
+				}
 			}
 		}
 	}
@@ -25311,21 +32690,38 @@ bool HumdrumFileContent::isLinkedPhraseBegin(HTp token, int index, const string&
 //////////////////////////////
 //
 // HumdrumFileContent::linkPhraseEndpoints --  Allow up to two phrase starts/ends
-//      on a note.
+//      on a note.  The link is stored in the phrase analysis table, and
+//      also in the "auto" HumHash parameters of the tokens if analysis
+//      hash values are active.
 //
 
 void HumdrumFileContent::linkPhraseEndpoints(HTp phrasestart, HTp phraseend) {
+	HumSpanTable& phrases = m_analysisTables.getPhrases();
+	int startid = m_analysisTables.getTokenId(phrasestart);
+	int endid   = m_analysisTables.getTokenId(phraseend);
+
+	int phraseEndCount = phrases.getStartCount(startid);
+	phraseEndCount++;
+	int phraseStartCount = phrases.getEndCount(endid);
+	phraseStartCount++;
+
+	HumNum duration = phraseend->getDurationFromStart()
+			- phrasestart->getDurationFromStart();
+
+	phrases.addLink(startid, endid, phrasestart, phraseend, phraseEndCount,
+			phraseStartCount, duration);
+
+	if (!m_analysisHashValues) {
+		return;
+	}
+
 	string durtag = "phraseDuration";
 	string endtag = "phraseEnd";
-	int phraseEndCount = phrasestart->getValueInt("auto", "phraseEndCount");
-	phraseEndCount++;
 	if (phraseEndCount > 1) {
 		endtag += to_string(phraseEndCount);
 		durtag += to_string(phraseEndCount);
 	}
 	string starttag = "phraseStart";
-	int phraseStartCount = phraseend->getValueInt("auto", "phraseStartCount");
-	phraseStartCount++;
 	if (phraseStartCount > 1) {
 		starttag += to_string(phraseStartCount);
 	}
@@ -25334,8 +32730,6 @@ void HumdrumFileContent::linkPhraseEndpoints(HTp phrasestart, HTp phraseend) {
 	phrasestart->setValue("auto", "id", phrasestart);
 	phraseend->setValue("auto", starttag, phrasestart);
 	phraseend->setValue("auto", "id", phraseend);
-	HumNum duration = phraseend->getDurationFromStart()
-			- phrasestart->getDurationFromStart();
 	phrasestart->setValue("auto", durtag, duration);
 	phrasestart->setValue("auto", "phraseEndCount", to_string(phraseEndCount));
 	phraseend->setValue("auto", "phraseStartCount", to_string(phraseStartCount));
@@ -25352,6 +32746,9 @@ void HumdrumFileContent::linkPhraseEndpoints(HTp phrasestart, HTp phraseend) {
 //
 
 void HumdrumFileContent::analyzeRestPositions(void) {
+	if (!startAnalysis(HumFileAnalysis::PASS_REST_POSITIONS)) {
+		return;
+	}
 	vector<HTp> kernstarts = getKernSpineStartList();
 
 	// Now using verovio automatic rest positions, so not calcualting
@@ -25561,10 +32958,7 @@ bool HumdrumFileContent::checkRestForVerticalPositioning(HTp rest, int baseline)
 		return false;
 	}
 
-	string oloc = to_string(oct);
-
-	rest->setValue("auto", "ploc", dname);
-	rest->setValue("auto", "oloc", oloc);
+	storeRestPosition(rest, pc, oct);
 
 	return true;
 }
@@ -25599,8 +32993,25 @@ void HumdrumFileContent::setRestOnCenterStaffLine(HTp rest, int baseline) {
 		return;
 	}
 
-	string oloc = to_string(oct);
+	storeRestPosition(rest, pc, oct);
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::storeRestPosition -- Store the vertical position of
+//     a rest in the analysis tables, and as ploc/oloc "auto" parameters if
+//     analysis hash values are active.
+//
 
+void HumdrumFileContent::storeRestPosition(HTp rest, int pc, int oct) {
+	m_analysisTables.setRestPosition(m_analysisTables.getTokenId(rest), pc, oct);
+	if (!m_analysisHashValues) {
+		return;
+	}
+	string dname(1, (char)("CDEFGAB"[pc]));
+	string oloc = to_string(oct);
 	rest->setValue("auto", "ploc", dname);
 	rest->setValue("auto", "oloc", oloc);
 }
@@ -25664,10 +33075,7 @@ void HumdrumFileContent::assignVerticalRestPosition(HTp first, HTp second, int b
 		return;
 	}
 
-	string oloc = to_string(oct);
-
-	rest->setValue("auto", "ploc", dname);
-	rest->setValue("auto", "oloc", oloc);
+	storeRestPosition(rest, pc, oct);
 }
 
 
@@ -26068,10 +33476,11 @@ int HumdrumFileContent::getRestPositionAboveNotes(HTp rest, vector<int>& vpos) {
 //
 
 bool HumdrumFileContent::analyzeSlurs(void) {
-	if (m_analyses.m_slurs_analyzed) {
+	if (!startAnalysis(HumFileAnalysis::PASS_SLURS)) {
 		return false;
 	}
-	m_analyses.m_slurs_analyzed = true;
+	HumAnalysisTables& tables = prepareAnalysisTables();
+	tables.getSlurs().resize(tables.getTokenCount());
 	bool output = true;
 	output &= analyzeKernSlurs();
 	output &= analyzeMensSlurs();
@@ -26141,11 +33550,10 @@ bool HumdrumFileContent::analyzeMensSlurs(void) {
 
 	vector<HTp> mensspines;
 	getSpineStartList(mensspines, "**mens");
-	bool output = true;
 	string linkSignifier = m_signifiers.getKernLinkSignifier();
-	for (int i=0; i<(int)mensspines.size(); i++) {
-		output = output && analyzeKernSlurs(mensspines[i], slurstarts, slurends, labels, endings, linkSignifier);
-	}
+	SpineSpanAnalysis analysis = &HumdrumFileContent::analyzeKernSlurs;
+	bool output = analyzeSpineSpans(analysis, m_analysisTables.getSlurs(), mensspines,
+			slurstarts, slurends, labels, endings, linkSignifier);
 	createLinkedSlurs(slurstarts, slurends);
 	return output;
 }
@@ -26212,11 +33620,10 @@ bool HumdrumFileContent::analyzeKernSlurs(void) {
 
 	vector<HTp> kernspines;
 	getSpineStartList(kernspines, "**kern");
-	bool output = true;
 	string linkSignifier = m_signifiers.getKernLinkSignifier();
-	for (int i=0; i<(int)kernspines.size(); i++) {
-		output = output && analyzeKernSlurs(kernspines[i], slurstarts, slurends, labels, endings, linkSignifier);
-	}
+	SpineSpanAnalysis analysis = &HumdrumFileContent::analyzeKernSlurs;
+	bool output = analyzeSpineSpans(analysis, m_analysisTables.getSlurs(), kernspines,
+			slurstarts, slurends, labels, endings, linkSignifier);
 
 	createLinkedSlurs(slurstarts, slurends);
 	return output;
@@ -26310,17 +33717,25 @@ bool HumdrumFileContent::analyzeKernSlurs(HTp spinestart,
 							if (labels[token->getLineIndex()].first) {
 								duration -= labels[token->getLineIndex()].first->getDurationFromStart();
 							}
-							token->setValue("auto", "endingSlurBack", "true");
-							token->setValue("auto", "slurSide", "stop");
-							token->setValue("auto", "slurDuration",
-								token->getDurationToEnd());
+							m_analysisTables.getSlurs().addHanging(m_analysisTables.getTokenId(token),
+									false, token->getDurationToEnd(), -1, true);
+							if (m_analysisHashValues) {
+								token->setValue("auto", "endingSlurBack", "true");
+								token->setValue("auto", "slurSide", "stop");
+								token->setValue("auto", "slurDuration",
+									token->getDurationToEnd());
+							}
 						} else {
 							// This is a slur closing that does not have a matching opening.
-							token->setValue("auto", "hangingSlur", "true");
-							token->setValue("auto", "slurSide", "stop");
-							token->setValue("auto", "slurOpenIndex", to_string(i));
-							token->setValue("auto", "slurDuration",
-								token->getDurationToEnd());
+							m_analysisTables.getSlurs().addHanging(m_analysisTables.getTokenId(token),
+									false, token->getDurationToEnd(), i);
+							if (m_analysisHashValues) {
+								token->setValue("auto", "hangingSlur", "true");
+								token->setValue("auto", "slurSide", "stop");
+								token->setValue("auto", "slurOpenIndex", to_string(i));
+								token->setValue("auto", "slurDuration",
+									token->getDurationToEnd());
+							}
 						}
 					}
 				}
@@ -26345,10 +33760,15 @@ bool HumdrumFileContent::analyzeKernSlurs(HTp spinestart,
 	for (int i=0; i<(int)sluropens.size(); i++) {
 		for (int j=0; j<(int)sluropens[i].size(); j++) {
 			for (int k=0; k<(int)sluropens[i][j].size(); k++) {
-				sluropens[i][j][k]->setValue("", "auto", "hangingSlur", "true");
-				sluropens[i][j][k]->setValue("", "auto", "slurSide", "start");
-				sluropens[i][j][k]->setValue("", "auto", "slurDuration",
-						sluropens[i][j][k]->getDurationFromStart());
+				HTp stok = sluropens[i][j][k];
+				m_analysisTables.getSlurs().addHanging(m_analysisTables.getTokenId(stok),
+						true, stok->getDurationFromStart());
+				if (m_analysisHashValues) {
+					stok->setValue("", "auto", "hangingSlur", "true");
+					stok->setValue("", "auto", "slurSide", "start");
+					stok->setValue("", "auto", "slurDuration",
+							stok->getDurationFromStart());
+				}
 			}
 		}
 	}
@@ -26448,38 +33868,52 @@ bool HumdrumFileContent::isLinkedSlurBegin(HTp token, int index, const string& p
 //////////////////////////////
 //
 // HumdrumFileContent::linkSlurEndpoints --  Allow up to two slur starts/ends
-//      on a note.
+//      on a note.  The link is stored in the slur analysis table, and also
+//      in the "auto" HumHash parameters of the tokens if analysis hash
+//      values are active.
 //
 
 void HumdrumFileContent::linkSlurEndpoints(HTp slurstart, HTp slurend) {
+	HumSpanTable& slurs = m_analysisTables.getSlurs();
+	int startid = m_analysisTables.getTokenId(slurstart);
+	int endid   = m_analysisTables.getTokenId(slurend);
+
+	int slurStartCount = slurs.getStartCount(startid);
+	int opencount = (int)count(slurstart->begin(), slurstart->end(), '(');
+	slurStartCount++;
+	int openEnumeration = opencount - slurStartCount + 1;
+
+	int slurEndNumber = slurs.getEndCount(endid);
+	slurEndNumber++;
+	int closeEnumeration = slurEndNumber;
+
+	HumNum duration = slurend->getDurationFromStart()
+			- slurstart->getDurationFromStart();
+
+	slurs.addLink(startid, endid, slurstart, slurend, openEnumeration,
+			closeEnumeration, duration);
+
+	if (!m_analysisHashValues) {
+		return;
+	}
+
 	string durtag = "slurDuration";
 	string endtag = "slurEndId";
 	string starttag = "slurStartId";
 	string slurstartnumbertag = "slurStartNumber";
 	string slurendnumbertag = "slurEndNumber";
 
-	int slurStartCount = slurstart->getValueInt("auto", "slurStartCount");
-	int opencount = (int)count(slurstart->begin(), slurstart->end(), '(');
-	slurStartCount++;
-	int openEnumeration = opencount - slurStartCount + 1;
-
 	if (openEnumeration > 1) {
 		endtag += to_string(openEnumeration);
 		durtag += to_string(openEnumeration);
 		slurendnumbertag += to_string(openEnumeration);
 	}
 
-	int slurEndNumber = slurend->getValueInt("auto", "slurEndCount");
-	slurEndNumber++;
-	int closeEnumeration = slurEndNumber;
 	if (closeEnumeration > 1) {
 		starttag += to_string(closeEnumeration);
 		slurstartnumbertag += to_string(closeEnumeration);
 	}
 
-	HumNum duration = slurend->getDurationFromStart()
-			- slurstart->getDurationFromStart();
-
 	slurstart->setValue("auto", endtag,            slurend);
 	slurstart->setValue("auto", "id",              slurstart);
 	slurstart->setValue("auto", slurendnumbertag,  closeEnumeration);
@@ -26495,6 +33929,111 @@ void HumdrumFileContent::linkSlurEndpoints(HTp slurstart, HTp slurend) {
 
 
 
+//////////////////////////////
+//
+// HumdrumFileContent::analyzeSonorities -- Fill in the sonority table of
+//     the analysis tables, listing the notes sounding in the **kern spines
+//     on each data line.  If the pitches of tokens are changed after the
+//     analysis, call invalidateAnalysis(HumFileAnalysis::PASS_SONORITIES)
+//     before using the table again.
+//
+
+bool HumdrumFileContent::analyzeSonorities(void) {
+	if (!startAnalysis(HumFileAnalysis::PASS_SONORITIES)) {
+		return true;
+	}
+	HumAnalysisTables& tables = m_analysisTables;
+	HumSonorityTable& sonorities = tables.getSonorities();
+	HumdrumFileContent& infile = *this;
+	sonorities.resize(infile.getLineCount());
+
+	// Pitches of the subtokens of each non-null token, parsed when the
+	// token is first used (-1 for rests and other non-pitches), and
+	// whether the subtoken continues a tie:
+	vector<int> pitchStart(tables.getTokenCount(), -1);
+	vector<int> pitchCount(tables.getTokenCount(), 0);
+	vector<short> pitches;
+	vector<bool> tied;
+
+	for (int i=0; i<infile.getLineCount(); i++) {
+		if (!infile[i].isData()) {
+			continue;
+		}
+		sonorities.addSlice(i);
+		int fieldCount = infile[i].getFieldCount();
+		for (int j=0; j<fieldCount; j++) {
+			HTp token = infile.token(i, j);
+			if (!token->isKern()) {
+				continue;
+			}
+			int id = tables.getTokenId(i, j);
+			int resolved = tables.getNullResolution(id);
+			if (resolved < 0) {
+				continue;
+			}
+			HTp note = tables.getToken(resolved);
+			if (pitchStart[resolved] < 0) {
+				pitchStart[resolved] = (int)pitches.size();
+				int scount = note->getSubtokenCount();
+				for (int k=0; k<scount; k++) {
+					string subtok = note->getSubtoken(k);
+					int base40 = -1;
+					if (subtok.find('r') == string::npos) {
+						base40 = Convert::kernToBase40(subtok);
+					}
+					pitches.push_back((short)(base40 < 0 ? -1 : base40));
+					tied.push_back((subtok.find('_') != string::npos) ||
+							(subtok.find(']') != string::npos));
+				}
+				pitchCount[resolved] = scount;
+			}
+			int start = pitchStart[resolved];
+			for (int k=0; k<pitchCount[resolved]; k++) {
+				if (pitches[start + k] < 0) {
+					continue;
+				}
+				bool attack = (resolved == id) && !tied[start + k];
+				sonorities.addNote(i, note, j, k, pitches[start + k], attack);
+			}
+		}
+	}
+
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getSonorities -- Return the sonority table for the
+//     file, running the analysis if necessary.  Iterating over the table
+//     visits the sonority of each data line.  If lines have been added or
+//     removed since the analysis, the tokens are indexed again, and the
+//     analysis is rerun.
+//
+
+const HumSonorityTable& HumdrumFileContent::getSonorities(void) {
+	// Check the line count of the token index:
+	HumAnalysisTables& tables = getAnalysisTables();
+	requireAnalysis(HumFileAnalysis::PASS_SONORITIES);
+	return tables.getSonorities();
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getSonority -- Return the notes sounding on a line.
+//     The sonority is empty for non-data lines.
+//
+
+HumSonority HumdrumFileContent::getSonority(int line) {
+	return getSonorities().getSonority(line);
+}
+
+
+
+
 
 //////////////////////////////
 //
@@ -26634,6 +34173,64 @@ void HumdrumFileContent::getBaselines(vector<vector<int>>& centerlines) {
 
 
 
+//////////////////////////////
+//
+// HumdrumFileContent::analyzeStrandTable -- Fill in the strand table of
+//     the file (see HumStrandTable) with the tokens of each strand, in the
+//     same order as getStrandStart().  If tokens are added or removed
+//     after the analysis, call
+//     invalidateAnalysis(HumFileAnalysis::PASS_STRAND_TABLE) before using
+//     the table again.
+//
+
+bool HumdrumFileContent::analyzeStrandTable(void) {
+	if (!startAnalysis(HumFileAnalysis::PASS_STRAND_TABLE)) {
+		return true;
+	}
+	HumStrandTable& table = m_strandTable;
+	table.clear();
+	table.setLineCount(getLineCount());
+
+	for (int i=0; i<getSpineCount(); i++) {
+		for (int j=0; j<getStrandCount(i); j++) {
+			table.addStrand(i);
+			HTp current = getStrandStart(i, j);
+			HTp send = getStrandEnd(i, j);
+			while (current) {
+				table.addToken(current);
+				if (current == send) {
+					break;
+				}
+				current = current->getNextToken();
+			}
+		}
+	}
+
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getStrandTable -- Return the strand table of the
+//     file, running the analysis if necessary.
+//
+
+const HumStrandTable& HumdrumFileContent::getStrandTable(void) {
+	HumStrandTable& table = m_strandTable;
+	if (m_analyses.isDone(HumFileAnalysis::PASS_STRAND_TABLE) &&
+			(table.getLineCount() != getLineCount())) {
+		// Lines have been added or removed since the analysis.
+		invalidateAnalysis(HumFileAnalysis::PASS_STRAND_TABLE);
+	}
+	requireAnalysis(HumFileAnalysis::PASS_STRAND_TABLE);
+	return table;
+}
+
+
+
+
 //////////////////////////////
 //
 // HumdrumFileContent::analyzeTextRepetition -- Look for *ij and *Xij markers
@@ -26708,15 +34305,148 @@ bool HumdrumFileContent::analyzeTextRepetition(void) {
 
 
 
+//////////////////////////////
+//
+// HumdrumFileContent::analyzeText -- Fill in the text table of the file
+//     (see HumTextTable) with the syllables and words of each lyric spine
+//     and the notes sung on each syllable.  If the lyrics or rhythms are
+//     changed after the analysis, call
+//     invalidateAnalysis(HumFileAnalysis::PASS_TEXT) before using the
+//     table again.
+//
+
+bool HumdrumFileContent::analyzeText(void) {
+	if (!startAnalysis(HumFileAnalysis::PASS_TEXT)) {
+		return true;
+	}
+	HumdrumFileContent& infile = *this;
+	HumTextTable& table = m_textTable;
+	table.clear();
+	table.setLineCount(infile.getLineCount());
+
+	vector<HTp> sstarts;
+	infile.getSpineStartList(sstarts);
+	vector<int> syllables;
+	for (int i=0; i<(int)sstarts.size(); i++) {
+		HTp start = sstarts[i];
+		if (!(start->isDataType("**text") || start->isDataType("**silbe") ||
+				start->isDataType("**sylb") || start->isDataType("**sylba"))) {
+			continue;
+		}
+		int spine = table.addSpine(start);
+		syllables.clear();
+		HTp current = start->getNextToken();
+		HTp ending = start;
+		while (current) {
+			if (current->isData() && !current->isNull() && !current->empty()) {
+				syllables.push_back(table.addSyllable(spine, current));
+			}
+			ending = current;
+			current = current->getNextToken();
+		}
+
+		// The notes of a syllable end at the line of the next syllable, or
+		// at the end of the spine:
+		HTp first;
+		HTp last;
+		HumNum endtime;
+		for (int j=0; j<(int)syllables.size(); j++) {
+			int endline = ending->getLineIndex();
+			if (j < (int)syllables.size() - 1) {
+				endline = table.getSyllableToken(syllables[j+1])->getLineIndex();
+			}
+			HTp token = table.getSyllableToken(syllables[j]);
+			int count = getSyllableNotes(token, endline, first, last, endtime);
+			table.setNotes(syllables[j], count, first, last, endtime);
+		}
+	}
+
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getTextTable -- Return the text table of the file,
+//     running the analysis if necessary.
+//
+
+const HumTextTable& HumdrumFileContent::getTextTable(void) {
+	HumTextTable& table = m_textTable;
+	if (m_analyses.isDone(HumFileAnalysis::PASS_TEXT) &&
+			(table.getLineCount() != getLineCount())) {
+		// Lines have been added or removed since the analysis.
+		invalidateAnalysis(HumFileAnalysis::PASS_TEXT);
+	}
+	requireAnalysis(HumFileAnalysis::PASS_TEXT);
+	return table;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getSyllableNotes -- Return the number of notes
+//     attacked on a syllable: the attacks in the first **kern spine to the
+//     left of the syllable from the line of the syllable up to (but not
+//     including) endline.  Rests are skipped, and the tied notes of the
+//     last attack are included in the syllable.  first is set to the **kern
+//     token on the line of the syllable, last to the last note or tied note,
+//     and endtime to the end of the last note (or the start of the syllable
+//     if there are no notes).
+//
+
+int HumdrumFileContent::getSyllableNotes(HTp syllable, int endline,
+		HTp& first, HTp& last, HumNum& endtime) {
+	first = NULL;
+	last = NULL;
+	endtime = syllable->getDurationFromStart();
+	HTp current = syllable->getPreviousFieldToken();
+	while (current && !current->isKern()) {
+		current = current->getPreviousFieldToken();
+	}
+	if (!current) {
+		return 0;
+	}
+	first = current;
+	int output = 0;
+	while (current) {
+		if ((!current->isData()) || current->isNull() || current->isRest()) {
+			current = current->getNextToken();
+			continue;
+		}
+		if (current->isNoteAttack()) {
+			if (current->getLineIndex() >= endline) {
+				break;
+			}
+			output++;
+		}
+		last = current;
+		endtime = current->getDurationFromStart() + current->getDuration();
+		current = current->getNextToken();
+	}
+	return output;
+}
+
+
+
 
 
 //////////////////////////////
 //
 // HumdrumFileContent::analyzeKernTies -- Link start and ends of
-//    ties to each other.
+//    ties to each other.  The analysis is only done once for each version
+//    of the file: call createLinesFromTokens() or invalidateAnalysis()
+//    after changing ties to analyze them again.
 //
 
 bool HumdrumFileContent::analyzeKernTies(void) {
+	if (!startAnalysis(HumFileAnalysis::PASS_TIES)) {
+		return true;
+	}
+	HumAnalysisTables& tables = prepareAnalysisTables();
+	tables.getTies().resize(tables.getTokenCount());
 	vector<pair<HTp, int>> linkedtiestarts;
 	vector<pair<HTp, int>> linkedtieends;
 
@@ -26850,21 +34580,37 @@ void HumdrumFileContent::createLinkedTies(vector<pair<HTp, int>>& linkstarts,
 
 //////////////////////////////
 //
-// HumdrumFileContent::linkTieEndpoints --
+// HumdrumFileContent::linkTieEndpoints -- Link the start and end notes
+//     of a tie.  The start and end indexes are the subtoken indexes of
+//     the notes in chords (-1 for single notes).  The link is stored in
+//     the tie analysis table, and also in the "auto" HumHash parameters
+//     of the tokens if analysis hash values are active.
 //
 
 void HumdrumFileContent::linkTieEndpoints(HTp tiestart,
 		int startindex, HTp tieend, int endindex) {
 
+	int startnumber = startindex + 1;
+	int endnumber   = endindex + 1;
+
+   HumNum duration = tieend->getDurationFromStart()
+         - tiestart->getDurationFromStart();
+
+	// Single notes are the first subtoken in the table:
+	m_analysisTables.getTies().addLink(m_analysisTables.getTokenId(tiestart),
+			m_analysisTables.getTokenId(tieend), tiestart, tieend,
+			std::max(startnumber, 1), std::max(endnumber, 1), duration);
+
+	if (!m_analysisHashValues) {
+		return;
+	}
+
    string durtag   = "tieDuration";
    string starttag = "tieStart";
    string endtag   = "tieEnd";
 	string startnum = "tieStartSubtokenNumber";
 	string endnum   = "tieEndSubtokenNumber";
 
-	int startnumber = startindex + 1;
-	int endnumber   = endindex + 1;
-
 	if (tiestart->isChord()) {
 		if (startnumber > 0) {
 			durtag   += to_string(startnumber);
@@ -26891,8 +34637,6 @@ void HumdrumFileContent::linkTieEndpoints(HTp tiestart,
 		tieend->setValue("auto", startnum, to_string(startnumber));
 	}
 
-   HumNum duration = tieend->getDurationFromStart()
-         - tiestart->getDurationFromStart();
    tiestart->setValue("auto", durtag, duration);
 }
 
@@ -27028,6 +34772,322 @@ HumdrumFileContent::~HumdrumFileContent() {
 
 
 
+//////////////////////////////
+//
+// HumdrumFileContent::getAnalysisTables -- Return the typed analysis
+//     results for the file.  The tokens are indexed the first time that
+//     this function is called after reading the file, after
+//     createLinesFromTokens() or invalidateAnalysis() is called, or after
+//     lines have been added or removed.  This check is done for each
+//     call, so it only compares the line count (prepareAnalysisTables()
+//     compares every line).  Changing tokens in place does not change the
+//     index, but call createLinesFromTokens() or invalidateAnalysis()
+//     afterwards so that stale results are cleared from the tables.
+//
+
+HumAnalysisTables& HumdrumFileContent::getAnalysisTables(void) {
+	if ((!m_analyses.isDone(HumFileAnalysis::PASS_TOKEN_INDEX)) ||
+			(m_analysisTables.getLineCount() != getLineCount())) {
+		indexAnalysisTables();
+	}
+	return m_analysisTables;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::prepareAnalysisTables -- Check that the token index
+//     of the analysis tables matches the current contents of the file
+//     before running an analysis, and recreate the index (clearing all
+//     previous analysis results) if not.
+//
+
+HumAnalysisTables& HumdrumFileContent::prepareAnalysisTables(void) {
+	if ((!m_analyses.isDone(HumFileAnalysis::PASS_TOKEN_INDEX)) ||
+			!m_analysisTables.isIndexCurrent(*this)) {
+		indexAnalysisTables();
+	}
+	return m_analysisTables;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::indexAnalysisTables -- Create a new token index for
+//     the analysis tables.  This clears the tables, so the analyses which
+//     store their results in the tables have to be run again.
+//
+
+void HumdrumFileContent::indexAnalysisTables(void) {
+	m_analyses.invalidate(HumFileAnalysis::PASS_TOKEN_INDEX);
+	m_analyses.setDone(HumFileAnalysis::PASS_TOKEN_INDEX);
+	m_analysisTables.indexTokens(*this);
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::requireAnalysis -- Run an analysis pass (and the
+//     passes that it depends on) if it has not already been run on the
+//     current contents of the file.  Returns true if the results of the
+//     pass are available.  The structure and rhythm passes are not run
+//     here, since they are controlled by how the file was read.
+//
+
+bool HumdrumFileContent::requireAnalysis(HumFileAnalysis::Pass pass) {
+	if (pass == HumFileAnalysis::PASS_TOKEN_INDEX) {
+		// Always check that the index matches the file contents.
+		prepareAnalysisTables();
+		return true;
+	}
+	if (m_analyses.isDone(pass)) {
+		return true;
+	}
+	switch (pass) {
+		case HumFileAnalysis::PASS_STRANDS:          analyzeStrands();          break;
+		case HumFileAnalysis::PASS_NULLS:            resolveNullTokens();       break;
+		case HumFileAnalysis::PASS_STROPHES:         analyzeStrophes();         break;
+		case HumFileAnalysis::PASS_OTTAVAS:          analyzeOttavas();          break;
+		case HumFileAnalysis::PASS_KERN_ACCIDENTALS: analyzeKernAccidentals();  break;
+		case HumFileAnalysis::PASS_MENS_ACCIDENTALS: analyzeMensAccidentals();  break;
+		case HumFileAnalysis::PASS_SLURS:            analyzeSlurs();            break;
+		case HumFileAnalysis::PASS_BEAMS:            analyzeBeams();            break;
+		case HumFileAnalysis::PASS_PHRASES:          analyzePhrasings();        break;
+		case HumFileAnalysis::PASS_TIES:             analyzeKernTies();         break;
+		case HumFileAnalysis::PASS_BARLINES:         analyzeBarlines();         break;
+		case HumFileAnalysis::PASS_MEASURES:         analyzeMeasureIndex();     break;
+		case HumFileAnalysis::PASS_REST_POSITIONS:   analyzeRestPositions();    break;
+		case HumFileAnalysis::PASS_NULL_TABLE:       analyzeNullResolution();   break;
+		case HumFileAnalysis::PASS_SONORITIES:       analyzeSonorities();       break;
+		case HumFileAnalysis::PASS_METRIC_GRID:      analyzeMetricGrid();       break;
+		case HumFileAnalysis::PASS_TEXT:             analyzeText();             break;
+		case HumFileAnalysis::PASS_STRAND_TABLE:     analyzeStrandTable();      break;
+		default:
+			break;
+	}
+	return m_analyses.isDone(pass);
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::isAnalyzed -- Return true if the analysis pass has
+//     been run on the current contents of the file.
+//
+
+bool HumdrumFileContent::isAnalyzed(HumFileAnalysis::Pass pass) const {
+	return m_analyses.isDone(pass);
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::invalidateAnalysis -- Mark an analysis pass and all
+//     passes which depend on it as needing to be run again, such as after
+//     changing the contents of tokens.
+//
+
+void HumdrumFileContent::invalidateAnalysis(HumFileAnalysis::Pass pass) {
+	m_analyses.invalidate(pass);
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::startAnalysis -- Called at the start of an analysis
+//     pass: returns false if the pass has already been run; otherwise, the
+//     passes that it depends on are run, the pass is marked as done, and
+//     true is returned.
+//
+
+bool HumdrumFileContent::startAnalysis(HumFileAnalysis::Pass pass) {
+	if (m_analyses.isDone(pass)) {
+		return false;
+	}
+	unsigned int dependencies = HumFileAnalysis::getDependencies(pass);
+	for (int i=0; i<HumFileAnalysis::PASS_COUNT; i++) {
+		if (dependencies & (1u << i)) {
+			requireAnalysis((HumFileAnalysis::Pass)i);
+		}
+	}
+	m_analyses.setDone(pass);
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::setAnalysisHashValues -- Set to false to store
+//     the results of accidental, slur, beam and rest-position analyses
+//     only in the analysis tables (and not also as strings in the "auto"
+//     HumHash namespace of the tokens).
+//
+
+void HumdrumFileContent::setAnalysisHashValues(bool state) {
+	m_analysisHashValues = state;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getAnalysisHashValues -- Return true if analysis
+//     results are also stored in the "auto" HumHash namespace of tokens.
+//
+
+bool HumdrumFileContent::getAnalysisHashValues(void) const {
+	return m_analysisHashValues;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::setAnalysisThreadCount -- Set the number of threads
+//     used to analyze spines in parallel for slur, beam and accidental
+//     analyses.  The default is 1 (serial analysis); a count of 0 or less
+//     will use the number of cores.  The results are identical to the
+//     serial analysis.
+//
+
+void HumdrumFileContent::setAnalysisThreadCount(int count) {
+	m_analysisThreads = count;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getAnalysisThreadCount -- Return the number of threads
+//     used for parallel spine analyses (0 or less for the number of cores).
+//
+
+int HumdrumFileContent::getAnalysisThreadCount(void) const {
+	return m_analysisThreads;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::useAnalysisThreads -- Return true if more than one
+//     thread should be used to analyze the given number of spines.
+//
+
+bool HumdrumFileContent::useAnalysisThreads(int count) const {
+	if (count < 2) {
+		return false;
+	}
+	if (m_analysisThreads == 1) {
+		return false;
+	}
+	if ((m_analysisThreads <= 0) && (std::thread::hardware_concurrency() < 2)) {
+		return false;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::runAnalysisThreads -- Call the analysis function
+//     for each index from 0 to count-1, with each thread pulling the next
+//     unprocessed index.
+//
+
+void HumdrumFileContent::runAnalysisThreads(int count,
+		const std::function<void(int)>& analysis) {
+	int threadCount = m_analysisThreads;
+	if (threadCount <= 0) {
+		threadCount = (int)std::thread::hardware_concurrency();
+	}
+	if (threadCount > count) {
+		threadCount = count;
+	}
+	if (threadCount < 1) {
+		threadCount = 1;
+	}
+
+	std::atomic<int> nextIndex(0);
+	auto worker = [&](void) {
+		int index;
+		while ((index = nextIndex++) < count) {
+			analysis(index);
+		}
+	};
+
+	if (threadCount == 1) {
+		worker();
+	} else {
+		vector<std::thread> pool;
+		pool.reserve(threadCount);
+		for (int i=0; i<threadCount; i++) {
+			pool.emplace_back(worker);
+		}
+		for (int i=0; i<(int)pool.size(); i++) {
+			pool[i].join();
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::analyzeSpineSpans -- Run a slur or beam analysis
+//     on a list of spines.  If parallel analysis is active, each spine
+//     is analyzed in a separate task, and the links to spans in other
+//     spines are collected for each spine and then appended in spine
+//     order so that createLinkedSlurs() and createLinkedBeams() pair
+//     them in the same order as a serial analysis.  Every spine is
+//     analyzed even if the analysis of an earlier one fails, so that the
+//     span table is the same for any number of threads.
+//
+
+bool HumdrumFileContent::analyzeSpineSpans(SpineSpanAnalysis analysis,
+		HumSpanTable& table, vector<HTp>& spinestarts, vector<HTp>& linkstarts,
+		vector<HTp>& linkends, vector<pair<HTp, HTp>>& labels,
+		vector<int>& endings, const string& linksig) {
+	int count = (int)spinestarts.size();
+	bool output = true;
+	if (!useAnalysisThreads(count)) {
+		for (int i=0; i<count; i++) {
+			bool status = (this->*analysis)(spinestarts[i], linkstarts,
+					linkends, labels, endings, linksig);
+			output = output && status;
+		}
+		return output;
+	}
+
+	vector<vector<HTp>> starts(count);
+	vector<vector<HTp>> ends(count);
+	vector<int> status(count, 1);
+	std::mutex tablemutex;
+	table.setMutex(&tablemutex);
+	runAnalysisThreads(count, [&](int index) {
+		status[index] = (this->*analysis)(spinestarts[index], starts[index],
+				ends[index], labels, endings, linksig);
+	});
+	table.setMutex(NULL);
+
+	for (int i=0; i<count; i++) {
+		linkstarts.insert(linkstarts.end(), starts[i].begin(), starts[i].end());
+		linkends.insert(linkends.end(), ends[i].begin(), ends[i].end());
+		output = output && status[i];
+	}
+	return output;
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumFileContent::analyzeRScale --
@@ -27957,7 +36017,7 @@ void HumdrumFileStream::fillUrlBuffer(stringstream& uribuffer,
 //
 
 void HumdrumFileStructure::analyzeStropheMarkers(void) {
-	m_analyses.m_strophes_analyzed = true;
+	m_analyses.setDone(HumFileAnalysis::PASS_STROPHES);
 
 	m_strophes1d.clear();
 	m_strophes2d.clear();
@@ -28027,7 +36087,7 @@ void HumdrumFileStructure::analyzeStropheMarkers(void) {
 //
 
 bool HumdrumFileStructure::analyzeStrophes(void) {
-	if (!m_analyses.m_strands_analyzed) {
+	if (!m_analyses.isDone(HumFileAnalysis::PASS_STRANDS)) {
 		analyzeStrands();
 	}
 	analyzeStropheMarkers();
@@ -28363,15 +36423,16 @@ bool HumdrumFileStructure::readStringCsv(const string& contents,
 //
 
 bool HumdrumFileStructure::analyzeStructure(void) {
-	m_analyses.m_structure_analyzed = false;
-	if (!m_analyses.m_strands_analyzed) {
+	// Reanalyzing the structure invalidates all content analyses:
+	m_analyses.invalidate(HumFileAnalysis::PASS_STRUCTURE);
+	if (!m_analyses.isDone(HumFileAnalysis::PASS_STRANDS)) {
 		if (!analyzeStrands()       ) { return isValid(); }
 	}
 	if (!analyzeGlobalParameters() ) { return isValid(); }
 	if (!analyzeLocalParameters()  ) { return isValid(); }
 	if (!analyzeTokenDurations()   ) { return isValid(); }
 	if (!analyzeTokenDurations()   ) { return isValid(); }
-	m_analyses.m_structure_analyzed = true;
+	m_analyses.setDone(HumFileAnalysis::PASS_STRUCTURE);
 	if (!analyzeRhythmStructure()  ) { return isValid(); }
 	analyzeSignifiers();
 	return isValid();
@@ -28386,8 +36447,8 @@ bool HumdrumFileStructure::analyzeStructure(void) {
 //
 
 bool HumdrumFileStructure::analyzeStructureNoRhythm(void) {
-	m_analyses.m_structure_analyzed = true;
-	if (!m_analyses.m_strands_analyzed) {
+	m_analyses.setDone(HumFileAnalysis::PASS_STRUCTURE);
+	if (!m_analyses.isDone(HumFileAnalysis::PASS_STRANDS)) {
 		if (!analyzeStrands()          ) { return isValid(); }
 	}
 	if (!analyzeGlobalParameters() ) { return isValid(); }
@@ -28405,7 +36466,7 @@ bool HumdrumFileStructure::analyzeStructureNoRhythm(void) {
 //
 
 bool HumdrumFileStructure::analyzeRhythmStructure(void) {
-	m_analyses.m_rhythm_analyzed = true;
+	m_analyses.setDone(HumFileAnalysis::PASS_RHYTHM);
 	setLineRhythmAnalyzed();
 	if (!isStructureAnalyzed()) {
 		if (!analyzeStructureNoRhythm()) { return isValid(); }
@@ -29458,7 +37519,7 @@ void HumdrumFileStructure::assignLineDurations(void) {
 bool HumdrumFileStructure::assignDurationsToNonRhythmicTrack(
 		HTp endtoken, HTp current) {
 
-	string spineinfo = endtoken->getSpineInfo();
+	const string& spineinfo = endtoken->getSpineInfo();
 	HTp token = endtoken;
 
 	while (token) {
@@ -29625,7 +37686,7 @@ void HumdrumFileStructure::checkForLocalParameters(HTp token,
 //
 
 bool HumdrumFileStructure::analyzeStrands(void) {
-	m_analyses.m_strands_analyzed = true;
+	m_analyses.setDone(HumFileAnalysis::PASS_STRANDS);
 	int spines = getSpineCount();
 	m_strand1d.clear();
 	m_strand2d.clear();
@@ -29663,10 +37724,10 @@ bool HumdrumFileStructure::analyzeStrands(void) {
 //
 
 void HumdrumFileStructure::resolveNullTokens(void) {
-	if (m_analyses.m_nulls_analyzed) {
+	if (m_analyses.isDone(HumFileAnalysis::PASS_NULLS)) {
 		return;
 	}
-	m_analyses.m_nulls_analyzed = true;
+	m_analyses.setDone(HumFileAnalysis::PASS_NULLS);
 	if (!areStrandsAnalyzed()) {
 		analyzeStrands();
 	}
@@ -31622,13 +39683,12 @@ bool HumdrumLine::analyzeTracks(string& err) {
 		return !err.size();
 	}
 
-	string info;
 	int track;
 	int maxtrack = 0;
 	int i, j, k;
 
 	for (i=0; i<(int)m_tokens.size(); i++) {
-		info = m_tokens[i]->getSpineInfo();
+		const string& info = m_tokens[i]->getSpineInfo();
 		track = 0;
 		for (j=0; j<(int)info.size(); j++) {
 			if (!isdigit(info[j])) {
@@ -32532,12 +40592,13 @@ int HumdrumLine::isExpansionList(int startTrack, int stopTrack) {
 //
 
 ostream& operator<<(ostream& out, HumdrumLine& line) {
-	out << (string)line;
+	// print through a reference so that the line is not copied:
+	out << static_cast<const string&>(line);
 	return out;
 }
 
 ostream& operator<< (ostream& out, HLp line) {
-	out << (string)(*line);
+	out << static_cast<const string&>(*line);
 	return out;
 }
 
@@ -33297,6 +41358,10 @@ HumNum HumdrumToken::getSlurDuration(HumNum scale) {
 	if (!isDataTypeLike("**kern")) {
 		return 0;
 	}
+	HumSpanTable* slurs = getSlurTable();
+	if (slurs) {
+		return slurs->getDuration(getSlurTableId());
+	}
 	if (isDefined("auto", "slurDuration")) {
 		return getValueFraction("auto", "slurDuration");
 	} else if (isDefined("auto", "slurEnd")) {
@@ -33469,6 +41534,11 @@ void HumdrumToken::setSpineInfo(const string& spineinfo) {
 }
 
 
+void HumdrumToken::setSpineInfo(const std::shared_ptr<const string>& spineinfo) {
+	m_address.setSpineInfo(spineinfo);
+}
+
+
 
 //////////////////////////////
 //
@@ -33477,7 +41547,7 @@ void HumdrumToken::setSpineInfo(const string& spineinfo) {
 // @SEEALTO: setSpineInfo
 //
 
-string HumdrumToken::getSpineInfo(void) const {
+const string& HumdrumToken::getSpineInfo(void) const {
 	return m_address.getSpineInfo();
 }
 
@@ -33709,7 +41779,7 @@ HTp HumdrumToken::getNextToken(int index) const {
 //
 
 vector<HumdrumToken*> HumdrumToken::getNextTokens(void) const {
-	return m_nextTokens;
+	return m_nextTokens.toVector();
 }
 
 
@@ -33721,7 +41791,7 @@ vector<HumdrumToken*> HumdrumToken::getNextTokens(void) const {
 //
 
 vector<HumdrumToken*> HumdrumToken::getPreviousTokens(void) const {
-	return m_previousTokens;
+	return m_previousTokens.toVector();
 }
 
 
@@ -34987,20 +43057,19 @@ int HumdrumToken::hasVisibleAccidental(int subtokenIndex) const {
 		return -1;
 	}
 	if (isKern()) {
-		if (!humfile->getValueBool("auto", "accidentalAnalysis**kern")) {
-			int status = humfile->analyzeKernAccidentals();
-			if (!status) {
-				return -1;
-			}
+		if (!humfile->requireAnalysis(HumFileAnalysis::PASS_KERN_ACCIDENTALS)) {
+			return -1;
 		}
 	} else if (isMens()) {
-		if (!humfile->getValueBool("auto", "accidentalAnalysis**mens")) {
-			int status = humfile->analyzeMensAccidentals();
-			if (!status) {
-				return -1;
-			}
+		if (!humfile->requireAnalysis(HumFileAnalysis::PASS_MENS_ACCIDENTALS)) {
+			return -1;
 		}
 	}
+	HumAnalysisTables& tables = humfile->getAnalysisTables();
+	int flags = tables.getAccidentalFlags(tables.getTokenId((HTp)this), subtokenIndex);
+	if (flags >= 0) {
+		return (flags & HumAnalysisTables::ACCID_VISUAL) ? 1 : 0;
+	}
 	return getValueBool("auto", to_string(subtokenIndex), "visualAccidental");
 }
 
@@ -35008,8 +43077,8 @@ int HumdrumToken::hasVisibleAccidental(int subtokenIndex) const {
 
 //////////////////////////////
 //
-// HumdrumToken::hasVisibleAccidental -- Returns true if the accidental
-//    of a **kern note is viewable if rendered to graphical notation.
+// HumdrumToken::hasCautionaryAccidental -- Returns true if the accidental
+//    of a **kern note is a cautionary accidental.
 // 	return values:
 //      0  = false;
 //      1  = true;
@@ -35026,20 +43095,19 @@ int HumdrumToken::hasCautionaryAccidental(int subtokenIndex) const {
 		return -1;
 	}
 	if (isKern()) {
-		if (!humfile->getValueBool("auto", "accidentalAnalysis**kern")) {
-			int status = humfile->analyzeKernAccidentals();
-			if (!status) {
-				return -1;
-			}
+		if (!humfile->requireAnalysis(HumFileAnalysis::PASS_KERN_ACCIDENTALS)) {
+			return -1;
 		}
 	} else if (isMens()) {
-		if (!humfile->getValueBool("auto", "accidentalAnalysis**mens")) {
-			int status = humfile->analyzeMensAccidentals();
-			if (!status) {
-				return -1;
-			}
+		if (!humfile->requireAnalysis(HumFileAnalysis::PASS_MENS_ACCIDENTALS)) {
+			return -1;
 		}
 	}
+	HumAnalysisTables& tables = humfile->getAnalysisTables();
+	int flags = tables.getAccidentalFlags(tables.getTokenId((HTp)this), subtokenIndex);
+	if (flags >= 0) {
+		return (flags & HumAnalysisTables::ACCID_CAUTIONARY) ? 1 : 0;
+	}
 	return getValueBool("auto", to_string(subtokenIndex), "cautionaryAccidental");
 }
 
@@ -36870,12 +44938,16 @@ ostream& printSequence(vector<HTp>& sequence, ostream& out) {
 //////////////////////////////
 //
 // HumdrumToken::getSlurStartToken -- Return a pointer to the token
-//     which starts the given slur.  Returns NULL if no start.  Assumes that
-//     HumdrumFileContent::analyzeKernSlurs() has already been run.
+//     which starts the given slur.  Returns NULL if no start.  The slur
+//     analysis of the file is run if it has not been done yet.
 //				<parameter key="slurEnd" value="HT_140366146702320" idref=""/>
 //
 
 HTp HumdrumToken::getSlurStartToken(int number) {
+	HumSpanTable* slurs = getSlurTable();
+	if (slurs) {
+		return slurs->getStartToken(getSlurTableId(), number);
+	}
 	string tag = "slurStartId";
 	if (number > 1) {
 		tag += to_string(number);
@@ -36892,6 +44964,10 @@ HTp HumdrumToken::getSlurStartToken(int number) {
 //
 
 int HumdrumToken::getSlurStartNumber(int endnumber) {
+	HumSpanTable* slurs = getSlurTable();
+	if (slurs) {
+		return slurs->getStartNumber(getSlurTableId(), endnumber);
+	}
 	string tag = "slurStartNumber";
 	if (endnumber > 1) {
 		tag += to_string(endnumber);
@@ -36905,12 +44981,16 @@ int HumdrumToken::getSlurStartNumber(int endnumber) {
 //////////////////////////////
 //
 // HumdrumToken::getSlurEndToken -- Return a pointer to the token
-//     which ends the given slur.  Returns NULL if no end.  Assumes that
-//     HumdrumFileContent::analyzeKernSlurs() has already been run.
+//     which ends the given slur.  Returns NULL if no end.  The slur
+//     analysis of the file is run if it has not been done yet.
 //				<parameter key="slurStart" value="HT_140366146702320" idref=""/>
 //
 
 HTp HumdrumToken::getSlurEndToken(int number) {
+	HumSpanTable* slurs = getSlurTable();
+	if (slurs) {
+		return slurs->getEndToken(getSlurTableId(), number);
+	}
 	string tag = "slurEnd";
 	if (number > 1) {
 		tag += to_string(number);
@@ -36921,15 +45001,69 @@ HTp HumdrumToken::getSlurEndToken(int number) {
 
 
 
+//////////////////////////////
+//
+// HumdrumToken::getSlurTable -- Return the slur analysis table of the
+//     file containing the token (running the slur analysis if it has not
+//     been done yet), or NULL if the token is not in a file or not in the
+//     table (in which case the "auto" HumHash parameters of the token should
+//     be used instead).
+//
+
+HumSpanTable* HumdrumToken::getSlurTable(void) {
+	HLp owner = getOwner();
+	if (!owner) {
+		return NULL;
+	}
+	HumdrumFile* infile = owner->getOwner();
+	if (!infile) {
+		return NULL;
+	}
+	if (!infile->requireAnalysis(HumFileAnalysis::PASS_SLURS)) {
+		return NULL;
+	}
+	HumAnalysisTables& tables = infile->getAnalysisTables();
+	if (tables.getTokenId(this) < 0) {
+		return NULL;
+	}
+	return &tables.getSlurs();
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumToken::getSlurTableId -- Return the index of the token in the
+//     analysis tables of its file.
+//
+
+int HumdrumToken::getSlurTableId(void) {
+	HLp owner = getOwner();
+	if (!owner) {
+		return -1;
+	}
+	HumdrumFile* infile = owner->getOwner();
+	if (!infile) {
+		return -1;
+	}
+	return infile->getAnalysisTables().getTokenId(this);
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumToken::getPhraseStartToken -- Return a pointer to the token
-//     which starts the given phrase.  Returns NULL if no start.  Assumes that
-//     HumdrumFileContent::analyzeKernPhrasings() has already been run.
+//     which starts the given phrase.  Returns NULL if no start.  The phrase
+//     analysis of the file is run if it has not been done yet.
 //				<parameter key="phraseEnd" value="HT_140366146702320" idref=""/>
 //
 
 HTp HumdrumToken::getPhraseStartToken(int number) {
+	HumSpanTable* phrases = getPhraseTable();
+	if (phrases) {
+		return phrases->getStartToken(getSlurTableId(), number);
+	}
 	string tag = "phraseStart";
 	if (number > 1) {
 		tag += to_string(number);
@@ -36942,12 +45076,16 @@ HTp HumdrumToken::getPhraseStartToken(int number) {
 //////////////////////////////
 //
 // HumdrumToken::getPhraseEndToken -- Return a pointer to the token
-//     which ends the given phrase.  Returns NULL if no end.  Assumes that
-//     HumdrumFileContent::analyzeKernPhrasings() has already been run.
+//     which ends the given phrase.  Returns NULL if no end.  The phrase
+//     analysis of the file is run if it has not been done yet.
 //				<parameter key="phraseStart" value="HT_140366146702320" idref=""/>
 //
 
 HTp HumdrumToken::getPhraseEndToken(int number) {
+	HumSpanTable* phrases = getPhraseTable();
+	if (phrases) {
+		return phrases->getEndToken(getSlurTableId(), number);
+	}
 	string tag = "phraseEnd";
 	if (number > 1) {
 		tag += to_string(number);
@@ -36957,6 +45095,35 @@ HTp HumdrumToken::getPhraseEndToken(int number) {
 
 
 
+//////////////////////////////
+//
+// HumdrumToken::getPhraseTable -- Return the phrase analysis table of the
+//     file containing the token (running the phrase analysis if it has
+//     not been done yet), or NULL if the token is not in a file or not in
+//     the table.
+//
+
+HumSpanTable* HumdrumToken::getPhraseTable(void) {
+	HLp owner = getOwner();
+	if (!owner) {
+		return NULL;
+	}
+	HumdrumFile* infile = owner->getOwner();
+	if (!infile) {
+		return NULL;
+	}
+	if (!infile->requireAnalysis(HumFileAnalysis::PASS_PHRASES)) {
+		return NULL;
+	}
+	HumAnalysisTables& tables = infile->getAnalysisTables();
+	if (tables.getTokenId(this) < 0) {
+		return NULL;
+	}
+	return &tables.getPhrases();
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumToken::resolveNull --
@@ -45501,7 +53668,9 @@ char& MuseRecordBasic::getColumn(int columnNumber) {
 		cerr << "Error trying to access column: " << columnNumber  << endl;
 		cerr << "CURRENT DATA: ===============================" << endl;
 		cerr << (*this);
-		static char x = ' ';
+		// dummy column (one per thread, since callers may write to it):
+		static thread_local char x;
+		x = ' ';
 		return x;
 	} else if (realindex >= (int)m_recordString.size()) {
 		m_recordString.resize(realindex+1);
@@ -46476,7 +54645,7 @@ ostream& operator<<(ostream& out, MuseRecordBasic* aRecord) {
 class MxmlMeasure;
 class MxmlPart;
 
-int MxmlEvent::m_counter = 0;
+std::atomic<int> MxmlEvent::m_counter(0);
 
 ////////////////////////////////////////////////////////////////////////////
 
@@ -46558,8 +54727,7 @@ void MxmlEvent::makeDummyRest(MxmlMeasure* owner, HumNum starttime,
 	// m_node remains null
 	// m_links remains empty
 	m_linked = false;
-	m_sequence = -m_counter;
-	m_counter++;
+	m_sequence = -m_counter++;
 	m_voice = 1;  // don't know what the original voice number is
 	m_voiceindex = voiceindex;
 	m_staff = staffindex + 1;
@@ -50901,6 +59069,8 @@ bool NoteGrid::load(HumdrumFile& infile) {
 		if (current.size() != kernspines.size()) {
 			cerr << "Error: Unequal vector sizes " << current.size()
 			     << " compared to " << kernspines.size() << endl;
+			// don't leave a partially filled grid:
+			clear();
 			return false;
 		}
 		for (int j=0; j<(int)current.size(); j++) {
@@ -51712,6 +59882,7 @@ Options::Options(const Options& options) {
 	m_processedQ = options.m_processedQ;
 	m_suppressQ = options.m_suppressQ;
 	m_optionsArgQ = options.m_optionsArgQ;
+	m_exitQ = options.m_exitQ;
 	for (int i=0; i<(int)options.m_optionRegister.size(); i++) {
 		Option_register* orr = new Option_register(*options.m_optionRegister[i]);
 		m_optionRegister.push_back(orr);
@@ -51749,6 +59920,7 @@ Options& Options::operator=(const Options& options) {
 	m_processedQ = options.m_processedQ;
 	m_suppressQ = options.m_suppressQ;
 	m_optionsArgQ = options.m_optionsArgQ;
+	m_exitQ = options.m_exitQ;
 
 	for (int i=0; i<(int)m_optionRegister.size(); i++) {
 		delete m_optionRegister[i];
@@ -52237,6 +60409,19 @@ void Options::reset(void) {
 
 
 
+//////////////////////////////
+//
+// Options::setExitOnError -- Set to false to store an unknown-option error
+//     in the parse errors (see hasParseError()) rather than exiting the
+//     program.  The --options option is also ignored in that case.
+//
+
+void Options::setExitOnError(bool state) {
+	m_exitQ = state;
+}
+
+
+
 //////////////////////////////
 //
 // Options::getFlag -- Set the character which is usually set to a dash.
@@ -52558,8 +60743,10 @@ int Options::getRegIndex(const string& optionName) {
 
 	if (optionName == "options") {
 		#ifndef __EMSCRIPTEN__
-		print(cout);
-		exit(0);
+		if (m_exitQ) {
+			print(cout);
+			exit(0);
+		}
 		#endif
 		return -1;
 	}
@@ -52568,6 +60755,9 @@ int Options::getRegIndex(const string& optionName) {
 	if (it == m_optionList.end()) {
 		if (m_options_error_checkQ) {
 			m_error << "Error: unknown option \"" << optionName << "\"." << endl;
+			if (!m_exitQ) {
+				return -1;
+			}
 			#ifndef __EMSCRIPTEN__
 				cerr << "Error: unknown option \"" << optionName << "\"." << endl;
 			#endif
@@ -53301,23 +61491,25 @@ PixelColor PixelColor::getColor(const string& colorstring) {
 	// check for decimal strings with spaces around numbers: "255 255 255"
 	if ((colorstring.find(' ') != string::npos) ||
 		 (colorstring.find('\t') != string::npos)) {
-		char buffer[256] = {0};
-		strcpy(buffer, colorstring.c_str());
-		char* ptr = strtok(buffer, " \t\n:;");
+		const char* separators = " \t\n:;";
+		vector<string> values;
+		size_t start = colorstring.find_first_not_of(separators);
+		while ((start != string::npos) && (values.size() < 3)) {
+			size_t end = colorstring.find_first_of(separators, start);
+			values.push_back(colorstring.substr(start, end - start));
+			start = colorstring.find_first_not_of(separators, end);
+		}
 		int tred   = -1;
 		int tgreen = -1;
 		int tblue  = -1;
-		if (ptr != NULL) {
-			sscanf(ptr, "%d", &tred);
-			ptr = strtok(NULL, " \t\n;:");
+		if (values.size() > 0) {
+			sscanf(values[0].c_str(), "%d", &tred);
 		}
-		if (ptr != NULL) {
-			sscanf(ptr, "%d", &tgreen);
-			ptr = strtok(NULL, " \t\n;:");
+		if (values.size() > 1) {
+			sscanf(values[1].c_str(), "%d", &tgreen);
 		}
-		if (ptr != NULL) {
-			sscanf(ptr, "%d", &tblue);
-			ptr = strtok(NULL, " \t\n;:");
+		if (values.size() > 2) {
+			sscanf(values[2].c_str(), "%d", &tblue);
 		}
 		if (tred > 0 && tgreen > 0 && tblue > 0) {
 			output.setColor(tred, tgreen, tblue);
@@ -54795,17 +62987,7 @@ void Tool_1520ify::clearStates(void) {
 //
 
 string Tool_1520ify::getDate(void) {
-	auto now = std::chrono::system_clock::now();
-	std::time_t now_time = std::chrono::system_clock::to_time_t(now);
-	std::tm* local_time = std::localtime(&now_time);
-	int year = local_time->tm_year + 1900;
-	int month = local_time->tm_mon + 1; 
-	int day = local_time->tm_mday;
-	stringstream ss;
-	ss << year << "/";
-	ss << std::setw(2) << std::setfill('0') << month << "/";
-	ss << std::setw(2) << std::setfill('0') << day;
-	return ss.str();
+	return Convert::getCurrentDate();
 }
 
 
@@ -54816,11 +62998,7 @@ string Tool_1520ify::getDate(void) {
 //
 
 int Tool_1520ify::getYear(void) {
-	auto now = std::chrono::system_clock::now();
-	std::time_t now_time = std::chrono::system_clock::to_time_t(now);
-	std::tm* local_time = std::localtime(&now_time);
-	int year = local_time->tm_year + 1900;
-	return year;
+	return stoi(Convert::getCurrentDate("%Y"));
 }
 
 
@@ -54888,7 +63066,6 @@ bool Tool_addic::run(HumdrumFile& infile) {
 //
 
 void Tool_addic::initialize(void) {
-	m_instrumentList = Convert::getInstrumentList();
 	m_fixQ = getBoolean("fix");
 }
 
@@ -55092,18 +63269,10 @@ string Tool_addic::getInstrumentClass(const string& code) {
 		code2   = hre.getMatch(3);
 	}
 
-	string class1 = "";
+	string class1 = Convert::getInstrumentClass(code1);
 	string class2 = "";
-
-	for (int i=0; i<(int)m_instrumentList.size(); i++) {
-		if (code1 == m_instrumentList[i].first) {
-			class1 = m_instrumentList[i].second;
-		}
-		if (count == 2) {
-			if (code2 == m_instrumentList[i].first) {
-				class2 = m_instrumentList[i].second;
-			}
-		}
+	if (count == 2) {
+		class2 = Convert::getInstrumentClass(code2);
 	}
 
 	if (count == 1) {
@@ -56299,14 +64468,9 @@ void Tool_autoaccid::addAccidentalQualifications(HumdrumFile& infile) {
 void Tool_autoaccid::addAccidentalInfo(HTp token) {
 	vector<string> subtokens;
 	subtokens = token->getSubtokens();
-	if (subtokens.size() == 1) {
-		bool visual = token->getValueBool("auto", "0", "visualAccidental");
-		subtokens[0] = setVisualState(subtokens[0], visual);
-	} else {
-		for (int i=0; i<(int)subtokens.size(); i++) {
-			bool visual = token->getValueBool("auto", to_string(i+1), "visualAccidental");
-			subtokens[i] = setVisualState(subtokens[i], visual);
-		}
+	for (int i=0; i<(int)subtokens.size(); i++) {
+		bool visual = token->hasVisibleAccidental(i) > 0;
+		subtokens[i] = setVisualState(subtokens[i], visual);
 	}
 	string text;
 	for (int i=0; i<(int)subtokens.size(); i++) {
@@ -57240,13 +65404,15 @@ void Tool_autobeam::addBeams(HumdrumFile& infile) {
 //////////////////////////////
 //
 // Tool_autobeam::initialize -- extract time signature lines for
-//    each **kern spine in file.
+//    each **kern spine in file.  All analysis data is reset so that
+//    the tool can be run again on another file.
 //
 
 void Tool_autobeam::initialize(HumdrumFile& infile) {
 	m_splitcount = 0;
 	m_kernspines = infile.getKernLikeSpineStartList();
 	vector<HTp>& ks = m_kernspines;
+	m_timesigs.clear();
 	m_timesigs.resize(infile.getTrackCount() + 1);
 	for (int i=0; i<(int)ks.size(); i++) {
 		infile.getTimeSigs(m_timesigs[ks[i]->getTrack()], ks[i]->getTrack());
@@ -57829,8 +65995,8 @@ void Tool_autocadence::addMatchToScore(HumdrumFile& infile, int matchIndex) {
 	int nindex = coord.at(2);
 	auto& info = m_sequences.at(vindex).at(pindex).at(nindex);
 	// get<0> is the sequence string.
-	HTp startL = get<1>(info);  // starting token of cadence formula, lower voice
-	HTp startU = get<2>(info);  // starting token of cadence formula, upper voice
+	HTp startL = std::get<1>(info);  // starting token of cadence formula, lower voice
+	HTp startU = std::get<2>(info);  // starting token of cadence formula, upper voice
 	if (startL == NULL) {
 		cerr << "WARNING: startL is NULL" << endl;
 		return;
@@ -57840,7 +66006,7 @@ void Tool_autocadence::addMatchToScore(HumdrumFile& infile, int matchIndex) {
 		return;
 	}
 	int lindex = startL->getLineIndex();
-	vector<int>& dindexes = get<3>(info);
+	vector<int>& dindexes = std::get<3>(info);
 	if (dindexes.empty()) {
 		cerr << "WARNING: dindexes is empty" << endl;
 		return;
@@ -57974,7 +66140,7 @@ bool Tool_autocadence::getCadenceEndSliceNotes(HTp& endL, HTp& endU, int count,
 			lineIndex++;
 			continue;
 		}
-		string& interval = get<0>(m_intervals.at(lineIndex).at(vindex).at(pindex));
+		string& interval = std::get<0>(m_intervals.at(lineIndex).at(vindex).at(pindex));
 		if (!interval.empty()) {
 			counter++;
 			if (counter == count) {
@@ -58075,7 +66241,7 @@ void Tool_autocadence::printMatchCount(void) {
 	int subcount = 0;
 	for (int i=0; i<(int)m_matches.size(); i++) {
 		auto& info = m_sequences.at(m_matches[i][0]).at(m_matches[i][1]).at(m_matches[i][2]);
-		vector<int>& matches = get<3>(info);
+		vector<int>& matches = std::get<3>(info);
 		subcount += (int)matches.size() - 1;
 	}
 
@@ -58110,10 +66276,10 @@ void Tool_autocadence::searchIntervalSequences(void) {
 	for (int i=0; i<(int)m_sequences.size(); i++) {
 		for (int j=0; j<(int)m_sequences[i].size(); j++) {
 			for (int k=0; k<(int)m_sequences[i][j].size(); k++) {
-				string& feature = get<0>(m_sequences.at(i).at(j).at(k));
+				string& feature = std::get<0>(m_sequences.at(i).at(j).at(k));
 				for (int m=0; m<(int)m_definitions.size(); m++) {
 					if (hre.search(feature, m_definitions.at(m).m_regex)) {
-						vector<int>& matches = get<3>(m_sequences.at(i).at(j).at(k));
+						vector<int>& matches = std::get<3>(m_sequences.at(i).at(j).at(k));
 						// cerr << "FOUND MATCH: " << m << endl;
 						matches.push_back(m);
 						m_matches.emplace_back(vector<int>{i, j, k});
@@ -58141,7 +66307,7 @@ void Tool_autocadence::prepareDefinitionList(set<int>& list) {
 		int& pindex = m_matches.at(i).at(1);
 		int& nindex = m_matches.at(i).at(2);
 		auto& info  = m_sequences.at(vindex).at(pindex).at(nindex);
-		vector<int>& matches = get<3>(info);
+		vector<int>& matches = std::get<3>(info);
 		for (int m=0; m<(int)matches.size(); m++) {
 			int dindex = matches.at(m);
 			list.insert(dindex);
@@ -58181,7 +66347,7 @@ void Tool_autocadence::printSequenceMatches(void) {
 		int& pindex = m_matches.at(i).at(1);
 		int& nindex = m_matches.at(i).at(2);
 		auto& info = m_sequences.at(vindex).at(pindex).at(nindex);
-		vector<int>& matches = get<3>(info);
+		vector<int>& matches = std::get<3>(info);
 		if (matches.empty()) {
 			continue;
 		}
@@ -58202,7 +66368,7 @@ void Tool_autocadence::printSequenceMatches(void) {
 			}
 		}
 		m_humdrum_text << "\t";
-		string& sequence = get<0>(info);
+		string& sequence = std::get<0>(info);
 		m_humdrum_text << sequence << endl;
 	}
 }
@@ -58218,8 +66384,8 @@ void Tool_autocadence::printSequenceMatches2(void) {
 			}
 			m_humdrum_text << "# Matches for voices " << (i+1) << " TO " << (i+1+j+1) << endl;
 			for (int k=0; k<(int)m_sequences.at(i).at(j).size(); k++) {
-				string& sequence = get<0>(m_sequences.at(i).at(j).at(k));
-				vector<int>& matches = get<3>(m_sequences.at(i).at(j).at(k));
+				string& sequence = std::get<0>(m_sequences.at(i).at(j).at(k));
+				vector<int>& matches = std::get<3>(m_sequences.at(i).at(j).at(k));
 				if (matches.empty()) {
 					continue;
 				}
@@ -58268,7 +66434,7 @@ void Tool_autocadence::printSequenceInfo(void) {
 			m_humdrum_text << endl;
 			m_humdrum_text << "# Sequences for voices " << (i+1) << " TO " << (i+1+j+1) << endl;
 			for (int k=0; k<(int)m_sequences[i][j].size(); k++) {
-				string& sequence = get<0>(m_sequences[i][j][k]);
+				string& sequence = std::get<0>(m_sequences[i][j][k]);
 				m_humdrum_text << sequence << endl;
 			}
 		}
@@ -58338,12 +66504,12 @@ void Tool_autocadence::prepareSinglePairSequences(HumdrumFile& infile, int vinde
 		if (!infile[i].isData()) {
 			continue;
 		}
-		string interval = get<0>(m_intervals.at(i).at(vindex).at(pindex));
+		string interval = std::get<0>(m_intervals.at(i).at(vindex).at(pindex));
 		if (interval.empty()) {
 			continue;
 		}
-		HTp lower = get<1>(m_intervals.at(i).at(vindex).at(pindex));
-		HTp upper = get<2>(m_intervals.at(i).at(vindex).at(pindex));
+		HTp lower = std::get<1>(m_intervals.at(i).at(vindex).at(pindex));
+		HTp upper = std::get<2>(m_intervals.at(i).at(vindex).at(pindex));
 		string sequence = generateSequenceString(infile, i, vindex, pindex);
 // cerr << "ADDING SEQUENCE: " << sequence << endl;
 		m_sequences.at(vindex).at(pindex).emplace_back(sequence, lower, upper, vector<int>{});
@@ -58371,7 +66537,7 @@ void Tool_autocadence::prepareSinglePairSequences(HumdrumFile& infile, int vinde
 string Tool_autocadence::generateSequenceString(HumdrumFile& infile, int lindex, int vindex, int pindex) {
 	vector<string> pieces;
 	for (int i=lindex; i<infile.getLineCount(); i++) {
-		string interval = get<0>(m_intervals.at(i).at(vindex).at(pindex));
+		string interval = std::get<0>(m_intervals.at(i).at(vindex).at(pindex));
 		if (interval.empty()) {
 			continue;
 		}
@@ -58577,7 +66743,7 @@ void Tool_autocadence::printIntervalDataLine(HumdrumFile& infile, int index, int
 			int vindex = m_trackToVoiceIndex.at(track);
 			int tcount = kcount - vindex - 1;
 			for (int j=0; j<tcount; j++) {
-				string value = get<0>(m_intervals.at(index).at(vindex).at(j));
+				string value = std::get<0>(m_intervals.at(index).at(vindex).at(j));
 				if (value == "") {
 					value = ".";
 				}
@@ -58628,7 +66794,7 @@ void Tool_autocadence::printIntervalDataLineScore(HumdrumFile& infile, int index
 			int vindex = m_trackToVoiceIndex.at(track);
 			int tcount = kcount - vindex - 1;
 			for (int j=0; j<tcount; j++) {
-				string value = get<0>(m_intervals.at(index).at(vindex).at(j));
+				string value = std::get<0>(m_intervals.at(index).at(vindex).at(j));
 				if (value == "") {
 					value = ".";
 				}
@@ -58798,8 +66964,8 @@ void Tool_autocadence::prepareIntervalInfo(HumdrumFile& infile) {
 			int pcount = vcount - j - 1;
 			m_intervals[i][j].resize(pcount);
 			for (int k=0; k<pcount; k++) {
-				get<1>(m_intervals[i][j][k]) = NULL;
-				get<2>(m_intervals[i][j][k]) = NULL;
+				std::get<1>(m_intervals[i][j][k]) = NULL;
+				std::get<2>(m_intervals[i][j][k]) = NULL;
 			}
 		}
 	}
@@ -59975,7 +68141,7 @@ void Tool_autostem::getNotePositions(vector<vector<vector<int> > >& notepos,
 
 void Tool_autostem::processKernTokenStems(HumdrumFile& infile,
 		vector<vector<int> >& baseline, int row, int col) {
-	exit(1);
+	// not implemented: see processKernTokenStemsSimpleModel().
 }
 
 
@@ -60396,8 +68562,8 @@ bool Tool_autostem::getBeamState(vector<vector<string > >& beams,
 				// grace notes;
 				countBeamStuff(infile.token(i, j)->c_str(), start, stop, flagr, flagl);
 				if ((start != 0) && (stop != 0)) {
-					cerr << "Funny error in grace note beam calculation" << endl;
-					exit(1);
+					m_error_text << "Funny error in grace note beam calculation" << endl;
+					return false;
 				}
 				if (start > 7) {
 					cerr << "Too many beam starts" << endl;
@@ -60437,8 +68603,8 @@ bool Tool_autostem::getBeamState(vector<vector<string > >& beams,
 				}
 				len = (int)gbinfo.size();
 				if (len > 6) {
-					cerr << "Error too many grace note beams" << endl;
-					exit(1);
+					m_error_text << "Error too many grace note beams" << endl;
+					return false;
 				}
 				beams.at(i).at(j) = gbinfo;
 				gracestate.at(track).at(curlayer.at(track)) = contin;
@@ -60450,8 +68616,8 @@ bool Tool_autostem::getBeamState(vector<vector<string > >& beams,
 
 				countBeamStuff(infile.token(i, j)->c_str(), start, stop, flagr, flagl);
 				if ((start != 0) && (stop != 0)) {
-					cerr << "Funny error in note beam calculation" << endl;
-					exit(1);
+					m_error_text << "Funny error in note beam calculation" << endl;
+					return false;
 				}
 				if (start > 7) {
 					cerr << "Too many beam starts" << endl;
@@ -60529,6 +68695,185 @@ void Tool_autostem::countBeamStuff(const string& token, int& start, int& stop,
 
 
 
+//////////////////////////////
+//
+// PackedRoll::PackedRoll --
+//
+
+PackedRoll::PackedRoll(void) {
+	setKeyRange(0, 127);
+}
+
+
+
+//////////////////////////////
+//
+// PackedRoll::setKeyRange -- Set the lowest and highest MIDI key numbers
+//     stored in the roll.  This also clears the roll.
+//
+
+void PackedRoll::setKeyRange(int low, int high) {
+	m_low   = low;
+	m_count = high - low + 1;
+	m_words = (m_count + 63) / 64;
+	clear();
+}
+
+
+
+//////////////////////////////
+//
+// PackedRoll::clear -- Remove all notes and start again at time step 0.
+//
+
+void PackedRoll::clear(void) {
+	m_first = 0;
+	m_bits.clear();
+}
+
+
+
+//////////////////////////////
+//
+// PackedRoll::addNote -- Mark an attack at the start step and sustain in
+//     the following steps before the end step.  An attack is not changed
+//     to a sustain by an overlapping note.  Steps which have already been
+//     removed are ignored.
+//
+
+void PackedRoll::addNote(int key, int64_t start, int64_t end) {
+	key -= m_low;
+	if ((key < 0) || (key >= m_count)) {
+		return;
+	}
+	extend(std::max(start + 1, end));
+	uint64_t mask = (uint64_t)1 << (key % 64);
+	int word = key / 64;
+	if (start >= m_first) {
+		getStep(start)[word] |= mask;
+	}
+	for (int64_t i=std::max(start + 1, m_first); i<end; i++) {
+		getStep(i)[m_words + word] |= mask;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// PackedRoll::getValue -- Return 2 for an attack, 1 for a sustain and 0
+//     if the key is not sounding.  Steps which are not stored are silent.
+//
+
+int PackedRoll::getValue(int64_t step, int key) const {
+	const uint64_t* bits = getStep(step);
+	key -= m_low;
+	if (!bits || (key < 0) || (key >= m_count)) {
+		return 0;
+	}
+	uint64_t mask = (uint64_t)1 << (key % 64);
+	if (bits[key / 64] & mask) {
+		return 2;
+	}
+	if (bits[m_words + key / 64] & mask) {
+		return 1;
+	}
+	return 0;
+}
+
+
+
+//////////////////////////////
+//
+// PackedRoll::writeStep -- Write the attack and sustain planes of a time
+//     step in the binary format described in tool-binroll.h.
+//
+
+void PackedRoll::writeStep(ostream& out, int64_t step) const {
+	const uint64_t* bits = getStep(step);
+	int bytes = (m_count + 7) / 8;
+	for (int plane=0; plane<2; plane++) {
+		for (int i=0; i<bytes; i++) {
+			char value = 0;
+			if (bits) {
+				value = (char)((bits[plane * m_words + i / 8] >> (8 * (i % 8))) & 0xff);
+			}
+			out.put(value);
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// PackedRoll::removeSteps -- Discard the time steps before the given step.
+//
+
+void PackedRoll::removeSteps(int64_t end) {
+	if (end <= m_first) {
+		return;
+	}
+	size_t count = (size_t)(end - m_first) * 2 * m_words;
+	if (count >= m_bits.size()) {
+		m_bits.clear();
+	} else {
+		m_bits.erase(m_bits.begin(), m_bits.begin() + count);
+	}
+	m_first = end;
+}
+
+
+
+//////////////////////////////
+//
+// PackedRoll::extend -- Make sure that the time steps before the given
+//     step are stored.
+//
+
+void PackedRoll::extend(int64_t end) {
+	if (end <= m_first) {
+		return;
+	}
+	size_t size = (size_t)(end - m_first) * 2 * m_words;
+	if (size > m_bits.size()) {
+		m_bits.resize(size, 0);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// PackedRoll::getStep -- Return the bit planes for a time step, or NULL
+//     if the step is not stored.
+//
+
+uint64_t* PackedRoll::getStep(int64_t step) {
+	if (step < m_first) {
+		return NULL;
+	}
+	size_t index = (size_t)(step - m_first) * 2 * m_words;
+	if (index >= m_bits.size()) {
+		return NULL;
+	}
+	return m_bits.data() + index;
+}
+
+
+const uint64_t* PackedRoll::getStep(int64_t step) const {
+	if (step < m_first) {
+		return NULL;
+	}
+	size_t index = (size_t)(step - m_first) * 2 * m_words;
+	if (index >= m_bits.size()) {
+		return NULL;
+	}
+	return m_bits.data() + index;
+}
+
+
+
 /////////////////////////////////
 //
 // Tool_binroll::Tool_binroll -- Set the recognized options for the tool.
@@ -60537,6 +68882,9 @@ void Tool_autostem::countBeamStuff(const string& token, int& start, int& stop,
 Tool_binroll::Tool_binroll(void) {
 	// add options here
 	define("t|timebase=s:16", "timebase to do analysis at");
+	define("k|keys=s:0-127",  "range of MIDI key numbers to include");
+	define("b|binary=b",      "output bit-packed binary roll");
+	define("s|stream=b",      "print time steps as soon as they are complete");
 }
 
 
@@ -60579,7 +68927,9 @@ bool Tool_binroll::run(HumdrumFile& infile, ostream& out) {
 
 
 bool Tool_binroll::run(HumdrumFile& infile) {
-	m_duration.setValue(1, 4); // 16th note
+	if (!initialize()) {
+		return false;
+	}
 	processFile(infile);
 	return true;
 }
@@ -60588,129 +68938,93 @@ bool Tool_binroll::run(HumdrumFile& infile) {
 
 //////////////////////////////
 //
-// Tool_binroll::processFile --
+// Tool_binroll::initialize --
 //
 
-void Tool_binroll::processFile(HumdrumFile& infile) {
-	vector<vector<char>> output;
-	output.resize(128);
-	int count = (infile.getScoreDuration() / m_duration).getInteger() + 1;
-	for (int i=0; i<(int)output.size(); i++) {
-		output[i].resize(count);
-		std::fill(output[i].begin(), output[i].end(), 0);
-	}
+bool Tool_binroll::initialize(void) {
+	m_binaryQ = getBoolean("binary");
+	m_streamQ = getBoolean("stream");
 
-	int strandcount = infile.getStrandCount();
-	for (int i=0; i<strandcount; i++) {
-		HTp starting = infile.getStrandStart(i);
-		if (!starting->isKern()) {
-			continue;
-		}
-		HTp ending = infile.getStrandEnd(i);
-		processStrand(output, starting, ending);
+	m_duration = Convert::recipToDuration(getString("timebase"));
+	if (m_duration <= 0) {
+		m_duration.setValue(1, 4); // 16th note
 	}
 
-	printAnalysis(infile, output);
-
+	HumRegex hre;
+	int low = 0;
+	int high = 127;
+	if (hre.search(getString("keys"), "^\\s*(\\d+)\\s*[-:]\\s*(\\d+)\\s*$")) {
+		low  = hre.getMatchInt(1);
+		high = hre.getMatchInt(2);
+	} else {
+		low = -1;
+	}
+	if ((low < 0) || (high > 127) || (low > high)) {
+		setError("Error: invalid key range " + getString("keys") + " (use for example 21-108)");
+		return false;
+	}
+	m_roll.setKeyRange(low, high);
+	return true;
 }
 
 
 
 //////////////////////////////
 //
-// Tool_binroll::printAnalysis --
+// Tool_binroll::processFile -- Fill in the roll line by line.  Since the
+//     lines are in time order, the time steps before the start of a line
+//     can no longer change, so in streaming mode they are printed (and
+//     removed from the roll) before the line is processed.
 //
 
-void Tool_binroll::printAnalysis(HumdrumFile& infile,
-		vector<vector<char>>& roll) {
-	HumRegex hre;
+void Tool_binroll::processFile(HumdrumFile& infile) {
+	int count = (infile.getScoreDuration() / m_duration).getInteger() + 1;
+	m_roll.clear();
+	m_printed = 0;
 
+	printHeader(infile, count);
 	for (int i=0; i<infile.getLineCount(); i++) {
-		if (infile[i].isExclusive()) {
-			break;
-		}
-		if (infile[i].isEmpty()) {
-			continue;
-		}
-		string line = infile[i].getText();
-		int found = 0;
-		for (int j=0; j<(int)line.size(); j++) {
-			if ((line[j] == '!') && !found) {
-				m_free_text << "#";
-			} else {
-				found = 1;
-				m_free_text << line[j];
-			}
-		}
-		m_free_text << "\n";
-	}
-
-	for (int i=0; i<(int)roll[0].size(); i++) {
-		for (int j=0; j<(int)roll.size(); j++) {
-			m_free_text << (int)roll[j][i];
-			if (j < (int)roll.size() - 1) {
-				m_free_text << ' ';
-			}
-		}
-		m_free_text << "\n";
-	}
-
-	int startindex = infile.getLineCount() - 1;
-	for (int i=infile.getLineCount()-1; i>=0; i--) {
-		if (infile[i].isManipulator()) {
-			startindex = i+1;
-			break;
-		}
-		startindex = i;
-	}
-
-	for (int i=startindex; i<infile.getLineCount(); i++) {
-		if (infile[i].isEmpty()) {
+		if (!infile[i].isData()) {
 			continue;
 		}
-		string line = infile[i].getText();
-		int found = 0;
-		for (int j=0; j<(int)line.size(); j++) {
-			if ((line[j] == '!') && !found) {
-				m_free_text << "#";
-			} else {
-				found = 1;
-				m_free_text << line[j];
-			}
+		if (m_streamQ) {
+			printSteps((infile[i].getDurationFromStart() / m_duration).getInteger());
 		}
-		m_free_text << "\n";
+		processLine(infile[i]);
 	}
+	printSteps(count);
+	printTrailer(infile);
 }
 
 
 
 //////////////////////////////
 //
-// Tool_binroll::processStrand --
+// Tool_binroll::processLine -- Add the notes starting on a data line.
 //
 
-void Tool_binroll::processStrand(vector<vector<char>>& roll, HTp starting,
-		HTp ending) {
-	HTp current = starting;
+void Tool_binroll::processLine(HumdrumLine& line) {
 	int base12;
 	HumNum starttime;
 	HumNum duration;
 	int startindex;
 	int endindex;
-	while (current && (current != ending)) {
+	for (int i=0; i<line.getFieldCount(); i++) {
+		HTp current = line.token(i);
+		if (!current->isKern()) {
+			continue;
+		}
 		if (!current->isNonNullData()) {
-			current = current->getNextToken();
 			continue;
 		}
 		if (current->isRest()) {
-			current = current->getNextToken();
 			continue;
 		}
 
+		starttime = current->getDurationFromStart();
+		startindex = (starttime / m_duration).getInteger();
 		if (current->isChord()) {
 			int stcount = current->getSubtokenCount();
-			starttime = current->getDurationFromStart();
-			startindex = (starttime / m_duration).getInteger();
 			for (int s=0; s<stcount; s++) {
 				string tok = current->getSubtoken(s);
 				base12 = Convert::kernToMidiNoteNumber(tok);
@@ -60719,27 +69033,142 @@ void Tool_binroll::processStrand(vector<vector<char>>& roll, HTp starting,
 				}
 				duration = Convert::recipToDuration(tok);
 				endindex = ((starttime+duration) / m_duration).getInteger();
-				roll[base12][startindex] = 2;
-				for (int i=startindex+1; i<endindex; i++) {
-					roll[base12][i] = 1;
-				}
+				m_roll.addNote(base12, startindex, endindex);
 			}
 		} else {
 			base12 = Convert::kernToMidiNoteNumber(current);
 			if ((base12 < 0) || (base12 > 127)) {
-				current = current->getNextToken();
 				continue;
 			}
-			starttime = current->getDurationFromStart();
 			duration = current->getDuration();
-			startindex = (starttime / m_duration).getInteger();
-			endindex   = ((starttime+duration) / m_duration).getInteger();
-			roll[base12][startindex] = 2;
-			for (int i=startindex+1; i<endindex; i++) {
-				roll[base12][i] = 1;
+			endindex = ((starttime+duration) / m_duration).getInteger();
+			m_roll.addNote(base12, startindex, endindex);
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::printSteps -- Print the time steps before the given step
+//     which have not yet been printed, and remove them from the roll.
+//
+
+void Tool_binroll::printSteps(int end) {
+	int low = m_roll.getLowKey();
+	int high = low + m_roll.getKeyCount() - 1;
+	for (int i=m_printed; i<end; i++) {
+		if (m_binaryQ) {
+			m_roll.writeStep(m_free_text, i);
+			continue;
+		}
+		for (int j=low; j<=high; j++) {
+			m_free_text << m_roll.getValue(i, j);
+			if (j < high) {
+				m_free_text << ' ';
 			}
 		}
-		current = current->getNextToken();
+		m_free_text << "\n";
+	}
+	if (end > m_printed) {
+		m_printed = end;
+	}
+	m_roll.removeSteps(m_printed);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::printHeader -- Print the comments before the start of the
+//     data, or the header of the binary format.
+//
+
+void Tool_binroll::printHeader(HumdrumFile& infile, int count) {
+	if (m_binaryQ) {
+		m_free_text << "HUMROLL1";
+		writeInt(m_duration.getNumerator(), 4);
+		writeInt(m_duration.getDenominator(), 4);
+		writeInt(m_roll.getLowKey(), 4);
+		writeInt(m_roll.getKeyCount(), 4);
+		writeInt(count, 8);
+		return;
+	}
+
+	for (int i=0; i<infile.getLineCount(); i++) {
+		if (infile[i].isExclusive()) {
+			break;
+		}
+		if (infile[i].isEmpty()) {
+			continue;
+		}
+		printComment(infile[i]);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::printTrailer -- Print the comments after the end of the
+//     data (not for binary output).
+//
+
+void Tool_binroll::printTrailer(HumdrumFile& infile) {
+	if (m_binaryQ) {
+		return;
+	}
+
+	int startindex = infile.getLineCount() - 1;
+	for (int i=infile.getLineCount()-1; i>=0; i--) {
+		if (infile[i].isManipulator()) {
+			startindex = i+1;
+			break;
+		}
+		startindex = i;
+	}
+
+	for (int i=startindex; i<infile.getLineCount(); i++) {
+		if (infile[i].isEmpty()) {
+			continue;
+		}
+		printComment(infile[i]);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::printComment -- Print a line with its leading "!"
+//     characters changed to "#".
+//
+
+void Tool_binroll::printComment(HumdrumLine& line) {
+	string text = line.getText();
+	int found = 0;
+	for (int j=0; j<(int)text.size(); j++) {
+		if ((text[j] == '!') && !found) {
+			m_free_text << "#";
+		} else {
+			found = 1;
+			m_free_text << text[j];
+		}
+	}
+	m_free_text << "\n";
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::writeInt -- Write an integer in little-endian byte order.
+//
+
+void Tool_binroll::writeInt(uint64_t value, int bytes) {
+	for (int i=0; i<bytes; i++) {
+		m_free_text.put((char)((value >> (8 * i)) & 0xff));
 	}
 }
 
@@ -61855,22 +70284,7 @@ void Tool_chantize::clearStates(void) {
 //
 
 string Tool_chantize::getDate(void) {
-	time_t t = time(NULL);
-	tm* timeptr = localtime(&t);
-	stringstream ss;
-	int year = timeptr->tm_year + 1900;
-	int month = timeptr->tm_mon + 1;
-	int day = timeptr->tm_mday;
-	ss << year << "/";
-	if (month < 10) {
-		ss << "0";
-	}
-	ss << month << "/";
-	if (day < 10) {
-		ss << "0";
-	}
-	ss << day;
-	return ss.str();
+	return Convert::getCurrentDate();
 }
 
 
@@ -63215,7 +71629,9 @@ string NoteNode::getId(void) {
 
 int Tool_cint::processFile(HumdrumFile& infile) {
 
-   initialize();
+	if (!initialize()) {
+		return 0;
+	}
 
 	vector<vector<NoteNode> > notes;
 	vector<string> names;
@@ -63232,6 +71648,10 @@ int Tool_cint::processFile(HumdrumFile& infile) {
 	if (koptionQ) {
 		adjustKTracks(ktracks, getString("koption"));
 	}
+	if (ktracks.empty()) {
+		m_warning_text << "Warning: no **kern spines in file" << endl;
+		return 0;
+	}
 	notes.resize(ktracks.size());
 	reverselookup.resize(infile.getTrackCount()+1);
 	fill(reverselookup.begin(), reverselookup.end(), -1);
@@ -63258,7 +71678,7 @@ int Tool_cint::processFile(HumdrumFile& infile) {
 
 	if (pitchesQ) {
 		printPitchGrid(notes, infile);
-		exit(0);
+		return 0;
 	}
 
 	int count = 0;
@@ -65339,12 +73759,10 @@ void Tool_cint::extractNoteArray(vector<vector<NoteNode> >& notes, HumdrumFile&
 			current[index].beatsize = beatsizes[track];
 			if (infile.token(i, j)->isNull()) {
 				sign = -1;
-				HTp nullx = infile.token(i, j)->resolveNull();
-				if (nullx == NULL) {
-					ii = jj = -1;
-				} else {
-					ii = nullx->getLineIndex();
-					jj = nullx->getFieldIndex();
+				if (!infile.getResolvedPosition(i, j, ii, jj)) {
+					// null token at start of spine
+					ii = i;
+					jj = j;
 				}
 			} else {
 				ii = i;
@@ -65587,25 +74005,26 @@ void Tool_cint::getNames(vector<string>& names, vector<int>& reverselookup,
 //////////////////////////////
 //
 // Tool_cint::initialize -- validate and process command-line options.
+//     Returns false if no analysis should be done (such as for --help).
 //
 
-void Tool_cint::initialize(void) {
+bool Tool_cint::initialize(void) {
 
 	// handle basic options:
 	if (getBoolean("author")) {
 		m_humdrum_text << "Written by Craig Stuart Sapp, "
 			  << "craig@ccrma.stanford.edu, September 2013" << endl;
-		exit(0);
+		return false;
 	} else if (getBoolean("version")) {
 		m_humdrum_text << getCommand() << ", version: 16 March 2022" << endl;
 		m_humdrum_text << "compiled: " << __DATE__ << endl;
-		exit(0);
+		return false;
 	} else if (getBoolean("help")) {
 		usage(getCommand());
-		exit(0);
+		return false;
 	} else if (getBoolean("example")) {
 		example();
-		exit(0);
+		return false;
 	}
 
 	koptionQ = getBoolean("koption");
@@ -65701,6 +74120,7 @@ void Tool_cint::initialize(void) {
 		SearchString = getString("search");
 	}
 
+	return true;
 }
 
 
@@ -65731,8 +74151,6 @@ void Tool_cint::usage(const string& command) {
 
 
 
-double cmr_note_info::m_syncopationWeight = 1.0;
-double cmr_note_info::m_leapWeight = 0.5;
 
 
 ///////////////////////////////////////////////////////////////////////////
@@ -66010,13 +74428,13 @@ double cmr_note_info::getMetricLevel(HTp token) {
 //     is preceded by a melodic leap.
 //
 
-double cmr_note_info::getNoteStrength(void) {
+double cmr_note_info::getNoteStrength(double syncopationWeight, double leapWeight) {
 	double output = 1.0;
 	if (hasSyncopation()) {
-		output += m_syncopationWeight;
+		output += syncopationWeight;
 	}
 	if (hasLeapBefore()) {
-		output += m_leapWeight;
+		output += leapWeight;
 	}
 	return output;
 }
@@ -66467,10 +74885,10 @@ int cmr_group_info::getStartFieldNumber(void) {
 // cmr_group_info::getGroupStrength -- Return the strength value for the CMR.
 //
 
-double cmr_group_info::getGroupStrength(void) {
+double cmr_group_info::getGroupStrength(double syncopationWeight, double leapWeight) {
 	double output = 0.0;
 	for (int i=0; i<(int)m_notes.size(); i++) {
-		output += m_notes[i].getNoteStrength();
+		output += m_notes[i].getNoteStrength(syncopationWeight, leapWeight);
 	}
 	return output;
 }
@@ -66775,8 +75193,8 @@ void Tool_cmr::initialize(void) {
 	m_infoQ        = getBoolean("info");
 	m_halfQ        = getBoolean("half");
 
-	cmr_note_info::m_syncopationWeight = getDouble("syncopation-weight");
-	cmr_note_info::m_leapWeight        = getDouble("leap-weight");
+	m_syncopationWeight = getDouble("syncopation-weight");
+	m_leapWeight        = getDouble("leap-weight");
 
 	m_noteGroups.clear();
 }
@@ -66796,6 +75214,7 @@ void Tool_cmr::processFile(HumdrumFile& infile) {
 	m_maxPitch.resize(infile.getMaxTrack() + 1);
 
 	m_local_count = 0;
+	m_positiveLines.assign(infile.getLineCount(), 0);
 
 	m_barNum = infile.getMeasureNumbers();
 
@@ -66916,6 +75335,8 @@ void Tool_cmr::processSpine(HTp startok, HumdrumFile&  infile) {
 		return;
 	}
 
+	prepareRangeTables();
+
 	for (int i=0; i<(int)m_notelist.size(); i++) {
 		checkForCmr(i, 1, infile);
 	}
@@ -66968,6 +75389,8 @@ void Tool_cmr::processSpineFlipped(HTp startok, HumdrumFile& infile) {
 		return;
 	}
 
+	prepareRangeTables();
+
 	for (int i=0; i<(int)m_notelist.size(); i++) {
 		checkForCmr(i, -1, infile);
 	}
@@ -67011,7 +75434,7 @@ void Tool_cmr::checkForCmr(int index, int direction, HumdrumFile& infile) {
 	int i = index+1;
 	HumNum duration = 0;
 	if (i < (int)m_notelist.size()) {
-		duration = m_notelist.at(i).at(0)->getDurationFromStart() - m_notelist.at(index).at(0)->getDurationFromStart();
+		duration = m_starttimes[i] - m_starttimes[index];
 	}
 
 	// Check for matching peaks after target note:
@@ -67031,14 +75454,14 @@ void Tool_cmr::checkForCmr(int index, int direction, HumdrumFile& infile) {
 		}
 		i++;
 		if (i < (int)m_notelist.size()) {
-			duration = m_notelist.at(i).at(0)->getDurationFromStart() - m_notelist.at(index).at(0)->getDurationFromStart();
+			duration = m_starttimes[i] - m_starttimes[index];
 		}
 	}
 
 	i = index-1;
 	duration = 0;
-	if (i < (int)m_notelist.size()) {
-		duration = m_notelist.at(index).at(0)->getDurationFromStart() - m_notelist.at(i).at(0)->getDurationFromStart();
+	if (i >= 0) {
+		duration = m_starttimes[index] - m_starttimes[i];
 	}
 
 	// Check for matching peaks before target note:
@@ -67058,7 +75481,7 @@ void Tool_cmr::checkForCmr(int index, int direction, HumdrumFile& infile) {
 		}
 		i--;
 		if (i >= 0) {
-			duration = m_notelist.at(index).at(0)->getDurationFromStart() - m_notelist.at(i).at(0)->getDurationFromStart();
+			duration = m_starttimes[index] - m_starttimes[i];
 		}
 	}
 
@@ -67067,16 +75490,15 @@ void Tool_cmr::checkForCmr(int index, int direction, HumdrumFile& infile) {
 		return;
 	}
 
+	int firstNew = (int)m_noteGroups.size();
 	for (int i=0; i<=(int)candidates.size() - m_cmrNum; i++) {
 		int index1 = candidates.at(i);
 		int index2 = candidates.at(i+m_cmrNum-1);
-		HumNum dur1 = m_notelist.at(index1).at(0)->getDurationFromStart();
-		HumNum dur2 = m_notelist.at(index2).at(0)->getDurationFromStart();
-		HumNum duration = dur2 - dur1;
+		HumNum duration = m_starttimes[index2] - m_starttimes[index1];
 		if (duration > m_cmrDur) {
 			continue;
 		}
-		if (hasHigher(pitch, 2, m_midinums, m_notelist, index1, index2)) {
+		if (hasHigher(pitch, 2, index1, index2)) {
 			continue;
 		}
 
@@ -67093,40 +75515,39 @@ void Tool_cmr::checkForCmr(int index, int direction, HumdrumFile& infile) {
 			m_noteGroups.back().setDirectionDown();
 		} else {
 			m_noteGroups.back().setDirectionUp();
+			updatePositiveLines(m_noteGroups.back(), 1);
 		}
 	}
 
+	if (m_noteGroups.empty()) {
+		return;
+	}
+
 	int leapcount = m_noteGroups.back().getLeapCount();
 	int syncocount  = m_noteGroups.back().getSyncopationCount();
 	if (syncocount == 0) {
 		if (leapcount < 3) {
 			// Delete groups since it has less than three leaps and no syncopations
-			if (m_noteGroups.size() > 0) {
-				m_noteGroups.resize(m_noteGroups.size() - 1);
+			if (m_noteGroups.back().getDirection() > 0) {
+				updatePositiveLines(m_noteGroups.back(), -1);
 			}
+			m_noteGroups.resize(m_noteGroups.size() - 1);
 		}
 	}
 
 	// Remove negative groups if they share a note with a positive group.
-	vector<bool> positive(infile.getLineCount(), false);
-	for (int i=0; i<(int)m_noteGroups.size(); i++) {
-		int dir = m_noteGroups.at(i).getDirection();
-		if (dir > 0) {
-			for (int j=0; j<m_noteGroups.at(i).getNoteCount(); j++) {
-				int line = m_noteGroups.at(i).getToken(j)->getLineIndex();
-				positive.at(line) = true;
-			}
-		} else if (dir < 0) {
-			bool valid = true;
-			for (int j=0; j<m_noteGroups.at(i).getNoteCount(); j++) {
-				int line = m_noteGroups.at(i).getToken(j)->getLineIndex();
-				if (positive.at(line)) {
-					valid = false;
-					break;
-				}
-			}
-			if (!valid) {
-				m_noteGroups.at(i).makeInvalid();
+	// Only the positive groups before a negative group in the list are
+	// considered, and those cannot change after the negative group is
+	// added, so only the new groups need to be checked.
+	for (int i=firstNew; i<(int)m_noteGroups.size(); i++) {
+		if (m_noteGroups[i].getDirection() >= 0) {
+			continue;
+		}
+		for (int j=0; j<m_noteGroups[i].getNoteCount(); j++) {
+			int line = m_noteGroups[i].getToken(j)->getLineIndex();
+			if (m_positiveLines.at(line) > 0) {
+				m_noteGroups[i].makeInvalid();
+				break;
 			}
 		}
 	}
@@ -67134,6 +75555,88 @@ void Tool_cmr::checkForCmr(int index, int direction, HumdrumFile& infile) {
 
 
 
+//////////////////////////////
+//
+// Tool_cmr::updatePositiveLines -- Add (change = 1) or remove (change = -1)
+//     the notes of a positive group from the count of positive CMR notes
+//     on each line of the score.
+//
+
+void Tool_cmr::updatePositiveLines(cmr_group_info& group, int change) {
+	for (int j=0; j<group.getNoteCount(); j++) {
+		int line = group.getToken(j)->getLineIndex();
+		m_positiveLines.at(line) += change;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_cmr::prepareRangeTables -- Store the start times of the notes in
+//     the current part, and create sparse tables for finding the highest
+//     pitch (and highest pitch on a strong beat) in a range of notes in
+//     constant time.  m_midinums must be calculated before calling this
+//     function.
+//
+
+void Tool_cmr::prepareRangeTables(void) {
+	int size = (int)m_notelist.size();
+	m_starttimes.resize(size);
+	vector<int> strongpitches(size);
+	for (int i=0; i<size; i++) {
+		HTp note = m_notelist[i].at(0);
+		m_starttimes[i] = note->getDurationFromStart();
+		strongpitches[i] = isOnStrongBeat(note) ? m_midinums.at(i) : -1;
+	}
+	buildRangeMaxTable(m_maxPitchTable, m_midinums);
+	buildRangeMaxTable(m_maxStrongPitchTable, strongpitches);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_cmr::buildRangeMaxTable -- Create a sparse table where
+//     table[k][i] is the maximum of values[i] to values[i + 2^k - 1].
+//
+
+void Tool_cmr::buildRangeMaxTable(vector<vector<int>>& table, vector<int>& values) {
+	int size = (int)values.size();
+	int levels = 1;
+	while ((1 << levels) <= size) {
+		levels++;
+	}
+	table.resize(levels);
+	table[0] = values;
+	for (int k=1; k<levels; k++) {
+		int width = 1 << k;
+		int half = width >> 1;
+		table[k].resize(size - width + 1);
+		for (int i=0; i+width<=size; i++) {
+			table[k][i] = std::max(table[k-1][i], table[k-1][i+half]);
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_cmr::getRangeMax -- Return the maximum value between index1 and
+//     index2 (inclusive) from a table created by buildRangeMaxTable().
+//
+
+int Tool_cmr::getRangeMax(vector<vector<int>>& table, int index1, int index2) {
+	int k = 0;
+	while ((2 << k) <= index2 - index1 + 1) {
+		k++;
+	}
+	return std::max(table[k][index1], table[k][index2 - (1 << k) + 1]);
+}
+
+
+
 //////////////////////////////
 //
 // Tool_cmr::hasHigher -- There may be a note a step higher
@@ -67142,22 +75645,16 @@ void Tool_cmr::checkForCmr(int index, int direction, HumdrumFile& infile) {
 //     True = invalid CMR case.
 //
 
-bool Tool_cmr::hasHigher(int pitch, int tolerance, vector<int>& midinums, vector<vector<HTp>>& notelist, int index1, int index2) {
-
-	for (int i=index1; i<=index2; i++) {
-		// Only a step above (major or minor second) is allowed.
-		// Input tolerance is 2.
-		if (midinums.at(i) > pitch + tolerance) {
-			return true;
-		}
-
-		if (midinums.at(i) > pitch) {
-			// If the higher note is accented, then invalidate the cmr.
-			if (isOnStrongBeat(notelist.at(i).at(0))) {
-				return true;
-			}
-		}
+bool Tool_cmr::hasHigher(int pitch, int tolerance, int index1, int index2) {
+	// Only a step above (major or minor second) is allowed.
+	// Input tolerance is 2.
+	if (getRangeMax(m_maxPitchTable, index1, index2) > pitch + tolerance) {
+		return true;
+	}
 
+	// If a higher note is accented, then invalidate the cmr.
+	if (getRangeMax(m_maxStrongPitchTable, index1, index2) > pitch) {
+		return true;
 	}
 
 	return false;
@@ -67468,7 +75965,7 @@ void Tool_cmr::printGroupStatistics(HumdrumFile& infile) {
 		m_humdrum_text << "!!!cmr_end_measure: "   << m_noteGroups[i].getMeasureEnd()       << endl;
 		// Durations are in units of whole notes (semibreves):
 		m_humdrum_text << "!!!cmr_duration: "      << groupDuration << m_durUnit            << endl;
-		m_humdrum_text << "!!!cmr_strength: "      << m_noteGroups[i].getGroupStrength()    << endl;
+		m_humdrum_text << "!!!cmr_strength: "      << m_noteGroups[i].getGroupStrength(m_syncopationWeight, m_leapWeight)    << endl;
 		m_humdrum_text << "!!!cmr_direction: "     << m_noteGroups[i].getDirection()        << endl;
 		m_humdrum_text << "!!!cmr_note_count: "    << m_noteGroups[i].getNoteCount()        << endl;
 		m_humdrum_text << "!!!cmr_pitch: "         << m_noteGroups[i].getPitch()            << endl;
@@ -68332,7 +76829,7 @@ int Tool_cmr::getStrengthScore(void) {
 	int output = 0;
 	for (int i=0; i<(int)m_noteGroups.size(); i++) {
 		if (m_noteGroups[i].isValid()) {
-			output += m_noteGroups[i].getGroupStrength();
+			output += m_noteGroups[i].getGroupStrength(m_syncopationWeight, m_leapWeight);
 		}
 	}
 	return output;
@@ -72010,33 +80507,8 @@ void Tool_composite::adjustBadCoincidenceRests(HumdrumFile& output, HumdrumFile&
 	}
 
 	HumRegex hre;
-	vector<HumNum> timesigtop(output.getLineCount(), 4);
-	vector<HumNum> timesigbot(output.getLineCount(), 4);
-	HumNum tts = 4;
-	HumNum bts = 4;
-
-	for (int i=0; i<output.getLineCount(); i++) {
-		if (!output[i].isInterpretation()) {
-			timesigtop[i] = tts;
-			timesigbot[i] = bts;
-			continue;
-		}
-		for (int j=0; j<output[i].getFieldCount(); j++) {
-			HTp token = output.token(i, j);
-			if (token->getDataType() != "**kern-coin") {
-				continue;
-			}
-			if (token->isTimeSignature()) {
-				if (hre.search(token, "^\\*M(\\d+)/(\\d+)")) {
-					tts = hre.getMatch(1);
-					bts = hre.getMatch(2);
-				}
-			}
-			break;
-		}
-		timesigtop[i] = tts;
-		timesigbot[i] = bts;
-	}
+	const HumMetricTable& grid = output.getMetricGrid();
+	int track = sstarts.at(0)->getTrack();
 
 	HTp current = sstarts.at(0);
 	string rhythm;
@@ -72058,7 +80530,13 @@ void Tool_composite::adjustBadCoincidenceRests(HumdrumFile& output, HumdrumFile&
 			rhythm = hre.getMatch(1);
 			if (rhythm == "3...") {
 				int lindex = current->getLineIndex();
-				current = fixBadRestRhythm(current, rhythm, timesigtop[lindex], timesigbot[lindex]);
+				HumNum tstop = 4;
+				HumNum tsbot = 4;
+				if (grid.hasMeter(lindex, track)) {
+					tstop = grid.getMeterTop(lindex, track);
+					tsbot = grid.getMeterBottom(lindex, track);
+				}
+				current = fixBadRestRhythm(current, rhythm, tstop, tsbot);
 			}
 		}
 		current = current->getNextToken();
@@ -75908,18 +84386,6 @@ void Tool_compositeold::addVerseLabels2(HumdrumFile& infile, HTp spinestart) {
 
 
 
-/////////////////////////////////
-//
-// Tool_deg::ScaleDegree static member variables:
-//
-
-bool Tool_deg::ScaleDegree::m_showTiesQ  = false;
-bool Tool_deg::ScaleDegree::m_showZerosQ = false;
-bool Tool_deg::ScaleDegree::m_octaveQ = false;
-string Tool_deg::ScaleDegree::m_forcedKey = "";
-
-
-
 /////////////////////////////////
 //
 // Tool_deg::Tool_deg -- Set the recognized options for the tool.
@@ -76018,7 +84484,7 @@ void Tool_deg::initialize(void) {
 		m_recipQ = true;
 	}
 	m_degTiesQ = getBoolean("ties");
-	Tool_deg::ScaleDegree::setShowOctaves(getBoolean("octave"));
+	m_degOctaveQ = getBoolean("octave");
 
 	if (getBoolean("spine-tracks")) {
 		m_spineTracks = getString("spine-tracks");
@@ -76049,12 +84515,10 @@ void Tool_deg::initialize(void) {
 			if (m_forcedKey.find(":") == string::npos) {
 				m_forcedKey += ":";
 			}
-			Tool_deg::ScaleDegree::setForcedKey(m_forcedKey);
 		}
 	}
 
-	Tool_deg::ScaleDegree::setShowTies(m_degTiesQ);
-	Tool_deg::ScaleDegree::setShowZeros(getBoolean("zeros"));
+	m_degZerosQ = getBoolean("zeros");
 }
 
 
@@ -76072,6 +84536,7 @@ void Tool_deg::processFile(HumdrumFile& infile) {
 
 	// Create storage space for scale degree analyses:
 	int kernCount = (int)m_selectedKernSpines.size();
+	m_degSpines.clear();
 	m_degSpines.resize(kernCount);
 	for (int i=0; i<kernCount; i++) {
 		prepareDegSpine(m_degSpines.at(i), m_selectedKernSpines.at(i), infile);
@@ -77416,6 +85881,17 @@ void Tool_deg::prepareDegSpine(vector<vector<ScaleDegree>>& degspine, HTp kernst
 		}
 	}
 
+	// Set the rendering options for the scale degrees:
+	for (int i=0; i<(int)degspine.size(); i++) {
+		for (int j=0; j<(int)degspine[i].size(); j++) {
+			ScaleDegree& degree = degspine[i][j];
+			degree.setShowTies(m_degTiesQ);
+			degree.setShowZeros(m_degZerosQ);
+			degree.setShowOctaves(m_degOctaveQ);
+			degree.setForcedKey(m_forcedKey);
+		}
+	}
+
 	// process melodic contours, etc.
 
 }
@@ -77731,7 +86207,7 @@ string Tool_deg::ScaleDegree::getDegToken(void) const {
 		return getManipulator();
 	} else if (isInterpretation()) {
 		if (isKeyDesignation()) {
-			if (m_forcedKey.empty()) {
+			if (!m_forcedKeyQ) {
 				return *token;
 			} else{
 				return "*";
@@ -78401,6 +86877,8 @@ Tool_dissonant::Tool_dissonant(void) {
 	define("i|x|e|exinterp=s:**cdata-rdiss", "specify exinterp for **diss spines");
 	define("color|color-by-rhythm=b",        "color dissonant notes by beat level");
 	define("color2|color-by-interval=b",     "color dissonant notes by dissonant interval");
+	define("statistics=b",                   "only print dissonance counts for each input file");
+	define("threads=i:0",                    "number of threads for --statistics (0 = number of cores)");
 }
 
 
@@ -78411,6 +86889,9 @@ Tool_dissonant::Tool_dissonant(void) {
 //
 
 bool Tool_dissonant::run(HumdrumFileSet& infiles) {
+	if (getBoolean("statistics")) {
+		return runStatistics(infiles);
+	}
 	bool status = true;
 	for (int i=0; i<infiles.getCount(); i++) {
 		status &= run(infiles[i]);
@@ -78457,6 +86938,17 @@ bool Tool_dissonant::run(HumdrumFile& infile, ostream& out) {
 
 bool Tool_dissonant::run(HumdrumFile& infile) {
 
+	if (getBoolean("statistics")) {
+		vector<int> counts;
+		int voices = 0;
+		prepareStatisticsLabels();
+		getStatistics(infile, counts, voices);
+		printStatisticsHeader(m_humdrum_text);
+		printStatisticsLine(m_humdrum_text, infile.getFilename(), counts, voices);
+		printStatisticsFooter(m_humdrum_text);
+		return true;
+	}
+
 	if (getBoolean("voice-number")) {
 		m_voicenumQ = true;
 	}
@@ -78618,8 +87110,8 @@ void Tool_dissonant::adjustColorization(HumdrumFile& infile) {
 	// New spines were added so need to re-analyze spine structure:
 	infile.analyzeBaseFromLines();
 
-	bool colorizeQ = getBoolean("colorize");
-	bool colorize2Q = getBoolean("colorize2");
+	bool colorizeQ = getBoolean("color");
+	bool colorize2Q = getBoolean("color2");
 	if (!(colorizeQ || colorize2Q)) {
 		// nothing to do
 		return;
@@ -79498,7 +87990,7 @@ void Tool_dissonant::changePitch(HTp note2, HTp note1) {
 //
 
 void Tool_dissonant::printColorLegend(HumdrumFile& infile) {
-	if (getBoolean("colorize")) {
+	if (getBoolean("color")) {
 		if (dissL0Q) {
 			infile.appendLine("!!!RDF**kern: N = strong dissonant marked note, color=\"#bb3300\"");
 		}
@@ -79508,7 +88000,7 @@ void Tool_dissonant::printColorLegend(HumdrumFile& infile) {
 		if (dissL2Q) {
 			infile.appendLine("!!!RDF**kern: + = weak 2 dissonant marked note, color=\"#0099ff\"");
 		}
-	} else if (getBoolean("colorize2")) {
+	} else if (getBoolean("color2")) {
 		if (diss2Q) {
 			infile.appendLine("!!!RDF**kern: @ = dissonant 2nd, marked note, color=\"#33bb00\"");
 		}
@@ -79577,8 +88069,10 @@ void Tool_dissonant::doAnalysisForVoice(vector<vector<string>>& results,
 		}
 	}
 	bool nodissonanceQ = getBoolean("no-dissonant");
-	bool colorizeQ = getBoolean("colorize");
-	bool colorize2Q = getBoolean("colorize2");
+	// --statistics does not modify the input data:
+	bool statisticsQ = getBoolean("statistics");
+	bool colorizeQ = getBoolean("color") && !statisticsQ;
+	bool colorize2Q = getBoolean("color2") && !statisticsQ;
 
 	HumNum durpp = -1; // duration of previous previous note
 	HumNum durp;       // duration of previous melodic note
@@ -80786,6 +89280,196 @@ void Tool_dissonant::printCountAnalysis(vector<vector<string>>& data) {
 
 
 
+//////////////////////////////
+//
+// Tool_dissonant::runStatistics -- Count the dissonance labels in each file
+//     of the set without modifying the files.  The files are analyzed
+//     in parallel (--threads), with each thread pulling the next unprocessed
+//     file from the set.  The output is a single table with one line for
+//     each input file.
+//
+
+bool Tool_dissonant::runStatistics(HumdrumFileSet& infiles) {
+	int count = infiles.getCount();
+	vector<vector<int>> counts(count);
+	vector<int> voices(count, 0);
+
+	int threadCount = getInteger("threads");
+	if (threadCount <= 0) {
+		threadCount = (int)std::thread::hardware_concurrency();
+	}
+	if (threadCount > count) {
+		threadCount = count;
+	}
+	if (threadCount < 1) {
+		threadCount = 1;
+	}
+
+	// Each thread uses its own copy of the tool since the analysis
+	// functions store temporary state in the tool.
+	std::atomic<int> nextFile(0);
+	auto worker = [&](void) {
+		Tool_dissonant tool;
+		static_cast<Options&>(tool) = static_cast<Options&>(*this);
+		tool.prepareStatisticsLabels();
+		int index;
+		while ((index = nextFile++) < count) {
+			tool.getStatistics(infiles[index], counts[index], voices[index]);
+		}
+	};
+
+	if (threadCount == 1) {
+		worker();
+	} else {
+		vector<std::thread> pool;
+		pool.reserve(threadCount);
+		for (int i=0; i<threadCount; i++) {
+			pool.emplace_back(worker);
+		}
+		for (int i=0; i<(int)pool.size(); i++) {
+			pool[i].join();
+		}
+	}
+
+	prepareStatisticsLabels();
+	printStatisticsHeader(m_humdrum_text);
+	for (int i=0; i<count; i++) {
+		printStatisticsLine(m_humdrum_text, infiles[i].getFilename(), counts[i], voices[i]);
+	}
+	printStatisticsFooter(m_humdrum_text);
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_dissonant::prepareStatisticsLabels -- Create the list of labels
+//     used as columns in the --statistics output.  Labels which are
+//     identical (such as for -u) are merged into a single column.
+//
+
+void Tool_dissonant::prepareStatisticsLabels(void) {
+	if (getBoolean("undirected")) {
+		fillLabels2();
+	} else {
+		fillLabels();
+	}
+
+	m_statLabels.clear();
+	m_statAgents.clear();
+	m_statIndex.clear();
+	for (int i=0; i<(int)LABELS_SIZE; i++) {
+		if ((i == UNLABELED_Z2) || (i == UNLABELED_Z7)) {
+			continue;
+		}
+		if (m_statIndex.find(m_labels[i]) != m_statIndex.end()) {
+			continue;
+		}
+		m_statIndex[m_labels[i]] = (int)m_statLabels.size();
+		m_statLabels.push_back(m_labels[i]);
+		m_statAgents.push_back((i == AGENT_BIN) || (i == AGENT_TERN));
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_dissonant::getStatistics -- Count the dissonance labels in a file.
+//     Only the initial classification of the dissonances is done: the
+//     input file is not modified, so suppression and colorization of the
+//     dissonances are skipped.  prepareStatisticsLabels() must be called
+//     before this function.
+//
+
+void Tool_dissonant::getStatistics(HumdrumFile& infile, vector<int>& counts,
+		int& voices) {
+	counts.assign(m_statLabels.size(), 0);
+
+	NoteGrid grid(infile);
+	voices = grid.getVoiceCount();
+
+	vector<vector<string>> results(voices);
+	for (int i=0; i<(int)results.size(); i++) {
+		results[i].resize(infile.getLineCount());
+	}
+	vector<vector<NoteCell*>> attacks;
+	doAnalysis(results, grid, attacks, false);
+
+	for (int i=0; i<(int)results.size(); i++) {
+		for (int j=0; j<(int)results[i].size(); j++) {
+			if (results[i][j].empty()) {
+				continue;
+			}
+			auto it = m_statIndex.find(results[i][j]);
+			if (it != m_statIndex.end()) {
+				counts[it->second]++;
+			}
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_dissonant::printStatisticsHeader -- Print the exclusive
+//     interpretations for the --statistics table.  The **total column
+//     does not include suspension agents.
+//
+
+void Tool_dissonant::printStatisticsHeader(ostream& out) {
+	out << "**file\t**voices\t**total";
+	for (int i=0; i<(int)m_statLabels.size(); i++) {
+		out << "\t**" << m_statLabels[i];
+	}
+	out << endl;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_dissonant::printStatisticsLine -- Print the dissonance counts
+//     for a single file in the --statistics table.
+//
+
+void Tool_dissonant::printStatisticsLine(ostream& out, const string& filename,
+		vector<int>& counts, int voices) {
+	int total = 0;
+	for (int i=0; i<(int)counts.size(); i++) {
+		if (!m_statAgents.at(i)) {
+			total += counts[i];
+		}
+	}
+	out << (filename.empty() ? "." : filename);
+	out << "\t" << voices;
+	out << "\t" << total;
+	for (int i=0; i<(int)m_statLabels.size(); i++) {
+		out << "\t" << (i < (int)counts.size() ? counts[i] : 0);
+	}
+	out << endl;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_dissonant::printStatisticsFooter -- Print the spine terminators
+//     for the --statistics table.
+//
+
+void Tool_dissonant::printStatisticsFooter(ostream& out) {
+	out << "*-\t*-\t*-";
+	for (int i=0; i<(int)m_statLabels.size(); i++) {
+		out << "\t*-";
+	}
+	out << endl;
+}
+
+
+
 //////////////////////////////
 //
 // Tool_dissonant::getNextPitchAttackIndex -- Get the [line] index of the next
@@ -83385,10 +92069,8 @@ void Tool_esac2hum::printPdfLinks(ostream& output) {
 //
 
 void Tool_esac2hum::printConversionDate(ostream& output) {
-	std::time_t t = std::time(nullptr);
-	std::tm* now = std::localtime(&t);
 	output << "!!!ONB: Converted on ";
-	output << std::put_time(now, "%Y/%m/%d");
+	output << Convert::getCurrentDate();
 	output << " with esac2hum" << endl;
 }
 
@@ -85725,6 +94407,7 @@ Tool_extract::Tool_extract(void) {
 	define("empty|empties=b",           "only keep spines with only null data tokens");
 	define("spine-list=b",              "show spine list and then exit");
 	define("no-rest|no-rests=b",        "remove **kern spines containing only rests (and their co-spines)");
+	define("stream=b",                  "process input line-by-line without storing the file (-f, -k, -K, -i, -I, -x only)");
 
 	define("debug=b",                   "print debugging information");
 	define("author=b",                  "author of the program");
@@ -85785,6 +94468,429 @@ bool Tool_extract::run(HumdrumFile& infile) {
 
 
 
+//////////////////////////////
+//
+// Tool_extract::run -- Streaming processing of input data.  The input is
+//     read one line at a time, and only the track assignments of the
+//     currently active spines are stored, so memory usage is independent
+//     of the input size.  Only simple spine selections are allowed: field
+//     lists without subspine or model letters (-f, -k, -K), exclusion
+//     lists (-x), and exclusive interpretation selections (-i, -I, which
+//     can only match exclusive interpretations when streaming).  Track
+//     numbers in field lists (including "$") refer to the spines on the
+//     first exclusive interpretation line of each segment.  Concatenated
+//     files (where all spines are terminated before the next set of
+//     exclusive interpretations) are processed as separate segments, with
+//     the spine selection recalculated for each segment.
+//
+
+bool Tool_extract::run(istream& input, ostream& out) {
+	m_streamTracks.clear();
+	m_streamMaxTrack = 0;
+	bool status = true;
+	int lineindex = 0;
+	string line;
+	vector<string> tokens;
+	while (getline(input, line)) {
+		lineindex++;
+		if (!line.empty() && (line.back() == '\r')) {
+			line.pop_back();
+		}
+		if (!processStreamLine(line, tokens)) {
+			m_error_text << "Error on line " << lineindex << ": " << line << endl;
+			status = false;
+			break;
+		}
+		if (m_humdrum_text.tellp() > 0x10000) {
+			flushStreamOutput(out);
+		}
+	}
+	flushStreamOutput(out);
+	if (status && !m_streamTracks.empty()) {
+		m_warning_text << "Warning: input data does not terminate all spines" << endl;
+	}
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::flushStreamOutput -- Move the buffered Humdrum output
+//     text to the output stream.
+//
+
+void Tool_extract::flushStreamOutput(ostream& out) {
+	out << m_humdrum_text.str();
+	m_humdrum_text.str("");
+	m_humdrum_text.clear();
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::processStreamLine -- Extract the selected fields from a
+//     line of streamed input and update the spine tracks for any spine
+//     manipulators on the line.  Returns false if the line could not be
+//     processed.
+//
+
+bool Tool_extract::processStreamLine(const string& line, vector<string>& tokens) {
+	bool spinedQ = !line.empty() && (line.compare(0, 2, "!!") != 0);
+	if (!spinedQ) {
+		m_humdrum_text << line << '\n';
+		return true;
+	}
+
+	tokens.clear();
+	size_t start = 0;
+	size_t tab;
+	while ((tab = line.find('\t', start)) != string::npos) {
+		tokens.push_back(line.substr(start, tab - start));
+		start = tab + 1;
+	}
+	tokens.push_back(line.substr(start));
+
+	if (m_streamTracks.empty()) {
+		if (line.compare(0, 2, "**") != 0) {
+			m_error_text << "Error: data found before exclusive interpretations" << endl;
+			return false;
+		}
+		if (!prepareStreamSegment(line, (int)tokens.size())) {
+			return false;
+		}
+	} else if (tokens.size() != m_streamTracks.size()) {
+		m_error_text << "Error: expected " << m_streamTracks.size()
+		             << " fields but found " << tokens.size() << endl;
+		return false;
+	} else if (interpQ) {
+		// Check the exclusive interpretations of spines added with *+:
+		for (int j=0; j<(int)tokens.size(); j++) {
+			if (tokens[j].compare(0, 2, "**") != 0) {
+				continue;
+			}
+			bool found = false;
+			for (int k=0; k<(int)m_streamInterps.size(); k++) {
+				if (m_streamInterps[k] == tokens[j]) {
+					found = true;
+					break;
+				}
+			}
+			if (found == (interpstate != 0)) {
+				field.push_back(m_streamTracks[j]);
+				subfield.push_back(0);
+				model.push_back(0);
+			}
+		}
+	}
+
+	bool manipQ = false;
+	for (int j=0; j<(int)tokens.size(); j++) {
+		const string& token = tokens[j];
+		if ((token == "*^") || (token == "*v") || (token == "*x") ||
+				(token == "*+") || (token == "*-") ||
+				(token.compare(0, 2, "**") == 0)) {
+			manipQ = true;
+			break;
+		}
+	}
+
+	if (excludeQ) {
+		printStreamExcludedFields(tokens);
+	} else if (manipQ) {
+		printStreamManipulatorFields(tokens);
+	} else {
+		printStreamFields(tokens);
+	}
+
+	if (manipQ) {
+		updateStreamTracks(tokens);
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::prepareStreamSegment -- Calculate the spine selection for a
+//     new segment of streamed input from its exclusive interpretation line.
+//
+
+bool Tool_extract::prepareStreamSegment(const string& exinterps, int count) {
+	m_streamTracks.resize(count);
+	for (int i=0; i<count; i++) {
+		m_streamTracks[i] = i + 1;
+	}
+	m_streamMaxTrack = count;
+
+	// A minimal Humdrum file containing only the exclusive interpretations
+	// is sufficient for the spine-selection functions.
+	string header = exinterps;
+	header += '\n';
+	for (int i=0; i<count; i++) {
+		if (i > 0) {
+			header += '\t';
+		}
+		header += "*-";
+	}
+	header += '\n';
+	HumdrumFile infile;
+	infile.readString(header);
+	initialize(infile);
+
+	if (countQ || expandQ || reverseQ || removerestQ || grepQ || emptyQ ||
+			noEmptyQ || traceQ || spineListQ) {
+		m_error_text << "Error: only -f, -k, -K, -i, -I and -x options "
+		             << "can be used with --stream" << endl;
+		return false;
+	}
+
+	if (interpQ) {
+		getInterpretationFields(field, subfield, model, infile, interps,
+				interpstate);
+		HumRegex hre;
+		string buffer = interps;
+		hre.replaceDestructive(buffer, "", "\\s+", "g");
+		m_streamInterps.clear();
+		stringstream ss(buffer);
+		string interp;
+		while (getline(ss, interp, ',')) {
+			if (!interp.empty()) {
+				m_streamInterps.push_back(interp);
+			}
+		}
+	} else if (fieldQ || excludeQ) {
+		fillFieldData(field, subfield, model, fieldstring, infile);
+	} else {
+		// extract all spines
+		field.resize(count);
+		for (int i=0; i<count; i++) {
+			field[i] = i + 1;
+		}
+		subfield.assign(count, 0);
+		model.assign(count, 0);
+	}
+
+	for (int i=0; i<(int)field.size(); i++) {
+		if (subfield[i] || model[i]) {
+			m_error_text << "Error: subspine extraction cannot be used with --stream"
+			             << endl;
+			return false;
+		}
+		if ((field[i] == 0) && addRestsQ) {
+			m_error_text << "Error: rest-filled spines cannot be used with --stream"
+			             << endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::printStreamFields -- Print the selected fields of a streamed
+//     line that does not contain spine manipulators.
+//
+
+void Tool_extract::printStreamFields(vector<string>& tokens) {
+	int start = 0;
+	for (int t=0; t<(int)field.size(); t++) {
+		int target = field[t];
+		if (target == 0) {
+			if (start != 0) {
+				m_humdrum_text << '\t';
+			}
+			start = 1;
+			const string& token = tokens[0];
+			if (token[0] == '!') {
+				m_humdrum_text << "!";
+			} else if (token[0] == '=') {
+				m_humdrum_text << token;
+			} else if (token[0] != '*') {
+				m_humdrum_text << ".";
+			} else if (token.compare(0, 2, "*>") == 0) {
+				// expansion labels and expansion lists
+				m_humdrum_text << token;
+			} else {
+				m_humdrum_text << "*";
+			}
+			continue;
+		}
+		for (int j=0; j<(int)tokens.size(); j++) {
+			if (m_streamTracks[j] != target) {
+				continue;
+			}
+			if (start != 0) {
+				m_humdrum_text << '\t';
+			}
+			start = 1;
+			m_humdrum_text << tokens[j];
+		}
+	}
+	if (start != 0) {
+		m_humdrum_text << '\n';
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::printStreamExcludedFields -- Print the fields of a
+//     streamed line which are not in the exclusion list.
+//
+
+void Tool_extract::printStreamExcludedFields(vector<string>& tokens) {
+	int start = 0;
+	for (int j=0; j<(int)tokens.size(); j++) {
+		if (isInList(m_streamTracks[j], field)) {
+			continue;
+		}
+		if (start != 0) {
+			m_humdrum_text << '\t';
+		}
+		start = 1;
+		m_humdrum_text << tokens[j];
+	}
+	if (start != 0) {
+		m_humdrum_text << '\n';
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::printStreamManipulatorFields -- Streaming equivalent of
+//     dealWithSpineManipulators() for field lists without subspines.
+//
+
+void Tool_extract::printStreamManipulatorFields(vector<string>& tokens) {
+	vector<int> vmanip(tokens.size(), 0);
+	vector<int> xmanip(tokens.size(), 0);
+	for (int j=0; j<(int)tokens.size(); j++) {
+		if (tokens[j] == "*v") {
+			vmanip[j] = 1;
+		}
+		if (tokens[j] == "*x") {
+			xmanip[j] = 1;
+		}
+	}
+
+	int counter = 1;
+	for (int i=1; i<(int)xmanip.size(); i++) {
+		if ((xmanip[i] == 1) && (xmanip[i-1] == 1)) {
+			xmanip[i] = counter;
+			xmanip[i-1] = counter;
+			counter++;
+		}
+	}
+
+	counter = 1;
+	int i = 0;
+	while (i < (int)vmanip.size()) {
+		if (vmanip[i] == 1) {
+			while ((i < (int)vmanip.size()) && (vmanip[i] == 1)) {
+				vmanip[i] = counter;
+				i++;
+			}
+			counter++;
+		}
+		i++;
+	}
+
+	vector<int> fieldoccur(field.size(), 0);
+	vector<int> trackcounter(m_streamMaxTrack + 1, 0);
+	for (int t=0; t<(int)field.size(); t++) {
+		if ((field[t] > 0) && (field[t] < (int)trackcounter.size())) {
+			trackcounter[field[t]]++;
+			fieldoccur[t] = trackcounter[field[t]];
+		}
+	}
+
+	vector<string> tempout;
+	vector<int> vserial;
+	vector<int> xserial;
+	tempout.reserve(tokens.size());
+	vserial.reserve(tokens.size());
+	xserial.reserve(tokens.size());
+
+	for (int t=0; t<(int)field.size(); t++) {
+		int target = field[t];
+		if (target == 0) {
+			if (tokens[0].compare(0, 2, "**") == 0) {
+				tempout.push_back(blankName);
+			} else if (tokens[0] == "*-") {
+				tempout.push_back("*-");
+			} else {
+				tempout.push_back("*");
+			}
+			vserial.push_back(0);
+			xserial.push_back(0);
+			continue;
+		}
+		for (int j=0; j<(int)tokens.size(); j++) {
+			if (m_streamTracks[j] != target) {
+				continue;
+			}
+			tempout.push_back(tokens[j]);
+			xserial.push_back(tokens[j] == "*x" ? fieldoccur[t] * 1000 + xmanip[j] : 0);
+			vserial.push_back(tokens[j] == "*v" ? fieldoccur[t] * 1000 + vmanip[j] : 0);
+		}
+	}
+
+	printManipulatorLine(tempout, vserial, xserial);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::updateStreamTracks -- Update the track numbers of the active
+//     spines after a line of spine manipulators.  Split spines keep the track
+//     of the parent spine, merged spines take the track of the first spine,
+//     and added spines are given a new track number.
+//
+
+void Tool_extract::updateStreamTracks(vector<string>& tokens) {
+	vector<int> newtracks;
+	newtracks.reserve(tokens.size() + 1);
+	int j = 0;
+	while (j < (int)tokens.size()) {
+		const string& token = tokens[j];
+		int track = m_streamTracks[j];
+		if (token == "*^") {
+			newtracks.push_back(track);
+			newtracks.push_back(track);
+		} else if (token == "*v") {
+			newtracks.push_back(track);
+			while ((j + 1 < (int)tokens.size()) && (tokens[j+1] == "*v")) {
+				j++;
+			}
+		} else if ((token == "*x") && (j + 1 < (int)tokens.size()) &&
+				(tokens[j+1] == "*x")) {
+			newtracks.push_back(m_streamTracks[j+1]);
+			newtracks.push_back(track);
+			j++;
+		} else if (token == "*+") {
+			newtracks.push_back(track);
+			newtracks.push_back(++m_streamMaxTrack);
+		} else if (token == "*-") {
+			// spine is terminated
+		} else {
+			newtracks.push_back(track);
+		}
+		j++;
+	}
+	m_streamTracks.swap(newtracks);
+}
+
+
+
 //////////////////////////////
 //
 // Tool_extract::processFile --
@@ -86555,6 +95661,13 @@ void Tool_extract::processFieldEntry(vector<int>& field,
 
 	// convert kern tracks into spine tracks:
 	for (int i=finitsize; i<(int)field.size(); i++) {
+		if (field[i] > maxkerntrack) {
+			m_error_text << "Error: **kern spine " << field[i] << " does not exist" << endl;
+			field.resize(finitsize);
+			subfield.resize(finitsize);
+			model.resize(finitsize);
+			return;
+		}
 		if (field[i] > 0) {
 			spine = ktracks[field[i]-1]->getTrack();
 		   field[i] = spine;
@@ -87375,6 +96488,21 @@ void Tool_extract::dealWithSpineManipulators(HumdrumFile& infile, int line,
 		m_humdrum_text << "\n";
 	}
 
+	printManipulatorLine(tempout, vserial, xserial);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::printManipulatorLine -- Fix the *x and *v syntax of the
+//     extracted manipulator tokens and then print them.
+//
+
+void Tool_extract::printManipulatorLine(vector<string>& tempout,
+		vector<int>& vserial, vector<int>& xserial) {
+	int i;
+
 	// check for proper *x syntax /////////////////////////////////
 	for (i=0; i<(int)xserial.size()-1; i++) {
 		if (!xserial[i]) {
@@ -91099,22 +100227,7 @@ void Tool_gasparize::clearStates(void) {
 //
 
 string Tool_gasparize::getDate(void) {
-	time_t t = time(NULL);
-	tm* timeptr = localtime(&t);
-	stringstream ss;
-	int year = timeptr->tm_year + 1900;
-	int month = timeptr->tm_mon + 1;
-	int day = timeptr->tm_mday;
-	ss << year << "/";
-	if (month < 10) {
-		ss << "0";
-	}
-	ss << month << "/";
-	if (day < 10) {
-		ss << "0";
-	}
-	ss << day;
-	return ss.str();
+	return Convert::getCurrentDate();
 }
 
 
@@ -92986,7 +102099,7 @@ void Tool_hproof::markNonChordTones(HumdrumFile& infile) {
 		}
 	}
 	if (hlist.empty()) {
-		cerr << "Warning: No **harm or **rhrm spines in data" << endl;
+		m_warning_text << "Warning: No **harm or **rhrm spines in data" << endl;
 		return;
 	}
 
@@ -93494,6 +102607,7 @@ Tool_humdiff::Tool_humdiff(void) {
 	define("time-points|times=b", "display timepoint lists for each file");
 	define("note-points|notes=b", "display notepoint lists for each file");
 	define("c|color=s:red",       "color for difference markers");
+	define("a|align=b",           "align files by measure and time-slice content (allows inserted or deleted measures)");
 }
 
 
@@ -93523,20 +102637,34 @@ bool Tool_humdiff::run(HumdrumFileSet& infiles) {
 		cerr << "Usage: " << getCommand() << " files" << endl;
 		return false;
 	} else {
+		bool alignQ = getBoolean("align");
 		HumNum targetdur = infiles[0].getScoreDuration();
 		for (int i=1; i<infiles.getSize(); i++) {
 			HumNum dur = infiles[i].getScoreDuration();
-			if (dur != targetdur) {
+			if ((dur != targetdur) && !alignQ) {
 				cerr << "Error: all files must have the same duration" << endl;
 				return false;
 			}
 		}
 
+		m_sliceIds.clear();
+		m_measureIds.clear();
+		SliceSequence refslices;
+		if (alignQ) {
+			extractSlices(refslices, infiles[reference]);
+		}
+
 		for (int i=0; i<infiles.getCount(); i++) {
 			if (i == reference) {
 				continue;
 			}
-			compareFiles(infiles[reference], infiles[i]);
+			if (alignQ) {
+				SliceSequence altslices;
+				extractSlices(altslices, infiles[i]);
+				alignFiles(refslices, altslices);
+			} else {
+				compareFiles(infiles[reference], infiles[i]);
+			}
 		}
 
 		if (!getBoolean("report")) {
@@ -93577,6 +102705,284 @@ void Tool_humdiff::compareFiles(HumdrumFile& reference, HumdrumFile& alternate)
 
 
 
+//////////////////////////////
+//
+// Tool_humdiff::extractSlices -- Extract the time points of a file, and
+//     give each time point and measure an id for its note content, so
+//     that files can be aligned by comparing ids.  The ids are shared by
+//     all files compared with the tool.
+//
+
+void Tool_humdiff::extractSlices(SliceSequence& slices, HumdrumFile& infile) {
+	slices.clear();
+	slices.file = &infile;
+	extractTimePoints(slices.timepoints, infile);
+	if (getBoolean("time-points")) {
+		printTimePoints(slices.timepoints);
+	}
+
+	// measure segment of each line (counting barlines):
+	vector<int> segments(infile.getLineCount(), 0);
+	int segment = 0;
+	for (int i=0; i<infile.getLineCount(); i++) {
+		if (infile[i].isBarline()) {
+			segment++;
+		}
+		segments[i] = segment;
+	}
+
+	vector<NotePoint> notelist;
+	vector<vector<int>> notes;
+	vector<int> content;
+	vector<int> measurecontent;
+	int lastsegment = -1;
+	for (int i=0; i<(int)slices.timepoints.size(); i++) {
+		int line = slices.timepoints[i].index.at(0);
+		HumNum position = infile[line].getDurationFromBarline();
+		if (segments[line] != lastsegment) {
+			if (i > 0) {
+				slices.measureids.push_back(getContentId(m_measureIds, measurecontent));
+			}
+			measurecontent.clear();
+			slices.measurestarts.push_back(i);
+			slices.measuretimes.push_back(slices.timepoints[i].timestamp - position);
+			lastsegment = segments[line];
+		}
+
+		notelist.clear();
+		getNoteList(notelist, infile, line, slices.timepoints[i].measure, 0, i);
+		notes.resize(notelist.size());
+		for (int j=0; j<(int)notelist.size(); j++) {
+			notes[j] = { notelist[j].b40, notelist[j].duration.getNumerator(),
+					notelist[j].duration.getDenominator() };
+		}
+		sort(notes.begin(), notes.end());
+
+		content.clear();
+		content.push_back(position.getNumerator());
+		content.push_back(position.getDenominator());
+		for (int j=0; j<(int)notes.size(); j++) {
+			content.insert(content.end(), notes[j].begin(), notes[j].end());
+		}
+		int id = getContentId(m_sliceIds, content);
+		slices.sliceids.push_back(id);
+		measurecontent.push_back(id);
+	}
+	if (!slices.timepoints.empty()) {
+		slices.measureids.push_back(getContentId(m_measureIds, measurecontent));
+	}
+	slices.measurestarts.push_back((int)slices.timepoints.size());
+}
+
+
+
+//////////////////////////////
+//
+// Tool_humdiff::getContentId -- Return the id for the given content,
+//     adding a new id if the content has not been seen before.
+//
+
+int Tool_humdiff::getContentId(map<vector<int>, int>& ids,
+		const vector<int>& content) {
+	auto it = ids.find(content);
+	if (it != ids.end()) {
+		return it->second;
+	}
+	int id = (int)ids.size();
+	ids[content] = id;
+	return id;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_humdiff::alignFiles -- Align the measures of two files by their
+//     content ids.  Measures which are the same in both files have no
+//     differences to mark, so only the regions between them are compared
+//     in more detail.
+//
+
+void Tool_humdiff::alignFiles(SliceSequence& reference, SliceSequence& alternate) {
+	vector<pair<int, int>> matches;
+	int rcount = (int)reference.measureids.size();
+	int acount = (int)alternate.measureids.size();
+	diffSequences(matches, reference.measureids, 0, rcount,
+			alternate.measureids, 0, acount);
+
+	int r = 0;
+	int a = 0;
+	for (int i=0; i<=(int)matches.size(); i++) {
+		int rnext = i < (int)matches.size() ? matches[i].first  : rcount;
+		int anext = i < (int)matches.size() ? matches[i].second : acount;
+		if (r < rnext) {
+			// measures in the reference which are changed or missing
+			// in the alternate:
+			HumNum rbase = reference.measuretimes.at(r);
+			HumNum abase = a < acount ? alternate.measuretimes.at(a) :
+					alternate.file->getScoreDuration();
+			compareRegion(reference, reference.measurestarts.at(r),
+					reference.measurestarts.at(rnext), rbase, alternate,
+					alternate.measurestarts.at(a), alternate.measurestarts.at(anext),
+					abase);
+		}
+		r = rnext + 1;
+		a = anext + 1;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_humdiff::compareRegion -- Align the time points in a range of
+//     measures which differ between the two files.  Time points with the
+//     same content (including position in the measure) are matched, and
+//     the runs of time points between them are compared note by note.
+//     rbase and abase are the starting times of the region in each file.
+//
+
+void Tool_humdiff::compareRegion(SliceSequence& reference, int r1, int r2,
+		HumNum rbase, SliceSequence& alternate, int a1, int a2, HumNum abase) {
+	vector<pair<int, int>> matches;
+	diffSequences(matches, reference.sliceids, r1, r2, alternate.sliceids, a1, a2);
+
+	int r = r1;
+	int a = a1;
+	for (int i=0; i<=(int)matches.size(); i++) {
+		int rnext = i < (int)matches.size() ? matches[i].first  : r2;
+		int anext = i < (int)matches.size() ? matches[i].second : a2;
+		if (r < rnext) {
+			compareRun(reference, r, rnext, rbase, alternate, a, anext, abase);
+		}
+		if (i < (int)matches.size()) {
+			rbase = reference.timepoints.at(rnext).timestamp;
+			abase = alternate.timepoints.at(anext).timestamp;
+		}
+		r = rnext + 1;
+		a = anext + 1;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_humdiff::compareRun -- Compare the notes of time points in the two
+//     files which occur at the same time after the start of the run
+//     (rbase and abase), marking notes in the reference which do not
+//     have a match.
+//
+
+void Tool_humdiff::compareRun(SliceSequence& reference, int r1, int r2,
+		HumNum rbase, SliceSequence& alternate, int a1, int a2, HumNum abase) {
+	vector<vector<TimePoint>> timepoints(2);
+	for (int i=r1; i<r2; i++) {
+		timepoints[0].push_back(reference.timepoints.at(i));
+		timepoints[0].back().timestamp -= rbase;
+	}
+	for (int i=a1; i<a2; i++) {
+		timepoints[1].push_back(alternate.timepoints.at(i));
+		timepoints[1].back().timestamp -= abase;
+	}
+	compareTimePoints(timepoints, *reference.file, *alternate.file);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_humdiff::diffSequences -- Find the longest common subsequence of
+//     a[a1..a2) and b[b1..b2) with Myers' O(ND) difference algorithm, so
+//     that the time depends on the number of differences D.  The matched
+//     index pairs are stored in increasing order.  If the sequences have
+//     too many differences, only their common prefix and suffix are
+//     matched, and false is returned.
+//
+
+bool Tool_humdiff::diffSequences(vector<pair<int, int>>& matches,
+		const vector<int>& a, int a1, int a2, const vector<int>& b, int b1,
+		int b2) {
+	matches.clear();
+	vector<pair<int, int>> suffix;
+	while ((a1 < a2) && (b1 < b2) && (a[a1] == b[b1])) {
+		matches.emplace_back(a1++, b1++);
+	}
+	while ((a1 < a2) && (b1 < b2) && (a[a2-1] == b[b2-1])) {
+		suffix.emplace_back(--a2, --b2);
+	}
+
+	bool status = true;
+	int n = a2 - a1;
+	int m = b2 - b1;
+	if ((n > 0) && (m > 0)) {
+		// trace[d][k+d+1]: furthest x reached on diagonal k (x-y) before
+		// step d.
+		const int maxd = 2000;
+		int offset = n + m + 1;
+		vector<int> v(2 * offset + 1, 0);
+		vector<vector<int>> trace;
+		bool done = false;
+		for (int d=0; (d <= n + m) && !done; d++) {
+			if (d > maxd) {
+				status = false;
+				break;
+			}
+			trace.emplace_back(v.begin() + offset - d - 1, v.begin() + offset + d + 2);
+			for (int k=-d; k<=d; k+=2) {
+				int x;
+				if ((k == -d) || ((k != d) && (v[offset+k-1] < v[offset+k+1]))) {
+					x = v[offset+k+1];
+				} else {
+					x = v[offset+k-1] + 1;
+				}
+				int y = x - k;
+				while ((x < n) && (y < m) && (a[a1+x] == b[b1+y])) {
+					x++;
+					y++;
+				}
+				v[offset+k] = x;
+				if ((x >= n) && (y >= m)) {
+					done = true;
+					break;
+				}
+			}
+		}
+
+		if (status) {
+			// Follow the edit path back from the end to collect the diagonals:
+			vector<pair<int, int>> middle;
+			int x = n;
+			int y = m;
+			for (int d=(int)trace.size()-1; d>=0; d--) {
+				vector<int>& t = trace[d];
+				int k = x - y;
+				int prevk;
+				if ((k == -d) || ((k != d) && (t[k-1+d+1] < t[k+1+d+1]))) {
+					prevk = k + 1;
+				} else {
+					prevk = k - 1;
+				}
+				int prevx = t[prevk+d+1];
+				int prevy = prevx - prevk;
+				while ((x > prevx) && (y > prevy)) {
+					x--;
+					y--;
+					middle.emplace_back(a1 + x, b1 + y);
+				}
+				x = prevx;
+				y = prevy;
+			}
+			matches.insert(matches.end(), middle.rbegin(), middle.rend());
+		}
+	}
+
+	matches.insert(matches.end(), suffix.rbegin(), suffix.rend());
+	return status;
+}
+
+
+
 //////////////////////////////
 //
 // Tool_humdiff::printTimePoints --
@@ -94157,7 +103563,7 @@ void Tool_humsheet::printRowClasses(HumdrumFile& infile, int row) {
 	}
 	HTp token = hl->token(0);
 	if (token->compare(0, 2, "!!") == 0) {
-		if ((token->size() == 2) || (token->at(3) != '!')) {
+		if ((token->size() == 2) || (token->at(2) != '!')) {
 			classes += "gcommet ";
 		}
 	}
@@ -95686,7 +105092,119 @@ string Tool_humtr::transliterateTextOverlapping(const string& input) {
 
 
 
-int Tool_imitation::Enumerator = 0;
+//////////////////////////////
+//
+// ImitationSequenceIndex::build -- Create a suffix array of the symbol
+//     sequences (non-negative integers), the longest common prefix of
+//     suffixes adjacent in the array, and a range-minimum table of the
+//     common prefix lengths.
+//
+
+void ImitationSequenceIndex::build(vector<vector<int>>& sequences) {
+	// Concatenate the sequences with a unique (negative) separator
+	// after each one, so that no common prefix crosses sequences:
+	vector<int> text;
+	m_offsets.resize(sequences.size());
+	for (int i=0; i<(int)sequences.size(); i++) {
+		m_offsets.at(i) = (int)text.size();
+		text.insert(text.end(), sequences.at(i).begin(), sequences.at(i).end());
+		text.push_back(-1 - i);
+	}
+	int n = (int)text.size();
+	m_rank.resize(n);
+	m_minimums.clear();
+	if (n == 0) {
+		return;
+	}
+
+	// Suffix array by prefix doubling:
+	vector<int> suffixes(n);
+	vector<int> newrank(n);
+	for (int i=0; i<n; i++) {
+		suffixes[i] = i;
+		m_rank[i] = text[i];
+	}
+	for (int k=1; ; k *= 2) {
+		auto lessthan = [&](int a, int b) {
+			if (m_rank[a] != m_rank[b]) {
+				return m_rank[a] < m_rank[b];
+			}
+			int ra = a + k < n ? m_rank[a + k] : -1;
+			int rb = b + k < n ? m_rank[b + k] : -1;
+			return ra < rb;
+		};
+		sort(suffixes.begin(), suffixes.end(), lessthan);
+		newrank[suffixes[0]] = 0;
+		for (int i=1; i<n; i++) {
+			newrank[suffixes[i]] = newrank[suffixes[i-1]] +
+					(lessthan(suffixes[i-1], suffixes[i]) ? 1 : 0);
+		}
+		m_rank = newrank;
+		if (m_rank[suffixes[n-1]] == n - 1) {
+			break;
+		}
+	}
+
+	// Common prefix length of each suffix with the previous one in the
+	// suffix array (Kasai's algorithm):
+	vector<int> lcp(n, 0);
+	int h = 0;
+	for (int i=0; i<n; i++) {
+		if (m_rank[i] == 0) {
+			h = 0;
+			continue;
+		}
+		int j = suffixes[m_rank[i] - 1];
+		while ((i + h < n) && (j + h < n) && (text[i + h] == text[j + h])) {
+			h++;
+		}
+		lcp[m_rank[i]] = h;
+		if (h > 0) {
+			h--;
+		}
+	}
+
+	// Sparse table for range minimums of the prefix lengths:
+	m_minimums.push_back(lcp);
+	for (int k=1; (1 << k) <= n; k++) {
+		vector<int>& previous = m_minimums.back();
+		vector<int> current(n - (1 << k) + 1);
+		for (int i=0; i<(int)current.size(); i++) {
+			current[i] = std::min(previous[i], previous[i + (1 << (k - 1))]);
+		}
+		m_minimums.push_back(current);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// ImitationSequenceIndex::getMatchLength -- Return the number of equal
+//     symbols at the start of two positions in the sequences.
+//
+
+int ImitationSequenceIndex::getMatchLength(int seq1, int index1, int seq2,
+		int index2) const {
+	int a = m_rank.at(m_offsets.at(seq1) + index1);
+	int b = m_rank.at(m_offsets.at(seq2) + index2);
+	if (a == b) {
+		// same position
+		int end = seq1 + 1 < (int)m_offsets.size() ? m_offsets.at(seq1 + 1) :
+				(int)m_rank.size();
+		return end - 1 - m_offsets.at(seq1) - index1;
+	}
+	if (a > b) {
+		std::swap(a, b);
+	}
+	a++;
+	int k = 0;
+	while ((1 << (k + 1)) <= b - a + 1) {
+		k++;
+	}
+	return std::min(m_minimums[k][a], m_minimums[k][b - (1 << k) + 1]);
+}
+
 
 
 /////////////////////////////////
@@ -95772,16 +105290,20 @@ bool Tool_imitation::run(HumdrumFile& infile, ostream& out) {
 
 
 bool Tool_imitation::run(HumdrumFile& infile) {
-	Enumerator = 0;
+	m_enumerator = 0;
 
 	NoteGrid grid(infile);
+	if (grid.getVoiceCount() == 0) {
+		// no **kern spines, or spine structure that the grid cannot handle
+		return false;
+	}
 
 	if (getBoolean("debug")) {
 		grid.printGridInfo(cerr);
 		// return 1;
 	}
 
-	Enumerator = 0;
+	m_enumerator = 0;
 	m_threshold = getInteger("threshold") + 1;
 	if (m_threshold < 3) {
 		m_threshold = 3;
@@ -95877,7 +105399,7 @@ bool Tool_imitation::run(HumdrumFile& infile) {
 			infile.insertDataSpineBefore(track, results.at(i-1), "", exinterp);
 		}
 	}
-	if (m_mark && Enumerator) {
+	if (m_mark && m_enumerator) {
 		string rdfline = "!!!RDF**kern: ";
 		rdfline += m_marker;
 		rdfline += " = marked note (color=\"chocolate\")";
@@ -95923,6 +105445,8 @@ void Tool_imitation::doAnalysis(vector<vector<string> >& results,
 		getIntervals(intervals.at(i), attacks.at(i));
 	}
 
+	buildSequenceIndex(attacks, intervals);
+
 	for (int i=0; i<(int)attacks.size(); i++) {
 		for (int j=i+1; j<(int)attacks.size(); j++) {
 			analyzeImitation(results, attacks, intervals, i, j);
@@ -95956,6 +105480,69 @@ void Tool_imitation::getIntervals(vector<double>& intervals,
 
 
 
+//////////////////////////////
+//
+// Tool_imitation::buildSequenceIndex -- Convert the interval sequence of
+//     each voice into a list of integer symbols, one for each note, which
+//     are equal when compareSequences() would continue a match (the
+//     interval to the next note, or a rest, and the duration of the note
+//     if durations are also being matched).  When searching for
+//     inversions, the negated intervals of each voice are added after the
+//     original sequences.  A suffix array of all sequences is then used to
+//     find the length of the match between any two notes.
+//
+
+void Tool_imitation::buildSequenceIndex(vector<vector<NoteCell*>>& attacks,
+		vector<vector<double>>& intervals) {
+	map<std::tuple<bool, double, int, int>, int> symbols;
+	int voiceCount = (int)attacks.size();
+	m_sequences.resize(m_inversion ? 2 * voiceCount : voiceCount);
+	for (int v=0; v<(int)m_sequences.size(); v++) {
+		int voice = v % voiceCount;
+		double sign = v < voiceCount ? 1.0 : -1.0;
+		vector<int>& sequence = m_sequences.at(v);
+		sequence.resize(intervals.at(voice).size());
+		for (int i=0; i<(int)sequence.size(); i++) {
+			HumNum duration = attacks.at(voice).at(i)->getDuration();
+			sequence.at(i) = getSymbol(symbols, sign * intervals.at(voice).at(i), duration);
+		}
+	}
+	m_sequenceIndex.build(m_sequences);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_imitation::getSymbol -- Return the symbol for an interval and
+//     duration, adding a new symbol if it has not been seen before.
+//
+
+int Tool_imitation::getSymbol(map<std::tuple<bool, double, int, int>, int>& symbols,
+		double interval, HumNum duration) {
+	bool restQ = Convert::isNaN(interval);
+	if (restQ) {
+		interval = 0.0;
+	} else if (interval == 0.0) {
+		// -0.0 from inversions
+		interval = 0.0;
+	}
+	if (!m_duration) {
+		duration = 0;
+	}
+	std::tuple<bool, double, int, int> key(restQ, interval, duration.getNumerator(),
+			duration.getDenominator());
+	auto it = symbols.find(key);
+	if (it != symbols.end()) {
+		return it->second;
+	}
+	int symbol = (int)symbols.size();
+	symbols[key] = symbol;
+	return symbol;
+}
+
+
+
 //////////////////////////////
 //
 // Tool_imitation::analyzeImitation -- do imitation analysis between two voices.
@@ -95976,14 +105563,34 @@ void Tool_imitation::analyzeImitation(vector<vector<string>>& results,
 	vector<int> enum1(v1a.size(), 0);
 	vector<int> enum2(v2a.size(), 0);
 
+	// Notes in the second voice grouped by their first symbol: only notes
+	// starting with the same symbol as a note in the first voice can
+	// start a match with it.
+	int s1 = v1;
+	int s2 = m_inversion ? v2 + (int)attacks.size() : v2;
+	map<int, vector<int>> starts;
+	for (int j=0; j<(int)v2i.size() - 1; j++) {
+		starts[m_sequences.at(s2).at(j)].push_back(j);
+	}
+
 	for (int i=0; i<(int)v1i.size() - 1; i++) {
 		count = 0;
-		for (int j=0; j<(int)v2i.size() - 1; j++) {
-			if (m_rest || m_rest2) {
-				if ((i > 0) && (!Convert::isNaN(attacks.at(v1).at(i-1)->getSgnDiatonicPitch()))) {
-					// match initiator must be preceded by a rest (or start of music)
-					continue;
-				}
+		if (m_rest || m_rest2) {
+			if ((i > 0) && (!Convert::isNaN(attacks.at(v1).at(i-1)->getSgnDiatonicPitch()))) {
+				// match initiator must be preceded by a rest (or start of music)
+				continue;
+			}
+		}
+		auto found = starts.find(m_sequences.at(s1).at(i));
+		if (found == starts.end()) {
+			continue;
+		}
+		vector<int>& candidates = found->second;
+		int nextj = 0; // notes before nextj are skipped after a match
+		for (int c=0; c<(int)candidates.size(); c++) {
+			int j = candidates.at(c);
+			if (j < nextj) {
+				continue;
 			}
 			if (m_rest2) {
 				if ((j > 0) && (!Convert::isNaN(attacks.at(v2).at(j-1)->getSgnDiatonicPitch()))) {
@@ -95995,12 +105602,13 @@ void Tool_imitation::analyzeImitation(vector<vector<string>>& results,
 				// avoid re-matching an existing match as a submatch
 				continue;
 			}
-			count = compareSequences(v1a, v1i, i, v2a, v2i, j);
+			int length = m_sequenceIndex.getMatchLength(s1, i, s2, j);
+			count = compareSequences(v1a, v1i, i, v2a, v2i, j, length);
 			if ((count >= min) && (m_intervals.size() > 0)) {
 				count = checkForIntervalSequence(m_intervals, v1i, i, count);
 			}
 			if (count < min) {
-				j += count;
+				nextj = j + count + 1;
 				continue;
 			}
 
@@ -96013,14 +105621,14 @@ void Tool_imitation::analyzeImitation(vector<vector<string>>& results,
 			HumNum distance2 = time1 - time2;
 
 			if (m_maxdistanceQ && (distance1.getAbs().getFloat() > m_maxdistance)) {
-				j += count;
+				nextj = j + count + 1;
 				continue;
 			}
 
-			Enumerator++;
+			m_enumerator++;
 			for (int k=0; k<count; k++) {
-				enum1.at(i+k) = Enumerator;
-				enum2.at(j+k) = Enumerator;
+				enum1.at(i+k) = m_enumerator;
+				enum2.at(j+k) = m_enumerator;
 			}
 
 			int interval = int(*attacks.at(v2).at(j) - *attacks.at(v1).at(i));
@@ -96043,7 +105651,7 @@ void Tool_imitation::analyzeImitation(vector<vector<string>>& results,
 						} else {
 							results.at(v1).at(line1) += "n";
 						}
-						results.at(v1).at(line1) += to_string(Enumerator);
+						results.at(v1).at(line1) += to_string(m_enumerator);
 					}
 
 					if (m_measure) {
@@ -96150,7 +105758,7 @@ void Tool_imitation::analyzeImitation(vector<vector<string>>& results,
 						} else {
 							results.at(v2).at(line2) += "n";
 						}
-						results.at(v2).at(line2) += to_string(Enumerator);
+						results.at(v2).at(line2) += to_string(m_enumerator);
 					}
 
 					if (m_measure) {
@@ -96277,7 +105885,7 @@ void Tool_imitation::analyzeImitation(vector<vector<string>>& results,
 			}
 
 			// skip over match (need to do in i as well somehow)
-			j += count;
+			nextj = j + count + 1;
 		} // j loop
 	} // i loop
 }
@@ -96334,12 +105942,13 @@ int Tool_imitation::checkForIntervalSequence(vector<int>& m_intervals,
 //
 // Tool_imitation::compareSequences -- Returns the number of notes that
 //     match between the two sequences (which is one more than the
-//     interval count).
+//     interval count).  The length is the number of matching symbols
+//     at the start of the sequences from the sequence index.
 //
 
 int Tool_imitation::compareSequences(vector<NoteCell*>& attack1,
 		vector<double>& seq1, int i1, vector<NoteCell*>& attack2,
-		vector<double>& seq2, int i2) {
+		vector<double>& seq2, int i2, int length) {
 	int count = 0;
 	// sequences cannot start with rests
 	if (Convert::isNaN(seq1.at(i1)) || Convert::isNaN(seq2.at(i2))) {
@@ -96357,64 +105966,25 @@ int Tool_imitation::compareSequences(vector<NoteCell*>& attack1,
 		}
 	}
 
-	HumNum dur1;
-	HumNum dur2;
-
-	while ((i1+count < (int)seq1.size()) && (i2+count < (int)seq2.size())) {
-
-		if (m_duration) {
-			dur1 = attack1.at(i1+count)->getDuration();
-			dur2 = attack2.at(i2+count)->getDuration();
-			if (dur1 != dur2) {
-				break;
-			}
-		}
+	count = length;
+	if ((i1+count >= (int)seq1.size()) || (i2+count >= (int)seq2.size())) {
+		// One of the sequences ended while matching.
+		return count;
+	}
 
-		if (Convert::isNaN(seq1.at(i1+count))) {
-			// the first voice's interval is to/from a rest
-			if (Convert::isNaN(seq2.at(i2+count))) {
-				// The seoncd voice's interval is also to/from a rest,
-				// so increment count and continue.
-				count++;
-				continue;
-			} else {
-				// The second voice's interval is not to/from a rest,
-				// so return the current count.
-				if (count) {
-					return count + 1;
-				} else {
-					return count;
-				}
-			}
-		} else if (Convert::isNaN(seq2.at(i2+count))) {
-			// The second voice's interval is to/from a rest
-			// but already know that the first one is not, so return
-			// current count;
-			if (count) {
-				return count + 1;
-			} else {
-				return count;
-			}
-		} else if (m_inversion && (seq1.at(i1+count) == -seq2.at(i2+count))) {
-         // The two sequences match as inversions at this point, so continue.
-			count++;
-		} else if ((!m_inversion) && (seq1.at(i1+count) == seq2.at(i2+count))) {
-         // The two sequences match at this point, so continue.
-			count++;
-			continue;
-		} else {
-			// The sequences do not match so return the current count.
-			if (count) {
-				return count + 1;
-			} else {
-				return count;
-			}
+	if (m_duration) {
+		HumNum dur1 = attack1.at(i1+count)->getDuration();
+		HumNum dur2 = attack2.at(i2+count)->getDuration();
+		if (dur1 != dur2) {
+			// The match ends at a note with a different duration.
+			return count;
 		}
 	}
 
+	// The intervals (or rests) do not match, so include the note at
+	// the end of the last matching interval.
 	if (count) {
-		// don't add one for some reaason (this will cause out-of-bounds)
-		return count;
+		return count + 1;
 	} else {
 		return count;
 	}
@@ -98106,10 +107676,10 @@ bool Tool_mei2hum::convertFile(ostream& out, const char* filename) {
 	xml_document doc;
 	auto result = doc.load_file(filename);
 	if (!result) {
-		cerr << "\nXML file [" << filename << "] has syntax errors\n";
-		cerr << "Error description:\t" << result.description() << "\n";
-		cerr << "Error offset:\t" << result.offset << "\n\n";
-		exit(1);
+		m_error_text << "\nXML file [" << filename << "] has syntax errors\n";
+		m_error_text << "Error description:\t" << result.description() << "\n";
+		m_error_text << "Error offset:\t" << result.offset << "\n\n";
+		return false;
 	}
 
 	return convert(out, doc);
@@ -98126,10 +107696,10 @@ bool Tool_mei2hum::convert(ostream& out, const char* input) {
 	xml_document doc;
 	auto result = doc.load_string(input);
 	if (!result) {
-		cout << "\nXML content has syntax errors\n";
-		cout << "Error description:\t" << result.description() << "\n";
-		cout << "Error offset:\t" << result.offset << "\n\n";
-		exit(1);
+		m_error_text << "\nXML content has syntax errors\n";
+		m_error_text << "Error description:\t" << result.description() << "\n";
+		m_error_text << "Error offset:\t" << result.offset << "\n\n";
+		return false;
 	}
 
 	return convert(out, doc);
@@ -100498,7 +110068,9 @@ HumNum Tool_mei2hum::parseNote(xml_node note, xml_node chord, string& output,
 		output += tok;
 	}
 
-	if (m_xmlidQ) {
+	if (m_xmlidQ && dataslice) {
+		// Chord notes do not have their own slice (the chord is
+		// added to the grid in parseChord()).
 		GridStaff* staff = dataslice->at(m_currentStaff-1)->at(0);
 		// not keeping track of overwriting ids at the moment:
 		string xmlid = note.attribute("xml:id").value();
@@ -100669,7 +110241,9 @@ HumNum Tool_mei2hum::parseNote_mensural(xml_node note, xml_node chord, string& o
 		output += tok;
 	}
 
-	if (m_xmlidQ) {
+	if (m_xmlidQ && dataslice) {
+		// Chord notes do not have their own slice (the chord is
+		// added to the grid in parseChord()).
 		GridStaff* staff = dataslice->at(m_currentStaff-1)->at(0);
 		// not keeping track of overwriting ids at the moment:
 		string xmlid = note.attribute("xml:id").value();
@@ -103600,7 +113174,8 @@ void Tool_melisma::replaceLyrics(HumdrumFile& infile, vector<vector<int>>& count
 
 //////////////////////////////
 //
-// Tool_melisma::getNoteCounts --
+// Tool_melisma::getNoteCounts -- Get the number of notes for each syllable
+//     of the **text spines from the text table of the file.
 //
 
 void Tool_melisma::getNoteCounts(HumdrumFile& infile, vector<vector<int>>& counts) {
@@ -103608,10 +113183,11 @@ void Tool_melisma::getNoteCounts(HumdrumFile& infile, vector<vector<int>>& count
 	initBarlines(infile);
 	HumNum negativeOne = -1;
 	infile.initializeArray(m_endtimes, negativeOne);
-	vector<HTp> lyrics;
-	infile.getSpineStartList(lyrics, "**text");
-	for (int i=0; i<(int)lyrics.size(); i++) {
-		getNoteCountsForLyric(counts, lyrics[i]);
+	const HumTextTable& table = infile.getTextTable();
+	for (int i=0; i<table.getSpineCount(); i++) {
+		if (*table.getSpineStart(i) == "**text") {
+			getNoteCountsForLyric(counts, table, i);
+		}
 	}
 }
 
@@ -103646,21 +113222,15 @@ void Tool_melisma::initBarlines(HumdrumFile& infile) {
 // Tool_melisma::getNoteCountsForLyric --
 //
 
-void Tool_melisma::getNoteCountsForLyric(vector<vector<int>>& counts, HTp lyricStart) {
-	HTp current = lyricStart;
-	while (current) {
-		if (!current->isData()) {
-			current = current->getNextToken();
-			continue;
-		}
-		if (current->isNull()) {
-			current = current->getNextToken();
-			continue;
-		}
-		int line = current->getLineIndex();
-		int field = current->getFieldIndex();
-		counts[line][field] = getCountForSyllable(current);
-		current = current->getNextToken();
+void Tool_melisma::getNoteCountsForLyric(vector<vector<int>>& counts,
+		const HumTextTable& table, int spine) {
+	int start = table.getSpineSyllableStart(spine);
+	int count = table.getSpineSyllableCount(spine);
+	for (int i=start; i<start+count; i++) {
+		HTp token = table.getSyllableToken(i);
+		int line = token->getLineIndex();
+		int field = token->getFieldIndex();
+		counts[line][field] = getCountForSyllable(table, i);
 	}
 }
 
@@ -103668,76 +113238,24 @@ void Tool_melisma::getNoteCountsForLyric(vector<vector<int>>& counts, HTp lyricS
 
 //////////////////////////////
 //
-// Tool_melisma::getCountForSyllable --
+// Tool_melisma::getCountForSyllable -- Return the number of notes for a
+//     syllable and store the end time of its last note.  Syllables ending
+//     in "&" (elisions) are counted as one note.
 //
 
-int Tool_melisma::getCountForSyllable(HTp token) {
+int Tool_melisma::getCountForSyllable(const HumTextTable& table, int syllable) {
+	HTp token = table.getSyllableToken(syllable);
 	if (token->back() == '&') {
 		return 1;
 	}
-	HTp nexttok = token->getNextToken();
-	int eline   = token->getLineIndex();
-	int efield  = token->getFieldIndex();
-	m_endtimes[eline][efield] = token->getDurationFromStart() + token->getDuration();
-	while (nexttok) {
-		if (!nexttok->isData()) {
-			nexttok = nexttok->getNextToken();
-			continue;
-		}
-		if (nexttok->isNull()) {
-			nexttok = nexttok->getNextToken();
-			continue;
-		}
-		// found non-null data token
-		break;
-	}
-
-	HumdrumFile& infile = *token->getOwner()->getOwner();
-	int endline = infile.getLineCount() - 1;
-	if (nexttok) {
-		endline = nexttok->getLineIndex();
-	}
-	int output = 0;
-	HTp current = token->getPreviousFieldToken();
-	while (current) {
-		if (current->isKern()) {
-			break;
-		}
-		current = current->getPreviousFieldToken();
-	}
-	if (!current) {
-		return 0;
-	}
-	while (current) {
-		if (!current->isData()) {
-			current = current->getNextToken();
-			continue;
-		}
-		if (current->isNull()) {
-			current = current->getNextToken();
-			continue;
-		}
-		if (current->isRest()) {
-			current = current->getNextToken();
-			continue;
-		}
-		if (!current->isNoteAttack()) {
-			// ignore tied notes
-			m_endtimes[eline][efield] = current->getDurationFromStart() + current->getDuration();
-			current = current->getNextToken();
-			continue;
-		}
-		int line = current->getLineIndex();
-		if (line < endline) {
-			m_endtimes[eline][efield] = current->getDurationFromStart() + current->getDuration();
-			output++;
-		} else {
-			break;
-		}
-		current = current->getNextToken();
+	int eline  = token->getLineIndex();
+	int efield = token->getFieldIndex();
+	if (table.getLastNote(syllable)) {
+		m_endtimes[eline][efield] = table.getEndTime(syllable);
+	} else {
+		m_endtimes[eline][efield] = token->getDurationFromStart() + token->getDuration();
 	}
-
-	return output;
+	return table.getNoteCount(syllable);
 }
 
 
@@ -104794,19 +114312,18 @@ int Tool_meter::printKernAndAnalysisSpine(HumdrumLine& line, int index, bool pri
 
 //////////////////////////////
 //
-// Tool_meter::getMeterData --
+// Tool_meter::getMeterData -- The time signature and *beat: states of
+//     each track are read from the metric grid of the file.
 //
 
 void Tool_meter::getMeterData(HumdrumFile& infile) {
 
 	int maxtrack = infile.getMaxTrack();
-	vector<HumNum> curNum(maxtrack + 1, 0);
-	vector<HumNum> curDen(maxtrack + 1, 0);
-	vector<HumNum> curBeat(maxtrack + 1, 0);
 	vector<HumNum> curBarTime(maxtrack + 1, 0);
+	const HumMetricTable& grid = infile.getMetricGrid();
 
 	for (int i=0; i<infile.getLineCount(); i++) {
-		processLine(infile[i], curNum, curDen, curBeat, curBarTime);
+		processLine(infile[i], grid, curBarTime);
 	}
 }
 
@@ -104817,8 +114334,7 @@ void Tool_meter::getMeterData(HumdrumFile& infile) {
 // Tool_meter::processLine --
 //
 
-void Tool_meter::processLine(HumdrumLine& line, vector<HumNum>& curNum,
-		vector<HumNum>& curDen, vector<HumNum>& curBeat,
+void Tool_meter::processLine(HumdrumLine& line, const HumMetricTable& grid,
 		vector<HumNum>& curBarTime) {
 
 	int fieldCount = line.getFieldCount();
@@ -104845,30 +114361,8 @@ void Tool_meter::processLine(HumdrumLine& line, vector<HumNum>& curNum,
 		return;
 	}
 
-	if (line.isInterpretation()) {
-		// check for time signatures
-		for (int i=0; i<fieldCount; i++) {
-			HTp token = line.token(i);
-			if (!token->isKern()) {
-				continue;
-			}
-			if (hre.search(token, "^\\*M(\\d+)/(\\d+)")) {
-				int top = hre.getMatchInt(1);
-				int bot = hre.getMatchInt(2);
-				int track = token->getTrack();
-				curNum.at(track) = top;
-				curDen.at(track) = bot;
-				curBeat.at(track) = 0;
-			} else if (hre.search(token, "^\\*beat:\\s*([\\d.%]+)\\s*$")) {
-				int track = token->getTrack();
-				string recip = hre.getMatch(1);
-				curBeat.at(track) = Convert::recipToDuration(recip);
-			}
-		}
-		return;
-	}
-
 	if (line.isData()) {
+		int lineIndex = line.getLineIndex();
 		// check for time signatures
 		for (int i=0; i<fieldCount; i++) {
 			HTp token = line.token(i);
@@ -104886,18 +114380,21 @@ void Tool_meter::processLine(HumdrumLine& line, vector<HumNum>& curNum,
 			}
 			int pickup = token->getValueInt("auto", "pickup");
 			int track = token->getTrack();
+			HumNum curNum  = grid.getMeterTop(lineIndex, track);
+			HumNum curDen  = grid.getMeterBottom(lineIndex, track);
+			HumNum curBeat = grid.getExplicitBeat(lineIndex, track);
 			stringstream value;
 			value.str("");
-			value << curNum.at(track);
+			value << curNum;
 			token->setValue("auto", "numerator", value.str());
 			value.str("");
-			value << curDen.at(track);
+			value << curDen;
 			token->setValue("auto", "denominator", value.str());
 			HumNum curTime = token->getDurationFromStart();
 			HumNum q;
 			if (pickup) {
-				HumNum meterDur = curNum.at(track);
-				meterDur /= curDen.at(track);
+				HumNum meterDur = curNum;
+				meterDur /= curDen;
 				meterDur *= 4;
 				HumNum nbt = getHumNum(token, "nextBarTime");
 				q = meterDur - nbt;
@@ -104908,10 +114405,10 @@ void Tool_meter::processLine(HumdrumLine& line, vector<HumNum>& curNum,
 			value << q;
 			token->setValue("auto", "q", value.str());
 			bool compound = false;
-			int multiple = curNum.at(track).getNumerator() / 3;
-			int remainder = curNum.at(track).getNumerator() % 3;
-			int bottom = curDen.at(track).getNumerator();
-			if ((curBeat.at(track) == 0) && (bottom >= 8) && (multiple > 1) && (remainder == 0)) {
+			int multiple = curNum.getNumerator() / 3;
+			int remainder = curNum.getNumerator() % 3;
+			int bottom = curDen.getNumerator();
+			if ((curBeat == 0) && (bottom >= 8) && (multiple > 1) && (remainder == 0)) {
 				compound = true;
 			}
 
@@ -104929,13 +114426,13 @@ void Tool_meter::processLine(HumdrumLine& line, vector<HumNum>& curNum,
 			} else {
 				// convert quarter note metric positions into beat positions
 				if (compound) {
-					qq *= curDen.at(track);
+					qq *= curDen;
 					qq /= 4;
 					qq /= 3;
-				} else if (curBeat.at(track) > 0) {
-					qq /= curBeat.at(track);
+				} else if (curBeat > 0) {
+					qq /= curBeat;
 				} else {
-					qq *= curDen.at(track);
+					qq *= curDen;
 					qq /= 4;
 				}
 			}
@@ -105075,9 +114572,13 @@ bool Tool_metlev::run(HumdrumFile& infile) {
 		return true;
 	} else if (getBoolean("composite")) {
 		infile.prependDataSpine(beatlev, "nan", exinterp);
-		infile.printFieldIndex(0, m_humdrum_text);
+		// Read the composite spine back from a separate buffer, since
+		// m_humdrum_text may be writing to an output sink:
+		stringstream composite;
+		infile.printFieldIndex(0, composite);
 		infile.clear();
-		infile.readString(m_humdrum_text.str());
+		infile.readString(composite.str());
+		m_humdrum_text << composite.str();
 	} else {
 		vector<vector<double> > results;
 		fillVoiceResults(results, infile, beatlev);
@@ -106673,50 +116174,25 @@ void Tool_modori::printInfo(void) {
 
 //////////////////////////////
 //
-// SonorityDatabase::buildDatabase --
+// SonorityDatabase::buildDatabase -- Copy the notes sounding on a line
+//    from the sonority table of the file.
 //
 
-void SonorityDatabase::buildDatabase(HLp line) {
+void SonorityDatabase::buildDatabase(HumdrumFile& infile, int line) {
 	clear();
-	if (line == NULL) {
+	if ((line < 0) || (line >= infile.getLineCount())) {
 		return;
 	}
-	m_line = line;
-	bool nullQ = false;
-	if (!line->isData()) {
-		return;
-	}
-	int lowesti = 0;
-	int lowest12 = 1000;
-
-	for (int i=0; i<line->getFieldCount(); i++) {
-		HTp token = m_line->token(i);
-		if (!token->isKern()) {
-			continue;
-		}
-		if (token->isRest()) {
-			// ignoring rests, at least for now
-			continue;
-		}
-		if (token->isNull()) {
-			nullQ = true;
-			token = token->resolveNull();
-		}
-		if (token->isNull()) {
-			continue;
-		}
-		int scount = token->getSubtokenCount();
-		for (int j=0; j<scount; j++) {
-			expandList();
-			m_notes.back().setToken(token, nullQ, j);
-			if (m_notes.back().getBase12() < lowest12) {
-				lowesti = (int)m_notes.size() - 1;
-				lowest12 = m_notes.back().getBase12();
-			}
-		}
+	m_line = &infile[line];
+	HumSonority sonority = infile.getSonority(line);
+	int count = sonority.getNoteCount();
+	for (int i=0; i<count; i++) {
+		expandList();
+		m_notes.back().setNote(sonority.getToken(i), sonority.getSubtokenIndex(i),
+				sonority.getBase40(i), sonority.isAttack(i));
 	}
-	if (!m_notes.empty()) {
-		m_lowest = m_notes[lowesti];
+	if (count > 0) {
+		m_lowest = m_notes[sonority.getLowestIndex()];
 	}
 }
 
@@ -106884,70 +116360,34 @@ void Tool_msearch::initialize(void) {
 
 //////////////////////////////
 //
-// Tool_msearch::fillWords --
+// Tool_msearch::fillWords -- Get the words of the **silbe spines (or the
+//     **text spines if there are no **silbe spines) from the text table of
+//     the file.
 //
 
 void Tool_msearch::fillWords(HumdrumFile& infile, vector<TextInfo*>& words) {
-	vector<HTp> textspines;
-	infile.getSpineStartList(textspines, "**silbe");
-	if (textspines.empty()) {
-		infile.getSpineStartList(textspines, "**text");
-	}
-	for (int i=0; i<(int)textspines.size(); i++) {
-		fillWordsForTrack(words, textspines[i]);
-	}
-}
-
-
-
-//////////////////////////////
-//
-// Tool_msearch::fillWordsForTrack --
-//
-
-void Tool_msearch::fillWordsForTrack(vector<TextInfo*>& words,
-		HTp starttoken) {
-	HTp tok = starttoken->getNextToken();
-	while (tok != NULL) {
-		if (tok->empty()) {
-			tok = tok->getNextToken();
-			continue;
-		}
-		if (tok->isNull()) {
-			tok = tok->getNextToken();
-			continue;
+	const HumTextTable& table = infile.getTextTable();
+	string datatype = "**text";
+	for (int i=0; i<table.getSpineCount(); i++) {
+		if (table.getSpineStart(i)->isDataType("**silbe")) {
+			datatype = "**silbe";
+			break;
 		}
-		if (!tok->isData()) {
-			tok = tok->getNextToken();
+	}
+	for (int i=0; i<table.getSpineCount(); i++) {
+		if (!table.getSpineStart(i)->isDataType(datatype)) {
 			continue;
 		}
-		if (tok->at(0) == '-') {
-			// append a syllable to the end of previous word
-			if (!words.empty()) {
-				words.back()->fullword += tok->substr(1, string::npos);
-				if (words.back()->fullword.back() == '-') {
-					words.back()->fullword.pop_back();
-				}
-			}
-			tok = tok->getNextToken();
-			continue;
-		} else {
-			// start a new word
+		int start = table.getSpineWordStart(i);
+		int count = table.getSpineWordCount(i);
+		for (int j=0; j<count; j++) {
 			TextInfo* temp = new TextInfo();
-			temp->nexttoken = NULL;
-			if (!words.empty()) {
-				words.back()->nexttoken = tok;
+			temp->fullword = table.getWordText(start + j);
+			temp->starttoken = table.getWordToken(start + j);
+			if (j < count - 1) {
+				temp->nexttoken = table.getWordToken(start + j + 1);
 			}
-			temp->fullword = *tok;
-			if (!temp->fullword.empty()) {
-				if (temp->fullword.back() == '-') {
-					temp->fullword.pop_back();
-				}
-			}
-			temp->starttoken = tok;
 			words.push_back(temp);
-			tok = tok->getNextToken();
-			continue;
 		}
 	}
 }
@@ -107672,8 +117112,9 @@ bool Tool_msearch::doHarmonicPitchSearch(MSearchQueryToken& query, HTp token) {
 	}
 	m_sonoritiesChecked[lindex] = true;
 	SonorityDatabase& sonorities = m_sonorities[lindex];
-	if (sonorities.isEmpty()) {
-		sonorities.buildDatabase(token->getLine());
+	HumdrumFile* infile = token->getLine()->getOwner();
+	if (sonorities.isEmpty() && infile) {
+		sonorities.buildDatabase(*infile, lindex);
 	}
 
 	bool exactQ = false;
@@ -108693,9 +118134,9 @@ bool Tool_musedata2hum::convertFile(ostream& out, const string& filename) {
 	MuseDataSet mds;
 	int result = mds.readFile(filename);
 	if (!result) {
-		cerr << "\nMuseData file [" << filename << "] has syntax errors\n";
-		cerr << "Error description:\t" << mds.getError() << "\n";
-		exit(1);
+		m_error_text << "\nMuseData file [" << filename << "] has syntax errors\n";
+		m_error_text << "Error description:\t" << mds.getError() << "\n";
+		return false;
 	}
 	return convert(out, mds);
 }
@@ -108712,9 +118153,9 @@ bool Tool_musedata2hum::convertString(ostream& out, const string& input) {
 	MuseDataSet mds;
 	int result = mds.readString(input);
 	if (!result) {
-		cout << "\nXML content has syntax errors\n";
-		cout << "Error description:\t" << mds.getError() << "\n";
-		exit(1);
+		m_error_text << "\nMuseData content has syntax errors\n";
+		m_error_text << "Error description:\t" << mds.getError() << "\n";
+		return false;
 	}
 	return convert(out, mds);
 }
@@ -108906,9 +118347,8 @@ bool Tool_musedata2hum::convert(ostream& out, MuseDataSet& mds) {
 	m_postReferences.clear();
 
 	stringstream ss;
-	auto nowtime = std::chrono::system_clock::now();
-	time_t currenttime = std::chrono::system_clock::to_time_t(nowtime);
-	ss << std::ctime(&currenttime);
+	// same format as ctime():
+	ss << Convert::getCurrentDate("%a %b %e %H:%M:%S %Y\n");
 	out << "!!!ONB: Converted from MuseData with musedata2hum on " << ss.str();
 
 	string copyright = mds[ii].getCopyright();
@@ -115141,7 +124581,10 @@ void Tool_myank::processFile(HumdrumFile& infile) {
 		return;
 	}
 
-	getMetStates(m_metstates, infile);
+	if (m_debugQ) {
+		// metric states are only used for debugging output:
+		getMetStates(m_metstates, infile);
+	}
 	getMeasureStartStop(m_measureInList, infile);
 
 	string measurestring = getString("measures");
@@ -115180,6 +124623,9 @@ void Tool_myank::processFile(HumdrumFile& infile) {
 	// expand to multiple measures later.
 	expandMeasureOutList(m_measureOutList, m_measureInList, infile,
 			measurestring);
+	if (hasError()) {
+		return;
+	}
 
 	if (m_inlistQ) {
 		m_free_text << "INPUT MEASURE MAP: " << endl;
@@ -115213,22 +124659,14 @@ void Tool_myank::processFile(HumdrumFile& infile) {
 ////////////////////////
 //
 // Tool_myank::analyzeBarNumbers -- Stores the bar number of each line in a vector
+//     (taken from the measure index of the file).
 //
 
 vector<int> Tool_myank::analyzeBarNumbers(HumdrumFile& infile) {
 	vector<int> m_barnum;
 	m_barnum.resize(infile.getLineCount());
-	int current = 0;
-	HumRegex hre;
 	for (int i=0; i<infile.getLineCount(); i++) {
-		if (!infile[i].isBarline()) {
-			m_barnum.at(i) = current;
-			continue;
-		}
-		if (hre.search(infile[i].token(0), "=(\\d+)")) {
-			current = hre.getMatchInt(1);
-		}
-		m_barnum.at(i) = current;
+		m_barnum[i] = infile.getBarNumberForLine(i);
 	}
 	return m_barnum;
 }
@@ -116028,8 +125466,8 @@ void Tool_myank::adjustGlobalInterpretations(HumdrumFile& infile, int ii,
 void Tool_myank::adjustGlobalInterpretationsStart(HumdrumFile& infile, int ii,
 		vector<MeasureInfo>& outmeasures, int index) {
 	if (index != 0) {
-		cerr << "Error in adjustGlobalInterpetationsStart" << endl;
-		exit(1);
+		setError("Error in adjustGlobalInterpetationsStart");
+		return;
 	}
 
 	int i;
@@ -116766,109 +126204,35 @@ void Tool_myank::printEnding(HumdrumFile& infile, int lastline, int adjlin) {
 //////////////////////////////
 //
 // Tool_myank::getMeasureStartStop --  Get a list of the (numbered) measures in the
-//    input file, and store the start/stop lines for those measures.
-//    All data before the first numbered measure is in measure 0.
-//    although, if the first measure is not labeled, then ...
+//    input file from the measure index of the file, which is reused when
+//    extracting multiple excerpts from the same file.
 //
 
 void Tool_myank::getMeasureStartStop(vector<MeasureInfo>& measurelist, HumdrumFile& infile) {
-	measurelist.reserve(infile.getLineCount());
+	int count = infile.getMeasureIndexCount();
+	measurelist.reserve(count + 1);
 	measurelist.resize(0);
 
 	MeasureInfo current;
-	int i, ii;
-	int lastend = -1;
-	int dataend = -1;
-	int barnum1 = -1;
-	int barnum2 = -1;
-	HumRegex hre;
-
-	insertZerothMeasure(measurelist, infile);
-
-	for (i=0; i<infile.getLineCount(); i++) {
-		if (infile[i].isInterpretation()) {
-			if (*infile.token(i, 0) == "*-") {
-				dataend = i;
-				break;
-			}
-		}
-		if (!infile[i].isBarline()) {
-			continue;
-		}
-		//if (!hre.search(infile.token(i, 0), "^=.*(\\d+)")) {
-		//   continue;
-		//}
-		//barnum1 = stoi(hre.getMatch(1));
-		if (!sscanf(infile.token(i, 0)->c_str(), "=%d", &barnum1)) {
-			continue;
-		}
-		current.clear();
-		current.start = i;
-		current.num   = barnum1;
-		for (ii=i+1; ii<infile.getLineCount(); ii++) {
-			if (!infile[ii].isBarline()) {
-				continue;
-			}
-			//if (hre.search(infile.token(ii, 0), "^=.*(\\d+)")) {
-			//   barnum2 = stoi(hre.getMatch(1));
-			//   current.stop = ii;
-			//   lastend = ii;
-			//   i = ii - 1;
-			//   measurelist.push_back(current);
-			//   break;
-			//}
-			if (hre.search(infile.token(ii, 0), "=[^\\d]*(\\d+)")) {
-			// if (sscanf(infile.token(ii, 0), "=%d", &barnum2)) {
-				barnum2 = stoi(hre.getMatch(1));
-				current.stop = ii;
-				lastend = ii;
-				i = ii - 1;
-				current.file = &infile;
-				measurelist.push_back(current);
-				break;
-			} else {
-				if (atEndOfFile(infile, ii)) {
-					break;
-				}
-			}
-		}
-	}
-
-	int lastdata    = -1;   // last line in file with data
-	int lastmeasure = -1;   // last line in file with measure
-
-	for (i=infile.getLineCount()-1; i>=0; i--) {
-		if ((lastdata < 0) && infile[i].isData()) {
-			lastdata = i;
-		}
-		if ((lastmeasure < 0) && infile[i].isBarline()) {
-			lastmeasure = i;
-		}
-		if ((lastmeasure >= 0) && (lastdata >= 0)) {
-			break;
-		}
-	}
-
-	if (lastmeasure < lastdata) {
-		// no final barline, so set to ignore
-		lastmeasure = -1;
-		lastdata    = -1;
-	}
-
-	if ((barnum2 >= 0) && (lastend >= 0) && (dataend >= 0)) {
+	for (int i=0; i<count; i++) {
+		const HumMeasureInfo& entry = infile.getMeasureIndexEntry(i);
 		current.clear();
-		current.num = barnum2;
-		current.start = lastend;
-		current.stop = dataend;
-		if (lastmeasure > lastdata) {
-			current.stop = lastmeasure;
-		}
-		current.file = &infile;
+		current.num   = entry.number;
+		current.start = entry.startline;
+		current.stop  = entry.stopline;
+		current.file  = &infile;
 		measurelist.push_back(current);
 	}
 
 	// allow "myank -l" when there are no measure numbers
 	if (getBoolean("lines") && measurelist.size() == 0) {
+		int dataend = -1;
+		for (int i=0; i<infile.getLineCount(); i++) {
+			if (infile[i].isInterpretation() && (*infile.token(i, 0) == "*-")) {
+				dataend = i;
+				break;
+			}
+		}
 		current.clear();
 		current.num = 0;
 		current.start = 0;
@@ -116952,76 +126316,6 @@ void Tool_myank::getSectionString(string& sstring, HumdrumFile& infile, int sec)
 
 
 
-//////////////////////////////
-//
-// Tool_myank::atEndOfFile --
-//
-
-int Tool_myank::atEndOfFile(HumdrumFile& infile, int line) {
-	int i;
-	for (i=line+1; i<infile.getLineCount(); i++) {
-		if (infile[i].isData()) {
-			return 0;
-		}
-	}
-
-	return 1;
-}
-
-
-
-//////////////////////////////
-//
-// Tool_myank::insertZerothMeasure --
-//
-
-void Tool_myank::insertZerothMeasure(vector<MeasureInfo>& measurelist,
-		HumdrumFile& infile) {
-
-	HumRegex hre;
-	int exinterpline = -1;
-	int startline = -1;
-	int stopline = -1;
-	int i;
-	for (i=0; i<infile.getLineCount(); i++) {
-		if ((exinterpline < 0) && infile[i].isInterpretation()) {
-			exinterpline = i;
-		}
-		if ((startline < 0) && (infile[i].isData())) {
-			startline = i;
-		}
-		if (infile[i].isBarline() && hre.search(infile.token(i, 0), "^=.*\\d+", "")) {
-			stopline = i;
-			break;
-		}
-	}
-
-	if (exinterpline < 0) {
-		// somethind weird happend, just return
-		return;
-	}
-	if (startline < 0) {
-		// no zeroth measure;
-		return;
-	}
-	if (stopline < 0) {
-		// strange situation, no measure numbers
-		// consider what to do later...
-		return;
-	}
-
-	MeasureInfo current;
-	current.clear();
-	current.num = 0;
-	current.start = startline;
-	// current.start = exinterpline+1;
-	current.stop = stopline;
-	current.file = &infile;
-	measurelist.push_back(current);
-}
-
-
-
 //////////////////////////////
 //
 // Tool_myank::expandMeasureOutList -- read the measure list for the sequence of measures
@@ -117044,13 +126338,14 @@ void Tool_myank::expandMeasureOutList(vector<MeasureInfo>& measureout,
 			minmeasure = measurein[i].num;
 		}
 	}
+	measureout.clear();
 	if (maxmeasure <= 0 && !getBoolean("lines")) {
-		cerr << "Error: There are no measure numbers present in the data" << endl;
-		exit(1);
+		setError("Error: There are no measure numbers present in the data");
+		return;
 	}
 	if (maxmeasure > 1123123) {
-		cerr << "Error: ridiculusly large measure number: " << maxmeasure << endl;
-		exit(1);
+		setError("Error: ridiculusly large measure number: " + to_string(maxmeasure));
+		return;
 	}
 	if (m_maxQ) {
 		if (measurein.size() == 0) {
@@ -117058,7 +126353,7 @@ void Tool_myank::expandMeasureOutList(vector<MeasureInfo>& measureout,
 		} else {
 			m_humdrum_text << maxmeasure << endl;
 		}
-		exit(0);
+		return;
 	} else if (m_minQ) {
 		for (int ii=0; ii<infile.getLineCount(); ii++) {
 			if (infile[ii].isBarline()) {
@@ -117066,12 +126361,12 @@ void Tool_myank::expandMeasureOutList(vector<MeasureInfo>& measureout,
 					break;
 				} else {
 					m_humdrum_text << 0 << endl;
-					exit(0);
+					return;
 				}
 			}
 			if (infile[ii].isData()) {
 				m_humdrum_text << 0 << endl;
-				exit(0);
+				return;
 			}
 		}
 		if (measurein.size() == 0) {
@@ -117079,7 +126374,7 @@ void Tool_myank::expandMeasureOutList(vector<MeasureInfo>& measureout,
 		} else {
 			m_humdrum_text << minmeasure << endl;
 		}
-		exit(0);
+		return;
 	}
 
 	// create reverse-lookup list
@@ -117109,6 +126404,9 @@ void Tool_myank::expandMeasureOutList(vector<MeasureInfo>& measureout,
 		start += value - 1;
 		start += (int)hre.getMatch(1).size();
 		processFieldEntry(range, hre.getMatch(1), infile, maxmeasure, measurein, inmap);
+		if (hasError()) {
+			return;
+		}
 		value = hre.search(ostring, start, searchexp);
 	}
 }
@@ -117501,16 +126799,16 @@ void Tool_myank::processFieldEntry(vector<MeasureInfo>& field,
 		if (lastone  < 0         ) { lastone  = 0         ; }
 
 		if ((firstone < 1) && (firstone != 0)) {
-			cerr << "Error: range token: \"" << str << "\""
-				  << " contains too small a number at start: " << firstone << endl;
-			cerr << "Minimum number allowed is " << 1 << endl;
-			exit(1);
+			setError("Error: range token: \"" + str + "\""
+					+ " contains too small a number at start: " + to_string(firstone)
+					+ "\nMinimum number allowed is 1");
+			return;
 		}
 		if ((lastone < 1) && (lastone != 0)) {
-			cerr << "Error: range token: \"" << str << "\""
-				  << " contains too small a number at end: " << lastone << endl;
-			cerr << "Minimum number allowed is " << 1 << endl;
-			exit(1);
+			setError("Error: range token: \"" + str + "\""
+					+ " contains too small a number at end: " + to_string(lastone)
+					+ "\nMinimum number allowed is 1");
+			return;
 		}
 
 		if (firstone > lastone) {
@@ -117574,12 +126872,12 @@ void Tool_myank::processFieldEntry(vector<MeasureInfo>& field,
 		// do something with letter later...
 
 		if ((value < 1) && (value != 0)) {
-			cerr << "Error: range token: \"" << str << "\""
-				  << " contains too small a number at end: " << value << endl;
-			cerr << "Minimum number allowed is " << 1 << endl;
-			exit(1);
+			setError("Error: range token: \"" + str + "\""
+					+ " contains too small a number at end: " + to_string(value)
+					+ "\nMinimum number allowed is 1");
+			return;
 		}
-		if (inmap[value] >= 0) {
+		if ((value < (int)inmap.size()) && (inmap[value] >= 0)) {
 			current.clear();
 			current.file = &infile;
 			current.num = value;
@@ -117891,15 +127189,12 @@ void Tool_nproof::checkForBlankLines(HumdrumFile& infile) {
 // Tool_nproof::checkForValidInstrumentCode --
 //
 
-void Tool_nproof::checkForValidInstrumentCode(HTp token,
-		vector<pair<string, string>>& instrumentList) {
+void Tool_nproof::checkForValidInstrumentCode(HTp token) {
 
 	if ((token->find("&") == string::npos) && (token->find("|") == string::npos)) {
 		string code = token->substr(2);
-		for (int i=0; i<(int)instrumentList.size(); i++) {
-			if (instrumentList[i].first == code) {
-				return;
-			}
+		if (!Convert::getInstrumentClass(code).empty()) {
+			return;
 		}
 
 		m_errorCount++;
@@ -117917,14 +127212,8 @@ void Tool_nproof::checkForValidInstrumentCode(HTp token,
 		inst1 = hre.getMatch(1);
 		inst2 = hre.getMatch(2);
 
-		for (int i=0; i<(int)instrumentList.size(); i++) {
-			if (instrumentList[i].first == inst1) {
-				found1 = true;
-			}
-			if (instrumentList[i].first == inst2) {
-				found2 = true;
-			}
-		}
+		found1 = !Convert::getInstrumentClass(inst1).empty();
+		found2 = !Convert::getInstrumentClass(inst2).empty();
 	}
 
 	if (!found1) {
@@ -117953,8 +127242,6 @@ void Tool_nproof::checkInstrumentInformation(HumdrumFile& infile) {
 	int classLine = -1;
 	HumRegex hre;
 
-	vector<pair<string, string>> instrumentList = Convert::getInstrumentList();
-
 	for (int i=0; i<infile.getLineCount(); i++) {
 		if (infile[i].isData()) {
 			break;
@@ -117995,7 +127282,7 @@ void Tool_nproof::checkInstrumentInformation(HumdrumFile& infile) {
 					m_errorList += "!!!TOOL-nproof-error-" + to_string(m_errorCount) + ": expected instrument code on line " + to_string(token->getLineNumber()) + ", field " + to_string(token->getFieldNumber()) + ".\n";
 					m_errorHtml += "!! <li> @{TOOL-nproof-error-" + to_string(m_errorCount) + "} </li>\n";
 				} else {
-					checkForValidInstrumentCode(token, instrumentList);
+					checkForValidInstrumentCode(token);
 				}
 			} else {
 				if (*token != "*") {
@@ -121277,6 +130564,410 @@ ostream& _VoiceInfo::print(ostream& out) {
 
 
 
+//////////////////////////////
+//
+// PrangeCorpus::PrangeCorpus -- Constructor.
+//
+
+PrangeCorpus::PrangeCorpus(void) {
+	clear();
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::clear --
+//
+
+void PrangeCorpus::clear(void) {
+	m_voices.clear();
+	m_files = 0;
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::isEmpty -- Return true if no files have been added.
+//
+
+bool PrangeCorpus::isEmpty(void) const {
+	return m_files == 0;
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::getFileCount -- Return the number of files in the
+//     histograms.
+//
+
+int PrangeCorpus::getFileCount(void) const {
+	return m_files;
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::isDurationWeighted -- Return true if the histograms are
+//     weighted by note duration rather than counting note attacks.
+//
+
+bool PrangeCorpus::isDurationWeighted(void) const {
+	return m_durationQ;
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::setDurationWeighted -- Only has an effect before files
+//     are added.
+//
+
+void PrangeCorpus::setDurationWeighted(bool state) {
+	if (m_files == 0) {
+		m_durationQ = state;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::getVoiceKey -- Normalize a voice name for merging voices
+//     from different files: lower case with single spaces between words.
+//
+
+string PrangeCorpus::getVoiceKey(const string& name) {
+	string output;
+	for (int i=0; i<(int)name.size(); i++) {
+		unsigned char ch = (unsigned char)name[i];
+		if (isspace(ch)) {
+			if (!output.empty() && (output.back() != ' ')) {
+				output += ' ';
+			}
+		} else {
+			output += (char)tolower(ch);
+		}
+	}
+	if (!output.empty() && (output.back() == ' ')) {
+		output.pop_back();
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::addFile -- Add the histograms of the **kern voices of a
+//     file which were filled by Tool_prange::fillHistograms().  Voices
+//     without names are identified by their order in the file.
+//
+
+void PrangeCorpus::addFile(vector<_VoiceInfo>& voiceInfo) {
+	int count = 0;
+	for (int i=1; i<(int)voiceInfo.size(); i++) {
+		if (!voiceInfo[i].kernQ) {
+			continue;
+		}
+		count++;
+		string key = getVoiceKey(voiceInfo[i].name);
+		if (key.empty()) {
+			key = "voice " + to_string(count);
+		}
+		mergeVoice(m_voices[key], voiceInfo[i]);
+	}
+	m_files++;
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::merge -- Add the histograms of another corpus.  Returns
+//     false if the two corpora are weighted differently.
+//
+
+bool PrangeCorpus::merge(const PrangeCorpus& other) {
+	if (other.m_files == 0) {
+		return true;
+	}
+	if (m_durationQ != other.m_durationQ) {
+		return false;
+	}
+	for (auto& entry : other.m_voices) {
+		mergeVoice(m_voices[entry.first], entry.second);
+	}
+	m_files += other.m_files;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::mergeVoice -- Add the bins and finals of a voice to another
+//     voice with the same key.  The (alphabetically) first name and
+//     abbreviation are kept, so that the result does not depend on the
+//     order in which voices are merged.
+//
+
+void PrangeCorpus::mergeVoice(_VoiceInfo& target, const _VoiceInfo& source) {
+	target.kernQ = true;
+	if (!source.name.empty() && (target.name.empty() || (source.name < target.name))) {
+		target.name = source.name;
+	}
+	if (!source.abbr.empty() && (target.abbr.empty() || (source.abbr < target.abbr))) {
+		target.abbr = source.abbr;
+	}
+	for (int i=0; i<(int)source.midibins.size(); i++) {
+		target.midibins.at(i) += source.midibins[i];
+	}
+	for (int i=0; i<(int)source.diatonic.size(); i++) {
+		for (int j=0; j<(int)source.diatonic[i].size(); j++) {
+			target.diatonic.at(i).at(j) += source.diatonic[i][j];
+		}
+	}
+	for (int i=0; i<(int)source.diafinal.size(); i++) {
+		addFinal(target, source.diafinal[i], source.accfinal.at(i));
+	}
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::addFinal -- Add a finalis note to the sorted list of
+//     distinct finals for a voice.
+//
+
+void PrangeCorpus::addFinal(_VoiceInfo& voice, int diatonic, int acc) {
+	int index = 0;
+	while (index < (int)voice.diafinal.size()) {
+		int dia = voice.diafinal[index];
+		int alt = voice.accfinal.at(index);
+		if ((dia == diatonic) && (alt == acc)) {
+			return;
+		}
+		if ((dia > diatonic) || ((dia == diatonic) && (alt > acc))) {
+			break;
+		}
+		index++;
+	}
+	voice.diafinal.insert(voice.diafinal.begin() + index, diatonic);
+	voice.accfinal.insert(voice.accfinal.begin() + index, acc);
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::isPartial -- Return true if the file is a partial
+//     written by printPartial().
+//
+
+bool PrangeCorpus::isPartial(HumdrumFile& infile) {
+	return !infile.getReferenceRecord("prange-partial").empty();
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::readPartial -- Merge the histograms stored in a partial.
+//     Returns false and sets the error message if the partial is not
+//     valid or is weighted differently from the corpus.
+//
+
+bool PrangeCorpus::readPartial(HumdrumFile& infile, string& error) {
+	PrangeCorpus partial;
+	partial.m_durationQ = infile.getReferenceRecord("prange-weight") == "durations";
+	partial.m_files = atoi(infile.getReferenceRecord("prange-files").c_str());
+
+	HumRegex hre;
+	for (int i=0; i<infile.getLineCount(); i++) {
+		if (!infile[i].isData()) {
+			continue;
+		}
+		if (infile[i].getFieldCount() != 3) {
+			error = "prange partial line " + to_string(i+1) + " does not have three fields";
+			return false;
+		}
+		string key   = *infile.token(i, 0);
+		string field = *infile.token(i, 1);
+		string value = *infile.token(i, 2);
+		_VoiceInfo& voice = partial.m_voices[key];
+		voice.kernQ = true;
+		if (field == "name") {
+			voice.name = value;
+		} else if (field == "abbr") {
+			voice.abbr = value;
+		} else if (hre.search(field, "^midi:(\\d+)$")) {
+			int midi = hre.getMatchInt(1);
+			if (midi > 127) {
+				error = "MIDI pitch out of range on prange partial line " + to_string(i+1);
+				return false;
+			}
+			double count;
+			if (!readCount(value, count)) {
+				error = "invalid count " + value + " on prange partial line " + to_string(i+1);
+				return false;
+			}
+			voice.midibins[midi] += count;
+		} else if (hre.search(field, "^(dia|final):(\\d+):(-?\\d+)$")) {
+			int diatonic = hre.getMatchInt(2);
+			int acc = hre.getMatchInt(3);
+			if ((acc < -2) || (acc > 2)) {
+				error = "accidental out of range on prange partial line " + to_string(i+1);
+				return false;
+			}
+			if (hre.getMatch(1) == "final") {
+				addFinal(voice, diatonic, acc);
+			} else if (diatonic >= (int)voice.diatonic.size()) {
+				error = "diatonic pitch out of range on prange partial line " + to_string(i+1);
+				return false;
+			} else {
+				double count;
+				if (!readCount(value, count)) {
+					error = "invalid count " + value + " on prange partial line " + to_string(i+1);
+					return false;
+				}
+				voice.diatonic[diatonic][0] += count;
+				voice.diatonic[diatonic][acc+3] += count;
+			}
+		} else {
+			error = "unknown field " + field + " on prange partial line " + to_string(i+1);
+			return false;
+		}
+	}
+
+	if (!merge(partial)) {
+		error = "prange partial is not weighted by ";
+		error += m_durationQ ? "durations (-d option)" : "attacks";
+		return false;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::readCount -- Read a histogram count from a partial.
+//     Returns false if the text is not a finite, non-negative number.
+//
+
+bool PrangeCorpus::readCount(const string& text, double& count) {
+	count = 0.0;
+	if (text.empty()) {
+		return false;
+	}
+	char* end = NULL;
+	errno = 0;
+	double value = strtod(text.c_str(), &end);
+	if ((end != text.c_str() + text.size()) || (errno == ERANGE)) {
+		return false;
+	}
+	if (!std::isfinite(value) || (value < 0.0)) {
+		return false;
+	}
+	count = value;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::printPartial -- Print the histograms in a form that can be
+//     read by readPartial().  Only non-zero bins are stored.
+//
+
+ostream& PrangeCorpus::printPartial(ostream& out) const {
+	std::streamsize precision = out.precision(15);
+	out << "!!!prange-partial: 1\n";
+	out << "!!!prange-weight: " << (m_durationQ ? "durations" : "attacks") << "\n";
+	out << "!!!prange-files: " << m_files << "\n";
+	out << "**voice\t**key\t**value\n";
+	for (auto& entry : m_voices) {
+		const string& key = entry.first;
+		const _VoiceInfo& voice = entry.second;
+		if (!voice.name.empty()) {
+			out << key << "\tname\t" << voice.name << "\n";
+		}
+		if (!voice.abbr.empty()) {
+			out << key << "\tabbr\t" << voice.abbr << "\n";
+		}
+		for (int i=0; i<(int)voice.midibins.size(); i++) {
+			if (voice.midibins[i] != 0.0) {
+				out << key << "\tmidi:" << i << "\t" << voice.midibins[i] << "\n";
+			}
+		}
+		for (int i=0; i<(int)voice.diatonic.size(); i++) {
+			for (int j=1; j<(int)voice.diatonic[i].size(); j++) {
+				if (voice.diatonic[i][j] != 0.0) {
+					out << key << "\tdia:" << i << ":" << (j-3) << "\t" << voice.diatonic[i][j] << "\n";
+				}
+			}
+		}
+		for (int i=0; i<(int)voice.diafinal.size(); i++) {
+			out << key << "\tfinal:" << voice.diafinal[i] << ":" << voice.accfinal.at(i) << "\t1\n";
+		}
+	}
+	out << "*-\t*-\t*-\n";
+	out.precision(precision);
+	return out;
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::getVoiceInfo -- Fill in the voice list used for printing
+//     a range display, with voices sorted from low to high by their mean
+//     pitch.  Index 0 is for the all-voice summary, which is filled in by
+//     Tool_prange::mergeAllVoiceInfo().
+//
+
+void PrangeCorpus::getVoiceInfo(vector<_VoiceInfo>& voiceInfo) const {
+	vector<pair<double, const _VoiceInfo*>> voices;
+	for (auto& entry : m_voices) {
+		double sum = 0.0;
+		double total = 0.0;
+		for (int i=0; i<(int)entry.second.midibins.size(); i++) {
+			sum += i * entry.second.midibins[i];
+			total += entry.second.midibins[i];
+		}
+		voices.emplace_back(total > 0.0 ? sum / total : 0.0, &entry.second);
+	}
+	// stable_sort keeps voices with equal means in key order:
+	stable_sort(voices.begin(), voices.end(),
+		[](const pair<double, const _VoiceInfo*>& a,
+				const pair<double, const _VoiceInfo*>& b) {
+			return a.first < b.first;
+		});
+
+	voiceInfo.clear();
+	voiceInfo.resize(voices.size() + 1);
+	voiceInfo[0].name  = voices.size() == 2 ? "both" : "all";
+	voiceInfo[0].abbr  = voiceInfo[0].name;
+	voiceInfo[0].track = 0;
+	voiceInfo[0].index = 0;
+	for (int i=0; i<(int)voices.size(); i++) {
+		voiceInfo[i+1] = *voices[i].second;
+		voiceInfo[i+1].namfinal.clear();
+		voiceInfo[i+1].track = i + 1;
+		voiceInfo[i+1].index = i + 1;
+	}
+}
+
+
+
 /////////////////////////////////
 //
 // Tool_prange::Tool_prange -- Set the recognized options for the tool.
@@ -121309,6 +131000,8 @@ Tool_prange::Tool_prange(void) {
 	define("q|quartile=b",              "display quartile notes");
 	define("r|reverse=b",               "reverse list of notes in analysis from high to low");
 	define("x|extrema=b",               "highlight extrema notes in each part");
+	define("corpus=b",                  "merge histograms of all inputs (files or partials) into one range display");
+	define("partial=b",                 "print histograms as a partial that can be merged with --corpus");
 	define("sx|scorexml|score-xml|ScoreXML|scoreXML=b", "output ScoreXML format");
 	define("title=s:",                  "title for SCORE display");
 
@@ -121354,12 +131047,70 @@ bool Tool_prange::run(HumdrumFile& infile, ostream& out) {
 
 bool Tool_prange::run(HumdrumFile& infile) {
 	initialize();
+	if (PrangeCorpus::isPartial(infile)) {
+		if (!m_corpusQ) {
+			m_error_text << "Error: use the --corpus option to merge prange partials" << endl;
+			return false;
+		}
+		string error;
+		if (!m_corpus.readPartial(infile, error)) {
+			m_error_text << "Error: " << error << endl;
+			return false;
+		}
+		return true;
+	}
 	processFile(infile);
 	return true;
 }
 
 
 
+//////////////////////////////
+//
+// Tool_prange::finally -- Print the range display (or merged partial) for
+//     all inputs when using the --corpus option.  The title of a corpus
+//     display is only given by the --title option, and no key signature
+//     is shown.
+//
+
+void Tool_prange::finally(void) {
+	if (!m_corpusQ) {
+		return;
+	}
+	if (m_partialQ) {
+		m_corpus.printPartial(m_humdrum_text);
+		return;
+	}
+	if (m_corpus.isEmpty()) {
+		return;
+	}
+
+	vector<_VoiceInfo> voiceInfo;
+	m_corpus.getVoiceInfo(voiceInfo);
+	mergeAllVoiceInfo(voiceInfo);
+	m_refmap.clear();
+	if (m_scoreQ) {
+		printScoreFile(m_humdrum_text, voiceInfo, 0);
+	} else {
+		printAnalysis(m_humdrum_text, voiceInfo[0].midibins);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_prange::getCorpus -- Return the histograms merged for the --corpus
+//     option, such as for merging the results of tools run in separate
+//     threads with PrangeCorpus::merge().
+//
+
+PrangeCorpus& Tool_prange::getCorpus(void) {
+	return m_corpus;
+}
+
+
+
 //////////////////////////////
 //
 // Tool_prange::initialize --  Initializations that only have to be done once
@@ -121395,6 +131146,8 @@ void Tool_prange::initialize(void) {
 	m_titleQ       = getBoolean("title");
 	m_embedQ       = getBoolean("embed");
 	m_extremaQ     = getBoolean("extrema");
+	m_corpusQ      = getBoolean("corpus");
+	m_partialQ     = getBoolean("partial");
 
 	getRange(m_rangeL, m_rangeH, getString("range"));
 
@@ -121416,6 +131169,8 @@ void Tool_prange::initialize(void) {
 		m_percentile = m_percentile / 100.0;
 	}
 
+	m_corpus.setDurationWeighted(m_durationQ);
+
 	#ifdef __EMSCRIPTEN__
 		// Default styling for JavaScript version of program:
 		m_accQ     = !getBoolean("color-accidentals");
@@ -121446,9 +131201,22 @@ void Tool_prange::processFile(HumdrumFile& infile) {
 		}
 	}
 
+	if (m_corpusQ) {
+		// printed after all inputs in finally():
+		m_corpus.addFile(voiceInfo);
+		return;
+	}
+	if (m_partialQ) {
+		PrangeCorpus partial;
+		partial.setDurationWeighted(m_durationQ);
+		partial.addFile(voiceInfo);
+		partial.printPartial(m_humdrum_text);
+		return;
+	}
+
 	if (m_scoreQ) {
 		stringstream scoreout;
-		printScoreFile(scoreout, voiceInfo, infile);
+		printScoreFile(scoreout, voiceInfo, getKeySignature(infile));
 		if (m_embedQ) {
 			if (m_extremaQ) {
 				doExtremaMarkup(infile);
@@ -122042,7 +131810,7 @@ void Tool_prange::printXmlEncodedText(ostream& out, const string& strang) {
 // Tool_prange::printScoreFile --
 //
 
-void Tool_prange::printScoreFile(ostream& out, vector<_VoiceInfo>& voiceInfo, HumdrumFile& infile) {
+void Tool_prange::printScoreFile(ostream& out, vector<_VoiceInfo>& voiceInfo, int keysig) {
 	string titlestring = getTitle();
 
 	if (m_defineQ) {
@@ -122104,7 +131872,6 @@ void Tool_prange::printScoreFile(ostream& out, vector<_VoiceInfo>& voiceInfo, Hu
 	out << "8 1 0 0 0 200\n";   // staff 1
 	out << "8 2 0 -6 0 200\n";   // staff 2
 
-	int keysig = getKeySignature(infile);
 	// print key signature
 	if (keysig) {
 		out << "17 1 10 0 " << keysig << " 101.0";
@@ -123282,25 +133049,28 @@ void Tool_prange::getRange(int& rangeL, int& rangeH, const string& rangestring)
 	if (rangestring.empty()) {
 		return;
 	}
-	int length = (int)rangestring.length();
-	char* buffer = new char[length+1];
-	strcpy(buffer, rangestring.c_str());
-	char* ptr;
-	if (std::isdigit(buffer[0])) {
-		ptr = strtok(buffer, " \t\n:-");
-		sscanf(ptr, "%d", &rangeL);
-		ptr = strtok(NULL, " \t\n:-");
-		if (ptr != NULL) {
-			sscanf(ptr, "%d", &rangeH);
+	bool numericQ = std::isdigit(rangestring[0]);
+	const char* separators = numericQ ? " \t\n:-" : " :";
+	vector<string> values;
+	size_t start = rangestring.find_first_not_of(separators);
+	while ((start != string::npos) && (values.size() < 2)) {
+		size_t end = rangestring.find_first_of(separators, start);
+		values.push_back(rangestring.substr(start, end - start));
+		start = rangestring.find_first_not_of(separators, end);
+	}
+	if (numericQ) {
+		if (values.size() > 0) {
+			sscanf(values[0].c_str(), "%d", &rangeL);
+		}
+		if (values.size() > 1) {
+			sscanf(values[1].c_str(), "%d", &rangeH);
 		}
 	} else {
-		ptr = strtok(buffer, " :");
-		if (ptr != NULL) {
-			rangeL = Convert::kernToMidiNoteNumber(ptr);
-			ptr = strtok(NULL, " :");
-			if (ptr != NULL) {
-				rangeH = Convert::kernToMidiNoteNumber(ptr);
-			}
+		if (values.size() > 0) {
+			rangeL = Convert::kernToMidiNoteNumber(values[0]);
+		}
+		if (values.size() > 1) {
+			rangeH = Convert::kernToMidiNoteNumber(values[1]);
 		}
 	}
 
@@ -123478,9 +133248,11 @@ void Tool_recip::doCompositeAnalysis(HumdrumFile& infile) {
 		return;
 	} else {
 		infile.prependDataSpine(recips, "", m_exinterp);
-		infile.printFieldIndex(0, m_humdrum_text);
+		stringstream composite;
+		infile.printFieldIndex(0, composite);
 		infile.clear();
-		infile.readString(m_humdrum_text.str());
+		infile.readString(composite.str());
+		m_humdrum_text << composite.str();
 	}
 }
 
@@ -130297,6 +140069,8 @@ void Tool_slurcheck::initialize(void) {
 
 void Tool_slurcheck::processFile(HumdrumFile& infile) {
 	infile.analyzeSlurs();
+	HumAnalysisTables& tables = infile.getAnalysisTables();
+	HumSpanTable& slurs = tables.getSlurs();
 	int opencount = 0;
 	int closecount = 0;
 	int listQ  = getBoolean("list");
@@ -130322,10 +140096,9 @@ void Tool_slurcheck::processFile(HumdrumFile& infile) {
 				tok = tok->getNextToken();
 				continue;
 			}
-			string value = tok->getValue("auto", "hangingSlur");
-			if (value == "true") {
-				string side = tok->getValue("auto", "slurSide");
-				if (side == "start") {
+			int side = slurs.getHangingSide(tables.getTokenId(tok));
+			if (side != 0) {
+				if (side > 0) {
 					opencount++;
 					if (listQ) {
 						if (filenameQ) {
@@ -130338,7 +140111,7 @@ void Tool_slurcheck::processFile(HumdrumFile& infile) {
 						data += "i";
 						tok->setText(data);
 					}
-				} else if (side == "stop") {
+				} else {
 					closecount++;
 					if (listQ) {
 						if (filenameQ) {
@@ -130796,15 +140569,16 @@ void Tool_synco::initialize(void) {
 //
 
 void Tool_synco::processFile(HumdrumFile& infile) {
-	int scount = infile.getStrandCount();
+	const HumStrandTable& strands = infile.getStrandTable();
+	int scount = strands.getStrandCount();
 	m_scount = 0;
+	m_hasSyncoQ = false;
 	for (int i=0; i<scount; i++) {
-		HTp stok = infile.getStrandStart(i);
-		if (!stok->isKern()) {
+		HTp stok = strands.getToken(strands.getStrandOffset(i));
+		if (!stok || !stok->isKern()) {
 			continue;
 		}
-		HTp etok = infile.getStrandEnd(i);
-		processStrand(stok, etok);
+		processStrand(strands, i);
 	}
 }
 
@@ -130815,23 +140589,18 @@ void Tool_synco::processFile(HumdrumFile& infile) {
 // Tool_synco::processStrand --
 //
 
-void Tool_synco::processStrand(HTp stok, HTp etok) {
-	HTp current = stok;
-	while (current && (current != etok)) {
-		if (!current->isData()) {
-			current = current->getNextToken();
-			continue;
-		}
-		if (current->isNull()) {
-			current = current->getNextToken();
+void Tool_synco::processStrand(const HumStrandTable& strands, int strand) {
+	int start = strands.getStrandOffset(strand);
+	int end = start + strands.getStrandSize(strand);
+	for (int i=start; i<end; i++) {
+		if (!strands.isData(i) || strands.isNull(i)) {
 			continue;
 		}
+		HTp current = strands.getToken(i);
 		if (current->isRest()) {
-			current = current->getNextToken();
 			continue;
 		}
 		if (current->isSecondaryTiedNote()) {
-			current = current->getNextToken();
 			continue;
 		}
 		if (isSyncopated(current)) {
@@ -130839,7 +140608,6 @@ void Tool_synco::processStrand(HTp stok, HTp etok) {
 			m_scount++;
 			markNote(current);
 		}
-		current = current->getNextToken();
 	}
 }
 
@@ -134134,22 +143902,7 @@ void Tool_tassoize::clearStates(void) {
 //
 
 string Tool_tassoize::getDate(void) {
-	time_t t = time(NULL);
-	tm* timeptr = localtime(&t);
-	stringstream ss;
-	int year = timeptr->tm_year + 1900;
-	int month = timeptr->tm_mon + 1;
-	int day = timeptr->tm_mday;
-	ss << year << "/";
-	if (month < 10) {
-		ss << "0";
-	}
-	ss << month << "/";
-	if (day < 10) {
-		ss << "0";
-	}
-	ss << day;
-	return ss.str();
+	return Convert::getCurrentDate();
 }
 
 
@@ -134256,8 +144009,9 @@ void Tool_textdur::processFile(HumdrumFile& infile) {
 	m_melismas.clear();
 	m_melismas.resize(m_textStarts.size());
 
+	const HumTextTable& table = infile.getTextTable();
 	for (int i=0; i<(int)m_textStarts.size(); i++) {
-		processTextSpine(m_textStarts, i);
+		processTextSpine(table, m_textStarts, i);
 	}
 
 	if (!m_interleaveQ) {
@@ -134812,7 +144566,8 @@ void Tool_textdur::getTextSpineStarts(HumdrumFile& infile, vector<HTp>& starts)
 // Tool_textdur::processTextSpine --
 //
 
-void Tool_textdur::processTextSpine(vector<HTp>& starts, int index) {
+void Tool_textdur::processTextSpine(const HumTextTable& table, vector<HTp>& starts,
+		int index) {
 	HTp current = starts.at(index);
 	current->getNextToken();
 	while (current) {
@@ -134843,14 +144598,23 @@ void Tool_textdur::processTextSpine(vector<HTp>& starts, int index) {
 		current = current->getNextToken();
 	}
 
-	for (int i=0; i<(int)m_syllables.size(); i++) {
-		for (int j=0; j<(int)m_syllables[i].size() - 1; j++) {
-			if (m_melismaQ) {
-				m_melismas.at(i).at(j) = getMelisma(m_syllables.at(i).at(j), m_syllables.at(i).at(j+1));
-			}
-			if (m_durationQ) {
-				m_durations.at(i).at(j) = getDuration(m_syllables.at(i).at(j), m_syllables.at(i).at(j+1));
-			}
+	// The syllables of the spine are listed in the same order in the
+	// text table:
+	int first = 0;
+	for (int i=0; i<table.getSpineCount(); i++) {
+		if (table.getSpineStart(i) == starts.at(index)) {
+			first = table.getSpineSyllableStart(i);
+			break;
+		}
+	}
+
+	vector<HTp>& syllables = m_syllables.at(index);
+	for (int j=0; j<(int)syllables.size() - 1; j++) {
+		if (m_melismaQ) {
+			m_melismas.at(index).at(j) = getMelisma(table, first + j);
+		}
+		if (m_durationQ) {
+			m_durations.at(index).at(j) = getDuration(syllables.at(j), syllables.at(j+1));
 		}
 	}
 }
@@ -134859,47 +144623,22 @@ void Tool_textdur::processTextSpine(vector<HTp>& starts, int index) {
 
 //////////////////////////////
 //
-// Tool_textdur::getMelisma --  Not counting syllable starts on secondary tied notes.
+// Tool_textdur::getMelisma --  Not counting syllable starts on secondary
+//     tied notes.  The note count is taken from the text table of the file.
 //
 
-int Tool_textdur::getMelisma(HTp tok1, HTp tok2) {
-	int stopIndex = tok2->getLineIndex();
-	HTp current = getTandemKernToken(tok1);
+int Tool_textdur::getMelisma(const HumTextTable& table, int syllable) {
+	HTp current = table.getFirstNote(syllable);
 	if (!current) {
 		return 0;
 	}
 	if (current->isNull()) {
+		HTp tok1 = table.getSyllableToken(syllable);
 		cerr << "Strange case for syllable " << tok1 << " on line " << tok1->getLineNumber();
 		cerr << ", field " << tok1->getFieldNumber() <<" which does not start on a note" << endl;
 		return 0;
 	}
-	int cline = current->getLineIndex();
-	int counter = 0;
-	while (current && cline < stopIndex) {
-		if (!current->isData()) {
-			current = current->getNextToken();
-			if (current) {
-				cline = current->getLineIndex();
-			}
-			continue;
-		}
-		if (current->isNull()) {
-			current = current->getNextToken();
-			if (current) {
-				cline = current->getLineIndex();
-			}
-			continue;
-		}
-		if (current->isNoteAttack()) {
-			counter++;
-		}
-		current = current->getNextToken();
-		if (current) {
-			cline = current->getLineIndex();
-		}
-	}
-
-	return counter;
+	return table.getNoteCount(syllable);
 }
 
 
@@ -135449,21 +145188,13 @@ int Tool_thru::getLabelIndex(vector<string>& labels, string& key) {
 
 void Tool_thru::getLabelSequence(vector<string>& labelsequence,
 		const string& astring) {
-	int slength = (int)astring.size();
-	char* sdata = new char[slength+1];
-	strcpy(sdata, astring.c_str());
 	const char* ignorecharacters = ", [] ";
-	int index;
-
-	char* strptr = strtok(sdata, ignorecharacters);
-	while (strptr != NULL) {
-		labelsequence.resize((int)labelsequence.size() + 1);
-		index = (int)labelsequence.size() - 1;
-		labelsequence[index] = strptr;
-		strptr = strtok(NULL, ignorecharacters);
+	size_t start = astring.find_first_not_of(ignorecharacters);
+	while (start != string::npos) {
+		size_t end = astring.find_first_of(ignorecharacters, start);
+		labelsequence.push_back(astring.substr(start, end - start));
+		start = astring.find_first_not_of(ignorecharacters, end);
 	}
-
-	delete [] sdata;
 }
 
 
@@ -136193,6 +145924,7 @@ Tool_transpose::Tool_transpose(void) {
 	define("auto=b",          "auto. trans. inst. parts to concert pitch");
 	define("debug=b",         "print debugging statements");
 	define("s|spines=s:",     "transpose only specified spines");
+	define("intervals=s",     "list of intervals for multiple transpositions");
 	// quiet reversed with -T option (actively need to request transposition code now)
 	// define("q|quiet=b",       "suppress *Tr interpretations in output");
 	define("T|transcode=b",   "include transposition code to reverse transposition");
@@ -136251,7 +145983,10 @@ bool Tool_transpose::run(HumdrumFile& infile, ostream& out) {
 //
 
 bool Tool_transpose::run(HumdrumFile& infile) {
-	initialize(infile);
+	if (!initialize(infile)) {
+		// --help and similar options are not errors:
+		return !hasError();
+	}
 
 	if (ssettonicQ) {
 		transval = calculateTranspositionFromKey(ssettonic, infile);
@@ -136286,7 +146021,11 @@ bool Tool_transpose::run(HumdrumFile& infile) {
 				spineprocess[t] = false;
 			}
 		}
-		processFile(infile, spineprocess);
+		if (getBoolean("intervals")) {
+			processIntervals(infile, spineprocess);
+		} else {
+			processFile(infile, spineprocess);
+		}
 	}
 
 	return true;
@@ -136294,6 +146033,37 @@ bool Tool_transpose::run(HumdrumFile& infile) {
 
 
 
+//////////////////////////////
+//
+// Tool_transpose::processIntervals -- Print multiple transpositions of
+//     the input file, one segment for each interval in the --intervals
+//     list (such as "P1,M2,-m3").  The input data is parsed only once, and
+//     the transposition tables for each interval are reused if an interval
+//     is repeated.
+//
+
+void Tool_transpose::processIntervals(HumdrumFile& infile,
+		vector<bool>& spineprocess) {
+	HumRegex hre;
+	vector<string> intervals;
+	hre.split(intervals, getString("intervals"), "[\\s,]+");
+	string filename = infile.getFilename();
+	for (int i=0; i<(int)intervals.size(); i++) {
+		if (intervals[i].empty()) {
+			continue;
+		}
+		transval = getBase40ValueFromInterval(intervals[i]) + 40 * octave;
+		m_humdrum_text << "!!!!SEGMENT: ";
+		if (!filename.empty()) {
+			m_humdrum_text << filename << ":";
+		}
+		m_humdrum_text << intervals[i] << "\n";
+		processFile(infile, spineprocess);
+	}
+}
+
+
+
 //////////////////////////////
 //
 // Tool_transpose::convertScore -- create a concert pitch score from
@@ -136987,15 +146757,7 @@ void Tool_transpose::printHumdrumKernToken(HumdrumLine& record, int index,
 		m_humdrum_text << record.token(index);
 		return;
 	}
-	string buffer;
-	int tokencount = record.token(index)->getSubtokenCount();
-	for (int k=0; k<tokencount; k++) {
-		buffer = record.token(index)->getSubtoken(k);
-		printNewKernString(buffer, transval);
-		if (k<tokencount-1) {
-			m_humdrum_text << " ";
-		}
-	}
+	printNewKernString(*record.token(index), transval);
 }
 
 
@@ -137040,54 +146802,38 @@ cerr << "B40 = " << b40 << "\t" << pitch << endl;
 
 //////////////////////////////
 //
-// Tool_transpose::printNewKernString --
+// Tool_transpose::printNewKernString -- Print a transposed **kern token
+//     (which may be a chord).  The pitches are transposed with a lookup
+//     table for the interval, and the token is rewritten in a buffer that is
+//     reused for each token.
 //
 
 void Tool_transpose::printNewKernString(const string& input, int transval) {
+	m_kernBuffer = input;
+	getTransposer(transval).transposeKernToken(m_kernBuffer);
+	m_humdrum_text << m_kernBuffer;
+}
 
-	HumRegex hre;
-	if (input == ".") {
-		// Don't transpose null tokens.
-		m_humdrum_text << input;
-		return;
-	} else if (input.rfind('R') != string::npos) {
-		// Don't transpose unpitched notes (percussion parts).
-		m_humdrum_text << input;
-		return;
-	} else if (input.rfind('r') != string::npos) {
-		// Transpose rests only if they contain a pitch component.
-		string output = input;
-		if (hre.search(input, "([A-Ga-g]+[#n-]*)")) {
-			// Transpose pitch portion of rest (indicating vertical position).
-			string pitch = hre.getMatch(1);
-			int base40 = Convert::kernToBase40(pitch);
-cerr << "XPITCH " << pitch << "\tbase40 = " << base40 << endl;
-			string newpitch = Convert::base40ToKern(base40 + transval);
-cerr << "\tNEWPITCH " << pitch << endl;
-			hre.replaceDestructive(newpitch, "", "[-#n]+");
-			hre.replaceDestructive(output, newpitch, "([A-Ga-g]+[#n-]*)");
-		}
-		// don't transpose rests...
-		m_humdrum_text << output;
-		return;
-	} else if (!hre.search(input, "([A-Ga-g]+[#n-]*)")) {
-		// This is a form of invisible rest with no "r", just **recip.
-		m_humdrum_text << input;
-		return;
-	}
 
-	// Now the only thing left are regular pitches.
 
-	int base40 = Convert::kernToBase40(input);
-	string newpitch = Convert::base40ToKern(base40 + transval);
+//////////////////////////////
+//
+// Tool_transpose::getTransposer -- Return a base-40 transposer for the
+//     given interval.  Transposers are kept for each interval that has been
+//     used so that their lookup tables only need to be calculated once
+//     (such as when transposing parts to concert pitch).
+//
 
-	// consider interaction of #X -X n interaction vs. nX.
-	string output;
-	if (hre.search(input, "([A-Ga-g#n-]+)")) {
-		string oldpitch = hre.getMatch(1);
-		output = hre.replaceCopy(input, newpitch, oldpitch);
+HumTransposer& Tool_transpose::getTransposer(int transval) {
+	auto it = m_transposers.find(transval);
+	if (it != m_transposers.end()) {
+		return it->second;
 	}
-	m_humdrum_text << output;
+	HumTransposer& transposer = m_transposers[transval];
+	transposer.setBase40();
+	transposer.setTransposition(transval);
+	transposer.prepareKernTable();
+	return transposer;
 }
 
 
@@ -137182,8 +146928,13 @@ int Tool_transpose::getBase40ValueFromInterval(const string& interval) {
 //
 
 void Tool_transpose::example(void) {
-
-
+	m_free_text
+		<< getCommand() << " -t M3 file.krn      # transpose up a major third" << endl
+		<< getCommand() << " -t -P5 file.krn     # transpose down a perfect fifth" << endl
+		<< getCommand() << " -d 1 -c 2 file.krn  # same as -t M2" << endl
+		<< getCommand() << " -b 6 -s 2 file.krn  # transpose only the second spine" << endl
+		<< getCommand() << " -k e- file.krn      # transpose to the key of E-flat" << endl
+		<< getCommand() << " -C file.krn         # convert a written score to concert pitch" << endl;
 }
 
 
@@ -137194,7 +146945,20 @@ void Tool_transpose::example(void) {
 //
 
 void Tool_transpose::usage(const string& command) {
-
+	m_free_text
+		<< "Usage: " << command << " [-t interval | -b base40 | -d diatonic -c chromatic]"
+		<< " [options] [file(s)]" << endl
+		<< "Transpose **kern data (and key signatures, key designations and"
+		<< " *Tr codes)." << endl
+		<< "   -t interval  interval such as M3, -P5 or +m6" << endl
+		<< "   -b value     base-40 transposition interval" << endl
+		<< "   -d/-c value  diatonic and chromatic steps (both required)" << endl
+		<< "   -o value     octave transposition added to the interval" << endl
+		<< "   -k tonic     transpose to the given key" << endl
+		<< "   -s spines    transpose only the listed spines" << endl
+		<< "   -C / -W      convert between written and concert pitch" << endl
+		<< "   --auto       transpose instrumental parts to concert pitch" << endl
+		<< "   -T / -I      add *Tr / *ITr codes to the output" << endl;
 }
 
 
@@ -137715,26 +147479,27 @@ void Tool_transpose::addToHistogramDouble(vector<vector<double> >& histogram, in
 
 //////////////////////////////
 //
-// Tool_transpose::initialize --
+// Tool_transpose::initialize -- Returns false if the file should not be
+//     processed (such as for --help, or if there is an error in the options).
 //
 
-void Tool_transpose::initialize(HumdrumFile& infile) {
+bool Tool_transpose::initialize(HumdrumFile& infile) {
 
 	// handle basic options:
 	if (getBoolean("author")) {
 		m_free_text << "Written by Craig Stuart Sapp, "
 			  << "craig@ccrma.stanford.edu, 12 Apr 2004" << endl;
-		exit(0);
+		return false;
 	} else if (getBoolean("version")) {
 		m_free_text << getArg(0) << ", version: 10 Dec 2016" << endl;
 		m_free_text << "compiled: " << __DATE__ << endl;
-		exit(0);
+		return false;
 	} else if (getBoolean("help")) {
-		usage(getArg(0));
-		exit(0);
+		usage(getCommand());
+		return false;
 	} else if (getBoolean("example")) {
 		example();
-		exit(0);
+		return false;
 	}
 
 	transval     =  getInteger("base40");
@@ -137751,9 +147516,8 @@ void Tool_transpose::initialize(HumdrumFile& infile) {
 
 	switch (getBoolean("diatonic") + getBoolean("chromatic")) {
 		case 1:
-			cerr << "Error: both -d and -c options must be specified" << endl;
-			exit(1);
-			break;
+			m_error_text << "Error: both -d and -c options must be specified" << endl;
+			return false;
 		case 2:
 			{
 				char buffer[128] = {0};
@@ -137770,6 +147534,7 @@ void Tool_transpose::initialize(HumdrumFile& infile) {
 	}
 
 	transval += 40 * octave;
+	return true;
 }
 
 
@@ -138864,31 +148629,18 @@ void Tool_tspos::processFile(HumdrumFile& infile) {
 		chordPositions.clear();
 		thirdPositions.clear();
 		fifthPositions.clear();
-		for (int j=0; j<infile[i].getFieldCount(); j++) {
-			HTp token = infile.token(i, j); // get ptr to cell
-			// if not a **kern token, then skip:
-			if (!token->isKern()) {
-				continue;
-			}
-
-			if (token->isRest()) {
+		// Use the first note of each voice (chords count as a single voice),
+		// with null tokens resolved to the notes that they sustain:
+		HumSonority sonority = infile.getSonority(i);
+		int lastField = -1;
+		for (int j=0; j<sonority.getNoteCount(); j++) {
+			if (sonority.getFieldIndex(j) == lastField) {
 				continue;
 			}
-
-			HTp resolvedToken = NULL;
-			if (token->isNull()) {
-				resolvedToken = token->resolveNull();
-				if (!resolvedToken || resolvedToken->isRest()) {
-					continue;
-				}
-			}
-			if (resolvedToken) {
-				kernNotes.push_back(resolvedToken);
-			} else {
-				kernNotes.push_back(token);
-			}
+			lastField = sonority.getFieldIndex(j);
+			kernNotes.push_back(sonority.getToken(j));
+			midiNotes.push_back(sonority.getMidiPitch(j));
 		}
-		midiNotes = getMidiNotes(kernNotes);
 
 		if (m_colorThirds) { // thirds
 			thirdPositions = getThirds(midiNotes);
@@ -139067,11 +148819,7 @@ void Tool_tspos::analyzeVoiceCount(HumdrumFile& infile) {
 	vector<int>& voices = m_voiceCount;
 	voices.resize(infile.getLineCount());
 	for (int i=0; i<infile.getLineCount(); i++) {
-		if (!infile[i].isData()) {
-			voices[i] = 0;
-			continue;
-		}
-		voices[i] = countVoicesOnLine(infile, i);
+		voices[i] = infile.getSonority(i).getVoiceCount();
 	}
 }
 
@@ -139094,37 +148842,6 @@ void Tool_tspos::checkForTriadicSonority(vector<int>& positions, int line) {
 
 
 
-//////////////////////////////
-//
-// Tool_tspos::countVoicesOnLine --
-//
-
-int Tool_tspos::countVoicesOnLine(HumdrumFile& infile, int line) {
-	int output = 0;
-	for (int j=0; j<infile[line].getFieldCount(); j++) {
-		HTp token = infile.token(line, j);
-		if (!token->isKern()) {
-			continue;
-		}
-		if (token->isNull()) {
-			token = token->resolveNull();
-			if (!token) {
-				continue;
-			}
-			if (token->isNull()) {
-				continue;
-			}
-		}
-		if (token->isRest()) {
-			continue;
-		}
-		output++;
-	}
-	return output;
-}
-
-
-
 //////////////////////////////
 //
 // Tool_tspos::generateStatistics --
@@ -139957,30 +149674,6 @@ void Tool_tspos::keepOnlyDoubles(vector<int>& output) {
 
 
 
-//////////////////////////////
-//
-// Tool_tspos::getMidiNotes -- Convert kern notes to MIDI note numbers.
-//    If the note is sustaining, then make the MIDI note number negative.
-//
-
-vector<int> Tool_tspos::getMidiNotes(vector<HTp>& kernNotes) {
-	vector<int> output(kernNotes.size());
-	if (kernNotes.empty()) {
-		return output;
-	}
-	for (int i=0; i<(int)kernNotes.size(); i++) {
-		int midiNote = kernNotes.at(i)->getMidiPitch();
-		if (midiNote < 0) {
-			// negative values indicate sustained note.
-			midiNote = -midiNote;
-		}
-		output.at(i) = midiNote;
-	}
-	return output;
-}
-
-
-
 //////////////////////////////
 //
 // Tool_tspos::avoidRdfCollisions -- Adjust markers if they are already
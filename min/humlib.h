@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
-// Last Modified: Tue Mar  4 09:02:49 PST 2025
+// Last Modified: Sun Oct 18 19:08:24 UTC 2026
 // Filename:      min/humlib.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/min/humlib.h
 // Syntax:        C++11
@@ -40,13 +40,18 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define _HUMLIB_H_INCLUDED
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <cerrno>
 #include <chrono>
 #include <cmath>
+#include <condition_variable>
 #include <cstdarg>
+#include <cstdint>
 #include <cstring>
 #include <cstring>
 #include <ctime>
+#include <deque>
 #include <fstream>
 #include <functional>
 #include <iomanip>
@@ -54,12 +59,18 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <list>
 #include <locale>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <numeric>
 #include <random>
 #include <regex>
 #include <set>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -97,6 +108,12 @@ using std::vector;
    #include <sstream>
 #endif
 
+#ifdef _WIN32
+	#include <io.h>          /* _write (HumFdSink) */
+#else
+	#include <unistd.h>      /* write (HumFdSink)  */
+#endif
+
 #include "pugiconfig.hpp"
 #include "pugixml.hpp"
 
@@ -118,6 +135,7 @@ class HumdrumFileBase;
 class HumdrumFileStructure;
 class HumdrumFileContent;
 class HumdrumFile;
+class HumSpanTable;
 class MuseRecordBase;
 class MuseRecord;
 class MuseData;
@@ -276,6 +294,7 @@ class HumHash {
 
 	friend std::ostream& operator<<(std::ostream& out, const HumHash& hash);
 	friend std::ostream& operator<<(std::ostream& out, HumHash* hash);
+	friend class HumJsonWriter;
 };
 
 
@@ -501,6 +520,13 @@ class HumTransposer {
 		void        transpose            (HumPitch &pitch, int transVal);
 		void        transpose            (HumPitch &pitch, const std::string &transString);
 
+		// Bulk transposition of **kern data with a lookup table for the stored
+		// transposition interval.  The table is rebuilt automatically when the
+		// interval or the base changes.
+		void        prepareKernTable     (void);
+		const std::string& getKernTablePitch (int ipitch);
+		bool        transposeKernToken   (std::string &token);
+
 		// Convert between integer intervals and interval name strings:
 		std::string getIntervalName      (const HumPitch &p1, const HumPitch &p2);
 		std::string getIntervalName      (int intervalClass);
@@ -587,8 +613,14 @@ class HumTransposer {
 		// used to calculate semitones between diatonic pitch classes:
 		static const std::vector<int> m_diatonic2semitone;
 
+		// transposed **kern pitches indexed by integer pitch (see prepareKernTable):
+		std::vector<std::string> m_kernTable;
+		int m_kernTableBase = 0;
+		int m_kernTableTranspose = 0;
+
 	private:
 		void calculateDiatonicMapping(void);
+		bool transposeKernSubtoken(std::string &token, size_t start, size_t end);
 };
 
 
@@ -841,10 +873,13 @@ class HumAddress {
 		HLp                 getOwner          (void) const { return getLine(); }
 		bool                hasOwner          (void) const;
 
+		static std::shared_ptr<const std::string> makeSpineInfo(const std::string& spineinfo);
+
 	protected:
 		void                setOwner          (HLp aLine);
 		void                setFieldIndex     (int fieldlindex);
 		void                setSpineInfo      (const std::string& spineinfo);
+		void                setSpineInfo      (const std::shared_ptr<const std::string>& spineinfo);
 		void                setTrack          (int aTrack, int aSubtrack);
 		void                setTrack          (int aTrack);
 		void                setSubtrack       (int aSubtrack);
@@ -866,7 +901,10 @@ class HumAddress {
 		// But in this case there is a spine info simplification which will
 		// convert "(#)a (#)b" into "#" where # is the original spine number.
 		// Other more complicated mergers may be simplified in the future.
-		std::string m_spining;
+		// Common spine info strings point into a fixed table, and others
+		// are shared by the tokens that use them (see makeSpineInfo()),
+		// so each token does not need its own copy of the string.
+		std::shared_ptr<const std::string> m_spining;
 
 		// track: This is the track number of the spine.  It is the first
 		// number found in the spineinfo string.
@@ -949,6 +987,13 @@ class _HumInstrument {
 };
 
 
+// HumInstrument: look up the English name and General MIDI instrument of
+// a Humdrum instrument code such as "*Iflt".  The table of codes is a
+// constant array sorted by code (built at compile time), so lookups are
+// binary searches that need no initialization or locking.  Instruments
+// added or changed with setGM() are only known to the object that they were
+// set in.
+
 class HumInstrument {
 	public:
 		            HumInstrument       (void);
@@ -963,18 +1008,23 @@ class HumInstrument {
 		void        setHumdrum          (const std::string& Hname);
 		int         setGM               (const std::string& Hname, int aValue);
 
+		static int  getInstrumentCount  (void);
+		static _HumInstrument getInstrument(int index);
+
 	private:
-		int                            m_index;
-		static std::vector<_HumInstrument>  m_data;
-		static int                     m_classcount;
+		// m_index: index in the instrument table of the code given to
+		// setHumdrum(), or -1 if the code is not in the table.
+		int                        m_index;
+
+		// m_humdrum: code given to setHumdrum() (without *I).
+		std::string                m_humdrum;
+
+		// m_gm: General MIDI instruments given to setGM().
+		std::map<std::string, int> m_gm;
 
 	protected:
-		void       initialize          (void);
-		void       afi                 (const char* humdrum_name, int midinum,
-		                                const char* EN_name);
-		int        find                (const std::string& Hname);
-		void       sortData            (void);
-		static int data_compare_by_humdrum_name(const void* a, const void* b);
+		static int find                (const std::string& Hname);
+		static std::string stripPrefix (const std::string& Hname);
 };
 
 
@@ -1466,6 +1516,43 @@ std::ostream& operator<< (std::ostream& out, HLp line);
 
 
 
+class HumTokenLinks {
+	public:
+		             HumTokenLinks  (void);
+		             HumTokenLinks  (const HumTokenLinks& links);
+		            ~HumTokenLinks  ();
+
+		HumTokenLinks& operator=    (const HumTokenLinks& links);
+		HTp          operator[]     (int index) const { return data()[index]; }
+		HTp&         operator[]     (int index) { return data()[index]; }
+		int          size           (void) const { return m_size; }
+		bool         empty          (void) const { return m_size == 0; }
+		HTp          back           (void) const { return data()[m_size-1]; }
+		void         clear          (void) { m_size = 0; }
+		void         resize         (int newsize);
+		void         push_back      (HTp token);
+		std::vector<HTp> toVector   (void) const;
+
+	protected:
+		const HTp*   data           (void) const
+		                            { return m_capacity > 1 ? m_list : &m_single; }
+		HTp*         data           (void)
+		                            { return m_capacity > 1 ? m_list : &m_single; }
+		void         reserve        (int capacity);
+
+	private:
+		// The link is stored directly in m_single when the capacity is 1,
+		// otherwise the links are stored in the array m_list.
+		union {
+			HTp  m_single;
+			HTp* m_list;
+		};
+		int m_size;
+		int m_capacity;
+};
+
+
+
 
 typedef HumdrumToken* HTp;
 
@@ -1679,7 +1766,7 @@ class HumdrumToken : public std::string, public HumHash {
 		bool     isMens                    (void) const;
 		bool     isMensLike                (void) const;
 		bool     isStaffLike               (void) const { return isKernLike() || isMensLike(); }
-		std::string   getSpineInfo         (void) const;
+		const std::string& getSpineInfo    (void) const;
 		int      getTrack                  (void) const;
 		int      getSpineIndex             (void) const;
 		int      getSubtrack               (void) const;
@@ -1795,6 +1882,7 @@ class HumdrumToken : public std::string, public HumHash {
 		void     setLineIndex              (int lineindex);
 		void     setFieldIndex             (int fieldlindex);
 		void     setSpineInfo              (const std::string& spineinfo);
+		void     setSpineInfo              (const std::shared_ptr<const std::string>& spineinfo);
 		void     setSubtrack               (int aSubtrack);
 		void     setSubtrackCount          (int count);
 		void     setPreviousToken          (HTp aToken);
@@ -1809,6 +1897,9 @@ class HumdrumToken : public std::string, public HumHash {
 		void     setStrandIndex            (int index);
 
 		bool     analyzeDuration           (void);
+		HumSpanTable* getSlurTable         (void);
+		HumSpanTable* getPhraseTable       (void);
+		int      getSlurTableId            (void);
 		std::ostream& printXmlBaseInfo     (std::ostream& out = std::cout, int level = 0,
 		                                    const std::string& indent = "\t");
 		std::ostream& printXmlContentInfo  (std::ostream& out = std::cout, int level = 0,
@@ -1837,22 +1928,22 @@ class HumdrumToken : public std::string, public HumHash {
 		// following token, but there can be two tokens if the current
 		// token is *^, and there will be zero following tokens after a
 		// spine terminating token (*-).
-		std::vector<HTp> m_nextTokens;     // link to next token(s) in spine
+		HumTokenLinks m_nextTokens;     // link to next token(s) in spine
 
 		// previousTokens: Simiar to nextTokens, but for the immediately
 		// follow token(s) in the data.  Typically there will be one
 		// preceding token, but there can be multiple tokens when the previous
 		// line has *v merge tokens for the spine.  Exclusive interpretations
 		// have no tokens preceding them.
-		std::vector<HTp> m_previousTokens; // link to last token(s) in spine
+		HumTokenLinks m_previousTokens; // link to last token(s) in spine
 
 		// nextNonNullTokens: This is a list of non-tokens in the spine
 		// that follow this one.
-		std::vector<HTp> m_nextNonNullTokens;
+		HumTokenLinks m_nextNonNullTokens;
 
 		// previousNonNullTokens: This is a list of non-tokens in the spine
 		// that preced this one.
-		std::vector<HTp> m_previousNonNullTokens;
+		HumTokenLinks m_previousNonNullTokens;
 
 		// rhycheck: Used to perfrom HumdrumFileStructure::analyzeRhythm
 		// recursively.
@@ -1947,65 +2038,80 @@ class TokenPair {
 };
 
 
-// HumFileAnalysis: class used to manage analysis states for a Humdrum file.
+// HumFileAnalysis: registry of the analysis passes which have been run
+// on a Humdrum file.  Each pass declares the passes that it depends on
+// (see HumFileAnalysis::getDependencies() in HumdrumFileBase.cpp), and
+// invalidating a pass also invalidates all passes which depend on it.
+// The structure passes (PASS_STRANDS to PASS_RHYTHM) are run when the
+// file is read, and the content passes are run on demand by
+// HumdrumFileContent::requireAnalysis().  All content passes are
+// invalidated by HumdrumFileBase::createLinesFromTokens(), since the
+// tokens have usually been changed when it is called.
 
 class HumFileAnalysis {
 	public:
-		HumFileAnalysis(void) {}
+		enum Pass {
+			// Structure passes (HumdrumFileStructure):
+			PASS_STRANDS = 0,     // spine strands
+			PASS_NULLS,           // null token resolution
+			PASS_STROPHES,        // strophe markers
+			PASS_STRUCTURE,       // global/local parameters, token durations
+			PASS_RHYTHM,          // rhythmic positions of lines
+
+			// Content passes (HumdrumFileContent):
+			PASS_TOKEN_INDEX,     // token ids of the analysis tables
+			PASS_OTTAVAS,         // ottava marks ("auto" ottava parameters)
+			PASS_KERN_ACCIDENTALS,
+			PASS_MENS_ACCIDENTALS,
+			PASS_SLURS,
+			PASS_BEAMS,
+			PASS_PHRASES,
+			PASS_TIES,
+			PASS_BARLINES,        // barline differences between staves
+			PASS_MEASURES,        // measure index
+			PASS_REST_POSITIONS,
+			PASS_NULL_TABLE,      // null-token resolution table
+			PASS_SONORITIES,      // sounding pitches on each data line
+			PASS_METRIC_GRID,     // metric positions of data lines
+			PASS_TEXT,            // lyric syllables, words and melismas
+			PASS_STRAND_TABLE,    // tokens of each strand in contiguous arrays
+
+			PASS_COUNT
+		};
+
+		HumFileAnalysis(void) { clear(); }
 		~HumFileAnalysis() { clear(); }
 		void clear(void) {
-			m_structure_analyzed = false;
-			m_rhythm_analyzed    = false;
-			m_strands_analyzed   = false;
-			m_slurs_analyzed     = false;
-			m_beams_analyzed     = false;
-			m_phrases_analyzed   = false;
-			m_nulls_analyzed     = false;
-			m_strophes_analyzed  = false;
-
-			m_barlines_analyzed  = false;
+			m_done = 0;
+			m_version++;
 			m_barlines_different = false;
 		}
+		bool isDone(Pass pass) const { return (m_done >> pass) & 1; }
+		void setDone(Pass pass, bool state = true) {
+			if (state) {
+				m_done |= (1u << pass);
+			} else {
+				m_done &= ~(1u << pass);
+			}
+		}
+		void invalidate(Pass pass);
+		void invalidateContent(void);
+		int  getVersion(void) const { return m_version; }
+		static unsigned int getDependencies(Pass pass);
 
-		// m_structure_analyzed: Used to keep track of whether or not
-		// file structure has been analyzed.
-		bool m_structure_analyzed = false;
-
-		// m_rhythm_analyzed: Used to keep track of whether or not
-		// rhythm structure has been analyzed.
-		bool m_rhythm_analyzed = false;
-
-		// m_strands_analyzed: Used to keep track of whether or not
-		// file strands have been analyzed.
-		bool m_strands_analyzed = false;
-
-		// m_strophes_analyzed: Used to keep track of whether or not
-		// file strands have been analyzed.
-		bool m_strophes_analyzed = false;
-
-		// m_slurs_analyzed: Used to keep track of whether or not
-		// slur endpoints have been linked or not.
-		bool m_slurs_analyzed = false;
-
-		// m_phrases_analyzed: Used to keep track of whether or not
-		// phrase endpoints have been linked or not.
-		bool m_phrases_analyzed = false;
-
-		// m_beams_analyzed: Used to keep track of whether or not
-		// beam endpoints have been linked or not.
-		bool m_beams_analyzed = false;
-
-		// m_nulls_analyzed: Used to keep track of wheter or not
-		// null tokens have been analyzed yet.
-		bool m_nulls_analyzed = false;
-
-		// m_barlines_analyzed: Used to keep track of wheter or not
-		// barlines have beena analyzed yet.
-		bool m_barlines_analyzed = false;
 		// m_barlines_different: Set to true when the file contains
 		// any barlines that are not all of the same at the same
-		// times.
+		// times (result of PASS_BARLINES).
 		bool m_barlines_different = false;
+
+	private:
+		// m_done: bitmask of the passes which have been run since
+		// the last invalidation.
+		unsigned int m_done = 0;
+
+		// m_version: incremented each time analysis results are
+		// invalidated.
+		int m_version = 0;
 };
 
 bool sortTokenPairsByLineIndex(const TokenPair& a, const TokenPair& b);
@@ -2233,7 +2339,7 @@ class HumdrumFileBase : public HumHash {
 		bool          stitchLinesTogether       (HumdrumLine& previous,
 		                                         HumdrumLine& next);
 		void          addToTrackStarts          (HTp token);
-		void          addUniqueTokens           (std::vector<HTp>& target,
+		void          addUniqueTokens           (HumTokenLinks& target,
 		                                         std::vector<HTp>& source);
 		bool          processNonNullDataTokensForTrackForward(HTp starttoken,
 		                                         std::vector<HTp> ptokens);
@@ -2512,6 +2618,545 @@ class HumdrumFileStructure : public HumdrumFileBase {
 
 
 
+// HumSpanTable: links between the start and end tokens of slurs, beams,
+// ties or phrases.  Each token can start and end more than one span, so
+// the links are stored in a list, and each token has a chain of the links
+// starting and ending on it.  Span numbers are the enumerations used in
+// the "auto" HumHash parameters: for slurs, the start number is the index
+// of the opening character on the start token (counting from the last
+// one), and the end number is the index of the closing character on the
+// end token.  Phrases are numbered in the order that they were linked on
+// each token, and ties by the chord note (subtoken index plus one) that
+// they start or end on.  When spines are analyzed in parallel, a mutex
+// can be given to the table with setMutex() to serialize the additions to
+// the link list and hanging-span maps (all other storage is per token, and
+// each token is written by a single thread).
+
+class HumSpanTable {
+	public:
+		            HumSpanTable     (void);
+		void        clear            (void);
+		void        resize           (int tokenCount);
+
+		void        addLink          (int startid, int endid, HTp starttok,
+		                              HTp endtok, int startnumber, int endnumber,
+		                              HumNum duration);
+		void        addHanging       (int id, bool start, HumNum duration,
+		                              int openindex = -1, bool endingback = false);
+		void        setSpanMember    (int id, HTp spanstart);
+		void        setSpanEndpoints (int startid, int endid);
+		void        setMutex         (std::mutex* mutex) { m_mutex = mutex; }
+
+		HTp         getEndToken      (int id, int startnumber = 1) const;
+		HTp         getStartToken    (int id, int endnumber = 1) const;
+		int         getEndNumber     (int id, int startnumber = 1) const;
+		int         getStartNumber   (int id, int endnumber = 1) const;
+		HumNum      getDuration      (int id, int startnumber = 1) const;
+		int         getStartCount    (int id) const;
+		int         getEndCount      (int id) const;
+		int         getHangingSide   (int id) const;
+		int         getOpenIndex     (int id) const;
+		bool        isEndingBack     (int id) const;
+		HTp         getSpanStart     (int id) const;
+		bool        isSpanStart      (int id) const;
+		bool        isSpanEnd        (int id) const;
+
+	protected:
+		int         findStartLink    (int id, int startnumber) const;
+		int         findEndLink      (int id, int endnumber) const;
+
+	private:
+		enum {
+			FLAG_HANGING_START = 1,
+			FLAG_HANGING_STOP  = 2,
+			FLAG_ENDING_BACK   = 4,
+			FLAG_SPAN_START    = 8,
+			FLAG_SPAN_END      = 16
+		};
+
+		// Token arrays (indexed by token id):
+		std::vector<int>     m_firstStart;  // first link starting on token
+		std::vector<int>     m_firstEnd;    // first link ending on token
+		std::vector<short>   m_startCount;  // number of links starting on token
+		std::vector<short>   m_endCount;    // number of links ending on token
+		std::vector<uint8_t> m_flags;       // hanging/span states
+		std::vector<HTp>     m_spanStart;   // start of span containing token
+
+		// Link arrays (indexed by link):
+		std::vector<HTp>     m_startTokens;
+		std::vector<HTp>     m_endTokens;
+		std::vector<int>     m_startNumbers;
+		std::vector<int>     m_endNumbers;
+		std::vector<HumNum>  m_durations;
+		std::vector<int>     m_nextStart;   // next link starting on same token
+		std::vector<int>     m_nextEnd;     // next link ending on same token
+
+		// Hanging spans are rare, so store their parameters sparsely:
+		std::map<int, HumNum> m_hangingDurations;
+		std::map<int, int>    m_openIndexes;
+
+		// Lock for addLink() and addHanging() during parallel analyses:
+		std::mutex*           m_mutex = NULL;
+};
+
+
+
+class HumSonorityTable;
+
+// HumSonority: the notes sounding on one data line of a file (a vertical
+// slice through the **kern spines), as stored in a HumSonorityTable.
+// Null tokens are resolved to the notes that they sustain, and rests are
+// not included.  Notes are listed in field order, and in chord order
+// within each field.  Pitch-class sets are bitmasks: bit n of the base-40
+// set is base-40 pitch class n (C=2, C#=3, ...), and bit n of the base-12
+// set is chromatic pitch class n (C=0, C#=1, ...).  A note is an attack
+// if it starts on the line (it is not from a null token, and it is not
+// the continuation of a tie).  The sonority is a view into the table,
+// so it is only valid while the table is not changed.
+
+class HumSonority {
+	public:
+		             HumSonority              (const HumSonorityTable* table = NULL,
+		                                       int line = -1);
+		int          getLineIndex             (void) const;
+		bool         isEmpty                  (void) const;
+		int          getNoteCount             (void) const;
+		int          getAttackCount           (void) const;
+		int          getVoiceCount            (void) const;
+
+		int          getBase40                (int index) const;
+		int          getBase40Pc              (int index) const;
+		int          getMidiPitch             (int index) const;
+		HTp          getToken                 (int index) const;
+		int          getFieldIndex            (int index) const;
+		int          getSubtokenIndex         (int index) const;
+		bool         isAttack                 (int index) const;
+		int          getLowestIndex           (void) const;
+
+		uint64_t     getPitchClassSet         (void) const;
+		uint64_t     getAttackPitchClassSet   (void) const;
+		uint16_t     getPitchClassSet12       (void) const;
+		uint16_t     getAttackPitchClassSet12 (void) const;
+
+	private:
+		const HumSonorityTable* m_table;
+		int          m_line;
+		int          m_start;   // index of first note of line in table
+		int          m_count;   // number of notes on line
+};
+
+
+
+// HumSonorityTable: the sonority of each data line in a file, filled in
+// by HumdrumFileContent::analyzeSonorities().  The notes of all lines are
+// stored in one set of arrays, and iterating over the table visits the
+// sonority of each data line in order:
+//
+//    for (HumSonority slice : infile.getSonorities()) { ... }
+
+class HumSonorityTable {
+	public:
+		class const_iterator {
+			public:
+				const_iterator(const HumSonorityTable* table, int index)
+					: m_table(table), m_index(index) { }
+				HumSonority operator*(void) const {
+					return m_table->getSonority(m_table->m_dataLines[m_index]);
+				}
+				const_iterator& operator++(void) { m_index++; return *this; }
+				bool operator==(const const_iterator& other) const {
+					return m_index == other.m_index;
+				}
+				bool operator!=(const const_iterator& other) const {
+					return m_index != other.m_index;
+				}
+			private:
+				const HumSonorityTable* m_table;
+				int m_index;
+		};
+
+		             HumSonorityTable   (void);
+		void         clear              (void);
+		void         resize             (int lineCount);
+		void         addSlice           (int line);
+		void         addNote            (int line, HTp token, int field,
+		                                 int subtoken, int base40, bool attack);
+
+		int          getLineCount       (void) const;
+		int          getSliceCount      (void) const;
+		HumSonority  getSonority        (int line) const;
+		HumSonority  operator[]         (int line) const { return getSonority(line); }
+		const_iterator begin            (void) const { return const_iterator(this, 0); }
+		const_iterator end              (void) const {
+			return const_iterator(this, (int)m_dataLines.size());
+		}
+
+	private:
+		friend class HumSonority;
+
+		// Line arrays (indexed by line):
+		std::vector<int>      m_noteStart;    // index of first note on line
+		std::vector<short>    m_noteCount;    // number of notes on line
+		std::vector<short>    m_attackCount;  // number of attacked notes
+		std::vector<short>    m_voiceCount;   // number of fields with notes
+		std::vector<short>    m_lowest;       // index of lowest note on line
+		std::vector<uint64_t> m_pitchClasses;
+		std::vector<uint64_t> m_attackPitchClasses;
+		std::vector<uint16_t> m_pitchClasses12;
+		std::vector<uint16_t> m_attackPitchClasses12;
+
+		// Slice array: line index of each data line.
+		std::vector<int>      m_dataLines;
+
+		// Note arrays (indexed by note):
+		std::vector<short>    m_base40;
+		std::vector<short>    m_midi;
+		std::vector<HTp>      m_tokens;       // token containing note
+		std::vector<short>    m_fields;       // field of note on its line
+		std::vector<uint8_t>  m_subtokens;    // chord index of note
+		std::vector<uint8_t>  m_attacks;      // 1 = attack, 0 = sustain
+};
+
+
+
+// HumMetricTable: the metric position of each data line in each track of
+// a file, filled in by HumdrumFileContent::analyzeMetricGrid().  The meter
+// of a track is set by time signatures (*M3/4) in the track, and the beat
+// duration can be changed from the default for the meter by *beat:
+// interpretations (such as *beat:4.), which stay active until the next
+// time signature.  Compound meters (such as 6/8, but not 3/8) have
+// dotted beats.  Without a time signature, the beat is a quarter note.
+// Beats are counted from 1 at the previous barline, and the beat fraction
+// is the position within the beat (from 0 up to 1).  The metric level is
+// the one given by HumdrumFileContent::getMetricLevels(), which does not
+// use *beat: interpretations.  Tracks are indexed from 1, and only data
+// lines have entries.
+
+class HumMetricTable {
+	public:
+		             HumMetricTable     (void);
+		void         clear              (void);
+		void         resize             (int lineCount, int trackCount);
+		int          addMeter           (int top, int bottom, int bottom2,
+		                                 HumNum beat);
+		void         addLine            (int line, HumNum position);
+		void         setPosition        (int line, int track, int meter,
+		                                 int beat, HumNum fraction,
+		                                 double level);
+
+		int          getLineCount       (void) const;
+		int          getTrackCount      (void) const;
+		bool         hasPosition        (int line, int track) const;
+		HumNum       getMeasurePosition (int line) const;
+
+		bool         hasMeter           (int line, int track) const;
+		int          getMeterTop        (int line, int track) const;
+		HumNum       getMeterBottom     (int line, int track) const;
+		bool         isCompound         (int line, int track) const;
+		HumNum       getBeatDuration    (int line, int track) const;
+		HumNum       getExplicitBeat    (int line, int track) const;
+
+		int          getBeat            (int line, int track) const;
+		HumNum       getBeatFraction    (int line, int track) const;
+		double       getMetricLevel     (int line, int track,
+		                                 double undefined = NAN) const;
+
+	protected:
+		int          getIndex           (int line, int track) const;
+		int          getMeterIndex      (int line, int track) const;
+
+	private:
+		int                   m_trackCount = 0;
+
+		// Meter arrays (indexed by meter, where meter 0 is used for tracks
+		// without a time signature):
+		std::vector<int>      m_meterTops;
+		std::vector<HumNum>   m_meterBottoms;
+		std::vector<uint8_t>  m_compound;
+		std::vector<HumNum>   m_beatDurations;
+		std::vector<HumNum>   m_explicitBeats; // *beat: duration (0 if none)
+
+		// Line arrays (indexed by line):
+		std::vector<int>      m_rows;         // row of data line (-1 if none)
+
+		// Row arrays (indexed by row, one row for each data line):
+		std::vector<HumNum>   m_positions;    // quarter notes from barline
+
+		// Position arrays (indexed by row * track count + track - 1):
+		std::vector<int>      m_meters;       // meter index
+		std::vector<int>      m_beats;        // beat number (from 1)
+		std::vector<HumNum>   m_fractions;    // position within beat
+		std::vector<double>   m_levels;       // metric level
+};
+
+
+
+// HumTextTable: the syllables of the lyric spines of a file (**text,
+// **silbe, **sylb and **sylba) assembled into words, filled in by
+// HumdrumFileContent::analyzeText().  A syllable starting with "-"
+// continues the previous word in its spine, and other syllables start a
+// new word.  Each syllable is linked to the notes of the first **kern spine
+// to the left of its spine: the melisma of the syllable is the number of
+// note attacks from its line up to the line of the next syllable (or the
+// end of the lyric spine), and its end time is the end of the last of these
+// notes (including tied notes).
+// Spines are numbered in the order of the file, and the syllables and
+// words of each spine are numbered consecutively in line order.
+
+class HumTextTable {
+	public:
+		             HumTextTable          (void);
+		void         clear                 (void);
+		void         setLineCount          (int lineCount);
+		int          addSpine              (HTp start);
+		int          addSyllable           (int spine, HTp token);
+		void         setNotes              (int syllable, int count, HTp first,
+		                                    HTp last, HumNum endtime);
+
+		int          getLineCount          (void) const;
+		int          getSpineCount         (void) const;
+		HTp          getSpineStart         (int spine) const;
+		int          getSpineSyllableStart (int spine) const;
+		int          getSpineSyllableCount (int spine) const;
+		int          getSpineWordStart     (int spine) const;
+		int          getSpineWordCount     (int spine) const;
+
+		int          getSyllableCount      (void) const;
+		HTp          getSyllableToken      (int syllable) const;
+		int          getSyllableSpine      (int syllable) const;
+		int          getSyllableWord       (int syllable) const;
+		int          getNoteCount          (int syllable) const;
+		HTp          getFirstNote          (int syllable) const;
+		HTp          getLastNote           (int syllable) const;
+		HumNum       getEndTime            (int syllable) const;
+
+		int          getWordCount          (void) const;
+		const std::string& getWordText     (int word) const;
+		const std::string& getNormalizedWord(int word) const;
+		HTp          getWordToken          (int word) const;
+		int          getWordSpine          (int word) const;
+		int          getWordSyllableStart  (int word) const;
+		int          getWordSyllableCount  (int word) const;
+		int          getWordNoteCount      (int word) const;
+
+		static std::string normalize       (const std::string& text);
+
+	private:
+		int                      m_lineCount = 0;
+
+		// Spine arrays (indexed by spine):
+		std::vector<HTp>         m_spineStarts;
+		std::vector<int>         m_spineSyllables; // first syllable of spine
+		std::vector<int>         m_spineWords;     // first word of spine
+
+		// Syllable arrays (indexed by syllable):
+		std::vector<HTp>         m_syllables;      // token of syllable
+		std::vector<int>         m_syllableWords;  // word containing syllable
+		std::vector<int>         m_noteCounts;     // melisma (attacks)
+		std::vector<HTp>         m_firstNotes;     // first note of syllable
+		std::vector<HTp>         m_lastNotes;      // last note of syllable
+		std::vector<HumNum>      m_endTimes;       // end of last note
+
+		// Word arrays (indexed by word):
+		std::vector<std::string> m_words;          // syllables without hyphens
+		std::vector<std::string> m_normalized;     // see normalize()
+		std::vector<int>         m_wordSpines;
+		std::vector<int>         m_wordSyllables;  // first syllable of word
+		std::vector<int>         m_wordNotes;      // total melisma of word
+};
+
+
+
+// HumStrandTable: the tokens of each spine strand of a file stored in
+// contiguous arrays, filled in by HumdrumFileContent::analyzeStrandTable().
+// Strands are numbered as in HumdrumFileStructure::getStrandStart(): by
+// spine, then by starting line, where each subspine created by a spine
+// split is a separate strand.  The entries of a strand are its tokens from
+// the start to the end of the strand in line order, and the entries of
+// strand s are numbered from getStrandOffset(s) up to getStrandOffset(s) +
+// getStrandSize(s) - 1, so a strand can be processed with a loop over its
+// entries rather than by following getNextToken().  Each entry stores the
+// line and field of its token, the start time of the token (quarter notes
+// from the start of the file) and the strophe that contains it (see
+// HumdrumToken::getStrophe()), where strophes are numbered in the order
+// that they are first found in the strands.
+// The table is not changed after it is filled, so several threads can
+// read different strands at the same time.
+
+class HumStrandTable {
+	public:
+		             HumStrandTable     (void);
+		void         clear              (void);
+		void         setLineCount       (int lineCount);
+		int          addStrand          (int spine);
+		int          addToken           (HTp token);
+
+		int          getLineCount       (void) const;
+		int          getStrandCount     (void) const;
+		int          getStrandOffset    (int strand) const;
+		int          getStrandSize      (int strand) const;
+		int          getStrandSpine     (int strand) const;
+		int          getStrandTrack     (int strand) const;
+
+		int          getEntryCount      (void) const;
+		HTp          getToken           (int entry) const;
+		int          getLine            (int entry) const;
+		int          getField           (int entry) const;
+		HumNum       getStartTime       (int entry) const;
+		int          getStrophe         (int entry) const;
+		int          getStropheCount    (void) const;
+		HTp          getStropheStart    (int strophe) const;
+		bool         isData             (int entry) const;
+		bool         isNull             (int entry) const;
+
+	private:
+		int                   m_lineCount = 0;
+
+		// Strand arrays (indexed by strand):
+		std::vector<int>      m_offsets;      // first entry of strand
+		std::vector<int>      m_spines;       // spine index of strand
+		std::vector<int>      m_tracks;       // track of strand
+
+		// Entry arrays (indexed by entry):
+		std::vector<HTp>      m_tokens;
+		std::vector<int>      m_lines;
+		std::vector<int>      m_fields;
+		std::vector<HumNum>   m_startTimes;
+		std::vector<int>      m_strophes;     // strophe index (-1 if none)
+		std::vector<uint8_t>  m_types;        // TYPE_DATA and TYPE_NULL bits
+
+		// Strophe arrays (indexed by strophe):
+		std::vector<HTp>      m_stropheStarts; // *S/ token starting strophe
+
+		enum {
+			TYPE_DATA = 1,
+			TYPE_NULL = 2
+		};
+};
+
+
+
+// HumAnalysisTables: per-file analysis results of HumdrumFileContent,
+// indexed by token id (the position of the token in the file when read
+// line by line).  The token index is created when the first analysis
+// using the tables is run, so tokens added after that are not indexed.
+// The analyses which have filled the tables are tracked by the analysis
+// pass registry of the file (see HumFileAnalysis).  Stem lengths and
+// barline comparisons are only stored as "auto" HumHash parameters (of
+// tokens and lines), since they are single values for a few tokens or
+// lines of a file.
+
+class HumAnalysisTables {
+	public:
+		             HumAnalysisTables   (void);
+		void         clear               (void);
+		void         indexTokens         (HumdrumFileBase& infile);
+		bool         isIndexCurrent      (HumdrumFileBase& infile) const;
+		int          getLineCount        (void) const;
+		int          getTokenCount       (void) const;
+		int          getTokenId          (HTp token) const;
+		int          getTokenId          (int line, int field) const;
+		HTp          getToken            (int id) const;
+		int          getTokenLine        (int id) const;
+		int          getTokenField       (int id) const;
+
+		// Accidental analysis:
+		enum {
+			ACCID_VISUAL     = 1,
+			ACCID_CAUTIONARY = 2,
+			ACCID_OBLIGATORY = 4
+		};
+		bool         setAccidentalFlags  (int id, int subtoken, int flags);
+		int          getAccidentalFlags  (int id, int subtoken) const;
+
+		// Slur, beam, tie and phrase analyses:
+		HumSpanTable& getSlurs           (void) { return m_slurs; }
+		HumSpanTable& getBeams           (void) { return m_beams; }
+		HumSpanTable& getTies            (void) { return m_ties; }
+		HumSpanTable& getPhrases         (void) { return m_phrases; }
+
+		// Rest vertical positions:
+		void         setRestPosition     (int id, int diatonic, int octave);
+		bool         getRestPosition     (int id, int& diatonic, int& octave) const;
+
+		// Null-token resolution:
+		void         setNullResolution   (int id, int resolved, int attackline);
+		int          getNullResolution   (int id) const;
+		int          getAttackLine       (int id) const;
+
+		// Sonorities of data lines:
+		HumSonorityTable& getSonorities  (void) { return m_sonorities; }
+
+	protected:
+		int          getAccidentalIndex  (int id, int subtoken) const;
+
+	private:
+		// Token index:
+		std::vector<int>      m_lineOffsets;  // token id of first token on each line
+		std::vector<HTp>      m_tokens;       // token for each token id
+		std::vector<int>      m_tokenLines;   // line index for each token id
+
+		// Accidental display (ACCID_* flags) of each subtoken of the data
+		// tokens.  The flags of subtoken n of a token are at
+		// m_accidentals[m_accidentalOffsets[id] + n].
+		std::vector<int>      m_accidentalOffsets;
+		std::vector<uint8_t>  m_accidentals;
+
+		HumSpanTable          m_slurs;
+		HumSpanTable          m_beams;
+		HumSpanTable          m_ties;
+		HumSpanTable          m_phrases;
+
+		// Rest positions: diatonic pitch class (0=C to 6=B, -1 if none) and
+		// octave of the vertical rest position.
+		std::vector<int8_t>   m_restDiatonic;
+		std::vector<int8_t>   m_restOctave;
+
+		// Null-token resolution: token id of the last non-null data token
+		// in the (sub)spine at or before each token (-1 if none), and the
+		// line on which that note was attacked (the start of its tie
+		// group for tied notes).
+		std::vector<int>      m_nullResolution;
+		std::vector<int>      m_attackLines;
+
+		HumSonorityTable      m_sonorities;
+};
+
+
+
+// HumMeasureInfo: entry in the measure index of a HumdrumFileContent
+// (see HumdrumFileContent-measure.cpp).
+
+class HumMeasureInfo {
+	public:
+		HumMeasureInfo(void) { clear(); }
+		void clear(void) {
+			number = -1;
+			startline = stopline = -1;
+			clef.clear(); keysig.clear(); key.clear();
+			timesig.clear(); met.clear(); tempo.clear();
+			subtracks.clear();
+		}
+
+		int number;             // measure number (0 for pickup measure)
+		int startline;          // starting barline (first data line for pickup)
+		int stopline;           // ending barline (or terminator line)
+
+		// Active spine layout at the start of the measure: the number of
+		// subspines for each track (indexed by track number).
+		std::vector<int> subtracks;
+
+		// Prevailing interpretations at the start of the measure,
+		// indexed by track number (NULL if none).
+		std::vector<HTp> clef;
+		std::vector<HTp> keysig;
+		std::vector<HTp> key;
+		std::vector<HTp> timesig;
+		std::vector<HTp> met;
+		std::vector<HTp> tempo;
+};
+
+
 class HumdrumFileContent : public HumdrumFileStructure {
 	public:
 		       HumdrumFileContent         (void);
@@ -2519,16 +3164,41 @@ class HumdrumFileContent : public HumdrumFileStructure {
 		       HumdrumFileContent         (std::istream& contents);
 		      ~HumdrumFileContent         ();
 
+		// Each analysis is run once for each version of the file, and
+		// later calls return without analyzing again.  After changing
+		// tokens, call createLinesFromTokens() or invalidateAnalysis() so
+		// that the next call analyzes the new contents.
 		bool   analyzeSlurs               (void);  // in src/HumdrumFileContents-slur.cpp
 		bool   analyzeBeams               (void);  // in src/HumdrumFileContents-beam.cpp
 		bool   analyzePhrasings           (void);
 		bool   analyzeTextRepetition      (void);
+		bool   analyzeText                (void);
+		const HumTextTable& getTextTable  (void);
 		bool   analyzeKernTies            (void);
 		bool   analyzeAccidentals         (void);
 		bool   analyzeKernAccidentals     (const std::string& dataType = "**kern");
 		bool   analyzeMensAccidentals     (void);
 		bool   analyzeRScale              (void);
 
+		// Analysis pass registry: run a pass and its dependencies if needed.
+		bool   requireAnalysis            (HumFileAnalysis::Pass pass);
+		bool   isAnalyzed                 (HumFileAnalysis::Pass pass) const;
+		void   invalidateAnalysis         (HumFileAnalysis::Pass pass);
+
+		// Typed analysis results (accidentals, slurs, beams, rest positions).
+		// The analyses also store their results as strings in the "auto"
+		// HumHash namespace of each token unless setAnalysisHashValues(false)
+		// is called before running them.
+		HumAnalysisTables& getAnalysisTables(void);
+		void   setAnalysisHashValues      (bool state);
+		bool   getAnalysisHashValues      (void) const;
+
+		// Slur, beam and accidental analyses can analyze each spine in a
+		// separate thread (default 1 for serial analysis; 0 for the number
+		// of cores).
+		void   setAnalysisThreadCount     (int count);
+		int    getAnalysisThreadCount     (void) const;
+
 		// in HumdrumFileContent-hand.cpp
 		bool   doHandAnalysis             (bool attacksOnlyQ = false);
 		bool   doHandAnalysis             (HTp startSpine, bool attacksOnlyQ = false);
@@ -2539,6 +3209,7 @@ class HumdrumFileContent : public HumdrumFileStructure {
 		// in HumdrumFileContent-midi.cpp
 		void fillMidiInfo(std::vector<std::vector<std::vector<std::pair<HTp, int>>>>& trackMidi);
 		void processStrandNotesForMidi(HTp sstart, HTp send, std::vector<std::vector<std::pair<HTp, int>>>& trackInfo);
+		void processStrandNotesForMidi(int strand, std::vector<std::vector<std::pair<HTp, int>>>& trackInfo);
 
 		// in HumdrumFileContent-rest.cpp
 		void  analyzeRestPositions                  (void);
@@ -2549,6 +3220,12 @@ class HumdrumFileContent : public HumdrumFileStructure {
 		bool analyzeKernStemLengths       (void);
 
 		// in HumdrumFileContent-metlev.cpp
+		bool  analyzeMetricGrid           (void);
+		const HumMetricTable& getMetricGrid(void);
+
+		// in HumdrumFileContent-strand.cpp
+		bool  analyzeStrandTable          (void);
+		const HumStrandTable& getStrandTable(void);
 		void  getMetricLevels             (std::vector<double>& output, int track = 0,
 		                                   double undefined = NAN);
 		// in HumdrumFileContent-timesig.cpp
@@ -2595,6 +3272,26 @@ class HumdrumFileContent : public HumdrumFileStructure {
 		bool   hasDifferentBarlines       (void);
 		bool   hasDataStraddle            (int line);
 
+		// in HumdrumFileContent-null.cpp
+		bool   analyzeNullResolution      (void);
+		HTp    getResolvedToken           (int line, int field);
+		bool   getResolvedPosition        (int line, int field, int& rline,
+		                                   int& rfield);
+		int    getAttackLine              (int line, int field);
+
+		// in HumdrumFileContent-sonority.cpp
+		bool   analyzeSonorities          (void);
+		const HumSonorityTable& getSonorities(void);
+		HumSonority getSonority           (int line);
+
+		// in HumdrumFileContent-measure.cpp
+		bool   analyzeMeasureIndex        (void);
+		int    getMeasureIndexCount       (void);
+		const HumMeasureInfo& getMeasureIndexEntry(int index);
+		int    getMeasureIndexForNumber   (int number);
+		int    getMeasureIndexForLine     (int line);
+		int    getBarNumberForLine        (int line);
+
 	protected:
 
 		bool   analyzeKernPhrasings       (HTp spinestart,
@@ -2610,6 +3307,34 @@ class HumdrumFileContent : public HumdrumFileStructure {
 		                                   const std::string& keysig);
 		void   resetDiatonicStatesWithKeySignature(std::vector<int>& states,
 				                             std::vector<int>& signature);
+		void   analyzeKernAccidentals     (std::vector<int>& rtracks, int kcount,
+		                                   int part);
+		void   setAccidentalState         (int tokenid, HTp token, int subtoken,
+		                                   int flags);
+		HumAnalysisTables& prepareAnalysisTables(void);
+		void   indexAnalysisTables        (void);
+		bool   startAnalysis              (HumFileAnalysis::Pass pass);
+		void   addNotesForMidi            (HTp token,
+		                                   std::vector<std::vector<std::pair<HTp, int>>>& trackInfo);
+
+		// Parallel spine analyses (defined in src/HumdrumFileContent.cpp):
+		typedef bool (HumdrumFileContent::*SpineSpanAnalysis)(HTp spinestart,
+		                                   std::vector<HTp>& linkstarts,
+		                                   std::vector<HTp>& linkends,
+		                                   std::vector<std::pair<HTp, HTp>>& labels,
+		                                   std::vector<int>& endings,
+		                                   const std::string& linksig);
+		bool   useAnalysisThreads         (int count) const;
+		void   runAnalysisThreads         (int count,
+		                                   const std::function<void(int)>& analysis);
+		bool   analyzeSpineSpans          (SpineSpanAnalysis analysis,
+		                                   HumSpanTable& table,
+		                                   std::vector<HTp>& spinestarts,
+		                                   std::vector<HTp>& linkstarts,
+		                                   std::vector<HTp>& linkends,
+		                                   std::vector<std::pair<HTp, HTp>>& labels,
+		                                   std::vector<int>& endings,
+		                                   const std::string& linksig);
 
 		bool   analyzeKernPhrasings       (void);
 
@@ -2654,6 +3379,7 @@ class HumdrumFileContent : public HumdrumFileStructure {
 		int     getRestPositionBelowNotes (HTp rest, std::vector<int>& vpos);
 		void    setRestOnCenterStaffLine  (HTp rest, int baseline);
 		bool    checkRestForVerticalPositioning(HTp rest, int baseline);
+		void    storeRestPosition         (HTp rest, int pc, int oct);
 
 		// Stem lengths:
 		bool    analyzeKernStemLengths    (HTp stok, HTp etok, std::vector<std::vector<int>>& centerlines);
@@ -2663,8 +3389,55 @@ class HumdrumFileContent : public HumdrumFileStructure {
 		void    prepareStaffBelowNoteStems (HTp token);
 
 		void    getBaselines              (std::vector<std::vector<int>>& centerlines);
+		static double getMetricLevel      (HumNum position, HumNum pulse,
+		                                   bool compound, int bottom);
+		int     getSyllableNotes          (HTp syllable, int endline, HTp& first,
+		                                   HTp& last, HumNum& endtime);
 		void    createLinkedTies          (std::vector<std::pair<HTp, int>>& starts,
 		                                   std::vector<std::pair<HTp, int>>& ends);
+
+		// Measure index:
+		void    storeMeasureState         (HumMeasureInfo& info,
+		                                   std::vector<std::vector<HTp>>& states);
+
+	protected:
+		// m_measureIndex: list of numbered measures in the file, created
+		// by analyzeMeasureIndex().
+		std::vector<HumMeasureInfo> m_measureIndex;
+
+		// m_measureLines: index into m_measureIndex for each line
+		// in the file (-1 for lines outside of measures).
+		std::vector<int> m_measureLines;
+
+		// m_barNumbers: prevailing bar number for each line in the file.
+		std::vector<int> m_barNumbers;
+
+		// m_measureNumbers: first entry in m_measureIndex for each
+		// measure number.
+		std::map<int, int> m_measureNumbers;
+
+		// m_metricGrid: metric positions of data lines, created by
+		// analyzeMetricGrid().
+		HumMetricTable m_metricGrid;
+
+		// m_textTable: syllables and words of the lyric spines, created by
+		// analyzeText().
+		HumTextTable m_textTable;
+
+		// m_strandTable: tokens of each strand, created by
+		// analyzeStrandTable().
+		HumStrandTable m_strandTable;
+
+		// m_analysisTables: typed results of content analyses, indexed
+		// by token id.
+		HumAnalysisTables m_analysisTables;
+
+		// m_analysisHashValues: also store analysis results as "auto"
+		// parameters in the HumHash of each token.
+		bool m_analysisHashValues = true;
+
+		// m_analysisThreads: number of threads for parallel spine analyses.
+		int m_analysisThreads = 1;
 };
 
 
@@ -4261,11 +5034,13 @@ class Convert {
 
 		// instrument related functions defined in Convert-instrument.cpp
 		static std::vector<std::pair<std::string, std::string>> getInstrumentList(void);
+		static std::string getInstrumentClass(const std::string& code);
 
 		// Reference record functions defined in Convert-reference.cpp
 		static std::string getReferenceKeyMeaning(HTp token);
 		static std::string getReferenceKeyMeaning(const std::string& token);
 		static std::string getLanguageName(const std::string& abbreviation);
+		static std::string getCurrentDate(const std::string& format = "%Y/%m/%d");
 };
 
 
@@ -4348,6 +5123,612 @@ std::ostream& operator<<(std::ostream& out, PixelColor apixel);
 
 
 
+class HumOutputSink : public std::streambuf {
+	public:
+		                HumOutputSink   (void);
+		virtual        ~HumOutputSink   ();
+
+		bool            write           (const char* data, size_t size);
+		bool            write           (const std::string& text);
+		bool            writeFile       (HumdrumFileBase& infile);
+		bool            flush           (void);
+
+		size_t          getByteCount    (void);
+		bool            isFailed        (void);
+
+	protected:
+		virtual bool    writeData       (const char* data, size_t size) = 0;
+		void            setUnbuffered   (void);
+
+		virtual int             overflow(int ch);
+		virtual std::streamsize xsputn  (const char* data, std::streamsize size);
+		virtual int             sync    (void);
+
+	private:
+		// m_buffer: small writes (such as single tokens) are collected
+		// here before being passed to writeData().  Writes larger than the
+		// buffer are passed on directly.
+		char m_buffer[8192];
+
+		// m_written: number of bytes passed on to writeData().
+		size_t m_written = 0;
+
+		// m_failed: true if writeData() could not store some data.
+		bool m_failed = false;
+};
+
+
+
+//////////////////////////////
+//
+// HumFdSink -- Write to a file descriptor, such as 1 for standard output
+//     or an open socket.
+//
+
+class HumFdSink : public HumOutputSink {
+	public:
+		                HumFdSink       (int fd);
+		               ~HumFdSink       ();
+
+	protected:
+		bool            writeData       (const char* data, size_t size);
+
+	private:
+		int m_fd;
+};
+
+
+
+//////////////////////////////
+//
+// HumBufferSink -- Write into a caller-supplied block of memory.  The text
+//     is stored directly in the block, and writing fails (isFailed()
+//     returns true) if the block is too small.
+//
+
+class HumBufferSink : public HumOutputSink {
+	public:
+		                HumBufferSink   (char* buffer, size_t capacity);
+		               ~HumBufferSink   ();
+
+		const char*     getData         (void);
+		size_t          getSize         (void);
+
+	protected:
+		bool            writeData       (const char* data, size_t size);
+		int             sync            (void);
+
+	private:
+		char* m_data;
+};
+
+
+
+//////////////////////////////
+//
+// HumStringSink -- Append to a caller-supplied string.
+//
+
+class HumStringSink : public HumOutputSink {
+	public:
+		                HumStringSink   (std::string& output);
+		               ~HumStringSink   ();
+
+	protected:
+		bool            writeData       (const char* data, size_t size);
+
+	private:
+		std::string& m_output;
+};
+
+
+
+//////////////////////////////
+//
+// HumStreamSink -- Write to an existing output stream, such as std::cout.
+//
+
+class HumStreamSink : public HumOutputSink {
+	public:
+		                HumStreamSink   (std::ostream& output);
+		               ~HumStreamSink   ();
+
+	protected:
+		bool            writeData       (const char* data, size_t size);
+
+	private:
+		std::ostream& m_output;
+};
+
+
+
+//////////////////////////////
+//
+// HumCallbackSink -- Pass blocks of text to a function.  The function
+//     returns false if it could not accept the data.
+//
+
+class HumCallbackSink : public HumOutputSink {
+	public:
+		typedef std::function<bool(const char* data, size_t size)> Callback;
+
+		                HumCallbackSink (const Callback& callback);
+		               ~HumCallbackSink ();
+
+	protected:
+		bool            writeData       (const char* data, size_t size);
+
+	private:
+		Callback m_callback;
+};
+
+
+
+// HumFeatureTable: columns of values for each row of a table.  Each column
+// is a fixed-width array (32-bit integers or 64-bit floats) that can be
+// passed directly to numerical code.  String columns store 32-bit indexes
+// into a dictionary of the distinct strings in the table (index 0 is the
+// empty string).  Missing values are MISSING_INT in integer columns and NAN
+// in float columns.
+//
+// The binary form written by write() contains a header, the string
+// dictionary and then each column as a contiguous array, with every block
+// aligned to 8 bytes, so that HumFeatureView can use the arrays in place
+// from a memory-mapped file.  Numbers are stored in the byte order of the
+// computer that wrote the file (checked when reading).
+//
+//    offset  size  contents
+//         0     8  "HUMFEAT1"
+//         8     4  0x01020304 (byte-order mark)
+//        12     4  column count
+//        16     4  string count
+//        20     4  (zero)
+//        24     8  row count
+//        32     8  byte size of the string text block
+//        40    48  for each column: name (32 bytes, null-terminated),
+//                  type (4 bytes), zero (4 bytes), offset of the column
+//                  data from the start of the file (8 bytes)
+//         .     .  string offsets (8 bytes each, string count + 1) into the
+//                  string text block, followed by the text block (each
+//                  string is null-terminated)
+//         .     .  column data
+//
+
+class HumFeatureTable {
+	public:
+		enum ColumnType {
+			TYPE_INT32   = 1,
+			TYPE_FLOAT64 = 2,
+			TYPE_STRING  = 3
+		};
+
+		static constexpr int32_t MISSING_INT = INT32_MIN;
+		static constexpr int     MAX_NAME_SIZE = 31;
+
+		                   HumFeatureTable     (void);
+		void               clear               (void);
+		void               clearRows           (void);
+
+		int                addColumn           (const std::string& name,
+		                                        ColumnType type);
+		int                getColumnCount      (void) const;
+		int                getColumnIndex      (const std::string& name) const;
+		const std::string& getColumnName       (int column) const;
+		ColumnType         getColumnType       (int column) const;
+		int64_t            getRowCount         (void) const;
+
+		void               addRow              (void);
+		void               setInt              (int column, int32_t value);
+		void               setFloat            (int column, double value);
+		void               setString           (int column, const std::string& value);
+		void               setStringIndex      (int column, int32_t index);
+
+		int32_t            getInt              (int64_t row, int column) const;
+		double             getFloat            (int64_t row, int column) const;
+		const std::string& getString           (int64_t row, int column) const;
+		const int32_t*     getIntColumn        (int column) const;
+		const double*      getFloatColumn      (int column) const;
+
+		int                addString           (const std::string& value);
+		int                getStringCount      (void) const;
+		const std::string& getDictionaryString (int index) const;
+
+		bool               append              (const HumFeatureTable& other);
+		bool               write               (std::ostream& out) const;
+		bool               writeFile           (const std::string& filename) const;
+		bool               read                (const char* data, size_t size);
+		bool               readFile            (const std::string& filename);
+		std::ostream&      printTsv            (std::ostream& out) const;
+
+	private:
+		struct Column {
+			std::string          name;
+			ColumnType           type = TYPE_INT32;
+			std::vector<int32_t> ints;     // for TYPE_INT32 and TYPE_STRING
+			std::vector<double>  floats;   // for TYPE_FLOAT64
+		};
+
+		std::vector<Column>        m_columns;
+		std::vector<std::string>   m_strings;
+		std::map<std::string, int> m_stringIds;
+		int64_t                    m_rows = 0;
+};
+
+
+
+// HumFeatureView: read-only access to a table written by
+// HumFeatureTable::write(), without copying the data.  The memory must
+// stay valid (and mapped) while the view is used, and should be aligned
+// to 8 bytes (as memory from mmap() or new is).
+
+class HumFeatureView {
+	public:
+		                HumFeatureView      (void);
+		bool            open                (const char* data, size_t size);
+		void            close               (void);
+		bool            isOpen              (void) const;
+
+		int             getColumnCount      (void) const;
+		int             getColumnIndex      (const std::string& name) const;
+		const char*     getColumnName       (int column) const;
+		HumFeatureTable::ColumnType getColumnType (int column) const;
+		int64_t         getRowCount         (void) const;
+
+		const int32_t*  getIntColumn        (int column) const;
+		const double*   getFloatColumn      (int column) const;
+		int             getStringCount      (void) const;
+		const char*     getDictionaryString (int index) const;
+		const char*     getString           (int64_t row, int column) const;
+
+	protected:
+		const char*     getColumnData       (int column) const;
+
+	private:
+		const char*     m_data        = NULL;
+		size_t          m_size        = 0;
+		int             m_columnCount = 0;
+		int             m_stringCount = 0;
+		int64_t         m_rows        = 0;
+		const uint64_t* m_stringOffsets = NULL;
+		const char*     m_stringText  = NULL;
+};
+
+
+
+// HumFeatureExtractor: add a row to a feature table for each note attack
+// in the **kern spines of a file (each note of a chord is a separate row;
+// secondary tied notes are not included, and the duration of a note is
+// its tied duration).  All selected features are extracted in a single
+// pass through the file.  An extractor is not modified by extract(), so
+// one extractor can be used by many threads, each with its own table.
+
+class HumFeatureExtractor {
+	public:
+		enum Feature {
+			FEATURE_FILE,       // filename
+			FEATURE_LINE,       // line index of note
+			FEATURE_FIELD,      // field index of note
+			FEATURE_SUBTOKEN,   // index of note in chord
+			FEATURE_TRACK,      // track (spine) number
+			FEATURE_LAYER,      // subtrack number (0 if spine is not split)
+			FEATURE_MEASURE,    // measure number
+			FEATURE_ONSET,      // quarter notes from start of score
+			FEATURE_DURATION,   // tied duration in quarter notes
+			FEATURE_METPOS,     // quarter notes from start of measure
+			FEATURE_BEAT,       // beat in measure (from 1)
+			FEATURE_METLEV,     // metric level (from getMetricLevels())
+			FEATURE_KERN,       // **kern text of note
+			FEATURE_BASE40,     // base-40 pitch
+			FEATURE_MIDI,       // MIDI key number
+			FEATURE_INTERVAL,   // semitones from previous note in layer
+			FEATURE_INTERVAL40, // base-40 interval from previous note in layer
+			FEATURE_TIE,        // 1 if note is tied to following notes
+			FEATURE_CHORD,      // number of notes in the chord
+			FEATURE_LYRIC,      // syllable in first **text spine for note
+			FEATURE_COUNT
+		};
+
+		                   HumFeatureExtractor (void);
+		bool               setFeatures         (const std::string& list);
+		void               setFeature          (Feature feature, bool state);
+		bool               isFeature           (Feature feature) const;
+		static const char* getFeatureName      (Feature feature);
+		static std::ostream& printFeatureList  (std::ostream& out);
+
+		void               prepareTable        (HumFeatureTable& table) const;
+		void               extract             (HumdrumFile& infile,
+		                                        HumFeatureTable& table,
+		                                        const std::string& filename = "") const;
+
+	protected:
+		std::string        getLyric            (HTp token) const;
+		HumNum             getTiedDuration     (HTp token, int base40) const;
+
+	private:
+		std::vector<bool>  m_features;
+};
+
+
+
+// HumTextPosting: one occurrence of a word in a HumTextIndex.
+
+class HumTextPosting {
+	public:
+		int file     = 0;  // index of the file in the text index
+		int line     = 0;  // line index of the first syllable of the word
+		int field    = 0;  // field index of the first syllable of the word
+		int track    = 0;  // track of the lyric spine
+		int spine    = 0;  // lyric spine in the file (see HumTextTable)
+		int position = 0;  // position of the word in the spine
+		int notes    = 0;  // number of notes attacked on the word
+};
+
+
+// HumTextIndex: an inverted index of the words in the lyrics of a corpus of
+// files, so that text queries do not need to parse the files again.  Words
+// are taken from the text table of each file (see HumTextTable) and indexed
+// by their normalized form.  A word containing spaces is indexed under
+// each part, with consecutive positions, so that phrases can be found by
+// searching for consecutive positions in a spine.  Indexes of parts of a
+// corpus can be built separately (such as on different threads) and joined
+// in order with append().  The text form of an index (write() and read()):
+//
+//    !!!HUMTEXTINDEX: 1
+//    @file <TAB> filename                   (one line for each file)
+//    word <TAB> posting <TAB> posting ...   (one line for each word)
+//
+// where each posting is "file:line:field:track:spine:position:notes"
+// (indexes from 0).
+
+class HumTextIndex {
+	public:
+		                   HumTextIndex  (void);
+		void               clear         (void);
+		int                addFile       (HumdrumFile& infile,
+		                                  const std::string& filename);
+		void               append        (const HumTextIndex& index);
+
+		int                getFileCount  (void) const;
+		const std::string& getFilename   (int file) const;
+		int                getWordCount  (void) const;
+		void               getWordList   (std::vector<std::string>& words) const;
+		const std::vector<HumTextPosting>* find(const std::string& word) const;
+		int                search        (std::vector<HumTextPosting>& matches,
+		                                  const std::string& query,
+		                                  bool prefix = false) const;
+
+		bool               write         (std::ostream& out) const;
+		bool               writeFile     (const std::string& filename) const;
+		bool               read          (std::istream& in);
+		bool               readFile      (const std::string& filename);
+
+	protected:
+		void               getPostings   (std::vector<HumTextPosting>& postings,
+		                                  const std::string& word,
+		                                  bool prefix) const;
+		static bool        isBefore      (const HumTextPosting& a,
+		                                  const HumTextPosting& b);
+
+	private:
+		std::vector<std::string> m_files;
+		std::map<std::string, std::vector<HumTextPosting>> m_words;
+};
+
+
+
+// HumJsonWriter: write the structure of a Humdrum file (lines, tokens,
+// tracks, subtracks and spine links) together with the results of content
+// analyses, so that other programs do not need to parse the Humdrum data
+// again.  The output is written directly to the output stream while the
+// file is traversed, without building a document in memory.  The format
+// is JSON or CBOR (RFC 8949, using indefinite-length arrays and maps);
+// both formats have the same structure:
+//
+//    { "format": "humdrum", "version": 1,
+//      "lineCount": 12, "trackCount": 2, "tpq": 2, "duration": [4, 1],
+//      "tracks": [ { "track": 1, "dataType": "**kern", "start": [0, 0] },
+//                  ... ],
+//      "lines": [ { "line": 0, "type": "exclusive",
+//                   "durationFromStart": [0, 1], "duration": [0, 1],
+//                   "tokens": [ { "id": "loc0_0", "text": "**kern",
+//                                 "type": "interpretation", "track": 1,
+//                                 "subtrack": 0, "spine": "1",
+//                                 "next": [[1, 0]], "prev": [] }, ... ] },
+//                 ... ] }
+//
+// Durations are [numerator, denominator] pairs in quarter notes, and
+// references to other tokens are [line, field] pairs.  The sections that
+// are written can be limited with setSections(); the analysis needed by a
+// section is run before writing if it has not been done already.  Ties,
+// slurs, phrases, beams, accidentals and rest positions are taken from the
+// analysis tables of the file (see HumAnalysisTables.h):
+//
+//    "slurs": [ { "number": 1, "end": [8, 0], "duration": [3, 2] } ],
+//    "slurHanging": 1,           (+1 for an unmatched start, -1 for an end)
+//    "ties": [ ... ], "phrases": [ ... ], "phraseHanging": 1,
+//    "beams": [ ... ], "beamHanging": -1,
+//    "accidentals": [1, 0, 3],   (HumAnalysisTables::ACCID_* flags for
+//                                 each note of a chord)
+//    "restPosition": [4, 4],     (diatonic pitch class and octave)
+//
+// Other analyses (such as stem lengths) and layout parameters are written
+// as the "parameters" of a token: [namespace1, namespace2, key, value]
+// lists, where token values are given as [line, field] pairs, and the
+// token that a layout parameter came from is added as a fifth element.
+// The "auto" parameters which copy results in the analysis tables are not
+// written.
+
+class HumJsonWriter {
+	public:
+		enum Format {
+			FORMAT_JSON,
+			FORMAT_CBOR
+		};
+
+		enum Section {
+			SECTION_LINKS       = 0x001,  // next/previous tokens in spines
+			SECTION_RHYTHM      = 0x002,  // durations of lines and tokens
+			SECTION_NULLS       = 0x004,  // resolution of null tokens
+			SECTION_TIES        = 0x008,  // tie links
+			SECTION_SLURS       = 0x010,  // slur links
+			SECTION_PHRASES     = 0x020,  // phrase links
+			SECTION_BEAMS       = 0x040,  // beam links
+			SECTION_ACCIDENTALS = 0x080,  // displayed accidentals
+			SECTION_RESTS       = 0x100,  // vertical positions of rests
+			SECTION_PARAMETERS  = 0x200,  // layout parameters and linked tokens
+			SECTION_AUTO        = 0x400,  // other "auto" parameters
+			SECTION_ALL         = 0x7ff
+		};
+
+		              HumJsonWriter       (void);
+
+		void          setFormat           (Format format);
+		Format        getFormat           (void) const;
+		void          setSections         (int sections);
+		bool          setSections         (const std::string& names);
+		int           getSections         (void) const;
+		static std::string getSectionNames(void);
+
+		bool          write               (std::ostream& out, HumdrumFile& infile);
+
+	protected:
+		void          writeHeader         (HumdrumFile& infile);
+		void          writeLine           (HumdrumLine& line);
+		void          writeToken          (HTp token);
+		void          writeTokenLinks     (HTp token);
+		void          writeSpans          (const char* key, const char* hangingkey,
+		                                   HumSpanTable& spans, int id, HTp token);
+		void          writeAnalyses       (HTp token);
+		void          writeParameters     (HTp token);
+		int           getParameterSection (const std::string& ns1,
+		                                   const std::string& ns2,
+		                                   const std::string& key) const;
+		static const char* getLineType    (HumdrumLine& line);
+		static const char* getTokenType   (HTp token);
+
+		// Low-level output shared by the JSON and CBOR formats:
+		void          beginObject         (void);
+		void          endObject           (void);
+		void          beginArray          (void);
+		void          endArray            (void);
+		void          writeKey            (const char* key);
+		void          writeString         (const char* text, size_t size);
+		void          writeString         (const std::string& text);
+		void          writeString         (const char* text);
+		void          writeInteger        (long long value);
+		void          writeRational       (HumNum value);
+		void          writeReference      (HTp token);
+		void          writeNull           (void);
+		void          writeNewline        (void);
+		void          writeSeparator      (void);
+		void          writeCborHead       (int major, unsigned long long value);
+		void          put                 (char ch);
+		void          put                 (const char* data, size_t size);
+
+	private:
+		Format m_format = FORMAT_JSON;
+		int    m_sections = SECTION_ALL;
+
+		// m_tables: analysis tables of the file being written.
+		HumAnalysisTables* m_tables = NULL;
+
+		// m_out: output buffer of the stream being written to.
+		std::streambuf* m_out = NULL;
+
+		// m_failed: true if the stream could not accept some output.
+		bool   m_failed = false;
+
+		// m_first: for each open JSON array or object, true if no value has
+		// been written into it yet (so that no comma is needed).
+		std::vector<char> m_first;
+
+		// m_afterKey: true if a JSON key has been written, so that the next
+		// value does not need a comma.
+		bool   m_afterKey = false;
+
+		// m_newline: true if the next JSON value should start on a new line.
+		bool   m_newline = false;
+};
+
+
+
+class HumToolRequest {
+	public:
+		std::string id;      // identifier copied into the response
+		std::string tool;    // tool name, such as "transpose"
+		std::string options; // command-line options for the tool
+		std::string input;   // Humdrum data to process
+};
+
+
+class HumToolResponse {
+	public:
+		std::string id;
+		bool        status = true;  // false if the request failed
+		std::string humdrum;        // output data in Humdrum syntax
+		std::string json;           // output data in JSON syntax
+		std::string text;           // free-text output
+		std::string warning;
+		std::string error;
+};
+
+
+class HumToolServer {
+	public:
+		                  HumToolServer   (void);
+		                  HumToolServer   (int threads);
+		                 ~HumToolServer   ();
+
+		void              setThreadCount  (int threads);
+		int               getThreadCount  (void);
+		void              setQueueSize    (int size);
+		int               getQueueSize    (void);
+
+		bool              serve           (std::istream& input,
+		                                   std::ostream& output);
+		bool              run             (const HumToolRequest& request,
+		                                   HumToolResponse& response);
+
+		static bool       hasTool         (const std::string& name);
+		static std::vector<std::string> getToolNames(void);
+
+		static int        readRequest     (std::istream& input,
+		                                   HumToolRequest& request,
+		                                   std::string& error);
+		static std::ostream& writeRequest (std::ostream& output,
+		                                   const HumToolRequest& request);
+		static int        readResponse    (std::istream& input,
+		                                   HumToolResponse& response,
+		                                   std::string& error);
+		static std::ostream& writeResponse(std::ostream& output,
+		                                   const HumToolResponse& response);
+
+	protected:
+		void              startWorkers    (void);
+		void              stopWorkers     (void);
+		void              workerLoop      (void);
+		void              addJob          (std::function<void(void)> job);
+
+	private:
+		// m_threadCount: number of worker threads (0 = number of cores).
+		int m_threadCount = 0;
+
+		// m_workers: threads that process the requests in m_jobs.
+		std::vector<std::thread> m_workers;
+
+		// m_queueSize: maximum number of jobs waiting for a worker thread
+		// (0 = four jobs for each worker thread).
+		int m_queueSize = 0;
+
+		std::deque<std::function<void(void)>> m_jobs;
+		std::mutex              m_jobMutex;
+		std::condition_variable m_jobSignal;
+		std::condition_variable m_queueSignal;
+		bool                    m_stopQ = false;
+};
+
+
+
 // SliceType is a list of various Humdrum line types.  Groupings are
 // segmented by categories which are prefixed with an underscore.
 // For example Notes are in the _Duration group, since they have
@@ -5057,7 +6438,7 @@ class MxmlEvent {
 		std::vector<MxmlEvent*> m_links;   // list of secondary chord notes
 		bool               m_linked;       // true if a secondary chord note
 		int                m_sequence;     // ordering of event in XML file
-		static int         m_counter;      // counter for sequence variable
+		static std::atomic<int> m_counter; // counter for sequence variable
 		short              m_staff;        // staff number in part for event
 		short              m_voice;        // voice number in part for event
 		int                m_voiceindex;   // voice index of item (remapping)
@@ -5284,6 +6665,7 @@ class Options {
 		                                   int suppress = 0);
 		void            xverify           (int error_check = 1,
 		                                   int suppress = 0);
+		void            setExitOnError    (bool state);
 		void            setFlag           (char aFlag);
 		void            setModified       (const std::string& optionName,
 		                                   const std::string& optionValue);
@@ -5338,6 +6720,12 @@ class Options {
 		// m_optionsArgument: indicate that --options was used.
 		bool m_optionsArgQ = false;
 
+		// m_exitQ: true means to exit the program when an unknown option
+		// is given (or to print the option list when --options is given).
+		// Set to false for programs which process more than one command,
+		// such as the humserver tool server.
+		bool m_exitQ = true;
+
 		// m_error: used to store errors in parsing command-line options.
 		std::stringstream m_error;
 
@@ -5391,6 +6779,12 @@ class HumTool : public Options {
 		std::ostream& getError        (std::ostream& out);
 		void          setError        (const std::string& message);
 
+		void          setOutputSink   (HumOutputSink* sink);
+		void          setHumdrumSink  (HumOutputSink* sink);
+		void          setJsonSink     (HumOutputSink* sink);
+		void          setFreeTextSink (HumOutputSink* sink);
+		void          clearOutputSinks(void);
+
 		virtual void  finally         (void) { };
 
 	protected:
@@ -5402,6 +6796,28 @@ class HumTool : public Options {
 
 		bool m_suppress = false;
 
+	private:
+		static bool   hasStreamText   (std::stringstream& stream);
+		static void   printStreamText (std::ostream& out,
+		                               std::stringstream& stream);
+		static void   attachSink      (std::stringstream& stream,
+		                               HumOutputSink* sink,
+		                               HumOutputSink*& current,
+		                               size_t& start);
+		static bool   hasSinkText     (HumOutputSink* sink, size_t start);
+
+		// Sinks which receive the Humdrum, JSON and free text output
+		// instead of the stringstreams above (NULL if not used).  The
+		// byte count of each sink when it was attached (or when
+		// clearOutput() was last called) is used to check whether the
+		// tool has written anything to it.
+		HumOutputSink* m_humdrum_sink = NULL;
+		HumOutputSink* m_json_sink    = NULL;
+		HumOutputSink* m_free_sink    = NULL;
+		size_t m_humdrum_sink_start   = 0;
+		size_t m_json_sink_start      = 0;
+		size_t m_free_sink_start      = 0;
+
 };
 
 
@@ -5706,7 +7122,6 @@ class Tool_addic : public HumTool {
 		void     processFile       (HumdrumFile& infile);
 
 	private:
-		std::vector<std::pair<std::string, std::string>> m_instrumentList;
 		bool m_fixQ = false;  // used with -f option: fix incorrect instrument classes
 
 
@@ -6104,6 +7519,40 @@ class Tool_autostem : public HumTool {
 };
 
 
+// PackedRoll: a piano roll stored as two bits for each key in each time
+// step (attack and sustain).  Only a window of time steps is stored:
+// removeSteps() discards the steps which have already been printed, so
+// the roll does not have to be kept in memory for the entire score.
+
+class PackedRoll {
+	public:
+		            PackedRoll      (void);
+		void        setKeyRange     (int low, int high);
+		int         getLowKey       (void) const { return m_low; }
+		int         getKeyCount     (void) const { return m_count; }
+		void        clear           (void);
+
+		void        addNote         (int key, int64_t start, int64_t end);
+		int         getValue        (int64_t step, int key) const;
+		void        writeStep       (std::ostream& out, int64_t step) const;
+		void        removeSteps     (int64_t end);
+
+	protected:
+		void        extend          (int64_t end);
+		uint64_t*   getStep         (int64_t step);
+		const uint64_t* getStep     (int64_t step) const;
+
+	private:
+		int                   m_low   = 0;   // lowest key in roll
+		int                   m_count = 128; // number of keys in roll
+		int                   m_words = 2;   // 64-bit words in a bit plane
+		int64_t               m_first = 0;   // time step of m_bits[0]
+		std::vector<uint64_t> m_bits;        // attack plane then sustain
+		                                     // plane for each time step
+};
+
+
+
 class Tool_binroll : public HumTool {
 	public:
 		         Tool_binroll      (void);
@@ -6115,14 +7564,21 @@ class Tool_binroll : public HumTool {
 		bool     run               (HumdrumFile& infile, std::ostream& out);
 
 	protected:
+		bool     initialize        (void);
 		void     processFile       (HumdrumFile& infile);
-		void     processStrand     (std::vector<std::vector<char>>& roll, HTp starting,
-		                            HTp ending);
-		void     printAnalysis     (HumdrumFile& infile,
-		                            std::vector<std::vector<char>>& roll);
+		void     processLine       (HumdrumLine& line);
+		void     printHeader       (HumdrumFile& infile, int count);
+		void     printTrailer      (HumdrumFile& infile);
+		void     printSteps        (int end);
+		void     printComment      (HumdrumLine& line);
+		void     writeInt          (uint64_t value, int bytes);
 
 	private:
-		HumNum    m_duration;
+		HumNum     m_duration;       // duration of a time step
+		PackedRoll m_roll;           // time steps which are not yet printed
+		int        m_printed = 0;    // next time step to print
+		bool       m_binaryQ = false;
+		bool       m_streamQ = false;
 
 };
 
@@ -6339,7 +7795,7 @@ class Tool_cint : public HumTool {
 
 	protected:
 
-		void      initialize           (void);
+		bool      initialize           (void);
 		void      example              (void);
 		void      usage                (const std::string& command);
 		int       processFile          (HumdrumFile& infile);
@@ -6502,7 +7958,8 @@ class cmr_note_info {
 		std::string   getPitch         (void);
 		HTp      getToken         (void);
 		int      getLineIndex     (void);
-		double   getNoteStrength  (void);
+		double   getNoteStrength  (double syncopationWeight = 1.0,
+		                           double leapWeight = 0.5);
 		bool     hasSyncopation   (void);
 		bool     hasLeapBefore    (void);
 		void     markNote         (const std::string& marker);
@@ -6512,9 +7969,6 @@ class cmr_note_info {
 		static bool   isSyncopated(HTp token);
 		static bool   isLeapBefore(HTp token);
 
-		static double m_syncopationWeight;
-		static double m_leapWeight;
-
 	private:
 		std::vector<HTp> m_tokens;    // List of tokens for the notes (first entry is note attack);
 
@@ -6568,7 +8022,8 @@ class cmr_group_info {
 		HumNum  getEndTime         (void);
 		HumNum  getGroupDuration   (void);
 		HumNum  getStartTime       (void);
-		double  getGroupStrength   (void);
+		double  getGroupStrength   (double syncopationWeight = 1.0,
+		                            double leapWeight = 0.5);
 		bool    mergeGroup         (cmr_group_info& group);
 		std::ostream& printNotes   (std::ostream& output = std::cout, const std::string& marker = "");
 
@@ -6642,9 +8097,13 @@ class Tool_cmr : public HumTool {
 		void             getPartNames            (std::vector<std::string>& partNames, HumdrumFile& infile);
 		void             checkForCmr             (int index, int direction, HumdrumFile& infile);
 		bool             hasHigher               (int pitch, int tolerance,
-		                                          std::vector<int>& midinums,
-		                                          std::vector<std::vector<HTp>>& notelist,
 		                                          int index1, int index2);
+		void             prepareRangeTables      (void);
+		void             buildRangeMaxTable      (std::vector<std::vector<int>>& table,
+		                                          std::vector<int>& values);
+		int              getRangeMax             (std::vector<std::vector<int>>& table,
+		                                          int index1, int index2);
+		void             updatePositiveLines     (cmr_group_info& group, int change);
 		bool             hasGroupUp              (void);
 		bool             hasGroupDown            (void);
 		void             getVocalRange           (std::vector<std::string>& minpitch,
@@ -6722,12 +8181,24 @@ class Tool_cmr : public HumTool {
 		// m_halfQ == report durations in half note (minims).
 		bool m_halfQ = false;
 
+		// m_syncopationWeight == strength added to syncopated notes.
+		double m_syncopationWeight = 1.0;
+
+		// m_leapWeight == strength added to notes preceded by a leap.
+		double m_leapWeight = 0.5;
+
 		// variables for doing CMR analysis (reset for each part)
 		std::vector<int>         m_midinums;      // MIDI note for first entry for teach tied group
 		std::vector<bool>        m_localpeaks;    // True if higher (or lower for negative search) than adjacent notes.
 		std::vector<double>      m_metlevs;       // True if higher (or lower for negative search) than adjacent notes.
 		std::vector<bool>        m_syncopation;   // True if note is syncopated.
 		std::vector<bool>        m_leapbefore;    // True if note has a leap before it.
+		std::vector<HumNum>      m_starttimes;    // Start time of each note in quarter notes.
+		std::vector<std::vector<int>> m_maxPitchTable;       // Range maximum table for m_midinums.
+		std::vector<std::vector<int>> m_maxStrongPitchTable; // Range maximum table for notes on strong beats.
+
+		// m_positiveLines == number of notes in positive CMR groups on each line.
+		std::vector<int>         m_positiveLines;
 
 		// Summary statistics variables:
 		std::vector<int>         m_cmrCount;       // number of CMRs in each input file
@@ -7169,10 +8640,10 @@ class Tool_deg : public HumTool {
 				int             getSubtokenCount         (void) const;
 
 				// output options:
-				static void     setShowTies    (bool state) { m_showTiesQ = state;  }
-				static void     setShowZeros   (bool state) { m_showZerosQ = state; }
-				static void     setShowOctaves (bool state) { m_octaveQ = state; }
-				static void     setForcedKey   (const std::string& key) { m_forcedKey = key; }
+				void            setShowTies    (bool state) { m_showTiesQ = state;  }
+				void            setShowZeros   (bool state) { m_showZerosQ = state; }
+				void            setShowOctaves (bool state) { m_octaveQ = state; }
+				void            setForcedKey   (const std::string& key) { m_forcedKeyQ = !key.empty(); }
 
 			protected:  // ScaleDegree class
 				std::string     generateDegDataToken     (void) const;
@@ -7249,11 +8720,11 @@ class Tool_deg : public HumTool {
 				ScaleDegree* m_prevRest = NULL;
 				ScaleDegree* m_nextRest = NULL;
 
-				// ScaleDegree rendering options:
-				static bool m_showTiesQ;
-				static bool m_showZerosQ;
-				static bool m_octaveQ;
-				static std::string m_forcedKey;
+				// ScaleDegree rendering options (set by Tool_deg::prepareDegSpine):
+				bool m_showTiesQ  = false;
+				bool m_showZerosQ = false;
+				bool m_octaveQ    = false;
+				bool m_forcedKeyQ = false;
 		};
 
 
@@ -7350,6 +8821,8 @@ class Tool_deg : public HumTool {
 		bool m_recipQ          = false;   // used with -r option
 		bool m_kernQ           = false;   // used with --kern option
 		bool m_degTiesQ        = false;   // used with -t option
+		bool m_degZerosQ       = false;   // used with -z option
+		bool m_degOctaveQ      = false;   // used with -o option
 		bool m_forceKeyQ       = false;   // used with -K option
 
 		std::string m_defaultKey  = "";    // used with --default-key option
@@ -7467,6 +8940,15 @@ class Tool_dissonant : public HumTool {
 		void    addSuspensionMarkToNote(HTp start, const string& marks);
 		void    adjustSuspensionColors(HTp speinstart);
 
+		bool    runStatistics        (HumdrumFileSet& infiles);
+		void    prepareStatisticsLabels(void);
+		void    getStatistics        (HumdrumFile& infile, vector<int>& counts,
+		                              int& voices);
+		void    printStatisticsHeader(ostream& out);
+		void    printStatisticsLine  (ostream& out, const string& filename,
+		                              vector<int>& counts, int voices);
+		void    printStatisticsFooter(ostream& out);
+
 	private:
 		vector<HTp> m_kernspines;
 		bool diss2Q = false;
@@ -7482,6 +8964,11 @@ class Tool_dissonant : public HumTool {
 
 		vector<string> m_labels;
 
+		// --statistics columns:
+		vector<string>   m_statLabels; // unique dissonance labels
+		vector<bool>     m_statAgents; // true if column is for a suspension agent
+		map<string, int> m_statIndex;  // label to column index
+
 		// unaccdented non-harmonic tones:
 		const int PASSING_UP           =  0; // rising passing tone
 		const int PASSING_DOWN         =  1; // downward passing tone
@@ -7866,6 +9353,7 @@ class Tool_extract : public HumTool {
 		bool     run                    (HumdrumFile& infile);
 		bool     run                    (const std::string& indata, std::ostream& out);
 		bool     run                    (HumdrumFile& infile, std::ostream& out);
+		bool     run                    (std::istream& input, std::ostream& out);
 
 	protected:
 
@@ -7941,6 +9429,19 @@ class Tool_extract : public HumTool {
 		                                 std::vector<int>& model, const std::string& searchstring,
 		                                 HumdrumFile& infile, int state);
 		void printInterpretationForKernSpine(HumdrumFile& infile, int index);
+		void    printManipulatorLine    (std::vector<std::string>& tempout,
+		                                 std::vector<int>& vserial,
+		                                 std::vector<int>& xserial);
+
+		// streaming functions (--stream option):
+		bool    processStreamLine       (const std::string& line,
+		                                 std::vector<std::string>& tokens);
+		bool    prepareStreamSegment    (const std::string& exinterps, int count);
+		void    printStreamFields       (std::vector<std::string>& tokens);
+		void    printStreamExcludedFields(std::vector<std::string>& tokens);
+		void    printStreamManipulatorFields(std::vector<std::string>& tokens);
+		void    updateStreamTracks      (std::vector<std::string>& tokens);
+		void    flushStreamOutput       (std::ostream& out);
 
 	private:
 
@@ -7983,6 +9484,9 @@ class Tool_extract : public HumTool {
 		bool        emptyQ      = false;     // used with --empty option
 		bool        spineListQ  = false;     // used with --spine option
 		bool        removerestQ = false;     // used with --no-rest option
+		std::vector<int> m_streamTracks;     // used with --stream option
+		int         m_streamMaxTrack = 0;    // used with --stream option
+		std::vector<std::string> m_streamInterps; // used with --stream option
 
 };
 
@@ -8490,6 +9994,31 @@ class NotePoint {
 };
 
 
+// SliceSequence: the time points of a file, with an id for the note content
+// of each time point (its position in the measure, and the pitch and
+// duration of each note attacked there) and for each measure (the list of
+// its time point ids).  Equal ids mean equal content, so files can be
+// aligned by comparing ids.
+class SliceSequence {
+	public:
+		HumdrumFile*            file = NULL;
+		std::vector<TimePoint>  timepoints;
+		std::vector<int>        sliceids;      // content id of each time point
+		std::vector<int>        measureids;    // content id of each measure
+		std::vector<int>        measurestarts; // first time point of each measure
+		std::vector<HumNum>     measuretimes;  // start time of each measure
+
+		void clear(void) {
+			file = NULL;
+			timepoints.clear();
+			sliceids.clear();
+			measureids.clear();
+			measurestarts.clear();
+			measuretimes.clear();
+		}
+};
+
+
 // Function declarations:
 
 class Tool_humdiff : public HumTool {
@@ -8510,9 +10039,30 @@ class Tool_humdiff : public HumTool {
 		void     printNotePoints    (std::vector<NotePoint>& notelist);
 		void     markNote           (NotePoint& np);
 
+		// Alignment of files with inserted or deleted material (-a):
+		void     extractSlices      (SliceSequence& slices, HumdrumFile& infile);
+		int      getContentId       (std::map<std::vector<int>, int>& ids,
+		                             const std::vector<int>& content);
+		void     alignFiles         (SliceSequence& reference, SliceSequence& alternate);
+		void     compareRegion      (SliceSequence& reference, int r1, int r2,
+		                             HumNum rbase, SliceSequence& alternate,
+		                             int a1, int a2, HumNum abase);
+		void     compareRun         (SliceSequence& reference, int r1, int r2,
+		                             HumNum rbase, SliceSequence& alternate,
+		                             int a1, int a2, HumNum abase);
+		bool     diffSequences      (std::vector<std::pair<int, int>>& matches,
+		                             const std::vector<int>& a, int a1, int a2,
+		                             const std::vector<int>& b, int b1, int b2);
+
 	private:
 		int m_marked = 0;
 
+		// m_sliceIds: content ids of time points for alignment.
+		std::map<std::vector<int>, int> m_sliceIds;
+
+		// m_measureIds: content ids of measures for alignment.
+		std::map<std::vector<int>, int> m_measureIds;
+
 
 };
 
@@ -8631,6 +10181,29 @@ class Tool_humtr : public HumTool {
 };
 
 
+//////////////////////////////
+//
+// ImitationSequenceIndex -- Suffix array of the interval sequences of all
+//    voices, used to find the number of matching intervals starting at
+//    any two notes in constant time (the longest common prefix of two
+//    suffixes, from a range-minimum table of the prefix lengths of
+//    neighboring suffixes).
+//
+
+class ImitationSequenceIndex {
+	public:
+		void     build             (vector<vector<int>>& sequences);
+		int      getMatchLength    (int seq1, int index1, int seq2,
+		                            int index2) const;
+
+	private:
+		vector<int>         m_offsets;   // start of each sequence in text
+		vector<int>         m_rank;      // suffix array index of each position
+		vector<vector<int>> m_minimums;  // sparse table of prefix lengths
+};
+
+
+
 class Tool_imitation : public HumTool {
 	public:
 		         Tool_imitation    (void);
@@ -8652,9 +10225,13 @@ class Tool_imitation : public HumTool {
 		                            int v1, int v2);
 		void    getIntervals       (vector<double>& intervals,
 		                            vector<NoteCell*>& attacks);
+		void    buildSequenceIndex (vector<vector<NoteCell*>>& attacks,
+		                            vector<vector<double>>& intervals);
+		int     getSymbol          (std::map<std::tuple<bool, double, int, int>, int>& symbols,
+		                            double interval, HumNum duration);
 		int     compareSequences   (vector<NoteCell*>& attack1, vector<double>& seq1,
 		                            int i1, vector<NoteCell*>& attack2,
-		                            vector<double>& seq2, int i2);
+		                            vector<double>& seq2, int i2, int length);
 		int     checkForIntervalSequence(vector<int>& m_intervals,
 		                            vector<double>& v1i, int starti, int count);
 		void    markedTiedNotes    (vector<HTp>& tokens);
@@ -8671,7 +10248,7 @@ class Tool_imitation : public HumTool {
 		bool m_mark;
 		char m_marker = '@';
 		bool m_single = false;
-		static int Enumerator;
+		int m_enumerator = 0;  // number of the current imitation match
 		bool m_first = false;
 		bool m_nozero = false;
 		bool m_onlyzero = false;
@@ -8696,6 +10273,11 @@ class Tool_imitation : public HumTool {
 		bool m_retrograde = false;
 
 		vector<int> m_barlines;
+
+		// m_sequences: symbol for each interval (and duration) of each
+		// voice, followed by the inverted sequences for inversion searches.
+		vector<vector<int>> m_sequences;
+		ImitationSequenceIndex m_sequenceIndex;
 };
 
 
@@ -9145,8 +10727,9 @@ class Tool_melisma : public HumTool {
 		void   initialize              (HumdrumFile& infile);
 		void   processFile             (HumdrumFile& infile);
 		void   getNoteCounts           (HumdrumFile& infile, std::vector<std::vector<int>>& counts);
-		void   getNoteCountsForLyric   (std::vector<std::vector<int>>& counts, HTp lyricStart);
-		int    getCountForSyllable     (HTp token);
+		void   getNoteCountsForLyric   (std::vector<std::vector<int>>& counts,
+		                                const HumTextTable& table, int spine);
+		int    getCountForSyllable     (const HumTextTable& table, int syllable);
 		void   replaceLyrics           (HumdrumFile& infile, std::vector<std::vector<int>>& counts);
 		void   markMelismas            (HumdrumFile& infile, std::vector<std::vector<int>>& counts);
 		void   markMelismaNotes        (HTp text, int count);
@@ -9219,9 +10802,7 @@ class Tool_meter : public HumTool {
 		void     processFile       (HumdrumFile& infile);
 		void     getMeterData      (HumdrumFile& infile);
 		void     processLine       (HumdrumLine& line,
-		                            std::vector<HumNum>& curNum,
-		                            std::vector<HumNum>& curDen,
-		                            std::vector<HumNum>& curBeat,
+		                            const HumMetricTable& grid,
 		                            std::vector<HumNum>& curBarTime);
 		void     printMeterData    (HumdrumFile& infile);
 		void     printHumdrumLine  (HumdrumLine& line, bool printLabels);
@@ -9412,6 +10993,18 @@ class SonorityNoteData {
 			m_base40 = Convert::kernToBase40(m_tok);
 		}
 
+		void setNote(HTp token, int index, int base40, bool attackQ) {
+			// Note data from the sonority table of the file (the note
+			// string is not extracted from the token).
+			m_token   = token;
+			m_index   = index;
+			m_tok.clear();
+			m_attackQ = attackQ;
+			m_base7   = Convert::base40ToDiatonic(base40);
+			m_base12  = Convert::base40ToMidiNoteNumber(base40) - 12;
+			m_base40  = base40;
+		}
+
 		void setString(std::string tok) {
 			// tok cannot be a chord or a null token
 			// This version is for vertical queries not for searching data.
@@ -9492,7 +11085,7 @@ class SonorityDatabase {
 		HLp getLine(void)      { return m_line; }
 		SonorityNoteData& getLowest(void) { return m_lowest; };
 		void addNote          (const std::string& text);
-		void buildDatabase     (HLp line);
+		void buildDatabase     (HumdrumFile& infile, int line);
 		SonorityNoteData& operator[](int index) {
 			return m_notes.at(index);
 		}
@@ -9691,8 +11284,6 @@ class Tool_msearch : public HumTool {
 		void    markTextMatch      (HumdrumFile& infile, TextInfo& word);
 		void    fillWords          (HumdrumFile& infile,
 		                            vector<TextInfo*>& words);
-		void    fillWordsForTrack  (vector<TextInfo*>& words,
-		                            HTp starttoken);
 		void    printQuery         (vector<MSearchQueryToken>& query);
 		void    addMusicSearchSummary(HumdrumFile& infile, int mcount, const std::string& marker);
 		void    addTextSearchSummary(HumdrumFile& infile, int mcount, const std::string& marker);
@@ -10162,12 +11753,9 @@ class Tool_myank : public HumTool {
 		                                int index);
 		void      getMarkString        (std::ostream& out, HumdrumFile& infile);
 		void      printDoubleBarline   (HumdrumFile& infile, int line);
-		void      insertZerothMeasure  (std::vector<MeasureInfo>& measurelist,
-		                                HumdrumFile& infile);
 		void      getMetStates         (std::vector<std::vector<MyCoord> >& metstates,
 		                                HumdrumFile& infile);
 		MyCoord   getLocalMetInfo      (HumdrumFile& infile, int row, int track);
-		int       atEndOfFile          (HumdrumFile& infile, int line);
 		void      processFile          (HumdrumFile& infile);
 		int       getSectionCount      (HumdrumFile& infile);
 		void      getSectionString     (std::string& sstring, HumdrumFile& infile,
@@ -10225,7 +11813,7 @@ class Tool_nproof : public HumTool {
 		void     checkInstrumentInformation(HumdrumFile& infile);
 		void     checkKeyInformation(HumdrumFile& infile);
 		void     checkSpineTerminations(HumdrumFile& infile);
-		void     checkForValidInstrumentCode(HTp token, std::vector<std::pair<std::string, std::string>>& instrumentList);
+		void     checkForValidInstrumentCode(HTp token);
 		void     checkReferenceRecords(HumdrumFile& infile);
 
 	protected:
@@ -10525,6 +12113,54 @@ class _VoiceInfo {
 
 
 
+// PrangeCorpus: pitch histograms of many files, merged by voice name so
+// that a range profile of a corpus can be printed without the source files.
+// Each file (or group of files) can be stored as a partial, which is a
+// Humdrum file with one line for each non-zero histogram bin:
+//
+//    !!!prange-partial: 1
+//    !!!prange-weight: attacks
+//    !!!prange-files: 2
+//    **voice   **key     **value
+//    soprano   name      Soprano
+//    soprano   abbr      S
+//    soprano   midi:72   14
+//    soprano   dia:49:0  14        (diatonic index and accidental)
+//    soprano   final:42:0 1        (diatonic index and accidental)
+//    *-        *-        *-
+//
+// Merging partials adds their bins, so they can be merged in any grouping
+// and order, and a merged partial can be updated later by merging it with
+// partials for new files.
+class PrangeCorpus {
+	public:
+		                PrangeCorpus      (void);
+		void            clear             (void);
+		bool            isEmpty           (void) const;
+		int             getFileCount      (void) const;
+		bool            isDurationWeighted(void) const;
+		void            setDurationWeighted(bool state);
+		void            addFile           (std::vector<_VoiceInfo>& voiceInfo);
+		bool            merge             (const PrangeCorpus& other);
+		static bool     isPartial         (HumdrumFile& infile);
+		bool            readPartial       (HumdrumFile& infile, std::string& error);
+		std::ostream&   printPartial      (std::ostream& out) const;
+		void            getVoiceInfo      (std::vector<_VoiceInfo>& voiceInfo) const;
+		static std::string getVoiceKey    (const std::string& name);
+
+	private:
+		static void     mergeVoice        (_VoiceInfo& target, const _VoiceInfo& source);
+		static void     addFinal          (_VoiceInfo& voice, int diatonic, int acc);
+		static bool     readCount         (const std::string& text, double& count);
+
+		// m_voices: histograms by normalized voice name.
+		std::map<std::string, _VoiceInfo> m_voices;
+		int  m_files     = 0;
+		bool m_durationQ = false;
+};
+
+
+
 class Tool_prange : public HumTool {
 	public:
 		         Tool_prange       (void);
@@ -10534,6 +12170,9 @@ class Tool_prange : public HumTool {
 		bool        run               (HumdrumFile& infile);
 		bool        run               (const std::string& indata, std::ostream& out);
 		bool        run               (HumdrumFile& infile, std::ostream& out);
+		void        finally           (void);
+
+		PrangeCorpus& getCorpus       (void);
 
 	protected:
 		void        processFile         (HumdrumFile& infile);
@@ -10547,7 +12186,7 @@ class Tool_prange : public HumTool {
 		void        printReferenceRecords       (std::ostream& out, HumdrumFile& infile);
 		void        printScoreEncodedText       (std::ostream& out, const std::string& strang);
 		void        printXmlEncodedText         (std::ostream& out, const std::string& strang);
-		void        printScoreFile              (std::ostream& out, std::vector<_VoiceInfo>& voiceInfo, HumdrumFile& infile);
+		void        printScoreFile              (std::ostream& out, std::vector<_VoiceInfo>& voiceInfo, int keysig);
 		void        printKeySigCompression      (std::ostream& out, int keysig, int extra);
 		void        assignHorizontalPosition    (std::vector<_VoiceInfo>& voiceInfo, int minval, int maxval);
 		int         getKeySignature             (HumdrumFile& infile);
@@ -10619,6 +12258,8 @@ class Tool_prange : public HumTool {
 		bool m_scoreQ       = false; // for --score option
 		bool m_titleQ       = false; // for --title option
 		bool m_extremaQ     = false; // for --extrema option
+		bool m_corpusQ      = false; // for --corpus option
+		bool m_partialQ     = false; // for --partial option
 
 		std::string m_highMark = "🌸";
 		std::string m_lowMark  = "🟢";
@@ -10637,6 +12278,9 @@ class Tool_prange : public HumTool {
 		// m_trackToKernIndex: mapping from track to **kern index
 		std::vector<int> m_trackToKernIndex;
 
+		// m_corpus: histograms merged from all inputs for --corpus option.
+		PrangeCorpus m_corpus;
+
 };
 
 
@@ -11303,7 +12947,7 @@ class Tool_synco : public HumTool {
 		void      processFile      (HumdrumFile& infile);
 		void      initialize       (void);
 
-		void      processStrand    (HTp stok, HTp etok);
+		void      processStrand    (const HumStrandTable& strands, int strand);
 		bool      isSyncopated     (HTp token);
 		double    getMetricLevel   (HTp token);
 		void      markNote         (HTp token);
@@ -11482,8 +13126,9 @@ class Tool_textdur : public HumTool {
 		void     printMelismas     (HumdrumFile& infile);
 		void     printDurations     (HumdrumFile& infile);
 		void     getTextSpineStarts(HumdrumFile& infile, std::vector<HTp>& starts);
-		void     processTextSpine  (std::vector<HTp>& starts, int index);
-		int      getMelisma        (HTp tok1, HTp tok2);
+		void     processTextSpine  (const HumTextTable& table,
+		                            std::vector<HTp>& starts, int index);
+		int      getMelisma        (const HumTextTable& table, int syllable);
 		HumNum   getDuration       (HTp tok1, HTp tok2);
 		HTp      getTandemKernToken(HTp token);
 		void     printInterleaved  (HumdrumFile& infile);
@@ -11628,10 +13273,12 @@ class Tool_transpose : public HumTool {
 	protected:
 
 		// auto transpose functions:
-		void     initialize             (HumdrumFile& infile);
+		bool     initialize             (HumdrumFile& infile);
 		void     convertScore           (HumdrumFile& infile, int style);
 		void     processFile            (HumdrumFile& infile,
 		                                 std::vector<bool>& spineprocess);
+		void     processIntervals       (HumdrumFile& infile,
+		                                 std::vector<bool>& spineprocess);
 		void     convertToConcertPitches(HumdrumFile& infile, int line,
 		                                 std::vector<int>& tvals);
 		void     convertToWrittenPitches(HumdrumFile& infile, int line,
@@ -11703,6 +13350,7 @@ class Tool_transpose : public HumTool {
 		                                 int line, int transval);
 		int      getTransposeInfo       (HumdrumFile& infile, int row, int col);
 		void     printNewKernString     (const std::string& string, int transval);
+		HumTransposer& getTransposer    (int transval);
 
 	private:
 		int      transval     = 0;   // used with -b option
@@ -11717,6 +13365,9 @@ class Tool_transpose : public HumTool {
 		int      writtenQ     = 0;   // used with -W option
 		int      quietQ       = 0;   // used with -q option
 		int      instrumentQ  = 0;   // used with -I option
+
+		std::map<int, HumTransposer> m_transposers; // lookup tables for each interval
+		std::string   m_kernBuffer;  // reused for transposing **kern tokens
 };
 
 
@@ -11790,7 +13441,6 @@ class Tool_tspos : public HumTool {
 	protected:
 		void             initialize        (HumdrumFile& infile);
 		void             processFile       (HumdrumFile& infile);
-		std::vector<int> getMidiNotes(std::vector<HTp>& kernNotes);
 		std::vector<int> getChordPositions(std::vector<int>& midiNotes);
 		std::vector<int> getNoteMods(std::vector<int>& midiNotes);
 		std::vector<int> getThirds(std::vector<int>& midiNotes);
@@ -11804,7 +13454,6 @@ class Tool_tspos : public HumTool {
 		std::vector<std::string> getTrackNames(HumdrumFile& infile);
 		int              getVectorSum(std::vector<int>& input);
 		void             analyzeVoiceCount(HumdrumFile& infile);
-		int              countVoicesOnLine(HumdrumFile& infile, int line);
 		std::string      generateTable(HumdrumFile& infile, std::vector<std::string>& name);
 		bool             hasFullTriadAttack(HumdrumLine& line);
 		void             avoidRdfCollisions(HumdrumFile& infile);
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Feb 29 20:10:49 PST 2020
-// Last Modified: Sat Feb 29 20:10:52 PST 2020
+// Last Modified: Sun Oct 18 23:59:59 PDT 2026
 // Filename:      Convert-instrument.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/Convert-instrument.cpp
 // Syntax:        C++11; humlib
@@ -12,6 +12,8 @@
 
 #include "Convert.h"
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <utility>
 #include <vector>
@@ -23,237 +25,300 @@ namespace hum {
 // START_MERGE
 
 
+// Instrument codes and their instrument classes (from
+// https://bit.ly/humdrum-instrument-codes), sorted by code (in strcmp()
+// order) so that they can be found with a binary search:
+
+static constexpr struct {
+	const char* code;
+	const char* iclass;
+} InstrumentClassList[] = {
+	{ "accor",   "klav" },
+	{ "alto",    "vox" },
+	{ "anvil",   "idio" },
+	{ "archl",   "str" },
+	{ "armon",   "ww" },
+	{ "arpa",    "str" },
+	{ "bagpI",   "ww" },
+	{ "bagpS",   "ww" },
+	{ "banjo",   "str" },
+	{ "bansu",   "ww" },
+	{ "barit",   "vox" },
+	{ "baset",   "ww" },
+	{ "bass",    "vox" },
+	{ "bdrum",   "idio" },
+	{ "bguit",   "str" },
+	{ "biwa",    "str" },
+	{ "brush",   "idio" },
+	{ "bscan",   "vox" },
+	{ "bspro",   "vox" },
+	{ "bugle",   "bras" },
+	{ "calam",   "ww" },
+	{ "calpe",   "ww" },
+	{ "calto",   "vox" },
+	{ "campn",   "idio" },
+	{ "cangl",   "ww" },
+	{ "canto",   "vox" },
+	{ "caril",   "idio" },
+	{ "castr",   "vox" },
+	{ "casts",   "idio" },
+	{ "cbass",   "str" },
+	{ "cello",   "str" },
+	{ "cemba",   "klav" },
+	{ "cetra",   "str" },
+	{ "chain",   "idio" },
+	{ "chcym",   "idio" },
+	{ "chime",   "idio" },
+	{ "chlma",   "ww" },
+	{ "chlms",   "ww" },
+	{ "chlmt",   "ww" },
+	{ "clap",    "idio" },
+	{ "clara",   "ww" },
+	{ "clarb",   "ww" },
+	{ "claro",   "ww" },
+	{ "clarp",   "ww" },
+	{ "clars",   "ww" },
+	{ "clave",   "idio" },
+	{ "clavi",   "klav" },
+	{ "clest",   "klav" },
+	{ "clrno",   "bras" },
+	{ "colsp",   "vox" },
+	{ "conga",   "idio" },
+	{ "cor",     "bras" },
+	{ "cornm",   "ww" },
+	{ "corno",   "ww" },
+	{ "cornt",   "bras" },
+	{ "coro",    "vox" },
+	{ "crshc",   "idio" },
+	{ "ctenor",  "vox" },
+	{ "ctina",   "klav" },
+	{ "drmsp",   "vox" },
+	{ "drum",    "idio" },
+	{ "drumP",   "idio" },
+	{ "dulc",    "str" },
+	{ "eguit",   "str" },
+	{ "fag_c",   "ww" },
+	{ "fagot",   "ww" },
+	{ "false",   "vox" },
+	{ "fdrum",   "idio" },
+	{ "feme",    "vox" },
+	{ "fife",    "ww" },
+	{ "fingc",   "idio" },
+	{ "flex",    "idio" },
+	{ "flt",     "ww" },
+	{ "flt_a",   "ww" },
+	{ "flt_b",   "ww" },
+	{ "fltda",   "ww" },
+	{ "fltdb",   "ww" },
+	{ "fltdn",   "ww" },
+	{ "fltds",   "ww" },
+	{ "fltdt",   "ww" },
+	{ "flugh",   "bras" },
+	{ "forte",   "klav" },
+	{ "gen",     "gen" },
+	{ "genB",    "gen" },
+	{ "genT",    "gen" },
+	{ "glock",   "idio" },
+	{ "gong",    "idio" },
+	{ "guitr",   "str" },
+	{ "hammd",   "klav" },
+	{ "hbell",   "idio" },
+	{ "heck",    "ww" },
+	{ "heltn",   "vox" },
+	{ "hichi",   "ww" },
+	{ "hurdy",   "str" },
+	{ "kitv",    "str" },
+	{ "klav",    "klav" },
+	{ "kokyu",   "str" },
+	{ "komun",   "str" },
+	{ "koto",    "str" },
+	{ "kruma",   "ww" },
+	{ "krumb",   "ww" },
+	{ "krums",   "ww" },
+	{ "krumt",   "ww" },
+	{ "lion",    "idio" },
+	{ "liuto",   "str" },
+	{ "lyrsp",   "vox" },
+	{ "lyrtn",   "vox" },
+	{ "male",    "vox" },
+	{ "mando",   "str" },
+	{ "marac",   "idio" },
+	{ "marim",   "idio" },
+	{ "mbari",   "vox" },
+	{ "mezzo",   "vox" },
+	{ "nfant",   "vox" },
+	{ "nokan",   "ww" },
+	{ "oboe",    "ww" },
+	{ "oboeD",   "ww" },
+	{ "ocari",   "ww" },
+	{ "ondes",   "klav" },
+	{ "ophic",   "bras" },
+	{ "organ",   "klav" },
+	{ "oud",     "str" },
+	{ "paila",   "idio" },
+	{ "panpi",   "ww" },
+	{ "pbell",   "idio" },
+	{ "pguit",   "str" },
+	{ "physh",   "klav" },
+	{ "piano",   "klav" },
+	{ "piatt",   "idio" },
+	{ "picco",   "ww" },
+	{ "pipa",    "str" },
+	{ "piri",    "ww" },
+	{ "porta",   "klav" },
+	{ "psalt",   "str" },
+	{ "qin",     "str" },
+	{ "quinto",  "vox" },
+	{ "quitr",   "str" },
+	{ "rackt",   "ww" },
+	{ "ratch",   "idio" },
+	{ "ratl",    "idio" },
+	{ "rebec",   "str" },
+	{ "recit",   "vox" },
+	{ "reedo",   "klav" },
+	{ "rhode",   "klav" },
+	{ "ridec",   "idio" },
+	{ "sarod",   "str" },
+	{ "sarus",   "ww" },
+	{ "saxA",    "ww" },
+	{ "saxB",    "ww" },
+	{ "saxC",    "ww" },
+	{ "saxN",    "ww" },
+	{ "saxR",    "ww" },
+	{ "saxS",    "ww" },
+	{ "saxT",    "ww" },
+	{ "sbell",   "idio" },
+	{ "sdrum",   "idio" },
+	{ "serp",    "bras" },
+	{ "sesto",   "vox" },
+	{ "shaku",   "ww" },
+	{ "shami",   "str" },
+	{ "sheng",   "ww" },
+	{ "sho",     "ww" },
+	{ "siren",   "idio" },
+	{ "sitar",   "str" },
+	{ "slap",    "idio" },
+	{ "soprn",   "vox" },
+	{ "spok",    "vox" },
+	{ "spokF",   "vox" },
+	{ "spokM",   "vox" },
+	{ "spshc",   "idio" },
+	{ "steel",   "idio" },
+	{ "stim",    "vox" },
+	{ "stimA",   "vox" },
+	{ "stimB",   "vox" },
+	{ "stimC",   "vox" },
+	{ "stimR",   "vox" },
+	{ "stimS",   "vox" },
+	{ "strdr",   "idio" },
+	{ "sxhA",    "bras" },
+	{ "sxhB",    "bras" },
+	{ "sxhC",    "bras" },
+	{ "sxhR",    "bras" },
+	{ "sxhS",    "bras" },
+	{ "sxhT",    "bras" },
+	{ "synth",   "klav" },
+	{ "tabla",   "idio" },
+	{ "tambn",   "idio" },
+	{ "tambu",   "str" },
+	{ "tanbr",   "str" },
+	{ "tblok",   "idio" },
+	{ "tdrum",   "idio" },
+	{ "tenor",   "vox" },
+	{ "timpa",   "idio" },
+	{ "tiorb",   "str" },
+	{ "tom",     "idio" },
+	{ "trngl",   "idio" },
+	{ "tromP",   "bras" },
+	{ "troma",   "bras" },
+	{ "tromb",   "bras" },
+	{ "tromp",   "bras" },
+	{ "tromt",   "bras" },
+	{ "trumB",   "bras" },
+	{ "tuba",    "bras" },
+	{ "tubaB",   "bras" },
+	{ "tubaC",   "bras" },
+	{ "tubaT",   "bras" },
+	{ "tubaU",   "bras" },
+	{ "ukule",   "str" },
+	{ "vibra",   "idio" },
+	{ "vina",    "str" },
+	{ "viola",   "str" },
+	{ "violb",   "str" },
+	{ "viold",   "str" },
+	{ "viole",   "str" },
+	{ "violn",   "str" },
+	{ "violp",   "str" },
+	{ "viols",   "str" },
+	{ "violt",   "str" },
+	{ "vox",     "vox" },
+	{ "wblok",   "idio" },
+	{ "xylo",    "idio" },
+	{ "zithr",   "str" },
+	{ "zurna",   "ww" }
+};
+
+
+static constexpr int InstrumentClassCount =
+		(int)(sizeof(InstrumentClassList) / sizeof(InstrumentClassList[0]));
+
+
+// isSortedInstrumentClassList: used to check at compile time that the
+// instrument class list is sorted and has no duplicate codes.
+
+static constexpr bool isSortedInstrumentClassList(void) {
+	for (int i=1; i<InstrumentClassCount; i++) {
+		const char* a = InstrumentClassList[i-1].code;
+		const char* b = InstrumentClassList[i].code;
+		while ((*a != '\0') && (*a == *b)) {
+			a++;
+			b++;
+		}
+		if ((unsigned char)*a >= (unsigned char)*b) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static_assert(isSortedInstrumentClassList(), "InstrumentClassList must be sorted by code");
+
+
+
 //////////////////////////////
 //
-// Convert::getInstrumentList -- List from https://bit.ly/humdrum-instrument-codes
+// Convert::getInstrumentList -- Return the list of instrument codes
+//     and their instrument classes, sorted by code.
 //
 
 vector<pair<string, string> > Convert::getInstrumentList(void) {
-	return vector<pair<string, string> > {
-		{"accor",	"klav"},
-		{"alto",	"vox"},
-		{"anvil",	"idio"},
-		{"archl",	"str"},
-		{"armon",	"ww"},
-		{"arpa",	"str"},
-		{"bagpI",	"ww"},
-		{"bagpS",	"ww"},
-		{"banjo",	"str"},
-		{"bansu",	"ww"},
-		{"barit",	"vox"},
-		{"baset",	"ww"},
-		{"bass",	"vox"},
-		{"bdrum",	"idio"},
-		{"bguit",	"str"},
-		{"biwa",	"str"},
-		{"brush",	"idio"},
-		{"bscan",	"vox"},
-		{"bspro",	"vox"},
-		{"bugle",	"bras"},
-		{"calam",	"ww"},
-		{"calpe",	"ww"},
-		{"calto",	"vox"},
-		{"campn",	"idio"},
-		{"cangl",	"ww"},
-		{"canto",	"vox"},
-		{"caril",	"idio"},
-		{"castr",	"vox"},
-		{"casts",	"idio"},
-		{"cbass",	"str"},
-		{"cello",	"str"},
-		{"cemba",	"klav"},
-		{"cetra",	"str"},
-		{"chain",	"idio"},
-		{"chcym",	"idio"},
-		{"chime",	"idio"},
-		{"chlma",	"ww"},
-		{"chlms",	"ww"},
-		{"chlmt",	"ww"},
-		{"clap",	"idio"},
-		{"clara",	"ww"},
-		{"clarb",	"ww"},
-		{"claro",	"ww"},
-		{"clarp",	"ww"},
-		{"clars",	"ww"},
-		{"clave",	"idio"},
-		{"clavi",	"klav"},
-		{"clest",	"klav"},
-		{"clrno",	"bras"},
-		{"colsp",	"vox"},
-		{"conga",	"idio"},
-		{"cor",	"bras"},
-		{"cornm",	"ww"},
-		{"corno",	"ww"},
-		{"cornt",	"bras"},
-		{"coro",	"vox"},
-		{"crshc",	"idio"},
-		{"ctenor",	"vox"},
-		{"ctina",	"klav"},
-		{"drmsp",	"vox"},
-		{"drum",	"idio"},
-		{"drumP",	"idio"},
-		{"dulc",	"str"},
-		{"eguit",	"str"},
-		{"fag_c",	"ww"},
-		{"fagot",	"ww"},
-		{"false",	"vox"},
-		{"fdrum",	"idio"},
-		{"feme",	"vox"},
-		{"fife",	"ww"},
-		{"fingc",	"idio"},
-		{"flex",	"idio"},
-		{"flt",	"ww"},
-		{"flt_a",	"ww"},
-		{"flt_b",	"ww"},
-		{"fltda",	"ww"},
-		{"fltdb",	"ww"},
-		{"fltdn",	"ww"},
-		{"fltds",	"ww"},
-		{"fltdt",	"ww"},
-		{"flugh",	"bras"},
-		{"forte",	"klav"},
-		{"gen",	"gen"},
-		{"genB",	"gen"},
-		{"genT",	"gen"},
-		{"glock",	"idio"},
-		{"gong",	"idio"},
-		{"guitr",	"str"},
-		{"hammd",	"klav"},
-		{"hbell",	"idio"},
-		{"heck",	"ww"},
-		{"heltn",	"vox"},
-		{"hichi",	"ww"},
-		{"hurdy",	"str"},
-		{"kitv",	"str"},
-		{"klav",	"klav"},
-		{"kokyu",	"str"},
-		{"komun",	"str"},
-		{"koto",	"str"},
-		{"kruma",	"ww"},
-		{"krumb",	"ww"},
-		{"krums",	"ww"},
-		{"krumt",	"ww"},
-		{"lion",	"idio"},
-		{"liuto",	"str"},
-		{"lyrsp",	"vox"},
-		{"lyrtn",	"vox"},
-		{"male",	"vox"},
-		{"mando",	"str"},
-		{"marac",	"idio"},
-		{"marim",	"idio"},
-		{"mbari",	"vox"},
-		{"mezzo",	"vox"},
-		{"nfant",	"vox"},
-		{"nokan",	"ww"},
-		{"oboe",	"ww"},
-		{"oboeD",	"ww"},
-		{"ocari",	"ww"},
-		{"ondes",	"klav"},
-		{"ophic",	"bras"},
-		{"organ",	"klav"},
-		{"oud",	"str"},
-		{"paila",	"idio"},
-		{"panpi",	"ww"},
-		{"pbell",	"idio"},
-		{"pguit",	"str"},
-		{"physh",	"klav"},
-		{"piano",	"klav"},
-		{"piatt",	"idio"},
-		{"picco",	"ww"},
-		{"pipa",	"str"},
-		{"piri",	"ww"},
-		{"porta",	"klav"},
-		{"psalt",	"str"},
-		{"qin",	"str"},
-		{"quinto",	"vox"},
-		{"quitr",	"str"},
-		{"rackt",	"ww"},
-		{"ratch",	"idio"},
-		{"ratl",	"idio"},
-		{"rebec",	"str"},
-		{"recit",	"vox"},
-		{"reedo",	"klav"},
-		{"rhode",	"klav"},
-		{"ridec",	"idio"},
-		{"sarod",	"str"},
-		{"sarus",	"ww"},
-		{"saxA",	"ww"},
-		{"saxB",	"ww"},
-		{"saxC",	"ww"},
-		{"saxN",	"ww"},
-		{"saxR",	"ww"},
-		{"saxS",	"ww"},
-		{"saxT",	"ww"},
-		{"sbell",	"idio"},
-		{"sdrum",	"idio"},
-		{"serp",	"bras"},
-		{"sesto",	"vox"},
-		{"shaku",	"ww"},
-		{"shami",	"str"},
-		{"sheng",	"ww"},
-		{"sho",	"ww"},
-		{"siren",	"idio"},
-		{"sitar",	"str"},
-		{"slap",	"idio"},
-		{"soprn",	"vox"},
-		{"spok",	"vox"},
-		{"spokF",	"vox"},
-		{"spokM",	"vox"},
-		{"spshc",	"idio"},
-		{"steel",	"idio"},
-		{"stim",	"vox"},
-		{"stimA",	"vox"},
-		{"stimB",	"vox"},
-		{"stimC",	"vox"},
-		{"stimR",	"vox"},
-		{"stimS",	"vox"},
-		{"strdr",	"idio"},
-		{"sxhA",	"bras"},
-		{"sxhB",	"bras"},
-		{"sxhC",	"bras"},
-		{"sxhR",	"bras"},
-		{"sxhS",	"bras"},
-		{"sxhT",	"bras"},
-		{"synth",	"klav"},
-		{"tabla",	"idio"},
-		{"tambn",	"idio"},
-		{"tambu",	"str"},
-		{"tanbr",	"str"},
-		{"tblok",	"idio"},
-		{"tdrum",	"idio"},
-		{"tenor",	"vox"},
-		{"timpa",	"idio"},
-		{"tiorb",	"str"},
-		{"tom",	"idio"},
-		{"trngl",	"idio"},
-		{"tromP",	"bras"},
-		{"troma",	"bras"},
-		{"tromb",	"bras"},
-		{"tromp",	"bras"},
-		{"tromt",	"bras"},
-		{"trumB",	"bras"},
-		{"tuba",	"bras"},
-		{"tubaB",	"bras"},
-		{"tubaC",	"bras"},
-		{"tubaT",	"bras"},
-		{"tubaU",	"bras"},
-		{"ukule",	"str"},
-		{"vibra",	"idio"},
-		{"vina",	"str"},
-		{"viola",	"str"},
-		{"violb",	"str"},
-		{"viold",	"str"},
-		{"viole",	"str"},
-		{"violn",	"str"},
-		{"violp",	"str"},
-		{"viols",	"str"},
-		{"violt",	"str"},
-		{"vox",	"vox"},
-		{"wblok",	"idio"},
-		{"xylo",	"idio"},
-		{"zithr",	"str"},
-		{"zurna",	"ww"}
-	};
+	vector<pair<string, string> > output;
+	output.reserve(InstrumentClassCount);
+	for (int i=0; i<InstrumentClassCount; i++) {
+		output.emplace_back(InstrumentClassList[i].code, InstrumentClassList[i].iclass);
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// Convert::getInstrumentClass -- Return the instrument class of an
+//     instrument code (without *I), such as "str" for "violn", or an empty
+//     string if the code is unknown.
+//
+
+string Convert::getInstrumentClass(const string& code) {
+	auto end = InstrumentClassList + InstrumentClassCount;
+	auto entry = std::lower_bound(InstrumentClassList, end, code.c_str(),
+			[](const decltype(InstrumentClassList[0])& a, const char* b) {
+				return strcmp(a.code, b) < 0;
+			});
+	if ((entry == end) || (strcmp(entry->code, code.c_str()) != 0)) {
+		return "";
+	}
+	return entry->iclass;
 }
 
 
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
-// Last Modified: Wed Aug 19 00:06:39 PDT 2015
+// Last Modified: Sun Oct 18 22:40:05 PDT 2026
 // Filename:      Convert-pitch.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/Convert-pitch.cpp
 // Syntax:        C++11; humlib
@@ -292,7 +292,8 @@ int Convert::kernToBase12(const string& kerndata) {
 //////////////////////////////
 //
 // Convert::base40ToKern -- Convert Base-40 integer pitches into
-//   **kern pitch representation.
+//   **kern pitch representation.  Returns an empty string if the
+//   octave is out of range.
 //
 
 string Convert::base40ToKern(int b40) {
@@ -320,7 +321,7 @@ string Convert::base40ToKern(int b40) {
 	}
 	if (repeat > 12) {
 		cerr << "Error: unreasonable octave value: " << octave << " for " << b40 << endl;
-		exit(1);
+		return "";
 	}
 	string output;
 	output += base;
@@ -13,6 +13,8 @@
 #include "Convert.h"
 #include "HumRegex.h"
 
+#include <ctime>
+
 using namespace std;
 
 namespace hum {
@@ -950,6 +952,29 @@ string Convert::getLanguageName(const string& abbreviation) {
 
 
 
+//////////////////////////////
+//
+// Convert::getCurrentDate -- Return the current local date (and/or time)
+//     formatted with strftime().  The default format is "YYYY/MM/DD", which
+//     is the format used in reference records such as !!!ONB and !!!END.
+//     (localtime() is not used since it returns a pointer to shared storage.)
+//
+
+string Convert::getCurrentDate(const string& format) {
+	time_t now = time(NULL);
+	tm local;
+	#ifdef _WIN32
+		localtime_s(&local, &now);
+	#else
+		localtime_r(&now, &local);
+	#endif
+	char buffer[256];
+	size_t length = strftime(buffer, sizeof(buffer), format.c_str(), &local);
+	return string(buffer, length);
+}
+
+
+
 // END_MERGE
 
 } // end namespace hum
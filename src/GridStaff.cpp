@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Oct 16 16:08:05 PDT 2016
-// Last Modified: Sun Oct 16 16:08:08 PDT 2016
+// Last Modified: Sun Oct 18 16:55:11 PDT 2026
 // Filename:      GridStaff.cpp
 // URL:           https://github.com/craigsapp/hum2ly/blob/master/src/GridStaff.cpp
 // Syntax:        C++11; humlib
@@ -233,16 +233,16 @@ ostream& operator<<(ostream& output, GridStaff* staff) {
 	}
 	for (int t=0; t<(int)staff->size(); t++) {
 		GridVoice* gt = staff->at(t);
-		cout << "(v" << t << ":)";
+		output << "(v" << t << ":)";
 		if (gt == NULL) {
-			cout << "{gt:n}";
+			output << "{gt:n}";
 			continue;
 		} else {
 			HTp token = gt->getToken();
 			if (token == NULL) {
-				cout << "{n}";
+				output << "{n}";
 			} else {
-				cout << " \"" << *token << "\" ";
+				output << " \"" << *token << "\" ";
 			}
 		}
 	}
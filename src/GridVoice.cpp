@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Tue Oct 18 12:01:36 PDT 2016
-// Last Modified: Tue Oct 18 12:01:41 PDT 2016
+// Last Modified: Sun Oct 18 16:55:18 PDT 2026
 // Filename:      GridVoice.h
 // URL:           https://github.com/craigsapp/hum2ly/blob/master/include/GridVoice.h
 // Syntax:        C++11; humlib
@@ -242,9 +242,9 @@ string GridVoice::getString(void) {
 	string output;
 	HTp token = getToken();
 	if (token == NULL) {
-		cout << "{n}";
+		output = "{n}";
 	} else {
-		cout << *token;
+		output = *token;
 	}
 	return output;
 }
@@ -264,9 +264,9 @@ ostream& operator<<(ostream& output, GridVoice* voice) {
 
 	HTp token = voice->getToken();
 	if (token == NULL) {
-		cout << "{n}";
+		output << "{n}";
 	} else {
-		cout << " \"" << *token << "\" ";
+		output << " \"" << *token << "\" ";
 	}
 	return output;
 }
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
-// Last Modified: Sun Aug  9 21:03:12 PDT 2015
+// Last Modified: Sun Oct 18 23:48:30 PDT 2026
 // Filename:      HumAddress.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumAddress.cpp
 // Syntax:        C++11; humlib
@@ -13,6 +13,8 @@
 #include "HumAddress.h"
 #include "HumdrumLine.h"
 
+#include <unordered_set>
+
 using namespace std;
 
 namespace hum {
@@ -30,6 +32,7 @@ HumAddress::HumAddress(void) {
 	m_subtrack      = -1;
 	m_subtrackcount = 0;
 	m_fieldindex    = -1;
+	m_spining       = makeSpineInfo("");
 	m_owner         = NULL;
 }
 
@@ -169,7 +172,45 @@ HTp HumAddress::getExclusiveInterpretation(void) {
 //
 
 const string& HumAddress::getSpineInfo(void) const {
-	return m_spining;
+	return *m_spining;
+}
+
+
+
+//////////////////////////////
+//
+// HumAddress::makeSpineInfo -- Return a spine info string which can be
+//     shared by several tokens.  Common spine info strings (the first one
+//     hundred spines, split up to two times) are taken from a fixed table
+//     which does not change, so no locking or reference counting is needed
+//     for them.  Other strings are allocated, and freed when the last token
+//     using them is deleted.
+//
+
+std::shared_ptr<const string> HumAddress::makeSpineInfo(const string& spineinfo) {
+	static const std::unordered_set<string> common = [](void) {
+		std::unordered_set<string> output;
+		output.insert("");
+		for (int i=1; i<=100; i++) {
+			string track = to_string(i);
+			for (const string& sub : { track, "(" + track + ")a", "(" + track + ")b" }) {
+				output.insert(sub);
+			}
+			for (const char* split1 : { "a", "b" }) {
+				for (const char* split2 : { "a", "b" }) {
+					output.insert("((" + track + ")" + split1 + ")" + split2);
+				}
+			}
+		}
+		return output;
+	}();
+
+	auto found = common.find(spineinfo);
+	if (found != common.end()) {
+		// Point to the table entry without taking ownership of it:
+		return std::shared_ptr<const string>(std::shared_ptr<const string>(), &*found);
+	}
+	return std::make_shared<const string>(spineinfo);
 }
 
 
@@ -306,10 +347,16 @@ void HumAddress::setFieldIndex(int index) {
 //     token.  For example "2" for the second spine (from the left), or
 //     "((2)a)b" for a sub-spine created as the left sub-spine of the main
 //     spine and then as the right sub-spine of that sub-spine.  This function
-//     is used by the HumdrumFileStructure class.
+//     is used by the HumdrumFileStructure class.  The second form shares a
+//     string returned by makeSpineInfo().
 //
 
 void HumAddress::setSpineInfo(const string& spineinfo) {
+	m_spining = makeSpineInfo(spineinfo);
+}
+
+
+void HumAddress::setSpineInfo(const std::shared_ptr<const string>& spineinfo) {
 	m_spining = spineinfo;
 }
 
@@ -0,0 +1,392 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 12:24:31 PDT 2026
+// Last Modified: Sun Oct 18 23:59:59 PDT 2026
+// Filename:      HumAnalysisTables.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumAnalysisTables.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Typed storage for the results of HumdrumFileContent analyses
+//                (accidental display, slur, beam, tie and phrase links, rest
+//                positions, null-token resolution and sonorities), indexed
+//                by the position of each token in the file.
+//
+
+#include "HumAnalysisTables.h"
+#include "HumdrumFileBase.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::HumAnalysisTables -- Constructor.
+//
+
+HumAnalysisTables::HumAnalysisTables(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::clear -- Remove the token index and all analysis data.
+//
+
+void HumAnalysisTables::clear(void) {
+	m_lineOffsets.clear();
+	m_tokens.clear();
+	m_tokenLines.clear();
+	m_accidentalOffsets.clear();
+	m_accidentals.clear();
+	m_slurs.clear();
+	m_beams.clear();
+	m_ties.clear();
+	m_phrases.clear();
+	m_restDiatonic.clear();
+	m_restOctave.clear();
+	m_nullResolution.clear();
+	m_attackLines.clear();
+	m_sonorities.clear();
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::indexTokens -- Assign an id to each token in the file
+//    and prepare empty analysis tables for them.
+//
+
+void HumAnalysisTables::indexTokens(HumdrumFileBase& infile) {
+	clear();
+	int lineCount = infile.getLineCount();
+	m_lineOffsets.resize(lineCount + 1);
+	int count = 0;
+	for (int i=0; i<lineCount; i++) {
+		m_lineOffsets[i] = count;
+		count += infile[i].getFieldCount();
+	}
+	m_lineOffsets[lineCount] = count;
+	m_tokens.resize(count);
+	m_tokenLines.resize(count);
+	m_accidentalOffsets.resize(count + 1);
+	int subtokens = 0;
+	for (int i=0; i<lineCount; i++) {
+		int fieldCount = infile[i].getFieldCount();
+		bool dataQ = infile[i].isData();
+		for (int j=0; j<fieldCount; j++) {
+			HTp token = infile.token(i, j);
+			m_tokens[m_lineOffsets[i] + j] = token;
+			m_tokenLines[m_lineOffsets[i] + j] = i;
+			m_accidentalOffsets[m_lineOffsets[i] + j] = subtokens;
+			if (dataQ && !token->isNull()) {
+				subtokens += 1 + (int)std::count(token->begin(), token->end(), ' ');
+			}
+		}
+	}
+	m_accidentalOffsets[count] = subtokens;
+
+	m_accidentals.assign(subtokens, 0);
+	m_slurs.resize(count);
+	m_beams.resize(count);
+	m_ties.resize(count);
+	m_phrases.resize(count);
+	m_restDiatonic.assign(count, -1);
+	m_restOctave.assign(count, 0);
+	m_nullResolution.assign(count, -1);
+	m_attackLines.assign(count, -1);
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::isIndexCurrent -- Return true if the token index
+//    matches the tokens in the file (i.e., lines or spines have not been
+//    added or removed since the index was created).
+//
+
+bool HumAnalysisTables::isIndexCurrent(HumdrumFileBase& infile) const {
+	int lineCount = infile.getLineCount();
+	if (lineCount + 1 != (int)m_lineOffsets.size()) {
+		return false;
+	}
+	for (int i=0; i<lineCount; i++) {
+		int fieldCount = infile[i].getFieldCount();
+		if (m_lineOffsets[i] + fieldCount != m_lineOffsets[i+1]) {
+			return false;
+		}
+		if ((fieldCount > 0) && (m_tokens[m_lineOffsets[i]] != infile.token(i, 0))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::getLineCount -- Return the number of lines in the
+//    file when the tokens were indexed.
+//
+
+int HumAnalysisTables::getLineCount(void) const {
+	if (m_lineOffsets.empty()) {
+		return 0;
+	}
+	return (int)m_lineOffsets.size() - 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::getTokenCount -- Return the number of indexed tokens.
+//
+
+int HumAnalysisTables::getTokenCount(void) const {
+	return (int)m_tokens.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::getTokenId -- Return the id of a token, or -1 if the
+//    token is not in the index (such as tokens created after the index).
+//
+
+int HumAnalysisTables::getTokenId(HTp token) const {
+	if (token == NULL) {
+		return -1;
+	}
+	int line = token->getLineIndex();
+	if ((line < 0) || (line + 1 >= (int)m_lineOffsets.size())) {
+		return -1;
+	}
+	int id = m_lineOffsets[line] + token->getFieldIndex();
+	if ((id < m_lineOffsets[line]) || (id >= m_lineOffsets[line+1])) {
+		return -1;
+	}
+	if (m_tokens[id] != token) {
+		return -1;
+	}
+	return id;
+}
+
+//
+// Line and field version:
+//
+
+int HumAnalysisTables::getTokenId(int line, int field) const {
+	if ((line < 0) || (line + 1 >= (int)m_lineOffsets.size())) {
+		return -1;
+	}
+	int id = m_lineOffsets[line] + field;
+	if ((field < 0) || (id >= m_lineOffsets[line+1])) {
+		return -1;
+	}
+	return id;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::getToken -- Return the token for a token id.
+//
+
+HTp HumAnalysisTables::getToken(int id) const {
+	if ((id < 0) || (id >= (int)m_tokens.size())) {
+		return NULL;
+	}
+	return m_tokens[id];
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::getTokenLine -- Return the line index of a token id,
+//     or -1 if the id is not valid.
+//
+
+int HumAnalysisTables::getTokenLine(int id) const {
+	if ((id < 0) || (id >= (int)m_tokenLines.size())) {
+		return -1;
+	}
+	return m_tokenLines[id];
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::getTokenField -- Return the field index of a token id
+//     on its line, or -1 if the id is not valid.
+//
+
+int HumAnalysisTables::getTokenField(int id) const {
+	if ((id < 0) || (id >= (int)m_tokenLines.size())) {
+		return -1;
+	}
+	return id - m_lineOffsets[m_tokenLines[id]];
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::setAccidentalFlags -- Add ACCID_VISUAL, ACCID_CAUTIONARY
+//     and/or ACCID_OBLIGATORY states to a subtoken.  Returns false if the
+//     token did not have the subtoken when it was indexed.
+//
+
+bool HumAnalysisTables::setAccidentalFlags(int id, int subtoken, int flags) {
+	int index = getAccidentalIndex(id, subtoken);
+	if (index < 0) {
+		return false;
+	}
+	m_accidentals[index] |= (uint8_t)flags;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::getAccidentalFlags -- Return the accidental states of
+//     a subtoken, or -1 if the subtoken is not stored in the tables.
+//
+
+int HumAnalysisTables::getAccidentalFlags(int id, int subtoken) const {
+	int index = getAccidentalIndex(id, subtoken);
+	if (index < 0) {
+		return -1;
+	}
+	return m_accidentals[index];
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::getAccidentalIndex -- Return the position of the
+//     accidental states of a subtoken in m_accidentals, or -1 if the
+//     token did not have the subtoken when it was indexed.
+//
+
+int HumAnalysisTables::getAccidentalIndex(int id, int subtoken) const {
+	if ((id < 0) || (id + 1 >= (int)m_accidentalOffsets.size()) || (subtoken < 0)) {
+		return -1;
+	}
+	int index = m_accidentalOffsets[id] + subtoken;
+	if (index >= m_accidentalOffsets[id + 1]) {
+		return -1;
+	}
+	return index;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::setRestPosition -- Store the vertical position of
+//     a rest as a diatonic pitch class (0=C to 6=B) and octave.
+//
+
+void HumAnalysisTables::setRestPosition(int id, int diatonic, int octave) {
+	if ((id < 0) || (id >= (int)m_restDiatonic.size())) {
+		return;
+	}
+	m_restDiatonic[id] = (int8_t)diatonic;
+	m_restOctave[id] = (int8_t)octave;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::getRestPosition -- Return the vertical position of a
+//     rest as a diatonic pitch class (0=C to 6=B) and octave.  Returns false
+//     if the rest does not have a vertical position.
+//
+
+bool HumAnalysisTables::getRestPosition(int id, int& diatonic, int& octave) const {
+	if ((id < 0) || (id >= (int)m_restDiatonic.size())) {
+		return false;
+	}
+	if (m_restDiatonic[id] < 0) {
+		return false;
+	}
+	diatonic = m_restDiatonic[id];
+	octave = m_restOctave[id];
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::setNullResolution -- Store the token id of the
+//     non-null data token which a token resolves to, and the line on
+//     which that note was attacked.
+//
+
+void HumAnalysisTables::setNullResolution(int id, int resolved, int attackline) {
+	if ((id < 0) || (id >= (int)m_nullResolution.size())) {
+		return;
+	}
+	m_nullResolution[id] = resolved;
+	m_attackLines[id] = attackline;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::getNullResolution -- Return the token id of the last
+//     non-null data token in the spine at or before the given token, or
+//     -1 if there is none (or the id is not valid).
+//
+
+int HumAnalysisTables::getNullResolution(int id) const {
+	if ((id < 0) || (id >= (int)m_nullResolution.size())) {
+		return -1;
+	}
+	return m_nullResolution[id];
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisTables::getAttackLine -- Return the line on which the note
+//     sounding at the given token was attacked, or -1 if there is none.
+//
+
+int HumAnalysisTables::getAttackLine(int id) const {
+	if ((id < 0) || (id >= (int)m_attackLines.size())) {
+		return -1;
+	}
+	return m_attackLines[id];
+}
+
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
@@ -0,0 +1,407 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 20:04:36 PDT 2026
+// Last Modified: Sun Oct 18 23:59:59 PDT 2026
+// Filename:      HumFeatureExtractor.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumFeatureExtractor.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Extraction of note features from **kern data into the
+//                columns of a HumFeatureTable.
+//
+
+#include "HumFeatureExtractor.h"
+#include "Convert.h"
+#include "HumRegex.h"
+
+#include <cmath>
+#include <map>
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+
+// Column name, column type and description of each feature, in the order
+// of the HumFeatureExtractor::Feature enumeration:
+
+static const struct {
+	const char* name;
+	HumFeatureTable::ColumnType type;
+	const char* description;
+} HumFeatureList[HumFeatureExtractor::FEATURE_COUNT] = {
+	{ "file",       HumFeatureTable::TYPE_STRING,  "filename" },
+	{ "line",       HumFeatureTable::TYPE_INT32,   "line index of note in file (from 0)" },
+	{ "field",      HumFeatureTable::TYPE_INT32,   "field index of note on line (from 0)" },
+	{ "subtoken",   HumFeatureTable::TYPE_INT32,   "index of note in chord (from 0)" },
+	{ "track",      HumFeatureTable::TYPE_INT32,   "track (spine) number of note (from 1)" },
+	{ "layer",      HumFeatureTable::TYPE_INT32,   "subtrack number of note (0 if spine is not split)" },
+	{ "measure",    HumFeatureTable::TYPE_INT32,   "measure number" },
+	{ "onset",      HumFeatureTable::TYPE_FLOAT64, "quarter notes from start of score" },
+	{ "duration",   HumFeatureTable::TYPE_FLOAT64, "duration in quarter notes (including tied notes)" },
+	{ "metpos",     HumFeatureTable::TYPE_FLOAT64, "quarter notes from start of measure" },
+	{ "beat",       HumFeatureTable::TYPE_FLOAT64, "beat in measure (from 1) in units of the time signature bottom" },
+	{ "metlev",     HumFeatureTable::TYPE_FLOAT64, "metric level of note (0 = beat, 1 = measure, -1 = half beat)" },
+	{ "kern",       HumFeatureTable::TYPE_STRING,  "**kern data for note" },
+	{ "base40",     HumFeatureTable::TYPE_INT32,   "base-40 pitch of note" },
+	{ "midi",       HumFeatureTable::TYPE_INT32,   "MIDI key number of note" },
+	{ "interval",   HumFeatureTable::TYPE_INT32,   "semitones from first note of previous attack in layer" },
+	{ "interval40", HumFeatureTable::TYPE_INT32,   "base-40 interval from first note of previous attack in layer" },
+	{ "tie",        HumFeatureTable::TYPE_INT32,   "1 if note is tied to following notes, otherwise 0" },
+	{ "chord",      HumFeatureTable::TYPE_INT32,   "number of notes in chord (1 for single notes)" },
+	{ "lyric",      HumFeatureTable::TYPE_STRING,  "syllable in first **text spine after note's spine" }
+};
+
+
+
+//////////////////////////////
+//
+// HumFeatureExtractor::HumFeatureExtractor -- Constructor.  All features
+//     are extracted by default.
+//
+
+HumFeatureExtractor::HumFeatureExtractor(void) {
+	m_features.resize(FEATURE_COUNT, true);
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureExtractor::setFeatures -- Select the features to extract from
+//     a list of feature names separated by commas or spaces.  An empty list
+//     selects all features.  Returns false if a name is not recognized
+//     (and no change is made in the selection).
+//
+
+bool HumFeatureExtractor::setFeatures(const string& list) {
+	HumRegex hre;
+	vector<string> names;
+	hre.split(names, list, "[,\\s]+");
+	vector<bool> features(FEATURE_COUNT, false);
+	bool found = false;
+	for (int i=0; i<(int)names.size(); i++) {
+		if (names[i].empty()) {
+			continue;
+		}
+		int index = -1;
+		for (int j=0; j<FEATURE_COUNT; j++) {
+			if (names[i] == HumFeatureList[j].name) {
+				index = j;
+				break;
+			}
+		}
+		if (index < 0) {
+			return false;
+		}
+		features[index] = true;
+		found = true;
+	}
+	if (!found) {
+		fill(features.begin(), features.end(), true);
+	}
+	m_features = features;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureExtractor::setFeature -- Turn the extraction of a feature on
+//     or off.
+//
+
+void HumFeatureExtractor::setFeature(Feature feature, bool state) {
+	m_features.at(feature) = state;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureExtractor::isFeature -- Return true if the feature will be
+//     extracted.
+//
+
+bool HumFeatureExtractor::isFeature(Feature feature) const {
+	return m_features.at(feature);
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureExtractor::getFeatureName -- Return the column name for a
+//     feature.
+//
+
+const char* HumFeatureExtractor::getFeatureName(Feature feature) {
+	if ((feature < 0) || (feature >= FEATURE_COUNT)) {
+		return "";
+	}
+	return HumFeatureList[feature].name;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureExtractor::printFeatureList -- Print the name and description
+//     of each feature.
+//
+
+ostream& HumFeatureExtractor::printFeatureList(ostream& out) {
+	for (int i=0; i<FEATURE_COUNT; i++) {
+		out << HumFeatureList[i].name << "\t" << HumFeatureList[i].description << endl;
+	}
+	return out;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureExtractor::prepareTable -- Add a column to the table for each
+//     selected feature (if the table does not already have the column).
+//
+
+void HumFeatureExtractor::prepareTable(HumFeatureTable& table) const {
+	for (int i=0; i<FEATURE_COUNT; i++) {
+		if (m_features[i]) {
+			table.addColumn(HumFeatureList[i].name, HumFeatureList[i].type);
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureExtractor::extract -- Add a row to the table for each note
+//     attack in the file.  If the filename is empty, the name that the file
+//     was read from is used.
+//
+
+void HumFeatureExtractor::extract(HumdrumFile& infile, HumFeatureTable& table,
+		const string& filename) const {
+	prepareTable(table);
+	vector<int> columns(FEATURE_COUNT, -1);
+	for (int i=0; i<FEATURE_COUNT; i++) {
+		if (m_features[i]) {
+			columns[i] = table.getColumnIndex(HumFeatureList[i].name);
+		}
+	}
+
+	// Analyses done once for the file:
+	vector<int> measures;
+	if (m_features[FEATURE_MEASURE]) {
+		measures = infile.getMeasureNumbers();
+	}
+	vector<double> metlevs;
+	if (m_features[FEATURE_METLEV]) {
+		infile.getMetricLevels(metlevs);
+	}
+	vector<pair<int, HumNum>> timesigs;
+	if (m_features[FEATURE_BEAT]) {
+		infile.getTimeSigs(timesigs);
+	}
+	int fileindex = 0;
+	if (m_features[FEATURE_FILE]) {
+		fileindex = table.addString(filename.empty() ? infile.getFilename() : filename);
+	}
+
+	// previous attacked pitch (base-40) in each track/subtrack:
+	map<pair<int, int>, int> previous;
+
+	for (int i=0; i<infile.getLineCount(); i++) {
+		if (!infile[i].isData()) {
+			continue;
+		}
+		HumNum onset  = infile[i].getDurationFromStart();
+		HumNum metpos = infile[i].getDurationFromBarline();
+		for (int j=0; j<infile[i].getFieldCount(); j++) {
+			HTp token = infile.token(i, j);
+			if (!token->isKern() || token->isNull() || token->isRest()) {
+				continue;
+			}
+			int track = token->getTrack();
+			int layer = token->getSubtrack();
+			int count = token->getSubtokenCount();
+			int first = -1;
+			string lyric;
+			bool lyricQ = false;
+			for (int k=0; k<count; k++) {
+				string subtok = token->getSubtoken(k);
+				if ((subtok.find('r') != string::npos) ||
+						(subtok.find('_') != string::npos) ||
+						(subtok.find(']') != string::npos)) {
+					continue;
+				}
+				int base40 = Convert::kernToBase40(subtok);
+				if (base40 < 0) {
+					continue;
+				}
+				bool tieQ = subtok.find('[') != string::npos;
+				if (first < 0) {
+					first = base40;
+				}
+				table.addRow();
+
+				if (columns[FEATURE_FILE] >= 0) {
+					table.setStringIndex(columns[FEATURE_FILE], fileindex);
+				}
+				if (columns[FEATURE_LINE] >= 0) {
+					table.setInt(columns[FEATURE_LINE], i);
+				}
+				if (columns[FEATURE_FIELD] >= 0) {
+					table.setInt(columns[FEATURE_FIELD], j);
+				}
+				if (columns[FEATURE_SUBTOKEN] >= 0) {
+					table.setInt(columns[FEATURE_SUBTOKEN], k);
+				}
+				if (columns[FEATURE_TRACK] >= 0) {
+					table.setInt(columns[FEATURE_TRACK], track);
+				}
+				if (columns[FEATURE_LAYER] >= 0) {
+					table.setInt(columns[FEATURE_LAYER], layer);
+				}
+				if (columns[FEATURE_MEASURE] >= 0) {
+					table.setInt(columns[FEATURE_MEASURE], measures.at(i));
+				}
+				if (columns[FEATURE_ONSET] >= 0) {
+					table.setFloat(columns[FEATURE_ONSET], onset.getFloat());
+				}
+				if (columns[FEATURE_DURATION] >= 0) {
+					HumNum duration = Convert::recipToDuration(subtok);
+					if (tieQ) {
+						duration += getTiedDuration(token, base40);
+					}
+					table.setFloat(columns[FEATURE_DURATION], duration.getFloat());
+				}
+				if (columns[FEATURE_METPOS] >= 0) {
+					table.setFloat(columns[FEATURE_METPOS], metpos.getFloat());
+				}
+				if ((columns[FEATURE_BEAT] >= 0) && (timesigs.at(i).first > 0)) {
+					HumNum beat = metpos * timesigs[i].second / 4 + 1;
+					table.setFloat(columns[FEATURE_BEAT], beat.getFloat());
+				}
+				if (columns[FEATURE_METLEV] >= 0) {
+					table.setFloat(columns[FEATURE_METLEV], metlevs.at(i));
+				}
+				if (columns[FEATURE_KERN] >= 0) {
+					table.setString(columns[FEATURE_KERN], subtok);
+				}
+				if (columns[FEATURE_BASE40] >= 0) {
+					table.setInt(columns[FEATURE_BASE40], base40);
+				}
+				if (columns[FEATURE_MIDI] >= 0) {
+					table.setInt(columns[FEATURE_MIDI], Convert::base40ToMidiNoteNumber(base40));
+				}
+				auto it = previous.find(std::make_pair(track, layer));
+				if (it != previous.end()) {
+					if (columns[FEATURE_INTERVAL] >= 0) {
+						table.setInt(columns[FEATURE_INTERVAL],
+								Convert::base40ToMidiNoteNumber(base40) -
+								Convert::base40ToMidiNoteNumber(it->second));
+					}
+					if (columns[FEATURE_INTERVAL40] >= 0) {
+						table.setInt(columns[FEATURE_INTERVAL40], base40 - it->second);
+					}
+				}
+				if (columns[FEATURE_TIE] >= 0) {
+					table.setInt(columns[FEATURE_TIE], tieQ ? 1 : 0);
+				}
+				if (columns[FEATURE_CHORD] >= 0) {
+					table.setInt(columns[FEATURE_CHORD], count);
+				}
+				if (columns[FEATURE_LYRIC] >= 0) {
+					if (!lyricQ) {
+						lyric = getLyric(token);
+						lyricQ = true;
+					}
+					table.setString(columns[FEATURE_LYRIC], lyric);
+				}
+			}
+			if (first >= 0) {
+				previous[std::make_pair(track, layer)] = first;
+			}
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureExtractor::getTiedDuration -- Return the duration of the
+//     notes tied to a note (not including the duration of the note
+//     itself), following the notes with the same pitch in the chords of
+//     the following tokens in the spine.
+//
+
+HumNum HumFeatureExtractor::getTiedDuration(HTp token, int base40) const {
+	HumNum output = 0;
+	HTp current = token->getNextToken();
+	while (current) {
+		if (!current->isData() || current->isNull()) {
+			current = current->getNextToken();
+			continue;
+		}
+		string match;
+		for (int k=0; k<current->getSubtokenCount(); k++) {
+			string subtok = current->getSubtoken(k);
+			if ((subtok.find('_') == string::npos) && (subtok.find(']') == string::npos)) {
+				continue;
+			}
+			if (Convert::kernToBase40(subtok) == base40) {
+				match = subtok;
+				break;
+			}
+		}
+		if (match.empty()) {
+			// incomplete tie
+			break;
+		}
+		output += Convert::recipToDuration(match);
+		if (match.find(']') != string::npos) {
+			break;
+		}
+		current = current->getNextToken();
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureExtractor::getLyric -- Return the syllable in the first
+//     **text (or **silbe/**sylb) spine to the right of the token's spine
+//     (skipping other layers of the spine), or an empty string if there is
+//     no syllable on the token's line.
+//
+
+string HumFeatureExtractor::getLyric(HTp token) const {
+	int track = token->getTrack();
+	HTp current = token->getNextFieldToken();
+	while (current && ((current->getTrack() == track) || !current->isKernLike())) {
+		if (current->isDataType("**text") || current->isDataType("**silbe") ||
+				current->isDataType("**sylb")) {
+			return current->isNull() ? "" : (string)*current;
+		}
+		current = current->getNextFieldToken();
+	}
+	return "";
+}
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
@@ -0,0 +1,829 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 19:52:07 PDT 2026
+// Last Modified: Sun Oct 18 23:59:59 PDT 2026
+// Filename:      HumFeatureTable.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumFeatureTable.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Columnar storage of features, and reading/writing of the
+//                binary feature file format.
+//
+
+#include "HumFeatureTable.h"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+
+//////////////////////////////
+//
+// HumFeatureTable::HumFeatureTable -- Constructor.
+//
+
+HumFeatureTable::HumFeatureTable(void) {
+	clear();
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::clear -- Remove all columns, rows and strings.
+//
+
+void HumFeatureTable::clear(void) {
+	m_columns.clear();
+	clearRows();
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::clearRows -- Remove all rows and strings, but keep
+//     the columns.
+//
+
+void HumFeatureTable::clearRows(void) {
+	for (int i=0; i<(int)m_columns.size(); i++) {
+		m_columns[i].ints.clear();
+		m_columns[i].floats.clear();
+	}
+	m_strings.clear();
+	m_stringIds.clear();
+	m_rows = 0;
+	addString("");
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::addColumn -- Add a column, or return the index of an
+//     existing column with the same name and type.  Existing rows are
+//     given missing values in a new column.  Returns -1 if there is a
+//     column with the same name but a different type, or if the name is
+//     empty or longer than MAX_NAME_SIZE characters.
+//
+
+int HumFeatureTable::addColumn(const string& name, ColumnType type) {
+	int index = getColumnIndex(name);
+	if (index >= 0) {
+		return m_columns[index].type == type ? index : -1;
+	}
+	if (name.empty() || ((int)name.size() > MAX_NAME_SIZE)) {
+		return -1;
+	}
+	m_columns.emplace_back();
+	Column& column = m_columns.back();
+	column.name = name;
+	column.type = type;
+	if (type == TYPE_FLOAT64) {
+		column.floats.resize(m_rows, NAN);
+	} else {
+		column.ints.resize(m_rows, type == TYPE_STRING ? 0 : MISSING_INT);
+	}
+	return (int)m_columns.size() - 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getColumnCount --
+//
+
+int HumFeatureTable::getColumnCount(void) const {
+	return (int)m_columns.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getColumnIndex -- Return -1 if there is no column
+//     with the given name.
+//
+
+int HumFeatureTable::getColumnIndex(const string& name) const {
+	for (int i=0; i<(int)m_columns.size(); i++) {
+		if (m_columns[i].name == name) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getColumnName --
+//
+
+const string& HumFeatureTable::getColumnName(int column) const {
+	return m_columns.at(column).name;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getColumnType --
+//
+
+HumFeatureTable::ColumnType HumFeatureTable::getColumnType(int column) const {
+	return m_columns.at(column).type;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getRowCount --
+//
+
+int64_t HumFeatureTable::getRowCount(void) const {
+	return m_rows;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::addRow -- Add a row with missing values (or empty
+//     strings) in each column.  The set functions fill in the last row.
+//
+
+void HumFeatureTable::addRow(void) {
+	for (int i=0; i<(int)m_columns.size(); i++) {
+		Column& column = m_columns[i];
+		if (column.type == TYPE_FLOAT64) {
+			column.floats.push_back(NAN);
+		} else {
+			column.ints.push_back(column.type == TYPE_STRING ? 0 : MISSING_INT);
+		}
+	}
+	m_rows++;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::setInt -- Set a value in the last row of an integer
+//     column.
+//
+
+void HumFeatureTable::setInt(int column, int32_t value) {
+	m_columns.at(column).ints.back() = value;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::setFloat -- Set a value in the last row of a float
+//     column.
+//
+
+void HumFeatureTable::setFloat(int column, double value) {
+	m_columns.at(column).floats.back() = value;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::setString -- Set a value in the last row of a string
+//     column, adding the string to the dictionary if necessary.
+//
+
+void HumFeatureTable::setString(int column, const string& value) {
+	m_columns.at(column).ints.back() = addString(value);
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::setStringIndex -- Set a value in the last row of a
+//     string column to a string already in the dictionary.  This avoids
+//     looking up strings (such as a filename) which are the same for many
+//     rows.
+//
+
+void HumFeatureTable::setStringIndex(int column, int32_t index) {
+	m_columns.at(column).ints.back() = index;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getInt --
+//
+
+int32_t HumFeatureTable::getInt(int64_t row, int column) const {
+	return m_columns.at(column).ints.at(row);
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getFloat --
+//
+
+double HumFeatureTable::getFloat(int64_t row, int column) const {
+	return m_columns.at(column).floats.at(row);
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getString --
+//
+
+const string& HumFeatureTable::getString(int64_t row, int column) const {
+	return m_strings.at(m_columns.at(column).ints.at(row));
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getIntColumn -- Return the values of an integer column,
+//     or the dictionary indexes of a string column.
+//
+
+const int32_t* HumFeatureTable::getIntColumn(int column) const {
+	return m_columns.at(column).ints.data();
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getFloatColumn --
+//
+
+const double* HumFeatureTable::getFloatColumn(int column) const {
+	return m_columns.at(column).floats.data();
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::addString -- Return the dictionary index of a string,
+//     adding it to the dictionary if it is not already there.
+//
+
+int HumFeatureTable::addString(const string& value) {
+	auto it = m_stringIds.find(value);
+	if (it != m_stringIds.end()) {
+		return it->second;
+	}
+	int index = (int)m_strings.size();
+	m_strings.push_back(value);
+	m_stringIds[value] = index;
+	return index;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getStringCount -- Return the size of the string
+//     dictionary.
+//
+
+int HumFeatureTable::getStringCount(void) const {
+	return (int)m_strings.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::getDictionaryString --
+//
+
+const string& HumFeatureTable::getDictionaryString(int index) const {
+	return m_strings.at(index);
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::append -- Add the rows of another table, such as the
+//     table for another file.  If this table has no columns, the columns
+//     of the other table are used.  Returns false if the tables do not have
+//     the same columns.
+//
+
+bool HumFeatureTable::append(const HumFeatureTable& other) {
+	if (m_columns.empty() && (m_rows == 0)) {
+		for (int i=0; i<(int)other.m_columns.size(); i++) {
+			addColumn(other.m_columns[i].name, other.m_columns[i].type);
+		}
+	}
+	if (m_columns.size() != other.m_columns.size()) {
+		return false;
+	}
+	for (int i=0; i<(int)m_columns.size(); i++) {
+		if ((m_columns[i].name != other.m_columns[i].name) ||
+				(m_columns[i].type != other.m_columns[i].type)) {
+			return false;
+		}
+	}
+
+	vector<int32_t> stringmap(other.m_strings.size());
+	for (int i=0; i<(int)other.m_strings.size(); i++) {
+		stringmap[i] = addString(other.m_strings[i]);
+	}
+
+	for (int i=0; i<(int)m_columns.size(); i++) {
+		Column& column = m_columns[i];
+		const Column& source = other.m_columns[i];
+		if (column.type == TYPE_FLOAT64) {
+			column.floats.insert(column.floats.end(), source.floats.begin(),
+					source.floats.end());
+		} else if (column.type == TYPE_STRING) {
+			column.ints.reserve(column.ints.size() + source.ints.size());
+			for (int32_t index : source.ints) {
+				column.ints.push_back(stringmap.at(index));
+			}
+		} else {
+			column.ints.insert(column.ints.end(), source.ints.begin(),
+					source.ints.end());
+		}
+	}
+	m_rows += other.m_rows;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::write -- Write the table in the binary format described
+//     in HumFeatureTable.h.
+//
+
+bool HumFeatureTable::write(ostream& out) const {
+	auto padding = [](uint64_t size) { return (8 - size % 8) % 8; };
+	const char zeros[8] = {0};
+
+	uint64_t textsize = 0;
+	for (int i=0; i<(int)m_strings.size(); i++) {
+		textsize += m_strings[i].size() + 1;
+	}
+	uint64_t offset = 40 + 48 * m_columns.size();
+	offset += 8 * (m_strings.size() + 1);
+	offset += textsize + padding(textsize);
+
+	char header[40] = {0};
+	memcpy(header, "HUMFEAT1", 8);
+	uint32_t bom = 0x01020304;
+	uint32_t columncount = (uint32_t)m_columns.size();
+	uint32_t stringcount = (uint32_t)m_strings.size();
+	memcpy(header + 8,  &bom,         4);
+	memcpy(header + 12, &columncount, 4);
+	memcpy(header + 16, &stringcount, 4);
+	memcpy(header + 24, &m_rows,      8);
+	memcpy(header + 32, &textsize,    8);
+	out.write(header, sizeof(header));
+
+	for (int i=0; i<(int)m_columns.size(); i++) {
+		char descriptor[48] = {0};
+		const Column& column = m_columns[i];
+		memcpy(descriptor, column.name.data(), column.name.size());
+		uint32_t type = (uint32_t)column.type;
+		memcpy(descriptor + 32, &type,   4);
+		memcpy(descriptor + 40, &offset, 8);
+		out.write(descriptor, sizeof(descriptor));
+		uint64_t size = m_rows * (column.type == TYPE_FLOAT64 ? 8 : 4);
+		offset += size + padding(size);
+	}
+
+	uint64_t position = 0;
+	for (int i=0; i<=(int)m_strings.size(); i++) {
+		out.write((const char*)&position, 8);
+		if (i < (int)m_strings.size()) {
+			position += m_strings[i].size() + 1;
+		}
+	}
+	for (int i=0; i<(int)m_strings.size(); i++) {
+		out.write(m_strings[i].c_str(), m_strings[i].size() + 1);
+	}
+	out.write(zeros, padding(textsize));
+
+	for (int i=0; i<(int)m_columns.size(); i++) {
+		const Column& column = m_columns[i];
+		uint64_t size;
+		if (column.type == TYPE_FLOAT64) {
+			size = column.floats.size() * 8;
+			out.write((const char*)column.floats.data(), size);
+		} else {
+			size = column.ints.size() * 4;
+			out.write((const char*)column.ints.data(), size);
+		}
+		out.write(zeros, padding(size));
+	}
+
+	return out.good();
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::writeFile --
+//
+
+bool HumFeatureTable::writeFile(const string& filename) const {
+	std::ofstream output(filename, std::ios::binary);
+	if (!output.is_open()) {
+		return false;
+	}
+	return write(output);
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::read -- Copy a table from data in the binary format.
+//     Returns false if the data is not a valid table.
+//
+
+bool HumFeatureTable::read(const char* data, size_t size) {
+	clear();
+	HumFeatureView view;
+	if (!view.open(data, size) || (view.getDictionaryString(0)[0] != '\0')) {
+		return false;
+	}
+	for (int i=1; i<view.getStringCount(); i++) {
+		addString(view.getDictionaryString(i));
+	}
+	if (getStringCount() != view.getStringCount()) {
+		// duplicate strings in the dictionary
+		clear();
+		return false;
+	}
+	m_rows = view.getRowCount();
+	for (int i=0; i<view.getColumnCount(); i++) {
+		m_columns.emplace_back();
+		Column& column = m_columns.back();
+		column.name = view.getColumnName(i);
+		column.type = view.getColumnType(i);
+		if (column.type == TYPE_FLOAT64) {
+			const double* values = view.getFloatColumn(i);
+			column.floats.assign(values, values + m_rows);
+		} else {
+			const int32_t* values = view.getIntColumn(i);
+			column.ints.assign(values, values + m_rows);
+		}
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::readFile --
+//
+
+bool HumFeatureTable::readFile(const string& filename) {
+	ifstream input(filename, std::ios::binary | std::ios::ate);
+	if (!input.is_open()) {
+		return false;
+	}
+	size_t size = (size_t)input.tellg();
+	input.seekg(0);
+	// uint64_t storage keeps the columns aligned:
+	vector<uint64_t> buffer((size + 7) / 8);
+	input.read((char*)buffer.data(), size);
+	if (!input) {
+		return false;
+	}
+	return read((const char*)buffer.data(), size);
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureTable::printTsv -- Print the table as tab-separated values
+//     with a header line of column names.  Missing values are empty.
+//
+
+ostream& HumFeatureTable::printTsv(ostream& out) const {
+	for (int i=0; i<(int)m_columns.size(); i++) {
+		if (i > 0) {
+			out << '\t';
+		}
+		out << m_columns[i].name;
+	}
+	out << '\n';
+	std::streamsize precision = out.precision(15);
+	for (int64_t r=0; r<m_rows; r++) {
+		for (int i=0; i<(int)m_columns.size(); i++) {
+			if (i > 0) {
+				out << '\t';
+			}
+			const Column& column = m_columns[i];
+			if (column.type == TYPE_FLOAT64) {
+				if (!std::isnan(column.floats[r])) {
+					out << column.floats[r];
+				}
+			} else if (column.type == TYPE_STRING) {
+				out << m_strings[column.ints[r]];
+			} else if (column.ints[r] != MISSING_INT) {
+				out << column.ints[r];
+			}
+		}
+		out << '\n';
+	}
+	out.precision(precision);
+	return out;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::HumFeatureView -- Constructor.
+//
+
+HumFeatureView::HumFeatureView(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::open -- Check that the data is a valid feature table,
+//     and prepare to read it.  Returns false if the data is not valid.
+//
+
+bool HumFeatureView::open(const char* data, size_t size) {
+	close();
+	if ((data == NULL) || (size < 40) || ((uintptr_t)data % 8 != 0)) {
+		return false;
+	}
+	if (memcmp(data, "HUMFEAT1", 8) != 0) {
+		return false;
+	}
+	uint32_t bom;
+	uint32_t columncount;
+	uint32_t stringcount;
+	int64_t rows;
+	uint64_t textsize;
+	memcpy(&bom,         data + 8,  4);
+	memcpy(&columncount, data + 12, 4);
+	memcpy(&stringcount, data + 16, 4);
+	memcpy(&rows,        data + 24, 8);
+	memcpy(&textsize,    data + 32, 8);
+	if ((bom != 0x01020304) || (rows < 0) || (stringcount < 1)) {
+		return false;
+	}
+
+	uint64_t offsets = 40 + 48 * (uint64_t)columncount;
+	uint64_t text = offsets + 8 * ((uint64_t)stringcount + 1);
+	if ((text > size) || (textsize > size - text)) {
+		return false;
+	}
+	const uint64_t* stringoffsets = (const uint64_t*)(data + offsets);
+	for (uint32_t i=0; i<=stringcount; i++) {
+		if ((stringoffsets[i] > textsize) ||
+				((i > 0) && (stringoffsets[i] <= stringoffsets[i-1]))) {
+			return false;
+		}
+	}
+	if ((stringoffsets[0] != 0) || (stringoffsets[stringcount] != textsize) ||
+			(data[text + textsize - 1] != '\0')) {
+		return false;
+	}
+
+	for (uint32_t i=0; i<columncount; i++) {
+		const char* descriptor = data + 40 + 48 * i;
+		if (memchr(descriptor, '\0', 32) == NULL) {
+			return false;
+		}
+		uint32_t type;
+		uint64_t offset;
+		memcpy(&type,   descriptor + 32, 4);
+		memcpy(&offset, descriptor + 40, 8);
+		if ((type < HumFeatureTable::TYPE_INT32) || (type > HumFeatureTable::TYPE_STRING)) {
+			return false;
+		}
+		uint64_t width = (type == HumFeatureTable::TYPE_FLOAT64) ? 8 : 4;
+		if ((offset % 8 != 0) || (offset > size) ||
+				((uint64_t)rows > (size - offset) / width)) {
+			return false;
+		}
+		if (type == HumFeatureTable::TYPE_STRING) {
+			const int32_t* values = (const int32_t*)(data + offset);
+			for (int64_t r=0; r<rows; r++) {
+				if ((values[r] < 0) || ((uint32_t)values[r] >= stringcount)) {
+					return false;
+				}
+			}
+		}
+	}
+
+	m_data          = data;
+	m_size          = size;
+	m_columnCount   = (int)columncount;
+	m_stringCount   = (int)stringcount;
+	m_rows          = rows;
+	m_stringOffsets = stringoffsets;
+	m_stringText    = data + text;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::close -- Stop using the data (which is not freed).
+//
+
+void HumFeatureView::close(void) {
+	m_data          = NULL;
+	m_size          = 0;
+	m_columnCount   = 0;
+	m_stringCount   = 0;
+	m_rows          = 0;
+	m_stringOffsets = NULL;
+	m_stringText    = NULL;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::isOpen --
+//
+
+bool HumFeatureView::isOpen(void) const {
+	return m_data != NULL;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::getColumnCount --
+//
+
+int HumFeatureView::getColumnCount(void) const {
+	return m_columnCount;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::getColumnIndex -- Return -1 if there is no column with
+//     the given name.
+//
+
+int HumFeatureView::getColumnIndex(const string& name) const {
+	for (int i=0; i<m_columnCount; i++) {
+		if (name == getColumnName(i)) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::getColumnName --
+//
+
+const char* HumFeatureView::getColumnName(int column) const {
+	return m_data + 40 + 48 * column;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::getColumnType --
+//
+
+HumFeatureTable::ColumnType HumFeatureView::getColumnType(int column) const {
+	uint32_t type;
+	memcpy(&type, m_data + 40 + 48 * column + 32, 4);
+	return (HumFeatureTable::ColumnType)type;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::getRowCount --
+//
+
+int64_t HumFeatureView::getRowCount(void) const {
+	return m_rows;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::getColumnData -- Return the start of the array for a
+//     column.
+//
+
+const char* HumFeatureView::getColumnData(int column) const {
+	uint64_t offset;
+	memcpy(&offset, m_data + 40 + 48 * column + 40, 8);
+	return m_data + offset;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::getIntColumn -- Return the values of an integer column,
+//     or the dictionary indexes of a string column.
+//
+
+const int32_t* HumFeatureView::getIntColumn(int column) const {
+	return (const int32_t*)getColumnData(column);
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::getFloatColumn --
+//
+
+const double* HumFeatureView::getFloatColumn(int column) const {
+	return (const double*)getColumnData(column);
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::getStringCount -- Return the size of the string
+//     dictionary.
+//
+
+int HumFeatureView::getStringCount(void) const {
+	return m_stringCount;
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::getDictionaryString --
+//
+
+const char* HumFeatureView::getDictionaryString(int index) const {
+	return m_stringText + m_stringOffsets[index];
+}
+
+
+
+//////////////////////////////
+//
+// HumFeatureView::getString -- Return a value in a string column.
+//
+
+const char* HumFeatureView::getString(int64_t row, int column) const {
+	return getDictionaryString(getIntColumn(column)[row]);
+}
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Nov 25 14:18:01 PST 2000
-// Last Modified: Fri Sep  2 10:16:09 CEST 2016 (added to humlib)
+// Last Modified: Sun Oct 18 23:59:59 PDT 2026
 // Filename:      HumInstrument.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumInstrument.cpp
 // Syntax:        C++11; humlib
@@ -13,6 +13,7 @@
 
 #include "HumInstrument.h"
 
+#include <algorithm>
 #include <cstring>
 
 using namespace std;
@@ -21,11 +22,258 @@ namespace hum {
 
 // START_MERGE
 
-typedef unsigned long long TEMP64BITFIX;
 
-// declare static variables
-vector<_HumInstrument> HumInstrument::m_data;
-int HumInstrument::m_classcount = 0;
+// _HumInstrumentEntry: storage for the instrument table.  The public
+// _HumInstrument class (with string members) is returned by getInstrument().
+
+struct _HumInstrumentEntry {
+	const char* humdrum;  // instrument code (without the *I prefix)
+	int         gm;       // General MIDI instrument number
+	const char* name;     // English name of the instrument
+};
+
+// Humdrum instrument codes, sorted by code (in strcmp() order) so that they
+// can be found with a binary search:
+
+static constexpr _HumInstrumentEntry HumInstrumentTable[] = {
+	{ "accor",   GM_ACCORDION,              "accordion" },
+	{ "alto",    GM_RECORDER,               "alto" },
+	{ "anvil",   GM_TINKLE_BELL,            "anvil" },
+	{ "archl",   GM_ACOUSTIC_GUITAR_NYLON,  "archlute" },
+	{ "armon",   GM_HARMONICA,              "harmonica" },
+	{ "arpa",    GM_ORCHESTRAL_HARP,        "harp" },
+	{ "bagpI",   GM_BAGPIPE,                "bagpipe (Irish)" },
+	{ "bagpS",   GM_BAGPIPE,                "bagpipe (Scottish)" },
+	{ "banjo",   GM_BANJO,                  "banjo" },
+	{ "bansu",   GM_FLUTE,                  "bansuri" },
+	{ "barit",   GM_CHOIR_AAHS,             "baritone" },
+	{ "baset",   GM_CLARINET,               "bassett horn" },
+	{ "bass",    GM_CHOIR_AAHS,             "bass" },
+	{ "bdrum",   GM_TAIKO_DRUM,             "bass drum" },
+	{ "bguit",   GM_ELECTRIC_BASS_FINGER,   "electric bass guitar" },
+	{ "biwa",    GM_FLUTE,                  "biwa" },
+	{ "bongo",   GM_TAIKO_DRUM,             "bongo" },
+	{ "brush",   GM_BREATH_NOISE,           "brush" },
+	{ "bscan",   GM_CHOIR_AAHS,             "basso cantante" },
+	{ "bspro",   GM_CHOIR_AAHS,             "basso profondo" },
+	{ "bugle",   GM_TRUMPET,                "bugle" },
+	{ "calam",   GM_OBOE,                   "chalumeau" },
+	{ "calpe",   GM_LEAD_CALLIOPE,          "calliope" },
+	{ "calto",   GM_CHOIR_AAHS,             "contralto" },
+	{ "campn",   GM_TUBULAR_BELLS,          "bell" },
+	{ "cangl",   GM_ENGLISH_HORN,           "english horn" },
+	{ "canto",   GM_CHOIR_AAHS,             "canto" },
+	{ "caril",   GM_TUBULAR_BELLS,          "carillon" },
+	{ "castr",   GM_CHOIR_AAHS,             "castrato" },
+	{ "casts",   GM_WOODBLOCKS,             "castanets" },
+	{ "cbass",   GM_CONTRABASS,             "contrabass" },
+	{ "cello",   GM_CELLO,                  "violoncello" },
+	{ "cemba",   GM_HARPSICHORD,            "harpsichord" },
+	{ "cetra",   GM_VIOLIN,                 "cittern" },
+	{ "chain",   GM_TINKLE_BELL,            "chains" },
+	{ "chcym",   GM_REVERSE_CYMBAL,         "China cymbal" },
+	{ "chime",   GM_TUBULAR_BELLS,          "chimes" },
+	{ "chlma",   GM_BASSOON,                "alto shawm" },
+	{ "chlms",   GM_BASSOON,                "soprano shawm" },
+	{ "chlmt",   GM_BASSOON,                "tenor shawm" },
+	{ "clap",    GM_GUNSHOT,                "hand clapping" },
+	{ "clara",   GM_CLARINET,               "alto clarinet" },
+	{ "clarb",   GM_CLARINET,               "bass clarinet" },
+	{ "clarp",   GM_CLARINET,               "piccolo clarinet" },
+	{ "clars",   GM_CLARINET,               "clarinet" },
+	{ "clave",   GM_AGOGO,                  "claves" },
+	{ "clavi",   GM_CLAVI,                  "clavichord" },
+	{ "clest",   GM_CELESTA,                "celesta" },
+	{ "clrno",   GM_TRUMPET,                "clarino" },
+	{ "colsp",   GM_FLUTE,                  "coloratura soprano" },
+	{ "conga",   GM_TAIKO_DRUM,             "conga" },
+	{ "cor",     GM_FRENCH_HORN,            "horn" },
+	{ "cornm",   GM_BAGPIPE,                "French bagpipe" },
+	{ "corno",   GM_TRUMPET,                "cornett" },
+	{ "cornt",   GM_TRUMPET,                "cornet" },
+	{ "coro",    GM_CHOIR_AAHS,             "chorus" },
+	{ "crshc",   GM_REVERSE_CYMBAL,         "crash cymbal" },
+	{ "ctenor",  GM_CHOIR_AAHS,             "counter-tenor" },
+	{ "ctina",   GM_ACCORDION,              "concertina" },
+	{ "drmsp",   GM_FLUTE,                  "dramatic soprano" },
+	{ "drum",    GM_SYNTH_DRUM,             "drum" },
+	{ "drumP",   GM_SYNTH_DRUM,             "small drum" },
+	{ "dulc",    GM_DULCIMER,               "dulcimer" },
+	{ "eguit",   GM_ELECTRIC_GUITAR_CLEAN,  "electric guitar" },
+	{ "fag_c",   GM_BASSOON,                "contrabassoon" },
+	{ "fagot",   GM_BASSOON,                "bassoon" },
+	{ "false",   GM_RECORDER,               "falsetto" },
+	{ "fdrum",   GM_TAIKO_DRUM,             "frame drum" },
+	{ "feme",    GM_CHOIR_AAHS,             "female voice" },
+	{ "fife",    GM_BLOWN_BOTTLE,           "fife" },
+	{ "fingc",   GM_REVERSE_CYMBAL,         "finger cymbal" },
+	{ "flt",     GM_FLUTE,                  "flute" },
+	{ "flt_a",   GM_FLUTE,                  "alto flute" },
+	{ "flt_b",   GM_FLUTE,                  "bass flute" },
+	{ "fltda",   GM_RECORDER,               "alto recorder" },
+	{ "fltdb",   GM_RECORDER,               "bass recorder" },
+	{ "fltdn",   GM_RECORDER,               "sopranino recorder" },
+	{ "fltds",   GM_RECORDER,               "soprano recorder" },
+	{ "fltdt",   GM_RECORDER,               "tenor recorder" },
+	{ "flugh",   GM_FRENCH_HORN,            "flugelhorn" },
+	{ "forte",   GM_HONKYTONK_PIANO,        "fortepiano" },
+	{ "gen",     GM_ACOUSTIC_GRAND_PIANO,   "generic instrument" },
+	{ "genB",    GM_ACOUSTIC_GRAND_PIANO,   "generic bass instrument" },
+	{ "genT",    GM_ACOUSTIC_GRAND_PIANO,   "generic treble instrument" },
+	{ "glock",   GM_GLOCKENSPIEL,           "glockenspiel" },
+	{ "gong",    GM_REVERSE_CYMBAL,         "gong" },
+	{ "guitr",   GM_ACOUSTIC_GUITAR_NYLON,  "guitar" },
+	{ "hammd",   GM_DRAWBAR_ORGAN,          "Hammond electronic organ" },
+	{ "hbell",   GM_TINKLE_BELL,            "handbell" },
+	{ "heck",    GM_BASSOON,                "heckelphone" },
+	{ "heltn",   GM_CHOIR_AAHS,             "Heldentenor" },
+	{ "hichi",   GM_OBOE,                   "hichiriki" },
+	{ "hurdy",   GM_LEAD_CALLIOPE,          "hurdy-gurdy" },
+	{ "kitv",    GM_VIOLIN,                 "kit violin" },
+	{ "klav",    GM_ACOUSTIC_GRAND_PIANO,   "keyboard" },
+	{ "kokyu",   GM_FIDDLE,                 "kokyu" },
+	{ "komun",   GM_KOTO,                   "komun'go" },
+	{ "koto",    GM_KOTO,                   "koto" },
+	{ "kruma",   GM_TRUMPET,                "alto crumhorn" },
+	{ "krumb",   GM_TRUMPET,                "bass crumhorn" },
+	{ "krums",   GM_TRUMPET,                "soprano crumhorn" },
+	{ "krumt",   GM_TRUMPET,                "tenor crumhorn" },
+	{ "lion",    GM_AGOGO,                  "lion's roar" },
+	{ "liuto",   GM_ACOUSTIC_GUITAR_NYLON,  "lute" },
+	{ "lyrsp",   GM_FLUTE,                  "lyric soprano" },
+	{ "lyrtn",   GM_FRENCH_HORN,            "lyric tenor" },
+	{ "male",    GM_CHOIR_AAHS,             "male voice" },
+	{ "mando",   GM_ACOUSTIC_GUITAR_NYLON,  "mandolin" },
+	{ "marac",   GM_AGOGO,                  "maracas" },
+	{ "marim",   GM_MARIMBA,                "marimba" },
+	{ "mbari",   GM_CHOIR_AAHS,             "high baritone" },
+	{ "mezzo",   GM_CHOIR_AAHS,             "mezzo soprano" },
+	{ "nfant",   GM_CHOIR_AAHS,             "child's voice" },
+	{ "nokan",   GM_SHAKUHACHI,             "nokan" },
+	{ "oboe",    GM_OBOE,                   "oboe" },
+	{ "oboeD",   GM_ENGLISH_HORN,           "oboe d'amore" },
+	{ "ocari",   GM_OCARINA,                "ocarina" },
+	{ "ondes",   GM_PAD_SWEEP,              "ondes Martenot" },
+	{ "ophic",   GM_TUBA,                   "ophicleide" },
+	{ "organ",   GM_CHURCH_ORGAN,           "pipe organ" },
+	{ "oud",     GM_ACOUSTIC_GUITAR_NYLON,  "oud" },
+	{ "paila",   GM_AGOGO,                  "timbales" },
+	{ "panpi",   GM_PAN_FLUTE,              "panpipe" },
+	{ "pbell",   GM_TUBULAR_BELLS,          "bell plate" },
+	{ "pguit",   GM_ACOUSTIC_GUITAR_NYLON,  "Portuguese guitar" },
+	{ "physh",   GM_REED_ORGAN,             "physharmonica" },
+	{ "piano",   GM_ACOUSTIC_GRAND_PIANO,   "pianoforte" },
+	{ "piatt",   GM_REVERSE_CYMBAL,         "cymbals" },
+	{ "picco",   GM_PICCOLO,                "piccolo" },
+	{ "pipa",    GM_ACOUSTIC_GUITAR_NYLON,  "Chinese lute" },
+	{ "porta",   GM_TANGO_ACCORDION,        "portative organ" },
+	{ "psalt",   GM_CLAVI,                  "psaltery" },
+	{ "qin",     GM_CLAVI,                  "qin" },
+	{ "quinto",  GM_CHOIR_AAHS,             "quinto" },
+	{ "quitr",   GM_ACOUSTIC_GUITAR_NYLON,  "gittern" },
+	{ "rackt",   GM_TRUMPET,                "racket" },
+	{ "ratl",    GM_WOODBLOCKS,             "rattle" },
+	{ "rebec",   GM_ACOUSTIC_GUITAR_NYLON,  "rebec" },
+	{ "recit",   GM_CHOIR_AAHS,             "recitativo" },
+	{ "reedo",   GM_REED_ORGAN,             "reed organ" },
+	{ "rhode",   GM_ELECTRIC_PIANO_1,       "Fender-Rhodes electric piano" },
+	{ "ridec",   GM_REVERSE_CYMBAL,         "ride cymbal" },
+	{ "sarod",   GM_SITAR,                  "sarod" },
+	{ "sarus",   GM_TUBA,                   "sarrusophone" },
+	{ "saxA",    GM_ALTO_SAX,               "alto saxophone" },
+	{ "saxB",    GM_BARITONE_SAX,           "bass saxophone" },
+	{ "saxC",    GM_BARITONE_SAX,           "contrabass saxophone" },
+	{ "saxN",    GM_SOPRANO_SAX,            "sopranino saxophone" },
+	{ "saxR",    GM_BARITONE_SAX,           "baritone saxophone" },
+	{ "saxS",    GM_SOPRANO_SAX,            "soprano saxophone" },
+	{ "saxT",    GM_TENOR_SAX,              "tenor saxophone" },
+	{ "sbell",   GM_TINKLE_BELL,            "sleigh bells" },
+	{ "sdrum",   GM_SYNTH_DRUM,             "snare drum (kit)" },
+	{ "shaku",   GM_SHAKUHACHI,             "shakuhachi" },
+	{ "shami",   GM_SHAMISEN,               "shamisen" },
+	{ "sheng",   GM_SHANAI,                 "sheng" },
+	{ "sho",     GM_SHANAI,                 "sho" },
+	{ "siren",   GM_FX_SCI_FI,              "siren" },
+	{ "sitar",   GM_SITAR,                  "sitar" },
+	{ "slap",    GM_GUNSHOT,                "slapstick" },
+	{ "soprn",   GM_CHOIR_AAHS,             "soprano" },
+	{ "spshc",   GM_REVERSE_CYMBAL,         "splash cymbal" },
+	{ "steel",   GM_STEEL_DRUMS,            "steel-drum" },
+	{ "stim",    GM_SEASHORE,               "Sprechstimme" },
+	{ "stimA",   GM_SEASHORE,               "Sprechstimme, alto" },
+	{ "stimB",   GM_SEASHORE,               "Sprechstimme, bass" },
+	{ "stimC",   GM_SEASHORE,               "Sprechstimme, contralto" },
+	{ "stimR",   GM_SEASHORE,               "Sprechstimme, baritone" },
+	{ "stimS",   GM_SEASHORE,               "Sprechstimme, soprano" },
+	{ "strdr",   GM_AGOGO,                  "string drum" },
+	{ "sxhA",    GM_ALTO_SAX,               "alto saxhorn" },
+	{ "sxhB",    GM_BARITONE_SAX,           "bass saxhorn" },
+	{ "sxhC",    GM_BARITONE_SAX,           "contrabass saxhorn" },
+	{ "sxhR",    GM_BARITONE_SAX,           "baritone saxhorn" },
+	{ "sxhS",    GM_SOPRANO_SAX,            "soprano saxhorn" },
+	{ "sxhT",    GM_TENOR_SAX,              "tenor saxhorn" },
+	{ "synth",   GM_ELECTRIC_PIANO_2,       "keyboard synthesizer" },
+	{ "tabla",   GM_MELODIC_DRUM,           "tabla" },
+	{ "tambn",   GM_TINKLE_BELL,            "tambourine" },
+	{ "tambu",   GM_MELODIC_DRUM,           "tambura" },
+	{ "tanbr",   GM_MELODIC_DRUM,           "tanbur" },
+	{ "tblok",   GM_WOODBLOCKS,             "temple blocks" },
+	{ "tdrum",   GM_SYNTH_DRUM,             "tenor drum" },
+	{ "tenor",   GM_CHOIR_AAHS,             "tenor" },
+	{ "timpa",   GM_MELODIC_DRUM,           "timpani" },
+	{ "tiorb",   GM_ACOUSTIC_GUITAR_NYLON,  "theorbo" },
+	{ "tom",     GM_TAIKO_DRUM,             "tom-tom drum" },
+	{ "trngl",   GM_TINKLE_BELL,            "triangle" },
+	{ "tromb",   GM_TROMBONE,               "bass trombone" },
+	{ "tromp",   GM_TRUMPET,                "trumpet" },
+	{ "tromt",   GM_TROMBONE,               "tenor trombone" },
+	{ "tuba",    GM_TUBA,                   "tuba" },
+	{ "tubaB",   GM_TUBA,                   "bass tuba" },
+	{ "tubaC",   GM_TUBA,                   "contrabass tuba" },
+	{ "tubaT",   GM_TUBA,                   "tenor tuba" },
+	{ "tubaU",   GM_TUBA,                   "subcontra tuba" },
+	{ "ukule",   GM_ACOUSTIC_GUITAR_NYLON,  "ukulele" },
+	{ "vibra",   GM_VIBRAPHONE,             "vibraphone" },
+	{ "vina",    GM_SITAR,                  "vina" },
+	{ "viola",   GM_VIOLA,                  "viola" },
+	{ "violb",   GM_CONTRABASS,             "bass viola da gamba" },
+	{ "viold",   GM_VIOLA,                  "viola d'amore" },
+	{ "violn",   GM_VIOLIN,                 "violin" },
+	{ "violp",   GM_VIOLIN,                 "piccolo violin" },
+	{ "viols",   GM_VIOLIN,                 "treble viola da gamba" },
+	{ "violt",   GM_CELLO,                  "tenor viola da gamba" },
+	{ "vox",     GM_CHOIR_AAHS,             "generic voice" },
+	{ "wblok",   GM_WOODBLOCKS,             "woodblock" },
+	{ "xylo",    GM_XYLOPHONE,              "xylophone" },
+	{ "zithr",   GM_CLAVI,                  "zither" },
+	{ "zurna",   GM_ACOUSTIC_GUITAR_NYLON,  "zurna" }
+};
+
+
+static constexpr int HumInstrumentCount =
+		(int)(sizeof(HumInstrumentTable) / sizeof(HumInstrumentTable[0]));
+
+
+// isSortedInstrumentTable: used to check at compile time that the
+// instrument table is sorted and has no duplicate codes.
+
+static constexpr bool isSortedInstrumentTable(void) {
+	for (int i=1; i<HumInstrumentCount; i++) {
+		const char* a = HumInstrumentTable[i-1].humdrum;
+		const char* b = HumInstrumentTable[i].humdrum;
+		while ((*a != '\0') && (*a == *b)) {
+			a++;
+			b++;
+		}
+		if ((unsigned char)*a >= (unsigned char)*b) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static_assert(isSortedInstrumentTable(), "HumInstrumentTable must be sorted by code");
+
 
 
 //////////////////////////////
@@ -34,10 +282,6 @@ int HumInstrument::m_classcount = 0;
 //
 
 HumInstrument::HumInstrument(void) {
-	if (m_classcount == 0) {
-		initialize();
-	}
-	m_classcount++;
 	m_index = -1;
 }
 
@@ -49,10 +293,7 @@ HumInstrument::HumInstrument(void) {
 //
 
 HumInstrument::HumInstrument(const string& Hname) {
-	if (m_classcount == 0) {
-		initialize();
-	}
-
+	m_humdrum = Hname;
 	m_index = find(Hname);
 }
 
@@ -75,8 +316,12 @@ HumInstrument::~HumInstrument() {
 //
 
 int HumInstrument::getGM(void) {
-	if (m_index > 0) {
-		return m_data[m_index].gm;
+	auto it = m_gm.find(m_humdrum);
+	if (it != m_gm.end()) {
+		return it->second;
+	}
+	if (m_index >= 0) {
+		return HumInstrumentTable[m_index].gm;
 	} else {
 		return -1;
 	}
@@ -90,15 +335,14 @@ int HumInstrument::getGM(void) {
 //
 
 int HumInstrument::getGM(const string& Hname) {
-	int tindex;
-	if (Hname.compare(0, 2, "*I") == 0) {
-		tindex = find(Hname.substr(2));
-	} else {
-		tindex = find(Hname);
+	string code = stripPrefix(Hname);
+	auto it = m_gm.find(code);
+	if (it != m_gm.end()) {
+		return it->second;
 	}
-
-	if (tindex > 0) {
-		return m_data[tindex].gm;
+	int tindex = find(code);
+	if (tindex >= 0) {
+		return HumInstrumentTable[tindex].gm;
 	} else {
 		return -1;
 	}
@@ -112,8 +356,10 @@ int HumInstrument::getGM(const string& Hname) {
 //
 
 string HumInstrument::getName(void) {
-	if (m_index > 0) {
-		return m_data[m_index].name;
+	if (m_index >= 0) {
+		return HumInstrumentTable[m_index].name;
+	} else if (m_gm.find(m_humdrum) != m_gm.end()) {
+		return m_humdrum;
 	} else {
 		return "";
 	}
@@ -127,14 +373,12 @@ string HumInstrument::getName(void) {
 //
 
 string HumInstrument::getName(const string& Hname) {
-	int tindex;
-	if (Hname.compare(0, 2, "*I") == 0) {
-		tindex = find(Hname.substr(2));
-	} else{
-		tindex = find(Hname);
-	}
-	if (tindex > 0) {
-		return m_data[tindex].name;
+	string code = stripPrefix(Hname);
+	int tindex = find(code);
+	if (tindex >= 0) {
+		return HumInstrumentTable[tindex].name;
+	} else if (m_gm.find(code) != m_gm.end()) {
+		return code;
 	} else {
 		return "";
 	}
@@ -148,8 +392,8 @@ string HumInstrument::getName(const string& Hname) {
 //
 
 string HumInstrument::getHumdrum(void) {
-	if (m_index > 0) {
-		return m_data[m_index].humdrum;
+	if ((m_index >= 0) || (m_gm.find(m_humdrum) != m_gm.end())) {
+		return m_humdrum;
 	} else {
 		return "";
 	}
@@ -159,21 +403,18 @@ string HumInstrument::getHumdrum(void) {
 
 //////////////////////////////
 //
-// HumInstrument::setGM --
+// HumInstrument::setGM -- Set the General MIDI instrument for an
+//     instrument code in this object, adding the code if it is not in the
+//     table.  Returns the index of the code in the table (or -1 if it is
+//     not in the table), or 0 if the instrument number is invalid.
 //
 
 int HumInstrument::setGM(const string& Hname, int aValue) {
 	if (aValue < 0 || aValue > 127) {
 		return 0;
 	}
-	int rindex = find(Hname);
-	if (rindex > 0) {
-		m_data[rindex].gm = aValue;
-	} else {
-		afi(Hname.c_str(), aValue, Hname.c_str());
-		sortData();
-	}
-	return rindex;
+	m_gm[Hname] = aValue;
+	return find(Hname);
 }
 
 
@@ -184,310 +425,81 @@ int HumInstrument::setGM(const string& Hname, int aValue) {
 //
 
 void HumInstrument::setHumdrum(const string& Hname) {
-	if (Hname.compare(0, 2, "*I") == 0) {
-		m_index = find(Hname.substr(2));
-	} else {
-		m_index = find(Hname);
-	}
-                                             }
-
-
+	m_humdrum = stripPrefix(Hname);
+	m_index = find(m_humdrum);
+}
 
-//////////////////////////////////////////////////////////////////////////
-//
-// private functions
-//
 
 
 //////////////////////////////
 //
-// HumInstrument::initialize --
-//
-void HumInstrument::initialize(void) {
-   m_data.reserve(500);
-
-	// List has to be sorted by first parameter.  Maybe put in map.
-   afi("accor",   GM_ACCORDION,             "accordion");
-   afi("alto",    GM_RECORDER,              "alto");
-   afi("anvil",   GM_TINKLE_BELL,           "anvil");
-   afi("archl",   GM_ACOUSTIC_GUITAR_NYLON, "archlute");
-   afi("armon",   GM_HARMONICA,             "harmonica");
-   afi("arpa",    GM_ORCHESTRAL_HARP,       "harp");
-   afi("bagpI",   GM_BAGPIPE,               "bagpipe (Irish)");
-   afi("bagpS",   GM_BAGPIPE,               "bagpipe (Scottish)");
-   afi("banjo",   GM_BANJO,                 "banjo");
-   afi("bansu",   GM_FLUTE,                 "bansuri");
-   afi("barit",   GM_CHOIR_AAHS,            "baritone");
-   afi("baset",   GM_CLARINET,              "bassett horn");
-   afi("bass",    GM_CHOIR_AAHS,            "bass");
-   afi("bdrum",   GM_TAIKO_DRUM,            "bass drum");
-   afi("bguit",   GM_ELECTRIC_BASS_FINGER,  "electric bass guitar");
-   afi("biwa",    GM_FLUTE,                 "biwa");
-   afi("bongo",   GM_TAIKO_DRUM,            "bongo");
-   afi("brush",   GM_BREATH_NOISE,          "brush");
-   afi("bscan",   GM_CHOIR_AAHS,            "basso cantante");
-   afi("bspro",   GM_CHOIR_AAHS,            "basso profondo");
-   afi("bugle",   GM_TRUMPET,               "bugle");
-   afi("calam",   GM_OBOE,                  "chalumeau");
-   afi("calpe",   GM_LEAD_CALLIOPE,         "calliope");
-   afi("calto",   GM_CHOIR_AAHS,            "contralto");
-   afi("campn",   GM_TUBULAR_BELLS,         "bell");
-   afi("cangl",   GM_ENGLISH_HORN,          "english horn");
-   afi("canto",   GM_CHOIR_AAHS,            "canto");
-   afi("caril",   GM_TUBULAR_BELLS,         "carillon");
-   afi("castr",   GM_CHOIR_AAHS,            "castrato");
-   afi("casts",   GM_WOODBLOCKS,            "castanets");
-   afi("cbass",   GM_CONTRABASS,            "contrabass");
-   afi("cello",   GM_CELLO,                 "violoncello");
-   afi("cemba",   GM_HARPSICHORD,           "harpsichord");
-   afi("cetra",   GM_VIOLIN,                "cittern");
-   afi("chain",   GM_TINKLE_BELL,           "chains");
-   afi("chcym",   GM_REVERSE_CYMBAL,        "China cymbal");
-   afi("chime",   GM_TUBULAR_BELLS,         "chimes");
-   afi("chlma",   GM_BASSOON,               "alto shawm");
-   afi("chlms",   GM_BASSOON,               "soprano shawm");
-   afi("chlmt",   GM_BASSOON,               "tenor shawm");
-   afi("clap",    GM_GUNSHOT,               "hand clapping");
-   afi("clara",   GM_CLARINET,              "alto clarinet");
-   afi("clarb",   GM_CLARINET,              "bass clarinet");
-   afi("clarp",   GM_CLARINET,              "piccolo clarinet");
-   afi("clars",   GM_CLARINET,              "clarinet");
-   afi("clave",   GM_AGOGO,                 "claves");
-   afi("clavi",   GM_CLAVI,                 "clavichord");
-   afi("clest",   GM_CELESTA,               "celesta");
-   afi("clrno",   GM_TRUMPET,               "clarino");
-   afi("colsp",   GM_FLUTE,                 "coloratura soprano");
-   afi("conga",   GM_TAIKO_DRUM,            "conga");
-   afi("cor",     GM_FRENCH_HORN,           "horn");
-   afi("cornm",   GM_BAGPIPE,               "French bagpipe");
-   afi("corno",   GM_TRUMPET,               "cornett");
-   afi("cornt",   GM_TRUMPET,               "cornet");
-   afi("coro",    GM_CHOIR_AAHS,            "chorus");
-   afi("crshc",   GM_REVERSE_CYMBAL,        "crash cymbal");
-   afi("ctenor",  GM_CHOIR_AAHS,            "counter-tenor");
-   afi("ctina",   GM_ACCORDION,             "concertina");
-   afi("drmsp",   GM_FLUTE,                 "dramatic soprano");
-   afi("drum",    GM_SYNTH_DRUM,            "drum");
-   afi("drumP",   GM_SYNTH_DRUM,            "small drum");
-   afi("dulc",    GM_DULCIMER,              "dulcimer");
-   afi("eguit",   GM_ELECTRIC_GUITAR_CLEAN, "electric guitar");
-   afi("fag_c",   GM_BASSOON,               "contrabassoon");
-   afi("fagot",   GM_BASSOON,               "bassoon");
-   afi("false",   GM_RECORDER,              "falsetto");
-   afi("fdrum",   GM_TAIKO_DRUM,            "frame drum");
-   afi("feme",    GM_CHOIR_AAHS,            "female voice");
-   afi("fife",    GM_BLOWN_BOTTLE,          "fife");
-   afi("fingc",   GM_REVERSE_CYMBAL,        "finger cymbal");
-   afi("flt",     GM_FLUTE,                 "flute");
-   afi("flt_a",   GM_FLUTE,                 "alto flute");
-   afi("flt_b",   GM_FLUTE,                 "bass flute");
-   afi("fltda",   GM_RECORDER,              "alto recorder");
-   afi("fltdb",   GM_RECORDER,              "bass recorder");
-   afi("fltdn",   GM_RECORDER,              "sopranino recorder");
-   afi("fltds",   GM_RECORDER,              "soprano recorder");
-   afi("fltdt",   GM_RECORDER,              "tenor recorder");
-   afi("flugh",   GM_FRENCH_HORN,           "flugelhorn");
-   afi("forte",   GM_HONKYTONK_PIANO,       "fortepiano");
-   afi("gen",     GM_ACOUSTIC_GRAND_PIANO,  "generic instrument");
-   afi("genB",    GM_ACOUSTIC_GRAND_PIANO,  "generic bass instrument");
-   afi("genT",    GM_ACOUSTIC_GRAND_PIANO,  "generic treble instrument");
-   afi("glock",   GM_GLOCKENSPIEL,          "glockenspiel");
-   afi("gong",    GM_REVERSE_CYMBAL,        "gong");
-   afi("guitr",   GM_ACOUSTIC_GUITAR_NYLON, "guitar");
-   afi("hammd",   GM_DRAWBAR_ORGAN,         "Hammond electronic organ");
-   afi("hbell",   GM_TINKLE_BELL,           "handbell");
-   afi("hbell",   GM_TINKLE_BELL,           "handbell");
-   afi("heck",    GM_BASSOON,               "heckelphone");
-   afi("heltn",   GM_CHOIR_AAHS,            "Heldentenor");
-   afi("hichi",   GM_OBOE,                  "hichiriki");
-   afi("hurdy",   GM_LEAD_CALLIOPE,         "hurdy-gurdy");
-   afi("kitv",    GM_VIOLIN,                "kit violin");
-   afi("klav",    GM_ACOUSTIC_GRAND_PIANO,  "keyboard");
-   afi("kokyu",   GM_FIDDLE,                "kokyu");
-   afi("komun",   GM_KOTO,                  "komun'go");
-   afi("koto",    GM_KOTO,                  "koto");
-   afi("kruma",   GM_TRUMPET,               "alto crumhorn");
-   afi("krumb",   GM_TRUMPET,               "bass crumhorn");
-   afi("krums",   GM_TRUMPET,               "soprano crumhorn");
-   afi("krumt",   GM_TRUMPET,               "tenor crumhorn");
-   afi("lion",    GM_AGOGO,                 "lion's roar");
-   afi("liuto",   GM_ACOUSTIC_GUITAR_NYLON, "lute");
-   afi("lyrsp",   GM_FLUTE,                 "lyric soprano");
-   afi("lyrtn",   GM_FRENCH_HORN,           "lyric tenor");
-   afi("male",    GM_CHOIR_AAHS,            "male voice");
-   afi("mando",   GM_ACOUSTIC_GUITAR_NYLON, "mandolin");
-   afi("marac",   GM_AGOGO,                 "maracas");
-   afi("marim",   GM_MARIMBA,               "marimba");
-   afi("mbari",   GM_CHOIR_AAHS,            "high baritone");
-   afi("mezzo",   GM_CHOIR_AAHS,            "mezzo soprano");
-   afi("nfant",   GM_CHOIR_AAHS,            "child's voice");
-   afi("nokan",   GM_SHAKUHACHI,            "nokan");
-   afi("oboe",    GM_OBOE,                  "oboe");
-   afi("oboeD",   GM_ENGLISH_HORN,          "oboe d'amore");
-   afi("ocari",   GM_OCARINA,               "ocarina");
-   afi("ondes",   GM_PAD_SWEEP,             "ondes Martenot");
-   afi("ophic",   GM_TUBA,                  "ophicleide");
-   afi("organ",   GM_CHURCH_ORGAN,          "pipe organ");
-   afi("oud",     GM_ACOUSTIC_GUITAR_NYLON, "oud");
-   afi("paila",   GM_AGOGO,                 "timbales");
-   afi("panpi",   GM_PAN_FLUTE,             "panpipe");
-   afi("pbell",   GM_TUBULAR_BELLS,         "bell plate");
-   afi("pguit",   GM_ACOUSTIC_GUITAR_NYLON, "Portuguese guitar");
-   afi("physh",   GM_REED_ORGAN,            "physharmonica");
-   afi("piano",   GM_ACOUSTIC_GRAND_PIANO,  "pianoforte");
-   afi("piatt",   GM_REVERSE_CYMBAL,        "cymbals");
-   afi("picco",   GM_PICCOLO,               "piccolo");
-   afi("pipa",    GM_ACOUSTIC_GUITAR_NYLON, "Chinese lute");
-   afi("porta",   GM_TANGO_ACCORDION,       "portative organ");
-   afi("psalt",   GM_CLAVI,                 "psaltery");
-   afi("qin",     GM_CLAVI,                 "qin");
-   afi("quinto",  GM_CHOIR_AAHS,            "quinto");
-   afi("quitr",   GM_ACOUSTIC_GUITAR_NYLON, "gittern");
-   afi("rackt",   GM_TRUMPET,               "racket");
-   afi("ratl",    GM_WOODBLOCKS,            "rattle");
-   afi("rebec",   GM_ACOUSTIC_GUITAR_NYLON, "rebec");
-   afi("recit",   GM_CHOIR_AAHS,            "recitativo");
-   afi("reedo",   GM_REED_ORGAN,            "reed organ");
-   afi("rhode",   GM_ELECTRIC_PIANO_1,      "Fender-Rhodes electric piano");
-   afi("ridec",   GM_REVERSE_CYMBAL,        "ride cymbal");
-   afi("sarod",   GM_SITAR,                 "sarod");
-   afi("sarus",   GM_TUBA,                  "sarrusophone");
-   afi("saxA",    GM_ALTO_SAX,              "alto saxophone");
-   afi("saxB",    GM_BARITONE_SAX,          "bass saxophone");
-   afi("saxC",    GM_BARITONE_SAX,          "contrabass saxophone");
-   afi("saxN",    GM_SOPRANO_SAX,           "sopranino saxophone");
-   afi("saxR",    GM_BARITONE_SAX,          "baritone saxophone");
-   afi("saxS",    GM_SOPRANO_SAX,           "soprano saxophone");
-   afi("saxT",    GM_TENOR_SAX,             "tenor saxophone");
-   afi("sbell",   GM_TINKLE_BELL,           "sleigh bells");
-   afi("sdrum",   GM_SYNTH_DRUM,            "snare drum (kit)");
-   afi("shaku",   GM_SHAKUHACHI,            "shakuhachi");
-   afi("shami",   GM_SHAMISEN,              "shamisen");
-   afi("sheng",   GM_SHANAI,                "sheng");
-   afi("sho",     GM_SHANAI,                "sho");
-   afi("siren",   GM_FX_SCI_FI,             "siren");
-   afi("sitar",   GM_SITAR,                 "sitar");
-   afi("slap",    GM_GUNSHOT,               "slapstick");
-   afi("soprn",   GM_CHOIR_AAHS,            "soprano");
-   afi("spshc",   GM_REVERSE_CYMBAL,        "splash cymbal");
-   afi("steel",   GM_STEEL_DRUMS,           "steel-drum");
-   afi("stim",    GM_SEASHORE,              "Sprechstimme");
-   afi("stimA",   GM_SEASHORE,              "Sprechstimme, alto");
-   afi("stimB",   GM_SEASHORE,              "Sprechstimme, bass");
-   afi("stimC",   GM_SEASHORE,              "Sprechstimme, contralto");
-   afi("stimR",   GM_SEASHORE,              "Sprechstimme, baritone");
-   afi("stimS",   GM_SEASHORE,              "Sprechstimme, soprano");
-   afi("strdr",   GM_AGOGO,                 "string drum");
-   afi("sxhA",    GM_ALTO_SAX,              "alto saxhorn");
-   afi("sxhB",    GM_BARITONE_SAX,          "bass saxhorn");
-   afi("sxhC",    GM_BARITONE_SAX,          "contrabass saxhorn");
-   afi("sxhR",    GM_BARITONE_SAX,          "baritone saxhorn");
-   afi("sxhS",    GM_SOPRANO_SAX,           "soprano saxhorn");
-   afi("sxhT",    GM_TENOR_SAX,             "tenor saxhorn");
-   afi("synth",   GM_ELECTRIC_PIANO_2,      "keyboard synthesizer");
-   afi("tabla",   GM_MELODIC_DRUM,          "tabla");
-   afi("tambn",   GM_TINKLE_BELL,           "tambourine");
-   afi("tambu",   GM_MELODIC_DRUM,          "tambura");
-   afi("tanbr",   GM_MELODIC_DRUM,          "tanbur");
-   afi("tblok",   GM_WOODBLOCKS,            "temple blocks");
-   afi("tdrum",   GM_SYNTH_DRUM,            "tenor drum");
-   afi("tenor",   GM_CHOIR_AAHS,            "tenor");
-   afi("timpa",   GM_MELODIC_DRUM,          "timpani");
-   afi("tiorb",   GM_ACOUSTIC_GUITAR_NYLON, "theorbo");
-   afi("tom",     GM_TAIKO_DRUM,            "tom-tom drum");
-   afi("trngl",   GM_TINKLE_BELL,           "triangle");
-   afi("tromb",   GM_TROMBONE,              "bass trombone");
-   afi("tromp",   GM_TRUMPET,               "trumpet");
-   afi("tromt",   GM_TROMBONE,              "tenor trombone");
-   afi("tuba",    GM_TUBA,                  "tuba");
-   afi("tubaB",   GM_TUBA,                  "bass tuba");
-   afi("tubaC",   GM_TUBA,                  "contrabass tuba");
-   afi("tubaT",   GM_TUBA,                  "tenor tuba");
-   afi("tubaU",   GM_TUBA,                  "subcontra tuba");
-   afi("ukule",   GM_ACOUSTIC_GUITAR_NYLON, "ukulele");
-   afi("vibra",   GM_VIBRAPHONE,            "vibraphone");
-   afi("vina",    GM_SITAR,                 "vina");
-   afi("viola",   GM_VIOLA,                 "viola");
-   afi("violb",   GM_CONTRABASS,            "bass viola da gamba");
-   afi("viold",   GM_VIOLA,                 "viola d'amore");
-   afi("violn",   GM_VIOLIN,                "violin");
-   afi("violp",   GM_VIOLIN,                "piccolo violin");
-   afi("viols",   GM_VIOLIN,                "treble viola da gamba");
-   afi("violt",   GM_CELLO,                 "tenor viola da gamba");
-   afi("vox",     GM_CHOIR_AAHS,            "generic voice");
-   afi("wblok",   GM_WOODBLOCKS,            "woodblock");
-   afi("xylo",    GM_XYLOPHONE,             "xylophone");
-   afi("zithr",   GM_CLAVI,                 "zither");
-   afi("zurna",   GM_ACOUSTIC_GUITAR_NYLON, "zurna");
+// HumInstrument::getInstrumentCount -- Return the number of instrument
+//     codes in the table.
+//
 
+int HumInstrument::getInstrumentCount(void) {
+	return HumInstrumentCount;
 }
 
 
 
 //////////////////////////////
 //
-// HumInstrument::afi --
+// HumInstrument::getInstrument -- Return a copy of an entry of the
+//     instrument table (in order of instrument code), or an empty entry if
+//     the index is invalid.
 //
 
-void HumInstrument::afi(const char* humdrum_name, int midinum,
-		const char* EN_name) {
-	_HumInstrument x;
-	x.name = EN_name;
-	x.humdrum = humdrum_name;
-	x.gm = midinum;
-
-	m_data.push_back(x);
+_HumInstrument HumInstrument::getInstrument(int index) {
+	_HumInstrument output;
+	if ((index < 0) || (index >= HumInstrumentCount)) {
+		return output;
+	}
+	output.humdrum = HumInstrumentTable[index].humdrum;
+	output.name    = HumInstrumentTable[index].name;
+	output.gm      = HumInstrumentTable[index].gm;
+	return output;
 }
 
 
 
-//////////////////////////////
+//////////////////////////////////////////////////////////////////////////
 //
-// HumInstrument::find --
+// protected functions
 //
 
-int HumInstrument::find(const string& Hname) {
-	void* searchResult;
-	_HumInstrument key;
-	key.humdrum = Hname;
-	key.name = "";
-	key.gm = 0;
-
-	searchResult = bsearch(&key, m_data.data(),
-			m_data.size(), sizeof(_HumInstrument),
-			&data_compare_by_humdrum_name);
-
-	if (searchResult == NULL) {
-		return -1;
-	} else {
-		return (int)(((TEMP64BITFIX)(searchResult)) - ((TEMP64BITFIX)(m_data.data())))/
-			sizeof(_HumInstrument);
-	}
-}
-
 
 //////////////////////////////
 //
-// HumInstrument::data_compare_by_humdrum_name --
+// HumInstrument::find -- Return the index of an instrument code in the
+//     table, or -1 if it is not in the table.
 //
 
-int HumInstrument::data_compare_by_humdrum_name(const void* a,
-		const void* b) {
-	_HumInstrument& valuea = *((_HumInstrument*)a);
-	_HumInstrument& valueb = *((_HumInstrument*)b);
-	return strcmp(valuea.humdrum.c_str(), valueb.humdrum.c_str());
+int HumInstrument::find(const string& Hname) {
+	const _HumInstrumentEntry* end = HumInstrumentTable + HumInstrumentCount;
+	const _HumInstrumentEntry* entry = std::lower_bound(HumInstrumentTable, end,
+			Hname.c_str(), [](const _HumInstrumentEntry& a, const char* b) {
+				return strcmp(a.humdrum, b) < 0;
+			});
+	if ((entry == end) || (strcmp(entry->humdrum, Hname.c_str()) != 0)) {
+		return -1;
+	}
+	return (int)(entry - HumInstrumentTable);
 }
 
 
 
 //////////////////////////////
 //
-// HumInstrument::sortData --
+// HumInstrument::stripPrefix -- Remove "*I" from the start of an
+//     instrument code.
 //
 
-void HumInstrument::sortData(void) {
-	qsort(m_data.data(), m_data.size(), sizeof(_HumInstrument),
-		&HumInstrument::data_compare_by_humdrum_name);
+string HumInstrument::stripPrefix(const string& Hname) {
+	if (Hname.compare(0, 2, "*I") == 0) {
+		return Hname.substr(2);
+	}
+	return Hname;
 }
 
 
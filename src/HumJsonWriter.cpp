@@ -0,0 +1,912 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 21:46:02 PDT 2026
+// Last Modified: Sun Oct 18 23:59:59 PDT 2026
+// Filename:      HumJsonWriter.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumJsonWriter.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Write the token graph and analyses of a Humdrum file in
+//                JSON or CBOR format.
+//
+
+#include "HumJsonWriter.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+
+//////////////////////////////
+//
+// HumJsonWriter::HumJsonWriter -- Constructor.
+//
+
+HumJsonWriter::HumJsonWriter(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::setFormat -- Set the output format (JSON or CBOR).
+//
+
+void HumJsonWriter::setFormat(HumJsonWriter::Format format) {
+	m_format = format;
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::getFormat --
+//
+
+HumJsonWriter::Format HumJsonWriter::getFormat(void) const {
+	return m_format;
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::setSections -- Set the sections to write, either as a
+//     bitmask of HumJsonWriter::Section values, or as a list of section
+//     names separated by commas or spaces (see getSectionNames(), plus
+//     "all" and "none").  Returns false if a name is not known, in which
+//     case the sections are not changed.
+//
+
+void HumJsonWriter::setSections(int sections) {
+	m_sections = sections & SECTION_ALL;
+}
+
+
+bool HumJsonWriter::setSections(const string& names) {
+	static const struct { const char* name; int section; } table[] = {
+		{ "links",       SECTION_LINKS       },
+		{ "rhythm",      SECTION_RHYTHM      },
+		{ "nulls",       SECTION_NULLS       },
+		{ "ties",        SECTION_TIES        },
+		{ "slurs",       SECTION_SLURS       },
+		{ "phrases",     SECTION_PHRASES     },
+		{ "beams",       SECTION_BEAMS       },
+		{ "accidentals", SECTION_ACCIDENTALS },
+		{ "rests",       SECTION_RESTS       },
+		{ "parameters",  SECTION_PARAMETERS  },
+		{ "auto",        SECTION_AUTO        },
+		{ "all",         SECTION_ALL         },
+		{ "none",        0                   }
+	};
+
+	int sections = 0;
+	size_t start = 0;
+	while (start < names.size()) {
+		size_t end = names.find_first_of(", ", start);
+		if (end == string::npos) {
+			end = names.size();
+		}
+		if (end > start) {
+			string name = names.substr(start, end - start);
+			bool found = false;
+			for (auto& entry : table) {
+				if (name == entry.name) {
+					sections |= entry.section;
+					found = true;
+					break;
+				}
+			}
+			if (!found) {
+				return false;
+			}
+		}
+		start = end + 1;
+	}
+	m_sections = sections;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::getSections -- Return the bitmask of sections to write.
+//
+
+int HumJsonWriter::getSections(void) const {
+	return m_sections;
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::getSectionNames -- Return the names of the sections that
+//     can be given to setSections().
+//
+
+string HumJsonWriter::getSectionNames(void) {
+	return "links, rhythm, nulls, ties, slurs, phrases, beams, accidentals, rests, parameters, auto";
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::write -- Write a file to an output stream.  Returns false
+//     if the stream could not accept all of the output.
+//
+
+bool HumJsonWriter::write(ostream& out, HumdrumFile& infile) {
+	m_out      = out.rdbuf();
+	m_failed   = (m_out == NULL);
+	m_afterKey = false;
+	m_newline  = false;
+	m_first.clear();
+	if (m_failed) {
+		return false;
+	}
+
+	if (m_sections & SECTION_TIES) {
+		infile.requireAnalysis(HumFileAnalysis::PASS_TIES);
+	}
+	if (m_sections & SECTION_SLURS) {
+		infile.requireAnalysis(HumFileAnalysis::PASS_SLURS);
+	}
+	if (m_sections & SECTION_PHRASES) {
+		infile.requireAnalysis(HumFileAnalysis::PASS_PHRASES);
+	}
+	if (m_sections & SECTION_BEAMS) {
+		infile.requireAnalysis(HumFileAnalysis::PASS_BEAMS);
+	}
+	if (m_sections & SECTION_ACCIDENTALS) {
+		infile.requireAnalysis(HumFileAnalysis::PASS_KERN_ACCIDENTALS);
+	}
+	if (m_sections & SECTION_RESTS) {
+		infile.requireAnalysis(HumFileAnalysis::PASS_REST_POSITIONS);
+	}
+	m_tables = &infile.getAnalysisTables();
+
+	beginObject();
+	writeHeader(infile);
+	writeKey("lines");
+	beginArray();
+	for (int i=0; i<infile.getLineCount(); i++) {
+		writeNewline();
+		writeLine(infile[i]);
+	}
+	endArray();
+	endObject();
+	if (m_format == FORMAT_JSON) {
+		put('\n');
+	}
+
+	if (m_out->pubsync() == -1) {
+		m_failed = true;
+	}
+	m_out = NULL;
+	m_tables = NULL;
+	return !m_failed;
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeHeader -- Write the information about the file and
+//     its tracks.
+//
+
+void HumJsonWriter::writeHeader(HumdrumFile& infile) {
+	writeKey("format");
+	writeString("humdrum");
+	writeKey("version");
+	writeInteger(1);
+	writeKey("lineCount");
+	writeInteger(infile.getLineCount());
+	writeKey("trackCount");
+	writeInteger(infile.getMaxTrack());
+	if (m_sections & SECTION_RHYTHM) {
+		writeKey("tpq");
+		writeInteger(infile.tpq());
+		writeKey("duration");
+		writeRational(infile.getScoreDuration());
+	}
+
+	writeKey("tracks");
+	beginArray();
+	for (int i=1; i<=infile.getMaxTrack(); i++) {
+		writeNewline();
+		beginObject();
+		writeKey("track");
+		writeInteger(i);
+		HTp start = infile.getTrackStart(i);
+		if (start) {
+			writeKey("dataType");
+			writeString(start->getDataType());
+			writeKey("start");
+			writeReference(start);
+		}
+		endObject();
+	}
+	endArray();
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeLine -- Write a line and its tokens.
+//
+
+void HumJsonWriter::writeLine(HumdrumLine& line) {
+	beginObject();
+	writeKey("line");
+	writeInteger(line.getLineIndex());
+	writeKey("type");
+	writeString(getLineType(line));
+	if (m_sections & SECTION_RHYTHM) {
+		writeKey("durationFromStart");
+		writeRational(line.getDurationFromStart());
+		writeKey("durationFromBarline");
+		writeRational(line.getDurationFromBarline());
+		writeKey("duration");
+		writeRational(line.getDuration());
+	}
+	writeKey("tokens");
+	beginArray();
+	for (int j=0; j<line.getFieldCount(); j++) {
+		writeToken(line.token(j));
+	}
+	endArray();
+	endObject();
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeToken -- Write a token and the selected analyses
+//     of it.
+//
+
+void HumJsonWriter::writeToken(HTp token) {
+	beginObject();
+	writeKey("id");
+	writeString(token->getXmlId());
+	writeKey("text");
+	writeString(*token);
+	writeKey("type");
+	writeString(getTokenType(token));
+	writeKey("track");
+	writeInteger(token->getTrack());
+	writeKey("subtrack");
+	writeInteger(token->getSubtrack());
+	writeKey("spine");
+	writeString(token->getSpineInfo());
+
+	if (m_sections & SECTION_RHYTHM) {
+		HumNum duration = token->getDuration();
+		if (duration.isNonNegative()) {
+			writeKey("duration");
+			writeRational(duration);
+		}
+	}
+
+	if (m_sections & SECTION_LINKS) {
+		writeTokenLinks(token);
+	}
+
+	if ((m_sections & SECTION_NULLS) && token->isNull() && token->isData()) {
+		HTp resolve = token->resolveNull();
+		if (resolve && (resolve != token)) {
+			writeKey("resolve");
+			writeReference(resolve);
+		}
+	}
+
+	if ((m_sections & SECTION_PARAMETERS) && (token->getLinkedParameterSetCount() > 0)) {
+		writeKey("linked");
+		beginArray();
+		for (int i=0; i<token->getLinkedParameterSetCount(); i++) {
+			HumParamSet* pset = token->getLinkedParameterSet(i);
+			writeReference(pset ? pset->getToken() : NULL);
+		}
+		endArray();
+	}
+
+	writeAnalyses(token);
+	writeParameters(token);
+	endObject();
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeTokenLinks -- Write the next and previous tokens
+//     in the spine.
+//
+
+void HumJsonWriter::writeTokenLinks(HTp token) {
+	writeKey("next");
+	beginArray();
+	for (int i=0; i<token->getNextTokenCount(); i++) {
+		writeReference(token->getNextToken(i));
+	}
+	endArray();
+
+	writeKey("prev");
+	beginArray();
+	for (int i=0; i<token->getPreviousTokenCount(); i++) {
+		writeReference(token->getPreviousToken(i));
+	}
+	endArray();
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeAnalyses -- Write the analyses of a token that are
+//     stored in the analysis tables of the file.
+//
+
+void HumJsonWriter::writeAnalyses(HTp token) {
+	int id = m_tables->getTokenId(token);
+	if ((id < 0) || !token->isData()) {
+		return;
+	}
+
+	if (m_sections & SECTION_TIES) {
+		writeSpans("ties", "tieHanging", m_tables->getTies(), id, token);
+	}
+	if (m_sections & SECTION_SLURS) {
+		writeSpans("slurs", "slurHanging", m_tables->getSlurs(), id, token);
+	}
+	if (m_sections & SECTION_PHRASES) {
+		writeSpans("phrases", "phraseHanging", m_tables->getPhrases(), id, token);
+	}
+	if (m_sections & SECTION_BEAMS) {
+		writeSpans("beams", "beamHanging", m_tables->getBeams(), id, token);
+	}
+
+	if ((m_sections & SECTION_ACCIDENTALS) && token->isKern() && !token->isNull()) {
+		int count = token->getSubtokenCount();
+		int last = -1;
+		for (int i=0; i<count; i++) {
+			if (m_tables->getAccidentalFlags(id, i) > 0) {
+				last = i;
+			}
+		}
+		if (last >= 0) {
+			writeKey("accidentals");
+			beginArray();
+			for (int i=0; i<=last; i++) {
+				writeInteger(m_tables->getAccidentalFlags(id, i));
+			}
+			endArray();
+		}
+	}
+
+	int diatonic;
+	int octave;
+	if ((m_sections & SECTION_RESTS) && m_tables->getRestPosition(id, diatonic, octave)) {
+		writeKey("restPosition");
+		beginArray();
+		writeInteger(diatonic);
+		writeInteger(octave);
+		endArray();
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeSpans -- Write the ties, slurs, phrases or beams
+//     starting on a token, and whether the token has an unmatched start
+//     or end.
+//
+
+void HumJsonWriter::writeSpans(const char* key, const char* hangingkey,
+		HumSpanTable& spans, int id, HTp token) {
+	int count = spans.getStartCount(id);
+	if (count > 0) {
+		writeKey(key);
+		beginArray();
+		// Start numbers are at most the number of opening characters (or
+		// of notes for ties) on the token.
+		int found = 0;
+		for (int number=1; (found < count) && (number <= (int)token->size()); number++) {
+			HTp end = spans.getEndToken(id, number);
+			if (!end) {
+				continue;
+			}
+			found++;
+			beginObject();
+			writeKey("number");
+			writeInteger(number);
+			writeKey("end");
+			writeReference(end);
+			writeKey("duration");
+			writeRational(spans.getDuration(id, number));
+			endObject();
+		}
+		endArray();
+	}
+	int side = spans.getHangingSide(id);
+	if (side) {
+		writeKey(hangingkey);
+		writeInteger(side);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeParameters -- Write the parameters of a token that
+//     belong to the selected sections.  Values that are tokens (stored as
+//     "HT_" followed by the address of the token) are written as
+//     references to the token.
+//
+
+void HumJsonWriter::writeParameters(HTp token) {
+	MapNNKV* parameters = ((HumHash*)token)->parameters;
+	if ((parameters == NULL) || parameters->empty()) {
+		return;
+	}
+	bool found = false;
+	for (auto& it1 : *parameters) {
+		for (auto& it2 : it1.second) {
+			for (auto& it3 : it2.second) {
+				int section = getParameterSection(it1.first, it2.first, it3.first);
+				if (!(m_sections & section)) {
+					continue;
+				}
+				if (!found) {
+					writeKey("parameters");
+					beginArray();
+					found = true;
+				}
+				beginArray();
+				writeString(it1.first);
+				writeString(it2.first);
+				writeString(it3.first);
+				const HumParameter& value = it3.second;
+				if (value.compare(0, 3, "HT_") == 0) {
+					writeReference((HTp)strtoll(value.c_str() + 3, NULL, 10));
+				} else {
+					writeString(value);
+				}
+				if (value.origin) {
+					writeReference(value.origin);
+				}
+				endArray();
+			}
+		}
+	}
+	if (found) {
+		endArray();
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::getParameterSection -- Return the section that a
+//     parameter belongs to, or 0 if the parameter is not written because
+//     it is a copy of a result in the analysis tables (or the "id" of the
+//     token itself).  Analysis results are stored in the "auto" namespace,
+//     and all other parameters come from layout comments.
+//
+
+int HumJsonWriter::getParameterSection(const string& ns1, const string& ns2,
+		const string& key) const {
+	if (ns1.empty() && (ns2 == "auto")) {
+		if ((key.find("tie") != string::npos) || (key.find("Tie") != string::npos) ||
+				(key.find("phrase") != string::npos) || (key.find("Phrase") != string::npos) ||
+				(key.find("slur") != string::npos) || (key.find("Slur") != string::npos) ||
+				(key.find("beam") != string::npos) || (key.find("Beam") != string::npos) ||
+				(key == "id") || (key == "ploc") || (key == "oloc")) {
+			return 0;
+		}
+		return SECTION_AUTO;
+	}
+	if (ns1 == "auto") {
+		// Subtoken parameters, such as "auto", "1", "visualAccidental".
+		// The visual, cautionary and obligatory states are in the analysis
+		// tables.
+		if (key.find("ccidental") != string::npos) {
+			if ((key == "visualAccidental") || (key == "cautionaryAccidental") ||
+					(key == "obligatoryAccidental")) {
+				return 0;
+			}
+			return SECTION_ACCIDENTALS;
+		}
+		return SECTION_AUTO;
+	}
+	return SECTION_PARAMETERS;
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::getLineType --
+//
+
+const char* HumJsonWriter::getLineType(HumdrumLine& line) {
+	if (line.isEmpty()) {
+		return "empty";
+	} else if (line.isReference()) {
+		return "reference";
+	} else if (line.isCommentUniversal()) {
+		return "universal-comment";
+	} else if (line.isCommentGlobal()) {
+		return "global-comment";
+	} else if (line.isExclusive()) {
+		return "exclusive";
+	} else if (line.isTerminator()) {
+		return "terminator";
+	} else if (line.isManipulator()) {
+		return "manipulator";
+	} else if (line.isInterp()) {
+		return "interpretation";
+	} else if (line.isCommentLocal()) {
+		return "local-comment";
+	} else if (line.isBarline()) {
+		return "barline";
+	} else if (line.isData()) {
+		return "data";
+	}
+	return "unknown";
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::getTokenType -- Same categories as the <tokenType> of
+//     HumdrumToken::printXml(), with the tokens of global lines (which
+//     have no track) marked separately.
+//
+
+const char* HumJsonWriter::getTokenType(HTp token) {
+	HLp line = token->getOwner();
+	if (line && !line->hasSpines()) {
+		return "global";
+	} else if (token->isNull()) {
+		return "null";
+	} else if (token->isManipulator()) {
+		return "manipulator";
+	} else if (token->isCommentLocal()) {
+		return "local-comment";
+	} else if (token->isBarline()) {
+		return "barline";
+	} else if (token->isData()) {
+		return "data";
+	}
+	return "interpretation";
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::beginObject -- Start a JSON object or CBOR map.
+//
+
+void HumJsonWriter::beginObject(void) {
+	if (m_format == FORMAT_CBOR) {
+		put((char)0xbf);
+		return;
+	}
+	writeSeparator();
+	put('{');
+	m_first.push_back(1);
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::endObject --
+//
+
+void HumJsonWriter::endObject(void) {
+	if (m_format == FORMAT_CBOR) {
+		put((char)0xff);
+		return;
+	}
+	m_first.pop_back();
+	put('}');
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::beginArray -- Start a JSON or CBOR array.
+//
+
+void HumJsonWriter::beginArray(void) {
+	if (m_format == FORMAT_CBOR) {
+		put((char)0x9f);
+		return;
+	}
+	writeSeparator();
+	put('[');
+	m_first.push_back(1);
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::endArray --
+//
+
+void HumJsonWriter::endArray(void) {
+	if (m_format == FORMAT_CBOR) {
+		put((char)0xff);
+		return;
+	}
+	m_first.pop_back();
+	put(']');
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeKey -- Write the key of the next value in an object.
+//
+
+void HumJsonWriter::writeKey(const char* key) {
+	writeString(key);
+	if (m_format == FORMAT_JSON) {
+		put(':');
+		m_afterKey = true;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeString -- Write a string, escaping quotes,
+//     backslashes and control characters for JSON.
+//
+
+void HumJsonWriter::writeString(const char* text, size_t size) {
+	if (m_format == FORMAT_CBOR) {
+		writeCborHead(3, size);
+		put(text, size);
+		return;
+	}
+	writeSeparator();
+	put('"');
+	size_t start = 0;
+	for (size_t i=0; i<size; i++) {
+		unsigned char ch = (unsigned char)text[i];
+		if ((ch >= 0x20) && (ch != '"') && (ch != '\\')) {
+			continue;
+		}
+		put(text + start, i - start);
+		start = i + 1;
+		switch (ch) {
+			case '"':  put("\\\"", 2); break;
+			case '\\': put("\\\\", 2); break;
+			case '\n': put("\\n", 2);  break;
+			case '\r': put("\\r", 2);  break;
+			case '\t': put("\\t", 2);  break;
+			default: {
+				char buffer[8];
+				snprintf(buffer, sizeof(buffer), "\\u%04x", ch);
+				put(buffer, 6);
+			}
+		}
+	}
+	put(text + start, size - start);
+	put('"');
+}
+
+
+void HumJsonWriter::writeString(const string& text) {
+	writeString(text.data(), text.size());
+}
+
+
+void HumJsonWriter::writeString(const char* text) {
+	writeString(text, strlen(text));
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeInteger --
+//
+
+void HumJsonWriter::writeInteger(long long value) {
+	if (m_format == FORMAT_CBOR) {
+		if (value >= 0) {
+			writeCborHead(0, (unsigned long long)value);
+		} else {
+			writeCborHead(1, (unsigned long long)(-1 - value));
+		}
+		return;
+	}
+	writeSeparator();
+	char buffer[32];
+	int size = snprintf(buffer, sizeof(buffer), "%lld", value);
+	put(buffer, size);
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeRational -- Write a duration as a
+//     [numerator, denominator] array.
+//
+
+void HumJsonWriter::writeRational(HumNum value) {
+	beginArray();
+	writeInteger(value.getNumerator());
+	writeInteger(value.getDenominator());
+	endArray();
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeReference -- Write a reference to a token as a
+//     [line, field] array, or null if there is no token.
+//
+
+void HumJsonWriter::writeReference(HTp token) {
+	if (token == NULL) {
+		writeNull();
+		return;
+	}
+	beginArray();
+	writeInteger(token->getLineIndex());
+	writeInteger(token->getFieldIndex());
+	endArray();
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeNull --
+//
+
+void HumJsonWriter::writeNull(void) {
+	if (m_format == FORMAT_CBOR) {
+		put((char)0xf6);
+		return;
+	}
+	writeSeparator();
+	put("null", 4);
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeNewline -- Start the next JSON value on a new line
+//     (to keep lines of the output to a readable length).
+//
+
+void HumJsonWriter::writeNewline(void) {
+	if (m_format == FORMAT_JSON) {
+		m_newline = true;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeSeparator -- Write the comma before a JSON value
+//     if it is not the first value in its array or object.
+//
+
+void HumJsonWriter::writeSeparator(void) {
+	if (m_afterKey) {
+		m_afterKey = false;
+		return;
+	}
+	if (!m_first.empty()) {
+		if (m_first.back()) {
+			m_first.back() = 0;
+		} else {
+			put(',');
+		}
+	}
+	if (m_newline) {
+		put('\n');
+		m_newline = false;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::writeCborHead -- Write the initial bytes of a CBOR data
+//     item: the major type and the shortest encoding of the value.
+//
+
+void HumJsonWriter::writeCborHead(int major, unsigned long long value) {
+	char buffer[9];
+	int size;
+	major <<= 5;
+	if (value < 24) {
+		buffer[0] = (char)(major | value);
+		size = 1;
+	} else if (value <= 0xff) {
+		buffer[0] = (char)(major | 24);
+		size = 2;
+	} else if (value <= 0xffff) {
+		buffer[0] = (char)(major | 25);
+		size = 3;
+	} else if (value <= 0xffffffffULL) {
+		buffer[0] = (char)(major | 26);
+		size = 5;
+	} else {
+		buffer[0] = (char)(major | 27);
+		size = 9;
+	}
+	for (int i=size-1; i>0; i--) {
+		buffer[i] = (char)(value & 0xff);
+		value >>= 8;
+	}
+	put(buffer, size);
+}
+
+
+
+//////////////////////////////
+//
+// HumJsonWriter::put -- Write bytes to the output stream.
+//
+
+void HumJsonWriter::put(char ch) {
+	if (m_out->sputc(ch) == std::char_traits<char>::eof()) {
+		m_failed = true;
+	}
+}
+
+
+void HumJsonWriter::put(const char* data, size_t size) {
+	if (size == 0) {
+		return;
+	}
+	if (m_out->sputn(data, (std::streamsize)size) != (std::streamsize)size) {
+		m_failed = true;
+	}
+}
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
@@ -0,0 +1,353 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 12:24:31 PDT 2026
+// Last Modified: Sun Oct 18 23:59:55 PDT 2026
+// Filename:      HumMetricTable.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumMetricTable.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   The metric position of each data line in each track of a
+//                file, filled in by HumdrumFileContent::analyzeMetricGrid().
+//
+
+#include "HumMetricTable.h"
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+
+//////////////////////////////
+//
+// HumMetricTable::HumMetricTable -- Constructor.
+//
+
+HumMetricTable::HumMetricTable(void) {
+	clear();
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::clear -- Remove all positions and meters (except for
+//     meter 0, which is used for tracks without a time signature).
+//
+
+void HumMetricTable::clear(void) {
+	m_trackCount = 0;
+	m_meterTops.clear();
+	m_meterBottoms.clear();
+	m_compound.clear();
+	m_beatDurations.clear();
+	m_explicitBeats.clear();
+	m_rows.clear();
+	m_positions.clear();
+	m_meters.clear();
+	m_beats.clear();
+	m_fractions.clear();
+	m_levels.clear();
+	addMeter(0, 0, 0, 0);
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::resize -- Remove all positions and prepare the table
+//     for the given number of lines and tracks.
+//
+
+void HumMetricTable::resize(int lineCount, int trackCount) {
+	clear();
+	m_trackCount = trackCount;
+	m_rows.assign(lineCount, -1);
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::addMeter -- Return the index of a meter, adding it to
+//     the list of meters if it has not been used before.  The bottom of the
+//     time signature is bottom/bottom2 when bottom2 is not zero (such as
+//     *M3/2%3).  A beat of 0 means to use the default beat of the meter.
+//
+
+int HumMetricTable::addMeter(int top, int bottom, int bottom2, HumNum beat) {
+	HumNum bottomvalue = bottom;
+	if (bottom2 > 0) {
+		bottomvalue.setValue(bottom, bottom2);
+	}
+	// Compound meters such as 6/8, 9/8, 6/4, but not 3/8 or 3/4:
+	bool compound = (top % 3 == 0) && (top != 3) && (top != 0);
+	HumNum explicitbeat = beat > 0 ? beat : HumNum(0);
+	if (beat <= 0) {
+		beat = 1;
+		if (bottom > 0) {
+			beat.setValue(4, bottom);
+			if (compound) {
+				beat *= 3;
+			}
+		}
+	}
+	for (int i=(int)m_meterTops.size()-1; i>=0; i--) {
+		if ((m_meterTops[i] == top) && (m_meterBottoms[i] == bottomvalue) &&
+				(m_beatDurations[i] == beat) && (m_explicitBeats[i] == explicitbeat)) {
+			return i;
+		}
+	}
+	m_meterTops.push_back(top);
+	m_meterBottoms.push_back(bottomvalue);
+	m_compound.push_back(compound ? 1 : 0);
+	m_beatDurations.push_back(beat);
+	m_explicitBeats.push_back(explicitbeat);
+	return (int)m_meterTops.size() - 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::addLine -- Add a row of positions for a data line, which
+//     are then filled in with setPosition().
+//
+
+void HumMetricTable::addLine(int line, HumNum position) {
+	if ((line < 0) || (line >= (int)m_rows.size())) {
+		return;
+	}
+	m_rows[line] = (int)m_positions.size();
+	m_positions.push_back(position);
+	int size = (int)m_positions.size() * m_trackCount;
+	m_meters.resize(size, 0);
+	m_beats.resize(size, 0);
+	m_fractions.resize(size, 0);
+	m_levels.resize(size, NAN);
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::setPosition -- Store the metric position of a track on
+//     a data line added with addLine().
+//
+
+void HumMetricTable::setPosition(int line, int track, int meter, int beat,
+		HumNum fraction, double level) {
+	int index = getIndex(line, track);
+	if (index < 0) {
+		return;
+	}
+	m_meters[index]    = meter;
+	m_beats[index]     = beat;
+	m_fractions[index] = fraction;
+	m_levels[index]    = level;
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::getLineCount -- Return the number of lines in the file
+//     when the table was filled.
+//
+
+int HumMetricTable::getLineCount(void) const {
+	return (int)m_rows.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::getTrackCount -- Return the number of tracks in the
+//     file when the table was filled.
+//
+
+int HumMetricTable::getTrackCount(void) const {
+	return m_trackCount;
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::hasPosition -- Return true if the line is a data line
+//     and the track is in the table.
+//
+
+bool HumMetricTable::hasPosition(int line, int track) const {
+	return getIndex(line, track) >= 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::getMeasurePosition -- Return the duration in quarter
+//     notes from the previous barline to a data line (0 for other lines).
+//
+
+HumNum HumMetricTable::getMeasurePosition(int line) const {
+	if ((line < 0) || (line >= (int)m_rows.size()) || (m_rows[line] < 0)) {
+		return 0;
+	}
+	return m_positions[m_rows[line]];
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::hasMeter -- Return true if there is a time signature
+//     for the track before the line.
+//
+
+bool HumMetricTable::hasMeter(int line, int track) const {
+	return getMeterIndex(line, track) > 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::getMeterTop -- Return the top number of the time
+//     signature (0 if none).
+//
+
+int HumMetricTable::getMeterTop(int line, int track) const {
+	return m_meterTops[getMeterIndex(line, track)];
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::getMeterBottom -- Return the bottom number of the time
+//     signature (0 if none).
+//
+
+HumNum HumMetricTable::getMeterBottom(int line, int track) const {
+	return m_meterBottoms[getMeterIndex(line, track)];
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::isCompound -- Return true if the meter is compound.
+//
+
+bool HumMetricTable::isCompound(int line, int track) const {
+	return m_compound[getMeterIndex(line, track)];
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::getBeatDuration -- Return the duration of the beat in
+//     quarter notes.
+//
+
+HumNum HumMetricTable::getBeatDuration(int line, int track) const {
+	return m_beatDurations[getMeterIndex(line, track)];
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::getExplicitBeat -- Return the beat duration given by a
+//     *beat: interpretation, or 0 if the beat is the default one for the
+//     meter.
+//
+
+HumNum HumMetricTable::getExplicitBeat(int line, int track) const {
+	return m_explicitBeats[getMeterIndex(line, track)];
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::getBeat -- Return the beat number in the measure (from
+//     1), or 0 if there is no position for the line and track.
+//
+
+int HumMetricTable::getBeat(int line, int track) const {
+	int index = getIndex(line, track);
+	return index < 0 ? 0 : m_beats[index];
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::getBeatFraction -- Return the position within the beat
+//     as a fraction of the beat.
+//
+
+HumNum HumMetricTable::getBeatFraction(int line, int track) const {
+	int index = getIndex(line, track);
+	return index < 0 ? HumNum(0) : m_fractions[index];
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::getMetricLevel -- Return the metric level, or the
+//     undefined value if there is no position for the line and track.
+//
+
+double HumMetricTable::getMetricLevel(int line, int track,
+		double undefined) const {
+	int index = getIndex(line, track);
+	return index < 0 ? undefined : m_levels[index];
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::getIndex -- Return the index of a position in the
+//     position arrays, or -1 if there is none.
+//
+
+int HumMetricTable::getIndex(int line, int track) const {
+	if ((line < 0) || (line >= (int)m_rows.size())) {
+		return -1;
+	}
+	if ((track < 1) || (track > m_trackCount) || (m_rows[line] < 0)) {
+		return -1;
+	}
+	return m_rows[line] * m_trackCount + track - 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumMetricTable::getMeterIndex -- Return the meter of a position (0 if
+//     there is no time signature or no position).
+//
+
+int HumMetricTable::getMeterIndex(int line, int track) const {
+	int index = getIndex(line, track);
+	return index < 0 ? 0 : m_meters[index];
+}
+
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
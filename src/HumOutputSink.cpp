@@ -0,0 +1,449 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 18:10:14 PDT 2026
+// Last Modified: Sun Oct 18 23:59:12 PDT 2026
+// Filename:      HumOutputSink.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumOutputSink.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Destinations for the output of Humdrum tools.
+//
+
+#include "HumOutputSink.h"
+#include "HumdrumFileBase.h"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+	#include <io.h>
+#else
+	#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+
+//////////////////////////////
+//
+// HumOutputSink::HumOutputSink -- Constructor.
+//
+
+HumOutputSink::HumOutputSink(void) {
+	setp(m_buffer, m_buffer + sizeof(m_buffer));
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::~HumOutputSink -- Deconstructor.  Derived classes
+//     flush any buffered text in their own deconstructors, since
+//     writeData() cannot be called from here.
+//
+
+HumOutputSink::~HumOutputSink() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::write -- Write a block of text to the sink.  Returns
+//     false if the sink could not accept all of the text.
+//
+
+bool HumOutputSink::write(const char* data, size_t size) {
+	return (size_t)sputn(data, (std::streamsize)size) == size;
+}
+
+
+bool HumOutputSink::write(const string& text) {
+	return write(text.data(), text.size());
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::writeFile -- Write the text of each line in a Humdrum
+//     file.  The line buffers are sent directly to the sink, so nothing
+//     is copied into temporary strings on the way.  If tokens in the file
+//     have been changed, call createLinesFromTokens() on the file first
+//     (as when printing the file to a stream).
+//
+
+bool HumOutputSink::writeFile(HumdrumFileBase& infile) {
+	for (int i=0; i<infile.getLineCount(); i++) {
+		const string& line = infile[i];
+		sputn(line.data(), (std::streamsize)line.size());
+		sputc('\n');
+	}
+	return !m_failed;
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::flush -- Pass any buffered text on to the destination.
+//
+
+bool HumOutputSink::flush(void) {
+	return (pubsync() == 0) && !m_failed;
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::getByteCount -- Return the number of bytes written to
+//     the sink, including any which are still buffered.
+//
+
+size_t HumOutputSink::getByteCount(void) {
+	return m_written + (size_t)(pptr() - pbase());
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::isFailed -- Return true if some text could not be
+//     written to the destination.
+//
+
+bool HumOutputSink::isFailed(void) {
+	return m_failed;
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::setUnbuffered -- Pass all writes directly to writeData()
+//     for destinations that do not benefit from buffering.
+//
+
+void HumOutputSink::setUnbuffered(void) {
+	setp(NULL, NULL);
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::overflow -- Called when the buffer is full.
+//
+
+int HumOutputSink::overflow(int ch) {
+	if (sync() != 0) {
+		return traits_type::eof();
+	}
+	if (ch == traits_type::eof()) {
+		return traits_type::not_eof(ch);
+	}
+	if (pptr() < epptr()) {
+		*pptr() = (char)ch;
+		pbump(1);
+		return ch;
+	}
+	char value = (char)ch;
+	if (!writeData(&value, 1)) {
+		m_failed = true;
+		return traits_type::eof();
+	}
+	m_written++;
+	return ch;
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::xsputn -- Write a block of text.  Blocks that do not fit
+//     into the buffer are passed on without being copied.
+//
+
+std::streamsize HumOutputSink::xsputn(const char* data, std::streamsize size) {
+	if (size <= 0) {
+		return 0;
+	}
+	if (size > epptr() - pptr()) {
+		if (sync() != 0) {
+			return 0;
+		}
+	}
+	if (size <= epptr() - pptr()) {
+		memcpy(pptr(), data, (size_t)size);
+		pbump((int)size);
+		return size;
+	}
+	if (!writeData(data, (size_t)size)) {
+		m_failed = true;
+		return 0;
+	}
+	m_written += (size_t)size;
+	return size;
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::sync -- Pass the buffered text on to writeData().
+//
+
+int HumOutputSink::sync(void) {
+	size_t size = (size_t)(pptr() - pbase());
+	if (size == 0) {
+		return 0;
+	}
+	if (!writeData(pbase(), size)) {
+		m_failed = true;
+		return -1;
+	}
+	m_written += size;
+	setp(pbase(), epptr());
+	return 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumFdSink::HumFdSink -- Constructor.
+//
+
+HumFdSink::HumFdSink(int fd) {
+	m_fd = fd;
+}
+
+
+
+//////////////////////////////
+//
+// HumFdSink::~HumFdSink -- Deconstructor.  The file descriptor is not
+//     closed.
+//
+
+HumFdSink::~HumFdSink() {
+	flush();
+}
+
+
+
+//////////////////////////////
+//
+// HumFdSink::writeData --
+//
+
+bool HumFdSink::writeData(const char* data, size_t size) {
+	while (size > 0) {
+		#ifdef _WIN32
+			int count = _write(m_fd, data, (unsigned int)size);
+		#else
+			ssize_t count = ::write(m_fd, data, size);
+		#endif
+		if (count < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		if (count == 0) {
+			return false;
+		}
+		data += count;
+		size -= (size_t)count;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumBufferSink::HumBufferSink -- Constructor.  The caller's memory is
+//     used as the buffer of the sink, so text is written into it only once.
+//
+
+HumBufferSink::HumBufferSink(char* buffer, size_t capacity) {
+	m_data = buffer;
+	setp(buffer, buffer + capacity);
+}
+
+
+
+//////////////////////////////
+//
+// HumBufferSink::~HumBufferSink -- Deconstructor.
+//
+
+HumBufferSink::~HumBufferSink() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumBufferSink::getData -- Return the start of the caller's buffer.
+//
+
+const char* HumBufferSink::getData(void) {
+	return m_data;
+}
+
+
+
+//////////////////////////////
+//
+// HumBufferSink::getSize -- Return the number of bytes stored in the
+//     caller's buffer.  The text is not null-terminated.
+//
+
+size_t HumBufferSink::getSize(void) {
+	return (size_t)(pptr() - pbase());
+}
+
+
+
+//////////////////////////////
+//
+// HumBufferSink::writeData -- Only called when the buffer is full.
+//
+
+bool HumBufferSink::writeData(const char* data, size_t size) {
+	return false;
+}
+
+
+
+//////////////////////////////
+//
+// HumBufferSink::sync -- The text is already in its final location.
+//
+
+int HumBufferSink::sync(void) {
+	return 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumStringSink::HumStringSink -- Constructor.  The text is appended to
+//     the string as it is written.
+//
+
+HumStringSink::HumStringSink(string& output) : m_output(output) {
+	setUnbuffered();
+}
+
+
+
+//////////////////////////////
+//
+// HumStringSink::~HumStringSink -- Deconstructor.
+//
+
+HumStringSink::~HumStringSink() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumStringSink::writeData --
+//
+
+bool HumStringSink::writeData(const char* data, size_t size) {
+	m_output.append(data, size);
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumStreamSink::HumStreamSink -- Constructor.
+//
+
+HumStreamSink::HumStreamSink(ostream& output) : m_output(output) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumStreamSink::~HumStreamSink -- Deconstructor.
+//
+
+HumStreamSink::~HumStreamSink() {
+	flush();
+}
+
+
+
+//////////////////////////////
+//
+// HumStreamSink::writeData --
+//
+
+bool HumStreamSink::writeData(const char* data, size_t size) {
+	m_output.write(data, (std::streamsize)size);
+	return m_output.good();
+}
+
+
+
+//////////////////////////////
+//
+// HumCallbackSink::HumCallbackSink -- Constructor.
+//
+
+HumCallbackSink::HumCallbackSink(const Callback& callback) {
+	m_callback = callback;
+}
+
+
+
+//////////////////////////////
+//
+// HumCallbackSink::~HumCallbackSink -- Deconstructor.
+//
+
+HumCallbackSink::~HumCallbackSink() {
+	flush();
+}
+
+
+
+//////////////////////////////
+//
+// HumCallbackSink::writeData --
+//
+
+bool HumCallbackSink::writeData(const char* data, size_t size) {
+	if (!m_callback) {
+		return false;
+	}
+	return m_callback(data, size);
+}
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
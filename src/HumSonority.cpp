@@ -0,0 +1,269 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 12:24:31 PDT 2026
+// Last Modified: Sun Oct 18 23:59:55 PDT 2026
+// Filename:      HumSonority.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumSonority.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   The notes sounding on one data line of a file, as a view
+//                into a HumSonorityTable.
+//
+
+#include "HumSonority.h"
+#include "HumSonorityTable.h"
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+
+//////////////////////////////
+//
+// HumSonority::HumSonority -- Constructor.
+//
+
+HumSonority::HumSonority(const HumSonorityTable* table, int line) {
+	m_table = table;
+	m_line  = line;
+	m_start = 0;
+	m_count = 0;
+	if (table && (line >= 0) && (line < table->getLineCount())) {
+		m_start = table->m_noteStart[line];
+		m_count = table->m_noteCount[line];
+	} else {
+		m_table = NULL;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getLineIndex -- Return the line of the sonority in the file.
+//
+
+int HumSonority::getLineIndex(void) const {
+	return m_line;
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::isEmpty -- Return true if no notes are sounding.
+//
+
+bool HumSonority::isEmpty(void) const {
+	return m_count == 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getNoteCount -- Return the number of notes sounding,
+//     including doubled pitches.
+//
+
+int HumSonority::getNoteCount(void) const {
+	return m_count;
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getAttackCount -- Return the number of notes that start
+//     on the line.
+//
+
+int HumSonority::getAttackCount(void) const {
+	if (!m_table) {
+		return 0;
+	}
+	return m_table->m_attackCount[m_line];
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getVoiceCount -- Return the number of fields containing
+//     sounding notes (a chord counts as one voice).
+//
+
+int HumSonority::getVoiceCount(void) const {
+	if (!m_table) {
+		return 0;
+	}
+	return m_table->m_voiceCount[m_line];
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getBase40 -- Return the base-40 pitch of a note.
+//
+
+int HumSonority::getBase40(int index) const {
+	return m_table->m_base40.at(m_start + index);
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getBase40Pc -- Return the base-40 pitch class of a note.
+//
+
+int HumSonority::getBase40Pc(int index) const {
+	return getBase40(index) % 40;
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getMidiPitch -- Return the MIDI note number of a note.
+//
+
+int HumSonority::getMidiPitch(int index) const {
+	return m_table->m_midi.at(m_start + index);
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getToken -- Return the token containing the note, which is
+//     on an earlier line for sustained notes.
+//
+
+HTp HumSonority::getToken(int index) const {
+	return m_table->m_tokens.at(m_start + index);
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getFieldIndex -- Return the field on the sonority's line
+//     in which the note is sounding.
+//
+
+int HumSonority::getFieldIndex(int index) const {
+	return m_table->m_fields.at(m_start + index);
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getSubtokenIndex -- Return the chord index of the note in
+//     its token.
+//
+
+int HumSonority::getSubtokenIndex(int index) const {
+	return m_table->m_subtokens.at(m_start + index);
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::isAttack -- Return true if the note starts on the line.
+//
+
+bool HumSonority::isAttack(int index) const {
+	return m_table->m_attacks.at(m_start + index) != 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getLowestIndex -- Return the index of the lowest note (the
+//     first one if more than one voice has the lowest pitch), or -1 if
+//     there are no notes.
+//
+
+int HumSonority::getLowestIndex(void) const {
+	if (m_count == 0) {
+		return -1;
+	}
+	return m_table->m_lowest[m_line];
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getPitchClassSet -- Return the set of base-40 pitch classes
+//     sounding on the line.
+//
+
+uint64_t HumSonority::getPitchClassSet(void) const {
+	if (!m_table) {
+		return 0;
+	}
+	return m_table->m_pitchClasses[m_line];
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getAttackPitchClassSet -- Return the set of base-40 pitch
+//     classes attacked on the line.
+//
+
+uint64_t HumSonority::getAttackPitchClassSet(void) const {
+	if (!m_table) {
+		return 0;
+	}
+	return m_table->m_attackPitchClasses[m_line];
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getPitchClassSet12 -- Return the set of chromatic pitch
+//     classes sounding on the line.
+//
+
+uint16_t HumSonority::getPitchClassSet12(void) const {
+	if (!m_table) {
+		return 0;
+	}
+	return m_table->m_pitchClasses12[m_line];
+}
+
+
+
+//////////////////////////////
+//
+// HumSonority::getAttackPitchClassSet12 -- Return the set of chromatic
+//     pitch classes attacked on the line.
+//
+
+uint16_t HumSonority::getAttackPitchClassSet12(void) const {
+	if (!m_table) {
+		return 0;
+	}
+	return m_table->m_attackPitchClasses12[m_line];
+}
+
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
@@ -0,0 +1,181 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 12:24:31 PDT 2026
+// Last Modified: Sun Oct 18 23:59:55 PDT 2026
+// Filename:      HumSonorityTable.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumSonorityTable.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   The sonority of each data line in a file, filled in by
+//                HumdrumFileContent::analyzeSonorities().
+//
+
+#include "HumSonorityTable.h"
+#include "Convert.h"
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+
+//////////////////////////////
+//
+// HumSonorityTable::HumSonorityTable -- Constructor.
+//
+
+HumSonorityTable::HumSonorityTable(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumSonorityTable::clear -- Remove all sonorities.
+//
+
+void HumSonorityTable::clear(void) {
+	m_noteStart.clear();
+	m_noteCount.clear();
+	m_attackCount.clear();
+	m_voiceCount.clear();
+	m_lowest.clear();
+	m_pitchClasses.clear();
+	m_attackPitchClasses.clear();
+	m_pitchClasses12.clear();
+	m_attackPitchClasses12.clear();
+	m_dataLines.clear();
+	m_base40.clear();
+	m_midi.clear();
+	m_tokens.clear();
+	m_fields.clear();
+	m_subtokens.clear();
+	m_attacks.clear();
+}
+
+
+
+//////////////////////////////
+//
+// HumSonorityTable::resize -- Remove all sonorities and prepare empty
+//     sonorities for the given number of lines.
+//
+
+void HumSonorityTable::resize(int lineCount) {
+	clear();
+	m_noteStart.assign(lineCount, 0);
+	m_noteCount.assign(lineCount, 0);
+	m_attackCount.assign(lineCount, 0);
+	m_voiceCount.assign(lineCount, 0);
+	m_lowest.assign(lineCount, -1);
+	m_pitchClasses.assign(lineCount, 0);
+	m_attackPitchClasses.assign(lineCount, 0);
+	m_pitchClasses12.assign(lineCount, 0);
+	m_attackPitchClasses12.assign(lineCount, 0);
+}
+
+
+
+//////////////////////////////
+//
+// HumSonorityTable::addSlice -- Start the sonority of a data line.  The
+//     notes of the line are then added with addNote() before the next
+//     slice is started.
+//
+
+void HumSonorityTable::addSlice(int line) {
+	if ((line < 0) || (line >= (int)m_noteStart.size())) {
+		return;
+	}
+	m_dataLines.push_back(line);
+	m_noteStart[line] = (int)m_base40.size();
+	m_noteCount[line] = 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumSonorityTable::addNote -- Add a note to the sonority of the most
+//     recently added slice.
+//
+
+void HumSonorityTable::addNote(int line, HTp token, int field, int subtoken,
+		int base40, bool attack) {
+	if ((line < 0) || (line >= (int)m_noteStart.size())) {
+		return;
+	}
+	int midi = Convert::base40ToMidiNoteNumber(base40);
+	int pc40 = base40 % 40;
+	int pc12 = ((midi % 12) + 12) % 12;
+	int count = m_noteCount[line];
+	if ((count == 0) || (m_fields.back() != field)) {
+		m_voiceCount[line]++;
+	}
+	if ((count == 0) || (midi < m_midi[m_noteStart[line] + m_lowest[line]])) {
+		m_lowest[line] = (short)count;
+	}
+
+	m_base40.push_back((short)base40);
+	m_midi.push_back((short)midi);
+	m_tokens.push_back(token);
+	m_fields.push_back((short)field);
+	m_subtokens.push_back((uint8_t)subtoken);
+	m_attacks.push_back(attack ? 1 : 0);
+	m_noteCount[line]++;
+
+	m_pitchClasses[line] |= (uint64_t)1 << pc40;
+	m_pitchClasses12[line] |= (uint16_t)(1 << pc12);
+	if (attack) {
+		m_attackCount[line]++;
+		m_attackPitchClasses[line] |= (uint64_t)1 << pc40;
+		m_attackPitchClasses12[line] |= (uint16_t)(1 << pc12);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumSonorityTable::getLineCount -- Return the number of lines in the
+//     file when the table was filled.
+//
+
+int HumSonorityTable::getLineCount(void) const {
+	return (int)m_noteStart.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumSonorityTable::getSliceCount -- Return the number of data lines.
+//
+
+int HumSonorityTable::getSliceCount(void) const {
+	return (int)m_dataLines.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumSonorityTable::getSonority -- Return the sonority on a line (which is
+//     empty for non-data lines).
+//
+
+HumSonority HumSonorityTable::getSonority(int line) const {
+	return HumSonority(this, line);
+}
+
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
@@ -0,0 +1,425 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 12:24:31 PDT 2026
+// Last Modified: Sun Oct 18 23:59:55 PDT 2026
+// Filename:      HumSpanTable.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumSpanTable.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Links between the start and end tokens of slurs and beams,
+//                stored in HumAnalysisTables and indexed by token id.
+//
+
+#include "HumSpanTable.h"
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+
+//////////////////////////////
+//
+// HumSpanTable::HumSpanTable -- Constructor.
+//
+
+HumSpanTable::HumSpanTable(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::clear -- Remove all links.
+//
+
+void HumSpanTable::clear(void) {
+	m_firstStart.clear();
+	m_firstEnd.clear();
+	m_startCount.clear();
+	m_endCount.clear();
+	m_flags.clear();
+	m_spanStart.clear();
+	m_startTokens.clear();
+	m_endTokens.clear();
+	m_startNumbers.clear();
+	m_endNumbers.clear();
+	m_durations.clear();
+	m_nextStart.clear();
+	m_nextEnd.clear();
+	m_hangingDurations.clear();
+	m_openIndexes.clear();
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::resize -- Remove all links and prepare the table
+//    for the given number of tokens.
+//
+
+void HumSpanTable::resize(int tokenCount) {
+	clear();
+	m_firstStart.assign(tokenCount, -1);
+	m_firstEnd.assign(tokenCount, -1);
+	m_startCount.assign(tokenCount, 0);
+	m_endCount.assign(tokenCount, 0);
+	m_flags.assign(tokenCount, 0);
+	m_spanStart.assign(tokenCount, NULL);
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::addLink -- Store a link between the start and end of a
+//    span.  The start number is the enumeration of the opening character
+//    on the start token, and the end number is the enumeration of the
+//    closing character on the end token.
+//
+
+void HumSpanTable::addLink(int startid, int endid, HTp starttok, HTp endtok,
+		int startnumber, int endnumber, HumNum duration) {
+	if ((startid < 0) || (startid >= (int)m_firstStart.size())) {
+		return;
+	}
+	if ((endid < 0) || (endid >= (int)m_firstEnd.size())) {
+		return;
+	}
+	std::unique_lock<std::mutex> lock;
+	if (m_mutex) {
+		lock = std::unique_lock<std::mutex>(*m_mutex);
+	}
+	int link = (int)m_startTokens.size();
+	m_startTokens.push_back(starttok);
+	m_endTokens.push_back(endtok);
+	m_startNumbers.push_back(startnumber);
+	m_endNumbers.push_back(endnumber);
+	m_durations.push_back(duration);
+	m_nextStart.push_back(m_firstStart[startid]);
+	m_nextEnd.push_back(m_firstEnd[endid]);
+	m_firstStart[startid] = link;
+	m_firstEnd[endid] = link;
+	m_startCount[startid]++;
+	m_endCount[endid]++;
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::addHanging -- Mark a token as having a span start or end
+//    which does not have a matching end or start.  Spans which end at the
+//    start of a repeat ending are marked with endingback set to true (and
+//    are not considered hanging).
+//
+
+void HumSpanTable::addHanging(int id, bool start, HumNum duration,
+		int openindex, bool endingback) {
+	if ((id < 0) || (id >= (int)m_flags.size())) {
+		return;
+	}
+	std::unique_lock<std::mutex> lock;
+	if (m_mutex) {
+		lock = std::unique_lock<std::mutex>(*m_mutex);
+	}
+	if (endingback) {
+		m_flags[id] |= FLAG_ENDING_BACK;
+	} else {
+		m_flags[id] &= ~(FLAG_HANGING_START | FLAG_HANGING_STOP);
+		m_flags[id] |= start ? FLAG_HANGING_START : FLAG_HANGING_STOP;
+	}
+	m_hangingDurations[id] = duration;
+	if (openindex >= 0) {
+		m_openIndexes[id] = openindex;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::setSpanMember -- Store the start of a span which contains
+//    the token (used for beams which cross barlines).
+//
+
+void HumSpanTable::setSpanMember(int id, HTp spanstart) {
+	if ((id < 0) || (id >= (int)m_flags.size())) {
+		return;
+	}
+	m_spanStart[id] = spanstart;
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::setSpanEndpoints -- Mark the start and end tokens of a
+//    span which crosses a barline.
+//
+
+void HumSpanTable::setSpanEndpoints(int startid, int endid) {
+	if ((startid >= 0) && (startid < (int)m_flags.size())) {
+		m_flags[startid] |= FLAG_SPAN_START;
+	}
+	if ((endid >= 0) && (endid < (int)m_flags.size())) {
+		m_flags[endid] |= FLAG_SPAN_END;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::findStartLink -- Return the link starting on the token
+//    with the given start number, or -1 if none.
+//
+
+int HumSpanTable::findStartLink(int id, int startnumber) const {
+	if ((id < 0) || (id >= (int)m_firstStart.size())) {
+		return -1;
+	}
+	for (int link=m_firstStart[id]; link>=0; link=m_nextStart[link]) {
+		if (m_startNumbers[link] == startnumber) {
+			return link;
+		}
+	}
+	return -1;
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::findEndLink -- Return the link ending on the token
+//    with the given end number, or -1 if none.
+//
+
+int HumSpanTable::findEndLink(int id, int endnumber) const {
+	if ((id < 0) || (id >= (int)m_firstEnd.size())) {
+		return -1;
+	}
+	for (int link=m_firstEnd[id]; link>=0; link=m_nextEnd[link]) {
+		if (m_endNumbers[link] == endnumber) {
+			return link;
+		}
+	}
+	return -1;
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::getEndToken -- Return the end token of the span which
+//    starts on the given token with the given start number, or NULL
+//    if none.
+//
+
+HTp HumSpanTable::getEndToken(int id, int startnumber) const {
+	int link = findStartLink(id, startnumber);
+	return link < 0 ? NULL : m_endTokens[link];
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::getStartToken -- Return the start token of the span which
+//    ends on the given token with the given end number, or NULL if none.
+//
+
+HTp HumSpanTable::getStartToken(int id, int endnumber) const {
+	int link = findEndLink(id, endnumber);
+	return link < 0 ? NULL : m_startTokens[link];
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::getEndNumber -- Return the end number (on the end token)
+//    for the span with the given start number on the token, or 0 if none.
+//
+
+int HumSpanTable::getEndNumber(int id, int startnumber) const {
+	int link = findStartLink(id, startnumber);
+	return link < 0 ? 0 : m_endNumbers[link];
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::getStartNumber -- Return the start number (on the start
+//    token) for the span with the given end number on the token, or 0
+//    if none.
+//
+
+int HumSpanTable::getStartNumber(int id, int endnumber) const {
+	int link = findEndLink(id, endnumber);
+	return link < 0 ? 0 : m_startNumbers[link];
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::getDuration -- Return the duration of the span which
+//    starts on the given token with the given start number.  For hanging
+//    spans, the duration stored with addHanging() is returned.  Returns 0
+//    if there is no span.
+//
+
+HumNum HumSpanTable::getDuration(int id, int startnumber) const {
+	int link = findStartLink(id, startnumber);
+	if (link >= 0) {
+		return m_durations[link];
+	}
+	if (startnumber == 1) {
+		auto it = m_hangingDurations.find(id);
+		if (it != m_hangingDurations.end()) {
+			return it->second;
+		}
+	}
+	return 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::getStartCount -- Return the number of linked spans
+//     starting on the token.
+//
+
+int HumSpanTable::getStartCount(int id) const {
+	if ((id < 0) || (id >= (int)m_startCount.size())) {
+		return 0;
+	}
+	return m_startCount[id];
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::getEndCount -- Return the number of linked spans
+//     ending on the token.
+//
+
+int HumSpanTable::getEndCount(int id) const {
+	if ((id < 0) || (id >= (int)m_endCount.size())) {
+		return 0;
+	}
+	return m_endCount[id];
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::getHangingSide -- Return +1 if the token has an unmatched
+//     span start, -1 if it has an unmatched span end, or 0 otherwise.
+//
+
+int HumSpanTable::getHangingSide(int id) const {
+	if ((id < 0) || (id >= (int)m_flags.size())) {
+		return 0;
+	}
+	if (m_flags[id] & FLAG_HANGING_START) {
+		return +1;
+	} else if (m_flags[id] & FLAG_HANGING_STOP) {
+		return -1;
+	}
+	return 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::getOpenIndex -- Return the index of the closing character
+//     of an unmatched span end on the token, or -1 if none.
+//
+
+int HumSpanTable::getOpenIndex(int id) const {
+	auto it = m_openIndexes.find(id);
+	if (it == m_openIndexes.end()) {
+		return -1;
+	}
+	return it->second;
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::isEndingBack -- Return true if the token ends a span which
+//     starts before a repeat ending.
+//
+
+bool HumSpanTable::isEndingBack(int id) const {
+	if ((id < 0) || (id >= (int)m_flags.size())) {
+		return false;
+	}
+	return m_flags[id] & FLAG_ENDING_BACK;
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::getSpanStart -- Return the start of the barline-crossing
+//     span containing the token, or NULL if none.
+//
+
+HTp HumSpanTable::getSpanStart(int id) const {
+	if ((id < 0) || (id >= (int)m_spanStart.size())) {
+		return NULL;
+	}
+	return m_spanStart[id];
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::isSpanStart -- Return true if the token starts a
+//     barline-crossing span.
+//
+
+bool HumSpanTable::isSpanStart(int id) const {
+	if ((id < 0) || (id >= (int)m_flags.size())) {
+		return false;
+	}
+	return m_flags[id] & FLAG_SPAN_START;
+}
+
+
+
+//////////////////////////////
+//
+// HumSpanTable::isSpanEnd -- Return true if the token ends a
+//     barline-crossing span.
+//
+
+bool HumSpanTable::isSpanEnd(int id) const {
+	if ((id < 0) || (id >= (int)m_flags.size())) {
+		return false;
+	}
+	return m_flags[id] & FLAG_SPAN_END;
+}
+
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
@@ -0,0 +1,366 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 12:24:31 PDT 2026
+// Last Modified: Sun Oct 18 23:59:55 PDT 2026
+// Filename:      HumStrandTable.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumStrandTable.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   The tokens of each spine strand of a file stored in
+//                contiguous arrays, filled in by
+//                HumdrumFileContent::analyzeStrandTable().
+//
+
+#include "HumStrandTable.h"
+#include "HumdrumToken.h"
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+
+//////////////////////////////
+//
+// HumStrandTable::HumStrandTable -- Constructor.
+//
+
+HumStrandTable::HumStrandTable(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::clear -- Remove all strands and entries.
+//
+
+void HumStrandTable::clear(void) {
+	m_lineCount = 0;
+	m_offsets.clear();
+	m_spines.clear();
+	m_tracks.clear();
+	m_tokens.clear();
+	m_lines.clear();
+	m_fields.clear();
+	m_startTimes.clear();
+	m_strophes.clear();
+	m_types.clear();
+	m_stropheStarts.clear();
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::setLineCount -- Store the number of lines in the file
+//     being analyzed.
+//
+
+void HumStrandTable::setLineCount(int lineCount) {
+	m_lineCount = lineCount;
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::addStrand -- Add a strand to the table, returning its
+//     index.  The tokens of the strand must be added before the next
+//     strand.
+//
+
+int HumStrandTable::addStrand(int spine) {
+	m_offsets.push_back((int)m_tokens.size());
+	m_spines.push_back(spine);
+	m_tracks.push_back(0);
+	return (int)m_offsets.size() - 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::addToken -- Add a token to the end of the last strand in
+//     the table, returning the index of its entry.
+//
+
+int HumStrandTable::addToken(HTp token) {
+	if (m_offsets.empty()) {
+		return -1;
+	}
+	int strophe = -1;
+	HTp start = token->getStrophe();
+	if (start) {
+		// Search from the last strophe, since tokens of a strophe are
+		// usually added together.
+		for (int i=(int)m_stropheStarts.size()-1; i>=0; i--) {
+			if (m_stropheStarts[i] == start) {
+				strophe = i;
+				break;
+			}
+		}
+		if (strophe < 0) {
+			m_stropheStarts.push_back(start);
+			strophe = (int)m_stropheStarts.size() - 1;
+		}
+	}
+	if ((int)m_tokens.size() == m_offsets.back()) {
+		m_tracks.back() = token->getTrack();
+	}
+	m_tokens.push_back(token);
+	m_lines.push_back(token->getLineIndex());
+	m_fields.push_back(token->getFieldIndex());
+	m_startTimes.push_back(token->getDurationFromStart());
+	m_strophes.push_back(strophe);
+	uint8_t type = 0;
+	if (token->isData()) {
+		type |= TYPE_DATA;
+		if (token->isNull()) {
+			type |= TYPE_NULL;
+		}
+	}
+	m_types.push_back(type);
+	return (int)m_tokens.size() - 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getLineCount -- Return the number of lines in the file
+//     when the table was filled.
+//
+
+int HumStrandTable::getLineCount(void) const {
+	return m_lineCount;
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getStrandCount -- Return the number of strands.
+//
+
+int HumStrandTable::getStrandCount(void) const {
+	return (int)m_offsets.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getStrandOffset -- Return the index of the first entry
+//     of a strand.
+//
+
+int HumStrandTable::getStrandOffset(int strand) const {
+	if ((strand < 0) || (strand >= (int)m_offsets.size())) {
+		return 0;
+	}
+	return m_offsets[strand];
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getStrandSize -- Return the number of entries (tokens)
+//     in a strand.
+//
+
+int HumStrandTable::getStrandSize(int strand) const {
+	if ((strand < 0) || (strand >= (int)m_offsets.size())) {
+		return 0;
+	}
+	if (strand == (int)m_offsets.size() - 1) {
+		return (int)m_tokens.size() - m_offsets[strand];
+	}
+	return m_offsets[strand + 1] - m_offsets[strand];
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getStrandSpine -- Return the index of the spine (in the
+//     order of the exclusive interpretations) that a strand belongs to.
+//
+
+int HumStrandTable::getStrandSpine(int strand) const {
+	if ((strand < 0) || (strand >= (int)m_spines.size())) {
+		return -1;
+	}
+	return m_spines[strand];
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getStrandTrack -- Return the track number of a strand.
+//
+
+int HumStrandTable::getStrandTrack(int strand) const {
+	if ((strand < 0) || (strand >= (int)m_tracks.size())) {
+		return 0;
+	}
+	return m_tracks[strand];
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getEntryCount -- Return the number of entries in all
+//     strands.
+//
+
+int HumStrandTable::getEntryCount(void) const {
+	return (int)m_tokens.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getToken -- Return the token of an entry.
+//
+
+HTp HumStrandTable::getToken(int entry) const {
+	if ((entry < 0) || (entry >= (int)m_tokens.size())) {
+		return NULL;
+	}
+	return m_tokens[entry];
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getLine -- Return the line index of the token of an
+//     entry.
+//
+
+int HumStrandTable::getLine(int entry) const {
+	if ((entry < 0) || (entry >= (int)m_lines.size())) {
+		return -1;
+	}
+	return m_lines[entry];
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getField -- Return the field index of the token of an
+//     entry.
+//
+
+int HumStrandTable::getField(int entry) const {
+	if ((entry < 0) || (entry >= (int)m_fields.size())) {
+		return -1;
+	}
+	return m_fields[entry];
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getStartTime -- Return the start time of the token of
+//     an entry in quarter notes from the start of the file.
+//
+
+HumNum HumStrandTable::getStartTime(int entry) const {
+	if ((entry < 0) || (entry >= (int)m_startTimes.size())) {
+		return 0;
+	}
+	return m_startTimes[entry];
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getStrophe -- Return the index of the strophe
+//     containing the token of an entry, or -1 if the token is not in a
+//     strophe.
+//
+
+int HumStrandTable::getStrophe(int entry) const {
+	if ((entry < 0) || (entry >= (int)m_strophes.size())) {
+		return -1;
+	}
+	return m_strophes[entry];
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getStropheCount -- Return the number of strophes in the
+//     strands.
+//
+
+int HumStrandTable::getStropheCount(void) const {
+	return (int)m_stropheStarts.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::getStropheStart -- Return the *S/ interpretation that
+//     starts a strophe.
+//
+
+HTp HumStrandTable::getStropheStart(int strophe) const {
+	if ((strophe < 0) || (strophe >= (int)m_stropheStarts.size())) {
+		return NULL;
+	}
+	return m_stropheStarts[strophe];
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::isData -- Return true if the token of an entry is on a
+//     data line.
+//
+
+bool HumStrandTable::isData(int entry) const {
+	if ((entry < 0) || (entry >= (int)m_types.size())) {
+		return false;
+	}
+	return m_types[entry] & TYPE_DATA;
+}
+
+
+
+//////////////////////////////
+//
+// HumStrandTable::isNull -- Return true if the token of an entry is a
+//     null data token.
+//
+
+bool HumStrandTable::isNull(int entry) const {
+	if ((entry < 0) || (entry >= (int)m_types.size())) {
+		return false;
+	}
+	return m_types[entry] & TYPE_NULL;
+}
+
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
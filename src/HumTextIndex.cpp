@@ -0,0 +1,383 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 21:31:12 PDT 2026
+// Last Modified: Sun Oct 18 23:59:59 PDT 2026
+// Filename:      HumTextIndex.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumTextIndex.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Inverted index of the words in the lyrics of a corpus,
+//                and reading/writing of the index text format.
+//
+
+#include "HumTextIndex.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+
+//////////////////////////////
+//
+// HumTextIndex::HumTextIndex -- Constructor.
+//
+
+HumTextIndex::HumTextIndex(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::clear -- Remove all files and words.
+//
+
+void HumTextIndex::clear(void) {
+	m_files.clear();
+	m_words.clear();
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::addFile -- Add the words of the lyric spines of a file to
+//     the index, returning the index of the file.
+//
+
+int HumTextIndex::addFile(HumdrumFile& infile, const string& filename) {
+	int file = (int)m_files.size();
+	m_files.push_back(filename);
+	if (infile.getLineCount() == 0) {
+		return file;
+	}
+	const HumTextTable& table = infile.getTextTable();
+	HumTextPosting posting;
+	posting.file = file;
+	for (int i=0; i<table.getSpineCount(); i++) {
+		posting.spine = i;
+		posting.position = 0;
+		posting.track = table.getSpineStart(i)->getTrack();
+		int start = table.getSpineWordStart(i);
+		int count = table.getSpineWordCount(i);
+		for (int j=start; j<start+count; j++) {
+			const string& word = table.getNormalizedWord(j);
+			if (word.empty()) {
+				continue;
+			}
+			HTp token = table.getWordToken(j);
+			posting.line  = token->getLineIndex();
+			posting.field = token->getFieldIndex();
+			posting.notes = table.getWordNoteCount(j);
+			size_t begin = 0;
+			while (begin < word.size()) {
+				size_t end = word.find(' ', begin);
+				if (end == string::npos) {
+					end = word.size();
+				}
+				m_words[word.substr(begin, end - begin)].push_back(posting);
+				posting.position++;
+				begin = end + 1;
+			}
+		}
+	}
+	return file;
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::append -- Add the files and words of another index after
+//     the files of this index.
+//
+
+void HumTextIndex::append(const HumTextIndex& index) {
+	int offset = (int)m_files.size();
+	m_files.insert(m_files.end(), index.m_files.begin(), index.m_files.end());
+	for (auto& entry : index.m_words) {
+		vector<HumTextPosting>& postings = m_words[entry.first];
+		postings.reserve(postings.size() + entry.second.size());
+		for (int i=0; i<(int)entry.second.size(); i++) {
+			postings.push_back(entry.second[i]);
+			postings.back().file += offset;
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::getFileCount -- Return the number of files in the index.
+//
+
+int HumTextIndex::getFileCount(void) const {
+	return (int)m_files.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::getFilename -- Return the name of a file in the index.
+//
+
+const string& HumTextIndex::getFilename(int file) const {
+	static const string empty;
+	if ((file < 0) || (file >= (int)m_files.size())) {
+		return empty;
+	}
+	return m_files[file];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::getWordCount -- Return the number of distinct words in
+//     the index.
+//
+
+int HumTextIndex::getWordCount(void) const {
+	return (int)m_words.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::getWordList -- Return the distinct words of the index in
+//     sorted order.
+//
+
+void HumTextIndex::getWordList(vector<string>& words) const {
+	words.clear();
+	words.reserve(m_words.size());
+	for (auto& entry : m_words) {
+		words.push_back(entry.first);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::find -- Return the occurrences of a normalized word, or
+//     NULL if the word is not in the index.
+//
+
+const vector<HumTextPosting>* HumTextIndex::find(const string& word) const {
+	auto it = m_words.find(word);
+	if (it == m_words.end()) {
+		return NULL;
+	}
+	return &it->second;
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::search -- Find the occurrences of a word or phrase.  The
+//     query is normalized, and for a phrase the words must be at
+//     consecutive positions in a lyric spine.  If prefix is true, each
+//     word of the query matches any word starting with it.  The matches
+//     are the postings of the first word of each occurrence, sorted by
+//     file, spine and position.  Returns the number of matches.
+//
+
+int HumTextIndex::search(vector<HumTextPosting>& matches, const string& query,
+		bool prefix) const {
+	matches.clear();
+	string normal = HumTextTable::normalize(query);
+	vector<string> words;
+	stringstream stream(normal);
+	string word;
+	while (stream >> word) {
+		words.push_back(word);
+	}
+	if (words.empty()) {
+		return 0;
+	}
+
+	getPostings(matches, words[0], prefix);
+	vector<HumTextPosting> next;
+	vector<HumTextPosting> kept;
+	for (int i=1; (i<(int)words.size()) && !matches.empty(); i++) {
+		getPostings(next, words[i], prefix);
+		kept.clear();
+		HumTextPosting target;
+		for (int j=0; j<(int)matches.size(); j++) {
+			target.file     = matches[j].file;
+			target.spine    = matches[j].spine;
+			target.position = matches[j].position + i;
+			if (binary_search(next.begin(), next.end(), target, isBefore)) {
+				kept.push_back(matches[j]);
+			}
+		}
+		matches.swap(kept);
+	}
+	return (int)matches.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::getPostings -- Get the occurrences of a word (or of all
+//     words starting with it if prefix is true), sorted by file, spine and
+//     position.
+//
+
+void HumTextIndex::getPostings(vector<HumTextPosting>& postings,
+		const string& word, bool prefix) const {
+	postings.clear();
+	if (!prefix) {
+		const vector<HumTextPosting>* found = find(word);
+		if (found) {
+			postings = *found;
+		}
+		return;
+	}
+	for (auto it = m_words.lower_bound(word); it != m_words.end(); ++it) {
+		if (it->first.compare(0, word.size(), word) != 0) {
+			break;
+		}
+		postings.insert(postings.end(), it->second.begin(), it->second.end());
+	}
+	sort(postings.begin(), postings.end(), isBefore);
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::isBefore -- Order of postings by file, spine and position.
+//
+
+bool HumTextIndex::isBefore(const HumTextPosting& a, const HumTextPosting& b) {
+	if (a.file != b.file) {
+		return a.file < b.file;
+	}
+	if (a.spine != b.spine) {
+		return a.spine < b.spine;
+	}
+	return a.position < b.position;
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::write -- Write the index in its text form.
+//
+
+bool HumTextIndex::write(ostream& out) const {
+	out << "!!!HUMTEXTINDEX: 1\n";
+	for (int i=0; i<(int)m_files.size(); i++) {
+		out << "@file\t" << m_files[i] << '\n';
+	}
+	for (auto& entry : m_words) {
+		out << entry.first;
+		for (const HumTextPosting& p : entry.second) {
+			out << '\t' << p.file << ':' << p.line << ':' << p.field << ':'
+			    << p.track << ':' << p.spine << ':' << p.position << ':' << p.notes;
+		}
+		out << '\n';
+	}
+	out.flush();
+	return (bool)out;
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::writeFile --
+//
+
+bool HumTextIndex::writeFile(const string& filename) const {
+	std::ofstream output(filename);
+	if (!output.is_open()) {
+		return false;
+	}
+	return write(output);
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::read -- Read an index in its text form, replacing the
+//     contents of the index.  Returns false if the input is not a valid
+//     index.
+//
+
+bool HumTextIndex::read(istream& in) {
+	clear();
+	string line;
+	if (!getline(in, line) || (line != "!!!HUMTEXTINDEX: 1")) {
+		return false;
+	}
+	while (getline(in, line)) {
+		if (line.empty()) {
+			continue;
+		}
+		if (line.compare(0, 6, "@file\t") == 0) {
+			m_files.push_back(line.substr(6));
+			continue;
+		}
+		size_t tab = line.find('\t');
+		if ((tab == 0) || (tab == string::npos)) {
+			clear();
+			return false;
+		}
+		vector<HumTextPosting>& postings = m_words[line.substr(0, tab)];
+		while (tab != string::npos) {
+			HumTextPosting p;
+			int count = sscanf(line.c_str() + tab + 1, "%d:%d:%d:%d:%d:%d:%d",
+					&p.file, &p.line, &p.field, &p.track, &p.spine, &p.position,
+					&p.notes);
+			if ((count != 7) || (p.file < 0) || (p.file >= (int)m_files.size())) {
+				clear();
+				return false;
+			}
+			postings.push_back(p);
+			tab = line.find('\t', tab + 1);
+		}
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumTextIndex::readFile --
+//
+
+bool HumTextIndex::readFile(const string& filename) {
+	ifstream input(filename);
+	if (!input.is_open()) {
+		return false;
+	}
+	return read(input);
+}
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
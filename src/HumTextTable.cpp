@@ -0,0 +1,532 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 12:24:31 PDT 2026
+// Last Modified: Sun Oct 18 23:59:55 PDT 2026
+// Filename:      HumTextTable.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumTextTable.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   The syllables of the lyric spines of a file assembled into
+//                words, filled in by HumdrumFileContent::analyzeText().
+//
+
+#include "HumTextTable.h"
+#include "HumdrumToken.h"
+
+#include <cctype>
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+
+//////////////////////////////
+//
+// HumTextTable::HumTextTable -- Constructor.
+//
+
+HumTextTable::HumTextTable(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::clear -- Remove all spines, syllables and words.
+//
+
+void HumTextTable::clear(void) {
+	m_lineCount = 0;
+	m_spineStarts.clear();
+	m_spineSyllables.clear();
+	m_spineWords.clear();
+	m_syllables.clear();
+	m_syllableWords.clear();
+	m_noteCounts.clear();
+	m_firstNotes.clear();
+	m_lastNotes.clear();
+	m_endTimes.clear();
+	m_words.clear();
+	m_normalized.clear();
+	m_wordSpines.clear();
+	m_wordSyllables.clear();
+	m_wordNotes.clear();
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::setLineCount -- Store the number of lines in the file
+//     being analyzed.
+//
+
+void HumTextTable::setLineCount(int lineCount) {
+	m_lineCount = lineCount;
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::addSpine -- Add a lyric spine to the table, returning its
+//     index.  The syllables of the spine must be added before the next
+//     spine.
+//
+
+int HumTextTable::addSpine(HTp start) {
+	m_spineStarts.push_back(start);
+	m_spineSyllables.push_back((int)m_syllables.size());
+	m_spineWords.push_back((int)m_words.size());
+	return (int)m_spineStarts.size() - 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::addSyllable -- Add a syllable to the last spine in the
+//     table, either starting a new word or continuing the previous word of
+//     the spine, and return the index of the syllable.  The notes of the
+//     syllable are set later with setNotes().
+//
+
+int HumTextTable::addSyllable(int spine, HTp token) {
+	if ((spine < 0) || (spine != (int)m_spineStarts.size() - 1)) {
+		return -1;
+	}
+	string text = *token;
+	bool continuation = false;
+	if ((!text.empty()) && (text[0] == '-')) {
+		text.erase(0, 1);
+		continuation = (int)m_words.size() > m_spineWords[spine];
+	}
+	if ((!text.empty()) && (text.back() == '-')) {
+		text.pop_back();
+	}
+
+	int syllable = (int)m_syllables.size();
+	if (continuation) {
+		m_words.back() += text;
+		m_normalized.back() = normalize(m_words.back());
+	} else {
+		m_words.push_back(text);
+		m_normalized.push_back(normalize(text));
+		m_wordSpines.push_back(spine);
+		m_wordSyllables.push_back(syllable);
+		m_wordNotes.push_back(0);
+	}
+	m_syllables.push_back(token);
+	m_syllableWords.push_back((int)m_words.size() - 1);
+	m_noteCounts.push_back(0);
+	m_firstNotes.push_back(NULL);
+	m_lastNotes.push_back(NULL);
+	m_endTimes.push_back(token->getDurationFromStart());
+	return syllable;
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::setNotes -- Store the notes that a syllable is sung on:
+//     the number of note attacks, the first and last note tokens (NULL if
+//     none), and the end time of the last note.
+//
+
+void HumTextTable::setNotes(int syllable, int count, HTp first, HTp last,
+		HumNum endtime) {
+	if ((syllable < 0) || (syllable >= (int)m_syllables.size())) {
+		return;
+	}
+	m_wordNotes[m_syllableWords[syllable]] += count - m_noteCounts[syllable];
+	m_noteCounts[syllable] = count;
+	m_firstNotes[syllable] = first;
+	m_lastNotes[syllable]  = last;
+	m_endTimes[syllable]   = endtime;
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getLineCount -- Return the number of lines in the file
+//     when the table was filled.
+//
+
+int HumTextTable::getLineCount(void) const {
+	return m_lineCount;
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getSpineCount -- Return the number of lyric spines.
+//
+
+int HumTextTable::getSpineCount(void) const {
+	return (int)m_spineStarts.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getSpineStart -- Return the exclusive interpretation of
+//     a lyric spine.
+//
+
+HTp HumTextTable::getSpineStart(int spine) const {
+	if ((spine < 0) || (spine >= (int)m_spineStarts.size())) {
+		return NULL;
+	}
+	return m_spineStarts[spine];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getSpineSyllableStart -- Return the index of the first
+//     syllable of a spine.
+//
+
+int HumTextTable::getSpineSyllableStart(int spine) const {
+	if ((spine < 0) || (spine >= (int)m_spineStarts.size())) {
+		return 0;
+	}
+	return m_spineSyllables[spine];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getSpineSyllableCount -- Return the number of syllables
+//     in a spine.
+//
+
+int HumTextTable::getSpineSyllableCount(int spine) const {
+	if ((spine < 0) || (spine >= (int)m_spineStarts.size())) {
+		return 0;
+	}
+	if (spine == (int)m_spineStarts.size() - 1) {
+		return (int)m_syllables.size() - m_spineSyllables[spine];
+	}
+	return m_spineSyllables[spine + 1] - m_spineSyllables[spine];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getSpineWordStart -- Return the index of the first word
+//     of a spine.
+//
+
+int HumTextTable::getSpineWordStart(int spine) const {
+	if ((spine < 0) || (spine >= (int)m_spineStarts.size())) {
+		return 0;
+	}
+	return m_spineWords[spine];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getSpineWordCount -- Return the number of words in a
+//     spine.
+//
+
+int HumTextTable::getSpineWordCount(int spine) const {
+	if ((spine < 0) || (spine >= (int)m_spineStarts.size())) {
+		return 0;
+	}
+	if (spine == (int)m_spineStarts.size() - 1) {
+		return (int)m_words.size() - m_spineWords[spine];
+	}
+	return m_spineWords[spine + 1] - m_spineWords[spine];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getSyllableCount -- Return the number of syllables in
+//     all spines.
+//
+
+int HumTextTable::getSyllableCount(void) const {
+	return (int)m_syllables.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getSyllableToken -- Return the token of a syllable.
+//
+
+HTp HumTextTable::getSyllableToken(int syllable) const {
+	if ((syllable < 0) || (syllable >= (int)m_syllables.size())) {
+		return NULL;
+	}
+	return m_syllables[syllable];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getSyllableSpine -- Return the spine of a syllable.
+//
+
+int HumTextTable::getSyllableSpine(int syllable) const {
+	if ((syllable < 0) || (syllable >= (int)m_syllables.size())) {
+		return -1;
+	}
+	return m_wordSpines[m_syllableWords[syllable]];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getSyllableWord -- Return the word containing a syllable.
+//
+
+int HumTextTable::getSyllableWord(int syllable) const {
+	if ((syllable < 0) || (syllable >= (int)m_syllables.size())) {
+		return -1;
+	}
+	return m_syllableWords[syllable];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getNoteCount -- Return the number of notes attacked
+//     on a syllable (its melisma length).
+//
+
+int HumTextTable::getNoteCount(int syllable) const {
+	if ((syllable < 0) || (syllable >= (int)m_syllables.size())) {
+		return 0;
+	}
+	return m_noteCounts[syllable];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getFirstNote -- Return the **kern token on the line of a
+//     syllable (which may be a null token), or NULL if there is no **kern
+//     spine for the syllable.
+//
+
+HTp HumTextTable::getFirstNote(int syllable) const {
+	if ((syllable < 0) || (syllable >= (int)m_syllables.size())) {
+		return NULL;
+	}
+	return m_firstNotes[syllable];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getLastNote -- Return the last note (or tied note)
+//     sung on a syllable, or NULL if there are no notes.
+//
+
+HTp HumTextTable::getLastNote(int syllable) const {
+	if ((syllable < 0) || (syllable >= (int)m_syllables.size())) {
+		return NULL;
+	}
+	return m_lastNotes[syllable];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getEndTime -- Return the end of the last note sung on a
+//     syllable in quarter notes from the start of the file (the start of
+//     the syllable if there are no notes).
+//
+
+HumNum HumTextTable::getEndTime(int syllable) const {
+	if ((syllable < 0) || (syllable >= (int)m_syllables.size())) {
+		return 0;
+	}
+	return m_endTimes[syllable];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getWordCount -- Return the number of words in all spines.
+//
+
+int HumTextTable::getWordCount(void) const {
+	return (int)m_words.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getWordText -- Return the syllables of a word joined
+//     without their hyphens.
+//
+
+const string& HumTextTable::getWordText(int word) const {
+	static const string empty;
+	if ((word < 0) || (word >= (int)m_words.size())) {
+		return empty;
+	}
+	return m_words[word];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getNormalizedWord -- Return the normalized form of a word
+//     (see normalize()).
+//
+
+const string& HumTextTable::getNormalizedWord(int word) const {
+	static const string empty;
+	if ((word < 0) || (word >= (int)m_normalized.size())) {
+		return empty;
+	}
+	return m_normalized[word];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getWordToken -- Return the token of the first syllable
+//     of a word.
+//
+
+HTp HumTextTable::getWordToken(int word) const {
+	if ((word < 0) || (word >= (int)m_words.size())) {
+		return NULL;
+	}
+	return m_syllables[m_wordSyllables[word]];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getWordSpine -- Return the spine of a word.
+//
+
+int HumTextTable::getWordSpine(int word) const {
+	if ((word < 0) || (word >= (int)m_words.size())) {
+		return -1;
+	}
+	return m_wordSpines[word];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getWordSyllableStart -- Return the first syllable of a
+//     word.
+//
+
+int HumTextTable::getWordSyllableStart(int word) const {
+	if ((word < 0) || (word >= (int)m_words.size())) {
+		return -1;
+	}
+	return m_wordSyllables[word];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getWordSyllableCount -- Return the number of syllables
+//     in a word.
+//
+
+int HumTextTable::getWordSyllableCount(int word) const {
+	if ((word < 0) || (word >= (int)m_words.size())) {
+		return 0;
+	}
+	if (word == (int)m_words.size() - 1) {
+		return (int)m_syllables.size() - m_wordSyllables[word];
+	}
+	return m_wordSyllables[word + 1] - m_wordSyllables[word];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::getWordNoteCount -- Return the number of notes attacked
+//     on all syllables of a word.
+//
+
+int HumTextTable::getWordNoteCount(int word) const {
+	if ((word < 0) || (word >= (int)m_words.size())) {
+		return 0;
+	}
+	return m_wordNotes[word];
+}
+
+
+
+//////////////////////////////
+//
+// HumTextTable::normalize -- Return the form of a word used for searching:
+//     ASCII letters are lowercased, punctuation is removed (except for
+//     apostrophes), and spaces are reduced to single spaces between words.
+//     UTF-8 characters are not changed.
+//
+
+string HumTextTable::normalize(const string& text) {
+	string output;
+	output.reserve(text.size());
+	bool space = false;
+	for (int i=0; i<(int)text.size(); i++) {
+		unsigned char ch = (unsigned char)text[i];
+		if (isspace(ch)) {
+			space = !output.empty();
+			continue;
+		}
+		if ((ch < 0x80) && !isalnum(ch) && (ch != '\'')) {
+			continue;
+		}
+		if (space) {
+			output += ' ';
+			space = false;
+		}
+		output += (char)tolower(ch);
+	}
+	return output;
+}
+
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
@@ -0,0 +1,154 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 14:02:11 PDT 2026
+// Last Modified: Sun Oct 18 14:02:15 PDT 2026
+// Filename:      HumTokenLinks.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumTokenLinks.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   List of links from a token to the next or previous
+//                tokens in a spine.
+//
+
+#include "HumTokenLinks.h"
+
+#include <cstddef>
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+
+//////////////////////////////
+//
+// HumTokenLinks::HumTokenLinks -- Constructor.
+//
+
+HumTokenLinks::HumTokenLinks(void) {
+	m_single   = NULL;
+	m_size     = 0;
+	m_capacity = 1;
+}
+
+
+HumTokenLinks::HumTokenLinks(const HumTokenLinks& links) {
+	m_single   = NULL;
+	m_size     = 0;
+	m_capacity = 1;
+	*this = links;
+}
+
+
+
+//////////////////////////////
+//
+// HumTokenLinks::~HumTokenLinks -- Deconstructor.
+//
+
+HumTokenLinks::~HumTokenLinks() {
+	if (m_capacity > 1) {
+		delete [] m_list;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumTokenLinks::operator= -- Copy the links of another list.
+//
+
+HumTokenLinks& HumTokenLinks::operator=(const HumTokenLinks& links) {
+	if (this == &links) {
+		return *this;
+	}
+	reserve(links.m_size);
+	const HTp* source = links.data();
+	HTp* target = data();
+	for (int i=0; i<links.m_size; i++) {
+		target[i] = source[i];
+	}
+	m_size = links.m_size;
+	return *this;
+}
+
+
+
+//////////////////////////////
+//
+// HumTokenLinks::resize -- Change the number of links in the list.  New
+//     links are set to NULL.
+//
+
+void HumTokenLinks::resize(int newsize) {
+	if (newsize < 0) {
+		newsize = 0;
+	}
+	reserve(newsize);
+	HTp* target = data();
+	for (int i=m_size; i<newsize; i++) {
+		target[i] = NULL;
+	}
+	m_size = newsize;
+}
+
+
+
+//////////////////////////////
+//
+// HumTokenLinks::push_back -- Add a link to the end of the list.
+//
+
+void HumTokenLinks::push_back(HTp token) {
+	if (m_size >= m_capacity) {
+		reserve(m_capacity * 2);
+	}
+	data()[m_size++] = token;
+}
+
+
+
+//////////////////////////////
+//
+// HumTokenLinks::toVector -- Return a copy of the links as a vector.
+//
+
+vector<HTp> HumTokenLinks::toVector(void) const {
+	const HTp* source = data();
+	return vector<HTp>(source, source + m_size);
+}
+
+
+
+//////////////////////////////
+//
+// HumTokenLinks::reserve -- Make sure that there is storage for at least
+//     the given number of links.
+//
+
+void HumTokenLinks::reserve(int capacity) {
+	if (capacity <= m_capacity) {
+		return;
+	}
+	HTp* newlist = new HTp[capacity];
+	const HTp* source = data();
+	for (int i=0; i<m_size; i++) {
+		newlist[i] = source[i];
+	}
+	if (m_capacity > 1) {
+		delete [] m_list;
+	}
+	m_list = newlist;
+	m_capacity = capacity;
+}
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
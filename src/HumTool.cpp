@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Nov 28 08:55:15 PST 2016
-// Last Modified: Tue Dec 20 22:33:15 PST 2016
+// Last Modified: Sun Oct 18 23:59:12 PDT 2026
 // Filename:      HumTool.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumTool.cpp
 // Syntax:        C++11; humlib
@@ -36,7 +36,10 @@ HumTool::HumTool(void) {
 //
 
 HumTool::~HumTool() {
-	// do nothing
+	// Don't flush the sinks, since they may have been deleted already.
+	m_humdrum_text.std::ios::rdbuf(m_humdrum_text.rdbuf());
+	m_json_text.std::ios::rdbuf(m_json_text.rdbuf());
+	m_free_text.std::ios::rdbuf(m_free_text.rdbuf());
 }
 
 
@@ -51,9 +54,7 @@ bool HumTool::hasAnyText(void) {
 	if (m_suppress) {
 		return true;
 	}
-	return ((!m_humdrum_text.str().empty())
-			|| (!m_free_text.str().empty())
-			|| (!m_json_text.str().empty()));
+	return hasHumdrumText() || hasJsonText() || hasFreeText();
 }
 
 
@@ -75,9 +76,9 @@ string HumTool::getAllText(void) {
 //
 
 ostream& HumTool::getAllText(ostream& out) {
-	out << m_humdrum_text.str();
-	out << m_json_text.str();
-	out << m_free_text.str();
+	printStreamText(out, m_humdrum_text);
+	printStreamText(out, m_json_text);
+	printStreamText(out, m_free_text);
 	return out;
 }
 
@@ -101,7 +102,10 @@ void HumTool::suppressHumdrumFileOutput(void) {
 //
 
 bool HumTool::hasHumdrumText(void) {
-	return m_humdrum_text.str().empty() ? false : true;
+	if (m_humdrum_sink) {
+		return hasSinkText(m_humdrum_sink, m_humdrum_sink_start);
+	}
+	return hasStreamText(m_humdrum_text);
 }
 
 
@@ -121,7 +125,7 @@ string HumTool::getHumdrumText(void) {
 //
 
 ostream& HumTool::getHumdrumText(ostream& out) {
-	out << m_humdrum_text.str();
+	printStreamText(out, m_humdrum_text);
 	return out;
 }
 
@@ -133,7 +137,10 @@ ostream& HumTool::getHumdrumText(ostream& out) {
 //
 
 bool HumTool::hasFreeText(void) {
-	return m_free_text.str().empty() ? false : true;
+	if (m_free_sink) {
+		return hasSinkText(m_free_sink, m_free_sink_start);
+	}
+	return hasStreamText(m_free_text);
 }
 
 
@@ -153,7 +160,7 @@ string HumTool::getFreeText(void) {
 //
 
 ostream& HumTool::getFreeText(ostream& out) {
-	out << m_free_text.str();
+	printStreamText(out, m_free_text);
 	return out;
 }
 
@@ -165,7 +172,10 @@ ostream& HumTool::getFreeText(ostream& out) {
 //
 
 bool HumTool::hasJsonText(void) {
-	return m_json_text.str().empty() ? false : true;
+	if (m_json_sink) {
+		return hasSinkText(m_json_sink, m_json_sink_start);
+	}
+	return hasStreamText(m_json_text);
 }
 
 
@@ -185,7 +195,7 @@ string HumTool::getJsonText(void) {
 //
 
 ostream& HumTool::getJsonText(ostream& out) {
-	out << m_json_text.str();
+	printStreamText(out, m_json_text);
 	return out;
 }
 
@@ -274,6 +284,15 @@ void HumTool::clearOutput(void) {
 	m_free_text.str("");
   	m_warning_text.str("");
   	m_error_text.str("");
+	if (m_humdrum_sink) {
+		m_humdrum_sink_start = m_humdrum_sink->getByteCount();
+	}
+	if (m_json_sink) {
+		m_json_sink_start = m_json_sink->getByteCount();
+	}
+	if (m_free_sink) {
+		m_free_sink_start = m_free_sink->getByteCount();
+	}
 }
 
 
@@ -289,6 +308,139 @@ void HumTool::setError(const string& message) {
 
 
 
+//////////////////////////////
+//
+// HumTool::setOutputSink -- Send the Humdrum, JSON and free text output
+//     of the tool directly to the given sink rather than storing it in
+//     the tool.  Text already stored in the tool is not moved to the
+//     sink.  The get*Text() functions return nothing for output that
+//     was sent to a sink, but the has*Text() functions still report
+//     whether there was any output (which is needed to decide whether
+//     to print the input file instead).  If one sink is used for several
+//     types of output, the has*Text() functions cannot tell them apart.
+//     Use NULL to store the output in the tool again.
+//
+
+void HumTool::setOutputSink(HumOutputSink* sink) {
+	setHumdrumSink(sink);
+	setJsonSink(sink);
+	setFreeTextSink(sink);
+}
+
+
+
+//////////////////////////////
+//
+// HumTool::setHumdrumSink -- Send only the Humdrum text output to the
+//     given sink.
+//
+
+void HumTool::setHumdrumSink(HumOutputSink* sink) {
+	attachSink(m_humdrum_text, sink, m_humdrum_sink, m_humdrum_sink_start);
+}
+
+
+
+//////////////////////////////
+//
+// HumTool::setJsonSink -- Send only the JSON text output to the given sink.
+//
+
+void HumTool::setJsonSink(HumOutputSink* sink) {
+	attachSink(m_json_text, sink, m_json_sink, m_json_sink_start);
+}
+
+
+
+//////////////////////////////
+//
+// HumTool::setFreeTextSink -- Send only the free text output to the
+//     given sink.
+//
+
+void HumTool::setFreeTextSink(HumOutputSink* sink) {
+	attachSink(m_free_text, sink, m_free_sink, m_free_sink_start);
+}
+
+
+
+//////////////////////////////
+//
+// HumTool::clearOutputSinks -- Flush and detach all output sinks.
+//
+
+void HumTool::clearOutputSinks(void) {
+	setOutputSink(NULL);
+}
+
+
+
+//////////////////////////////
+//
+// HumTool::attachSink -- Redirect an output stream to a sink, or back to
+//     its own string buffer if the sink is NULL.  The previous sink is
+//     flushed.
+//
+
+void HumTool::attachSink(stringstream& stream, HumOutputSink* sink,
+		HumOutputSink*& current, size_t& start) {
+	if (current) {
+		current->flush();
+	}
+	current = sink;
+	start = sink ? sink->getByteCount() : 0;
+	if (sink) {
+		stream.std::ios::rdbuf(sink);
+	} else {
+		// stringstream::rdbuf() returns the stream's own string buffer:
+		stream.std::ios::rdbuf(stream.rdbuf());
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumTool::hasSinkText -- Return true if anything has been written to
+//     the sink since the given byte count.
+//
+
+bool HumTool::hasSinkText(HumOutputSink* sink, size_t start) {
+	return sink->getByteCount() > start;
+}
+
+
+
+//////////////////////////////
+//
+// HumTool::hasStreamText -- Return true if the string buffer of the
+//     stream is not empty.  This avoids copying the contents with str().
+//
+
+bool HumTool::hasStreamText(stringstream& stream) {
+	return stream.rdbuf()->sgetc() != stringstream::traits_type::eof();
+}
+
+
+
+//////////////////////////////
+//
+// HumTool::printStreamText -- Print the contents of the string buffer
+//     of the stream without copying it into a temporary string.  The
+//     read position is rewound afterwards so that the text can be
+//     printed again.
+//
+
+void HumTool::printStreamText(ostream& out, stringstream& stream) {
+	if (!hasStreamText(stream)) {
+		return;
+	}
+	out << stream.rdbuf();
+	stream.rdbuf()->pubseekpos(0, std::ios::in);
+}
+
+
+
 
 // END_MERGE
 
@@ -0,0 +1,998 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 17:31:08 PDT 2026
+// Last Modified: Sun Oct 18 23:59:59 PDT 2026
+// Filename:      HumToolServer.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumToolServer.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Long-running service that runs Humdrum tools on requests
+//                read from a stream.  See HumToolServer.h for a description
+//                of the request and response formats.
+//
+
+#include "HumToolServer.h"
+
+#include "HumdrumFileSet.h"
+#include "HumdrumFileStream.h"
+
+// tools which the server can run:
+
+#include "tool-1520ify.h"
+#include "tool-addic.h"
+#include "tool-addkey.h"
+#include "tool-addlabels.h"
+#include "tool-addtempo.h"
+#include "tool-autoaccid.h"
+#include "tool-autobeam.h"
+#include "tool-autocadence.h"
+#include "tool-autostem.h"
+#include "tool-binroll.h"
+#include "tool-bstyle.h"
+#include "tool-chantize.h"
+#include "tool-chint.h"
+#include "tool-chooser.h"
+#include "tool-chord.h"
+#include "tool-cint.h"
+#include "tool-cmr.h"
+#include "tool-colorgroups.h"
+#include "tool-colortriads.h"
+#include "tool-composite.h"
+#include "tool-compositeold.h"
+#include "tool-deg.h"
+#include "tool-dissonant.h"
+#include "tool-double.h"
+#include "tool-extract.h"
+#include "tool-fb.h"
+#include "tool-filter.h"
+#include "tool-fixps.h"
+#include "tool-flipper.h"
+#include "tool-gasparize.h"
+#include "tool-grep.h"
+#include "tool-half.h"
+#include "tool-hands.h"
+#include "tool-homorhythm.h"
+#include "tool-homorhythm2.h"
+#include "tool-hproof.h"
+#include "tool-humbreak.h"
+#include "tool-humdiff.h"
+#include "tool-humsheet.h"
+#include "tool-humsort.h"
+#include "tool-humtr.h"
+#include "tool-imitation.h"
+#include "tool-instinfo.h"
+#include "tool-kern2mens.h"
+#include "tool-kernify.h"
+#include "tool-kernview.h"
+#include "tool-melisma.h"
+#include "tool-mens2kern.h"
+#include "tool-meter.h"
+#include "tool-metlev.h"
+#include "tool-modori.h"
+#include "tool-msearch.h"
+#include "tool-myank.h"
+#include "tool-nproof.h"
+#include "tool-ordergps.h"
+#include "tool-pbar.h"
+#include "tool-pccount.h"
+#include "tool-periodicity.h"
+#include "tool-phrase.h"
+#include "tool-pline.h"
+#include "tool-pnum.h"
+#include "tool-prange.h"
+#include "tool-recip.h"
+#include "tool-restfill.h"
+#include "tool-rid.h"
+#include "tool-rphrase.h"
+#include "tool-sab2gs.h"
+#include "tool-satb2gs.h"
+#include "tool-scordatura.h"
+#include "tool-semitones.h"
+#include "tool-shed.h"
+#include "tool-sic.h"
+#include "tool-simat.h"
+#include "tool-slurcheck.h"
+#include "tool-spinetrace.h"
+#include "tool-strophe.h"
+#include "tool-synco.h"
+#include "tool-tabber.h"
+#include "tool-tandeminfo.h"
+#include "tool-tassoize.h"
+#include "tool-textdur.h"
+#include "tool-thru.h"
+#include "tool-tie.h"
+#include "tool-timebase.h"
+#include "tool-transpose.h"
+#include "tool-tremolo.h"
+#include "tool-trillspell.h"
+#include "tool-tspos.h"
+#include "tool-vcross.h"
+
+#include <exception>
+#include <map>
+#include <new>
+#include <memory>
+#include <sstream>
+#include <type_traits>
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+
+//////////////////////////////
+//
+// HumServerTool -- Interface for a tool object that is run by the server.
+//     Most tools do not reset all of their member variables when they are
+//     run again, so a new tool object is made for each request unless the
+//     tool has been checked and marked as reusable in the registry (see
+//     getServerToolRegistry()).  Reusable tools are kept between requests.
+//
+
+class HumServerTool {
+	public:
+		virtual         ~HumServerTool () { }
+		virtual HumTool& getTool       (void) = 0;
+		virtual bool     run           (const string& input,
+		                                HumOutputSink& passthrough) = 0;
+
+		bool             isReusable    (void) { return m_reusable; }
+		void             setReusable   (bool state) { m_reusable = state; }
+
+	private:
+		bool m_reusable = false;
+};
+
+
+
+//////////////////////////////
+//
+// HumServerStreamTool -- Run a tool on each segment of the input in turn,
+//     in the same way as STREAM_INTERFACE.
+//
+
+template <class TOOL>
+class HumServerStreamTool : public HumServerTool {
+	public:
+		HumTool& getTool(void) { return m_tool; }
+
+		bool run(const string& input, HumOutputSink& passthrough) {
+			HumdrumFileStream instream(input);
+			HumdrumFileSet infiles;
+			bool status = true;
+			while (instream.readSingleSegment(infiles)) {
+				status &= (bool)m_tool.run(infiles);
+				for (int i=0; i<infiles.getCount(); i++) {
+					passthrough.writeFile(infiles[i]);
+				}
+			}
+			m_tool.finally();
+			return status;
+		}
+
+	private:
+		TOOL m_tool;
+};
+
+
+
+//////////////////////////////
+//
+// HumServerSetTool -- Run a tool on all segments of the input at once,
+//     for tools which compare files with each other.
+//
+
+template <class TOOL>
+class HumServerSetTool : public HumServerTool {
+	public:
+		HumTool& getTool(void) { return m_tool; }
+
+		bool run(const string& input, HumOutputSink& passthrough) {
+			HumdrumFileSet infiles;
+			infiles.readString(input);
+			bool status = (bool)m_tool.run(infiles);
+			m_tool.finally();
+			for (int i=0; i<infiles.getCount(); i++) {
+				passthrough.writeFile(infiles[i]);
+			}
+			return status;
+		}
+
+	private:
+		TOOL m_tool;
+};
+
+
+
+//////////////////////////////
+//
+// getServerToolRegistry -- Return the list of tools that the server can run,
+//     indexed by tool name.  Tools added with HUMSERVER_REUSABLE_TOOL are
+//     kept between requests with the same options, so they must set all of
+//     their member variables again each time that they are run, and must
+//     not collect data across segments in finally().  Check a tool before
+//     adding it that way.
+//
+
+static const map<string, std::function<HumServerTool*(void)>>& getServerToolRegistry(void) {
+	static const map<string, std::function<HumServerTool*(void)>> registry = {
+		#define HUMSERVER_TOOL(NAME, INTERFACE) \
+			{ #NAME, [](void) -> HumServerTool* { return new INTERFACE<Tool_##NAME>; } },
+		#define HUMSERVER_REUSABLE_TOOL(NAME, INTERFACE) \
+			{ #NAME, [](void) -> HumServerTool* { \
+				static_assert(std::is_same<decltype(&Tool_##NAME::finally), void (HumTool::*)(void)>::value, \
+						"Tools which override finally() cannot be reused"); \
+				HumServerTool* tool = new INTERFACE<Tool_##NAME>; \
+				tool->setReusable(true); \
+				return tool; \
+			} },
+		HUMSERVER_TOOL(1520ify, HumServerStreamTool)
+		HUMSERVER_TOOL(addic, HumServerStreamTool)
+		HUMSERVER_TOOL(addkey, HumServerStreamTool)
+		HUMSERVER_TOOL(addlabels, HumServerStreamTool)
+		HUMSERVER_TOOL(addtempo, HumServerStreamTool)
+		HUMSERVER_TOOL(autoaccid, HumServerStreamTool)
+		HUMSERVER_REUSABLE_TOOL(autobeam, HumServerStreamTool)
+		HUMSERVER_TOOL(autocadence, HumServerStreamTool)
+		HUMSERVER_TOOL(autostem, HumServerStreamTool)
+		HUMSERVER_TOOL(binroll, HumServerStreamTool)
+		HUMSERVER_TOOL(bstyle, HumServerStreamTool)
+		HUMSERVER_TOOL(chantize, HumServerStreamTool)
+		HUMSERVER_TOOL(chint, HumServerStreamTool)
+		HUMSERVER_TOOL(chord, HumServerStreamTool)
+		HUMSERVER_TOOL(cint, HumServerStreamTool)
+		HUMSERVER_TOOL(cmr, HumServerStreamTool)
+		HUMSERVER_TOOL(colorgroups, HumServerStreamTool)
+		HUMSERVER_TOOL(colortriads, HumServerStreamTool)
+		HUMSERVER_TOOL(composite, HumServerStreamTool)
+		HUMSERVER_TOOL(compositeold, HumServerStreamTool)
+		HUMSERVER_TOOL(deg, HumServerStreamTool)
+		HUMSERVER_TOOL(dissonant, HumServerStreamTool)
+		HUMSERVER_TOOL(double, HumServerStreamTool)
+		HUMSERVER_REUSABLE_TOOL(extract, HumServerStreamTool)
+		HUMSERVER_TOOL(fb, HumServerStreamTool)
+		HUMSERVER_REUSABLE_TOOL(filter, HumServerStreamTool)
+		HUMSERVER_TOOL(fixps, HumServerStreamTool)
+		HUMSERVER_TOOL(flipper, HumServerStreamTool)
+		HUMSERVER_TOOL(gasparize, HumServerStreamTool)
+		HUMSERVER_TOOL(grep, HumServerStreamTool)
+		HUMSERVER_TOOL(half, HumServerStreamTool)
+		HUMSERVER_TOOL(hands, HumServerStreamTool)
+		HUMSERVER_TOOL(homorhythm, HumServerStreamTool)
+		HUMSERVER_TOOL(homorhythm2, HumServerStreamTool)
+		HUMSERVER_TOOL(hproof, HumServerStreamTool)
+		HUMSERVER_TOOL(humbreak, HumServerStreamTool)
+		HUMSERVER_TOOL(humsheet, HumServerStreamTool)
+		HUMSERVER_TOOL(humsort, HumServerStreamTool)
+		HUMSERVER_TOOL(humtr, HumServerStreamTool)
+		HUMSERVER_TOOL(imitation, HumServerStreamTool)
+		HUMSERVER_TOOL(instinfo, HumServerStreamTool)
+		HUMSERVER_TOOL(kern2mens, HumServerStreamTool)
+		HUMSERVER_TOOL(kernify, HumServerStreamTool)
+		HUMSERVER_TOOL(kernview, HumServerStreamTool)
+		HUMSERVER_TOOL(melisma, HumServerStreamTool)
+		HUMSERVER_TOOL(mens2kern, HumServerStreamTool)
+		HUMSERVER_TOOL(meter, HumServerStreamTool)
+		HUMSERVER_REUSABLE_TOOL(metlev, HumServerStreamTool)
+		HUMSERVER_TOOL(modori, HumServerStreamTool)
+		HUMSERVER_TOOL(msearch, HumServerStreamTool)
+		HUMSERVER_TOOL(myank, HumServerStreamTool)
+		HUMSERVER_TOOL(nproof, HumServerStreamTool)
+		HUMSERVER_TOOL(ordergps, HumServerStreamTool)
+		HUMSERVER_TOOL(pbar, HumServerStreamTool)
+		HUMSERVER_TOOL(pccount, HumServerStreamTool)
+		HUMSERVER_TOOL(periodicity, HumServerStreamTool)
+		HUMSERVER_TOOL(phrase, HumServerStreamTool)
+		HUMSERVER_TOOL(pline, HumServerStreamTool)
+		HUMSERVER_TOOL(pnum, HumServerStreamTool)
+		HUMSERVER_TOOL(prange, HumServerStreamTool)
+		HUMSERVER_REUSABLE_TOOL(recip, HumServerStreamTool)
+		HUMSERVER_TOOL(restfill, HumServerStreamTool)
+		HUMSERVER_TOOL(rid, HumServerStreamTool)
+		HUMSERVER_TOOL(rphrase, HumServerStreamTool)
+		HUMSERVER_TOOL(sab2gs, HumServerStreamTool)
+		HUMSERVER_TOOL(satb2gs, HumServerStreamTool)
+		HUMSERVER_TOOL(scordatura, HumServerStreamTool)
+		HUMSERVER_REUSABLE_TOOL(semitones, HumServerStreamTool)
+		HUMSERVER_TOOL(shed, HumServerStreamTool)
+		HUMSERVER_TOOL(sic, HumServerStreamTool)
+		HUMSERVER_TOOL(simat, HumServerStreamTool)
+		HUMSERVER_TOOL(slurcheck, HumServerStreamTool)
+		HUMSERVER_TOOL(spinetrace, HumServerStreamTool)
+		HUMSERVER_TOOL(strophe, HumServerStreamTool)
+		HUMSERVER_TOOL(synco, HumServerStreamTool)
+		HUMSERVER_TOOL(tabber, HumServerStreamTool)
+		HUMSERVER_TOOL(tandeminfo, HumServerStreamTool)
+		HUMSERVER_TOOL(tassoize, HumServerStreamTool)
+		HUMSERVER_TOOL(textdur, HumServerStreamTool)
+		HUMSERVER_REUSABLE_TOOL(thru, HumServerStreamTool)
+		HUMSERVER_TOOL(tie, HumServerStreamTool)
+		HUMSERVER_TOOL(timebase, HumServerStreamTool)
+		HUMSERVER_REUSABLE_TOOL(transpose, HumServerStreamTool)
+		HUMSERVER_TOOL(tremolo, HumServerStreamTool)
+		HUMSERVER_TOOL(trillspell, HumServerStreamTool)
+		HUMSERVER_TOOL(tspos, HumServerStreamTool)
+		HUMSERVER_TOOL(vcross, HumServerStreamTool)
+		HUMSERVER_TOOL(chooser, HumServerSetTool)
+		HUMSERVER_TOOL(humdiff, HumServerSetTool)
+		#undef HUMSERVER_TOOL
+		#undef HUMSERVER_REUSABLE_TOOL
+	};
+	return registry;
+}
+
+
+
+//////////////////////////////
+//
+// getServerTool -- Return a tool object which has been prepared with the
+//     given options.  Reusable tools are kept in a per-thread cache indexed
+//     by the command, so repeated requests with the same options do not
+//     need to construct the tool and parse the options again.  Other tools
+//     are made new for each request.
+//
+
+static map<string, std::shared_ptr<HumServerTool>>& getServerToolCache(void) {
+	static thread_local map<string, std::shared_ptr<HumServerTool>> cache;
+	return cache;
+}
+
+
+static string getServerToolCommand(const string& name, const string& options) {
+	string command = name;
+	if (!options.empty()) {
+		command += " ";
+		command += options;
+	}
+	return command;
+}
+
+
+static std::shared_ptr<HumServerTool> getServerTool(const string& name,
+		const string& options, string& error) {
+	auto& cache = getServerToolCache();
+	// Maximum number of prepared tools to keep in each thread:
+	const int maxCacheSize = 32;
+
+	string command = getServerToolCommand(name, options);
+
+	auto found = cache.find(command);
+	if (found != cache.end()) {
+		return found->second;
+	}
+
+	auto entry = getServerToolRegistry().find(name);
+	if (entry == getServerToolRegistry().end()) {
+		error = "Unknown tool: " + name + "\n";
+		return NULL;
+	}
+
+	std::shared_ptr<HumServerTool> tool(entry->second());
+	HumTool& interface = tool->getTool();
+	interface.setExitOnError(false);
+	if (!interface.process(command)) {
+		error = interface.getParseError();
+		if (error.empty()) {
+			error = "Error processing options for " + name + "\n";
+		} else if (error.back() != '\n') {
+			error += "\n";
+		}
+		return NULL;
+	}
+
+	if (tool->isReusable()) {
+		if ((int)cache.size() >= maxCacheSize) {
+			cache.clear();
+		}
+		cache[command] = tool;
+	}
+	return tool;
+}
+
+
+
+//////////////////////////////
+//
+// HumToolConnection -- Shared state for the requests read from a single
+//     input stream: responses are written one at a time to the output
+//     stream, and the connection stays open until all of its requests
+//     have been answered.
+//
+
+class HumToolConnection {
+	public:
+		HumToolConnection(ostream& output) : m_output(output) { }
+
+		void addRequest(void) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_pending++;
+		}
+
+		void sendResponse(const HumToolResponse& response, bool finished) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			try {
+				HumToolServer::writeResponse(m_output, response);
+				m_output.flush();
+			} catch (...) {
+				// The output stream has failed, so the response is lost, but
+				// the request still has to be counted as finished.
+			}
+			if (finished) {
+				m_pending--;
+				m_done.notify_all();
+			}
+		}
+
+		void wait(void) {
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_done.wait(lock, [this](void) { return m_pending == 0; });
+		}
+
+	private:
+		ostream&                m_output;
+		std::mutex              m_mutex;
+		std::condition_variable m_done;
+		int                     m_pending = 0;
+};
+
+
+
+//////////////////////////////
+//
+// HumToolServer::HumToolServer -- Constructor.  The default thread count
+//     of 0 uses one worker thread for each processor core.
+//
+
+HumToolServer::HumToolServer(void) {
+	// do nothing
+}
+
+
+HumToolServer::HumToolServer(int threads) {
+	setThreadCount(threads);
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::~HumToolServer -- Deconstructor.  Wait for the worker
+//     threads to finish their current jobs.
+//
+
+HumToolServer::~HumToolServer() {
+	stopWorkers();
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::setThreadCount -- Set the number of worker threads.  Use
+//     0 for one thread per processor core.  The workers are (re)started
+//     when the next stream is served.
+//
+
+void HumToolServer::setThreadCount(int threads) {
+	if (threads < 0) {
+		threads = 0;
+	}
+	if (threads != m_threadCount) {
+		stopWorkers();
+		m_threadCount = threads;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::getThreadCount -- Return the number of worker threads
+//     which will be used to process requests.
+//
+
+int HumToolServer::getThreadCount(void) {
+	if (m_threadCount > 0) {
+		return m_threadCount;
+	}
+	int cores = (int)std::thread::hardware_concurrency();
+	return cores > 0 ? cores : 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::setQueueSize -- Set the maximum number of requests which
+//     can wait for a worker thread.  When the queue is full, serve() stops
+//     reading requests until a worker takes the next one.  Use 0 for four
+//     requests per worker thread.
+//
+
+void HumToolServer::setQueueSize(int size) {
+	if (size < 0) {
+		size = 0;
+	}
+	m_queueSize = size;
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::getQueueSize -- Return the maximum number of requests
+//     which can wait for a worker thread.
+//
+
+int HumToolServer::getQueueSize(void) {
+	if (m_queueSize > 0) {
+		return m_queueSize;
+	}
+	return 4 * getThreadCount();
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::hasTool -- Return true if the server can run the given tool.
+//
+
+bool HumToolServer::hasTool(const string& name) {
+	const auto& registry = getServerToolRegistry();
+	return registry.find(name) != registry.end();
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::getToolNames -- Return a sorted list of the tools which
+//     the server can run.
+//
+
+vector<string> HumToolServer::getToolNames(void) {
+	vector<string> output;
+	for (const auto& entry : getServerToolRegistry()) {
+		output.push_back(entry.first);
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::run -- Process a single request in the current thread.
+//     Returns false if the tool could not be run or reported an error.
+//
+
+bool HumToolServer::run(const HumToolRequest& request, HumToolResponse& response) {
+	response = HumToolResponse();
+	response.id = request.id;
+
+	string error;
+	std::shared_ptr<HumServerTool> tool = getServerTool(request.tool, request.options, error);
+	if (!tool) {
+		response.status = false;
+		response.error = error;
+		return false;
+	}
+
+	// The output of the tool is written directly into the response:
+	HumTool& interface = tool->getTool();
+	HumStringSink humdrumSink(response.humdrum);
+	HumStringSink jsonSink(response.json);
+	HumStringSink textSink(response.text);
+	interface.setHumdrumSink(&humdrumSink);
+	interface.setJsonSink(&jsonSink);
+	interface.setFreeTextSink(&textSink);
+	interface.clearOutput();
+
+	string passthrough;
+	HumStringSink passthroughSink(passthrough);
+	bool status = false;
+	string exception;
+	try {
+		status = tool->run(request.input, passthroughSink);
+	} catch (const std::exception& e) {
+		exception = e.what();
+	} catch (...) {
+		exception = "unknown exception";
+	}
+	bool hasText = interface.hasAnyText();
+	interface.clearOutputSinks();
+
+	if (!exception.empty()) {
+		// The tool may have been left in an inconsistent state, so do not
+		// use it for another request.
+		getServerToolCache().erase(getServerToolCommand(request.tool, request.options));
+		interface.clearOutput();
+		response.humdrum.clear();
+		response.json.clear();
+		response.text.clear();
+		response.status = false;
+		response.error = "Error running " + request.tool + ": " + exception + "\n";
+		return false;
+	}
+
+	if (!hasText && !interface.hasError()) {
+		response.humdrum.swap(passthrough);
+	}
+	response.warning = interface.getWarning();
+	response.error   = interface.getError();
+	response.status  = status && !interface.hasError();
+	interface.clearOutput();
+	return response.status;
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::serve -- Read requests from the input stream until it
+//     ends, and write a response for each one to the output stream.
+//     Requests are processed concurrently by the worker threads, so the
+//     responses can be in a different order than the requests.  Reading
+//     waits while the job queue is full (see setQueueSize()).  Returns
+//     false if the input contained a malformed request (in which case an
+//     error response is sent and no more requests are read).
+//
+
+bool HumToolServer::serve(istream& input, ostream& output) {
+	startWorkers();
+	HumToolConnection connection(output);
+	bool status = true;
+
+	while (true) {
+		auto request = std::make_shared<HumToolRequest>();
+		string error;
+		int state = readRequest(input, *request, error);
+		if (state == 0) {
+			break;
+		}
+		if (state < 0) {
+			HumToolResponse response;
+			response.id = request->id;
+			response.status = false;
+			response.error = error;
+			connection.sendResponse(response, false);
+			status = false;
+			break;
+		}
+		if (!hasTool(request->tool)) {
+			HumToolResponse response;
+			response.id = request->id;
+			response.status = false;
+			response.error = "Unknown tool: " + request->tool + "\n";
+			connection.sendResponse(response, false);
+			continue;
+		}
+		connection.addRequest();
+		addJob([this, request, &connection](void) {
+			HumToolResponse response;
+			try {
+				run(*request, response);
+			} catch (const std::exception& e) {
+				response = HumToolResponse();
+				response.id = request->id;
+				response.status = false;
+				response.error = "Error running " + request->tool + ": " + e.what() + "\n";
+			} catch (...) {
+				response = HumToolResponse();
+				response.id = request->id;
+				response.status = false;
+				response.error = "Error running " + request->tool + ": unknown exception\n";
+			}
+			connection.sendResponse(response, true);
+		});
+	}
+
+	connection.wait();
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// readFrameHeader -- Read "key: value" lines up to an empty line.  Empty
+//     lines before the header are skipped.  Returns 1 if a header was read,
+//     0 if the input ended before a header, or -1 if the header is invalid.
+//
+
+static int readFrameHeader(istream& input, map<string, string>& header,
+		string& error) {
+	header.clear();
+	string line;
+	bool started = false;
+	while (getline(input, line)) {
+		if (!line.empty() && line.back() == '\r') {
+			line.pop_back();
+		}
+		if (line.empty()) {
+			if (started) {
+				return 1;
+			}
+			continue;
+		}
+		started = true;
+		size_t colon = line.find(':');
+		if (colon == string::npos) {
+			error = "Invalid header line: " + line + "\n";
+			return -1;
+		}
+		string key = line.substr(0, colon);
+		size_t start = line.find_first_not_of(" \t", colon + 1);
+		header[key] = start == string::npos ? "" : line.substr(start);
+	}
+	if (started) {
+		error = "Input ended inside of a header\n";
+		return -1;
+	}
+	return 0;
+}
+
+
+
+//////////////////////////////
+//
+// readFrameSection -- Read a section of a frame whose size is given by
+//     a header entry.  Returns false if the size is not a number, if it is
+//     larger than maxFrameSectionSize, if there is not enough memory for
+//     the section, or if the input ends before the end of the section.
+//
+
+static bool readFrameSection(istream& input, const map<string, string>& header,
+		const string& key, string& section, string& error) {
+	// Largest section that will be read (256 MB):
+	const size_t maxFrameSectionSize = (size_t)256 * 1024 * 1024;
+
+	section.clear();
+	auto found = header.find(key);
+	if (found == header.end()) {
+		return true;
+	}
+	const string& value = found->second;
+	if (value.empty() || (value.find_first_not_of("0123456789") != string::npos)) {
+		error = "Invalid " + key + ": " + value + "\n";
+		return false;
+	}
+	size_t size = 0;
+	for (char ch : value) {
+		size = size * 10 + (ch - '0');
+		if (size > maxFrameSectionSize) {
+			error = "Invalid " + key + ": " + value + " (maximum is "
+					+ to_string(maxFrameSectionSize) + ")\n";
+			return false;
+		}
+	}
+	try {
+		section.resize(size);
+	} catch (const std::bad_alloc&) {
+		error = "Not enough memory for " + key + ": " + value + "\n";
+		return false;
+	}
+	if (size > 0) {
+		input.read(&section[0], size);
+		if ((size_t)input.gcount() != size) {
+			error = "Input ended inside of " + key + " section\n";
+			section.resize(input.gcount());
+			return false;
+		}
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::readRequest -- Read a request frame.  Returns 1 if a request
+//     was read, 0 at the end of the input, or -1 if the request is invalid
+//     (with a description of the problem in error).
+//
+
+int HumToolServer::readRequest(istream& input, HumToolRequest& request,
+		string& error) {
+	request = HumToolRequest();
+	map<string, string> header;
+	int state = readFrameHeader(input, header, error);
+	if (state <= 0) {
+		return state;
+	}
+	request.id      = header["id"];
+	request.tool    = header["tool"];
+	request.options = header["options"];
+	if (!readFrameSection(input, header, "length", request.input, error)) {
+		return -1;
+	}
+	if (request.tool.empty()) {
+		error = "Missing tool in request\n";
+		return -1;
+	}
+	return 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::writeRequest -- Write a request frame.
+//
+
+ostream& HumToolServer::writeRequest(ostream& output,
+		const HumToolRequest& request) {
+	if (!request.id.empty()) {
+		output << "id: " << request.id << "\n";
+	}
+	output << "tool: " << request.tool << "\n";
+	if (!request.options.empty()) {
+		output << "options: " << request.options << "\n";
+	}
+	output << "length: " << request.input.size() << "\n";
+	output << "\n";
+	output << request.input;
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::readResponse -- Read a response frame.  Returns 1 if a
+//     response was read, 0 at the end of the input, or -1 if the response
+//     is invalid.
+//
+
+int HumToolServer::readResponse(istream& input, HumToolResponse& response,
+		string& error) {
+	response = HumToolResponse();
+	map<string, string> header;
+	int state = readFrameHeader(input, header, error);
+	if (state <= 0) {
+		return state;
+	}
+	response.id = header["id"];
+	response.status = header["status"] == "ok";
+	if (!readFrameSection(input, header, "humdrum-length", response.humdrum, error)) {
+		return -1;
+	}
+	if (!readFrameSection(input, header, "json-length", response.json, error)) {
+		return -1;
+	}
+	if (!readFrameSection(input, header, "text-length", response.text, error)) {
+		return -1;
+	}
+	if (!readFrameSection(input, header, "warning-length", response.warning, error)) {
+		return -1;
+	}
+	if (!readFrameSection(input, header, "error-length", response.error, error)) {
+		return -1;
+	}
+	return 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::writeResponse -- Write a response frame.
+//
+
+ostream& HumToolServer::writeResponse(ostream& output,
+		const HumToolResponse& response) {
+	if (!response.id.empty()) {
+		output << "id: " << response.id << "\n";
+	}
+	output << "status: " << (response.status ? "ok" : "error") << "\n";
+	output << "humdrum-length: " << response.humdrum.size() << "\n";
+	output << "json-length: "    << response.json.size()    << "\n";
+	output << "text-length: "    << response.text.size()    << "\n";
+	output << "warning-length: " << response.warning.size() << "\n";
+	output << "error-length: "   << response.error.size()   << "\n";
+	output << "\n";
+	output << response.humdrum;
+	output << response.json;
+	output << response.text;
+	output << response.warning;
+	output << response.error;
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::startWorkers -- Start the worker threads if they are not
+//     already running.
+//
+
+void HumToolServer::startWorkers(void) {
+	std::lock_guard<std::mutex> lock(m_jobMutex);
+	if (!m_workers.empty()) {
+		return;
+	}
+	m_stopQ = false;
+	int count = getThreadCount();
+	for (int i=0; i<count; i++) {
+		m_workers.emplace_back(&HumToolServer::workerLoop, this);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::stopWorkers -- Finish the queued jobs and then stop the
+//     worker threads.
+//
+
+void HumToolServer::stopWorkers(void) {
+	{
+		std::lock_guard<std::mutex> lock(m_jobMutex);
+		if (m_workers.empty()) {
+			return;
+		}
+		m_stopQ = true;
+	}
+	m_jobSignal.notify_all();
+	for (auto& worker : m_workers) {
+		worker.join();
+	}
+	m_workers.clear();
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::addJob -- Add a job to the queue for the worker threads.
+//     If the queue is full, wait until a worker takes a job from it.
+//
+
+void HumToolServer::addJob(std::function<void(void)> job) {
+	int limit = getQueueSize();
+	{
+		std::unique_lock<std::mutex> lock(m_jobMutex);
+		m_queueSignal.wait(lock, [this, limit](void) { return (int)m_jobs.size() < limit; });
+		m_jobs.push_back(std::move(job));
+	}
+	m_jobSignal.notify_one();
+}
+
+
+
+//////////////////////////////
+//
+// HumToolServer::workerLoop -- Process jobs from the queue until the
+//     workers are stopped and the queue is empty.
+//
+
+void HumToolServer::workerLoop(void) {
+	while (true) {
+		std::function<void(void)> job;
+		{
+			std::unique_lock<std::mutex> lock(m_jobMutex);
+			m_jobSignal.wait(lock, [this](void) { return m_stopQ || !m_jobs.empty(); });
+			if (m_jobs.empty()) {
+				return;
+			}
+			job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+		}
+		m_queueSignal.notify_one();
+		job();
+	}
+}
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Tue Dec 03 11:28:21 PDT 2019
-// Last Modified: Mon Jun 15 16:55:07 PDT 2020
+// Last Modified: Sun Oct 18 23:59:59 PDT 2026
 // Filename:      HumTransposer.cpp
 // URL:           https://github.com/craigsapp/hum2ly/blob/master/src/HumTransposer.cpp
 // Related:       https://github.com/rism-ch/verovio/blob/develop/src/transposition.cpp
@@ -41,6 +41,7 @@
 #include "HumTransposer.h"
 
 #include <cctype>
+#include <cstring>
 #include <iostream>
 #include <regex>
 #include <string>
@@ -363,6 +364,191 @@ void HumTransposer::transpose(HumPitch &pitch, const string &transString) {
 
 
 
+//////////////////////////////
+//
+// HumTransposer::prepareKernTable -- Calculate the transposed **kern pitch
+//    for each integer pitch in the octave range 0 to 9 at the stored
+//    transposition interval.  Pitches that would be transposed outside of
+//    that range are left empty in the table.  This function is called
+//    automatically by the table-based functions when the interval or base
+//    has changed since the last time the table was created.
+//
+
+void HumTransposer::prepareKernTable(void) {
+	int size = 10 * m_base;
+	m_kernTable.resize(size);
+	for (int i=0; i<size; i++) {
+		m_kernTable[i].clear();
+		int target = i + m_transpose;
+		if ((target < 0) || (target >= size)) {
+			continue;
+		}
+		m_kernTable[i] = integerPitchToHumPitch(target).getKernPitch();
+	}
+	m_kernTableBase      = m_base;
+	m_kernTableTranspose = m_transpose;
+}
+
+
+
+//////////////////////////////
+//
+// HumTransposer::getKernTablePitch -- Return the transposed **kern pitch
+//    for the given integer pitch in the current base, or an empty string if
+//    the pitch is not in the table.
+//
+
+const string& HumTransposer::getKernTablePitch(int ipitch) {
+	static const string empty;
+	if ((m_kernTableBase != m_base) || (m_kernTableTranspose != m_transpose)) {
+		prepareKernTable();
+	}
+	if ((ipitch < 0) || (ipitch >= (int)m_kernTable.size())) {
+		return empty;
+	}
+	return m_kernTable[ipitch];
+}
+
+
+
+//////////////////////////////
+//
+// HumTransposer::transposeKernToken -- Transpose the pitches of a **kern
+//    token (including all notes in a chord) at the stored transposition
+//    interval.  The token is modified in place, so no new strings are
+//    created for pitches that are found in the transposition table.  Null
+//    tokens, unpitched notes (R) and rhythm-only tokens are not changed, and
+//    only the vertical position of rests is transposed (without accidentals).
+//    Returns false if any subtoken contained an uninterpretable pitch
+//    (which is left unchanged).
+//
+
+bool HumTransposer::transposeKernToken(string &token) {
+	if ((m_kernTableBase != m_base) || (m_kernTableTranspose != m_transpose)) {
+		prepareKernTable();
+	}
+	bool status = true;
+	size_t start = 0;
+	while (start <= token.size()) {
+		size_t end = token.find(' ', start);
+		if (end == string::npos) {
+			end = token.size();
+		}
+		size_t oldsize = token.size();
+		status &= transposeKernSubtoken(token, start, end);
+		start = end + token.size() - oldsize + 1;
+	}
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// HumTransposer::transposeKernSubtoken -- Transpose the pitch in a single
+//    note or rest of a **kern token between the given string indexes.
+//
+
+bool HumTransposer::transposeKernSubtoken(string &token, size_t start, size_t end) {
+	if ((end == start + 1) && (token[start] == '.')) {
+		return true;
+	}
+
+	bool rest = false;
+	size_t pstart = string::npos;
+	for (size_t i=start; i<end; i++) {
+		char ch = token[i];
+		if (ch == 'R') {
+			// Don't transpose unpitched notes (percussion parts).
+			return true;
+		} else if (ch == 'r') {
+			rest = true;
+		} else if ((pstart == string::npos) && (strchr("ABCDEFGabcdefg", ch) != NULL)) {
+			pstart = i;
+		}
+	}
+	if (pstart == string::npos) {
+		// no pitch (such as an invisible rest containing only a rhythm).
+		return true;
+	}
+
+	// The pitch is extracted from the letters and accidentals in the pitch
+	// portion of a rest, or from the entire note otherwise.
+	size_t pend = pstart;
+	size_t istart = start;
+	size_t iend = end;
+	if (rest) {
+		while ((pend < end) && (strchr("ABCDEFGabcdefg", token[pend]) != NULL)) {
+			pend++;
+		}
+		while ((pend < end) && (strchr("#n-", token[pend]) != NULL)) {
+			pend++;
+		}
+		istart = pstart;
+		iend = pend;
+	} else {
+		pstart = start;
+		while ((pstart < end) && (strchr("ABCDEFGabcdefg#n-", token[pstart]) == NULL)) {
+			pstart++;
+		}
+		pend = pstart;
+		while ((pend < end) && (strchr("ABCDEFGabcdefg#n-", token[pend]) != NULL)) {
+			pend++;
+		}
+	}
+
+	int uc = 0;
+	int lc = 0;
+	int accid = 0;
+	int dpc = -1;
+	for (size_t i=istart; i<iend; i++) {
+		char ch = token[i];
+		if (ch == '#') {
+			accid++;
+		} else if (ch == '-') {
+			accid--;
+		} else if (('A' <= ch) && (ch <= 'G')) {
+			uc++;
+		} else if (('a' <= ch) && (ch <= 'g')) {
+			lc++;
+		} else {
+			continue;
+		}
+		if ((dpc < 0) && isalpha(ch)) {
+			dpc = (tolower(ch) - 'a' + 5) % 7;
+		}
+	}
+	if ((dpc < 0) || ((uc > 0) && (lc > 0))) {
+		return false;
+	}
+	int octave = uc > 0 ? 4 - uc : 3 + lc;
+	int ipitch = octave * m_base + m_diatonicMapping[dpc] + accid;
+
+	const string* newpitch = &getKernTablePitch(ipitch);
+	string fallback;
+	if (newpitch->empty()) {
+		if ((ipitch < 0) || (ipitch + m_transpose < 0)) {
+			return false;
+		}
+		fallback = integerPitchToHumPitch(ipitch + m_transpose).getKernPitch();
+		newpitch = &fallback;
+	}
+
+	if (rest) {
+		// Transpose pitch portion of rest (indicating vertical position).
+		size_t length = newpitch->find_first_of("#-");
+		if (length == string::npos) {
+			length = newpitch->size();
+		}
+		token.replace(pstart, pend - pstart, *newpitch, 0, length);
+	} else {
+		token.replace(pstart, pend - pstart, *newpitch);
+	}
+	return true;
+}
+
+
+
 //////////////////////////////
 //
 // HumTransposer::getBase -- Return the integer interval class representing an octave.
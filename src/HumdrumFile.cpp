@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Aug 17 02:39:28 PDT 2015
-// Last Modified: Mon Aug 17 02:39:32 PDT 2015
+// Last Modified: Sun Oct 18 16:05:27 PDT 2026
 // Filename:      HumdrumFile.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFile.cpp
 // Syntax:        C++11; humlib
@@ -62,6 +62,9 @@ HumdrumFile::~HumdrumFile() {
 
 ostream& HumdrumFile::printXml(ostream& out, int level,
 		const string& indent) {
+	// Slur durations are included in the content information of tokens:
+	requireAnalysis(HumFileAnalysis::PASS_SLURS);
+
 	out << Convert::repeatString(indent, level) << "<sequence>\n";
 	level++;
 
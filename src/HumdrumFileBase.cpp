@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
-// Last Modified: Fri Aug 14 21:57:09 PDT 2015
+// Last Modified: Sun Oct 18 23:59:59 PDT 2026
 // Filename:      HumdrumFileBase.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileBase.cpp
 // Syntax:        C++11; humlib
@@ -22,6 +22,7 @@
 #include <cstdarg>
 #include <cstring>
 #include <fstream>
+#include <memory>
 #include <sstream>
 
 using namespace std;
@@ -181,7 +182,7 @@ void HumdrumFileBase::clear(void) {
 //
 
 bool HumdrumFileBase::isStructureAnalyzed(void) {
-	return m_analyses.m_structure_analyzed;
+	return m_analyses.isDone(HumFileAnalysis::PASS_STRUCTURE);
 }
 
 
@@ -192,7 +193,7 @@ bool HumdrumFileBase::isStructureAnalyzed(void) {
 //
 
 bool HumdrumFileBase::isRhythmAnalyzed(void) {
-	return m_analyses.m_rhythm_analyzed;
+	return m_analyses.isDone(HumFileAnalysis::PASS_RHYTHM);
 }
 
 
@@ -203,7 +204,7 @@ bool HumdrumFileBase::isRhythmAnalyzed(void) {
 //
 
 bool HumdrumFileBase::areStrandsAnalyzed(void) {
-	return m_analyses.m_strands_analyzed;
+	return m_analyses.isDone(HumFileAnalysis::PASS_STRANDS);
 }
 
 
@@ -214,7 +215,96 @@ bool HumdrumFileBase::areStrandsAnalyzed(void) {
 //
 
 bool HumdrumFileBase::areStrophesAnalyzed(void) {
-	return m_analyses.m_strophes_analyzed;
+	return m_analyses.isDone(HumFileAnalysis::PASS_STROPHES);
+}
+
+
+
+//////////////////////////////
+//
+// HumFileAnalysis::getDependencies -- Return a bitmask of the analysis
+//     passes which must be run before the given pass.
+//
+
+unsigned int HumFileAnalysis::getDependencies(Pass pass) {
+	switch (pass) {
+		case PASS_STRANDS:
+			return 0;
+		case PASS_NULLS:
+		case PASS_STROPHES:
+		case PASS_STRUCTURE:
+			return (1u << PASS_STRANDS);
+		case PASS_RHYTHM:
+		case PASS_TOKEN_INDEX:
+		case PASS_OTTAVAS:
+		case PASS_BARLINES:
+		case PASS_MEASURES:
+			return (1u << PASS_STRUCTURE);
+		case PASS_KERN_ACCIDENTALS:
+		case PASS_MENS_ACCIDENTALS:
+			return (1u << PASS_TOKEN_INDEX) | (1u << PASS_OTTAVAS);
+		case PASS_SLURS:
+		case PASS_BEAMS:
+		case PASS_PHRASES:
+		case PASS_TIES:
+			return (1u << PASS_TOKEN_INDEX) | (1u << PASS_RHYTHM);
+		case PASS_METRIC_GRID:
+		case PASS_TEXT:
+			return (1u << PASS_RHYTHM);
+		case PASS_REST_POSITIONS:
+		case PASS_NULL_TABLE:
+			return (1u << PASS_TOKEN_INDEX);
+		case PASS_SONORITIES:
+			return (1u << PASS_NULL_TABLE);
+		case PASS_STRAND_TABLE:
+			return (1u << PASS_RHYTHM) | (1u << PASS_STROPHES);
+		case PASS_COUNT:
+			break;
+	}
+	return 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumFileAnalysis::invalidate -- Mark the given analysis pass and all
+//     passes which depend on it (directly or indirectly) as not run.
+//
+
+void HumFileAnalysis::invalidate(Pass pass) {
+	unsigned int invalid = (1u << pass);
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		for (int i=0; i<PASS_COUNT; i++) {
+			if (invalid & (1u << i)) {
+				continue;
+			}
+			if (getDependencies((Pass)i) & invalid) {
+				invalid |= (1u << i);
+				changed = true;
+			}
+		}
+	}
+	m_done &= ~invalid;
+	m_version++;
+}
+
+
+
+//////////////////////////////
+//
+// HumFileAnalysis::invalidateContent -- Mark all content passes (the
+//     passes from PASS_TOKEN_INDEX onwards) as not run.  The structure
+//     passes are kept.
+//
+
+void HumFileAnalysis::invalidateContent(void) {
+	for (int i=PASS_TOKEN_INDEX; i<PASS_COUNT; i++) {
+		m_done &= ~(1u << i);
+	}
+	m_version++;
 }
 
 
@@ -728,7 +818,7 @@ ostream& HumdrumFileBase::printFieldIndex(int fieldind, ostream& out) {
 			out << infile[i] << endl;
 			continue;
 		}
-		cout << infile.token(i,fieldind) << endl;
+		out << infile.token(i,fieldind) << endl;
 	}
 	return out;
 }
@@ -835,13 +925,16 @@ vector<int> HumdrumFileBase::getTrackWidths(void) {
 //////////////////////////////
 //
 // HumdrumFileBase::createLinesFromTokens -- Generate Humdrum lines strings
-//   from the stored list of tokens.
+//   from the stored list of tokens.  The content analyses (accidentals,
+//   slurs, ties, etc.) are marked as needing to be run again, since the
+//   tokens may have been changed.
 //
 
 void HumdrumFileBase::createLinesFromTokens(void) {
 	for (int i=0; i<(int)m_lines.size(); i++) {
 		m_lines[i]->createLineFromTokens();
 	}
+	m_analyses.invalidateContent();
 }
 
 
@@ -1708,6 +1801,7 @@ bool HumdrumFileBase::stitchLinesTogether(HumdrumLine& previous,
 bool HumdrumFileBase::analyzeSpines(void) {
 	vector<string> datatype;
 	vector<string> sinfo;
+	vector<std::shared_ptr<const string>> sshared;
 	vector<vector<HTp> > lastspine;
 	m_trackstarts.resize(0);
 	m_trackends.resize(0);
@@ -1732,12 +1826,14 @@ bool HumdrumFileBase::analyzeSpines(void) {
 			init = true;
 			datatype.resize(m_lines[i]->getTokenCount());
 			sinfo.resize(m_lines[i]->getTokenCount());
+			sshared.resize(m_lines[i]->getTokenCount());
 			lastspine.resize(m_lines[i]->getTokenCount());
 			for (j=0; j<m_lines[i]->getTokenCount(); j++) {
 				datatype[j] = m_lines[i]->getTokenString(j);
 				addToTrackStarts(m_lines[i]->token(j));
 				sinfo[j]    = to_string(j+1);
-				m_lines[i]->token(j)->setSpineInfo(sinfo[j]);
+				sshared[j]  = HumAddress::makeSpineInfo(sinfo[j]);
+				m_lines[i]->token(j)->setSpineInfo(sshared[j]);
 				m_lines[i]->token(j)->setFieldIndex(j);
 				lastspine[j].push_back(m_lines[i]->token(j));
 			}
@@ -1755,13 +1851,17 @@ bool HumdrumFileBase::analyzeSpines(void) {
 			return setParseError(err);
 		}
 		for (j=0; j<m_lines[i]->getTokenCount(); j++) {
-			m_lines[i]->token(j)->setSpineInfo(sinfo[j]);
+			m_lines[i]->token(j)->setSpineInfo(sshared[j]);
 			m_lines[i]->token(j)->setFieldIndex(j);
 		}
 		if (!m_lines[i]->isManipulator()) {
 			continue;
 		}
 		if (!adjustSpines(*m_lines[i], datatype, sinfo)) { return isValid(); }
+		sshared.resize(sinfo.size());
+		for (j=0; j<(int)sinfo.size(); j++) {
+			sshared[j] = HumAddress::makeSpineInfo(sinfo[j]);
+		}
 	}
 	return isValid();
 }
@@ -2180,15 +2280,16 @@ bool HumdrumFileBase::processNonNullDataTokensForTrackForward(HTp starttoken,
 //    variable in HumdrumTokens)
 //
 
-void HumdrumFileBase::addUniqueTokens(vector<HTp>& target,
+void HumdrumFileBase::addUniqueTokens(HumTokenLinks& target,
 		vector<HTp>& source) {
 	int i, j;
 	bool found;
 	for (i=0; i<(int)source.size(); i++) {
 		found = false;
 		for (j=0; j<(int)target.size(); j++) {
-			if (source[i] == target[i]) {
+			if (source[i] == target[j]) {
 				found = true;
+				break;
 			}
 		}
 		if (!found) {
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Fri Jun 17 14:31:58 PDT 2016
-// Last Modified: Sat Jun 18 17:20:28 PDT 2016
+// Last Modified: Sun Oct 18 23:59:59 PDT 2026
 // Filename:      HumdrumFileContent-accidental.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileContent-accidental.cpp
 // Syntax:        C++11; humlib
@@ -53,16 +53,28 @@ bool HumdrumFileContent::analyzeMensAccidentals(void) {
 //    would not be printed.  Algorithm assumes that all secondary tied notes
 //    will not display their accidental across a system break.  Consideration
 //    about grace-note accidental display still needs to be done.
+//    The analysis is only done once for each version of the file: call
+//    createLinesFromTokens() or invalidateAnalysis() after changing notes
+//    to analyze them again.
 //
 
 bool HumdrumFileContent::analyzeKernAccidentals(const string& dataType) {
-
-	// ottava marks must be analyzed first:
-	this->analyzeOttavas();
+	if ((dataType == "**kern") || dataType.empty()) {
+		if (!startAnalysis(HumFileAnalysis::PASS_KERN_ACCIDENTALS)) {
+			return true;
+		}
+	} else if (dataType == "**mens") {
+		if (!startAnalysis(HumFileAnalysis::PASS_MENS_ACCIDENTALS)) {
+			return true;
+		}
+	} else {
+		// ottava marks must be analyzed first:
+		requireAnalysis(HumFileAnalysis::PASS_OTTAVAS);
+	}
 
 	HumdrumFileContent& infile = *this;
-	int i, j, k;
-	int kindex;
+	prepareAnalysisTables();
+	int i;
 	int track;
 
 	// ktracks == List of **kern spines in data.
@@ -85,6 +97,44 @@ bool HumdrumFileContent::analyzeKernAccidentals(const string& dataType) {
 	}
 	int kcount = (int)ktracks.size();
 
+	if (useAnalysisThreads(kcount)) {
+		// The accidental states of each part are independent, so each
+		// part can be analyzed in a separate thread.
+		runAnalysisThreads(kcount, [&](int part) {
+			analyzeKernAccidentals(rtracks, kcount, part);
+		});
+	} else {
+		analyzeKernAccidentals(rtracks, kcount, -1);
+	}
+
+	// Indicate that the accidental analysis has been done:
+	string dataTypeDone = "accidentalAnalysis" + dataType;
+	infile.setValue("auto", dataTypeDone, "true");
+
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::analyzeKernAccidentals -- Analyze the accidentals
+//    of a single part (the index of the spine in the list of analyzed
+//    spines), or all parts if part is negative.  The line-based
+//    interactions between parts (barlines starting a new measure in all
+//    parts, and repeated accidentals in chords split across subspines)
+//    are followed when analyzing a single part, so the results are the
+//    same as when all parts are analyzed together.
+//
+
+void HumdrumFileContent::analyzeKernAccidentals(vector<int>& rtracks,
+		int kcount, int part) {
+	HumdrumFileContent& infile = *this;
+	HumAnalysisTables& tables = m_analysisTables;
+	int i, j, k;
+	int kindex;
+	int track;
+
 	// keysigs == key signature spellings of diatonic pitch classes.  This array
 	// is duplicated into dstates after each barline.
 	vector<vector<int> > keysigs;
@@ -137,6 +187,9 @@ bool HumdrumFileContent::analyzeKernAccidentals(const string& dataType) {
 				if (token->compare(0, 3, "*k[") == 0) {
 					track = token->getTrack();
 					kindex = rtracks[track];
+					if ((part >= 0) && (kindex != part)) {
+						continue;
+					}
 					fillKeySignature(keysigs[kindex], *infile[i].token(j));
 					// resetting key states of current measure.  What to do if this
 					// key signature is in the middle of a measure?
@@ -156,6 +209,9 @@ bool HumdrumFileContent::analyzeKernAccidentals(const string& dataType) {
 				std::fill(firstinbar.begin(), firstinbar.end(), 1);
 				track = token->getTrack();
 				kindex = rtracks[track];
+				if ((part >= 0) && (kindex != part)) {
+					continue;
+				}
 				// reset the accidental states in dstates to match keysigs.
 				resetDiatonicStatesWithKeySignature(dstates[kindex], keysigs[kindex]);
 				resetDiatonicStatesWithKeySignature(gdstates[kindex], keysigs[kindex]);
@@ -180,14 +236,19 @@ bool HumdrumFileContent::analyzeKernAccidentals(const string& dataType) {
 				continue;
 			}
 
-			int subcount = token->getSubtokenCount();
 			track = token->getTrack();
-
 			if (lasttrack != track) {
 				fill(concurrentstate.begin(), concurrentstate.end(), 0);
 			}
 			lasttrack = track;
 			int rindex = rtracks[track];
+			if ((part >= 0) && (rindex != part)) {
+				continue;
+			}
+
+			int subcount = token->getSubtokenCount();
+			int tokenid = tables.getTokenId(token);
+			int octaveadjust = token->getValueInt("auto", "ottava");
 			for (k=0; k<subcount; k++) {
 				// bool tienote = false;
 				string subtok = token->getSubtoken(k);
@@ -205,7 +266,6 @@ bool HumdrumFileContent::analyzeKernAccidentals(const string& dataType) {
 				}
 				int b40 = Convert::kernToBase40(subtok);
 				int diatonic = Convert::kernToBase7(subtok);
-				int octaveadjust = token->getValueInt("auto", "ottava");
 				diatonic -= octaveadjust * 7;
 				if (diatonic < 0) {
 					// Deal with extra-low notes later.
@@ -424,13 +484,14 @@ bool HumdrumFileContent::analyzeKernAccidentals(const string& dataType) {
 					// accidental is different from the previous state so should be
 					// printed
 					if (!hiddenQ) {
-						token->setValue("auto", to_string(k), "visualAccidental", "true");
+						int flags = HumAnalysisTables::ACCID_VISUAL;
 						if (gdstates[rindex][diatonic] < -900) {
 							// this is an obligatory cautionary accidental
 							// or at least half the time it is (figure that out later)
-							token->setValue("auto", to_string(k), "obligatoryAccidental", "true");
-							token->setValue("auto", to_string(k), "cautionaryAccidental", "true");
+							flags |= HumAnalysisTables::ACCID_OBLIGATORY;
+							flags |= HumAnalysisTables::ACCID_CAUTIONARY;
 						}
+						setAccidentalState(tokenid, token, k, flags);
 					}
 					gdstates[rindex][diatonic] = accid;
 					// regular notes are not affected by grace notes accidental
@@ -443,36 +504,32 @@ bool HumdrumFileContent::analyzeKernAccidentals(const string& dataType) {
 					// accidental is different from the previous state so should be
 					// printed, but only print if not supposed to be hidden.
 					if (!hiddenQ) {
-						token->setValue("auto", to_string(k), "visualAccidental", "true");
+						int flags = HumAnalysisTables::ACCID_VISUAL;
 						concurrentstate[diatonic] = accid;
 						if (dstates[rindex][diatonic] < -900) {
 							// this is an obligatory cautionary accidental
 							// or at least half the time it is (figure that out later)
-							token->setValue("auto", to_string(k), "obligatoryAccidental", "true");
-							token->setValue("auto", to_string(k), "cautionaryAccidental", "true");
+							flags |= HumAnalysisTables::ACCID_OBLIGATORY;
+							flags |= HumAnalysisTables::ACCID_CAUTIONARY;
 						}
+						setAccidentalState(tokenid, token, k, flags);
 					}
 					dstates[rindex][diatonic] = accid;
 					gdstates[rindex][diatonic] = accid;
 
 				} else if ((accid == 0) && (subtok.find("n") != string::npos) && !hiddenQ) {
-					token->setValue("auto", to_string(k), "cautionaryAccidental", "true");
-					token->setValue("auto", to_string(k), "visualAccidental", "true");
+					setAccidentalState(tokenid, token, k, HumAnalysisTables::ACCID_VISUAL |
+							HumAnalysisTables::ACCID_CAUTIONARY);
 				} else if (subtok.find("XX") == string::npos) {
 					// The accidental is not necessary. See if there is a single "X"
 					// immediately after the accidental which means to force it to
 					// display.
 					auto loc = subtok.find("X");
 					if ((loc != string::npos) && (loc > 0)) {
-						if (subtok[loc-1] == '#') {
-							token->setValue("auto", to_string(k), "cautionaryAccidental", "true");
-							token->setValue("auto", to_string(k), "visualAccidental", "true");
-						} else if (subtok[loc-1] == '-') {
-							token->setValue("auto", to_string(k), "cautionaryAccidental", "true");
-							token->setValue("auto", to_string(k), "visualAccidental", "true");
-						} else if (subtok[loc-1] == 'n') {
-							token->setValue("auto", to_string(k), "cautionaryAccidental", "true");
-							token->setValue("auto", to_string(k), "visualAccidental", "true");
+						if ((subtok[loc-1] == '#') || (subtok[loc-1] == '-') ||
+								(subtok[loc-1] == 'n')) {
+							setAccidentalState(tokenid, token, k, HumAnalysisTables::ACCID_VISUAL |
+									HumAnalysisTables::ACCID_CAUTIONARY);
 						}
 					}
 				}
@@ -480,12 +537,36 @@ bool HumdrumFileContent::analyzeKernAccidentals(const string& dataType) {
 		}
 		std::fill(firstinbar.begin(), firstinbar.end(), 0);
 	}
+}
 
-	// Indicate that the accidental analysis has been done:
-	string dataTypeDone = "accidentalAnalysis" + dataType;
-	infile.setValue("auto", dataTypeDone, "true");
 
-	return true;
+
+//////////////////////////////
+//
+// HumdrumFileContent::setAccidentalState -- Store the display state of
+//    an accidental on a note in the analysis tables, and also in the
+//    token's HumHash ("visualAccidental", "cautionaryAccidental" and
+//    "obligatoryAccidental" parameters in the "auto" namespace for the
+//    subtoken) if analysis hash values are active.  Tokens which are not
+//    in the token index of the tables only store the state in the HumHash.
+//
+
+void HumdrumFileContent::setAccidentalState(int tokenid, HTp token,
+		int subtoken, int flags) {
+	bool stored = m_analysisTables.setAccidentalFlags(tokenid, subtoken, flags);
+	if (stored && !m_analysisHashValues) {
+		return;
+	}
+	string key = to_string(subtoken);
+	if (flags & HumAnalysisTables::ACCID_VISUAL) {
+		token->setValue("auto", key, "visualAccidental", "true");
+	}
+	if (flags & HumAnalysisTables::ACCID_OBLIGATORY) {
+		token->setValue("auto", key, "obligatoryAccidental", "true");
+	}
+	if (flags & HumAnalysisTables::ACCID_CAUTIONARY) {
+		token->setValue("auto", key, "cautionaryAccidental", "true");
+	}
 }
 
 
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Jul 11 06:34:40 PDT 2020
-// Last Modified: Sat Jul 11 06:34:43 PDT 2020
+// Last Modified: Sun Oct 18 16:05:27 PDT 2026
 // Filename:      HumdrumFileContent-barline.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileContent-barline.cpp
 // Syntax:        C++11; humlib
@@ -30,11 +30,10 @@ namespace hum {
 //
 
 void HumdrumFileContent::analyzeBarlines(void) {
-	if (m_analyses.m_barlines_analyzed) {
-		// Maybe allow forcing reanalysis.
+	if (!startAnalysis(HumFileAnalysis::PASS_BARLINES)) {
+		// Use invalidateAnalysis() to force reanalysis.
 		return;
 	}
-	m_analyses.m_barlines_analyzed = true;
 	m_analyses.m_barlines_different = false;
 
 	string baseline;
@@ -167,9 +166,7 @@ bool HumdrumFileContent::hasDataStraddle(int line) {
 //
 
 bool HumdrumFileContent::hasDifferentBarlines(void) {
-	if (!m_analyses.m_barlines_analyzed) {
-		analyzeBarlines();
-	}
+	requireAnalysis(HumFileAnalysis::PASS_BARLINES);
 	return m_analyses.m_barlines_different;
 }
 
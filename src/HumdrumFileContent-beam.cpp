@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Fri Apr 15 11:18:20 PDT 2022
-// Last Modified: Fri Apr 15 11:18:22 PDT 2022
+// Last Modified: Sun Oct 18 16:05:27 PDT 2026
 // Filename:      HumdrumFileContent-beam.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileContent-beam.cpp
 // Syntax:        C++11; humlib
@@ -29,10 +29,11 @@ namespace hum {
 //
 
 bool HumdrumFileContent::analyzeBeams(void) {
-	if (m_analyses.m_beams_analyzed) {
+	if (!startAnalysis(HumFileAnalysis::PASS_BEAMS)) {
 		return false;
 	}
-	m_analyses.m_beams_analyzed = true;
+	HumAnalysisTables& tables = prepareAnalysisTables();
+	tables.getBeams().resize(tables.getTokenCount());
 	bool output = true;
 	output &= analyzeKernBeams();
 	output &= analyzeMensBeams();
@@ -102,11 +103,10 @@ bool HumdrumFileContent::analyzeMensBeams(void) {
 
 	vector<HTp> mensspines;
 	getSpineStartList(mensspines, "**mens");
-	bool output = true;
 	string linkSignifier = m_signifiers.getKernLinkSignifier();
-	for (int i=0; i<(int)mensspines.size(); i++) {
-		output = output && analyzeKernBeams(mensspines[i], beamstarts, beamends, labels, endings, linkSignifier);
-	}
+	SpineSpanAnalysis analysis = &HumdrumFileContent::analyzeKernBeams;
+	bool output = analyzeSpineSpans(analysis, m_analysisTables.getBeams(), mensspines,
+			beamstarts, beamends, labels, endings, linkSignifier);
 	createLinkedBeams(beamstarts, beamends);
 	return output;
 }
@@ -173,11 +173,10 @@ bool HumdrumFileContent::analyzeKernBeams(void) {
 
 	vector<HTp> kernspines;
 	getSpineStartList(kernspines, "**kern");
-	bool output = true;
 	string linkSignifier = m_signifiers.getKernLinkSignifier();
-	for (int i=0; i<(int)kernspines.size(); i++) {
-		output = output && analyzeKernBeams(kernspines[i], beamstarts, beamends, labels, endings, linkSignifier);
-	}
+	SpineSpanAnalysis analysis = &HumdrumFileContent::analyzeKernBeams;
+	bool output = analyzeSpineSpans(analysis, m_analysisTables.getBeams(), kernspines,
+			beamstarts, beamends, labels, endings, linkSignifier);
 
 	createLinkedBeams(beamstarts, beamends);
 	return output;
@@ -271,17 +270,25 @@ bool HumdrumFileContent::analyzeKernBeams(HTp spinestart,
 							if (labels[token->getLineIndex()].first) {
 								duration -= labels[token->getLineIndex()].first->getDurationFromStart();
 							}
-							token->setValue("auto", "endingBeamBack", "true");
-							token->setValue("auto", "beamSide", "stop");
-							token->setValue("auto", "beamDuration",
-								token->getDurationToEnd());
+							m_analysisTables.getBeams().addHanging(m_analysisTables.getTokenId(token),
+									false, token->getDurationToEnd(), -1, true);
+							if (m_analysisHashValues) {
+								token->setValue("auto", "endingBeamBack", "true");
+								token->setValue("auto", "beamSide", "stop");
+								token->setValue("auto", "beamDuration",
+									token->getDurationToEnd());
+							}
 						} else {
 							// This is a beam closing that does not have a matching opening.
-							token->setValue("auto", "hangingBeam", "true");
-							token->setValue("auto", "beamSide", "stop");
-							token->setValue("auto", "beamOpenIndex", to_string(i));
-							token->setValue("auto", "beamDuration",
-								token->getDurationToEnd());
+							m_analysisTables.getBeams().addHanging(m_analysisTables.getTokenId(token),
+									false, token->getDurationToEnd(), i);
+							if (m_analysisHashValues) {
+								token->setValue("auto", "hangingBeam", "true");
+								token->setValue("auto", "beamSide", "stop");
+								token->setValue("auto", "beamOpenIndex", to_string(i));
+								token->setValue("auto", "beamDuration",
+									token->getDurationToEnd());
+							}
 						}
 					}
 				}
@@ -306,10 +313,15 @@ bool HumdrumFileContent::analyzeKernBeams(HTp spinestart,
 	for (int i=0; i<(int)beamopens.size(); i++) {
 		for (int j=0; j<(int)beamopens[i].size(); j++) {
 			for (int k=0; k<(int)beamopens[i][j].size(); k++) {
-				beamopens[i][j][k]->setValue("", "auto", "hangingBeam", "true");
-				beamopens[i][j][k]->setValue("", "auto", "beamSide", "start");
-				beamopens[i][j][k]->setValue("", "auto", "beamDuration",
-						beamopens[i][j][k]->getDurationFromStart());
+				HTp btok = beamopens[i][j][k];
+				m_analysisTables.getBeams().addHanging(m_analysisTables.getTokenId(btok),
+						true, btok->getDurationFromStart());
+				if (m_analysisHashValues) {
+					btok->setValue("", "auto", "hangingBeam", "true");
+					btok->setValue("", "auto", "beamSide", "start");
+					btok->setValue("", "auto", "beamDuration",
+							btok->getDurationFromStart());
+				}
 			}
 		}
 	}
@@ -409,46 +421,63 @@ bool HumdrumFileContent::isLinkedBeamBegin(HTp token, int index, const string& p
 //////////////////////////////
 //
 // HumdrumFileContent::linkBeamEndpoints --  Allow up to two beam starts/ends
-//      on a note.
+//      on a note.  The link is stored in the beam analysis table, and also
+//      in the "auto" HumHash parameters of the tokens if analysis hash
+//      values are active.
 //
 
 void HumdrumFileContent::linkBeamEndpoints(HTp beamstart, HTp beamend) {
-	string durtag = "beamDuration";
-	string endtag = "beamEndId";
-	string starttag = "beamStartId";
-	string beamstartnumbertag = "beamStartNumber";
-	string beamendnumbertag = "beamEndNumber";
+	HumSpanTable& beams = m_analysisTables.getBeams();
+	int startid = m_analysisTables.getTokenId(beamstart);
+	int endid   = m_analysisTables.getTokenId(beamend);
 
-	int beamStartCount = beamstart->getValueInt("auto", "beamStartCount");
+	int beamStartCount = beams.getStartCount(startid);
 	int opencount = (int)count(beamstart->begin(), beamstart->end(), 'L');
 	beamStartCount++;
 	int openEnumeration = opencount - beamStartCount + 1;
 
-	if (openEnumeration > 1) {
-		endtag += to_string(openEnumeration);
-		durtag += to_string(openEnumeration);
-		beamendnumbertag += to_string(openEnumeration);
-	}
-
-	int beamEndNumber = beamend->getValueInt("auto", "beamEndCount");
+	int beamEndNumber = beams.getEndCount(endid);
 	beamEndNumber++;
 	int closeEnumeration = beamEndNumber;
-	if (closeEnumeration > 1) {
-		starttag += to_string(closeEnumeration);
-		beamstartnumbertag += to_string(closeEnumeration);
-	}
 
 	HumNum duration = beamend->getDurationFromStart()
 			- beamstart->getDurationFromStart();
 
 	HumNum durToBar = beamstart->getDurationToBarline();
 
+	beams.addLink(startid, endid, beamstart, beamend, openEnumeration,
+			closeEnumeration, duration);
+
 	if (duration >= durToBar) {
-		beamstart->setValue("auto", "beamSpanStart", 1);
-		beamend->setValue("auto", "beamSpanEnd", 1);
+		beams.setSpanEndpoints(startid, endid);
+		if (m_analysisHashValues) {
+			beamstart->setValue("auto", "beamSpanStart", 1);
+			beamend->setValue("auto", "beamSpanEnd", 1);
+		}
 		markBeamSpanMembers(beamstart, beamend);
 	}
 
+	if (!m_analysisHashValues) {
+		return;
+	}
+
+	string durtag = "beamDuration";
+	string endtag = "beamEndId";
+	string starttag = "beamStartId";
+	string beamstartnumbertag = "beamStartNumber";
+	string beamendnumbertag = "beamEndNumber";
+
+	if (openEnumeration > 1) {
+		endtag += to_string(openEnumeration);
+		durtag += to_string(openEnumeration);
+		beamendnumbertag += to_string(openEnumeration);
+	}
+
+	if (closeEnumeration > 1) {
+		starttag += to_string(closeEnumeration);
+		beamstartnumbertag += to_string(closeEnumeration);
+	}
+
 	beamstart->setValue("auto", endtag,            beamend);
 	beamstart->setValue("auto", "id",              beamstart);
 	beamstart->setValue("auto", beamendnumbertag,  closeEnumeration);
@@ -469,9 +498,14 @@ void HumdrumFileContent::linkBeamEndpoints(HTp beamstart, HTp beamend) {
 //
 
 void HumdrumFileContent::markBeamSpanMembers(HTp beamstart, HTp beamend) {
+	HumSpanTable& beams = m_analysisTables.getBeams();
 	int endindex = beamend->getLineIndex();
-	beamstart->setValue("auto", "inBeamSpan", beamstart);
-	beamend->setValue("auto", "inBeamSpan", beamstart);
+	beams.setSpanMember(m_analysisTables.getTokenId(beamstart), beamstart);
+	beams.setSpanMember(m_analysisTables.getTokenId(beamend), beamstart);
+	if (m_analysisHashValues) {
+		beamstart->setValue("auto", "inBeamSpan", beamstart);
+		beamend->setValue("auto", "inBeamSpan", beamstart);
+	}
 	HTp current = beamstart->getNextToken();;
 	while (current) {
       int line = current->getLineIndex();
@@ -495,7 +529,10 @@ void HumdrumFileContent::markBeamSpanMembers(HTp beamstart, HTp beamend) {
 			current = current->getNextToken();
 			continue;
 		}
-		current->setValue("auto", "inBeamSpan", beamstart);
+		beams.setSpanMember(m_analysisTables.getTokenId(current), beamstart);
+		if (m_analysisHashValues) {
+			current->setValue("auto", "inBeamSpan", beamstart);
+		}
 		current = current->getNextToken();
 	}
 }
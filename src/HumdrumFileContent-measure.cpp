@@ -0,0 +1,317 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 10:41:17 PDT 2026
+// Last Modified: Sun Oct 18 16:05:27 PDT 2026
+// Filename:      HumdrumFileContent-measure.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileContent-measure.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Create an index of the numbered measures in a file, storing
+//                the line range of each measure, the spine layout at the start
+//                of the measure and the prevailing clef, key signature, key,
+//                time signature, mensuration and tempo for each track.
+//                The index is created once and then can be used by excerpting
+//                tools such as myank without rescanning the file.
+//
+
+#include "HumdrumFileContent.h"
+
+#include <cctype>
+#include <cstdio>
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::analyzeMeasureIndex -- Create a list of the numbered
+//     measures in the file.  Measures start at a barline starting with
+//     "=" and a number, and end at the next barline containing a number
+//     (unnumbered barlines inside of a measure are ignored).  Data before
+//     the first numbered barline is given the measure number 0, and the last
+//     measure ends at the final barline (or the spine terminators if there
+//     is no final barline).  The index is created only once; if the contents
+//     of the file are changed after the index is created, then the file
+//     will need to be reparsed for a new index.
+//
+
+bool HumdrumFileContent::analyzeMeasureIndex(void) {
+	if (!startAnalysis(HumFileAnalysis::PASS_MEASURES)) {
+		return true;
+	}
+
+	HumdrumFileContent& infile = *this;
+	int lineCount = infile.getLineCount();
+	m_measureIndex.clear();
+	m_measureNumbers.clear();
+	m_measureLines.assign(lineCount, -1);
+	m_barNumbers.assign(lineCount, 0);
+
+	HumMeasureInfo current;
+
+	// pickup measure (measure 0):
+	int firstdata = -1;
+	for (int i=0; i<lineCount; i++) {
+		if ((firstdata < 0) && infile[i].isData()) {
+			firstdata = i;
+		}
+		if (!infile[i].isBarline()) {
+			continue;
+		}
+		if (infile.token(i, 0)->find_first_of("0123456789") == string::npos) {
+			continue;
+		}
+		if (firstdata >= 0) {
+			current.number = 0;
+			current.startline = firstdata;
+			current.stopline = i;
+			m_measureIndex.push_back(current);
+		}
+		break;
+	}
+
+	int lastdata = -1;
+	int lastbar  = -1;
+	for (int i=lineCount-1; i>=0; i--) {
+		if ((lastdata < 0) && infile[i].isData()) {
+			lastdata = i;
+		}
+		if ((lastbar < 0) && infile[i].isBarline()) {
+			lastbar = i;
+		}
+		if ((lastbar >= 0) && (lastdata >= 0)) {
+			break;
+		}
+	}
+
+	// numbered measures:
+	int lastend = -1;
+	int lastnum = -1;
+	int dataend = -1;
+	int barnum;
+	for (int i=0; i<lineCount; i++) {
+		if (infile[i].isInterpretation() && (*infile.token(i, 0) == "*-")) {
+			dataend = i;
+			break;
+		}
+		if (!infile[i].isBarline()) {
+			continue;
+		}
+		if (sscanf(infile.token(i, 0)->c_str(), "=%d", &barnum) != 1) {
+			continue;
+		}
+		for (int ii=i+1; ii<lineCount; ii++) {
+			if (!infile[ii].isBarline()) {
+				continue;
+			}
+			HTp token = infile.token(ii, 0);
+			size_t pos = token->find_first_of("0123456789");
+			if (pos == string::npos) {
+				if (ii >= lastdata) {
+					// no more data in the file
+					break;
+				}
+				continue;
+			}
+			current.clear();
+			current.number = barnum;
+			current.startline = i;
+			current.stopline = ii;
+			m_measureIndex.push_back(current);
+			lastend = ii;
+			lastnum = stoi(token->substr(pos));
+			i = ii - 1;
+			break;
+		}
+	}
+
+	// final measure:
+	if ((lastnum >= 0) && (lastend >= 0) && (dataend >= 0)) {
+		current.clear();
+		current.number = lastnum;
+		current.startline = lastend;
+		current.stopline = (lastbar > lastdata) ? lastbar : dataend;
+		m_measureIndex.push_back(current);
+	}
+
+	// Store the line to measure mapping, the bar number for each line and
+	// the prevailing interpretations at the start of each measure:
+	vector<vector<HTp>> states(6);
+	for (int i=0; i<(int)states.size(); i++) {
+		states[i].assign(infile.getMaxTrack() + 1, NULL);
+	}
+	int entry = 0;
+	int currentbar = 0;
+	for (int i=0; i<lineCount; i++) {
+		while ((entry < (int)m_measureIndex.size()) &&
+				(m_measureIndex[entry].startline <= i)) {
+			storeMeasureState(m_measureIndex[entry], states);
+			if (m_measureNumbers.find(m_measureIndex[entry].number) == m_measureNumbers.end()) {
+				m_measureNumbers[m_measureIndex[entry].number] = entry;
+			}
+			entry++;
+		}
+		if ((entry > 0) && (i <= m_measureIndex[entry-1].stopline)) {
+			m_measureLines[i] = entry - 1;
+		}
+
+		if (infile[i].isBarline()) {
+			HTp token = infile.token(i, 0);
+			size_t pos = token->find('=');
+			while (pos != string::npos) {
+				if ((pos + 1 < token->size()) && isdigit((*token)[pos+1])) {
+					currentbar = stoi(token->substr(pos+1));
+					break;
+				}
+				pos = token->find('=', pos + 1);
+			}
+		}
+		m_barNumbers[i] = currentbar;
+
+		if (!infile[i].isInterpretation()) {
+			continue;
+		}
+		for (int j=0; j<infile[i].getFieldCount(); j++) {
+			HTp token = infile.token(i, j);
+			int track = token->getTrack();
+			if ((track < 1) || (track >= (int)states[0].size())) {
+				continue;
+			}
+			if (token->isClef()) {
+				states[0][track] = token;
+			} else if (token->isKeySignature()) {
+				states[1][track] = token;
+			} else if (token->isKeyDesignation()) {
+				states[2][track] = token;
+			} else if (token->isTimeSignature()) {
+				states[3][track] = token;
+			} else if (token->isMensurationSymbol()) {
+				states[4][track] = token;
+			} else if (token->isTempo()) {
+				states[5][track] = token;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::storeMeasureState -- Store the current interpretation
+//    states and the spine layout at the start of a measure.
+//
+
+void HumdrumFileContent::storeMeasureState(HumMeasureInfo& info,
+		vector<vector<HTp>>& states) {
+	info.clef    = states[0];
+	info.keysig  = states[1];
+	info.key     = states[2];
+	info.timesig = states[3];
+	info.met     = states[4];
+	info.tempo   = states[5];
+
+	HumdrumFileContent& infile = *this;
+	info.subtracks.assign(infile.getMaxTrack() + 1, 0);
+	if ((info.startline < 0) || !infile[info.startline].hasSpines()) {
+		return;
+	}
+	for (int j=0; j<infile[info.startline].getFieldCount(); j++) {
+		int track = infile.token(info.startline, j)->getTrack();
+		if ((track > 0) && (track < (int)info.subtracks.size())) {
+			info.subtracks[track]++;
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getMeasureIndexCount -- Return the number of
+//     entries in the measure index.
+//
+
+int HumdrumFileContent::getMeasureIndexCount(void) {
+	analyzeMeasureIndex();
+	return (int)m_measureIndex.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getMeasureIndexEntry -- Return an entry in the
+//     measure index.
+//
+
+const HumMeasureInfo& HumdrumFileContent::getMeasureIndexEntry(int index) {
+	analyzeMeasureIndex();
+	return m_measureIndex.at(index);
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getMeasureIndexForNumber -- Return the index of
+//     the first measure with the given measure number, or -1 if there is
+//     no such measure.
+//
+
+int HumdrumFileContent::getMeasureIndexForNumber(int number) {
+	analyzeMeasureIndex();
+	auto it = m_measureNumbers.find(number);
+	if (it == m_measureNumbers.end()) {
+		return -1;
+	}
+	return it->second;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getMeasureIndexForLine -- Return the index of the
+//     measure containing the given line, or -1 if the line is not within
+//     a measure.  Barlines between two measures belong to the second one.
+//
+
+int HumdrumFileContent::getMeasureIndexForLine(int line) {
+	analyzeMeasureIndex();
+	if ((line < 0) || (line >= (int)m_measureLines.size())) {
+		return -1;
+	}
+	return m_measureLines[line];
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getBarNumberForLine -- Return the number of the
+//     last numbered barline on or before the given line (0 if none).
+//
+
+int HumdrumFileContent::getBarNumberForLine(int line) {
+	analyzeMeasureIndex();
+	if ((line < 0) || (line >= (int)m_barNumbers.size())) {
+		return 0;
+	}
+	return m_barNumbers[line];
+}
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
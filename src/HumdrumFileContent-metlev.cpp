@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Nov 28 21:19:11 PST 2016
-// Last Modified: Mon Nov 28 21:40:41 PST 2016
+// Last Modified: Sun Oct 18 20:59:30 PDT 2026
 // Filename:      HumdrumFileContent-metlev.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileContent-metlev.cpp
 // Syntax:        C++11; humlib
@@ -16,9 +16,14 @@
 //   log2 for smallert rhythmic value levels.  Metric positions above the
 //   beat level have yet to be implemented.
 //
+//   The metric grid stores the meter, beat, beat fraction and metric level
+//   of each data line in each track, so that tools which need metric
+//   positions can share one analysis of the file.
+//
 
 #include "Convert.h"
 #include "HumdrumFileContent.h"
+#include "HumRegex.h"
 
 #include <algorithm>
 #include <cstring>
@@ -29,12 +34,181 @@ namespace hum {
 
 // START_MERGE
 
+//////////////////////////////
+//
+// HumdrumFileContent::analyzeMetricGrid -- Fill in the metric table of
+//     the file (see HumMetricTable), with the metric position
+//     of each data line in each track of the file.  Positions are computed
+//     once for each meter on a line, and shared by the tracks using that
+//     meter.  If time signatures or rhythms are changed after the analysis,
+//     call invalidateAnalysis(HumFileAnalysis::PASS_METRIC_GRID) before
+//     using the table again.
+//
+
+bool HumdrumFileContent::analyzeMetricGrid(void) {
+	if (!startAnalysis(HumFileAnalysis::PASS_METRIC_GRID)) {
+		return true;
+	}
+	HumdrumFileContent& infile = *this;
+	HumMetricTable& grid = m_metricGrid;
+	int lineCount = infile.getLineCount();
+	int trackCount = infile.getMaxTrack();
+	grid.resize(lineCount, trackCount);
+
+	// Current time signature and meter of each track, and the line of the
+	// last time signature (only the first one on a line is used):
+	vector<int> tops(trackCount + 1, 0);
+	vector<int> bottoms(trackCount + 1, 0);
+	vector<int> bottoms2(trackCount + 1, 0);
+	vector<int> meters(trackCount + 1, 0);
+	vector<int> meterLines(trackCount + 1, -1);
+
+	// Beat durations, metric-level pulses, compound states and integer
+	// bottoms of each meter in the table:
+	vector<HumNum> beats(1, 1);
+	vector<HumNum> pulses(1, 1);
+	vector<bool> compounds(1, false);
+	vector<int> pulseBottoms(1, 4);
+
+	HumRegex hre;
+	for (int i=0; i<lineCount; i++) {
+		if (infile[i].isInterpretation()) {
+			int fieldCount = infile[i].getFieldCount();
+			for (int j=0; j<fieldCount; j++) {
+				HTp token = infile.token(i, j);
+				int track = token->getTrack();
+				if ((track < 1) || (track > trackCount)) {
+					continue;
+				}
+				int meter = -1;
+				int top = 0;
+				int bot = 0;
+				int bot2 = 0;
+				HumNum beat = 0;
+				if (token->compare(0, 2, "*M") == 0) {
+					int count = sscanf(token->c_str(), "*M%d/%d%%%d", &top, &bot, &bot2);
+					if ((count < 2) || (meterLines[track] == i)) {
+						continue;
+					}
+					meterLines[track] = i;
+					tops[track] = top;
+					bottoms[track] = bot;
+					bottoms2[track] = (count == 3) ? bot2 : 0;
+					meter = grid.addMeter(top, bot, bottoms2[track], 0);
+				} else if (token->compare(0, 6, "*beat:") == 0) {
+					if (!hre.search(token, "^\\*beat:\\s*([\\d.%]+)\\s*$")) {
+						continue;
+					}
+					beat = Convert::recipToDuration(hre.getMatch(1));
+					meter = grid.addMeter(tops[track], bottoms[track], bottoms2[track], beat);
+				} else {
+					continue;
+				}
+				meters[track] = meter;
+				if (meter == (int)beats.size()) {
+					HumNum pulse = 1;
+					bool compound = (tops[track] % 3 == 0) && (tops[track] != 3) && (tops[track] != 0);
+					if (bottoms[track] > 0) {
+						pulse.setValue(4, bottoms[track]);
+						if (compound) {
+							pulse *= 3;
+						}
+					}
+					beats.push_back(beat > 0 ? beat : pulse);
+					pulses.push_back(pulse);
+					compounds.push_back(compound);
+					pulseBottoms.push_back(bottoms[track]);
+				}
+			}
+		}
+		if (!infile[i].isData()) {
+			continue;
+		}
+
+		HumNum position = infile[i].getDurationFromBarline();
+		grid.addLine(i, position);
+		int lastMeter = -1;
+		int beat = 0;
+		HumNum fraction;
+		double level = NAN;
+		for (int track=1; track<=trackCount; track++) {
+			int meter = meters[track];
+			if (meter != lastMeter) {
+				HumNum beatpos = position / beats[meter];
+				int whole = beatpos.getNumerator() / beatpos.getDenominator();
+				beat = whole + 1;
+				fraction = beatpos - whole;
+				level = getMetricLevel(position, pulses[meter], compounds[meter],
+						pulseBottoms[meter]);
+				lastMeter = meter;
+			}
+			grid.setPosition(i, track, meter, beat, fraction, level);
+		}
+	}
+
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getMetricGrid -- Return the metric table for the
+//     file, running the analysis if necessary.
+//
+
+const HumMetricTable& HumdrumFileContent::getMetricGrid(void) {
+	HumMetricTable& grid = m_metricGrid;
+	if (m_analyses.isDone(HumFileAnalysis::PASS_METRIC_GRID) &&
+			(grid.getLineCount() != getLineCount())) {
+		// Lines have been added or removed since the analysis.
+		invalidateAnalysis(HumFileAnalysis::PASS_METRIC_GRID);
+	}
+	requireAnalysis(HumFileAnalysis::PASS_METRIC_GRID);
+	return grid;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getMetricLevel -- Return the metric level of a
+//     position in a measure: the number of binary divisions of the pulse
+//     (or a ternary division followed by binary divisions in compound
+//     meters) needed to reach the position.
+//
+
+double HumdrumFileContent::getMetricLevel(HumNum position, HumNum pulse,
+		bool compound, int bottom) {
+	HumNum measurepos = position / pulse;
+	int denominator = measurepos.getDenominator();
+	if (!compound) {
+		return Convert::nearIntQuantize(log(denominator) / log(2.0));
+	}
+	double output = Convert::nearIntQuantize(log(denominator) / log(3.0));
+	if ((output != 0.0) && (output != 1.0)) {
+		// if not the beat or first level, then calculate
+		// levels above level 1.  In 6/8 this means
+		// to move the 8th note level to be the "beat"
+		// and then use binary levels for rhythmic levels
+		// smaller than a beat.
+		HumNum combeatdur(4, bottom);
+		HumNum commeasurepos = position / combeatdur;
+		denominator = commeasurepos.getDenominator();
+		output = 1.0 + log(denominator)/log(2.0);
+	}
+	return output;
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumFileStructure::getMetricLevels -- Each line in the output
 //     vector matches to the line of the metric analysis data.
 //     undefined is the value to represent undefined analysis data
-//     (for non-data spines).
+//     (for non-data spines).  The levels are read from the metric
+//     grid of the file (see analyzeMetricGrid()).
 //
 //     default value: track = 0: 0 means use the time signature
 //         of the first **kern spines in the file; otherwise, use the
@@ -49,7 +223,6 @@ void HumdrumFileContent::getMetricLevels(vector<double>& output,
 	HumdrumFileStructure& infile = *this;
 	int lineCount = infile.getLineCount();
 	output.resize(lineCount);
-	fill(output.begin(), output.end(), undefined);
 	vector<HTp> kernspines = infile.getKernSpineStartList();
 	if ((track == 0) && (kernspines.size() > 0)) {
 		track = kernspines[0]->getTrack();
@@ -58,62 +231,9 @@ void HumdrumFileContent::getMetricLevels(vector<double>& output,
 		track = 1;
 	}
 
-	int top = 1;                // top number of time signature (0 for no meter)
-	int bot = 4;                // bottom number of time signature
-	bool compoundQ = false;     // test for compound meters, such as 6/8
-	HumNum beatdur(1 * 4, bot); // duration of a beat in the measure
-	HumNum measurepos;          // quarter notes from the start of barline
-	HumNum combeatdur;          // for adjusting beat level in compound meters
-	HumNum commeasurepos;       // for adjusting beat level in compound meters
-
+	const HumMetricTable& grid = getMetricGrid();
 	for (int i=0; i<lineCount; i++) {
-		if (infile[i].isInterpretation()) {
-			// check for time signature:
-			HumdrumLine& line = *infile.getLine(i);
-			for (int j=0; j<line.getFieldCount(); j++) {
-				int ttrack = line.token(j)->getTrack();
-				if (ttrack != track) {
-					continue;
-				}
-				if (sscanf(infile.token(i,j)->c_str(), "*M%d/%d", &top, &bot)) {
-					beatdur.setValue(1*4, bot); // converted to quarter-note units
-					if ((top % 3 == 0) && (top != 3)) {
-						// if meter top is a multiple of 3 but not 3, then compound
-						// such as 6/8, 9/8, 6/4, but not 3/8, 3/4.
-						compoundQ = true;
-						beatdur *= 3;
-					} else {
-						compoundQ = false;
-					}
-					break;
-				}
-			}
-		}
-		if (!infile[i].isData()) {
-				continue;
-		}
-
-		measurepos = infile[i].getDurationFromBarline();
-		// Might want to handle cases where the time signature changes in
-		// the middle or a measure...
-		measurepos /= beatdur;
-		int denominator = measurepos.getDenominator();
-		if (compoundQ) {
-			output[i] = Convert::nearIntQuantize(log(denominator) / log(3.0));
-			if ((output[i] != 0.0) && (output[i] != 1.0)) {
-				// if not the beat or first level, then calculate
-				// levels above level 1.  In 6/8 this means
-				// to move the 8th note level to be the "beat"
-				// and then use binary levels for rhythmic levels
-				// smaller than a beat.
-				combeatdur.setValue(4,bot);
-				commeasurepos = infile[i].getDurationFromBarline() / combeatdur;
-				denominator = commeasurepos.getDenominator();
-				output[i] = 1.0 + log(denominator)/log(2.0);
-			}
-		} else {
-			output[i] = Convert::nearIntQuantize(log(denominator) / log(2.0));
-		}
+		output[i] = grid.getMetricLevel(i, track, undefined);
 	}
 }
 
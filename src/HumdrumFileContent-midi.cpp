@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Aug 17 02:39:28 PDT 2015
-// Last Modified: Mon Oct  5 23:15:44 PDT 2015
+// Last Modified: Sun Oct 18 21:58:02 PDT 2026
 // Filename:      HumdrumFileContent-slur.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileContent-midi.cpp
 // Syntax:        C++11; humlib
@@ -44,15 +44,14 @@ void HumdrumFileContent::fillMidiInfo(vector<vector<vector<pair<HTp, int>>>>& tr
 	
 	vector<int> trackToKernIndex = infile.getTrackToKernIndex();
 
-	for (int i=0; i<infile.getStrandCount(); i++) {
-		HTp sstart = infile.getStrandStart(i);
-		if (!sstart->isKern()) {
+	const HumStrandTable& strands = getStrandTable();
+	for (int i=0; i<strands.getStrandCount(); i++) {
+		HTp sstart = strands.getToken(strands.getStrandOffset(i));
+		if (!sstart || !sstart->isKern()) {
 			continue;
 		}
-
-		int track = sstart->getTrack();
-		HTp send = infile.getStrandEnd(i);
-		processStrandNotesForMidi(sstart, send, trackMidi[trackToKernIndex[track]]);
+		int track = strands.getStrandTrack(i);
+		processStrandNotesForMidi(i, trackMidi[trackToKernIndex[track]]);
 	}
 }
 
@@ -75,26 +74,54 @@ void HumdrumFileContent::processStrandNotesForMidi(HTp sstart, HTp send, vector<
 			current = current->getNextToken();
 			continue;
 		}
-		vector<string> subtokens = current->getSubtokens();
-		for (int i=0; i<(int)subtokens.size(); i++) {
-			if (subtokens[i] == ".") {
-				// something strange happened (no null tokens expected)
-				continue;
-			}
-			if (subtokens[i].find("r") != string::npos) {
-				// rest, so store in MIDI[0]
-				trackInfo.at(0).emplace_back(current, 0);
-			} else if (subtokens[i].find("R") != string::npos) {
-				// unpitched or quasi-pitched note, so store in MIDI[0]
-				trackInfo.at(0).emplace_back(current, 0);
-			} else {
-				int keyno = Convert::kernToMidiNoteNumber(subtokens[i]);
-				if ((keyno >= 0) && (keyno < 128)) {
-					trackInfo.at(keyno).emplace_back(current, i);
-				}
+		addNotesForMidi(current, trackInfo);
+		current = current->getNextToken();
+	}
+}
+
+
+//
+// Strand given by its index in the strand table (see getStrandTable()):
+//
+
+void HumdrumFileContent::processStrandNotesForMidi(int strand, vector<vector<pair<HTp, int>>>& trackInfo) {
+	const HumStrandTable& strands = getStrandTable();
+	int start = strands.getStrandOffset(strand);
+	int end = start + strands.getStrandSize(strand);
+	for (int i=start; i<end; i++) {
+		if (strands.isData(i) && !strands.isNull(i)) {
+			addNotesForMidi(strands.getToken(i), trackInfo);
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::addNotesForMidi -- store the subtokens of a data
+//     token by MIDI note number (rests and unpitched notes in MIDI[0]).
+//
+
+void HumdrumFileContent::addNotesForMidi(HTp token, vector<vector<pair<HTp, int>>>& trackInfo) {
+	vector<string> subtokens = token->getSubtokens();
+	for (int i=0; i<(int)subtokens.size(); i++) {
+		if (subtokens[i] == ".") {
+			// something strange happened (no null tokens expected)
+			continue;
+		}
+		if (subtokens[i].find("r") != string::npos) {
+			// rest, so store in MIDI[0]
+			trackInfo.at(0).emplace_back(token, 0);
+		} else if (subtokens[i].find("R") != string::npos) {
+			// unpitched or quasi-pitched note, so store in MIDI[0]
+			trackInfo.at(0).emplace_back(token, 0);
+		} else {
+			int keyno = Convert::kernToMidiNoteNumber(subtokens[i]);
+			if ((keyno >= 0) && (keyno < 128)) {
+				trackInfo.at(keyno).emplace_back(token, i);
 			}
 		}
-		current = current->getNextToken();
 	}
 }
 
@@ -1,6 +1,6 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Nov  5 13:25:49 CET 2018
-// Last Modified: Sat Apr 30 12:15:31 PDT 2022
+// Last Modified: Sun Oct 18 21:59:10 PDT 2026
 // Filename:      HumdrumFileContent-note.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileContent-note.cpp
 // Syntax:        C++11; humlib
@@ -347,28 +347,23 @@ void HumdrumFileContent::prepareStaffBelowNoteStems(HTp token) {
 //
 
 int HumdrumFileContent::getNoteCount(void) {
-	HumdrumFileContent& infile = *this;
+	const HumStrandTable& strands = getStrandTable();
 	int counter = 0;
 
-	int scount = infile.getStrandCount();
+	int scount = strands.getStrandCount();
 	for (int i=0; i<scount; i++) {
-		HTp sstart = infile.getStrandStart(i);
-		if (!sstart->isKern()) {
+		int start = strands.getStrandOffset(i);
+		int end = start + strands.getStrandSize(i);
+		HTp sstart = strands.getToken(start);
+		if (!sstart || !sstart->isKern()) {
 			continue;
 		}
-		HTp send = infile.getStrandEnd(i);
-		HTp current = sstart;
-		while (current && (current != send)) {
-			if (!current->isData()) {
-				current = current->getNextToken();
-				continue;
-			}
-			if (current->isNull()) {
-				current = current->getNextToken();
+		for (int j=start; j<end; j++) {
+			if (!strands.isData(j) || strands.isNull(j)) {
 				continue;
 			}
+			HTp current = strands.getToken(j);
 			if (current->isRest()) {
-				current = current->getNextToken();
 				continue;
 			}
 			int subcount = current->getSubtokenCount();
@@ -391,7 +386,6 @@ int HumdrumFileContent::getNoteCount(void) {
 					counter++;
 				}
 			}
-			current = current->getNextToken();
 		}
 	}
 	return counter;
@@ -0,0 +1,133 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 18:31:40 PDT 2026
+// Last Modified: Sun Oct 18 23:59:57 PDT 2026
+// Filename:      HumdrumFileContent-null.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileContent-null.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Table of null-token resolutions for every token in the
+//                file: the last non-null data token in the (sub)spine at
+//                or before the token, and the line on which the sounding
+//                note was attacked.  The table is filled in one pass
+//                through the file, after which finding the note sounding
+//                at any (line, field) position does not need to follow
+//                token links.
+//
+
+#include "HumdrumFileContent.h"
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::analyzeNullResolution -- Fill in the null-token
+//     resolution table of the analysis tables.  Each token inherits the
+//     resolution of the previous token in its spine (the first spine for
+//     spine merges), so null data tokens and non-data tokens resolve to
+//     the last non-null data token before them.  The attack line of a
+//     secondary tied note is the attack line of the note that it is tied
+//     to.  If the contents of tokens are changed after the analysis, call
+//     invalidateAnalysis(HumFileAnalysis::PASS_NULL_TABLE) before using
+//     the table again.
+//
+
+bool HumdrumFileContent::analyzeNullResolution(void) {
+	if (!startAnalysis(HumFileAnalysis::PASS_NULL_TABLE)) {
+		return true;
+	}
+	HumAnalysisTables& tables = m_analysisTables;
+	HumdrumFileContent& infile = *this;
+
+	for (int i=0; i<infile.getLineCount(); i++) {
+		int fieldCount = infile[i].getFieldCount();
+		for (int j=0; j<fieldCount; j++) {
+			HTp token = infile.token(i, j);
+			int id = tables.getTokenId(i, j);
+			int previd = tables.getTokenId(token->getPreviousToken(0));
+			int resolved = tables.getNullResolution(previd);
+			int attack = tables.getAttackLine(previd);
+			if (token->isData() && !token->isNull()) {
+				if ((resolved < 0) || !token->isSecondaryTiedNote()) {
+					attack = i;
+				}
+				resolved = id;
+			}
+			tables.setNullResolution(id, resolved, attack);
+		}
+	}
+
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getResolvedToken -- Return the last non-null data
+//     token in the spine at or before the given position, or NULL if
+//     there is none.  For many lookups, use getAnalysisTables() directly
+//     after calling analyzeNullResolution().  Like the other accessors
+//     below, this reruns the analysis if lines have been added or removed
+//     since it was done.
+//
+
+HTp HumdrumFileContent::getResolvedToken(int line, int field) {
+	HumAnalysisTables& tables = getAnalysisTables();
+	requireAnalysis(HumFileAnalysis::PASS_NULL_TABLE);
+	return tables.getToken(tables.getNullResolution(tables.getTokenId(line, field)));
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getResolvedPosition -- Return the line and field of
+//     the last non-null data token in the spine at or before the given
+//     position.  Returns false if there is no such token.
+//
+
+bool HumdrumFileContent::getResolvedPosition(int line, int field, int& rline,
+		int& rfield) {
+	HumAnalysisTables& tables = getAnalysisTables();
+	requireAnalysis(HumFileAnalysis::PASS_NULL_TABLE);
+	int resolved = tables.getNullResolution(tables.getTokenId(line, field));
+	if (resolved < 0) {
+		rline = -1;
+		rfield = -1;
+		return false;
+	}
+	rline = tables.getTokenLine(resolved);
+	rfield = tables.getTokenField(resolved);
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getAttackLine -- Return the line on which the note
+//     (or rest) sounding at the given position was attacked, following
+//     ties back to the first note of the tie group.  Returns -1 if there
+//     is no data before the position in the spine.
+//
+
+int HumdrumFileContent::getAttackLine(int line, int field) {
+	HumAnalysisTables& tables = getAnalysisTables();
+	requireAnalysis(HumFileAnalysis::PASS_NULL_TABLE);
+	return tables.getAttackLine(tables.getTokenId(line, field));
+}
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Thu Sep 20 08:45:02 PDT 2018
-// Last Modified: Thu Sep 20 08:45:05 PDT 2018
+// Last Modified: Sun Oct 18 16:05:27 PDT 2026
 // Filename:      HumdrumFileContent-octave.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileContent-octave.cpp
 // Syntax:        C++11; humlib
@@ -30,6 +30,9 @@ namespace hum {
 //
 
 void HumdrumFileContent::analyzeOttavas(void) {
+	if (!startAnalysis(HumFileAnalysis::PASS_OTTAVAS)) {
+		return;
+	}
 	int tcount = getTrackCount();
 	vector<int> activeOttava(tcount+1, 0);
 	vector<int> octavestate(tcount+1, 0);
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Fri Dec  6 19:09:35 PST 2019
-// Last Modified: Fri Dec  6 19:09:39 PST 2019
+// Last Modified: Sun Oct 18 23:59:59 PDT 2026
 // Filename:      HumdrumFileContent-phrase.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileContent-phrase.cpp
 // Syntax:        C++11; humlib
@@ -29,10 +29,11 @@ namespace hum {
 //
 
 bool HumdrumFileContent::analyzePhrasings(void) {
-	if (m_analyses.m_phrases_analyzed) {
+	if (!startAnalysis(HumFileAnalysis::PASS_PHRASES)) {
 		return false;
 	}
-	m_analyses.m_phrases_analyzed = true;
+	HumAnalysisTables& tables = prepareAnalysisTables();
+	tables.getPhrases().resize(tables.getTokenCount());
 	bool output = true;
 	output &= analyzeKernPhrasings();
 	return output;
@@ -198,17 +199,25 @@ bool HumdrumFileContent::analyzeKernPhrasings(HTp spinestart,
 							if (labels[token->getLineIndex()].first) {
 								duration -= labels[token->getLineIndex()].first->getDurationFromStart();
 							}
-							token->setValue("auto", "endingPhraseBack", "true");
-							token->setValue("auto", "phraseSide", "stop");
-							token->setValue("auto", "phraseDuration",
-								token->getDurationToEnd());
+							m_analysisTables.getPhrases().addHanging(m_analysisTables.getTokenId(token),
+									false, token->getDurationToEnd(), -1, true);
+							if (m_analysisHashValues) {
+								token->setValue("auto", "endingPhraseBack", "true");
+								token->setValue("auto", "phraseSide", "stop");
+								token->setValue("auto", "phraseDuration",
+									token->getDurationToEnd());
+							}
 						} else {
 							// This is a phrase closing that does not have a matching opening.
-							token->setValue("auto", "hangingPhrase", "true");
-							token->setValue("auto", "phraseSide", "stop");
-							token->setValue("auto", "phraseOpenIndex", to_string(i));
-							token->setValue("auto", "phraseDuration",
-								token->getDurationToEnd());
+							m_analysisTables.getPhrases().addHanging(m_analysisTables.getTokenId(token),
+									false, token->getDurationToEnd(), i);
+							if (m_analysisHashValues) {
+								token->setValue("auto", "hangingPhrase", "true");
+								token->setValue("auto", "phraseSide", "stop");
+								token->setValue("auto", "phraseOpenIndex", to_string(i));
+								token->setValue("auto", "phraseDuration",
+									token->getDurationToEnd());
+							}
 						}
 					}
 				}
@@ -233,10 +242,15 @@ bool HumdrumFileContent::analyzeKernPhrasings(HTp spinestart,
 	for (int i=0; i<(int)phraseopens.size(); i++) {
 		for (int j=0; j<(int)phraseopens[i].size(); j++) {
 			for (int k=0; k<(int)phraseopens[i][j].size(); k++) {
-				phraseopens[i][j][k]->setValue("", "auto", "hangingPhrase", "true");
-				phraseopens[i][j][k]->setValue("", "auto", "phraseSide", "start");
-				phraseopens[i][j][k]->setValue("", "auto", "phraseDuration",
-						phraseopens[i][j][k]->getDurationFromStart());
+				HTp ptok = phraseopens[i][j][k];
+				m_analysisTables.getPhrases().addHanging(m_analysisTables.getTokenId(ptok),
+						true, ptok->getDurationFromStart());
+				if (m_analysisHashValues) {
+					ptok->setValue("", "auto", "hangingPhrase", "true");
+					ptok->setValue("", "auto", "phraseSide", "start");
+					ptok->setValue("", "auto", "phraseDuration",
+							ptok->getDurationFromStart());
+				}
 			}
 		}
 	}
@@ -336,21 +350,38 @@ bool HumdrumFileContent::isLinkedPhraseBegin(HTp token, int index, const string&
 //////////////////////////////
 //
 // HumdrumFileContent::linkPhraseEndpoints --  Allow up to two phrase starts/ends
-//      on a note.
+//      on a note.  The link is stored in the phrase analysis table, and
+//      also in the "auto" HumHash parameters of the tokens if analysis
+//      hash values are active.
 //
 
 void HumdrumFileContent::linkPhraseEndpoints(HTp phrasestart, HTp phraseend) {
+	HumSpanTable& phrases = m_analysisTables.getPhrases();
+	int startid = m_analysisTables.getTokenId(phrasestart);
+	int endid   = m_analysisTables.getTokenId(phraseend);
+
+	int phraseEndCount = phrases.getStartCount(startid);
+	phraseEndCount++;
+	int phraseStartCount = phrases.getEndCount(endid);
+	phraseStartCount++;
+
+	HumNum duration = phraseend->getDurationFromStart()
+			- phrasestart->getDurationFromStart();
+
+	phrases.addLink(startid, endid, phrasestart, phraseend, phraseEndCount,
+			phraseStartCount, duration);
+
+	if (!m_analysisHashValues) {
+		return;
+	}
+
 	string durtag = "phraseDuration";
 	string endtag = "phraseEnd";
-	int phraseEndCount = phrasestart->getValueInt("auto", "phraseEndCount");
-	phraseEndCount++;
 	if (phraseEndCount > 1) {
 		endtag += to_string(phraseEndCount);
 		durtag += to_string(phraseEndCount);
 	}
 	string starttag = "phraseStart";
-	int phraseStartCount = phraseend->getValueInt("auto", "phraseStartCount");
-	phraseStartCount++;
 	if (phraseStartCount > 1) {
 		starttag += to_string(phraseStartCount);
 	}
@@ -359,8 +390,6 @@ void HumdrumFileContent::linkPhraseEndpoints(HTp phrasestart, HTp phraseend) {
 	phrasestart->setValue("auto", "id", phrasestart);
 	phraseend->setValue("auto", starttag, phrasestart);
 	phraseend->setValue("auto", "id", phraseend);
-	HumNum duration = phraseend->getDurationFromStart()
-			- phrasestart->getDurationFromStart();
 	phrasestart->setValue("auto", durtag, duration);
 	phrasestart->setValue("auto", "phraseEndCount", to_string(phraseEndCount));
 	phraseend->setValue("auto", "phraseStartCount", to_string(phraseStartCount));
@@ -1,6 +1,6 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Tue Jun 12 21:02:48 PDT 2018
-// Last Modified: Sun Apr 17 01:39:03 PDT 2022
+// Last Modified: Sun Oct 18 16:05:27 PDT 2026
 // Filename:      HumdrumFileContent-rest.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileContent-rest.cpp
 // Syntax:        C++11; humlib
@@ -29,6 +29,9 @@ namespace hum {
 //
 
 void HumdrumFileContent::analyzeRestPositions(void) {
+	if (!startAnalysis(HumFileAnalysis::PASS_REST_POSITIONS)) {
+		return;
+	}
 	vector<HTp> kernstarts = getKernSpineStartList();
 
 	// Now using verovio automatic rest positions, so not calcualting
@@ -238,10 +241,7 @@ bool HumdrumFileContent::checkRestForVerticalPositioning(HTp rest, int baseline)
 		return false;
 	}
 
-	string oloc = to_string(oct);
-
-	rest->setValue("auto", "ploc", dname);
-	rest->setValue("auto", "oloc", oloc);
+	storeRestPosition(rest, pc, oct);
 
 	return true;
 }
@@ -276,8 +276,25 @@ void HumdrumFileContent::setRestOnCenterStaffLine(HTp rest, int baseline) {
 		return;
 	}
 
-	string oloc = to_string(oct);
+	storeRestPosition(rest, pc, oct);
+}
+
 
+
+//////////////////////////////
+//
+// HumdrumFileContent::storeRestPosition -- Store the vertical position of
+//     a rest in the analysis tables, and as ploc/oloc "auto" parameters if
+//     analysis hash values are active.
+//
+
+void HumdrumFileContent::storeRestPosition(HTp rest, int pc, int oct) {
+	m_analysisTables.setRestPosition(m_analysisTables.getTokenId(rest), pc, oct);
+	if (!m_analysisHashValues) {
+		return;
+	}
+	string dname(1, (char)("CDEFGAB"[pc]));
+	string oloc = to_string(oct);
 	rest->setValue("auto", "ploc", dname);
 	rest->setValue("auto", "oloc", oloc);
 }
@@ -341,10 +358,7 @@ void HumdrumFileContent::assignVerticalRestPosition(HTp first, HTp second, int b
 		return;
 	}
 
-	string oloc = to_string(oct);
-
-	rest->setValue("auto", "ploc", dname);
-	rest->setValue("auto", "oloc", oloc);
+	storeRestPosition(rest, pc, oct);
 }
 
 
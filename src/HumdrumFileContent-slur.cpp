@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Aug 17 02:39:28 PDT 2015
-// Last Modified: Mon Oct  5 23:15:44 PDT 2015
+// Last Modified: Sun Oct 18 16:05:27 PDT 2026
 // Filename:      HumdrumFileContent-slur.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileContent-slur.cpp
 // Syntax:        C++11; humlib
@@ -29,10 +29,11 @@ namespace hum {
 //
 
 bool HumdrumFileContent::analyzeSlurs(void) {
-	if (m_analyses.m_slurs_analyzed) {
+	if (!startAnalysis(HumFileAnalysis::PASS_SLURS)) {
 		return false;
 	}
-	m_analyses.m_slurs_analyzed = true;
+	HumAnalysisTables& tables = prepareAnalysisTables();
+	tables.getSlurs().resize(tables.getTokenCount());
 	bool output = true;
 	output &= analyzeKernSlurs();
 	output &= analyzeMensSlurs();
@@ -102,11 +103,10 @@ bool HumdrumFileContent::analyzeMensSlurs(void) {
 
 	vector<HTp> mensspines;
 	getSpineStartList(mensspines, "**mens");
-	bool output = true;
 	string linkSignifier = m_signifiers.getKernLinkSignifier();
-	for (int i=0; i<(int)mensspines.size(); i++) {
-		output = output && analyzeKernSlurs(mensspines[i], slurstarts, slurends, labels, endings, linkSignifier);
-	}
+	SpineSpanAnalysis analysis = &HumdrumFileContent::analyzeKernSlurs;
+	bool output = analyzeSpineSpans(analysis, m_analysisTables.getSlurs(), mensspines,
+			slurstarts, slurends, labels, endings, linkSignifier);
 	createLinkedSlurs(slurstarts, slurends);
 	return output;
 }
@@ -173,11 +173,10 @@ bool HumdrumFileContent::analyzeKernSlurs(void) {
 
 	vector<HTp> kernspines;
 	getSpineStartList(kernspines, "**kern");
-	bool output = true;
 	string linkSignifier = m_signifiers.getKernLinkSignifier();
-	for (int i=0; i<(int)kernspines.size(); i++) {
-		output = output && analyzeKernSlurs(kernspines[i], slurstarts, slurends, labels, endings, linkSignifier);
-	}
+	SpineSpanAnalysis analysis = &HumdrumFileContent::analyzeKernSlurs;
+	bool output = analyzeSpineSpans(analysis, m_analysisTables.getSlurs(), kernspines,
+			slurstarts, slurends, labels, endings, linkSignifier);
 
 	createLinkedSlurs(slurstarts, slurends);
 	return output;
@@ -271,17 +270,25 @@ bool HumdrumFileContent::analyzeKernSlurs(HTp spinestart,
 							if (labels[token->getLineIndex()].first) {
 								duration -= labels[token->getLineIndex()].first->getDurationFromStart();
 							}
-							token->setValue("auto", "endingSlurBack", "true");
-							token->setValue("auto", "slurSide", "stop");
-							token->setValue("auto", "slurDuration",
-								token->getDurationToEnd());
+							m_analysisTables.getSlurs().addHanging(m_analysisTables.getTokenId(token),
+									false, token->getDurationToEnd(), -1, true);
+							if (m_analysisHashValues) {
+								token->setValue("auto", "endingSlurBack", "true");
+								token->setValue("auto", "slurSide", "stop");
+								token->setValue("auto", "slurDuration",
+									token->getDurationToEnd());
+							}
 						} else {
 							// This is a slur closing that does not have a matching opening.
-							token->setValue("auto", "hangingSlur", "true");
-							token->setValue("auto", "slurSide", "stop");
-							token->setValue("auto", "slurOpenIndex", to_string(i));
-							token->setValue("auto", "slurDuration",
-								token->getDurationToEnd());
+							m_analysisTables.getSlurs().addHanging(m_analysisTables.getTokenId(token),
+									false, token->getDurationToEnd(), i);
+							if (m_analysisHashValues) {
+								token->setValue("auto", "hangingSlur", "true");
+								token->setValue("auto", "slurSide", "stop");
+								token->setValue("auto", "slurOpenIndex", to_string(i));
+								token->setValue("auto", "slurDuration",
+									token->getDurationToEnd());
+							}
 						}
 					}
 				}
@@ -306,10 +313,15 @@ bool HumdrumFileContent::analyzeKernSlurs(HTp spinestart,
 	for (int i=0; i<(int)sluropens.size(); i++) {
 		for (int j=0; j<(int)sluropens[i].size(); j++) {
 			for (int k=0; k<(int)sluropens[i][j].size(); k++) {
-				sluropens[i][j][k]->setValue("", "auto", "hangingSlur", "true");
-				sluropens[i][j][k]->setValue("", "auto", "slurSide", "start");
-				sluropens[i][j][k]->setValue("", "auto", "slurDuration",
-						sluropens[i][j][k]->getDurationFromStart());
+				HTp stok = sluropens[i][j][k];
+				m_analysisTables.getSlurs().addHanging(m_analysisTables.getTokenId(stok),
+						true, stok->getDurationFromStart());
+				if (m_analysisHashValues) {
+					stok->setValue("", "auto", "hangingSlur", "true");
+					stok->setValue("", "auto", "slurSide", "start");
+					stok->setValue("", "auto", "slurDuration",
+							stok->getDurationFromStart());
+				}
 			}
 		}
 	}
@@ -409,38 +421,52 @@ bool HumdrumFileContent::isLinkedSlurBegin(HTp token, int index, const string& p
 //////////////////////////////
 //
 // HumdrumFileContent::linkSlurEndpoints --  Allow up to two slur starts/ends
-//      on a note.
+//      on a note.  The link is stored in the slur analysis table, and also
+//      in the "auto" HumHash parameters of the tokens if analysis hash
+//      values are active.
 //
 
 void HumdrumFileContent::linkSlurEndpoints(HTp slurstart, HTp slurend) {
+	HumSpanTable& slurs = m_analysisTables.getSlurs();
+	int startid = m_analysisTables.getTokenId(slurstart);
+	int endid   = m_analysisTables.getTokenId(slurend);
+
+	int slurStartCount = slurs.getStartCount(startid);
+	int opencount = (int)count(slurstart->begin(), slurstart->end(), '(');
+	slurStartCount++;
+	int openEnumeration = opencount - slurStartCount + 1;
+
+	int slurEndNumber = slurs.getEndCount(endid);
+	slurEndNumber++;
+	int closeEnumeration = slurEndNumber;
+
+	HumNum duration = slurend->getDurationFromStart()
+			- slurstart->getDurationFromStart();
+
+	slurs.addLink(startid, endid, slurstart, slurend, openEnumeration,
+			closeEnumeration, duration);
+
+	if (!m_analysisHashValues) {
+		return;
+	}
+
 	string durtag = "slurDuration";
 	string endtag = "slurEndId";
 	string starttag = "slurStartId";
 	string slurstartnumbertag = "slurStartNumber";
 	string slurendnumbertag = "slurEndNumber";
 
-	int slurStartCount = slurstart->getValueInt("auto", "slurStartCount");
-	int opencount = (int)count(slurstart->begin(), slurstart->end(), '(');
-	slurStartCount++;
-	int openEnumeration = opencount - slurStartCount + 1;
-
 	if (openEnumeration > 1) {
 		endtag += to_string(openEnumeration);
 		durtag += to_string(openEnumeration);
 		slurendnumbertag += to_string(openEnumeration);
 	}
 
-	int slurEndNumber = slurend->getValueInt("auto", "slurEndCount");
-	slurEndNumber++;
-	int closeEnumeration = slurEndNumber;
 	if (closeEnumeration > 1) {
 		starttag += to_string(closeEnumeration);
 		slurstartnumbertag += to_string(closeEnumeration);
 	}
 
-	HumNum duration = slurend->getDurationFromStart()
-			- slurstart->getDurationFromStart();
-
 	slurstart->setValue("auto", endtag,            slurend);
 	slurstart->setValue("auto", "id",              slurstart);
 	slurstart->setValue("auto", slurendnumbertag,  closeEnumeration);
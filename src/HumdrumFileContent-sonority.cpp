@@ -0,0 +1,136 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 18:45:08 PDT 2026
+// Last Modified: Sun Oct 18 23:59:55 PDT 2026
+// Filename:      HumdrumFileContent-sonority.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileContent-sonority.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Table of the pitches sounding on each data line of the
+//                file (the vertical sonorities), for harmonic analysis
+//                tools.  The table is filled in one pass through the file
+//                using the null-token resolution table, and each **kern
+//                token is parsed only once, no matter how many lines it
+//                is sustained through.
+//
+
+#include "HumdrumFileContent.h"
+#include "Convert.h"
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::analyzeSonorities -- Fill in the sonority table of
+//     the analysis tables, listing the notes sounding in the **kern spines
+//     on each data line.  If the pitches of tokens are changed after the
+//     analysis, call invalidateAnalysis(HumFileAnalysis::PASS_SONORITIES)
+//     before using the table again.
+//
+
+bool HumdrumFileContent::analyzeSonorities(void) {
+	if (!startAnalysis(HumFileAnalysis::PASS_SONORITIES)) {
+		return true;
+	}
+	HumAnalysisTables& tables = m_analysisTables;
+	HumSonorityTable& sonorities = tables.getSonorities();
+	HumdrumFileContent& infile = *this;
+	sonorities.resize(infile.getLineCount());
+
+	// Pitches of the subtokens of each non-null token, parsed when the
+	// token is first used (-1 for rests and other non-pitches), and
+	// whether the subtoken continues a tie:
+	vector<int> pitchStart(tables.getTokenCount(), -1);
+	vector<int> pitchCount(tables.getTokenCount(), 0);
+	vector<short> pitches;
+	vector<bool> tied;
+
+	for (int i=0; i<infile.getLineCount(); i++) {
+		if (!infile[i].isData()) {
+			continue;
+		}
+		sonorities.addSlice(i);
+		int fieldCount = infile[i].getFieldCount();
+		for (int j=0; j<fieldCount; j++) {
+			HTp token = infile.token(i, j);
+			if (!token->isKern()) {
+				continue;
+			}
+			int id = tables.getTokenId(i, j);
+			int resolved = tables.getNullResolution(id);
+			if (resolved < 0) {
+				continue;
+			}
+			HTp note = tables.getToken(resolved);
+			if (pitchStart[resolved] < 0) {
+				pitchStart[resolved] = (int)pitches.size();
+				int scount = note->getSubtokenCount();
+				for (int k=0; k<scount; k++) {
+					string subtok = note->getSubtoken(k);
+					int base40 = -1;
+					if (subtok.find('r') == string::npos) {
+						base40 = Convert::kernToBase40(subtok);
+					}
+					pitches.push_back((short)(base40 < 0 ? -1 : base40));
+					tied.push_back((subtok.find('_') != string::npos) ||
+							(subtok.find(']') != string::npos));
+				}
+				pitchCount[resolved] = scount;
+			}
+			int start = pitchStart[resolved];
+			for (int k=0; k<pitchCount[resolved]; k++) {
+				if (pitches[start + k] < 0) {
+					continue;
+				}
+				bool attack = (resolved == id) && !tied[start + k];
+				sonorities.addNote(i, note, j, k, pitches[start + k], attack);
+			}
+		}
+	}
+
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getSonorities -- Return the sonority table for the
+//     file, running the analysis if necessary.  Iterating over the table
+//     visits the sonority of each data line.  If lines have been added or
+//     removed since the analysis, the tokens are indexed again, and the
+//     analysis is rerun.
+//
+
+const HumSonorityTable& HumdrumFileContent::getSonorities(void) {
+	// Check the line count of the token index:
+	HumAnalysisTables& tables = getAnalysisTables();
+	requireAnalysis(HumFileAnalysis::PASS_SONORITIES);
+	return tables.getSonorities();
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getSonority -- Return the notes sounding on a line.
+//     The sonority is empty for non-data lines.
+//
+
+HumSonority HumdrumFileContent::getSonority(int line) {
+	return getSonorities().getSonority(line);
+}
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
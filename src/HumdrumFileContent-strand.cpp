@@ -0,0 +1,83 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 21:58:30 PDT 2026
+// Last Modified: Sun Oct 18 21:58:36 PDT 2026
+// Filename:      HumdrumFileContent-strand.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileContent-strand.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Table of the tokens of each spine strand.
+//
+
+#include "HumdrumFileContent.h"
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::analyzeStrandTable -- Fill in the strand table of
+//     the file (see HumStrandTable) with the tokens of each strand, in the
+//     same order as getStrandStart().  If tokens are added or removed
+//     after the analysis, call
+//     invalidateAnalysis(HumFileAnalysis::PASS_STRAND_TABLE) before using
+//     the table again.
+//
+
+bool HumdrumFileContent::analyzeStrandTable(void) {
+	if (!startAnalysis(HumFileAnalysis::PASS_STRAND_TABLE)) {
+		return true;
+	}
+	HumStrandTable& table = m_strandTable;
+	table.clear();
+	table.setLineCount(getLineCount());
+
+	for (int i=0; i<getSpineCount(); i++) {
+		for (int j=0; j<getStrandCount(i); j++) {
+			table.addStrand(i);
+			HTp current = getStrandStart(i, j);
+			HTp send = getStrandEnd(i, j);
+			while (current) {
+				table.addToken(current);
+				if (current == send) {
+					break;
+				}
+				current = current->getNextToken();
+			}
+		}
+	}
+
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getStrandTable -- Return the strand table of the
+//     file, running the analysis if necessary.
+//
+
+const HumStrandTable& HumdrumFileContent::getStrandTable(void) {
+	HumStrandTable& table = m_strandTable;
+	if (m_analyses.isDone(HumFileAnalysis::PASS_STRAND_TABLE) &&
+			(table.getLineCount() != getLineCount())) {
+		// Lines have been added or removed since the analysis.
+		invalidateAnalysis(HumFileAnalysis::PASS_STRAND_TABLE);
+	}
+	requireAnalysis(HumFileAnalysis::PASS_STRAND_TABLE);
+	return table;
+}
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
@@ -1,13 +1,15 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Dec 16 12:20:21 PST 2019
-// Last Modified: Mon Dec 16 12:20:24 PST 2019
+// Last Modified: Sun Oct 18 21:24:40 PDT 2026
 // Filename:      HumdrumFileContent-text.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileContent-text.cpp
 // Syntax:        C++11; humlib
 // vim:           syntax=cpp ts=3 noexpandtab nowrap
 //
-// Description:   Content analysis related to **text/**silbe spines.
+// Description:   Content analysis related to **text/**silbe spines:
+//                repetition markers and the text table of syllables, words
+//                and melismas.
 //
 
 #include "HumdrumFileContent.h"
@@ -92,6 +94,132 @@ bool HumdrumFileContent::analyzeTextRepetition(void) {
 }
 
 
+
+//////////////////////////////
+//
+// HumdrumFileContent::analyzeText -- Fill in the text table of the file
+//     (see HumTextTable) with the syllables and words of each lyric spine
+//     and the notes sung on each syllable.  If the lyrics or rhythms are
+//     changed after the analysis, call
+//     invalidateAnalysis(HumFileAnalysis::PASS_TEXT) before using the
+//     table again.
+//
+
+bool HumdrumFileContent::analyzeText(void) {
+	if (!startAnalysis(HumFileAnalysis::PASS_TEXT)) {
+		return true;
+	}
+	HumdrumFileContent& infile = *this;
+	HumTextTable& table = m_textTable;
+	table.clear();
+	table.setLineCount(infile.getLineCount());
+
+	vector<HTp> sstarts;
+	infile.getSpineStartList(sstarts);
+	vector<int> syllables;
+	for (int i=0; i<(int)sstarts.size(); i++) {
+		HTp start = sstarts[i];
+		if (!(start->isDataType("**text") || start->isDataType("**silbe") ||
+				start->isDataType("**sylb") || start->isDataType("**sylba"))) {
+			continue;
+		}
+		int spine = table.addSpine(start);
+		syllables.clear();
+		HTp current = start->getNextToken();
+		HTp ending = start;
+		while (current) {
+			if (current->isData() && !current->isNull() && !current->empty()) {
+				syllables.push_back(table.addSyllable(spine, current));
+			}
+			ending = current;
+			current = current->getNextToken();
+		}
+
+		// The notes of a syllable end at the line of the next syllable, or
+		// at the end of the spine:
+		HTp first;
+		HTp last;
+		HumNum endtime;
+		for (int j=0; j<(int)syllables.size(); j++) {
+			int endline = ending->getLineIndex();
+			if (j < (int)syllables.size() - 1) {
+				endline = table.getSyllableToken(syllables[j+1])->getLineIndex();
+			}
+			HTp token = table.getSyllableToken(syllables[j]);
+			int count = getSyllableNotes(token, endline, first, last, endtime);
+			table.setNotes(syllables[j], count, first, last, endtime);
+		}
+	}
+
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getTextTable -- Return the text table of the file,
+//     running the analysis if necessary.
+//
+
+const HumTextTable& HumdrumFileContent::getTextTable(void) {
+	HumTextTable& table = m_textTable;
+	if (m_analyses.isDone(HumFileAnalysis::PASS_TEXT) &&
+			(table.getLineCount() != getLineCount())) {
+		// Lines have been added or removed since the analysis.
+		invalidateAnalysis(HumFileAnalysis::PASS_TEXT);
+	}
+	requireAnalysis(HumFileAnalysis::PASS_TEXT);
+	return table;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getSyllableNotes -- Return the number of notes
+//     attacked on a syllable: the attacks in the first **kern spine to the
+//     left of the syllable from the line of the syllable up to (but not
+//     including) endline.  Rests are skipped, and the tied notes of the
+//     last attack are included in the syllable.  first is set to the **kern
+//     token on the line of the syllable, last to the last note or tied note,
+//     and endtime to the end of the last note (or the start of the syllable
+//     if there are no notes).
+//
+
+int HumdrumFileContent::getSyllableNotes(HTp syllable, int endline,
+		HTp& first, HTp& last, HumNum& endtime) {
+	first = NULL;
+	last = NULL;
+	endtime = syllable->getDurationFromStart();
+	HTp current = syllable->getPreviousFieldToken();
+	while (current && !current->isKern()) {
+		current = current->getPreviousFieldToken();
+	}
+	if (!current) {
+		return 0;
+	}
+	first = current;
+	int output = 0;
+	while (current) {
+		if ((!current->isData()) || current->isNull() || current->isRest()) {
+			current = current->getNextToken();
+			continue;
+		}
+		if (current->isNoteAttack()) {
+			if (current->getLineIndex() >= endline) {
+				break;
+			}
+			output++;
+		}
+		last = current;
+		endtime = current->getDurationFromStart() + current->getDuration();
+		current = current->getNextToken();
+	}
+	return output;
+}
+
+
 // END_MERGE
 
 } // end namespace hum
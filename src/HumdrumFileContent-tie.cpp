@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Oct  5 23:16:26 PDT 2015
-// Last Modified: Mon Oct  5 23:16:29 PDT 2015
+// Last Modified: Sun Oct 18 23:59:59 PDT 2026
 // Filename:      HumdrumFileContent-tie.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileContent-tie.cpp
 // Syntax:        C++11; humlib
@@ -13,6 +13,8 @@
 #include "Convert.h"
 #include "HumdrumFileContent.h"
 
+#include <algorithm>
+
 using namespace std;
 
 namespace hum {
@@ -24,10 +26,17 @@ namespace hum {
 //////////////////////////////
 //
 // HumdrumFileContent::analyzeKernTies -- Link start and ends of
-//    ties to each other.
+//    ties to each other.  The analysis is only done once for each version
+//    of the file: call createLinesFromTokens() or invalidateAnalysis()
+//    after changing ties to analyze them again.
 //
 
 bool HumdrumFileContent::analyzeKernTies(void) {
+	if (!startAnalysis(HumFileAnalysis::PASS_TIES)) {
+		return true;
+	}
+	HumAnalysisTables& tables = prepareAnalysisTables();
+	tables.getTies().resize(tables.getTokenCount());
 	vector<pair<HTp, int>> linkedtiestarts;
 	vector<pair<HTp, int>> linkedtieends;
 
@@ -161,21 +170,37 @@ void HumdrumFileContent::createLinkedTies(vector<pair<HTp, int>>& linkstarts,
 
 //////////////////////////////
 //
-// HumdrumFileContent::linkTieEndpoints --
+// HumdrumFileContent::linkTieEndpoints -- Link the start and end notes
+//     of a tie.  The start and end indexes are the subtoken indexes of
+//     the notes in chords (-1 for single notes).  The link is stored in
+//     the tie analysis table, and also in the "auto" HumHash parameters
+//     of the tokens if analysis hash values are active.
 //
 
 void HumdrumFileContent::linkTieEndpoints(HTp tiestart,
 		int startindex, HTp tieend, int endindex) {
 
+	int startnumber = startindex + 1;
+	int endnumber   = endindex + 1;
+
+   HumNum duration = tieend->getDurationFromStart()
+         - tiestart->getDurationFromStart();
+
+	// Single notes are the first subtoken in the table:
+	m_analysisTables.getTies().addLink(m_analysisTables.getTokenId(tiestart),
+			m_analysisTables.getTokenId(tieend), tiestart, tieend,
+			std::max(startnumber, 1), std::max(endnumber, 1), duration);
+
+	if (!m_analysisHashValues) {
+		return;
+	}
+
    string durtag   = "tieDuration";
    string starttag = "tieStart";
    string endtag   = "tieEnd";
 	string startnum = "tieStartSubtokenNumber";
 	string endnum   = "tieEndSubtokenNumber";
 
-	int startnumber = startindex + 1;
-	int endnumber   = endindex + 1;
-
 	if (tiestart->isChord()) {
 		if (startnumber > 0) {
 			durtag   += to_string(startnumber);
@@ -202,8 +227,6 @@ void HumdrumFileContent::linkTieEndpoints(HTp tiestart,
 		tieend->setValue("auto", startnum, to_string(startnumber));
 	}
 
-   HumNum duration = tieend->getDurationFromStart()
-         - tiestart->getDurationFromStart();
    tiestart->setValue("auto", durtag, duration);
 }
 
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Aug 17 02:39:28 PDT 2015
-// Last Modified: Mon Aug 17 02:39:32 PDT 2015
+// Last Modified: Sun Oct 18 23:59:50 PDT 2026
 // Filename:      HumdrumFileContent.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileContent.cpp
 // Syntax:        C++11; humlib
@@ -14,6 +14,9 @@
 #include "HumRegex.h"
 #include "HumdrumFileContent.h"
 
+#include <atomic>
+#include <thread>
+
 using namespace std;
 
 namespace hum {
@@ -54,6 +57,322 @@ HumdrumFileContent::~HumdrumFileContent() {
 
 
 
+//////////////////////////////
+//
+// HumdrumFileContent::getAnalysisTables -- Return the typed analysis
+//     results for the file.  The tokens are indexed the first time that
+//     this function is called after reading the file, after
+//     createLinesFromTokens() or invalidateAnalysis() is called, or after
+//     lines have been added or removed.  This check is done for each
+//     call, so it only compares the line count (prepareAnalysisTables()
+//     compares every line).  Changing tokens in place does not change the
+//     index, but call createLinesFromTokens() or invalidateAnalysis()
+//     afterwards so that stale results are cleared from the tables.
+//
+
+HumAnalysisTables& HumdrumFileContent::getAnalysisTables(void) {
+	if ((!m_analyses.isDone(HumFileAnalysis::PASS_TOKEN_INDEX)) ||
+			(m_analysisTables.getLineCount() != getLineCount())) {
+		indexAnalysisTables();
+	}
+	return m_analysisTables;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::prepareAnalysisTables -- Check that the token index
+//     of the analysis tables matches the current contents of the file
+//     before running an analysis, and recreate the index (clearing all
+//     previous analysis results) if not.
+//
+
+HumAnalysisTables& HumdrumFileContent::prepareAnalysisTables(void) {
+	if ((!m_analyses.isDone(HumFileAnalysis::PASS_TOKEN_INDEX)) ||
+			!m_analysisTables.isIndexCurrent(*this)) {
+		indexAnalysisTables();
+	}
+	return m_analysisTables;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::indexAnalysisTables -- Create a new token index for
+//     the analysis tables.  This clears the tables, so the analyses which
+//     store their results in the tables have to be run again.
+//
+
+void HumdrumFileContent::indexAnalysisTables(void) {
+	m_analyses.invalidate(HumFileAnalysis::PASS_TOKEN_INDEX);
+	m_analyses.setDone(HumFileAnalysis::PASS_TOKEN_INDEX);
+	m_analysisTables.indexTokens(*this);
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::requireAnalysis -- Run an analysis pass (and the
+//     passes that it depends on) if it has not already been run on the
+//     current contents of the file.  Returns true if the results of the
+//     pass are available.  The structure and rhythm passes are not run
+//     here, since they are controlled by how the file was read.
+//
+
+bool HumdrumFileContent::requireAnalysis(HumFileAnalysis::Pass pass) {
+	if (pass == HumFileAnalysis::PASS_TOKEN_INDEX) {
+		// Always check that the index matches the file contents.
+		prepareAnalysisTables();
+		return true;
+	}
+	if (m_analyses.isDone(pass)) {
+		return true;
+	}
+	switch (pass) {
+		case HumFileAnalysis::PASS_STRANDS:          analyzeStrands();          break;
+		case HumFileAnalysis::PASS_NULLS:            resolveNullTokens();       break;
+		case HumFileAnalysis::PASS_STROPHES:         analyzeStrophes();         break;
+		case HumFileAnalysis::PASS_OTTAVAS:          analyzeOttavas();          break;
+		case HumFileAnalysis::PASS_KERN_ACCIDENTALS: analyzeKernAccidentals();  break;
+		case HumFileAnalysis::PASS_MENS_ACCIDENTALS: analyzeMensAccidentals();  break;
+		case HumFileAnalysis::PASS_SLURS:            analyzeSlurs();            break;
+		case HumFileAnalysis::PASS_BEAMS:            analyzeBeams();            break;
+		case HumFileAnalysis::PASS_PHRASES:          analyzePhrasings();        break;
+		case HumFileAnalysis::PASS_TIES:             analyzeKernTies();         break;
+		case HumFileAnalysis::PASS_BARLINES:         analyzeBarlines();         break;
+		case HumFileAnalysis::PASS_MEASURES:         analyzeMeasureIndex();     break;
+		case HumFileAnalysis::PASS_REST_POSITIONS:   analyzeRestPositions();    break;
+		case HumFileAnalysis::PASS_NULL_TABLE:       analyzeNullResolution();   break;
+		case HumFileAnalysis::PASS_SONORITIES:       analyzeSonorities();       break;
+		case HumFileAnalysis::PASS_METRIC_GRID:      analyzeMetricGrid();       break;
+		case HumFileAnalysis::PASS_TEXT:             analyzeText();             break;
+		case HumFileAnalysis::PASS_STRAND_TABLE:     analyzeStrandTable();      break;
+		default:
+			break;
+	}
+	return m_analyses.isDone(pass);
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::isAnalyzed -- Return true if the analysis pass has
+//     been run on the current contents of the file.
+//
+
+bool HumdrumFileContent::isAnalyzed(HumFileAnalysis::Pass pass) const {
+	return m_analyses.isDone(pass);
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::invalidateAnalysis -- Mark an analysis pass and all
+//     passes which depend on it as needing to be run again, such as after
+//     changing the contents of tokens.
+//
+
+void HumdrumFileContent::invalidateAnalysis(HumFileAnalysis::Pass pass) {
+	m_analyses.invalidate(pass);
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::startAnalysis -- Called at the start of an analysis
+//     pass: returns false if the pass has already been run; otherwise, the
+//     passes that it depends on are run, the pass is marked as done, and
+//     true is returned.
+//
+
+bool HumdrumFileContent::startAnalysis(HumFileAnalysis::Pass pass) {
+	if (m_analyses.isDone(pass)) {
+		return false;
+	}
+	unsigned int dependencies = HumFileAnalysis::getDependencies(pass);
+	for (int i=0; i<HumFileAnalysis::PASS_COUNT; i++) {
+		if (dependencies & (1u << i)) {
+			requireAnalysis((HumFileAnalysis::Pass)i);
+		}
+	}
+	m_analyses.setDone(pass);
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::setAnalysisHashValues -- Set to false to store
+//     the results of accidental, slur, beam and rest-position analyses
+//     only in the analysis tables (and not also as strings in the "auto"
+//     HumHash namespace of the tokens).
+//
+
+void HumdrumFileContent::setAnalysisHashValues(bool state) {
+	m_analysisHashValues = state;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getAnalysisHashValues -- Return true if analysis
+//     results are also stored in the "auto" HumHash namespace of tokens.
+//
+
+bool HumdrumFileContent::getAnalysisHashValues(void) const {
+	return m_analysisHashValues;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::setAnalysisThreadCount -- Set the number of threads
+//     used to analyze spines in parallel for slur, beam and accidental
+//     analyses.  The default is 1 (serial analysis); a count of 0 or less
+//     will use the number of cores.  The results are identical to the
+//     serial analysis.
+//
+
+void HumdrumFileContent::setAnalysisThreadCount(int count) {
+	m_analysisThreads = count;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getAnalysisThreadCount -- Return the number of threads
+//     used for parallel spine analyses (0 or less for the number of cores).
+//
+
+int HumdrumFileContent::getAnalysisThreadCount(void) const {
+	return m_analysisThreads;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::useAnalysisThreads -- Return true if more than one
+//     thread should be used to analyze the given number of spines.
+//
+
+bool HumdrumFileContent::useAnalysisThreads(int count) const {
+	if (count < 2) {
+		return false;
+	}
+	if (m_analysisThreads == 1) {
+		return false;
+	}
+	if ((m_analysisThreads <= 0) && (std::thread::hardware_concurrency() < 2)) {
+		return false;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::runAnalysisThreads -- Call the analysis function
+//     for each index from 0 to count-1, with each thread pulling the next
+//     unprocessed index.
+//
+
+void HumdrumFileContent::runAnalysisThreads(int count,
+		const std::function<void(int)>& analysis) {
+	int threadCount = m_analysisThreads;
+	if (threadCount <= 0) {
+		threadCount = (int)std::thread::hardware_concurrency();
+	}
+	if (threadCount > count) {
+		threadCount = count;
+	}
+	if (threadCount < 1) {
+		threadCount = 1;
+	}
+
+	std::atomic<int> nextIndex(0);
+	auto worker = [&](void) {
+		int index;
+		while ((index = nextIndex++) < count) {
+			analysis(index);
+		}
+	};
+
+	if (threadCount == 1) {
+		worker();
+	} else {
+		vector<std::thread> pool;
+		pool.reserve(threadCount);
+		for (int i=0; i<threadCount; i++) {
+			pool.emplace_back(worker);
+		}
+		for (int i=0; i<(int)pool.size(); i++) {
+			pool[i].join();
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::analyzeSpineSpans -- Run a slur or beam analysis
+//     on a list of spines.  If parallel analysis is active, each spine
+//     is analyzed in a separate task, and the links to spans in other
+//     spines are collected for each spine and then appended in spine
+//     order so that createLinkedSlurs() and createLinkedBeams() pair
+//     them in the same order as a serial analysis.  Every spine is
+//     analyzed even if the analysis of an earlier one fails, so that the
+//     span table is the same for any number of threads.
+//
+
+bool HumdrumFileContent::analyzeSpineSpans(SpineSpanAnalysis analysis,
+		HumSpanTable& table, vector<HTp>& spinestarts, vector<HTp>& linkstarts,
+		vector<HTp>& linkends, vector<pair<HTp, HTp>>& labels,
+		vector<int>& endings, const string& linksig) {
+	int count = (int)spinestarts.size();
+	bool output = true;
+	if (!useAnalysisThreads(count)) {
+		for (int i=0; i<count; i++) {
+			bool status = (this->*analysis)(spinestarts[i], linkstarts,
+					linkends, labels, endings, linksig);
+			output = output && status;
+		}
+		return output;
+	}
+
+	vector<vector<HTp>> starts(count);
+	vector<vector<HTp>> ends(count);
+	vector<int> status(count, 1);
+	std::mutex tablemutex;
+	table.setMutex(&tablemutex);
+	runAnalysisThreads(count, [&](int index) {
+		status[index] = (this->*analysis)(spinestarts[index], starts[index],
+				ends[index], labels, endings, linksig);
+	});
+	table.setMutex(NULL);
+
+	for (int i=0; i<count; i++) {
+		linkstarts.insert(linkstarts.end(), starts[i].begin(), starts[i].end());
+		linkends.insert(linkends.end(), ends[i].begin(), ends[i].end());
+		output = output && status[i];
+	}
+	return output;
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumFileContent::analyzeRScale --
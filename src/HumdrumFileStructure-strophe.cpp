@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Tue Oct 20 15:26:17 PDT 2020
-// Last Modified: Tue Oct 20 15:26:20 PDT 2020
+// Last Modified: Sun Oct 18 16:05:27 PDT 2026
 // Filename:      HumdrumFileStructure-strophe.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileStructure-strophe.cpp
 // Syntax:        C++11; humlib
@@ -26,7 +26,7 @@ namespace hum {
 //
 
 void HumdrumFileStructure::analyzeStropheMarkers(void) {
-	m_analyses.m_strophes_analyzed = true;
+	m_analyses.setDone(HumFileAnalysis::PASS_STROPHES);
 
 	m_strophes1d.clear();
 	m_strophes2d.clear();
@@ -96,7 +96,7 @@ void HumdrumFileStructure::analyzeStropheMarkers(void) {
 //
 
 bool HumdrumFileStructure::analyzeStrophes(void) {
-	if (!m_analyses.m_strands_analyzed) {
+	if (!m_analyses.isDone(HumFileAnalysis::PASS_STRANDS)) {
 		analyzeStrands();
 	}
 	analyzeStropheMarkers();
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Aug 17 02:39:28 PDT 2015
-// Last Modified: Mon Aug 17 02:39:32 PDT 2015
+// Last Modified: Sun Oct 18 23:20:41 PDT 2026
 // Filename:      HumdrumFileStructure.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileStructure.cpp
 // Syntax:        C++11; humlib
@@ -197,15 +197,16 @@ bool HumdrumFileStructure::readStringCsv(const string& contents,
 //
 
 bool HumdrumFileStructure::analyzeStructure(void) {
-	m_analyses.m_structure_analyzed = false;
-	if (!m_analyses.m_strands_analyzed) {
+	// Reanalyzing the structure invalidates all content analyses:
+	m_analyses.invalidate(HumFileAnalysis::PASS_STRUCTURE);
+	if (!m_analyses.isDone(HumFileAnalysis::PASS_STRANDS)) {
 		if (!analyzeStrands()       ) { return isValid(); }
 	}
 	if (!analyzeGlobalParameters() ) { return isValid(); }
 	if (!analyzeLocalParameters()  ) { return isValid(); }
 	if (!analyzeTokenDurations()   ) { return isValid(); }
 	if (!analyzeTokenDurations()   ) { return isValid(); }
-	m_analyses.m_structure_analyzed = true;
+	m_analyses.setDone(HumFileAnalysis::PASS_STRUCTURE);
 	if (!analyzeRhythmStructure()  ) { return isValid(); }
 	analyzeSignifiers();
 	return isValid();
@@ -220,8 +221,8 @@ bool HumdrumFileStructure::analyzeStructure(void) {
 //
 
 bool HumdrumFileStructure::analyzeStructureNoRhythm(void) {
-	m_analyses.m_structure_analyzed = true;
-	if (!m_analyses.m_strands_analyzed) {
+	m_analyses.setDone(HumFileAnalysis::PASS_STRUCTURE);
+	if (!m_analyses.isDone(HumFileAnalysis::PASS_STRANDS)) {
 		if (!analyzeStrands()          ) { return isValid(); }
 	}
 	if (!analyzeGlobalParameters() ) { return isValid(); }
@@ -239,7 +240,7 @@ bool HumdrumFileStructure::analyzeStructureNoRhythm(void) {
 //
 
 bool HumdrumFileStructure::analyzeRhythmStructure(void) {
-	m_analyses.m_rhythm_analyzed = true;
+	m_analyses.setDone(HumFileAnalysis::PASS_RHYTHM);
 	setLineRhythmAnalyzed();
 	if (!isStructureAnalyzed()) {
 		if (!analyzeStructureNoRhythm()) { return isValid(); }
@@ -1292,7 +1293,7 @@ void HumdrumFileStructure::assignLineDurations(void) {
 bool HumdrumFileStructure::assignDurationsToNonRhythmicTrack(
 		HTp endtoken, HTp current) {
 
-	string spineinfo = endtoken->getSpineInfo();
+	const string& spineinfo = endtoken->getSpineInfo();
 	HTp token = endtoken;
 
 	while (token) {
@@ -1459,7 +1460,7 @@ void HumdrumFileStructure::checkForLocalParameters(HTp token,
 //
 
 bool HumdrumFileStructure::analyzeStrands(void) {
-	m_analyses.m_strands_analyzed = true;
+	m_analyses.setDone(HumFileAnalysis::PASS_STRANDS);
 	int spines = getSpineCount();
 	m_strand1d.clear();
 	m_strand2d.clear();
@@ -1497,10 +1498,10 @@ bool HumdrumFileStructure::analyzeStrands(void) {
 //
 
 void HumdrumFileStructure::resolveNullTokens(void) {
-	if (m_analyses.m_nulls_analyzed) {
+	if (m_analyses.isDone(HumFileAnalysis::PASS_NULLS)) {
 		return;
 	}
-	m_analyses.m_nulls_analyzed = true;
+	m_analyses.setDone(HumFileAnalysis::PASS_NULLS);
 	if (!areStrandsAnalyzed()) {
 		analyzeStrands();
 	}
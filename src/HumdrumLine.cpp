@@ -1552,13 +1552,12 @@ bool HumdrumLine::analyzeTracks(string& err) {
 		return !err.size();
 	}
 
-	string info;
 	int track;
 	int maxtrack = 0;
 	int i, j, k;
 
 	for (i=0; i<(int)m_tokens.size(); i++) {
-		info = m_tokens[i]->getSpineInfo();
+		const string& info = m_tokens[i]->getSpineInfo();
 		track = 0;
 		for (j=0; j<(int)info.size(); j++) {
 			if (!isdigit(info[j])) {
@@ -2462,12 +2461,13 @@ int HumdrumLine::isExpansionList(int startTrack, int stopTrack) {
 //
 
 ostream& operator<<(ostream& out, HumdrumLine& line) {
-	out << (string)line;
+	// print through a reference so that the line is not copied:
+	out << static_cast<const string&>(line);
 	return out;
 }
 
 ostream& operator<< (ostream& out, HLp line) {
-	out << (string)(*line);
+	out << static_cast<const string&>(*line);
 	return out;
 }
 
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
-// Last Modified: Sun Aug  9 21:03:12 PDT 2015
+// Last Modified: Sun Oct 18 23:48:30 PDT 2026
 // Filename:      HumdrumToken.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumToken.cpp
 // Syntax:        C++11; humlib
@@ -361,6 +361,10 @@ HumNum HumdrumToken::getSlurDuration(HumNum scale) {
 	if (!isDataTypeLike("**kern")) {
 		return 0;
 	}
+	HumSpanTable* slurs = getSlurTable();
+	if (slurs) {
+		return slurs->getDuration(getSlurTableId());
+	}
 	if (isDefined("auto", "slurDuration")) {
 		return getValueFraction("auto", "slurDuration");
 	} else if (isDefined("auto", "slurEnd")) {
@@ -533,6 +537,11 @@ void HumdrumToken::setSpineInfo(const string& spineinfo) {
 }
 
 
+void HumdrumToken::setSpineInfo(const std::shared_ptr<const string>& spineinfo) {
+	m_address.setSpineInfo(spineinfo);
+}
+
+
 
 //////////////////////////////
 //
@@ -541,7 +550,7 @@ void HumdrumToken::setSpineInfo(const string& spineinfo) {
 // @SEEALTO: setSpineInfo
 //
 
-string HumdrumToken::getSpineInfo(void) const {
+const string& HumdrumToken::getSpineInfo(void) const {
 	return m_address.getSpineInfo();
 }
 
@@ -773,7 +782,7 @@ HTp HumdrumToken::getNextToken(int index) const {
 //
 
 vector<HumdrumToken*> HumdrumToken::getNextTokens(void) const {
-	return m_nextTokens;
+	return m_nextTokens.toVector();
 }
 
 
@@ -785,7 +794,7 @@ vector<HumdrumToken*> HumdrumToken::getNextTokens(void) const {
 //
 
 vector<HumdrumToken*> HumdrumToken::getPreviousTokens(void) const {
-	return m_previousTokens;
+	return m_previousTokens.toVector();
 }
 
 
@@ -2051,20 +2060,19 @@ int HumdrumToken::hasVisibleAccidental(int subtokenIndex) const {
 		return -1;
 	}
 	if (isKern()) {
-		if (!humfile->getValueBool("auto", "accidentalAnalysis**kern")) {
-			int status = humfile->analyzeKernAccidentals();
-			if (!status) {
-				return -1;
-			}
+		if (!humfile->requireAnalysis(HumFileAnalysis::PASS_KERN_ACCIDENTALS)) {
+			return -1;
 		}
 	} else if (isMens()) {
-		if (!humfile->getValueBool("auto", "accidentalAnalysis**mens")) {
-			int status = humfile->analyzeMensAccidentals();
-			if (!status) {
-				return -1;
-			}
+		if (!humfile->requireAnalysis(HumFileAnalysis::PASS_MENS_ACCIDENTALS)) {
+			return -1;
 		}
 	}
+	HumAnalysisTables& tables = humfile->getAnalysisTables();
+	int flags = tables.getAccidentalFlags(tables.getTokenId((HTp)this), subtokenIndex);
+	if (flags >= 0) {
+		return (flags & HumAnalysisTables::ACCID_VISUAL) ? 1 : 0;
+	}
 	return getValueBool("auto", to_string(subtokenIndex), "visualAccidental");
 }
 
@@ -2072,8 +2080,8 @@ int HumdrumToken::hasVisibleAccidental(int subtokenIndex) const {
 
 //////////////////////////////
 //
-// HumdrumToken::hasVisibleAccidental -- Returns true if the accidental
-//    of a **kern note is viewable if rendered to graphical notation.
+// HumdrumToken::hasCautionaryAccidental -- Returns true if the accidental
+//    of a **kern note is a cautionary accidental.
 // 	return values:
 //      0  = false;
 //      1  = true;
@@ -2090,20 +2098,19 @@ int HumdrumToken::hasCautionaryAccidental(int subtokenIndex) const {
 		return -1;
 	}
 	if (isKern()) {
-		if (!humfile->getValueBool("auto", "accidentalAnalysis**kern")) {
-			int status = humfile->analyzeKernAccidentals();
-			if (!status) {
-				return -1;
-			}
+		if (!humfile->requireAnalysis(HumFileAnalysis::PASS_KERN_ACCIDENTALS)) {
+			return -1;
 		}
 	} else if (isMens()) {
-		if (!humfile->getValueBool("auto", "accidentalAnalysis**mens")) {
-			int status = humfile->analyzeMensAccidentals();
-			if (!status) {
-				return -1;
-			}
+		if (!humfile->requireAnalysis(HumFileAnalysis::PASS_MENS_ACCIDENTALS)) {
+			return -1;
 		}
 	}
+	HumAnalysisTables& tables = humfile->getAnalysisTables();
+	int flags = tables.getAccidentalFlags(tables.getTokenId((HTp)this), subtokenIndex);
+	if (flags >= 0) {
+		return (flags & HumAnalysisTables::ACCID_CAUTIONARY) ? 1 : 0;
+	}
 	return getValueBool("auto", to_string(subtokenIndex), "cautionaryAccidental");
 }
 
@@ -3934,12 +3941,16 @@ ostream& printSequence(vector<HTp>& sequence, ostream& out) {
 //////////////////////////////
 //
 // HumdrumToken::getSlurStartToken -- Return a pointer to the token
-//     which starts the given slur.  Returns NULL if no start.  Assumes that
-//     HumdrumFileContent::analyzeKernSlurs() has already been run.
+//     which starts the given slur.  Returns NULL if no start.  The slur
+//     analysis of the file is run if it has not been done yet.
 //				<parameter key="slurEnd" value="HT_140366146702320" idref=""/>
 //
 
 HTp HumdrumToken::getSlurStartToken(int number) {
+	HumSpanTable* slurs = getSlurTable();
+	if (slurs) {
+		return slurs->getStartToken(getSlurTableId(), number);
+	}
 	string tag = "slurStartId";
 	if (number > 1) {
 		tag += to_string(number);
@@ -3956,6 +3967,10 @@ HTp HumdrumToken::getSlurStartToken(int number) {
 //
 
 int HumdrumToken::getSlurStartNumber(int endnumber) {
+	HumSpanTable* slurs = getSlurTable();
+	if (slurs) {
+		return slurs->getStartNumber(getSlurTableId(), endnumber);
+	}
 	string tag = "slurStartNumber";
 	if (endnumber > 1) {
 		tag += to_string(endnumber);
@@ -3969,12 +3984,16 @@ int HumdrumToken::getSlurStartNumber(int endnumber) {
 //////////////////////////////
 //
 // HumdrumToken::getSlurEndToken -- Return a pointer to the token
-//     which ends the given slur.  Returns NULL if no end.  Assumes that
-//     HumdrumFileContent::analyzeKernSlurs() has already been run.
+//     which ends the given slur.  Returns NULL if no end.  The slur
+//     analysis of the file is run if it has not been done yet.
 //				<parameter key="slurStart" value="HT_140366146702320" idref=""/>
 //
 
 HTp HumdrumToken::getSlurEndToken(int number) {
+	HumSpanTable* slurs = getSlurTable();
+	if (slurs) {
+		return slurs->getEndToken(getSlurTableId(), number);
+	}
 	string tag = "slurEnd";
 	if (number > 1) {
 		tag += to_string(number);
@@ -3985,15 +4004,69 @@ HTp HumdrumToken::getSlurEndToken(int number) {
 
 
 
+//////////////////////////////
+//
+// HumdrumToken::getSlurTable -- Return the slur analysis table of the
+//     file containing the token (running the slur analysis if it has not
+//     been done yet), or NULL if the token is not in a file or not in the
+//     table (in which case the "auto" HumHash parameters of the token should
+//     be used instead).
+//
+
+HumSpanTable* HumdrumToken::getSlurTable(void) {
+	HLp owner = getOwner();
+	if (!owner) {
+		return NULL;
+	}
+	HumdrumFile* infile = owner->getOwner();
+	if (!infile) {
+		return NULL;
+	}
+	if (!infile->requireAnalysis(HumFileAnalysis::PASS_SLURS)) {
+		return NULL;
+	}
+	HumAnalysisTables& tables = infile->getAnalysisTables();
+	if (tables.getTokenId(this) < 0) {
+		return NULL;
+	}
+	return &tables.getSlurs();
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumToken::getSlurTableId -- Return the index of the token in the
+//     analysis tables of its file.
+//
+
+int HumdrumToken::getSlurTableId(void) {
+	HLp owner = getOwner();
+	if (!owner) {
+		return -1;
+	}
+	HumdrumFile* infile = owner->getOwner();
+	if (!infile) {
+		return -1;
+	}
+	return infile->getAnalysisTables().getTokenId(this);
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumToken::getPhraseStartToken -- Return a pointer to the token
-//     which starts the given phrase.  Returns NULL if no start.  Assumes that
-//     HumdrumFileContent::analyzeKernPhrasings() has already been run.
+//     which starts the given phrase.  Returns NULL if no start.  The phrase
+//     analysis of the file is run if it has not been done yet.
 //				<parameter key="phraseEnd" value="HT_140366146702320" idref=""/>
 //
 
 HTp HumdrumToken::getPhraseStartToken(int number) {
+	HumSpanTable* phrases = getPhraseTable();
+	if (phrases) {
+		return phrases->getStartToken(getSlurTableId(), number);
+	}
 	string tag = "phraseStart";
 	if (number > 1) {
 		tag += to_string(number);
@@ -4006,12 +4079,16 @@ HTp HumdrumToken::getPhraseStartToken(int number) {
 //////////////////////////////
 //
 // HumdrumToken::getPhraseEndToken -- Return a pointer to the token
-//     which ends the given phrase.  Returns NULL if no end.  Assumes that
-//     HumdrumFileContent::analyzeKernPhrasings() has already been run.
+//     which ends the given phrase.  Returns NULL if no end.  The phrase
+//     analysis of the file is run if it has not been done yet.
 //				<parameter key="phraseStart" value="HT_140366146702320" idref=""/>
 //
 
 HTp HumdrumToken::getPhraseEndToken(int number) {
+	HumSpanTable* phrases = getPhraseTable();
+	if (phrases) {
+		return phrases->getEndToken(getSlurTableId(), number);
+	}
 	string tag = "phraseEnd";
 	if (number > 1) {
 		tag += to_string(number);
@@ -4021,6 +4098,35 @@ HTp HumdrumToken::getPhraseEndToken(int number) {
 
 
 
+//////////////////////////////
+//
+// HumdrumToken::getPhraseTable -- Return the phrase analysis table of the
+//     file containing the token (running the phrase analysis if it has
+//     not been done yet), or NULL if the token is not in a file or not in
+//     the table.
+//
+
+HumSpanTable* HumdrumToken::getPhraseTable(void) {
+	HLp owner = getOwner();
+	if (!owner) {
+		return NULL;
+	}
+	HumdrumFile* infile = owner->getOwner();
+	if (!infile) {
+		return NULL;
+	}
+	if (!infile->requireAnalysis(HumFileAnalysis::PASS_PHRASES)) {
+		return NULL;
+	}
+	HumAnalysisTables& tables = infile->getAnalysisTables();
+	if (tables.getTokenId(this) < 0) {
+		return NULL;
+	}
+	return &tables.getPhrases();
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumToken::resolveNull --
@@ -171,7 +171,9 @@ char& MuseRecordBasic::getColumn(int columnNumber) {
 		cerr << "Error trying to access column: " << columnNumber  << endl;
 		cerr << "CURRENT DATA: ===============================" << endl;
 		cerr << (*this);
-		static char x = ' ';
+		// dummy column (one per thread, since callers may write to it):
+		static thread_local char x;
+		x = ' ';
 		return x;
 	} else if (realindex >= (int)m_recordString.size()) {
 		m_recordString.resize(realindex+1);
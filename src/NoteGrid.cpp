@@ -174,6 +174,8 @@ bool NoteGrid::load(HumdrumFile& infile) {
 		if (current.size() != kernspines.size()) {
 			cerr << "Error: Unequal vector sizes " << current.size()
 			     << " compared to " << kernspines.size() << endl;
+			// don't leave a partially filled grid:
+			clear();
 			return false;
 		}
 		for (int j=0; j<(int)current.size(); j++) {
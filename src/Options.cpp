@@ -3,6 +3,7 @@
 // Creation Date: Sun Apr  5 13:07:18 PDT 1998
 // Last Modified: Sat Mar  1 09:31:01 PST 2014 Implemented with STL.
 // Last Modified: Thu Dec 15 09:06:52 PST 2016 Adjusted internal storage.
+// Last Modified: Sun Oct 18 17:20:04 PDT 2026 Added setExitOnError().
 // Filename:      Options.cpp
 // Web Address:   https://github.com/craigsapp/humlib/blob/master/include/Options.h
 // vim:           syntax=cpp ts=3 noexpandtab nowrap
@@ -321,6 +322,7 @@ Options::Options(const Options& options) {
 	m_processedQ = options.m_processedQ;
 	m_suppressQ = options.m_suppressQ;
 	m_optionsArgQ = options.m_optionsArgQ;
+	m_exitQ = options.m_exitQ;
 	for (int i=0; i<(int)options.m_optionRegister.size(); i++) {
 		Option_register* orr = new Option_register(*options.m_optionRegister[i]);
 		m_optionRegister.push_back(orr);
@@ -358,6 +360,7 @@ Options& Options::operator=(const Options& options) {
 	m_processedQ = options.m_processedQ;
 	m_suppressQ = options.m_suppressQ;
 	m_optionsArgQ = options.m_optionsArgQ;
+	m_exitQ = options.m_exitQ;
 
 	for (int i=0; i<(int)m_optionRegister.size(); i++) {
 		delete m_optionRegister[i];
@@ -846,6 +849,19 @@ void Options::reset(void) {
 
 
 
+//////////////////////////////
+//
+// Options::setExitOnError -- Set to false to store an unknown-option error
+//     in the parse errors (see hasParseError()) rather than exiting the
+//     program.  The --options option is also ignored in that case.
+//
+
+void Options::setExitOnError(bool state) {
+	m_exitQ = state;
+}
+
+
+
 //////////////////////////////
 //
 // Options::getFlag -- Set the character which is usually set to a dash.
@@ -1167,8 +1183,10 @@ int Options::getRegIndex(const string& optionName) {
 
 	if (optionName == "options") {
 		#ifndef __EMSCRIPTEN__
-		print(cout);
-		exit(0);
+		if (m_exitQ) {
+			print(cout);
+			exit(0);
+		}
 		#endif
 		return -1;
 	}
@@ -1177,6 +1195,9 @@ int Options::getRegIndex(const string& optionName) {
 	if (it == m_optionList.end()) {
 		if (m_options_error_checkQ) {
 			m_error << "Error: unknown option \"" << optionName << "\"." << endl;
+			if (!m_exitQ) {
+				return -1;
+			}
 			#ifndef __EMSCRIPTEN__
 				cerr << "Error: unknown option \"" << optionName << "\"." << endl;
 			#endif
@@ -18,6 +18,8 @@
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <string>
+#include <vector>
 
 using namespace std;
 
@@ -538,23 +540,25 @@ PixelColor PixelColor::getColor(const string& colorstring) {
 	// check for decimal strings with spaces around numbers: "255 255 255"
 	if ((colorstring.find(' ') != string::npos) ||
 		 (colorstring.find('\t') != string::npos)) {
-		char buffer[256] = {0};
-		strcpy(buffer, colorstring.c_str());
-		char* ptr = strtok(buffer, " \t\n:;");
+		const char* separators = " \t\n:;";
+		vector<string> values;
+		size_t start = colorstring.find_first_not_of(separators);
+		while ((start != string::npos) && (values.size() < 3)) {
+			size_t end = colorstring.find_first_of(separators, start);
+			values.push_back(colorstring.substr(start, end - start));
+			start = colorstring.find_first_not_of(separators, end);
+		}
 		int tred   = -1;
 		int tgreen = -1;
 		int tblue  = -1;
-		if (ptr != NULL) {
-			sscanf(ptr, "%d", &tred);
-			ptr = strtok(NULL, " \t\n;:");
+		if (values.size() > 0) {
+			sscanf(values[0].c_str(), "%d", &tred);
 		}
-		if (ptr != NULL) {
-			sscanf(ptr, "%d", &tgreen);
-			ptr = strtok(NULL, " \t\n;:");
+		if (values.size() > 1) {
+			sscanf(values[1].c_str(), "%d", &tgreen);
 		}
-		if (ptr != NULL) {
-			sscanf(ptr, "%d", &tblue);
-			ptr = strtok(NULL, " \t\n;:");
+		if (values.size() > 2) {
+			sscanf(values[2].c_str(), "%d", &tblue);
 		}
 		if (tred > 0 && tgreen > 0 && tblue > 0) {
 			output.setColor(tred, tgreen, tblue);
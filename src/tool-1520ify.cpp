@@ -917,17 +917,7 @@ void Tool_1520ify::clearStates(void) {
 //
 
 string Tool_1520ify::getDate(void) {
-	auto now = std::chrono::system_clock::now();
-	std::time_t now_time = std::chrono::system_clock::to_time_t(now);
-	std::tm* local_time = std::localtime(&now_time);
-	int year = local_time->tm_year + 1900;
-	int month = local_time->tm_mon + 1; 
-	int day = local_time->tm_mday;
-	stringstream ss;
-	ss << year << "/";
-	ss << std::setw(2) << std::setfill('0') << month << "/";
-	ss << std::setw(2) << std::setfill('0') << day;
-	return ss.str();
+	return Convert::getCurrentDate();
 }
 
 
@@ -938,11 +928,7 @@ string Tool_1520ify::getDate(void) {
 //
 
 int Tool_1520ify::getYear(void) {
-	auto now = std::chrono::system_clock::now();
-	std::time_t now_time = std::chrono::system_clock::to_time_t(now);
-	std::tm* local_time = std::localtime(&now_time);
-	int year = local_time->tm_year + 1900;
-	return year;
+	return stoi(Convert::getCurrentDate("%Y"));
 }
 
 
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Tue Sep 26 04:27:04 PDT 2023
-// Last Modified: Tue Sep 26 21:48:51 PDT 2023
+// Last Modified: Sun Oct 18 21:54:30 PDT 2026
 // Filename:      tool-addic.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-addic.cpp
 // Syntax:        C++11; humlib
@@ -82,7 +82,6 @@ bool Tool_addic::run(HumdrumFile& infile) {
 //
 
 void Tool_addic::initialize(void) {
-	m_instrumentList = Convert::getInstrumentList();
 	m_fixQ = getBoolean("fix");
 }
 
@@ -286,18 +285,10 @@ string Tool_addic::getInstrumentClass(const string& code) {
 		code2   = hre.getMatch(3);
 	}
 
-	string class1 = "";
+	string class1 = Convert::getInstrumentClass(code1);
 	string class2 = "";
-
-	for (int i=0; i<(int)m_instrumentList.size(); i++) {
-		if (code1 == m_instrumentList[i].first) {
-			class1 = m_instrumentList[i].second;
-		}
-		if (count == 2) {
-			if (code2 == m_instrumentList[i].first) {
-				class2 = m_instrumentList[i].second;
-			}
-		}
+	if (count == 2) {
+		class2 = Convert::getInstrumentClass(code2);
 	}
 
 	if (count == 1) {
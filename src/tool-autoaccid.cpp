@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Thu Jan 30 22:26:33 PST 2020
-// Last Modified: Thu Jan 30 22:26:35 PST 2020
+// Last Modified: Sun Oct 18 12:24:35 PDT 2026
 // Filename:      tool-autoaccid.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-autoaccid.cpp
 // Syntax:        C++11; humlib
@@ -163,14 +163,9 @@ void Tool_autoaccid::addAccidentalQualifications(HumdrumFile& infile) {
 void Tool_autoaccid::addAccidentalInfo(HTp token) {
 	vector<string> subtokens;
 	subtokens = token->getSubtokens();
-	if (subtokens.size() == 1) {
-		bool visual = token->getValueBool("auto", "0", "visualAccidental");
-		subtokens[0] = setVisualState(subtokens[0], visual);
-	} else {
-		for (int i=0; i<(int)subtokens.size(); i++) {
-			bool visual = token->getValueBool("auto", to_string(i+1), "visualAccidental");
-			subtokens[i] = setVisualState(subtokens[i], visual);
-		}
+	for (int i=0; i<(int)subtokens.size(); i++) {
+		bool visual = token->hasVisibleAccidental(i) > 0;
+		subtokens[i] = setVisualState(subtokens[i], visual);
 	}
 	string text;
 	for (int i=0; i<(int)subtokens.size(); i++) {
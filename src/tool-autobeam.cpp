@@ -2,6 +2,7 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Wed Nov 30 01:02:57 PST 2016
 // Last Modified: Sun May 21 21:11:12 CEST 2017 Ignore non-kern spines when adding beams
+// Last Modified: Sun Oct 18 23:58:40 PDT 2026 Reset analysis data for each file
 // Filename:      tool-autobeam.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-autobeam.cpp
 // Syntax:        C++11; humlib
@@ -836,13 +837,15 @@ void Tool_autobeam::addBeams(HumdrumFile& infile) {
 //////////////////////////////
 //
 // Tool_autobeam::initialize -- extract time signature lines for
-//    each **kern spine in file.
+//    each **kern spine in file.  All analysis data is reset so that
+//    the tool can be run again on another file.
 //
 
 void Tool_autobeam::initialize(HumdrumFile& infile) {
 	m_splitcount = 0;
 	m_kernspines = infile.getKernLikeSpineStartList();
 	vector<HTp>& ks = m_kernspines;
+	m_timesigs.clear();
 	m_timesigs.resize(infile.getTrackCount() + 1);
 	for (int i=0; i<(int)ks.size(); i++) {
 		infile.getTimeSigs(m_timesigs[ks[i]->getTrack()], ks[i]->getTrack());
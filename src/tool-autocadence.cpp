@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Feb 16 13:22:15 PST 2025
-// Last Modified: Sun Mar  2 11:57:59 PST 2025
+// Last Modified: Sun Oct 18 23:59:59 PDT 2026
 // Filename:      tool-autocadence.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-autocadence.cpp
 // Syntax:        C++11; humlib
@@ -567,8 +567,8 @@ void Tool_autocadence::addMatchToScore(HumdrumFile& infile, int matchIndex) {
 	int nindex = coord.at(2);
 	auto& info = m_sequences.at(vindex).at(pindex).at(nindex);
 	// get<0> is the sequence string.
-	HTp startL = get<1>(info);  // starting token of cadence formula, lower voice
-	HTp startU = get<2>(info);  // starting token of cadence formula, upper voice
+	HTp startL = std::get<1>(info);  // starting token of cadence formula, lower voice
+	HTp startU = std::get<2>(info);  // starting token of cadence formula, upper voice
 	if (startL == NULL) {
 		cerr << "WARNING: startL is NULL" << endl;
 		return;
@@ -578,7 +578,7 @@ void Tool_autocadence::addMatchToScore(HumdrumFile& infile, int matchIndex) {
 		return;
 	}
 	int lindex = startL->getLineIndex();
-	vector<int>& dindexes = get<3>(info);
+	vector<int>& dindexes = std::get<3>(info);
 	if (dindexes.empty()) {
 		cerr << "WARNING: dindexes is empty" << endl;
 		return;
@@ -712,7 +712,7 @@ bool Tool_autocadence::getCadenceEndSliceNotes(HTp& endL, HTp& endU, int count,
 			lineIndex++;
 			continue;
 		}
-		string& interval = get<0>(m_intervals.at(lineIndex).at(vindex).at(pindex));
+		string& interval = std::get<0>(m_intervals.at(lineIndex).at(vindex).at(pindex));
 		if (!interval.empty()) {
 			counter++;
 			if (counter == count) {
@@ -813,7 +813,7 @@ void Tool_autocadence::printMatchCount(void) {
 	int subcount = 0;
 	for (int i=0; i<(int)m_matches.size(); i++) {
 		auto& info = m_sequences.at(m_matches[i][0]).at(m_matches[i][1]).at(m_matches[i][2]);
-		vector<int>& matches = get<3>(info);
+		vector<int>& matches = std::get<3>(info);
 		subcount += (int)matches.size() - 1;
 	}
 
@@ -848,10 +848,10 @@ void Tool_autocadence::searchIntervalSequences(void) {
 	for (int i=0; i<(int)m_sequences.size(); i++) {
 		for (int j=0; j<(int)m_sequences[i].size(); j++) {
 			for (int k=0; k<(int)m_sequences[i][j].size(); k++) {
-				string& feature = get<0>(m_sequences.at(i).at(j).at(k));
+				string& feature = std::get<0>(m_sequences.at(i).at(j).at(k));
 				for (int m=0; m<(int)m_definitions.size(); m++) {
 					if (hre.search(feature, m_definitions.at(m).m_regex)) {
-						vector<int>& matches = get<3>(m_sequences.at(i).at(j).at(k));
+						vector<int>& matches = std::get<3>(m_sequences.at(i).at(j).at(k));
 						// cerr << "FOUND MATCH: " << m << endl;
 						matches.push_back(m);
 						m_matches.emplace_back(vector<int>{i, j, k});
@@ -879,7 +879,7 @@ void Tool_autocadence::prepareDefinitionList(set<int>& list) {
 		int& pindex = m_matches.at(i).at(1);
 		int& nindex = m_matches.at(i).at(2);
 		auto& info  = m_sequences.at(vindex).at(pindex).at(nindex);
-		vector<int>& matches = get<3>(info);
+		vector<int>& matches = std::get<3>(info);
 		for (int m=0; m<(int)matches.size(); m++) {
 			int dindex = matches.at(m);
 			list.insert(dindex);
@@ -919,7 +919,7 @@ void Tool_autocadence::printSequenceMatches(void) {
 		int& pindex = m_matches.at(i).at(1);
 		int& nindex = m_matches.at(i).at(2);
 		auto& info = m_sequences.at(vindex).at(pindex).at(nindex);
-		vector<int>& matches = get<3>(info);
+		vector<int>& matches = std::get<3>(info);
 		if (matches.empty()) {
 			continue;
 		}
@@ -940,7 +940,7 @@ void Tool_autocadence::printSequenceMatches(void) {
 			}
 		}
 		m_humdrum_text << "\t";
-		string& sequence = get<0>(info);
+		string& sequence = std::get<0>(info);
 		m_humdrum_text << sequence << endl;
 	}
 }
@@ -956,8 +956,8 @@ void Tool_autocadence::printSequenceMatches2(void) {
 			}
 			m_humdrum_text << "# Matches for voices " << (i+1) << " TO " << (i+1+j+1) << endl;
 			for (int k=0; k<(int)m_sequences.at(i).at(j).size(); k++) {
-				string& sequence = get<0>(m_sequences.at(i).at(j).at(k));
-				vector<int>& matches = get<3>(m_sequences.at(i).at(j).at(k));
+				string& sequence = std::get<0>(m_sequences.at(i).at(j).at(k));
+				vector<int>& matches = std::get<3>(m_sequences.at(i).at(j).at(k));
 				if (matches.empty()) {
 					continue;
 				}
@@ -1006,7 +1006,7 @@ void Tool_autocadence::printSequenceInfo(void) {
 			m_humdrum_text << endl;
 			m_humdrum_text << "# Sequences for voices " << (i+1) << " TO " << (i+1+j+1) << endl;
 			for (int k=0; k<(int)m_sequences[i][j].size(); k++) {
-				string& sequence = get<0>(m_sequences[i][j][k]);
+				string& sequence = std::get<0>(m_sequences[i][j][k]);
 				m_humdrum_text << sequence << endl;
 			}
 		}
@@ -1076,12 +1076,12 @@ void Tool_autocadence::prepareSinglePairSequences(HumdrumFile& infile, int vinde
 		if (!infile[i].isData()) {
 			continue;
 		}
-		string interval = get<0>(m_intervals.at(i).at(vindex).at(pindex));
+		string interval = std::get<0>(m_intervals.at(i).at(vindex).at(pindex));
 		if (interval.empty()) {
 			continue;
 		}
-		HTp lower = get<1>(m_intervals.at(i).at(vindex).at(pindex));
-		HTp upper = get<2>(m_intervals.at(i).at(vindex).at(pindex));
+		HTp lower = std::get<1>(m_intervals.at(i).at(vindex).at(pindex));
+		HTp upper = std::get<2>(m_intervals.at(i).at(vindex).at(pindex));
 		string sequence = generateSequenceString(infile, i, vindex, pindex);
 // cerr << "ADDING SEQUENCE: " << sequence << endl;
 		m_sequences.at(vindex).at(pindex).emplace_back(sequence, lower, upper, vector<int>{});
@@ -1109,7 +1109,7 @@ void Tool_autocadence::prepareSinglePairSequences(HumdrumFile& infile, int vinde
 string Tool_autocadence::generateSequenceString(HumdrumFile& infile, int lindex, int vindex, int pindex) {
 	vector<string> pieces;
 	for (int i=lindex; i<infile.getLineCount(); i++) {
-		string interval = get<0>(m_intervals.at(i).at(vindex).at(pindex));
+		string interval = std::get<0>(m_intervals.at(i).at(vindex).at(pindex));
 		if (interval.empty()) {
 			continue;
 		}
@@ -1315,7 +1315,7 @@ void Tool_autocadence::printIntervalDataLine(HumdrumFile& infile, int index, int
 			int vindex = m_trackToVoiceIndex.at(track);
 			int tcount = kcount - vindex - 1;
 			for (int j=0; j<tcount; j++) {
-				string value = get<0>(m_intervals.at(index).at(vindex).at(j));
+				string value = std::get<0>(m_intervals.at(index).at(vindex).at(j));
 				if (value == "") {
 					value = ".";
 				}
@@ -1366,7 +1366,7 @@ void Tool_autocadence::printIntervalDataLineScore(HumdrumFile& infile, int index
 			int vindex = m_trackToVoiceIndex.at(track);
 			int tcount = kcount - vindex - 1;
 			for (int j=0; j<tcount; j++) {
-				string value = get<0>(m_intervals.at(index).at(vindex).at(j));
+				string value = std::get<0>(m_intervals.at(index).at(vindex).at(j));
 				if (value == "") {
 					value = ".";
 				}
@@ -1536,8 +1536,8 @@ void Tool_autocadence::prepareIntervalInfo(HumdrumFile& infile) {
 			int pcount = vcount - j - 1;
 			m_intervals[i][j].resize(pcount);
 			for (int k=0; k<pcount; k++) {
-				get<1>(m_intervals[i][j][k]) = NULL;
-				get<2>(m_intervals[i][j][k]) = NULL;
+				std::get<1>(m_intervals[i][j][k]) = NULL;
+				std::get<2>(m_intervals[i][j][k]) = NULL;
 			}
 		}
 	}
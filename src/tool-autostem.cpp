@@ -2,6 +2,7 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Dec 26 03:28:25 PST 2010
 // Last Modified: Sun Dec  4 16:15:36 PST 2016 Ported from humextras
+// Last Modified: Sun Oct 18 22:35:02 PDT 2026 Report beam errors without exiting
 // Filename:      tool-autostem.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-autostem.cpp
 // Syntax:        C++11; humlib
@@ -745,7 +746,7 @@ void Tool_autostem::getNotePositions(vector<vector<vector<int> > >& notepos,
 
 void Tool_autostem::processKernTokenStems(HumdrumFile& infile,
 		vector<vector<int> >& baseline, int row, int col) {
-	exit(1);
+	// not implemented: see processKernTokenStemsSimpleModel().
 }
 
 
@@ -1166,8 +1167,8 @@ bool Tool_autostem::getBeamState(vector<vector<string > >& beams,
 				// grace notes;
 				countBeamStuff(infile.token(i, j)->c_str(), start, stop, flagr, flagl);
 				if ((start != 0) && (stop != 0)) {
-					cerr << "Funny error in grace note beam calculation" << endl;
-					exit(1);
+					m_error_text << "Funny error in grace note beam calculation" << endl;
+					return false;
 				}
 				if (start > 7) {
 					cerr << "Too many beam starts" << endl;
@@ -1207,8 +1208,8 @@ bool Tool_autostem::getBeamState(vector<vector<string > >& beams,
 				}
 				len = (int)gbinfo.size();
 				if (len > 6) {
-					cerr << "Error too many grace note beams" << endl;
-					exit(1);
+					m_error_text << "Error too many grace note beams" << endl;
+					return false;
 				}
 				beams.at(i).at(j) = gbinfo;
 				gracestate.at(track).at(curlayer.at(track)) = contin;
@@ -1220,8 +1221,8 @@ bool Tool_autostem::getBeamState(vector<vector<string > >& beams,
 
 				countBeamStuff(infile.token(i, j)->c_str(), start, stop, flagr, flagl);
 				if ((start != 0) && (stop != 0)) {
-					cerr << "Funny error in note beam calculation" << endl;
-					exit(1);
+					m_error_text << "Funny error in note beam calculation" << endl;
+					return false;
 				}
 				if (start > 7) {
 					cerr << "Too many beam starts" << endl;
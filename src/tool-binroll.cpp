@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Mar  4 21:09:10 PST 2018
-// Last Modified: Sun Mar  4 21:09:13 PST 2018
+// Last Modified: Sun Oct 18 23:59:59 PDT 2026
 // Filename:      tool-binroll.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-binroll.cpp
 // Syntax:        C++11; humlib
@@ -21,6 +21,185 @@ namespace hum {
 // START_MERGE
 
 
+//////////////////////////////
+//
+// PackedRoll::PackedRoll --
+//
+
+PackedRoll::PackedRoll(void) {
+	setKeyRange(0, 127);
+}
+
+
+
+//////////////////////////////
+//
+// PackedRoll::setKeyRange -- Set the lowest and highest MIDI key numbers
+//     stored in the roll.  This also clears the roll.
+//
+
+void PackedRoll::setKeyRange(int low, int high) {
+	m_low   = low;
+	m_count = high - low + 1;
+	m_words = (m_count + 63) / 64;
+	clear();
+}
+
+
+
+//////////////////////////////
+//
+// PackedRoll::clear -- Remove all notes and start again at time step 0.
+//
+
+void PackedRoll::clear(void) {
+	m_first = 0;
+	m_bits.clear();
+}
+
+
+
+//////////////////////////////
+//
+// PackedRoll::addNote -- Mark an attack at the start step and sustain in
+//     the following steps before the end step.  An attack is not changed
+//     to a sustain by an overlapping note.  Steps which have already been
+//     removed are ignored.
+//
+
+void PackedRoll::addNote(int key, int64_t start, int64_t end) {
+	key -= m_low;
+	if ((key < 0) || (key >= m_count)) {
+		return;
+	}
+	extend(std::max(start + 1, end));
+	uint64_t mask = (uint64_t)1 << (key % 64);
+	int word = key / 64;
+	if (start >= m_first) {
+		getStep(start)[word] |= mask;
+	}
+	for (int64_t i=std::max(start + 1, m_first); i<end; i++) {
+		getStep(i)[m_words + word] |= mask;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// PackedRoll::getValue -- Return 2 for an attack, 1 for a sustain and 0
+//     if the key is not sounding.  Steps which are not stored are silent.
+//
+
+int PackedRoll::getValue(int64_t step, int key) const {
+	const uint64_t* bits = getStep(step);
+	key -= m_low;
+	if (!bits || (key < 0) || (key >= m_count)) {
+		return 0;
+	}
+	uint64_t mask = (uint64_t)1 << (key % 64);
+	if (bits[key / 64] & mask) {
+		return 2;
+	}
+	if (bits[m_words + key / 64] & mask) {
+		return 1;
+	}
+	return 0;
+}
+
+
+
+//////////////////////////////
+//
+// PackedRoll::writeStep -- Write the attack and sustain planes of a time
+//     step in the binary format described in tool-binroll.h.
+//
+
+void PackedRoll::writeStep(ostream& out, int64_t step) const {
+	const uint64_t* bits = getStep(step);
+	int bytes = (m_count + 7) / 8;
+	for (int plane=0; plane<2; plane++) {
+		for (int i=0; i<bytes; i++) {
+			char value = 0;
+			if (bits) {
+				value = (char)((bits[plane * m_words + i / 8] >> (8 * (i % 8))) & 0xff);
+			}
+			out.put(value);
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// PackedRoll::removeSteps -- Discard the time steps before the given step.
+//
+
+void PackedRoll::removeSteps(int64_t end) {
+	if (end <= m_first) {
+		return;
+	}
+	size_t count = (size_t)(end - m_first) * 2 * m_words;
+	if (count >= m_bits.size()) {
+		m_bits.clear();
+	} else {
+		m_bits.erase(m_bits.begin(), m_bits.begin() + count);
+	}
+	m_first = end;
+}
+
+
+
+//////////////////////////////
+//
+// PackedRoll::extend -- Make sure that the time steps before the given
+//     step are stored.
+//
+
+void PackedRoll::extend(int64_t end) {
+	if (end <= m_first) {
+		return;
+	}
+	size_t size = (size_t)(end - m_first) * 2 * m_words;
+	if (size > m_bits.size()) {
+		m_bits.resize(size, 0);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// PackedRoll::getStep -- Return the bit planes for a time step, or NULL
+//     if the step is not stored.
+//
+
+uint64_t* PackedRoll::getStep(int64_t step) {
+	if (step < m_first) {
+		return NULL;
+	}
+	size_t index = (size_t)(step - m_first) * 2 * m_words;
+	if (index >= m_bits.size()) {
+		return NULL;
+	}
+	return m_bits.data() + index;
+}
+
+
+const uint64_t* PackedRoll::getStep(int64_t step) const {
+	if (step < m_first) {
+		return NULL;
+	}
+	size_t index = (size_t)(step - m_first) * 2 * m_words;
+	if (index >= m_bits.size()) {
+		return NULL;
+	}
+	return m_bits.data() + index;
+}
+
+
+
 /////////////////////////////////
 //
 // Tool_binroll::Tool_binroll -- Set the recognized options for the tool.
@@ -29,6 +208,9 @@ namespace hum {
 Tool_binroll::Tool_binroll(void) {
 	// add options here
 	define("t|timebase=s:16", "timebase to do analysis at");
+	define("k|keys=s:0-127",  "range of MIDI key numbers to include");
+	define("b|binary=b",      "output bit-packed binary roll");
+	define("s|stream=b",      "print time steps as soon as they are complete");
 }
 
 
@@ -71,7 +253,9 @@ bool Tool_binroll::run(HumdrumFile& infile, ostream& out) {
 
 
 bool Tool_binroll::run(HumdrumFile& infile) {
-	m_duration.setValue(1, 4); // 16th note
+	if (!initialize()) {
+		return false;
+	}
 	processFile(infile);
 	return true;
 }
@@ -80,129 +264,93 @@ bool Tool_binroll::run(HumdrumFile& infile) {
 
 //////////////////////////////
 //
-// Tool_binroll::processFile --
+// Tool_binroll::initialize --
 //
 
-void Tool_binroll::processFile(HumdrumFile& infile) {
-	vector<vector<char>> output;
-	output.resize(128);
-	int count = (infile.getScoreDuration() / m_duration).getInteger() + 1;
-	for (int i=0; i<(int)output.size(); i++) {
-		output[i].resize(count);
-		std::fill(output[i].begin(), output[i].end(), 0);
-	}
+bool Tool_binroll::initialize(void) {
+	m_binaryQ = getBoolean("binary");
+	m_streamQ = getBoolean("stream");
 
-	int strandcount = infile.getStrandCount();
-	for (int i=0; i<strandcount; i++) {
-		HTp starting = infile.getStrandStart(i);
-		if (!starting->isKern()) {
-			continue;
-		}
-		HTp ending = infile.getStrandEnd(i);
-		processStrand(output, starting, ending);
+	m_duration = Convert::recipToDuration(getString("timebase"));
+	if (m_duration <= 0) {
+		m_duration.setValue(1, 4); // 16th note
 	}
 
-	printAnalysis(infile, output);
-
+	HumRegex hre;
+	int low = 0;
+	int high = 127;
+	if (hre.search(getString("keys"), "^\\s*(\\d+)\\s*[-:]\\s*(\\d+)\\s*$")) {
+		low  = hre.getMatchInt(1);
+		high = hre.getMatchInt(2);
+	} else {
+		low = -1;
+	}
+	if ((low < 0) || (high > 127) || (low > high)) {
+		setError("Error: invalid key range " + getString("keys") + " (use for example 21-108)");
+		return false;
+	}
+	m_roll.setKeyRange(low, high);
+	return true;
 }
 
 
 
 //////////////////////////////
 //
-// Tool_binroll::printAnalysis --
+// Tool_binroll::processFile -- Fill in the roll line by line.  Since the
+//     lines are in time order, the time steps before the start of a line
+//     can no longer change, so in streaming mode they are printed (and
+//     removed from the roll) before the line is processed.
 //
 
-void Tool_binroll::printAnalysis(HumdrumFile& infile,
-		vector<vector<char>>& roll) {
-	HumRegex hre;
+void Tool_binroll::processFile(HumdrumFile& infile) {
+	int count = (infile.getScoreDuration() / m_duration).getInteger() + 1;
+	m_roll.clear();
+	m_printed = 0;
 
+	printHeader(infile, count);
 	for (int i=0; i<infile.getLineCount(); i++) {
-		if (infile[i].isExclusive()) {
-			break;
-		}
-		if (infile[i].isEmpty()) {
+		if (!infile[i].isData()) {
 			continue;
 		}
-		string line = infile[i].getText();
-		int found = 0;
-		for (int j=0; j<(int)line.size(); j++) {
-			if ((line[j] == '!') && !found) {
-				m_free_text << "#";
-			} else {
-				found = 1;
-				m_free_text << line[j];
-			}
-		}
-		m_free_text << "\n";
-	}
-
-	for (int i=0; i<(int)roll[0].size(); i++) {
-		for (int j=0; j<(int)roll.size(); j++) {
-			m_free_text << (int)roll[j][i];
-			if (j < (int)roll.size() - 1) {
-				m_free_text << ' ';
-			}
-		}
-		m_free_text << "\n";
-	}
-
-	int startindex = infile.getLineCount() - 1;
-	for (int i=infile.getLineCount()-1; i>=0; i--) {
-		if (infile[i].isManipulator()) {
-			startindex = i+1;
-			break;
+		if (m_streamQ) {
+			printSteps((infile[i].getDurationFromStart() / m_duration).getInteger());
 		}
-		startindex = i;
-	}
-
-	for (int i=startindex; i<infile.getLineCount(); i++) {
-		if (infile[i].isEmpty()) {
-			continue;
-		}
-		string line = infile[i].getText();
-		int found = 0;
-		for (int j=0; j<(int)line.size(); j++) {
-			if ((line[j] == '!') && !found) {
-				m_free_text << "#";
-			} else {
-				found = 1;
-				m_free_text << line[j];
-			}
-		}
-		m_free_text << "\n";
+		processLine(infile[i]);
 	}
+	printSteps(count);
+	printTrailer(infile);
 }
 
 
 
 //////////////////////////////
 //
-// Tool_binroll::processStrand --
+// Tool_binroll::processLine -- Add the notes starting on a data line.
 //
 
-void Tool_binroll::processStrand(vector<vector<char>>& roll, HTp starting,
-		HTp ending) {
-	HTp current = starting;
+void Tool_binroll::processLine(HumdrumLine& line) {
 	int base12;
 	HumNum starttime;
 	HumNum duration;
 	int startindex;
 	int endindex;
-	while (current && (current != ending)) {
+	for (int i=0; i<line.getFieldCount(); i++) {
+		HTp current = line.token(i);
+		if (!current->isKern()) {
+			continue;
+		}
 		if (!current->isNonNullData()) {
-			current = current->getNextToken();
 			continue;
 		}
 		if (current->isRest()) {
-			current = current->getNextToken();
 			continue;
 		}
 
+		starttime = current->getDurationFromStart();
+		startindex = (starttime / m_duration).getInteger();
 		if (current->isChord()) {
 			int stcount = current->getSubtokenCount();
-			starttime = current->getDurationFromStart();
-			startindex = (starttime / m_duration).getInteger();
 			for (int s=0; s<stcount; s++) {
 				string tok = current->getSubtoken(s);
 				base12 = Convert::kernToMidiNoteNumber(tok);
@@ -211,27 +359,142 @@ void Tool_binroll::processStrand(vector<vector<char>>& roll, HTp starting,
 				}
 				duration = Convert::recipToDuration(tok);
 				endindex = ((starttime+duration) / m_duration).getInteger();
-				roll[base12][startindex] = 2;
-				for (int i=startindex+1; i<endindex; i++) {
-					roll[base12][i] = 1;
-				}
+				m_roll.addNote(base12, startindex, endindex);
 			}
 		} else {
 			base12 = Convert::kernToMidiNoteNumber(current);
 			if ((base12 < 0) || (base12 > 127)) {
-				current = current->getNextToken();
 				continue;
 			}
-			starttime = current->getDurationFromStart();
 			duration = current->getDuration();
-			startindex = (starttime / m_duration).getInteger();
-			endindex   = ((starttime+duration) / m_duration).getInteger();
-			roll[base12][startindex] = 2;
-			for (int i=startindex+1; i<endindex; i++) {
-				roll[base12][i] = 1;
+			endindex = ((starttime+duration) / m_duration).getInteger();
+			m_roll.addNote(base12, startindex, endindex);
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::printSteps -- Print the time steps before the given step
+//     which have not yet been printed, and remove them from the roll.
+//
+
+void Tool_binroll::printSteps(int end) {
+	int low = m_roll.getLowKey();
+	int high = low + m_roll.getKeyCount() - 1;
+	for (int i=m_printed; i<end; i++) {
+		if (m_binaryQ) {
+			m_roll.writeStep(m_free_text, i);
+			continue;
+		}
+		for (int j=low; j<=high; j++) {
+			m_free_text << m_roll.getValue(i, j);
+			if (j < high) {
+				m_free_text << ' ';
 			}
 		}
-		current = current->getNextToken();
+		m_free_text << "\n";
+	}
+	if (end > m_printed) {
+		m_printed = end;
+	}
+	m_roll.removeSteps(m_printed);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::printHeader -- Print the comments before the start of the
+//     data, or the header of the binary format.
+//
+
+void Tool_binroll::printHeader(HumdrumFile& infile, int count) {
+	if (m_binaryQ) {
+		m_free_text << "HUMROLL1";
+		writeInt(m_duration.getNumerator(), 4);
+		writeInt(m_duration.getDenominator(), 4);
+		writeInt(m_roll.getLowKey(), 4);
+		writeInt(m_roll.getKeyCount(), 4);
+		writeInt(count, 8);
+		return;
+	}
+
+	for (int i=0; i<infile.getLineCount(); i++) {
+		if (infile[i].isExclusive()) {
+			break;
+		}
+		if (infile[i].isEmpty()) {
+			continue;
+		}
+		printComment(infile[i]);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::printTrailer -- Print the comments after the end of the
+//     data (not for binary output).
+//
+
+void Tool_binroll::printTrailer(HumdrumFile& infile) {
+	if (m_binaryQ) {
+		return;
+	}
+
+	int startindex = infile.getLineCount() - 1;
+	for (int i=infile.getLineCount()-1; i>=0; i--) {
+		if (infile[i].isManipulator()) {
+			startindex = i+1;
+			break;
+		}
+		startindex = i;
+	}
+
+	for (int i=startindex; i<infile.getLineCount(); i++) {
+		if (infile[i].isEmpty()) {
+			continue;
+		}
+		printComment(infile[i]);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::printComment -- Print a line with its leading "!"
+//     characters changed to "#".
+//
+
+void Tool_binroll::printComment(HumdrumLine& line) {
+	string text = line.getText();
+	int found = 0;
+	for (int j=0; j<(int)text.size(); j++) {
+		if ((text[j] == '!') && !found) {
+			m_free_text << "#";
+		} else {
+			found = 1;
+			m_free_text << text[j];
+		}
+	}
+	m_free_text << "\n";
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::writeInt -- Write an integer in little-endian byte order.
+//
+
+void Tool_binroll::writeInt(uint64_t value, int bytes) {
+	for (int i=0; i<bytes; i++) {
+		m_free_text.put((char)((value >> (8 * i)) & 0xff));
 	}
 }
 
@@ -2,6 +2,7 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Dec 26 17:03:54 PST 2010
 // Last Modified: Tue May 30 15:35:10 CEST 2017
+// Last Modified: Sun Oct 18 22:36:10 PDT 2026 Do not exit for --help and similar options
 // Filename:      tool-cint.cpp
 // URL:           https://github.com/craigsapp/minHumdrum/blob/master/src/tool-cint.cpp
 // Syntax:        C++11; humlib
@@ -221,7 +222,9 @@ string NoteNode::getId(void) {
 
 int Tool_cint::processFile(HumdrumFile& infile) {
 
-   initialize();
+	if (!initialize()) {
+		return 0;
+	}
 
 	vector<vector<NoteNode> > notes;
 	vector<string> names;
@@ -238,6 +241,10 @@ int Tool_cint::processFile(HumdrumFile& infile) {
 	if (koptionQ) {
 		adjustKTracks(ktracks, getString("koption"));
 	}
+	if (ktracks.empty()) {
+		m_warning_text << "Warning: no **kern spines in file" << endl;
+		return 0;
+	}
 	notes.resize(ktracks.size());
 	reverselookup.resize(infile.getTrackCount()+1);
 	fill(reverselookup.begin(), reverselookup.end(), -1);
@@ -264,7 +271,7 @@ int Tool_cint::processFile(HumdrumFile& infile) {
 
 	if (pitchesQ) {
 		printPitchGrid(notes, infile);
-		exit(0);
+		return 0;
 	}
 
 	int count = 0;
@@ -2345,12 +2352,10 @@ void Tool_cint::extractNoteArray(vector<vector<NoteNode> >& notes, HumdrumFile&
 			current[index].beatsize = beatsizes[track];
 			if (infile.token(i, j)->isNull()) {
 				sign = -1;
-				HTp nullx = infile.token(i, j)->resolveNull();
-				if (nullx == NULL) {
-					ii = jj = -1;
-				} else {
-					ii = nullx->getLineIndex();
-					jj = nullx->getFieldIndex();
+				if (!infile.getResolvedPosition(i, j, ii, jj)) {
+					// null token at start of spine
+					ii = i;
+					jj = j;
 				}
 			} else {
 				ii = i;
@@ -2593,25 +2598,26 @@ void Tool_cint::getNames(vector<string>& names, vector<int>& reverselookup,
 //////////////////////////////
 //
 // Tool_cint::initialize -- validate and process command-line options.
+//     Returns false if no analysis should be done (such as for --help).
 //
 
-void Tool_cint::initialize(void) {
+bool Tool_cint::initialize(void) {
 
 	// handle basic options:
 	if (getBoolean("author")) {
 		m_humdrum_text << "Written by Craig Stuart Sapp, "
 			  << "craig@ccrma.stanford.edu, September 2013" << endl;
-		exit(0);
+		return false;
 	} else if (getBoolean("version")) {
 		m_humdrum_text << getCommand() << ", version: 16 March 2022" << endl;
 		m_humdrum_text << "compiled: " << __DATE__ << endl;
-		exit(0);
+		return false;
 	} else if (getBoolean("help")) {
 		usage(getCommand());
-		exit(0);
+		return false;
 	} else if (getBoolean("example")) {
 		example();
-		exit(0);
+		return false;
 	}
 
 	koptionQ = getBoolean("koption");
@@ -2707,6 +2713,7 @@ void Tool_cint::initialize(void) {
 		SearchString = getString("search");
 	}
 
+	return true;
 }
 
 
@@ -2,7 +2,7 @@
 // Programmer:    Kiana Hu
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Fri Feb 18 22:00:48 PST 2022
-// Last Modified: Tue Jul  5 23:31:54 PDT 2022
+// Last Modified: Sun Oct 18 23:46:02 PDT 2026
 // Filename:      tool-cmr.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-cmr.cpp
 // Syntax:        C++11; humlib
@@ -27,14 +27,14 @@
 #include "Convert.h"
 #include "HumRegex.h"
 
+#include <algorithm>
+
 using namespace std;
 
 namespace hum {
 
 // START_MERGE
 
-double cmr_note_info::m_syncopationWeight = 1.0;
-double cmr_note_info::m_leapWeight = 0.5;
 
 
 ///////////////////////////////////////////////////////////////////////////
@@ -312,13 +312,13 @@ double cmr_note_info::getMetricLevel(HTp token) {
 //     is preceded by a melodic leap.
 //
 
-double cmr_note_info::getNoteStrength(void) {
+double cmr_note_info::getNoteStrength(double syncopationWeight, double leapWeight) {
 	double output = 1.0;
 	if (hasSyncopation()) {
-		output += m_syncopationWeight;
+		output += syncopationWeight;
 	}
 	if (hasLeapBefore()) {
-		output += m_leapWeight;
+		output += leapWeight;
 	}
 	return output;
 }
@@ -769,10 +769,10 @@ int cmr_group_info::getStartFieldNumber(void) {
 // cmr_group_info::getGroupStrength -- Return the strength value for the CMR.
 //
 
-double cmr_group_info::getGroupStrength(void) {
+double cmr_group_info::getGroupStrength(double syncopationWeight, double leapWeight) {
 	double output = 0.0;
 	for (int i=0; i<(int)m_notes.size(); i++) {
-		output += m_notes[i].getNoteStrength();
+		output += m_notes[i].getNoteStrength(syncopationWeight, leapWeight);
 	}
 	return output;
 }
@@ -1077,8 +1077,8 @@ void Tool_cmr::initialize(void) {
 	m_infoQ        = getBoolean("info");
 	m_halfQ        = getBoolean("half");
 
-	cmr_note_info::m_syncopationWeight = getDouble("syncopation-weight");
-	cmr_note_info::m_leapWeight        = getDouble("leap-weight");
+	m_syncopationWeight = getDouble("syncopation-weight");
+	m_leapWeight        = getDouble("leap-weight");
 
 	m_noteGroups.clear();
 }
@@ -1098,6 +1098,7 @@ void Tool_cmr::processFile(HumdrumFile& infile) {
 	m_maxPitch.resize(infile.getMaxTrack() + 1);
 
 	m_local_count = 0;
+	m_positiveLines.assign(infile.getLineCount(), 0);
 
 	m_barNum = infile.getMeasureNumbers();
 
@@ -1218,6 +1219,8 @@ void Tool_cmr::processSpine(HTp startok, HumdrumFile&  infile) {
 		return;
 	}
 
+	prepareRangeTables();
+
 	for (int i=0; i<(int)m_notelist.size(); i++) {
 		checkForCmr(i, 1, infile);
 	}
@@ -1270,6 +1273,8 @@ void Tool_cmr::processSpineFlipped(HTp startok, HumdrumFile& infile) {
 		return;
 	}
 
+	prepareRangeTables();
+
 	for (int i=0; i<(int)m_notelist.size(); i++) {
 		checkForCmr(i, -1, infile);
 	}
@@ -1313,7 +1318,7 @@ void Tool_cmr::checkForCmr(int index, int direction, HumdrumFile& infile) {
 	int i = index+1;
 	HumNum duration = 0;
 	if (i < (int)m_notelist.size()) {
-		duration = m_notelist.at(i).at(0)->getDurationFromStart() - m_notelist.at(index).at(0)->getDurationFromStart();
+		duration = m_starttimes[i] - m_starttimes[index];
 	}
 
 	// Check for matching peaks after target note:
@@ -1333,14 +1338,14 @@ void Tool_cmr::checkForCmr(int index, int direction, HumdrumFile& infile) {
 		}
 		i++;
 		if (i < (int)m_notelist.size()) {
-			duration = m_notelist.at(i).at(0)->getDurationFromStart() - m_notelist.at(index).at(0)->getDurationFromStart();
+			duration = m_starttimes[i] - m_starttimes[index];
 		}
 	}
 
 	i = index-1;
 	duration = 0;
-	if (i < (int)m_notelist.size()) {
-		duration = m_notelist.at(index).at(0)->getDurationFromStart() - m_notelist.at(i).at(0)->getDurationFromStart();
+	if (i >= 0) {
+		duration = m_starttimes[index] - m_starttimes[i];
 	}
 
 	// Check for matching peaks before target note:
@@ -1360,7 +1365,7 @@ void Tool_cmr::checkForCmr(int index, int direction, HumdrumFile& infile) {
 		}
 		i--;
 		if (i >= 0) {
-			duration = m_notelist.at(index).at(0)->getDurationFromStart() - m_notelist.at(i).at(0)->getDurationFromStart();
+			duration = m_starttimes[index] - m_starttimes[i];
 		}
 	}
 
@@ -1369,16 +1374,15 @@ void Tool_cmr::checkForCmr(int index, int direction, HumdrumFile& infile) {
 		return;
 	}
 
+	int firstNew = (int)m_noteGroups.size();
 	for (int i=0; i<=(int)candidates.size() - m_cmrNum; i++) {
 		int index1 = candidates.at(i);
 		int index2 = candidates.at(i+m_cmrNum-1);
-		HumNum dur1 = m_notelist.at(index1).at(0)->getDurationFromStart();
-		HumNum dur2 = m_notelist.at(index2).at(0)->getDurationFromStart();
-		HumNum duration = dur2 - dur1;
+		HumNum duration = m_starttimes[index2] - m_starttimes[index1];
 		if (duration > m_cmrDur) {
 			continue;
 		}
-		if (hasHigher(pitch, 2, m_midinums, m_notelist, index1, index2)) {
+		if (hasHigher(pitch, 2, index1, index2)) {
 			continue;
 		}
 
@@ -1395,40 +1399,39 @@ void Tool_cmr::checkForCmr(int index, int direction, HumdrumFile& infile) {
 			m_noteGroups.back().setDirectionDown();
 		} else {
 			m_noteGroups.back().setDirectionUp();
+			updatePositiveLines(m_noteGroups.back(), 1);
 		}
 	}
 
+	if (m_noteGroups.empty()) {
+		return;
+	}
+
 	int leapcount = m_noteGroups.back().getLeapCount();
 	int syncocount  = m_noteGroups.back().getSyncopationCount();
 	if (syncocount == 0) {
 		if (leapcount < 3) {
 			// Delete groups since it has less than three leaps and no syncopations
-			if (m_noteGroups.size() > 0) {
-				m_noteGroups.resize(m_noteGroups.size() - 1);
+			if (m_noteGroups.back().getDirection() > 0) {
+				updatePositiveLines(m_noteGroups.back(), -1);
 			}
+			m_noteGroups.resize(m_noteGroups.size() - 1);
 		}
 	}
 
 	// Remove negative groups if they share a note with a positive group.
-	vector<bool> positive(infile.getLineCount(), false);
-	for (int i=0; i<(int)m_noteGroups.size(); i++) {
-		int dir = m_noteGroups.at(i).getDirection();
-		if (dir > 0) {
-			for (int j=0; j<m_noteGroups.at(i).getNoteCount(); j++) {
-				int line = m_noteGroups.at(i).getToken(j)->getLineIndex();
-				positive.at(line) = true;
-			}
-		} else if (dir < 0) {
-			bool valid = true;
-			for (int j=0; j<m_noteGroups.at(i).getNoteCount(); j++) {
-				int line = m_noteGroups.at(i).getToken(j)->getLineIndex();
-				if (positive.at(line)) {
-					valid = false;
-					break;
-				}
-			}
-			if (!valid) {
-				m_noteGroups.at(i).makeInvalid();
+	// Only the positive groups before a negative group in the list are
+	// considered, and those cannot change after the negative group is
+	// added, so only the new groups need to be checked.
+	for (int i=firstNew; i<(int)m_noteGroups.size(); i++) {
+		if (m_noteGroups[i].getDirection() >= 0) {
+			continue;
+		}
+		for (int j=0; j<m_noteGroups[i].getNoteCount(); j++) {
+			int line = m_noteGroups[i].getToken(j)->getLineIndex();
+			if (m_positiveLines.at(line) > 0) {
+				m_noteGroups[i].makeInvalid();
+				break;
 			}
 		}
 	}
@@ -1436,6 +1439,88 @@ void Tool_cmr::checkForCmr(int index, int direction, HumdrumFile& infile) {
 
 
 
+//////////////////////////////
+//
+// Tool_cmr::updatePositiveLines -- Add (change = 1) or remove (change = -1)
+//     the notes of a positive group from the count of positive CMR notes
+//     on each line of the score.
+//
+
+void Tool_cmr::updatePositiveLines(cmr_group_info& group, int change) {
+	for (int j=0; j<group.getNoteCount(); j++) {
+		int line = group.getToken(j)->getLineIndex();
+		m_positiveLines.at(line) += change;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_cmr::prepareRangeTables -- Store the start times of the notes in
+//     the current part, and create sparse tables for finding the highest
+//     pitch (and highest pitch on a strong beat) in a range of notes in
+//     constant time.  m_midinums must be calculated before calling this
+//     function.
+//
+
+void Tool_cmr::prepareRangeTables(void) {
+	int size = (int)m_notelist.size();
+	m_starttimes.resize(size);
+	vector<int> strongpitches(size);
+	for (int i=0; i<size; i++) {
+		HTp note = m_notelist[i].at(0);
+		m_starttimes[i] = note->getDurationFromStart();
+		strongpitches[i] = isOnStrongBeat(note) ? m_midinums.at(i) : -1;
+	}
+	buildRangeMaxTable(m_maxPitchTable, m_midinums);
+	buildRangeMaxTable(m_maxStrongPitchTable, strongpitches);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_cmr::buildRangeMaxTable -- Create a sparse table where
+//     table[k][i] is the maximum of values[i] to values[i + 2^k - 1].
+//
+
+void Tool_cmr::buildRangeMaxTable(vector<vector<int>>& table, vector<int>& values) {
+	int size = (int)values.size();
+	int levels = 1;
+	while ((1 << levels) <= size) {
+		levels++;
+	}
+	table.resize(levels);
+	table[0] = values;
+	for (int k=1; k<levels; k++) {
+		int width = 1 << k;
+		int half = width >> 1;
+		table[k].resize(size - width + 1);
+		for (int i=0; i+width<=size; i++) {
+			table[k][i] = std::max(table[k-1][i], table[k-1][i+half]);
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_cmr::getRangeMax -- Return the maximum value between index1 and
+//     index2 (inclusive) from a table created by buildRangeMaxTable().
+//
+
+int Tool_cmr::getRangeMax(vector<vector<int>>& table, int index1, int index2) {
+	int k = 0;
+	while ((2 << k) <= index2 - index1 + 1) {
+		k++;
+	}
+	return std::max(table[k][index1], table[k][index2 - (1 << k) + 1]);
+}
+
+
+
 //////////////////////////////
 //
 // Tool_cmr::hasHigher -- There may be a note a step higher
@@ -1444,22 +1529,16 @@ void Tool_cmr::checkForCmr(int index, int direction, HumdrumFile& infile) {
 //     True = invalid CMR case.
 //
 
-bool Tool_cmr::hasHigher(int pitch, int tolerance, vector<int>& midinums, vector<vector<HTp>>& notelist, int index1, int index2) {
-
-	for (int i=index1; i<=index2; i++) {
-		// Only a step above (major or minor second) is allowed.
-		// Input tolerance is 2.
-		if (midinums.at(i) > pitch + tolerance) {
-			return true;
-		}
-
-		if (midinums.at(i) > pitch) {
-			// If the higher note is accented, then invalidate the cmr.
-			if (isOnStrongBeat(notelist.at(i).at(0))) {
-				return true;
-			}
-		}
+bool Tool_cmr::hasHigher(int pitch, int tolerance, int index1, int index2) {
+	// Only a step above (major or minor second) is allowed.
+	// Input tolerance is 2.
+	if (getRangeMax(m_maxPitchTable, index1, index2) > pitch + tolerance) {
+		return true;
+	}
 
+	// If a higher note is accented, then invalidate the cmr.
+	if (getRangeMax(m_maxStrongPitchTable, index1, index2) > pitch) {
+		return true;
 	}
 
 	return false;
@@ -1770,7 +1849,7 @@ void Tool_cmr::printGroupStatistics(HumdrumFile& infile) {
 		m_humdrum_text << "!!!cmr_end_measure: "   << m_noteGroups[i].getMeasureEnd()       << endl;
 		// Durations are in units of whole notes (semibreves):
 		m_humdrum_text << "!!!cmr_duration: "      << groupDuration << m_durUnit            << endl;
-		m_humdrum_text << "!!!cmr_strength: "      << m_noteGroups[i].getGroupStrength()    << endl;
+		m_humdrum_text << "!!!cmr_strength: "      << m_noteGroups[i].getGroupStrength(m_syncopationWeight, m_leapWeight)    << endl;
 		m_humdrum_text << "!!!cmr_direction: "     << m_noteGroups[i].getDirection()        << endl;
 		m_humdrum_text << "!!!cmr_note_count: "    << m_noteGroups[i].getNoteCount()        << endl;
 		m_humdrum_text << "!!!cmr_pitch: "         << m_noteGroups[i].getPitch()            << endl;
@@ -2634,7 +2713,7 @@ int Tool_cmr::getStrengthScore(void) {
 	int output = 0;
 	for (int i=0; i<(int)m_noteGroups.size(); i++) {
 		if (m_noteGroups[i].isValid()) {
-			output += m_noteGroups[i].getGroupStrength();
+			output += m_noteGroups[i].getGroupStrength(m_syncopationWeight, m_leapWeight);
 		}
 	}
 	return output;
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Jul 14 01:03:07 CEST 2019
-// Last Modified: Thu Jun  9 15:23:15 PDT 2022
+// Last Modified: Sun Oct 18 21:04:30 PDT 2026
 // Filename:      tool-composite.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-composite.cpp
 // Syntax:        C++11; humlib
@@ -3170,33 +3170,8 @@ void Tool_composite::adjustBadCoincidenceRests(HumdrumFile& output, HumdrumFile&
 	}
 
 	HumRegex hre;
-	vector<HumNum> timesigtop(output.getLineCount(), 4);
-	vector<HumNum> timesigbot(output.getLineCount(), 4);
-	HumNum tts = 4;
-	HumNum bts = 4;
-
-	for (int i=0; i<output.getLineCount(); i++) {
-		if (!output[i].isInterpretation()) {
-			timesigtop[i] = tts;
-			timesigbot[i] = bts;
-			continue;
-		}
-		for (int j=0; j<output[i].getFieldCount(); j++) {
-			HTp token = output.token(i, j);
-			if (token->getDataType() != "**kern-coin") {
-				continue;
-			}
-			if (token->isTimeSignature()) {
-				if (hre.search(token, "^\\*M(\\d+)/(\\d+)")) {
-					tts = hre.getMatch(1);
-					bts = hre.getMatch(2);
-				}
-			}
-			break;
-		}
-		timesigtop[i] = tts;
-		timesigbot[i] = bts;
-	}
+	const HumMetricTable& grid = output.getMetricGrid();
+	int track = sstarts.at(0)->getTrack();
 
 	HTp current = sstarts.at(0);
 	string rhythm;
@@ -3218,7 +3193,13 @@ void Tool_composite::adjustBadCoincidenceRests(HumdrumFile& output, HumdrumFile&
 			rhythm = hre.getMatch(1);
 			if (rhythm == "3...") {
 				int lindex = current->getLineIndex();
-				current = fixBadRestRhythm(current, rhythm, timesigtop[lindex], timesigbot[lindex]);
+				HumNum tstop = 4;
+				HumNum tsbot = 4;
+				if (grid.hasMeter(lindex, track)) {
+					tstop = grid.getMeterTop(lindex, track);
+					tsbot = grid.getMeterBottom(lindex, track);
+				}
+				current = fixBadRestRhythm(current, rhythm, tstop, tsbot);
 			}
 		}
 		current = current->getNextToken();
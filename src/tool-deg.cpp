@@ -21,18 +21,6 @@ namespace hum {
 
 // START_MERGE
 
-/////////////////////////////////
-//
-// Tool_deg::ScaleDegree static member variables:
-//
-
-bool Tool_deg::ScaleDegree::m_showTiesQ  = false;
-bool Tool_deg::ScaleDegree::m_showZerosQ = false;
-bool Tool_deg::ScaleDegree::m_octaveQ = false;
-string Tool_deg::ScaleDegree::m_forcedKey = "";
-
-
-
 /////////////////////////////////
 //
 // Tool_deg::Tool_deg -- Set the recognized options for the tool.
@@ -131,7 +119,7 @@ void Tool_deg::initialize(void) {
 		m_recipQ = true;
 	}
 	m_degTiesQ = getBoolean("ties");
-	Tool_deg::ScaleDegree::setShowOctaves(getBoolean("octave"));
+	m_degOctaveQ = getBoolean("octave");
 
 	if (getBoolean("spine-tracks")) {
 		m_spineTracks = getString("spine-tracks");
@@ -162,12 +150,10 @@ void Tool_deg::initialize(void) {
 			if (m_forcedKey.find(":") == string::npos) {
 				m_forcedKey += ":";
 			}
-			Tool_deg::ScaleDegree::setForcedKey(m_forcedKey);
 		}
 	}
 
-	Tool_deg::ScaleDegree::setShowTies(m_degTiesQ);
-	Tool_deg::ScaleDegree::setShowZeros(getBoolean("zeros"));
+	m_degZerosQ = getBoolean("zeros");
 }
 
 
@@ -185,6 +171,7 @@ void Tool_deg::processFile(HumdrumFile& infile) {
 
 	// Create storage space for scale degree analyses:
 	int kernCount = (int)m_selectedKernSpines.size();
+	m_degSpines.clear();
 	m_degSpines.resize(kernCount);
 	for (int i=0; i<kernCount; i++) {
 		prepareDegSpine(m_degSpines.at(i), m_selectedKernSpines.at(i), infile);
@@ -1529,6 +1516,17 @@ void Tool_deg::prepareDegSpine(vector<vector<ScaleDegree>>& degspine, HTp kernst
 		}
 	}
 
+	// Set the rendering options for the scale degrees:
+	for (int i=0; i<(int)degspine.size(); i++) {
+		for (int j=0; j<(int)degspine[i].size(); j++) {
+			ScaleDegree& degree = degspine[i][j];
+			degree.setShowTies(m_degTiesQ);
+			degree.setShowZeros(m_degZerosQ);
+			degree.setShowOctaves(m_degOctaveQ);
+			degree.setForcedKey(m_forcedKey);
+		}
+	}
+
 	// process melodic contours, etc.
 
 }
@@ -1844,7 +1842,7 @@ string Tool_deg::ScaleDegree::getDegToken(void) const {
 		return getManipulator();
 	} else if (isInterpretation()) {
 		if (isKeyDesignation()) {
-			if (m_forcedKey.empty()) {
+			if (!m_forcedKeyQ) {
 				return *token;
 			} else{
 				return "*";
@@ -2,7 +2,7 @@
 // Programmer:    Alexander Morgan
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
-// Last Modified: Wed May 24 15:39:19 CEST 2017
+// Last Modified: Sun Oct 18 23:45:11 PDT 2026
 // Filename:      tool-dissonant.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-dissonant.cpp
 // Syntax:        C++11; humlib
@@ -16,7 +16,9 @@
 #include "HumRegex.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <thread>
 
 using namespace std;
 
@@ -49,6 +51,8 @@ Tool_dissonant::Tool_dissonant(void) {
 	define("i|x|e|exinterp=s:**cdata-rdiss", "specify exinterp for **diss spines");
 	define("color|color-by-rhythm=b",        "color dissonant notes by beat level");
 	define("color2|color-by-interval=b",     "color dissonant notes by dissonant interval");
+	define("statistics=b",                   "only print dissonance counts for each input file");
+	define("threads=i:0",                    "number of threads for --statistics (0 = number of cores)");
 }
 
 
@@ -59,6 +63,9 @@ Tool_dissonant::Tool_dissonant(void) {
 //
 
 bool Tool_dissonant::run(HumdrumFileSet& infiles) {
+	if (getBoolean("statistics")) {
+		return runStatistics(infiles);
+	}
 	bool status = true;
 	for (int i=0; i<infiles.getCount(); i++) {
 		status &= run(infiles[i]);
@@ -105,6 +112,17 @@ bool Tool_dissonant::run(HumdrumFile& infile, ostream& out) {
 
 bool Tool_dissonant::run(HumdrumFile& infile) {
 
+	if (getBoolean("statistics")) {
+		vector<int> counts;
+		int voices = 0;
+		prepareStatisticsLabels();
+		getStatistics(infile, counts, voices);
+		printStatisticsHeader(m_humdrum_text);
+		printStatisticsLine(m_humdrum_text, infile.getFilename(), counts, voices);
+		printStatisticsFooter(m_humdrum_text);
+		return true;
+	}
+
 	if (getBoolean("voice-number")) {
 		m_voicenumQ = true;
 	}
@@ -266,8 +284,8 @@ void Tool_dissonant::adjustColorization(HumdrumFile& infile) {
 	// New spines were added so need to re-analyze spine structure:
 	infile.analyzeBaseFromLines();
 
-	bool colorizeQ = getBoolean("colorize");
-	bool colorize2Q = getBoolean("colorize2");
+	bool colorizeQ = getBoolean("color");
+	bool colorize2Q = getBoolean("color2");
 	if (!(colorizeQ || colorize2Q)) {
 		// nothing to do
 		return;
@@ -1146,7 +1164,7 @@ void Tool_dissonant::changePitch(HTp note2, HTp note1) {
 //
 
 void Tool_dissonant::printColorLegend(HumdrumFile& infile) {
-	if (getBoolean("colorize")) {
+	if (getBoolean("color")) {
 		if (dissL0Q) {
 			infile.appendLine("!!!RDF**kern: N = strong dissonant marked note, color=\"#bb3300\"");
 		}
@@ -1156,7 +1174,7 @@ void Tool_dissonant::printColorLegend(HumdrumFile& infile) {
 		if (dissL2Q) {
 			infile.appendLine("!!!RDF**kern: + = weak 2 dissonant marked note, color=\"#0099ff\"");
 		}
-	} else if (getBoolean("colorize2")) {
+	} else if (getBoolean("color2")) {
 		if (diss2Q) {
 			infile.appendLine("!!!RDF**kern: @ = dissonant 2nd, marked note, color=\"#33bb00\"");
 		}
@@ -1225,8 +1243,10 @@ void Tool_dissonant::doAnalysisForVoice(vector<vector<string>>& results,
 		}
 	}
 	bool nodissonanceQ = getBoolean("no-dissonant");
-	bool colorizeQ = getBoolean("colorize");
-	bool colorize2Q = getBoolean("colorize2");
+	// --statistics does not modify the input data:
+	bool statisticsQ = getBoolean("statistics");
+	bool colorizeQ = getBoolean("color") && !statisticsQ;
+	bool colorize2Q = getBoolean("color2") && !statisticsQ;
 
 	HumNum durpp = -1; // duration of previous previous note
 	HumNum durp;       // duration of previous melodic note
@@ -2434,6 +2454,196 @@ void Tool_dissonant::printCountAnalysis(vector<vector<string>>& data) {
 
 
 
+//////////////////////////////
+//
+// Tool_dissonant::runStatistics -- Count the dissonance labels in each file
+//     of the set without modifying the files.  The files are analyzed
+//     in parallel (--threads), with each thread pulling the next unprocessed
+//     file from the set.  The output is a single table with one line for
+//     each input file.
+//
+
+bool Tool_dissonant::runStatistics(HumdrumFileSet& infiles) {
+	int count = infiles.getCount();
+	vector<vector<int>> counts(count);
+	vector<int> voices(count, 0);
+
+	int threadCount = getInteger("threads");
+	if (threadCount <= 0) {
+		threadCount = (int)std::thread::hardware_concurrency();
+	}
+	if (threadCount > count) {
+		threadCount = count;
+	}
+	if (threadCount < 1) {
+		threadCount = 1;
+	}
+
+	// Each thread uses its own copy of the tool since the analysis
+	// functions store temporary state in the tool.
+	std::atomic<int> nextFile(0);
+	auto worker = [&](void) {
+		Tool_dissonant tool;
+		static_cast<Options&>(tool) = static_cast<Options&>(*this);
+		tool.prepareStatisticsLabels();
+		int index;
+		while ((index = nextFile++) < count) {
+			tool.getStatistics(infiles[index], counts[index], voices[index]);
+		}
+	};
+
+	if (threadCount == 1) {
+		worker();
+	} else {
+		vector<std::thread> pool;
+		pool.reserve(threadCount);
+		for (int i=0; i<threadCount; i++) {
+			pool.emplace_back(worker);
+		}
+		for (int i=0; i<(int)pool.size(); i++) {
+			pool[i].join();
+		}
+	}
+
+	prepareStatisticsLabels();
+	printStatisticsHeader(m_humdrum_text);
+	for (int i=0; i<count; i++) {
+		printStatisticsLine(m_humdrum_text, infiles[i].getFilename(), counts[i], voices[i]);
+	}
+	printStatisticsFooter(m_humdrum_text);
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_dissonant::prepareStatisticsLabels -- Create the list of labels
+//     used as columns in the --statistics output.  Labels which are
+//     identical (such as for -u) are merged into a single column.
+//
+
+void Tool_dissonant::prepareStatisticsLabels(void) {
+	if (getBoolean("undirected")) {
+		fillLabels2();
+	} else {
+		fillLabels();
+	}
+
+	m_statLabels.clear();
+	m_statAgents.clear();
+	m_statIndex.clear();
+	for (int i=0; i<(int)LABELS_SIZE; i++) {
+		if ((i == UNLABELED_Z2) || (i == UNLABELED_Z7)) {
+			continue;
+		}
+		if (m_statIndex.find(m_labels[i]) != m_statIndex.end()) {
+			continue;
+		}
+		m_statIndex[m_labels[i]] = (int)m_statLabels.size();
+		m_statLabels.push_back(m_labels[i]);
+		m_statAgents.push_back((i == AGENT_BIN) || (i == AGENT_TERN));
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_dissonant::getStatistics -- Count the dissonance labels in a file.
+//     Only the initial classification of the dissonances is done: the
+//     input file is not modified, so suppression and colorization of the
+//     dissonances are skipped.  prepareStatisticsLabels() must be called
+//     before this function.
+//
+
+void Tool_dissonant::getStatistics(HumdrumFile& infile, vector<int>& counts,
+		int& voices) {
+	counts.assign(m_statLabels.size(), 0);
+
+	NoteGrid grid(infile);
+	voices = grid.getVoiceCount();
+
+	vector<vector<string>> results(voices);
+	for (int i=0; i<(int)results.size(); i++) {
+		results[i].resize(infile.getLineCount());
+	}
+	vector<vector<NoteCell*>> attacks;
+	doAnalysis(results, grid, attacks, false);
+
+	for (int i=0; i<(int)results.size(); i++) {
+		for (int j=0; j<(int)results[i].size(); j++) {
+			if (results[i][j].empty()) {
+				continue;
+			}
+			auto it = m_statIndex.find(results[i][j]);
+			if (it != m_statIndex.end()) {
+				counts[it->second]++;
+			}
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_dissonant::printStatisticsHeader -- Print the exclusive
+//     interpretations for the --statistics table.  The **total column
+//     does not include suspension agents.
+//
+
+void Tool_dissonant::printStatisticsHeader(ostream& out) {
+	out << "**file\t**voices\t**total";
+	for (int i=0; i<(int)m_statLabels.size(); i++) {
+		out << "\t**" << m_statLabels[i];
+	}
+	out << endl;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_dissonant::printStatisticsLine -- Print the dissonance counts
+//     for a single file in the --statistics table.
+//
+
+void Tool_dissonant::printStatisticsLine(ostream& out, const string& filename,
+		vector<int>& counts, int voices) {
+	int total = 0;
+	for (int i=0; i<(int)counts.size(); i++) {
+		if (!m_statAgents.at(i)) {
+			total += counts[i];
+		}
+	}
+	out << (filename.empty() ? "." : filename);
+	out << "\t" << voices;
+	out << "\t" << total;
+	for (int i=0; i<(int)m_statLabels.size(); i++) {
+		out << "\t" << (i < (int)counts.size() ? counts[i] : 0);
+	}
+	out << endl;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_dissonant::printStatisticsFooter -- Print the spine terminators
+//     for the --statistics table.
+//
+
+void Tool_dissonant::printStatisticsFooter(ostream& out) {
+	out << "*-\t*-\t*-";
+	for (int i=0; i<(int)m_statLabels.size(); i++) {
+		out << "\t*-";
+	}
+	out << endl;
+}
+
+
+
 //////////////////////////////
 //
 // Tool_dissonant::getNextPitchAttackIndex -- Get the [line] index of the next
@@ -2413,10 +2413,8 @@ void Tool_esac2hum::printPdfLinks(ostream& output) {
 //
 
 void Tool_esac2hum::printConversionDate(ostream& output) {
-	std::time_t t = std::time(nullptr);
-	std::tm* now = std::localtime(&t);
 	output << "!!!ONB: Converted on ";
-	output << std::put_time(now, "%Y/%m/%d");
+	output << Convert::getCurrentDate();
 	output << " with esac2hum" << endl;
 }
 
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Jul 18 11:23:42 PDT 2005
-// Last Modified: Wed Jul  3 21:00:36 CEST 2024
+// Last Modified: Sun Oct 18 23:59:02 PDT 2026
 // Filename:      tool-extract.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-extract.h
 // Syntax:        C++11;; humlib
@@ -23,6 +23,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <sstream>
 
 using namespace std;
 
@@ -59,6 +60,7 @@ Tool_extract::Tool_extract(void) {
 	define("empty|empties=b",           "only keep spines with only null data tokens");
 	define("spine-list=b",              "show spine list and then exit");
 	define("no-rest|no-rests=b",        "remove **kern spines containing only rests (and their co-spines)");
+	define("stream=b",                  "process input line-by-line without storing the file (-f, -k, -K, -i, -I, -x only)");
 
 	define("debug=b",                   "print debugging information");
 	define("author=b",                  "author of the program");
@@ -119,6 +121,429 @@ bool Tool_extract::run(HumdrumFile& infile) {
 
 
 
+//////////////////////////////
+//
+// Tool_extract::run -- Streaming processing of input data.  The input is
+//     read one line at a time, and only the track assignments of the
+//     currently active spines are stored, so memory usage is independent
+//     of the input size.  Only simple spine selections are allowed: field
+//     lists without subspine or model letters (-f, -k, -K), exclusion
+//     lists (-x), and exclusive interpretation selections (-i, -I, which
+//     can only match exclusive interpretations when streaming).  Track
+//     numbers in field lists (including "$") refer to the spines on the
+//     first exclusive interpretation line of each segment.  Concatenated
+//     files (where all spines are terminated before the next set of
+//     exclusive interpretations) are processed as separate segments, with
+//     the spine selection recalculated for each segment.
+//
+
+bool Tool_extract::run(istream& input, ostream& out) {
+	m_streamTracks.clear();
+	m_streamMaxTrack = 0;
+	bool status = true;
+	int lineindex = 0;
+	string line;
+	vector<string> tokens;
+	while (getline(input, line)) {
+		lineindex++;
+		if (!line.empty() && (line.back() == '\r')) {
+			line.pop_back();
+		}
+		if (!processStreamLine(line, tokens)) {
+			m_error_text << "Error on line " << lineindex << ": " << line << endl;
+			status = false;
+			break;
+		}
+		if (m_humdrum_text.tellp() > 0x10000) {
+			flushStreamOutput(out);
+		}
+	}
+	flushStreamOutput(out);
+	if (status && !m_streamTracks.empty()) {
+		m_warning_text << "Warning: input data does not terminate all spines" << endl;
+	}
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::flushStreamOutput -- Move the buffered Humdrum output
+//     text to the output stream.
+//
+
+void Tool_extract::flushStreamOutput(ostream& out) {
+	out << m_humdrum_text.str();
+	m_humdrum_text.str("");
+	m_humdrum_text.clear();
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::processStreamLine -- Extract the selected fields from a
+//     line of streamed input and update the spine tracks for any spine
+//     manipulators on the line.  Returns false if the line could not be
+//     processed.
+//
+
+bool Tool_extract::processStreamLine(const string& line, vector<string>& tokens) {
+	bool spinedQ = !line.empty() && (line.compare(0, 2, "!!") != 0);
+	if (!spinedQ) {
+		m_humdrum_text << line << '\n';
+		return true;
+	}
+
+	tokens.clear();
+	size_t start = 0;
+	size_t tab;
+	while ((tab = line.find('\t', start)) != string::npos) {
+		tokens.push_back(line.substr(start, tab - start));
+		start = tab + 1;
+	}
+	tokens.push_back(line.substr(start));
+
+	if (m_streamTracks.empty()) {
+		if (line.compare(0, 2, "**") != 0) {
+			m_error_text << "Error: data found before exclusive interpretations" << endl;
+			return false;
+		}
+		if (!prepareStreamSegment(line, (int)tokens.size())) {
+			return false;
+		}
+	} else if (tokens.size() != m_streamTracks.size()) {
+		m_error_text << "Error: expected " << m_streamTracks.size()
+		             << " fields but found " << tokens.size() << endl;
+		return false;
+	} else if (interpQ) {
+		// Check the exclusive interpretations of spines added with *+:
+		for (int j=0; j<(int)tokens.size(); j++) {
+			if (tokens[j].compare(0, 2, "**") != 0) {
+				continue;
+			}
+			bool found = false;
+			for (int k=0; k<(int)m_streamInterps.size(); k++) {
+				if (m_streamInterps[k] == tokens[j]) {
+					found = true;
+					break;
+				}
+			}
+			if (found == (interpstate != 0)) {
+				field.push_back(m_streamTracks[j]);
+				subfield.push_back(0);
+				model.push_back(0);
+			}
+		}
+	}
+
+	bool manipQ = false;
+	for (int j=0; j<(int)tokens.size(); j++) {
+		const string& token = tokens[j];
+		if ((token == "*^") || (token == "*v") || (token == "*x") ||
+				(token == "*+") || (token == "*-") ||
+				(token.compare(0, 2, "**") == 0)) {
+			manipQ = true;
+			break;
+		}
+	}
+
+	if (excludeQ) {
+		printStreamExcludedFields(tokens);
+	} else if (manipQ) {
+		printStreamManipulatorFields(tokens);
+	} else {
+		printStreamFields(tokens);
+	}
+
+	if (manipQ) {
+		updateStreamTracks(tokens);
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::prepareStreamSegment -- Calculate the spine selection for a
+//     new segment of streamed input from its exclusive interpretation line.
+//
+
+bool Tool_extract::prepareStreamSegment(const string& exinterps, int count) {
+	m_streamTracks.resize(count);
+	for (int i=0; i<count; i++) {
+		m_streamTracks[i] = i + 1;
+	}
+	m_streamMaxTrack = count;
+
+	// A minimal Humdrum file containing only the exclusive interpretations
+	// is sufficient for the spine-selection functions.
+	string header = exinterps;
+	header += '\n';
+	for (int i=0; i<count; i++) {
+		if (i > 0) {
+			header += '\t';
+		}
+		header += "*-";
+	}
+	header += '\n';
+	HumdrumFile infile;
+	infile.readString(header);
+	initialize(infile);
+
+	if (countQ || expandQ || reverseQ || removerestQ || grepQ || emptyQ ||
+			noEmptyQ || traceQ || spineListQ) {
+		m_error_text << "Error: only -f, -k, -K, -i, -I and -x options "
+		             << "can be used with --stream" << endl;
+		return false;
+	}
+
+	if (interpQ) {
+		getInterpretationFields(field, subfield, model, infile, interps,
+				interpstate);
+		HumRegex hre;
+		string buffer = interps;
+		hre.replaceDestructive(buffer, "", "\\s+", "g");
+		m_streamInterps.clear();
+		stringstream ss(buffer);
+		string interp;
+		while (getline(ss, interp, ',')) {
+			if (!interp.empty()) {
+				m_streamInterps.push_back(interp);
+			}
+		}
+	} else if (fieldQ || excludeQ) {
+		fillFieldData(field, subfield, model, fieldstring, infile);
+	} else {
+		// extract all spines
+		field.resize(count);
+		for (int i=0; i<count; i++) {
+			field[i] = i + 1;
+		}
+		subfield.assign(count, 0);
+		model.assign(count, 0);
+	}
+
+	for (int i=0; i<(int)field.size(); i++) {
+		if (subfield[i] || model[i]) {
+			m_error_text << "Error: subspine extraction cannot be used with --stream"
+			             << endl;
+			return false;
+		}
+		if ((field[i] == 0) && addRestsQ) {
+			m_error_text << "Error: rest-filled spines cannot be used with --stream"
+			             << endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::printStreamFields -- Print the selected fields of a streamed
+//     line that does not contain spine manipulators.
+//
+
+void Tool_extract::printStreamFields(vector<string>& tokens) {
+	int start = 0;
+	for (int t=0; t<(int)field.size(); t++) {
+		int target = field[t];
+		if (target == 0) {
+			if (start != 0) {
+				m_humdrum_text << '\t';
+			}
+			start = 1;
+			const string& token = tokens[0];
+			if (token[0] == '!') {
+				m_humdrum_text << "!";
+			} else if (token[0] == '=') {
+				m_humdrum_text << token;
+			} else if (token[0] != '*') {
+				m_humdrum_text << ".";
+			} else if (token.compare(0, 2, "*>") == 0) {
+				// expansion labels and expansion lists
+				m_humdrum_text << token;
+			} else {
+				m_humdrum_text << "*";
+			}
+			continue;
+		}
+		for (int j=0; j<(int)tokens.size(); j++) {
+			if (m_streamTracks[j] != target) {
+				continue;
+			}
+			if (start != 0) {
+				m_humdrum_text << '\t';
+			}
+			start = 1;
+			m_humdrum_text << tokens[j];
+		}
+	}
+	if (start != 0) {
+		m_humdrum_text << '\n';
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::printStreamExcludedFields -- Print the fields of a
+//     streamed line which are not in the exclusion list.
+//
+
+void Tool_extract::printStreamExcludedFields(vector<string>& tokens) {
+	int start = 0;
+	for (int j=0; j<(int)tokens.size(); j++) {
+		if (isInList(m_streamTracks[j], field)) {
+			continue;
+		}
+		if (start != 0) {
+			m_humdrum_text << '\t';
+		}
+		start = 1;
+		m_humdrum_text << tokens[j];
+	}
+	if (start != 0) {
+		m_humdrum_text << '\n';
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::printStreamManipulatorFields -- Streaming equivalent of
+//     dealWithSpineManipulators() for field lists without subspines.
+//
+
+void Tool_extract::printStreamManipulatorFields(vector<string>& tokens) {
+	vector<int> vmanip(tokens.size(), 0);
+	vector<int> xmanip(tokens.size(), 0);
+	for (int j=0; j<(int)tokens.size(); j++) {
+		if (tokens[j] == "*v") {
+			vmanip[j] = 1;
+		}
+		if (tokens[j] == "*x") {
+			xmanip[j] = 1;
+		}
+	}
+
+	int counter = 1;
+	for (int i=1; i<(int)xmanip.size(); i++) {
+		if ((xmanip[i] == 1) && (xmanip[i-1] == 1)) {
+			xmanip[i] = counter;
+			xmanip[i-1] = counter;
+			counter++;
+		}
+	}
+
+	counter = 1;
+	int i = 0;
+	while (i < (int)vmanip.size()) {
+		if (vmanip[i] == 1) {
+			while ((i < (int)vmanip.size()) && (vmanip[i] == 1)) {
+				vmanip[i] = counter;
+				i++;
+			}
+			counter++;
+		}
+		i++;
+	}
+
+	vector<int> fieldoccur(field.size(), 0);
+	vector<int> trackcounter(m_streamMaxTrack + 1, 0);
+	for (int t=0; t<(int)field.size(); t++) {
+		if ((field[t] > 0) && (field[t] < (int)trackcounter.size())) {
+			trackcounter[field[t]]++;
+			fieldoccur[t] = trackcounter[field[t]];
+		}
+	}
+
+	vector<string> tempout;
+	vector<int> vserial;
+	vector<int> xserial;
+	tempout.reserve(tokens.size());
+	vserial.reserve(tokens.size());
+	xserial.reserve(tokens.size());
+
+	for (int t=0; t<(int)field.size(); t++) {
+		int target = field[t];
+		if (target == 0) {
+			if (tokens[0].compare(0, 2, "**") == 0) {
+				tempout.push_back(blankName);
+			} else if (tokens[0] == "*-") {
+				tempout.push_back("*-");
+			} else {
+				tempout.push_back("*");
+			}
+			vserial.push_back(0);
+			xserial.push_back(0);
+			continue;
+		}
+		for (int j=0; j<(int)tokens.size(); j++) {
+			if (m_streamTracks[j] != target) {
+				continue;
+			}
+			tempout.push_back(tokens[j]);
+			xserial.push_back(tokens[j] == "*x" ? fieldoccur[t] * 1000 + xmanip[j] : 0);
+			vserial.push_back(tokens[j] == "*v" ? fieldoccur[t] * 1000 + vmanip[j] : 0);
+		}
+	}
+
+	printManipulatorLine(tempout, vserial, xserial);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::updateStreamTracks -- Update the track numbers of the active
+//     spines after a line of spine manipulators.  Split spines keep the track
+//     of the parent spine, merged spines take the track of the first spine,
+//     and added spines are given a new track number.
+//
+
+void Tool_extract::updateStreamTracks(vector<string>& tokens) {
+	vector<int> newtracks;
+	newtracks.reserve(tokens.size() + 1);
+	int j = 0;
+	while (j < (int)tokens.size()) {
+		const string& token = tokens[j];
+		int track = m_streamTracks[j];
+		if (token == "*^") {
+			newtracks.push_back(track);
+			newtracks.push_back(track);
+		} else if (token == "*v") {
+			newtracks.push_back(track);
+			while ((j + 1 < (int)tokens.size()) && (tokens[j+1] == "*v")) {
+				j++;
+			}
+		} else if ((token == "*x") && (j + 1 < (int)tokens.size()) &&
+				(tokens[j+1] == "*x")) {
+			newtracks.push_back(m_streamTracks[j+1]);
+			newtracks.push_back(track);
+			j++;
+		} else if (token == "*+") {
+			newtracks.push_back(track);
+			newtracks.push_back(++m_streamMaxTrack);
+		} else if (token == "*-") {
+			// spine is terminated
+		} else {
+			newtracks.push_back(track);
+		}
+		j++;
+	}
+	m_streamTracks.swap(newtracks);
+}
+
+
+
 //////////////////////////////
 //
 // Tool_extract::processFile --
@@ -889,6 +1314,13 @@ void Tool_extract::processFieldEntry(vector<int>& field,
 
 	// convert kern tracks into spine tracks:
 	for (int i=finitsize; i<(int)field.size(); i++) {
+		if (field[i] > maxkerntrack) {
+			m_error_text << "Error: **kern spine " << field[i] << " does not exist" << endl;
+			field.resize(finitsize);
+			subfield.resize(finitsize);
+			model.resize(finitsize);
+			return;
+		}
 		if (field[i] > 0) {
 			spine = ktracks[field[i]-1]->getTrack();
 		   field[i] = spine;
@@ -1709,6 +2141,21 @@ void Tool_extract::dealWithSpineManipulators(HumdrumFile& infile, int line,
 		m_humdrum_text << "\n";
 	}
 
+	printManipulatorLine(tempout, vserial, xserial);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::printManipulatorLine -- Fix the *x and *v syntax of the
+//     extracted manipulator tokens and then print them.
+//
+
+void Tool_extract::printManipulatorLine(vector<string>& tempout,
+		vector<int>& vserial, vector<int>& xserial) {
+	int i;
+
 	// check for proper *x syntax /////////////////////////////////
 	for (i=0; i<(int)xserial.size()-1; i++) {
 		if (!xserial[i]) {
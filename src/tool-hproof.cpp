@@ -86,7 +86,7 @@ void Tool_hproof::markNonChordTones(HumdrumFile& infile) {
 		}
 	}
 	if (hlist.empty()) {
-		cerr << "Warning: No **harm or **rhrm spines in data" << endl;
+		m_warning_text << "Warning: No **harm or **rhrm spines in data" << endl;
 		return;
 	}
 
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Jul 29 11:38:01 CEST 2019
-// Last Modified: Sat Aug  3 17:48:04 EDT 2019
+// Last Modified: Sun Oct 18 19:20:44 PDT 2026
 // Filename:      humdiff.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/cli/humdiff.cpp
 // Syntax:        C++11
@@ -14,6 +14,7 @@
 #include "HumRegex.h"
 #include "Convert.h"
 
+#include <algorithm>
 #include <iostream>
 
 using namespace std;
@@ -34,6 +35,7 @@ Tool_humdiff::Tool_humdiff(void) {
 	define("time-points|times=b", "display timepoint lists for each file");
 	define("note-points|notes=b", "display notepoint lists for each file");
 	define("c|color=s:red",       "color for difference markers");
+	define("a|align=b",           "align files by measure and time-slice content (allows inserted or deleted measures)");
 }
 
 
@@ -63,20 +65,34 @@ bool Tool_humdiff::run(HumdrumFileSet& infiles) {
 		cerr << "Usage: " << getCommand() << " files" << endl;
 		return false;
 	} else {
+		bool alignQ = getBoolean("align");
 		HumNum targetdur = infiles[0].getScoreDuration();
 		for (int i=1; i<infiles.getSize(); i++) {
 			HumNum dur = infiles[i].getScoreDuration();
-			if (dur != targetdur) {
+			if ((dur != targetdur) && !alignQ) {
 				cerr << "Error: all files must have the same duration" << endl;
 				return false;
 			}
 		}
 
+		m_sliceIds.clear();
+		m_measureIds.clear();
+		SliceSequence refslices;
+		if (alignQ) {
+			extractSlices(refslices, infiles[reference]);
+		}
+
 		for (int i=0; i<infiles.getCount(); i++) {
 			if (i == reference) {
 				continue;
 			}
-			compareFiles(infiles[reference], infiles[i]);
+			if (alignQ) {
+				SliceSequence altslices;
+				extractSlices(altslices, infiles[i]);
+				alignFiles(refslices, altslices);
+			} else {
+				compareFiles(infiles[reference], infiles[i]);
+			}
 		}
 
 		if (!getBoolean("report")) {
@@ -117,6 +133,284 @@ void Tool_humdiff::compareFiles(HumdrumFile& reference, HumdrumFile& alternate)
 
 
 
+//////////////////////////////
+//
+// Tool_humdiff::extractSlices -- Extract the time points of a file, and
+//     give each time point and measure an id for its note content, so
+//     that files can be aligned by comparing ids.  The ids are shared by
+//     all files compared with the tool.
+//
+
+void Tool_humdiff::extractSlices(SliceSequence& slices, HumdrumFile& infile) {
+	slices.clear();
+	slices.file = &infile;
+	extractTimePoints(slices.timepoints, infile);
+	if (getBoolean("time-points")) {
+		printTimePoints(slices.timepoints);
+	}
+
+	// measure segment of each line (counting barlines):
+	vector<int> segments(infile.getLineCount(), 0);
+	int segment = 0;
+	for (int i=0; i<infile.getLineCount(); i++) {
+		if (infile[i].isBarline()) {
+			segment++;
+		}
+		segments[i] = segment;
+	}
+
+	vector<NotePoint> notelist;
+	vector<vector<int>> notes;
+	vector<int> content;
+	vector<int> measurecontent;
+	int lastsegment = -1;
+	for (int i=0; i<(int)slices.timepoints.size(); i++) {
+		int line = slices.timepoints[i].index.at(0);
+		HumNum position = infile[line].getDurationFromBarline();
+		if (segments[line] != lastsegment) {
+			if (i > 0) {
+				slices.measureids.push_back(getContentId(m_measureIds, measurecontent));
+			}
+			measurecontent.clear();
+			slices.measurestarts.push_back(i);
+			slices.measuretimes.push_back(slices.timepoints[i].timestamp - position);
+			lastsegment = segments[line];
+		}
+
+		notelist.clear();
+		getNoteList(notelist, infile, line, slices.timepoints[i].measure, 0, i);
+		notes.resize(notelist.size());
+		for (int j=0; j<(int)notelist.size(); j++) {
+			notes[j] = { notelist[j].b40, notelist[j].duration.getNumerator(),
+					notelist[j].duration.getDenominator() };
+		}
+		sort(notes.begin(), notes.end());
+
+		content.clear();
+		content.push_back(position.getNumerator());
+		content.push_back(position.getDenominator());
+		for (int j=0; j<(int)notes.size(); j++) {
+			content.insert(content.end(), notes[j].begin(), notes[j].end());
+		}
+		int id = getContentId(m_sliceIds, content);
+		slices.sliceids.push_back(id);
+		measurecontent.push_back(id);
+	}
+	if (!slices.timepoints.empty()) {
+		slices.measureids.push_back(getContentId(m_measureIds, measurecontent));
+	}
+	slices.measurestarts.push_back((int)slices.timepoints.size());
+}
+
+
+
+//////////////////////////////
+//
+// Tool_humdiff::getContentId -- Return the id for the given content,
+//     adding a new id if the content has not been seen before.
+//
+
+int Tool_humdiff::getContentId(map<vector<int>, int>& ids,
+		const vector<int>& content) {
+	auto it = ids.find(content);
+	if (it != ids.end()) {
+		return it->second;
+	}
+	int id = (int)ids.size();
+	ids[content] = id;
+	return id;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_humdiff::alignFiles -- Align the measures of two files by their
+//     content ids.  Measures which are the same in both files have no
+//     differences to mark, so only the regions between them are compared
+//     in more detail.
+//
+
+void Tool_humdiff::alignFiles(SliceSequence& reference, SliceSequence& alternate) {
+	vector<pair<int, int>> matches;
+	int rcount = (int)reference.measureids.size();
+	int acount = (int)alternate.measureids.size();
+	diffSequences(matches, reference.measureids, 0, rcount,
+			alternate.measureids, 0, acount);
+
+	int r = 0;
+	int a = 0;
+	for (int i=0; i<=(int)matches.size(); i++) {
+		int rnext = i < (int)matches.size() ? matches[i].first  : rcount;
+		int anext = i < (int)matches.size() ? matches[i].second : acount;
+		if (r < rnext) {
+			// measures in the reference which are changed or missing
+			// in the alternate:
+			HumNum rbase = reference.measuretimes.at(r);
+			HumNum abase = a < acount ? alternate.measuretimes.at(a) :
+					alternate.file->getScoreDuration();
+			compareRegion(reference, reference.measurestarts.at(r),
+					reference.measurestarts.at(rnext), rbase, alternate,
+					alternate.measurestarts.at(a), alternate.measurestarts.at(anext),
+					abase);
+		}
+		r = rnext + 1;
+		a = anext + 1;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_humdiff::compareRegion -- Align the time points in a range of
+//     measures which differ between the two files.  Time points with the
+//     same content (including position in the measure) are matched, and
+//     the runs of time points between them are compared note by note.
+//     rbase and abase are the starting times of the region in each file.
+//
+
+void Tool_humdiff::compareRegion(SliceSequence& reference, int r1, int r2,
+		HumNum rbase, SliceSequence& alternate, int a1, int a2, HumNum abase) {
+	vector<pair<int, int>> matches;
+	diffSequences(matches, reference.sliceids, r1, r2, alternate.sliceids, a1, a2);
+
+	int r = r1;
+	int a = a1;
+	for (int i=0; i<=(int)matches.size(); i++) {
+		int rnext = i < (int)matches.size() ? matches[i].first  : r2;
+		int anext = i < (int)matches.size() ? matches[i].second : a2;
+		if (r < rnext) {
+			compareRun(reference, r, rnext, rbase, alternate, a, anext, abase);
+		}
+		if (i < (int)matches.size()) {
+			rbase = reference.timepoints.at(rnext).timestamp;
+			abase = alternate.timepoints.at(anext).timestamp;
+		}
+		r = rnext + 1;
+		a = anext + 1;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_humdiff::compareRun -- Compare the notes of time points in the two
+//     files which occur at the same time after the start of the run
+//     (rbase and abase), marking notes in the reference which do not
+//     have a match.
+//
+
+void Tool_humdiff::compareRun(SliceSequence& reference, int r1, int r2,
+		HumNum rbase, SliceSequence& alternate, int a1, int a2, HumNum abase) {
+	vector<vector<TimePoint>> timepoints(2);
+	for (int i=r1; i<r2; i++) {
+		timepoints[0].push_back(reference.timepoints.at(i));
+		timepoints[0].back().timestamp -= rbase;
+	}
+	for (int i=a1; i<a2; i++) {
+		timepoints[1].push_back(alternate.timepoints.at(i));
+		timepoints[1].back().timestamp -= abase;
+	}
+	compareTimePoints(timepoints, *reference.file, *alternate.file);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_humdiff::diffSequences -- Find the longest common subsequence of
+//     a[a1..a2) and b[b1..b2) with Myers' O(ND) difference algorithm, so
+//     that the time depends on the number of differences D.  The matched
+//     index pairs are stored in increasing order.  If the sequences have
+//     too many differences, only their common prefix and suffix are
+//     matched, and false is returned.
+//
+
+bool Tool_humdiff::diffSequences(vector<pair<int, int>>& matches,
+		const vector<int>& a, int a1, int a2, const vector<int>& b, int b1,
+		int b2) {
+	matches.clear();
+	vector<pair<int, int>> suffix;
+	while ((a1 < a2) && (b1 < b2) && (a[a1] == b[b1])) {
+		matches.emplace_back(a1++, b1++);
+	}
+	while ((a1 < a2) && (b1 < b2) && (a[a2-1] == b[b2-1])) {
+		suffix.emplace_back(--a2, --b2);
+	}
+
+	bool status = true;
+	int n = a2 - a1;
+	int m = b2 - b1;
+	if ((n > 0) && (m > 0)) {
+		// trace[d][k+d+1]: furthest x reached on diagonal k (x-y) before
+		// step d.
+		const int maxd = 2000;
+		int offset = n + m + 1;
+		vector<int> v(2 * offset + 1, 0);
+		vector<vector<int>> trace;
+		bool done = false;
+		for (int d=0; (d <= n + m) && !done; d++) {
+			if (d > maxd) {
+				status = false;
+				break;
+			}
+			trace.emplace_back(v.begin() + offset - d - 1, v.begin() + offset + d + 2);
+			for (int k=-d; k<=d; k+=2) {
+				int x;
+				if ((k == -d) || ((k != d) && (v[offset+k-1] < v[offset+k+1]))) {
+					x = v[offset+k+1];
+				} else {
+					x = v[offset+k-1] + 1;
+				}
+				int y = x - k;
+				while ((x < n) && (y < m) && (a[a1+x] == b[b1+y])) {
+					x++;
+					y++;
+				}
+				v[offset+k] = x;
+				if ((x >= n) && (y >= m)) {
+					done = true;
+					break;
+				}
+			}
+		}
+
+		if (status) {
+			// Follow the edit path back from the end to collect the diagonals:
+			vector<pair<int, int>> middle;
+			int x = n;
+			int y = m;
+			for (int d=(int)trace.size()-1; d>=0; d--) {
+				vector<int>& t = trace[d];
+				int k = x - y;
+				int prevk;
+				if ((k == -d) || ((k != d) && (t[k-1+d+1] < t[k+1+d+1]))) {
+					prevk = k + 1;
+				} else {
+					prevk = k - 1;
+				}
+				int prevx = t[prevk+d+1];
+				int prevy = prevx - prevk;
+				while ((x > prevx) && (y > prevy)) {
+					x--;
+					y--;
+					middle.emplace_back(a1 + x, b1 + y);
+				}
+				x = prevx;
+				y = prevy;
+			}
+			matches.insert(matches.end(), middle.rbegin(), middle.rend());
+		}
+	}
+
+	matches.insert(matches.end(), suffix.rbegin(), suffix.rend());
+	return status;
+}
+
+
+
 //////////////////////////////
 //
 // Tool_humdiff::printTimePoints --
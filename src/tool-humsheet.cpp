@@ -227,7 +227,7 @@ void Tool_humsheet::printRowClasses(HumdrumFile& infile, int row) {
 	}
 	HTp token = hl->token(0);
 	if (token->compare(0, 2, "!!") == 0) {
-		if ((token->size() == 2) || (token->at(3) != '!')) {
+		if ((token->size() == 2) || (token->at(2) != '!')) {
 			classes += "gcommet ";
 		}
 	}
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Jun 17 15:24:23 CEST 2017
-// Last Modified: Fri Aug 11 18:25:50 EDT 2017
+// Last Modified: Sun Oct 18 23:59:48 PDT 2026
 // Filename:      tool-imitation.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-imitation.cpp
 // Syntax:        C++11; humlib
@@ -35,7 +35,119 @@ namespace hum {
 // START_MERGE
 
 
-int Tool_imitation::Enumerator = 0;
+//////////////////////////////
+//
+// ImitationSequenceIndex::build -- Create a suffix array of the symbol
+//     sequences (non-negative integers), the longest common prefix of
+//     suffixes adjacent in the array, and a range-minimum table of the
+//     common prefix lengths.
+//
+
+void ImitationSequenceIndex::build(vector<vector<int>>& sequences) {
+	// Concatenate the sequences with a unique (negative) separator
+	// after each one, so that no common prefix crosses sequences:
+	vector<int> text;
+	m_offsets.resize(sequences.size());
+	for (int i=0; i<(int)sequences.size(); i++) {
+		m_offsets.at(i) = (int)text.size();
+		text.insert(text.end(), sequences.at(i).begin(), sequences.at(i).end());
+		text.push_back(-1 - i);
+	}
+	int n = (int)text.size();
+	m_rank.resize(n);
+	m_minimums.clear();
+	if (n == 0) {
+		return;
+	}
+
+	// Suffix array by prefix doubling:
+	vector<int> suffixes(n);
+	vector<int> newrank(n);
+	for (int i=0; i<n; i++) {
+		suffixes[i] = i;
+		m_rank[i] = text[i];
+	}
+	for (int k=1; ; k *= 2) {
+		auto lessthan = [&](int a, int b) {
+			if (m_rank[a] != m_rank[b]) {
+				return m_rank[a] < m_rank[b];
+			}
+			int ra = a + k < n ? m_rank[a + k] : -1;
+			int rb = b + k < n ? m_rank[b + k] : -1;
+			return ra < rb;
+		};
+		sort(suffixes.begin(), suffixes.end(), lessthan);
+		newrank[suffixes[0]] = 0;
+		for (int i=1; i<n; i++) {
+			newrank[suffixes[i]] = newrank[suffixes[i-1]] +
+					(lessthan(suffixes[i-1], suffixes[i]) ? 1 : 0);
+		}
+		m_rank = newrank;
+		if (m_rank[suffixes[n-1]] == n - 1) {
+			break;
+		}
+	}
+
+	// Common prefix length of each suffix with the previous one in the
+	// suffix array (Kasai's algorithm):
+	vector<int> lcp(n, 0);
+	int h = 0;
+	for (int i=0; i<n; i++) {
+		if (m_rank[i] == 0) {
+			h = 0;
+			continue;
+		}
+		int j = suffixes[m_rank[i] - 1];
+		while ((i + h < n) && (j + h < n) && (text[i + h] == text[j + h])) {
+			h++;
+		}
+		lcp[m_rank[i]] = h;
+		if (h > 0) {
+			h--;
+		}
+	}
+
+	// Sparse table for range minimums of the prefix lengths:
+	m_minimums.push_back(lcp);
+	for (int k=1; (1 << k) <= n; k++) {
+		vector<int>& previous = m_minimums.back();
+		vector<int> current(n - (1 << k) + 1);
+		for (int i=0; i<(int)current.size(); i++) {
+			current[i] = std::min(previous[i], previous[i + (1 << (k - 1))]);
+		}
+		m_minimums.push_back(current);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// ImitationSequenceIndex::getMatchLength -- Return the number of equal
+//     symbols at the start of two positions in the sequences.
+//
+
+int ImitationSequenceIndex::getMatchLength(int seq1, int index1, int seq2,
+		int index2) const {
+	int a = m_rank.at(m_offsets.at(seq1) + index1);
+	int b = m_rank.at(m_offsets.at(seq2) + index2);
+	if (a == b) {
+		// same position
+		int end = seq1 + 1 < (int)m_offsets.size() ? m_offsets.at(seq1 + 1) :
+				(int)m_rank.size();
+		return end - 1 - m_offsets.at(seq1) - index1;
+	}
+	if (a > b) {
+		std::swap(a, b);
+	}
+	a++;
+	int k = 0;
+	while ((1 << (k + 1)) <= b - a + 1) {
+		k++;
+	}
+	return std::min(m_minimums[k][a], m_minimums[k][b - (1 << k) + 1]);
+}
+
 
 
 /////////////////////////////////
@@ -121,16 +233,20 @@ bool Tool_imitation::run(HumdrumFile& infile, ostream& out) {
 
 
 bool Tool_imitation::run(HumdrumFile& infile) {
-	Enumerator = 0;
+	m_enumerator = 0;
 
 	NoteGrid grid(infile);
+	if (grid.getVoiceCount() == 0) {
+		// no **kern spines, or spine structure that the grid cannot handle
+		return false;
+	}
 
 	if (getBoolean("debug")) {
 		grid.printGridInfo(cerr);
 		// return 1;
 	}
 
-	Enumerator = 0;
+	m_enumerator = 0;
 	m_threshold = getInteger("threshold") + 1;
 	if (m_threshold < 3) {
 		m_threshold = 3;
@@ -226,7 +342,7 @@ bool Tool_imitation::run(HumdrumFile& infile) {
 			infile.insertDataSpineBefore(track, results.at(i-1), "", exinterp);
 		}
 	}
-	if (m_mark && Enumerator) {
+	if (m_mark && m_enumerator) {
 		string rdfline = "!!!RDF**kern: ";
 		rdfline += m_marker;
 		rdfline += " = marked note (color=\"chocolate\")";
@@ -272,6 +388,8 @@ void Tool_imitation::doAnalysis(vector<vector<string> >& results,
 		getIntervals(intervals.at(i), attacks.at(i));
 	}
 
+	buildSequenceIndex(attacks, intervals);
+
 	for (int i=0; i<(int)attacks.size(); i++) {
 		for (int j=i+1; j<(int)attacks.size(); j++) {
 			analyzeImitation(results, attacks, intervals, i, j);
@@ -305,6 +423,69 @@ void Tool_imitation::getIntervals(vector<double>& intervals,
 
 
 
+//////////////////////////////
+//
+// Tool_imitation::buildSequenceIndex -- Convert the interval sequence of
+//     each voice into a list of integer symbols, one for each note, which
+//     are equal when compareSequences() would continue a match (the
+//     interval to the next note, or a rest, and the duration of the note
+//     if durations are also being matched).  When searching for
+//     inversions, the negated intervals of each voice are added after the
+//     original sequences.  A suffix array of all sequences is then used to
+//     find the length of the match between any two notes.
+//
+
+void Tool_imitation::buildSequenceIndex(vector<vector<NoteCell*>>& attacks,
+		vector<vector<double>>& intervals) {
+	map<std::tuple<bool, double, int, int>, int> symbols;
+	int voiceCount = (int)attacks.size();
+	m_sequences.resize(m_inversion ? 2 * voiceCount : voiceCount);
+	for (int v=0; v<(int)m_sequences.size(); v++) {
+		int voice = v % voiceCount;
+		double sign = v < voiceCount ? 1.0 : -1.0;
+		vector<int>& sequence = m_sequences.at(v);
+		sequence.resize(intervals.at(voice).size());
+		for (int i=0; i<(int)sequence.size(); i++) {
+			HumNum duration = attacks.at(voice).at(i)->getDuration();
+			sequence.at(i) = getSymbol(symbols, sign * intervals.at(voice).at(i), duration);
+		}
+	}
+	m_sequenceIndex.build(m_sequences);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_imitation::getSymbol -- Return the symbol for an interval and
+//     duration, adding a new symbol if it has not been seen before.
+//
+
+int Tool_imitation::getSymbol(map<std::tuple<bool, double, int, int>, int>& symbols,
+		double interval, HumNum duration) {
+	bool restQ = Convert::isNaN(interval);
+	if (restQ) {
+		interval = 0.0;
+	} else if (interval == 0.0) {
+		// -0.0 from inversions
+		interval = 0.0;
+	}
+	if (!m_duration) {
+		duration = 0;
+	}
+	std::tuple<bool, double, int, int> key(restQ, interval, duration.getNumerator(),
+			duration.getDenominator());
+	auto it = symbols.find(key);
+	if (it != symbols.end()) {
+		return it->second;
+	}
+	int symbol = (int)symbols.size();
+	symbols[key] = symbol;
+	return symbol;
+}
+
+
+
 //////////////////////////////
 //
 // Tool_imitation::analyzeImitation -- do imitation analysis between two voices.
@@ -325,14 +506,34 @@ void Tool_imitation::analyzeImitation(vector<vector<string>>& results,
 	vector<int> enum1(v1a.size(), 0);
 	vector<int> enum2(v2a.size(), 0);
 
+	// Notes in the second voice grouped by their first symbol: only notes
+	// starting with the same symbol as a note in the first voice can
+	// start a match with it.
+	int s1 = v1;
+	int s2 = m_inversion ? v2 + (int)attacks.size() : v2;
+	map<int, vector<int>> starts;
+	for (int j=0; j<(int)v2i.size() - 1; j++) {
+		starts[m_sequences.at(s2).at(j)].push_back(j);
+	}
+
 	for (int i=0; i<(int)v1i.size() - 1; i++) {
 		count = 0;
-		for (int j=0; j<(int)v2i.size() - 1; j++) {
-			if (m_rest || m_rest2) {
-				if ((i > 0) && (!Convert::isNaN(attacks.at(v1).at(i-1)->getSgnDiatonicPitch()))) {
-					// match initiator must be preceded by a rest (or start of music)
-					continue;
-				}
+		if (m_rest || m_rest2) {
+			if ((i > 0) && (!Convert::isNaN(attacks.at(v1).at(i-1)->getSgnDiatonicPitch()))) {
+				// match initiator must be preceded by a rest (or start of music)
+				continue;
+			}
+		}
+		auto found = starts.find(m_sequences.at(s1).at(i));
+		if (found == starts.end()) {
+			continue;
+		}
+		vector<int>& candidates = found->second;
+		int nextj = 0; // notes before nextj are skipped after a match
+		for (int c=0; c<(int)candidates.size(); c++) {
+			int j = candidates.at(c);
+			if (j < nextj) {
+				continue;
 			}
 			if (m_rest2) {
 				if ((j > 0) && (!Convert::isNaN(attacks.at(v2).at(j-1)->getSgnDiatonicPitch()))) {
@@ -344,12 +545,13 @@ void Tool_imitation::analyzeImitation(vector<vector<string>>& results,
 				// avoid re-matching an existing match as a submatch
 				continue;
 			}
-			count = compareSequences(v1a, v1i, i, v2a, v2i, j);
+			int length = m_sequenceIndex.getMatchLength(s1, i, s2, j);
+			count = compareSequences(v1a, v1i, i, v2a, v2i, j, length);
 			if ((count >= min) && (m_intervals.size() > 0)) {
 				count = checkForIntervalSequence(m_intervals, v1i, i, count);
 			}
 			if (count < min) {
-				j += count;
+				nextj = j + count + 1;
 				continue;
 			}
 
@@ -362,14 +564,14 @@ void Tool_imitation::analyzeImitation(vector<vector<string>>& results,
 			HumNum distance2 = time1 - time2;
 
 			if (m_maxdistanceQ && (distance1.getAbs().getFloat() > m_maxdistance)) {
-				j += count;
+				nextj = j + count + 1;
 				continue;
 			}
 
-			Enumerator++;
+			m_enumerator++;
 			for (int k=0; k<count; k++) {
-				enum1.at(i+k) = Enumerator;
-				enum2.at(j+k) = Enumerator;
+				enum1.at(i+k) = m_enumerator;
+				enum2.at(j+k) = m_enumerator;
 			}
 
 			int interval = int(*attacks.at(v2).at(j) - *attacks.at(v1).at(i));
@@ -392,7 +594,7 @@ void Tool_imitation::analyzeImitation(vector<vector<string>>& results,
 						} else {
 							results.at(v1).at(line1) += "n";
 						}
-						results.at(v1).at(line1) += to_string(Enumerator);
+						results.at(v1).at(line1) += to_string(m_enumerator);
 					}
 
 					if (m_measure) {
@@ -499,7 +701,7 @@ void Tool_imitation::analyzeImitation(vector<vector<string>>& results,
 						} else {
 							results.at(v2).at(line2) += "n";
 						}
-						results.at(v2).at(line2) += to_string(Enumerator);
+						results.at(v2).at(line2) += to_string(m_enumerator);
 					}
 
 					if (m_measure) {
@@ -626,7 +828,7 @@ void Tool_imitation::analyzeImitation(vector<vector<string>>& results,
 			}
 
 			// skip over match (need to do in i as well somehow)
-			j += count;
+			nextj = j + count + 1;
 		} // j loop
 	} // i loop
 }
@@ -683,12 +885,13 @@ int Tool_imitation::checkForIntervalSequence(vector<int>& m_intervals,
 //
 // Tool_imitation::compareSequences -- Returns the number of notes that
 //     match between the two sequences (which is one more than the
-//     interval count).
+//     interval count).  The length is the number of matching symbols
+//     at the start of the sequences from the sequence index.
 //
 
 int Tool_imitation::compareSequences(vector<NoteCell*>& attack1,
 		vector<double>& seq1, int i1, vector<NoteCell*>& attack2,
-		vector<double>& seq2, int i2) {
+		vector<double>& seq2, int i2, int length) {
 	int count = 0;
 	// sequences cannot start with rests
 	if (Convert::isNaN(seq1.at(i1)) || Convert::isNaN(seq2.at(i2))) {
@@ -706,64 +909,25 @@ int Tool_imitation::compareSequences(vector<NoteCell*>& attack1,
 		}
 	}
 
-	HumNum dur1;
-	HumNum dur2;
-
-	while ((i1+count < (int)seq1.size()) && (i2+count < (int)seq2.size())) {
-
-		if (m_duration) {
-			dur1 = attack1.at(i1+count)->getDuration();
-			dur2 = attack2.at(i2+count)->getDuration();
-			if (dur1 != dur2) {
-				break;
-			}
-		}
+	count = length;
+	if ((i1+count >= (int)seq1.size()) || (i2+count >= (int)seq2.size())) {
+		// One of the sequences ended while matching.
+		return count;
+	}
 
-		if (Convert::isNaN(seq1.at(i1+count))) {
-			// the first voice's interval is to/from a rest
-			if (Convert::isNaN(seq2.at(i2+count))) {
-				// The seoncd voice's interval is also to/from a rest,
-				// so increment count and continue.
-				count++;
-				continue;
-			} else {
-				// The second voice's interval is not to/from a rest,
-				// so return the current count.
-				if (count) {
-					return count + 1;
-				} else {
-					return count;
-				}
-			}
-		} else if (Convert::isNaN(seq2.at(i2+count))) {
-			// The second voice's interval is to/from a rest
-			// but already know that the first one is not, so return
-			// current count;
-			if (count) {
-				return count + 1;
-			} else {
-				return count;
-			}
-		} else if (m_inversion && (seq1.at(i1+count) == -seq2.at(i2+count))) {
-         // The two sequences match as inversions at this point, so continue.
-			count++;
-		} else if ((!m_inversion) && (seq1.at(i1+count) == seq2.at(i2+count))) {
-         // The two sequences match at this point, so continue.
-			count++;
-			continue;
-		} else {
-			// The sequences do not match so return the current count.
-			if (count) {
-				return count + 1;
-			} else {
-				return count;
-			}
+	if (m_duration) {
+		HumNum dur1 = attack1.at(i1+count)->getDuration();
+		HumNum dur2 = attack2.at(i2+count)->getDuration();
+		if (dur1 != dur2) {
+			// The match ends at a note with a different duration.
+			return count;
 		}
 	}
 
+	// The intervals (or rests) do not match, so include the note at
+	// the end of the last matching interval.
 	if (count) {
-		// don't add one for some reaason (this will cause out-of-bounds)
-		return count;
+		return count + 1;
 	} else {
 		return count;
 	}
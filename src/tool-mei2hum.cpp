@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Wed Sep 13 14:58:26 PDT 2017
-// Last Modified: Tue Mar  9 22:03:56 PST 2021
+// Last Modified: Sun Oct 18 22:37:15 PDT 2026
 // Filename:      mei2hum.cpp
 // URL:           https://github.com/craigsapp/mei2hum/blob/master/src/mei2hum.cpp
 // Syntax:        C++11; humlib
@@ -96,10 +96,10 @@ bool Tool_mei2hum::convertFile(ostream& out, const char* filename) {
 	xml_document doc;
 	auto result = doc.load_file(filename);
 	if (!result) {
-		cerr << "\nXML file [" << filename << "] has syntax errors\n";
-		cerr << "Error description:\t" << result.description() << "\n";
-		cerr << "Error offset:\t" << result.offset << "\n\n";
-		exit(1);
+		m_error_text << "\nXML file [" << filename << "] has syntax errors\n";
+		m_error_text << "Error description:\t" << result.description() << "\n";
+		m_error_text << "Error offset:\t" << result.offset << "\n\n";
+		return false;
 	}
 
 	return convert(out, doc);
@@ -116,10 +116,10 @@ bool Tool_mei2hum::convert(ostream& out, const char* input) {
 	xml_document doc;
 	auto result = doc.load_string(input);
 	if (!result) {
-		cout << "\nXML content has syntax errors\n";
-		cout << "Error description:\t" << result.description() << "\n";
-		cout << "Error offset:\t" << result.offset << "\n\n";
-		exit(1);
+		m_error_text << "\nXML content has syntax errors\n";
+		m_error_text << "Error description:\t" << result.description() << "\n";
+		m_error_text << "Error offset:\t" << result.offset << "\n\n";
+		return false;
 	}
 
 	return convert(out, doc);
@@ -2488,7 +2488,9 @@ HumNum Tool_mei2hum::parseNote(xml_node note, xml_node chord, string& output,
 		output += tok;
 	}
 
-	if (m_xmlidQ) {
+	if (m_xmlidQ && dataslice) {
+		// Chord notes do not have their own slice (the chord is
+		// added to the grid in parseChord()).
 		GridStaff* staff = dataslice->at(m_currentStaff-1)->at(0);
 		// not keeping track of overwriting ids at the moment:
 		string xmlid = note.attribute("xml:id").value();
@@ -2659,7 +2661,9 @@ HumNum Tool_mei2hum::parseNote_mensural(xml_node note, xml_node chord, string& o
 		output += tok;
 	}
 
-	if (m_xmlidQ) {
+	if (m_xmlidQ && dataslice) {
+		// Chord notes do not have their own slice (the chord is
+		// added to the grid in parseChord()).
 		GridStaff* staff = dataslice->at(m_currentStaff-1)->at(0);
 		// not keeping track of overwriting ids at the moment:
 		string xmlid = note.attribute("xml:id").value();
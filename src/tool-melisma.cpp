@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug 24 17:50:06 EDT 2019
-// Last Modified: Sat Aug 24 17:50:08 EDT 2019
+// Last Modified: Sun Oct 18 21:27:33 PDT 2026
 // Filename:      tool-melisma.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-melisma.cpp
 // Syntax:        C++11; humlib
@@ -646,7 +646,8 @@ void Tool_melisma::replaceLyrics(HumdrumFile& infile, vector<vector<int>>& count
 
 //////////////////////////////
 //
-// Tool_melisma::getNoteCounts --
+// Tool_melisma::getNoteCounts -- Get the number of notes for each syllable
+//     of the **text spines from the text table of the file.
 //
 
 void Tool_melisma::getNoteCounts(HumdrumFile& infile, vector<vector<int>>& counts) {
@@ -654,10 +655,11 @@ void Tool_melisma::getNoteCounts(HumdrumFile& infile, vector<vector<int>>& count
 	initBarlines(infile);
 	HumNum negativeOne = -1;
 	infile.initializeArray(m_endtimes, negativeOne);
-	vector<HTp> lyrics;
-	infile.getSpineStartList(lyrics, "**text");
-	for (int i=0; i<(int)lyrics.size(); i++) {
-		getNoteCountsForLyric(counts, lyrics[i]);
+	const HumTextTable& table = infile.getTextTable();
+	for (int i=0; i<table.getSpineCount(); i++) {
+		if (*table.getSpineStart(i) == "**text") {
+			getNoteCountsForLyric(counts, table, i);
+		}
 	}
 }
 
@@ -692,21 +694,15 @@ void Tool_melisma::initBarlines(HumdrumFile& infile) {
 // Tool_melisma::getNoteCountsForLyric --
 //
 
-void Tool_melisma::getNoteCountsForLyric(vector<vector<int>>& counts, HTp lyricStart) {
-	HTp current = lyricStart;
-	while (current) {
-		if (!current->isData()) {
-			current = current->getNextToken();
-			continue;
-		}
-		if (current->isNull()) {
-			current = current->getNextToken();
-			continue;
-		}
-		int line = current->getLineIndex();
-		int field = current->getFieldIndex();
-		counts[line][field] = getCountForSyllable(current);
-		current = current->getNextToken();
+void Tool_melisma::getNoteCountsForLyric(vector<vector<int>>& counts,
+		const HumTextTable& table, int spine) {
+	int start = table.getSpineSyllableStart(spine);
+	int count = table.getSpineSyllableCount(spine);
+	for (int i=start; i<start+count; i++) {
+		HTp token = table.getSyllableToken(i);
+		int line = token->getLineIndex();
+		int field = token->getFieldIndex();
+		counts[line][field] = getCountForSyllable(table, i);
 	}
 }
 
@@ -714,76 +710,24 @@ void Tool_melisma::getNoteCountsForLyric(vector<vector<int>>& counts, HTp lyricS
 
 //////////////////////////////
 //
-// Tool_melisma::getCountForSyllable --
+// Tool_melisma::getCountForSyllable -- Return the number of notes for a
+//     syllable and store the end time of its last note.  Syllables ending
+//     in "&" (elisions) are counted as one note.
 //
 
-int Tool_melisma::getCountForSyllable(HTp token) {
+int Tool_melisma::getCountForSyllable(const HumTextTable& table, int syllable) {
+	HTp token = table.getSyllableToken(syllable);
 	if (token->back() == '&') {
 		return 1;
 	}
-	HTp nexttok = token->getNextToken();
-	int eline   = token->getLineIndex();
-	int efield  = token->getFieldIndex();
-	m_endtimes[eline][efield] = token->getDurationFromStart() + token->getDuration();
-	while (nexttok) {
-		if (!nexttok->isData()) {
-			nexttok = nexttok->getNextToken();
-			continue;
-		}
-		if (nexttok->isNull()) {
-			nexttok = nexttok->getNextToken();
-			continue;
-		}
-		// found non-null data token
-		break;
-	}
-
-	HumdrumFile& infile = *token->getOwner()->getOwner();
-	int endline = infile.getLineCount() - 1;
-	if (nexttok) {
-		endline = nexttok->getLineIndex();
-	}
-	int output = 0;
-	HTp current = token->getPreviousFieldToken();
-	while (current) {
-		if (current->isKern()) {
-			break;
-		}
-		current = current->getPreviousFieldToken();
-	}
-	if (!current) {
-		return 0;
-	}
-	while (current) {
-		if (!current->isData()) {
-			current = current->getNextToken();
-			continue;
-		}
-		if (current->isNull()) {
-			current = current->getNextToken();
-			continue;
-		}
-		if (current->isRest()) {
-			current = current->getNextToken();
-			continue;
-		}
-		if (!current->isNoteAttack()) {
-			// ignore tied notes
-			m_endtimes[eline][efield] = current->getDurationFromStart() + current->getDuration();
-			current = current->getNextToken();
-			continue;
-		}
-		int line = current->getLineIndex();
-		if (line < endline) {
-			m_endtimes[eline][efield] = current->getDurationFromStart() + current->getDuration();
-			output++;
-		} else {
-			break;
-		}
-		current = current->getNextToken();
+	int eline  = token->getLineIndex();
+	int efield = token->getFieldIndex();
+	if (table.getLastNote(syllable)) {
+		m_endtimes[eline][efield] = table.getEndTime(syllable);
+	} else {
+		m_endtimes[eline][efield] = token->getDurationFromStart() + token->getDuration();
 	}
-
-	return output;
+	return table.getNoteCount(syllable);
 }
 
 
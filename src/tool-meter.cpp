@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Tue Sep 12 13:31:48 PDT 2023
-// Last Modified: Mon Sep 18 10:45:14 PDT 2023
+// Last Modified: Sun Oct 18 21:04:18 PDT 2026
 // Filename:      tool-meter.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-meter.cpp
 // Syntax:        C++11; humlib
@@ -706,19 +706,18 @@ int Tool_meter::printKernAndAnalysisSpine(HumdrumLine& line, int index, bool pri
 
 //////////////////////////////
 //
-// Tool_meter::getMeterData --
+// Tool_meter::getMeterData -- The time signature and *beat: states of
+//     each track are read from the metric grid of the file.
 //
 
 void Tool_meter::getMeterData(HumdrumFile& infile) {
 
 	int maxtrack = infile.getMaxTrack();
-	vector<HumNum> curNum(maxtrack + 1, 0);
-	vector<HumNum> curDen(maxtrack + 1, 0);
-	vector<HumNum> curBeat(maxtrack + 1, 0);
 	vector<HumNum> curBarTime(maxtrack + 1, 0);
+	const HumMetricTable& grid = infile.getMetricGrid();
 
 	for (int i=0; i<infile.getLineCount(); i++) {
-		processLine(infile[i], curNum, curDen, curBeat, curBarTime);
+		processLine(infile[i], grid, curBarTime);
 	}
 }
 
@@ -729,8 +728,7 @@ void Tool_meter::getMeterData(HumdrumFile& infile) {
 // Tool_meter::processLine --
 //
 
-void Tool_meter::processLine(HumdrumLine& line, vector<HumNum>& curNum,
-		vector<HumNum>& curDen, vector<HumNum>& curBeat,
+void Tool_meter::processLine(HumdrumLine& line, const HumMetricTable& grid,
 		vector<HumNum>& curBarTime) {
 
 	int fieldCount = line.getFieldCount();
@@ -757,30 +755,8 @@ void Tool_meter::processLine(HumdrumLine& line, vector<HumNum>& curNum,
 		return;
 	}
 
-	if (line.isInterpretation()) {
-		// check for time signatures
-		for (int i=0; i<fieldCount; i++) {
-			HTp token = line.token(i);
-			if (!token->isKern()) {
-				continue;
-			}
-			if (hre.search(token, "^\\*M(\\d+)/(\\d+)")) {
-				int top = hre.getMatchInt(1);
-				int bot = hre.getMatchInt(2);
-				int track = token->getTrack();
-				curNum.at(track) = top;
-				curDen.at(track) = bot;
-				curBeat.at(track) = 0;
-			} else if (hre.search(token, "^\\*beat:\\s*([\\d.%]+)\\s*$")) {
-				int track = token->getTrack();
-				string recip = hre.getMatch(1);
-				curBeat.at(track) = Convert::recipToDuration(recip);
-			}
-		}
-		return;
-	}
-
 	if (line.isData()) {
+		int lineIndex = line.getLineIndex();
 		// check for time signatures
 		for (int i=0; i<fieldCount; i++) {
 			HTp token = line.token(i);
@@ -798,18 +774,21 @@ void Tool_meter::processLine(HumdrumLine& line, vector<HumNum>& curNum,
 			}
 			int pickup = token->getValueInt("auto", "pickup");
 			int track = token->getTrack();
+			HumNum curNum  = grid.getMeterTop(lineIndex, track);
+			HumNum curDen  = grid.getMeterBottom(lineIndex, track);
+			HumNum curBeat = grid.getExplicitBeat(lineIndex, track);
 			stringstream value;
 			value.str("");
-			value << curNum.at(track);
+			value << curNum;
 			token->setValue("auto", "numerator", value.str());
 			value.str("");
-			value << curDen.at(track);
+			value << curDen;
 			token->setValue("auto", "denominator", value.str());
 			HumNum curTime = token->getDurationFromStart();
 			HumNum q;
 			if (pickup) {
-				HumNum meterDur = curNum.at(track);
-				meterDur /= curDen.at(track);
+				HumNum meterDur = curNum;
+				meterDur /= curDen;
 				meterDur *= 4;
 				HumNum nbt = getHumNum(token, "nextBarTime");
 				q = meterDur - nbt;
@@ -820,10 +799,10 @@ void Tool_meter::processLine(HumdrumLine& line, vector<HumNum>& curNum,
 			value << q;
 			token->setValue("auto", "q", value.str());
 			bool compound = false;
-			int multiple = curNum.at(track).getNumerator() / 3;
-			int remainder = curNum.at(track).getNumerator() % 3;
-			int bottom = curDen.at(track).getNumerator();
-			if ((curBeat.at(track) == 0) && (bottom >= 8) && (multiple > 1) && (remainder == 0)) {
+			int multiple = curNum.getNumerator() / 3;
+			int remainder = curNum.getNumerator() % 3;
+			int bottom = curDen.getNumerator();
+			if ((curBeat == 0) && (bottom >= 8) && (multiple > 1) && (remainder == 0)) {
 				compound = true;
 			}
 
@@ -841,13 +820,13 @@ void Tool_meter::processLine(HumdrumLine& line, vector<HumNum>& curNum,
 			} else {
 				// convert quarter note metric positions into beat positions
 				if (compound) {
-					qq *= curDen.at(track);
+					qq *= curDen;
 					qq /= 4;
 					qq /= 3;
-				} else if (curBeat.at(track) > 0) {
-					qq /= curBeat.at(track);
+				} else if (curBeat > 0) {
+					qq /= curBeat;
 				} else {
-					qq *= curDen.at(track);
+					qq *= curDen;
 					qq /= 4;
 				}
 			}
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
-// Last Modified: Tue Nov 29 01:03:06 PST 2016
+// Last Modified: Sun Oct 18 23:12:30 PDT 2026
 // Filename:      tool-metlev.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-metlev.cpp
 // Syntax:        C++11; humlib
@@ -19,6 +19,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <sstream>
 
 using namespace std;
 
@@ -149,9 +150,13 @@ bool Tool_metlev::run(HumdrumFile& infile) {
 		return true;
 	} else if (getBoolean("composite")) {
 		infile.prependDataSpine(beatlev, "nan", exinterp);
-		infile.printFieldIndex(0, m_humdrum_text);
+		// Read the composite spine back from a separate buffer, since
+		// m_humdrum_text may be writing to an output sink:
+		stringstream composite;
+		infile.printFieldIndex(0, composite);
 		infile.clear();
-		infile.readString(m_humdrum_text.str());
+		infile.readString(composite.str());
+		m_humdrum_text << composite.str();
 	} else {
 		vector<vector<double> > results;
 		fillVoiceResults(results, infile, beatlev);
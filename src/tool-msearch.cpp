@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Aug 27 06:15:38 PDT 2017
-// Last Modified: Tue Nov 23 16:00:54 CET 2021
+// Last Modified: Sun Oct 18 21:26:02 PDT 2026
 // Filename:      tool-msearch.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-msearch.cpp
 // Syntax:        C++11; humlib
@@ -23,50 +23,25 @@ namespace hum {
 
 //////////////////////////////
 //
-// SonorityDatabase::buildDatabase --
+// SonorityDatabase::buildDatabase -- Copy the notes sounding on a line
+//    from the sonority table of the file.
 //
 
-void SonorityDatabase::buildDatabase(HLp line) {
+void SonorityDatabase::buildDatabase(HumdrumFile& infile, int line) {
 	clear();
-	if (line == NULL) {
+	if ((line < 0) || (line >= infile.getLineCount())) {
 		return;
 	}
-	m_line = line;
-	bool nullQ = false;
-	if (!line->isData()) {
-		return;
+	m_line = &infile[line];
+	HumSonority sonority = infile.getSonority(line);
+	int count = sonority.getNoteCount();
+	for (int i=0; i<count; i++) {
+		expandList();
+		m_notes.back().setNote(sonority.getToken(i), sonority.getSubtokenIndex(i),
+				sonority.getBase40(i), sonority.isAttack(i));
 	}
-	int lowesti = 0;
-	int lowest12 = 1000;
-
-	for (int i=0; i<line->getFieldCount(); i++) {
-		HTp token = m_line->token(i);
-		if (!token->isKern()) {
-			continue;
-		}
-		if (token->isRest()) {
-			// ignoring rests, at least for now
-			continue;
-		}
-		if (token->isNull()) {
-			nullQ = true;
-			token = token->resolveNull();
-		}
-		if (token->isNull()) {
-			continue;
-		}
-		int scount = token->getSubtokenCount();
-		for (int j=0; j<scount; j++) {
-			expandList();
-			m_notes.back().setToken(token, nullQ, j);
-			if (m_notes.back().getBase12() < lowest12) {
-				lowesti = (int)m_notes.size() - 1;
-				lowest12 = m_notes.back().getBase12();
-			}
-		}
-	}
-	if (!m_notes.empty()) {
-		m_lowest = m_notes[lowesti];
+	if (count > 0) {
+		m_lowest = m_notes[sonority.getLowestIndex()];
 	}
 }
 
@@ -234,70 +209,34 @@ void Tool_msearch::initialize(void) {
 
 //////////////////////////////
 //
-// Tool_msearch::fillWords --
+// Tool_msearch::fillWords -- Get the words of the **silbe spines (or the
+//     **text spines if there are no **silbe spines) from the text table of
+//     the file.
 //
 
 void Tool_msearch::fillWords(HumdrumFile& infile, vector<TextInfo*>& words) {
-	vector<HTp> textspines;
-	infile.getSpineStartList(textspines, "**silbe");
-	if (textspines.empty()) {
-		infile.getSpineStartList(textspines, "**text");
-	}
-	for (int i=0; i<(int)textspines.size(); i++) {
-		fillWordsForTrack(words, textspines[i]);
-	}
-}
-
-
-
-//////////////////////////////
-//
-// Tool_msearch::fillWordsForTrack --
-//
-
-void Tool_msearch::fillWordsForTrack(vector<TextInfo*>& words,
-		HTp starttoken) {
-	HTp tok = starttoken->getNextToken();
-	while (tok != NULL) {
-		if (tok->empty()) {
-			tok = tok->getNextToken();
-			continue;
-		}
-		if (tok->isNull()) {
-			tok = tok->getNextToken();
-			continue;
+	const HumTextTable& table = infile.getTextTable();
+	string datatype = "**text";
+	for (int i=0; i<table.getSpineCount(); i++) {
+		if (table.getSpineStart(i)->isDataType("**silbe")) {
+			datatype = "**silbe";
+			break;
 		}
-		if (!tok->isData()) {
-			tok = tok->getNextToken();
+	}
+	for (int i=0; i<table.getSpineCount(); i++) {
+		if (!table.getSpineStart(i)->isDataType(datatype)) {
 			continue;
 		}
-		if (tok->at(0) == '-') {
-			// append a syllable to the end of previous word
-			if (!words.empty()) {
-				words.back()->fullword += tok->substr(1, string::npos);
-				if (words.back()->fullword.back() == '-') {
-					words.back()->fullword.pop_back();
-				}
-			}
-			tok = tok->getNextToken();
-			continue;
-		} else {
-			// start a new word
+		int start = table.getSpineWordStart(i);
+		int count = table.getSpineWordCount(i);
+		for (int j=0; j<count; j++) {
 			TextInfo* temp = new TextInfo();
-			temp->nexttoken = NULL;
-			if (!words.empty()) {
-				words.back()->nexttoken = tok;
-			}
-			temp->fullword = *tok;
-			if (!temp->fullword.empty()) {
-				if (temp->fullword.back() == '-') {
-					temp->fullword.pop_back();
-				}
+			temp->fullword = table.getWordText(start + j);
+			temp->starttoken = table.getWordToken(start + j);
+			if (j < count - 1) {
+				temp->nexttoken = table.getWordToken(start + j + 1);
 			}
-			temp->starttoken = tok;
 			words.push_back(temp);
-			tok = tok->getNextToken();
-			continue;
 		}
 	}
 }
@@ -1022,8 +961,9 @@ bool Tool_msearch::doHarmonicPitchSearch(MSearchQueryToken& query, HTp token) {
 	}
 	m_sonoritiesChecked[lindex] = true;
 	SonorityDatabase& sonorities = m_sonorities[lindex];
-	if (sonorities.isEmpty()) {
-		sonorities.buildDatabase(token->getLine());
+	HumdrumFile* infile = token->getLine()->getOwner();
+	if (sonorities.isEmpty() && infile) {
+		sonorities.buildDatabase(*infile, lindex);
 	}
 
 	bool exactQ = false;
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Wed Sep 25 19:23:06 PDT 2019
-// Last Modified: Sun Feb 27 02:39:41 PST 2022
+// Last Modified: Sun Oct 18 22:37:15 PDT 2026
 // Filename:      musedata2hum.cpp
 // URL:           https://github.com/craigsapp/hum2ly/blob/master/src/musedata2hum.cpp
 // Syntax:        C++11; humlib
@@ -97,9 +97,9 @@ bool Tool_musedata2hum::convertFile(ostream& out, const string& filename) {
 	MuseDataSet mds;
 	int result = mds.readFile(filename);
 	if (!result) {
-		cerr << "\nMuseData file [" << filename << "] has syntax errors\n";
-		cerr << "Error description:\t" << mds.getError() << "\n";
-		exit(1);
+		m_error_text << "\nMuseData file [" << filename << "] has syntax errors\n";
+		m_error_text << "Error description:\t" << mds.getError() << "\n";
+		return false;
 	}
 	return convert(out, mds);
 }
@@ -116,9 +116,9 @@ bool Tool_musedata2hum::convertString(ostream& out, const string& input) {
 	MuseDataSet mds;
 	int result = mds.readString(input);
 	if (!result) {
-		cout << "\nXML content has syntax errors\n";
-		cout << "Error description:\t" << mds.getError() << "\n";
-		exit(1);
+		m_error_text << "\nMuseData content has syntax errors\n";
+		m_error_text << "Error description:\t" << mds.getError() << "\n";
+		return false;
 	}
 	return convert(out, mds);
 }
@@ -310,9 +310,8 @@ bool Tool_musedata2hum::convert(ostream& out, MuseDataSet& mds) {
 	m_postReferences.clear();
 
 	stringstream ss;
-	auto nowtime = std::chrono::system_clock::now();
-	time_t currenttime = std::chrono::system_clock::to_time_t(nowtime);
-	ss << std::ctime(&currenttime);
+	// same format as ctime():
+	ss << Convert::getCurrentDate("%a %b %e %H:%M:%S %Y\n");
 	out << "!!!ONB: Converted from MuseData with musedata2hum on " << ss.str();
 
 	string copyright = mds[ii].getCopyright();
@@ -4,6 +4,8 @@
 // Creation Date: Sun Dec 26 17:03:54 PST 2010
 // Last Modifed:  Sun Dec 18 23:25:32 PST 2016 Ported to humlib
 // Last Modifed:  Thu Feb  9 06:40:13 PST 2023 Added -l option
+// Last Modifed:  Sun Oct 18 11:02:10 PDT 2026 Use measure index from HumdrumFileContent
+// Last Modifed:  Sun Oct 18 22:38:02 PDT 2026 Report data errors without exiting
 // Filename:      ...sig/examples/all/myank.cpp
 // Filename:      tool-myank.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-myank.cpp
@@ -249,7 +251,10 @@ void Tool_myank::processFile(HumdrumFile& infile) {
 		return;
 	}
 
-	getMetStates(m_metstates, infile);
+	if (m_debugQ) {
+		// metric states are only used for debugging output:
+		getMetStates(m_metstates, infile);
+	}
 	getMeasureStartStop(m_measureInList, infile);
 
 	string measurestring = getString("measures");
@@ -288,6 +293,9 @@ void Tool_myank::processFile(HumdrumFile& infile) {
 	// expand to multiple measures later.
 	expandMeasureOutList(m_measureOutList, m_measureInList, infile,
 			measurestring);
+	if (hasError()) {
+		return;
+	}
 
 	if (m_inlistQ) {
 		m_free_text << "INPUT MEASURE MAP: " << endl;
@@ -321,22 +329,14 @@ void Tool_myank::processFile(HumdrumFile& infile) {
 ////////////////////////
 //
 // Tool_myank::analyzeBarNumbers -- Stores the bar number of each line in a vector
+//     (taken from the measure index of the file).
 //
 
 vector<int> Tool_myank::analyzeBarNumbers(HumdrumFile& infile) {
 	vector<int> m_barnum;
 	m_barnum.resize(infile.getLineCount());
-	int current = 0;
-	HumRegex hre;
 	for (int i=0; i<infile.getLineCount(); i++) {
-		if (!infile[i].isBarline()) {
-			m_barnum.at(i) = current;
-			continue;
-		}
-		if (hre.search(infile[i].token(0), "=(\\d+)")) {
-			current = hre.getMatchInt(1);
-		}
-		m_barnum.at(i) = current;
+		m_barnum[i] = infile.getBarNumberForLine(i);
 	}
 	return m_barnum;
 }
@@ -1136,8 +1136,8 @@ void Tool_myank::adjustGlobalInterpretations(HumdrumFile& infile, int ii,
 void Tool_myank::adjustGlobalInterpretationsStart(HumdrumFile& infile, int ii,
 		vector<MeasureInfo>& outmeasures, int index) {
 	if (index != 0) {
-		cerr << "Error in adjustGlobalInterpetationsStart" << endl;
-		exit(1);
+		setError("Error in adjustGlobalInterpetationsStart");
+		return;
 	}
 
 	int i;
@@ -1874,109 +1874,35 @@ void Tool_myank::printEnding(HumdrumFile& infile, int lastline, int adjlin) {
 //////////////////////////////
 //
 // Tool_myank::getMeasureStartStop --  Get a list of the (numbered) measures in the
-//    input file, and store the start/stop lines for those measures.
-//    All data before the first numbered measure is in measure 0.
-//    although, if the first measure is not labeled, then ...
+//    input file from the measure index of the file, which is reused when
+//    extracting multiple excerpts from the same file.
 //
 
 void Tool_myank::getMeasureStartStop(vector<MeasureInfo>& measurelist, HumdrumFile& infile) {
-	measurelist.reserve(infile.getLineCount());
+	int count = infile.getMeasureIndexCount();
+	measurelist.reserve(count + 1);
 	measurelist.resize(0);
 
 	MeasureInfo current;
-	int i, ii;
-	int lastend = -1;
-	int dataend = -1;
-	int barnum1 = -1;
-	int barnum2 = -1;
-	HumRegex hre;
-
-	insertZerothMeasure(measurelist, infile);
-
-	for (i=0; i<infile.getLineCount(); i++) {
-		if (infile[i].isInterpretation()) {
-			if (*infile.token(i, 0) == "*-") {
-				dataend = i;
-				break;
-			}
-		}
-		if (!infile[i].isBarline()) {
-			continue;
-		}
-		//if (!hre.search(infile.token(i, 0), "^=.*(\\d+)")) {
-		//   continue;
-		//}
-		//barnum1 = stoi(hre.getMatch(1));
-		if (!sscanf(infile.token(i, 0)->c_str(), "=%d", &barnum1)) {
-			continue;
-		}
-		current.clear();
-		current.start = i;
-		current.num   = barnum1;
-		for (ii=i+1; ii<infile.getLineCount(); ii++) {
-			if (!infile[ii].isBarline()) {
-				continue;
-			}
-			//if (hre.search(infile.token(ii, 0), "^=.*(\\d+)")) {
-			//   barnum2 = stoi(hre.getMatch(1));
-			//   current.stop = ii;
-			//   lastend = ii;
-			//   i = ii - 1;
-			//   measurelist.push_back(current);
-			//   break;
-			//}
-			if (hre.search(infile.token(ii, 0), "=[^\\d]*(\\d+)")) {
-			// if (sscanf(infile.token(ii, 0), "=%d", &barnum2)) {
-				barnum2 = stoi(hre.getMatch(1));
-				current.stop = ii;
-				lastend = ii;
-				i = ii - 1;
-				current.file = &infile;
-				measurelist.push_back(current);
-				break;
-			} else {
-				if (atEndOfFile(infile, ii)) {
-					break;
-				}
-			}
-		}
-	}
-
-	int lastdata    = -1;   // last line in file with data
-	int lastmeasure = -1;   // last line in file with measure
-
-	for (i=infile.getLineCount()-1; i>=0; i--) {
-		if ((lastdata < 0) && infile[i].isData()) {
-			lastdata = i;
-		}
-		if ((lastmeasure < 0) && infile[i].isBarline()) {
-			lastmeasure = i;
-		}
-		if ((lastmeasure >= 0) && (lastdata >= 0)) {
-			break;
-		}
-	}
-
-	if (lastmeasure < lastdata) {
-		// no final barline, so set to ignore
-		lastmeasure = -1;
-		lastdata    = -1;
-	}
-
-	if ((barnum2 >= 0) && (lastend >= 0) && (dataend >= 0)) {
+	for (int i=0; i<count; i++) {
+		const HumMeasureInfo& entry = infile.getMeasureIndexEntry(i);
 		current.clear();
-		current.num = barnum2;
-		current.start = lastend;
-		current.stop = dataend;
-		if (lastmeasure > lastdata) {
-			current.stop = lastmeasure;
-		}
-		current.file = &infile;
+		current.num   = entry.number;
+		current.start = entry.startline;
+		current.stop  = entry.stopline;
+		current.file  = &infile;
 		measurelist.push_back(current);
 	}
 
 	// allow "myank -l" when there are no measure numbers
 	if (getBoolean("lines") && measurelist.size() == 0) {
+		int dataend = -1;
+		for (int i=0; i<infile.getLineCount(); i++) {
+			if (infile[i].isInterpretation() && (*infile.token(i, 0) == "*-")) {
+				dataend = i;
+				break;
+			}
+		}
 		current.clear();
 		current.num = 0;
 		current.start = 0;
@@ -2060,76 +1986,6 @@ void Tool_myank::getSectionString(string& sstring, HumdrumFile& infile, int sec)
 
 
 
-//////////////////////////////
-//
-// Tool_myank::atEndOfFile --
-//
-
-int Tool_myank::atEndOfFile(HumdrumFile& infile, int line) {
-	int i;
-	for (i=line+1; i<infile.getLineCount(); i++) {
-		if (infile[i].isData()) {
-			return 0;
-		}
-	}
-
-	return 1;
-}
-
-
-
-//////////////////////////////
-//
-// Tool_myank::insertZerothMeasure --
-//
-
-void Tool_myank::insertZerothMeasure(vector<MeasureInfo>& measurelist,
-		HumdrumFile& infile) {
-
-	HumRegex hre;
-	int exinterpline = -1;
-	int startline = -1;
-	int stopline = -1;
-	int i;
-	for (i=0; i<infile.getLineCount(); i++) {
-		if ((exinterpline < 0) && infile[i].isInterpretation()) {
-			exinterpline = i;
-		}
-		if ((startline < 0) && (infile[i].isData())) {
-			startline = i;
-		}
-		if (infile[i].isBarline() && hre.search(infile.token(i, 0), "^=.*\\d+", "")) {
-			stopline = i;
-			break;
-		}
-	}
-
-	if (exinterpline < 0) {
-		// somethind weird happend, just return
-		return;
-	}
-	if (startline < 0) {
-		// no zeroth measure;
-		return;
-	}
-	if (stopline < 0) {
-		// strange situation, no measure numbers
-		// consider what to do later...
-		return;
-	}
-
-	MeasureInfo current;
-	current.clear();
-	current.num = 0;
-	current.start = startline;
-	// current.start = exinterpline+1;
-	current.stop = stopline;
-	current.file = &infile;
-	measurelist.push_back(current);
-}
-
-
-
 //////////////////////////////
 //
 // Tool_myank::expandMeasureOutList -- read the measure list for the sequence of measures
@@ -2152,13 +2008,14 @@ void Tool_myank::expandMeasureOutList(vector<MeasureInfo>& measureout,
 			minmeasure = measurein[i].num;
 		}
 	}
+	measureout.clear();
 	if (maxmeasure <= 0 && !getBoolean("lines")) {
-		cerr << "Error: There are no measure numbers present in the data" << endl;
-		exit(1);
+		setError("Error: There are no measure numbers present in the data");
+		return;
 	}
 	if (maxmeasure > 1123123) {
-		cerr << "Error: ridiculusly large measure number: " << maxmeasure << endl;
-		exit(1);
+		setError("Error: ridiculusly large measure number: " + to_string(maxmeasure));
+		return;
 	}
 	if (m_maxQ) {
 		if (measurein.size() == 0) {
@@ -2166,7 +2023,7 @@ void Tool_myank::expandMeasureOutList(vector<MeasureInfo>& measureout,
 		} else {
 			m_humdrum_text << maxmeasure << endl;
 		}
-		exit(0);
+		return;
 	} else if (m_minQ) {
 		for (int ii=0; ii<infile.getLineCount(); ii++) {
 			if (infile[ii].isBarline()) {
@@ -2174,12 +2031,12 @@ void Tool_myank::expandMeasureOutList(vector<MeasureInfo>& measureout,
 					break;
 				} else {
 					m_humdrum_text << 0 << endl;
-					exit(0);
+					return;
 				}
 			}
 			if (infile[ii].isData()) {
 				m_humdrum_text << 0 << endl;
-				exit(0);
+				return;
 			}
 		}
 		if (measurein.size() == 0) {
@@ -2187,7 +2044,7 @@ void Tool_myank::expandMeasureOutList(vector<MeasureInfo>& measureout,
 		} else {
 			m_humdrum_text << minmeasure << endl;
 		}
-		exit(0);
+		return;
 	}
 
 	// create reverse-lookup list
@@ -2217,6 +2074,9 @@ void Tool_myank::expandMeasureOutList(vector<MeasureInfo>& measureout,
 		start += value - 1;
 		start += (int)hre.getMatch(1).size();
 		processFieldEntry(range, hre.getMatch(1), infile, maxmeasure, measurein, inmap);
+		if (hasError()) {
+			return;
+		}
 		value = hre.search(ostring, start, searchexp);
 	}
 }
@@ -2609,16 +2469,16 @@ void Tool_myank::processFieldEntry(vector<MeasureInfo>& field,
 		if (lastone  < 0         ) { lastone  = 0         ; }
 
 		if ((firstone < 1) && (firstone != 0)) {
-			cerr << "Error: range token: \"" << str << "\""
-				  << " contains too small a number at start: " << firstone << endl;
-			cerr << "Minimum number allowed is " << 1 << endl;
-			exit(1);
+			setError("Error: range token: \"" + str + "\""
+					+ " contains too small a number at start: " + to_string(firstone)
+					+ "\nMinimum number allowed is 1");
+			return;
 		}
 		if ((lastone < 1) && (lastone != 0)) {
-			cerr << "Error: range token: \"" << str << "\""
-				  << " contains too small a number at end: " << lastone << endl;
-			cerr << "Minimum number allowed is " << 1 << endl;
-			exit(1);
+			setError("Error: range token: \"" + str + "\""
+					+ " contains too small a number at end: " + to_string(lastone)
+					+ "\nMinimum number allowed is 1");
+			return;
 		}
 
 		if (firstone > lastone) {
@@ -2682,12 +2542,12 @@ void Tool_myank::processFieldEntry(vector<MeasureInfo>& field,
 		// do something with letter later...
 
 		if ((value < 1) && (value != 0)) {
-			cerr << "Error: range token: \"" << str << "\""
-				  << " contains too small a number at end: " << value << endl;
-			cerr << "Minimum number allowed is " << 1 << endl;
-			exit(1);
+			setError("Error: range token: \"" + str + "\""
+					+ " contains too small a number at end: " + to_string(value)
+					+ "\nMinimum number allowed is 1");
+			return;
 		}
-		if (inmap[value] >= 0) {
+		if ((value < (int)inmap.size()) && (inmap[value] >= 0)) {
 			current.clear();
 			current.file = &infile;
 			current.num = value;
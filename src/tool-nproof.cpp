@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Wed Sep 20 13:08:15 PDT 2023
-// Last Modified: Wed Sep 20 13:08:18 PDT 2023
+// Last Modified: Sun Oct 18 21:54:50 PDT 2026
 // Filename:      tool-nproof.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-nproof.cpp
 // Syntax:        C++11; humlib
@@ -234,15 +234,12 @@ void Tool_nproof::checkForBlankLines(HumdrumFile& infile) {
 // Tool_nproof::checkForValidInstrumentCode --
 //
 
-void Tool_nproof::checkForValidInstrumentCode(HTp token,
-		vector<pair<string, string>>& instrumentList) {
+void Tool_nproof::checkForValidInstrumentCode(HTp token) {
 
 	if ((token->find("&") == string::npos) && (token->find("|") == string::npos)) {
 		string code = token->substr(2);
-		for (int i=0; i<(int)instrumentList.size(); i++) {
-			if (instrumentList[i].first == code) {
-				return;
-			}
+		if (!Convert::getInstrumentClass(code).empty()) {
+			return;
 		}
 
 		m_errorCount++;
@@ -260,14 +257,8 @@ void Tool_nproof::checkForValidInstrumentCode(HTp token,
 		inst1 = hre.getMatch(1);
 		inst2 = hre.getMatch(2);
 
-		for (int i=0; i<(int)instrumentList.size(); i++) {
-			if (instrumentList[i].first == inst1) {
-				found1 = true;
-			}
-			if (instrumentList[i].first == inst2) {
-				found2 = true;
-			}
-		}
+		found1 = !Convert::getInstrumentClass(inst1).empty();
+		found2 = !Convert::getInstrumentClass(inst2).empty();
 	}
 
 	if (!found1) {
@@ -296,8 +287,6 @@ void Tool_nproof::checkInstrumentInformation(HumdrumFile& infile) {
 	int classLine = -1;
 	HumRegex hre;
 
-	vector<pair<string, string>> instrumentList = Convert::getInstrumentList();
-
 	for (int i=0; i<infile.getLineCount(); i++) {
 		if (infile[i].isData()) {
 			break;
@@ -338,7 +327,7 @@ void Tool_nproof::checkInstrumentInformation(HumdrumFile& infile) {
 					m_errorList += "!!!TOOL-nproof-error-" + to_string(m_errorCount) + ": expected instrument code on line " + to_string(token->getLineNumber()) + ", field " + to_string(token->getFieldNumber()) + ".\n";
 					m_errorHtml += "!! <li> @{TOOL-nproof-error-" + to_string(m_errorCount) + "} </li>\n";
 				} else {
-					checkForValidInstrumentCode(token, instrumentList);
+					checkForValidInstrumentCode(token);
 				}
 			} else {
 				if (*token != "*") {
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Jul 18 11:23:42 PDT 2005
-// Last Modified: Sat Jun  8 17:37:39 PDT 2024 (ported to humlib)
+// Last Modified: Sun Oct 18 23:59:58 PDT 2026
 // Filename:      src/tool-prange.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-prange.cpp
 // Syntax:        C++11; humlib
@@ -16,6 +16,10 @@
 #include "HumRegex.h"
 #include "Convert.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
@@ -114,6 +118,410 @@ ostream& _VoiceInfo::print(ostream& out) {
 
 
 
+//////////////////////////////
+//
+// PrangeCorpus::PrangeCorpus -- Constructor.
+//
+
+PrangeCorpus::PrangeCorpus(void) {
+	clear();
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::clear --
+//
+
+void PrangeCorpus::clear(void) {
+	m_voices.clear();
+	m_files = 0;
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::isEmpty -- Return true if no files have been added.
+//
+
+bool PrangeCorpus::isEmpty(void) const {
+	return m_files == 0;
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::getFileCount -- Return the number of files in the
+//     histograms.
+//
+
+int PrangeCorpus::getFileCount(void) const {
+	return m_files;
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::isDurationWeighted -- Return true if the histograms are
+//     weighted by note duration rather than counting note attacks.
+//
+
+bool PrangeCorpus::isDurationWeighted(void) const {
+	return m_durationQ;
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::setDurationWeighted -- Only has an effect before files
+//     are added.
+//
+
+void PrangeCorpus::setDurationWeighted(bool state) {
+	if (m_files == 0) {
+		m_durationQ = state;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::getVoiceKey -- Normalize a voice name for merging voices
+//     from different files: lower case with single spaces between words.
+//
+
+string PrangeCorpus::getVoiceKey(const string& name) {
+	string output;
+	for (int i=0; i<(int)name.size(); i++) {
+		unsigned char ch = (unsigned char)name[i];
+		if (isspace(ch)) {
+			if (!output.empty() && (output.back() != ' ')) {
+				output += ' ';
+			}
+		} else {
+			output += (char)tolower(ch);
+		}
+	}
+	if (!output.empty() && (output.back() == ' ')) {
+		output.pop_back();
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::addFile -- Add the histograms of the **kern voices of a
+//     file which were filled by Tool_prange::fillHistograms().  Voices
+//     without names are identified by their order in the file.
+//
+
+void PrangeCorpus::addFile(vector<_VoiceInfo>& voiceInfo) {
+	int count = 0;
+	for (int i=1; i<(int)voiceInfo.size(); i++) {
+		if (!voiceInfo[i].kernQ) {
+			continue;
+		}
+		count++;
+		string key = getVoiceKey(voiceInfo[i].name);
+		if (key.empty()) {
+			key = "voice " + to_string(count);
+		}
+		mergeVoice(m_voices[key], voiceInfo[i]);
+	}
+	m_files++;
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::merge -- Add the histograms of another corpus.  Returns
+//     false if the two corpora are weighted differently.
+//
+
+bool PrangeCorpus::merge(const PrangeCorpus& other) {
+	if (other.m_files == 0) {
+		return true;
+	}
+	if (m_durationQ != other.m_durationQ) {
+		return false;
+	}
+	for (auto& entry : other.m_voices) {
+		mergeVoice(m_voices[entry.first], entry.second);
+	}
+	m_files += other.m_files;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::mergeVoice -- Add the bins and finals of a voice to another
+//     voice with the same key.  The (alphabetically) first name and
+//     abbreviation are kept, so that the result does not depend on the
+//     order in which voices are merged.
+//
+
+void PrangeCorpus::mergeVoice(_VoiceInfo& target, const _VoiceInfo& source) {
+	target.kernQ = true;
+	if (!source.name.empty() && (target.name.empty() || (source.name < target.name))) {
+		target.name = source.name;
+	}
+	if (!source.abbr.empty() && (target.abbr.empty() || (source.abbr < target.abbr))) {
+		target.abbr = source.abbr;
+	}
+	for (int i=0; i<(int)source.midibins.size(); i++) {
+		target.midibins.at(i) += source.midibins[i];
+	}
+	for (int i=0; i<(int)source.diatonic.size(); i++) {
+		for (int j=0; j<(int)source.diatonic[i].size(); j++) {
+			target.diatonic.at(i).at(j) += source.diatonic[i][j];
+		}
+	}
+	for (int i=0; i<(int)source.diafinal.size(); i++) {
+		addFinal(target, source.diafinal[i], source.accfinal.at(i));
+	}
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::addFinal -- Add a finalis note to the sorted list of
+//     distinct finals for a voice.
+//
+
+void PrangeCorpus::addFinal(_VoiceInfo& voice, int diatonic, int acc) {
+	int index = 0;
+	while (index < (int)voice.diafinal.size()) {
+		int dia = voice.diafinal[index];
+		int alt = voice.accfinal.at(index);
+		if ((dia == diatonic) && (alt == acc)) {
+			return;
+		}
+		if ((dia > diatonic) || ((dia == diatonic) && (alt > acc))) {
+			break;
+		}
+		index++;
+	}
+	voice.diafinal.insert(voice.diafinal.begin() + index, diatonic);
+	voice.accfinal.insert(voice.accfinal.begin() + index, acc);
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::isPartial -- Return true if the file is a partial
+//     written by printPartial().
+//
+
+bool PrangeCorpus::isPartial(HumdrumFile& infile) {
+	return !infile.getReferenceRecord("prange-partial").empty();
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::readPartial -- Merge the histograms stored in a partial.
+//     Returns false and sets the error message if the partial is not
+//     valid or is weighted differently from the corpus.
+//
+
+bool PrangeCorpus::readPartial(HumdrumFile& infile, string& error) {
+	PrangeCorpus partial;
+	partial.m_durationQ = infile.getReferenceRecord("prange-weight") == "durations";
+	partial.m_files = atoi(infile.getReferenceRecord("prange-files").c_str());
+
+	HumRegex hre;
+	for (int i=0; i<infile.getLineCount(); i++) {
+		if (!infile[i].isData()) {
+			continue;
+		}
+		if (infile[i].getFieldCount() != 3) {
+			error = "prange partial line " + to_string(i+1) + " does not have three fields";
+			return false;
+		}
+		string key   = *infile.token(i, 0);
+		string field = *infile.token(i, 1);
+		string value = *infile.token(i, 2);
+		_VoiceInfo& voice = partial.m_voices[key];
+		voice.kernQ = true;
+		if (field == "name") {
+			voice.name = value;
+		} else if (field == "abbr") {
+			voice.abbr = value;
+		} else if (hre.search(field, "^midi:(\\d+)$")) {
+			int midi = hre.getMatchInt(1);
+			if (midi > 127) {
+				error = "MIDI pitch out of range on prange partial line " + to_string(i+1);
+				return false;
+			}
+			double count;
+			if (!readCount(value, count)) {
+				error = "invalid count " + value + " on prange partial line " + to_string(i+1);
+				return false;
+			}
+			voice.midibins[midi] += count;
+		} else if (hre.search(field, "^(dia|final):(\\d+):(-?\\d+)$")) {
+			int diatonic = hre.getMatchInt(2);
+			int acc = hre.getMatchInt(3);
+			if ((acc < -2) || (acc > 2)) {
+				error = "accidental out of range on prange partial line " + to_string(i+1);
+				return false;
+			}
+			if (hre.getMatch(1) == "final") {
+				addFinal(voice, diatonic, acc);
+			} else if (diatonic >= (int)voice.diatonic.size()) {
+				error = "diatonic pitch out of range on prange partial line " + to_string(i+1);
+				return false;
+			} else {
+				double count;
+				if (!readCount(value, count)) {
+					error = "invalid count " + value + " on prange partial line " + to_string(i+1);
+					return false;
+				}
+				voice.diatonic[diatonic][0] += count;
+				voice.diatonic[diatonic][acc+3] += count;
+			}
+		} else {
+			error = "unknown field " + field + " on prange partial line " + to_string(i+1);
+			return false;
+		}
+	}
+
+	if (!merge(partial)) {
+		error = "prange partial is not weighted by ";
+		error += m_durationQ ? "durations (-d option)" : "attacks";
+		return false;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::readCount -- Read a histogram count from a partial.
+//     Returns false if the text is not a finite, non-negative number.
+//
+
+bool PrangeCorpus::readCount(const string& text, double& count) {
+	count = 0.0;
+	if (text.empty()) {
+		return false;
+	}
+	char* end = NULL;
+	errno = 0;
+	double value = strtod(text.c_str(), &end);
+	if ((end != text.c_str() + text.size()) || (errno == ERANGE)) {
+		return false;
+	}
+	if (!std::isfinite(value) || (value < 0.0)) {
+		return false;
+	}
+	count = value;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::printPartial -- Print the histograms in a form that can be
+//     read by readPartial().  Only non-zero bins are stored.
+//
+
+ostream& PrangeCorpus::printPartial(ostream& out) const {
+	std::streamsize precision = out.precision(15);
+	out << "!!!prange-partial: 1\n";
+	out << "!!!prange-weight: " << (m_durationQ ? "durations" : "attacks") << "\n";
+	out << "!!!prange-files: " << m_files << "\n";
+	out << "**voice\t**key\t**value\n";
+	for (auto& entry : m_voices) {
+		const string& key = entry.first;
+		const _VoiceInfo& voice = entry.second;
+		if (!voice.name.empty()) {
+			out << key << "\tname\t" << voice.name << "\n";
+		}
+		if (!voice.abbr.empty()) {
+			out << key << "\tabbr\t" << voice.abbr << "\n";
+		}
+		for (int i=0; i<(int)voice.midibins.size(); i++) {
+			if (voice.midibins[i] != 0.0) {
+				out << key << "\tmidi:" << i << "\t" << voice.midibins[i] << "\n";
+			}
+		}
+		for (int i=0; i<(int)voice.diatonic.size(); i++) {
+			for (int j=1; j<(int)voice.diatonic[i].size(); j++) {
+				if (voice.diatonic[i][j] != 0.0) {
+					out << key << "\tdia:" << i << ":" << (j-3) << "\t" << voice.diatonic[i][j] << "\n";
+				}
+			}
+		}
+		for (int i=0; i<(int)voice.diafinal.size(); i++) {
+			out << key << "\tfinal:" << voice.diafinal[i] << ":" << voice.accfinal.at(i) << "\t1\n";
+		}
+	}
+	out << "*-\t*-\t*-\n";
+	out.precision(precision);
+	return out;
+}
+
+
+
+//////////////////////////////
+//
+// PrangeCorpus::getVoiceInfo -- Fill in the voice list used for printing
+//     a range display, with voices sorted from low to high by their mean
+//     pitch.  Index 0 is for the all-voice summary, which is filled in by
+//     Tool_prange::mergeAllVoiceInfo().
+//
+
+void PrangeCorpus::getVoiceInfo(vector<_VoiceInfo>& voiceInfo) const {
+	vector<pair<double, const _VoiceInfo*>> voices;
+	for (auto& entry : m_voices) {
+		double sum = 0.0;
+		double total = 0.0;
+		for (int i=0; i<(int)entry.second.midibins.size(); i++) {
+			sum += i * entry.second.midibins[i];
+			total += entry.second.midibins[i];
+		}
+		voices.emplace_back(total > 0.0 ? sum / total : 0.0, &entry.second);
+	}
+	// stable_sort keeps voices with equal means in key order:
+	stable_sort(voices.begin(), voices.end(),
+		[](const pair<double, const _VoiceInfo*>& a,
+				const pair<double, const _VoiceInfo*>& b) {
+			return a.first < b.first;
+		});
+
+	voiceInfo.clear();
+	voiceInfo.resize(voices.size() + 1);
+	voiceInfo[0].name  = voices.size() == 2 ? "both" : "all";
+	voiceInfo[0].abbr  = voiceInfo[0].name;
+	voiceInfo[0].track = 0;
+	voiceInfo[0].index = 0;
+	for (int i=0; i<(int)voices.size(); i++) {
+		voiceInfo[i+1] = *voices[i].second;
+		voiceInfo[i+1].namfinal.clear();
+		voiceInfo[i+1].track = i + 1;
+		voiceInfo[i+1].index = i + 1;
+	}
+}
+
+
+
 /////////////////////////////////
 //
 // Tool_prange::Tool_prange -- Set the recognized options for the tool.
@@ -146,6 +554,8 @@ Tool_prange::Tool_prange(void) {
 	define("q|quartile=b",              "display quartile notes");
 	define("r|reverse=b",               "reverse list of notes in analysis from high to low");
 	define("x|extrema=b",               "highlight extrema notes in each part");
+	define("corpus=b",                  "merge histograms of all inputs (files or partials) into one range display");
+	define("partial=b",                 "print histograms as a partial that can be merged with --corpus");
 	define("sx|scorexml|score-xml|ScoreXML|scoreXML=b", "output ScoreXML format");
 	define("title=s:",                  "title for SCORE display");
 
@@ -191,12 +601,70 @@ bool Tool_prange::run(HumdrumFile& infile, ostream& out) {
 
 bool Tool_prange::run(HumdrumFile& infile) {
 	initialize();
+	if (PrangeCorpus::isPartial(infile)) {
+		if (!m_corpusQ) {
+			m_error_text << "Error: use the --corpus option to merge prange partials" << endl;
+			return false;
+		}
+		string error;
+		if (!m_corpus.readPartial(infile, error)) {
+			m_error_text << "Error: " << error << endl;
+			return false;
+		}
+		return true;
+	}
 	processFile(infile);
 	return true;
 }
 
 
 
+//////////////////////////////
+//
+// Tool_prange::finally -- Print the range display (or merged partial) for
+//     all inputs when using the --corpus option.  The title of a corpus
+//     display is only given by the --title option, and no key signature
+//     is shown.
+//
+
+void Tool_prange::finally(void) {
+	if (!m_corpusQ) {
+		return;
+	}
+	if (m_partialQ) {
+		m_corpus.printPartial(m_humdrum_text);
+		return;
+	}
+	if (m_corpus.isEmpty()) {
+		return;
+	}
+
+	vector<_VoiceInfo> voiceInfo;
+	m_corpus.getVoiceInfo(voiceInfo);
+	mergeAllVoiceInfo(voiceInfo);
+	m_refmap.clear();
+	if (m_scoreQ) {
+		printScoreFile(m_humdrum_text, voiceInfo, 0);
+	} else {
+		printAnalysis(m_humdrum_text, voiceInfo[0].midibins);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_prange::getCorpus -- Return the histograms merged for the --corpus
+//     option, such as for merging the results of tools run in separate
+//     threads with PrangeCorpus::merge().
+//
+
+PrangeCorpus& Tool_prange::getCorpus(void) {
+	return m_corpus;
+}
+
+
+
 //////////////////////////////
 //
 // Tool_prange::initialize --  Initializations that only have to be done once
@@ -232,6 +700,8 @@ void Tool_prange::initialize(void) {
 	m_titleQ       = getBoolean("title");
 	m_embedQ       = getBoolean("embed");
 	m_extremaQ     = getBoolean("extrema");
+	m_corpusQ      = getBoolean("corpus");
+	m_partialQ     = getBoolean("partial");
 
 	getRange(m_rangeL, m_rangeH, getString("range"));
 
@@ -253,6 +723,8 @@ void Tool_prange::initialize(void) {
 		m_percentile = m_percentile / 100.0;
 	}
 
+	m_corpus.setDurationWeighted(m_durationQ);
+
 	#ifdef __EMSCRIPTEN__
 		// Default styling for JavaScript version of program:
 		m_accQ     = !getBoolean("color-accidentals");
@@ -283,9 +755,22 @@ void Tool_prange::processFile(HumdrumFile& infile) {
 		}
 	}
 
+	if (m_corpusQ) {
+		// printed after all inputs in finally():
+		m_corpus.addFile(voiceInfo);
+		return;
+	}
+	if (m_partialQ) {
+		PrangeCorpus partial;
+		partial.setDurationWeighted(m_durationQ);
+		partial.addFile(voiceInfo);
+		partial.printPartial(m_humdrum_text);
+		return;
+	}
+
 	if (m_scoreQ) {
 		stringstream scoreout;
-		printScoreFile(scoreout, voiceInfo, infile);
+		printScoreFile(scoreout, voiceInfo, getKeySignature(infile));
 		if (m_embedQ) {
 			if (m_extremaQ) {
 				doExtremaMarkup(infile);
@@ -879,7 +1364,7 @@ void Tool_prange::printXmlEncodedText(ostream& out, const string& strang) {
 // Tool_prange::printScoreFile --
 //
 
-void Tool_prange::printScoreFile(ostream& out, vector<_VoiceInfo>& voiceInfo, HumdrumFile& infile) {
+void Tool_prange::printScoreFile(ostream& out, vector<_VoiceInfo>& voiceInfo, int keysig) {
 	string titlestring = getTitle();
 
 	if (m_defineQ) {
@@ -941,7 +1426,6 @@ void Tool_prange::printScoreFile(ostream& out, vector<_VoiceInfo>& voiceInfo, Hu
 	out << "8 1 0 0 0 200\n";   // staff 1
 	out << "8 2 0 -6 0 200\n";   // staff 2
 
-	int keysig = getKeySignature(infile);
 	// print key signature
 	if (keysig) {
 		out << "17 1 10 0 " << keysig << " 101.0";
@@ -2119,25 +2603,28 @@ void Tool_prange::getRange(int& rangeL, int& rangeH, const string& rangestring)
 	if (rangestring.empty()) {
 		return;
 	}
-	int length = (int)rangestring.length();
-	char* buffer = new char[length+1];
-	strcpy(buffer, rangestring.c_str());
-	char* ptr;
-	if (std::isdigit(buffer[0])) {
-		ptr = strtok(buffer, " \t\n:-");
-		sscanf(ptr, "%d", &rangeL);
-		ptr = strtok(NULL, " \t\n:-");
-		if (ptr != NULL) {
-			sscanf(ptr, "%d", &rangeH);
+	bool numericQ = std::isdigit(rangestring[0]);
+	const char* separators = numericQ ? " \t\n:-" : " :";
+	vector<string> values;
+	size_t start = rangestring.find_first_not_of(separators);
+	while ((start != string::npos) && (values.size() < 2)) {
+		size_t end = rangestring.find_first_of(separators, start);
+		values.push_back(rangestring.substr(start, end - start));
+		start = rangestring.find_first_not_of(separators, end);
+	}
+	if (numericQ) {
+		if (values.size() > 0) {
+			sscanf(values[0].c_str(), "%d", &rangeL);
+		}
+		if (values.size() > 1) {
+			sscanf(values[1].c_str(), "%d", &rangeH);
 		}
 	} else {
-		ptr = strtok(buffer, " :");
-		if (ptr != NULL) {
-			rangeL = Convert::kernToMidiNoteNumber(ptr);
-			ptr = strtok(NULL, " :");
-			if (ptr != NULL) {
-				rangeH = Convert::kernToMidiNoteNumber(ptr);
-			}
+		if (values.size() > 0) {
+			rangeL = Convert::kernToMidiNoteNumber(values[0]);
+		}
+		if (values.size() > 1) {
+			rangeH = Convert::kernToMidiNoteNumber(values[1]);
 		}
 	}
 
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Wed Dec  7 08:01:07 PST 2016
-// Last Modified: Wed Dec  7 12:40:28 PST 2016
+// Last Modified: Sun Oct 18 23:12:30 PDT 2026
 // Filename:      tool-recip.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-recip.cpp
 // Syntax:        C++11; humlib
@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <sstream>
 
 using namespace std;
 
@@ -180,9 +181,11 @@ void Tool_recip::doCompositeAnalysis(HumdrumFile& infile) {
 		return;
 	} else {
 		infile.prependDataSpine(recips, "", m_exinterp);
-		infile.printFieldIndex(0, m_humdrum_text);
+		stringstream composite;
+		infile.printFieldIndex(0, composite);
 		infile.clear();
-		infile.readString(m_humdrum_text.str());
+		infile.readString(composite.str());
+		m_humdrum_text << composite.str();
 	}
 }
 
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Fri Jul  6 00:05:27 CEST 2018
-// Last Modified: Fri Jul  6 22:06:26 CEST 2018
+// Last Modified: Sun Oct 18 12:24:35 PDT 2026
 // Filename:      tool-slurcheck.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-slurcheck.cpp
 // Syntax:        C++11; humlib
@@ -99,6 +99,8 @@ void Tool_slurcheck::initialize(void) {
 
 void Tool_slurcheck::processFile(HumdrumFile& infile) {
 	infile.analyzeSlurs();
+	HumAnalysisTables& tables = infile.getAnalysisTables();
+	HumSpanTable& slurs = tables.getSlurs();
 	int opencount = 0;
 	int closecount = 0;
 	int listQ  = getBoolean("list");
@@ -124,10 +126,9 @@ void Tool_slurcheck::processFile(HumdrumFile& infile) {
 				tok = tok->getNextToken();
 				continue;
 			}
-			string value = tok->getValue("auto", "hangingSlur");
-			if (value == "true") {
-				string side = tok->getValue("auto", "slurSide");
-				if (side == "start") {
+			int side = slurs.getHangingSide(tables.getTokenId(tok));
+			if (side != 0) {
+				if (side > 0) {
 					opencount++;
 					if (listQ) {
 						if (filenameQ) {
@@ -140,7 +141,7 @@ void Tool_slurcheck::processFile(HumdrumFile& infile) {
 						data += "i";
 						tok->setText(data);
 					}
-				} else if (side == "stop") {
+				} else {
 					closecount++;
 					if (listQ) {
 						if (filenameQ) {
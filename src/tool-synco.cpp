@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Apr 30 10:42:45 PDT 2022
-// Last Modified: Wed May  4 01:03:46 PDT 2022
+// Last Modified: Sun Oct 18 21:59:44 PDT 2026
 // Filename:      tool-synco.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-synco.cpp
 // Syntax:        C++11; humlib
@@ -139,15 +139,16 @@ void Tool_synco::initialize(void) {
 //
 
 void Tool_synco::processFile(HumdrumFile& infile) {
-	int scount = infile.getStrandCount();
+	const HumStrandTable& strands = infile.getStrandTable();
+	int scount = strands.getStrandCount();
 	m_scount = 0;
+	m_hasSyncoQ = false;
 	for (int i=0; i<scount; i++) {
-		HTp stok = infile.getStrandStart(i);
-		if (!stok->isKern()) {
+		HTp stok = strands.getToken(strands.getStrandOffset(i));
+		if (!stok || !stok->isKern()) {
 			continue;
 		}
-		HTp etok = infile.getStrandEnd(i);
-		processStrand(stok, etok);
+		processStrand(strands, i);
 	}
 }
 
@@ -158,23 +159,18 @@ void Tool_synco::processFile(HumdrumFile& infile) {
 // Tool_synco::processStrand --
 //
 
-void Tool_synco::processStrand(HTp stok, HTp etok) {
-	HTp current = stok;
-	while (current && (current != etok)) {
-		if (!current->isData()) {
-			current = current->getNextToken();
-			continue;
-		}
-		if (current->isNull()) {
-			current = current->getNextToken();
+void Tool_synco::processStrand(const HumStrandTable& strands, int strand) {
+	int start = strands.getStrandOffset(strand);
+	int end = start + strands.getStrandSize(strand);
+	for (int i=start; i<end; i++) {
+		if (!strands.isData(i) || strands.isNull(i)) {
 			continue;
 		}
+		HTp current = strands.getToken(i);
 		if (current->isRest()) {
-			current = current->getNextToken();
 			continue;
 		}
 		if (current->isSecondaryTiedNote()) {
-			current = current->getNextToken();
 			continue;
 		}
 		if (isSyncopated(current)) {
@@ -182,7 +178,6 @@ void Tool_synco::processStrand(HTp stok, HTp etok) {
 			m_scount++;
 			markNote(current);
 		}
-		current = current->getNextToken();
 	}
 }
 
@@ -911,22 +911,7 @@ void Tool_tassoize::clearStates(void) {
 //
 
 string Tool_tassoize::getDate(void) {
-	time_t t = time(NULL);
-	tm* timeptr = localtime(&t);
-	stringstream ss;
-	int year = timeptr->tm_year + 1900;
-	int month = timeptr->tm_mon + 1;
-	int day = timeptr->tm_mday;
-	ss << year << "/";
-	if (month < 10) {
-		ss << "0";
-	}
-	ss << month << "/";
-	if (day < 10) {
-		ss << "0";
-	}
-	ss << day;
-	return ss.str();
+	return Convert::getCurrentDate();
 }
 
 
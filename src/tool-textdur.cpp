@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Sep  2 12:02:01 CEST 2023
-// Last Modified: Sat Sep  2 12:02:04 CEST 2023
+// Last Modified: Sun Oct 18 21:28:51 PDT 2026
 // Filename:      tool-textdur.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-textdur.cpp
 // Syntax:        C++11; humlib
@@ -120,8 +120,9 @@ void Tool_textdur::processFile(HumdrumFile& infile) {
 	m_melismas.clear();
 	m_melismas.resize(m_textStarts.size());
 
+	const HumTextTable& table = infile.getTextTable();
 	for (int i=0; i<(int)m_textStarts.size(); i++) {
-		processTextSpine(m_textStarts, i);
+		processTextSpine(table, m_textStarts, i);
 	}
 
 	if (!m_interleaveQ) {
@@ -676,7 +677,8 @@ void Tool_textdur::getTextSpineStarts(HumdrumFile& infile, vector<HTp>& starts)
 // Tool_textdur::processTextSpine --
 //
 
-void Tool_textdur::processTextSpine(vector<HTp>& starts, int index) {
+void Tool_textdur::processTextSpine(const HumTextTable& table, vector<HTp>& starts,
+		int index) {
 	HTp current = starts.at(index);
 	current->getNextToken();
 	while (current) {
@@ -707,14 +709,23 @@ void Tool_textdur::processTextSpine(vector<HTp>& starts, int index) {
 		current = current->getNextToken();
 	}
 
-	for (int i=0; i<(int)m_syllables.size(); i++) {
-		for (int j=0; j<(int)m_syllables[i].size() - 1; j++) {
-			if (m_melismaQ) {
-				m_melismas.at(i).at(j) = getMelisma(m_syllables.at(i).at(j), m_syllables.at(i).at(j+1));
-			}
-			if (m_durationQ) {
-				m_durations.at(i).at(j) = getDuration(m_syllables.at(i).at(j), m_syllables.at(i).at(j+1));
-			}
+	// The syllables of the spine are listed in the same order in the
+	// text table:
+	int first = 0;
+	for (int i=0; i<table.getSpineCount(); i++) {
+		if (table.getSpineStart(i) == starts.at(index)) {
+			first = table.getSpineSyllableStart(i);
+			break;
+		}
+	}
+
+	vector<HTp>& syllables = m_syllables.at(index);
+	for (int j=0; j<(int)syllables.size() - 1; j++) {
+		if (m_melismaQ) {
+			m_melismas.at(index).at(j) = getMelisma(table, first + j);
+		}
+		if (m_durationQ) {
+			m_durations.at(index).at(j) = getDuration(syllables.at(j), syllables.at(j+1));
 		}
 	}
 }
@@ -723,47 +734,22 @@ void Tool_textdur::processTextSpine(vector<HTp>& starts, int index) {
 
 //////////////////////////////
 //
-// Tool_textdur::getMelisma --  Not counting syllable starts on secondary tied notes.
+// Tool_textdur::getMelisma --  Not counting syllable starts on secondary
+//     tied notes.  The note count is taken from the text table of the file.
 //
 
-int Tool_textdur::getMelisma(HTp tok1, HTp tok2) {
-	int stopIndex = tok2->getLineIndex();
-	HTp current = getTandemKernToken(tok1);
+int Tool_textdur::getMelisma(const HumTextTable& table, int syllable) {
+	HTp current = table.getFirstNote(syllable);
 	if (!current) {
 		return 0;
 	}
 	if (current->isNull()) {
+		HTp tok1 = table.getSyllableToken(syllable);
 		cerr << "Strange case for syllable " << tok1 << " on line " << tok1->getLineNumber();
 		cerr << ", field " << tok1->getFieldNumber() <<" which does not start on a note" << endl;
 		return 0;
 	}
-	int cline = current->getLineIndex();
-	int counter = 0;
-	while (current && cline < stopIndex) {
-		if (!current->isData()) {
-			current = current->getNextToken();
-			if (current) {
-				cline = current->getLineIndex();
-			}
-			continue;
-		}
-		if (current->isNull()) {
-			current = current->getNextToken();
-			if (current) {
-				cline = current->getLineIndex();
-			}
-			continue;
-		}
-		if (current->isNoteAttack()) {
-			counter++;
-		}
-		current = current->getNextToken();
-		if (current) {
-			cline = current->getLineIndex();
-		}
-	}
-
-	return counter;
+	return table.getNoteCount(syllable);
 }
 
 
@@ -503,21 +503,13 @@ int Tool_thru::getLabelIndex(vector<string>& labels, string& key) {
 
 void Tool_thru::getLabelSequence(vector<string>& labelsequence,
 		const string& astring) {
-	int slength = (int)astring.size();
-	char* sdata = new char[slength+1];
-	strcpy(sdata, astring.c_str());
 	const char* ignorecharacters = ", [] ";
-	int index;
-
-	char* strptr = strtok(sdata, ignorecharacters);
-	while (strptr != NULL) {
-		labelsequence.resize((int)labelsequence.size() + 1);
-		index = (int)labelsequence.size() - 1;
-		labelsequence[index] = strptr;
-		strptr = strtok(NULL, ignorecharacters);
+	size_t start = astring.find_first_not_of(ignorecharacters);
+	while (start != string::npos) {
+		size_t end = astring.find_first_of(ignorecharacters, start);
+		labelsequence.push_back(astring.substr(start, end - start));
+		start = astring.find_first_not_of(ignorecharacters, end);
 	}
-
-	delete [] sdata;
 }
 
 
@@ -11,6 +11,9 @@
 // Last Modified: Mon Dec  5 23:28:50 PST 2016 Ported to humlib from humextras
 // Last Modified: Wed May 16 22:47:11 PDT 2018 Added **mxhm transposition
 // Last Modified: Thu Jun 14 15:30:53 PDT 2018 Added rest position transposition
+// Last Modified: Sun Oct 18 11:52:14 PDT 2026 Table-based transposition, --intervals
+// Last Modified: Sun Oct 18 22:39:20 PDT 2026 Do not exit for --help or option errors
+// Last Modified: Sun Oct 18 23:58:12 PDT 2026 Print --help and --example text
 // Filename:      tool-transpose.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-transpose.cpp
 // Syntax:        C++11; humlib; humlib
@@ -51,6 +54,7 @@ Tool_transpose::Tool_transpose(void) {
 	define("auto=b",          "auto. trans. inst. parts to concert pitch");
 	define("debug=b",         "print debugging statements");
 	define("s|spines=s:",     "transpose only specified spines");
+	define("intervals=s",     "list of intervals for multiple transpositions");
 	// quiet reversed with -T option (actively need to request transposition code now)
 	// define("q|quiet=b",       "suppress *Tr interpretations in output");
 	define("T|transcode=b",   "include transposition code to reverse transposition");
@@ -109,7 +113,10 @@ bool Tool_transpose::run(HumdrumFile& infile, ostream& out) {
 //
 
 bool Tool_transpose::run(HumdrumFile& infile) {
-	initialize(infile);
+	if (!initialize(infile)) {
+		// --help and similar options are not errors:
+		return !hasError();
+	}
 
 	if (ssettonicQ) {
 		transval = calculateTranspositionFromKey(ssettonic, infile);
@@ -144,7 +151,11 @@ bool Tool_transpose::run(HumdrumFile& infile) {
 				spineprocess[t] = false;
 			}
 		}
-		processFile(infile, spineprocess);
+		if (getBoolean("intervals")) {
+			processIntervals(infile, spineprocess);
+		} else {
+			processFile(infile, spineprocess);
+		}
 	}
 
 	return true;
@@ -152,6 +163,37 @@ bool Tool_transpose::run(HumdrumFile& infile) {
 
 
 
+//////////////////////////////
+//
+// Tool_transpose::processIntervals -- Print multiple transpositions of
+//     the input file, one segment for each interval in the --intervals
+//     list (such as "P1,M2,-m3").  The input data is parsed only once, and
+//     the transposition tables for each interval are reused if an interval
+//     is repeated.
+//
+
+void Tool_transpose::processIntervals(HumdrumFile& infile,
+		vector<bool>& spineprocess) {
+	HumRegex hre;
+	vector<string> intervals;
+	hre.split(intervals, getString("intervals"), "[\\s,]+");
+	string filename = infile.getFilename();
+	for (int i=0; i<(int)intervals.size(); i++) {
+		if (intervals[i].empty()) {
+			continue;
+		}
+		transval = getBase40ValueFromInterval(intervals[i]) + 40 * octave;
+		m_humdrum_text << "!!!!SEGMENT: ";
+		if (!filename.empty()) {
+			m_humdrum_text << filename << ":";
+		}
+		m_humdrum_text << intervals[i] << "\n";
+		processFile(infile, spineprocess);
+	}
+}
+
+
+
 //////////////////////////////
 //
 // Tool_transpose::convertScore -- create a concert pitch score from
@@ -845,15 +887,7 @@ void Tool_transpose::printHumdrumKernToken(HumdrumLine& record, int index,
 		m_humdrum_text << record.token(index);
 		return;
 	}
-	string buffer;
-	int tokencount = record.token(index)->getSubtokenCount();
-	for (int k=0; k<tokencount; k++) {
-		buffer = record.token(index)->getSubtoken(k);
-		printNewKernString(buffer, transval);
-		if (k<tokencount-1) {
-			m_humdrum_text << " ";
-		}
-	}
+	printNewKernString(*record.token(index), transval);
 }
 
 
@@ -898,54 +932,38 @@ cerr << "B40 = " << b40 << "\t" << pitch << endl;
 
 //////////////////////////////
 //
-// Tool_transpose::printNewKernString --
+// Tool_transpose::printNewKernString -- Print a transposed **kern token
+//     (which may be a chord).  The pitches are transposed with a lookup
+//     table for the interval, and the token is rewritten in a buffer that is
+//     reused for each token.
 //
 
 void Tool_transpose::printNewKernString(const string& input, int transval) {
+	m_kernBuffer = input;
+	getTransposer(transval).transposeKernToken(m_kernBuffer);
+	m_humdrum_text << m_kernBuffer;
+}
 
-	HumRegex hre;
-	if (input == ".") {
-		// Don't transpose null tokens.
-		m_humdrum_text << input;
-		return;
-	} else if (input.rfind('R') != string::npos) {
-		// Don't transpose unpitched notes (percussion parts).
-		m_humdrum_text << input;
-		return;
-	} else if (input.rfind('r') != string::npos) {
-		// Transpose rests only if they contain a pitch component.
-		string output = input;
-		if (hre.search(input, "([A-Ga-g]+[#n-]*)")) {
-			// Transpose pitch portion of rest (indicating vertical position).
-			string pitch = hre.getMatch(1);
-			int base40 = Convert::kernToBase40(pitch);
-cerr << "XPITCH " << pitch << "\tbase40 = " << base40 << endl;
-			string newpitch = Convert::base40ToKern(base40 + transval);
-cerr << "\tNEWPITCH " << pitch << endl;
-			hre.replaceDestructive(newpitch, "", "[-#n]+");
-			hre.replaceDestructive(output, newpitch, "([A-Ga-g]+[#n-]*)");
-		}
-		// don't transpose rests...
-		m_humdrum_text << output;
-		return;
-	} else if (!hre.search(input, "([A-Ga-g]+[#n-]*)")) {
-		// This is a form of invisible rest with no "r", just **recip.
-		m_humdrum_text << input;
-		return;
-	}
 
-	// Now the only thing left are regular pitches.
 
-	int base40 = Convert::kernToBase40(input);
-	string newpitch = Convert::base40ToKern(base40 + transval);
+//////////////////////////////
+//
+// Tool_transpose::getTransposer -- Return a base-40 transposer for the
+//     given interval.  Transposers are kept for each interval that has been
+//     used so that their lookup tables only need to be calculated once
+//     (such as when transposing parts to concert pitch).
+//
 
-	// consider interaction of #X -X n interaction vs. nX.
-	string output;
-	if (hre.search(input, "([A-Ga-g#n-]+)")) {
-		string oldpitch = hre.getMatch(1);
-		output = hre.replaceCopy(input, newpitch, oldpitch);
+HumTransposer& Tool_transpose::getTransposer(int transval) {
+	auto it = m_transposers.find(transval);
+	if (it != m_transposers.end()) {
+		return it->second;
 	}
-	m_humdrum_text << output;
+	HumTransposer& transposer = m_transposers[transval];
+	transposer.setBase40();
+	transposer.setTransposition(transval);
+	transposer.prepareKernTable();
+	return transposer;
 }
 
 
@@ -1040,8 +1058,13 @@ int Tool_transpose::getBase40ValueFromInterval(const string& interval) {
 //
 
 void Tool_transpose::example(void) {
-
-
+	m_free_text
+		<< getCommand() << " -t M3 file.krn      # transpose up a major third" << endl
+		<< getCommand() << " -t -P5 file.krn     # transpose down a perfect fifth" << endl
+		<< getCommand() << " -d 1 -c 2 file.krn  # same as -t M2" << endl
+		<< getCommand() << " -b 6 -s 2 file.krn  # transpose only the second spine" << endl
+		<< getCommand() << " -k e- file.krn      # transpose to the key of E-flat" << endl
+		<< getCommand() << " -C file.krn         # convert a written score to concert pitch" << endl;
 }
 
 
@@ -1052,7 +1075,20 @@ void Tool_transpose::example(void) {
 //
 
 void Tool_transpose::usage(const string& command) {
-
+	m_free_text
+		<< "Usage: " << command << " [-t interval | -b base40 | -d diatonic -c chromatic]"
+		<< " [options] [file(s)]" << endl
+		<< "Transpose **kern data (and key signatures, key designations and"
+		<< " *Tr codes)." << endl
+		<< "   -t interval  interval such as M3, -P5 or +m6" << endl
+		<< "   -b value     base-40 transposition interval" << endl
+		<< "   -d/-c value  diatonic and chromatic steps (both required)" << endl
+		<< "   -o value     octave transposition added to the interval" << endl
+		<< "   -k tonic     transpose to the given key" << endl
+		<< "   -s spines    transpose only the listed spines" << endl
+		<< "   -C / -W      convert between written and concert pitch" << endl
+		<< "   --auto       transpose instrumental parts to concert pitch" << endl
+		<< "   -T / -I      add *Tr / *ITr codes to the output" << endl;
 }
 
 
@@ -1573,26 +1609,27 @@ void Tool_transpose::addToHistogramDouble(vector<vector<double> >& histogram, in
 
 //////////////////////////////
 //
-// Tool_transpose::initialize --
+// Tool_transpose::initialize -- Returns false if the file should not be
+//     processed (such as for --help, or if there is an error in the options).
 //
 
-void Tool_transpose::initialize(HumdrumFile& infile) {
+bool Tool_transpose::initialize(HumdrumFile& infile) {
 
 	// handle basic options:
 	if (getBoolean("author")) {
 		m_free_text << "Written by Craig Stuart Sapp, "
 			  << "craig@ccrma.stanford.edu, 12 Apr 2004" << endl;
-		exit(0);
+		return false;
 	} else if (getBoolean("version")) {
 		m_free_text << getArg(0) << ", version: 10 Dec 2016" << endl;
 		m_free_text << "compiled: " << __DATE__ << endl;
-		exit(0);
+		return false;
 	} else if (getBoolean("help")) {
-		usage(getArg(0));
-		exit(0);
+		usage(getCommand());
+		return false;
 	} else if (getBoolean("example")) {
 		example();
-		exit(0);
+		return false;
 	}
 
 	transval     =  getInteger("base40");
@@ -1609,9 +1646,8 @@ void Tool_transpose::initialize(HumdrumFile& infile) {
 
 	switch (getBoolean("diatonic") + getBoolean("chromatic")) {
 		case 1:
-			cerr << "Error: both -d and -c options must be specified" << endl;
-			exit(1);
-			break;
+			m_error_text << "Error: both -d and -c options must be specified" << endl;
+			return false;
 		case 2:
 			{
 				char buffer[128] = {0};
@@ -1628,6 +1664,7 @@ void Tool_transpose::initialize(HumdrumFile& infile) {
 	}
 
 	transval += 40 * octave;
+	return true;
 }
 
 
@@ -192,31 +192,18 @@ void Tool_tspos::processFile(HumdrumFile& infile) {
 		chordPositions.clear();
 		thirdPositions.clear();
 		fifthPositions.clear();
-		for (int j=0; j<infile[i].getFieldCount(); j++) {
-			HTp token = infile.token(i, j); // get ptr to cell
-			// if not a **kern token, then skip:
-			if (!token->isKern()) {
-				continue;
-			}
-
-			if (token->isRest()) {
+		// Use the first note of each voice (chords count as a single voice),
+		// with null tokens resolved to the notes that they sustain:
+		HumSonority sonority = infile.getSonority(i);
+		int lastField = -1;
+		for (int j=0; j<sonority.getNoteCount(); j++) {
+			if (sonority.getFieldIndex(j) == lastField) {
 				continue;
 			}
-
-			HTp resolvedToken = NULL;
-			if (token->isNull()) {
-				resolvedToken = token->resolveNull();
-				if (!resolvedToken || resolvedToken->isRest()) {
-					continue;
-				}
-			}
-			if (resolvedToken) {
-				kernNotes.push_back(resolvedToken);
-			} else {
-				kernNotes.push_back(token);
-			}
+			lastField = sonority.getFieldIndex(j);
+			kernNotes.push_back(sonority.getToken(j));
+			midiNotes.push_back(sonority.getMidiPitch(j));
 		}
-		midiNotes = getMidiNotes(kernNotes);
 
 		if (m_colorThirds) { // thirds
 			thirdPositions = getThirds(midiNotes);
@@ -395,11 +382,7 @@ void Tool_tspos::analyzeVoiceCount(HumdrumFile& infile) {
 	vector<int>& voices = m_voiceCount;
 	voices.resize(infile.getLineCount());
 	for (int i=0; i<infile.getLineCount(); i++) {
-		if (!infile[i].isData()) {
-			voices[i] = 0;
-			continue;
-		}
-		voices[i] = countVoicesOnLine(infile, i);
+		voices[i] = infile.getSonority(i).getVoiceCount();
 	}
 }
 
@@ -422,37 +405,6 @@ void Tool_tspos::checkForTriadicSonority(vector<int>& positions, int line) {
 
 
 
-//////////////////////////////
-//
-// Tool_tspos::countVoicesOnLine --
-//
-
-int Tool_tspos::countVoicesOnLine(HumdrumFile& infile, int line) {
-	int output = 0;
-	for (int j=0; j<infile[line].getFieldCount(); j++) {
-		HTp token = infile.token(line, j);
-		if (!token->isKern()) {
-			continue;
-		}
-		if (token->isNull()) {
-			token = token->resolveNull();
-			if (!token) {
-				continue;
-			}
-			if (token->isNull()) {
-				continue;
-			}
-		}
-		if (token->isRest()) {
-			continue;
-		}
-		output++;
-	}
-	return output;
-}
-
-
-
 //////////////////////////////
 //
 // Tool_tspos::generateStatistics --
@@ -1285,30 +1237,6 @@ void Tool_tspos::keepOnlyDoubles(vector<int>& output) {
 
 
 
-//////////////////////////////
-//
-// Tool_tspos::getMidiNotes -- Convert kern notes to MIDI note numbers.
-//    If the note is sustaining, then make the MIDI note number negative.
-//
-
-vector<int> Tool_tspos::getMidiNotes(vector<HTp>& kernNotes) {
-	vector<int> output(kernNotes.size());
-	if (kernNotes.empty()) {
-		return output;
-	}
-	for (int i=0; i<(int)kernNotes.size(); i++) {
-		int midiNote = kernNotes.at(i)->getMidiPitch();
-		if (midiNote < 0) {
-			// negative values indicate sustained note.
-			midiNote = -midiNote;
-		}
-		output.at(i) = midiNote;
-	}
-	return output;
-}
-
-
-
 //////////////////////////////
 //
 // Tool_tspos::avoidRdfCollisions -- Adjust markers if they are already
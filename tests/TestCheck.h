@@ -0,0 +1,80 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 23:24:10 PDT 2026
+// Last Modified: Sun Oct 18 23:24:10 PDT 2026
+// Filename:      tests/TestCheck.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/tests/TestCheck.h
+// Syntax:        C++11
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Shared reporting for the self-checking test programs
+//                which are run by "make selftest".  Each failed check
+//                prints a "MISMATCH:" line to standard error, and report()
+//                prints a final "PASSED" or "FAILED" summary line and
+//                returns the exit status for main().
+//
+// Usage:         TestCheck test("tokens");
+//                test.check(a == b, "token text", filename);
+//                test.addCount();
+//                return test.report();
+//
+
+#ifndef _TESTCHECK_H_INCLUDED
+#define _TESTCHECK_H_INCLUDED
+
+#include <iostream>
+#include <string>
+
+class TestCheck {
+	public:
+		TestCheck(const std::string& units) : m_units(units) { }
+
+		// fail -- Count a failed check and return the error stream (after
+		//     "MISMATCH: ") so that the caller can describe it.
+		std::ostream& fail(void) {
+			m_failures++;
+			return std::cerr << "MISMATCH: ";
+		}
+
+		// check -- Report a failed check of the given file.
+		bool check(bool test, const std::string& label,
+				const std::string& filename) {
+			if (!test) {
+				fail() << label << " on " << filename << std::endl;
+			}
+			return test;
+		}
+
+		// addCount -- Add to the number of items checked, which is
+		//     printed in the summary line.
+		void addCount(int count = 1) {
+			m_count += count;
+		}
+
+		// setUnits -- Change the description of the items in the summary line.
+		void setUnits(const std::string& units) {
+			m_units = units;
+		}
+
+		int getFailureCount(void) const {
+			return m_failures;
+		}
+
+		// report -- Print the summary line and return the exit status.
+		int report(void) const {
+			std::cout << (m_failures ? "FAILED" : "PASSED") << ": " << m_count
+			          << " " << m_units << ", " << m_failures << " mismatches"
+			          << std::endl;
+			return m_failures ? 1 : 0;
+		}
+
+	private:
+		std::string m_units;
+		int m_count    = 0;
+		int m_failures = 0;
+};
+
+#endif /* _TESTCHECK_H_INCLUDED */
+
+
+
@@ -0,0 +1,1491 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 16:41:08 PDT 2026
+// Last Modified: Sun Oct 18 16:41:12 PDT 2026
+// Filename:      tests/test-benchmark/test-benchmark.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/tests/test-benchmark/test-benchmark.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Speed and memory benchmarks for the main humlib code paths.
+//                Synthetic scores of a given size are generated in Humdrum,
+//                MusicXML, MEI and MuseData formats (or a corpus of files is
+//                given on the command line), and then the time to read the
+//                files, analyze their structure and content, build NoteGrids,
+//                run a set of tools and convert the other formats to Humdrum
+//                is measured.  The results are printed as tab-separated
+//                values (or JSON lines with -j) so that the output of two
+//                versions of humlib can be compared with --compare.
+//
+// Usage:         make benchmark
+//                make test-benchmark
+//                bin/test-benchmark -p 8 -m 200 -s 4 -c 20 -l > new.tsv
+//                bin/test-benchmark files/*.krn > corpus.tsv
+//                bin/test-benchmark --compare old.tsv new.tsv
+//
+
+#include "humlib.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace hum;
+using namespace std;
+
+
+//////////////////////////////
+//
+// BenchSpec -- Size of the synthetic score.
+//
+
+class BenchSpec {
+	public:
+		int      parts    = 4;    // number of **kern spines
+		int      measures = 100;  // number of 4/4 measures
+		int      splits   = 0;    // split a part into two voices every N measures
+		int      chords   = 0;    // percentage of notes which are chords
+		bool     lyrics   = false; // add a **text spine to each part
+		unsigned seed     = 1;    // random number seed
+};
+
+
+//////////////////////////////
+//
+// BenchEvent -- A note, chord or rest in one voice of a synthetic measure.
+//    Durations are in eighth notes.
+//
+
+class BenchEvent {
+	public:
+		int         start    = 0;
+		int         length   = 1;
+		vector<int> pitches;        // diatonic*10+accidental offset; empty for rests
+		bool        tieStart = false;
+		bool        tieEnd   = false;
+		bool        slurStart = false;
+		bool        slurEnd  = false;
+		int         beam     = 0;   // 1 = beam start, 2 = beam end
+		string      syllable;
+		int         wordpos  = 0;   // 0 = single, 1 = initial, 2 = medial, 3 = terminal
+		string      id;
+};
+
+typedef vector<BenchEvent> BenchVoice;
+
+
+//////////////////////////////
+//
+// BenchScore -- Synthetic score: [part][measure][voice] events.
+//
+
+class BenchScore {
+	public:
+		BenchSpec spec;
+		vector<vector<vector<BenchVoice>>> parts;
+};
+
+
+//////////////////////////////
+//
+// BenchInput -- Input data for one format of the benchmarks.
+//
+
+class BenchInput {
+	public:
+		vector<string> humdrum;
+		vector<string> musicxml;
+		vector<string> mei;
+		vector<string> musedata;
+		string         description;
+};
+
+
+//////////////////////////////
+//
+// BenchResult -- Measurement of one benchmark.
+//
+
+class BenchResult {
+	public:
+		string    name;
+		string    group;
+		int       iterations = 0;
+		double    best       = 0.0;
+		double    median     = 0.0;
+		long long items      = 0;
+		string    unit;
+		long      peakRss    = 0;
+};
+
+
+//////////////////////////////
+//
+// BenchTimer -- Accumulate the time of the measured parts of an iteration.
+//
+
+class BenchTimer {
+	public:
+		void   start   (void) { m_start = chrono::steady_clock::now(); }
+		void   stop    (void) {
+			m_total += chrono::duration<double>(chrono::steady_clock::now() - m_start).count();
+		}
+		void   clear   (void) { m_total = 0.0; }
+		double elapsed (void) const { return m_total; }
+	private:
+		chrono::steady_clock::time_point m_start;
+		double m_total = 0.0;
+};
+
+typedef function<void(BenchTimer& timer)> BenchFunction;
+
+
+// function declarations:
+void        generateScore         (BenchScore& score, const BenchSpec& spec);
+void        generateVoice         (BenchVoice& voice, mt19937& rng, int center,
+                                   const BenchSpec& spec, int& pendingTie,
+                                   bool allowTie, bool lyrics, int& syllable);
+string      makeHumdrum           (const BenchScore& score);
+string      makeMusicXml          (const BenchScore& score);
+string      makeMei               (const BenchScore& score);
+string      makeMuseData          (const BenchScore& score);
+string      getKernToken          (const BenchEvent& event);
+string      getKernPitch          (int pitch);
+int         getVoiceCount         (const BenchSpec& spec, int part, int measure);
+void        loadCorpus            (BenchInput& input, Options& options);
+string      readFileContents      (const string& filename);
+long long   countTokens           (const vector<string>& contents);
+long long   countBytes            (const vector<string>& contents);
+void        runBenchmarks         (vector<BenchResult>& results,
+                                   const BenchInput& input, Options& options);
+void        addBenchmark          (vector<BenchResult>& results, Options& options,
+                                   const string& name, const string& group,
+                                   long long items, const string& unit,
+                                   const BenchFunction& function);
+template <class TOOL>
+void        addToolBenchmark      (vector<BenchResult>& results, Options& options,
+                                   const vector<string>& humdrum, long long tokens,
+                                   const string& command);
+void        printResults          (ostream& out, const vector<BenchResult>& results,
+                                   const BenchInput& input, bool jsonQ);
+int         compareResults        (ostream& out, const string& oldfile,
+                                   const string& newfile, double threshold);
+void        readResults           (map<string, BenchResult>& results,
+                                   vector<string>& order, const string& filename);
+void        resetPeakRss          (void);
+long        getPeakRss            (void);
+
+
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+	Options options;
+	options.define("p|parts=i:4",      "number of parts in the synthetic score");
+	options.define("m|measures=i:100", "number of measures in the synthetic score");
+	options.define("s|splits=i:0",     "split each part into two voices every N measures");
+	options.define("c|chords=i:0",     "percentage of notes which are chords");
+	options.define("l|lyrics=b",       "add a **text spine for each part");
+	options.define("seed=i:1",         "random number seed for the synthetic score");
+	options.define("r|repeat=i:5",     "number of times to run each benchmark");
+	options.define("b|benchmark=s",    "only run benchmarks whose name contains the string");
+	options.define("j|json=b",         "print results as JSON lines");
+	options.define("compare=b",        "compare the results in two files");
+	options.define("t|threshold=d:10", "percent slowdown reported as a regression");
+	options.define("save=s",           "write the synthetic score files with the given prefix");
+	options.process(argc, argv);
+
+	if (options.getBoolean("compare")) {
+		if (options.getArgCount() != 2) {
+			cerr << "Usage: " << options.getCommand()
+			     << " --compare old.tsv new.tsv" << endl;
+			return 1;
+		}
+		return compareResults(cout, options.getArg(1), options.getArg(2),
+				options.getDouble("threshold"));
+	}
+
+	BenchInput input;
+	if (options.getArgCount() > 0) {
+		loadCorpus(input, options);
+	} else {
+		BenchSpec spec;
+		spec.parts    = max(1, options.getInteger("parts"));
+		spec.measures = max(1, options.getInteger("measures"));
+		spec.splits   = max(0, options.getInteger("splits"));
+		spec.chords   = min(100, max(0, options.getInteger("chords")));
+		spec.lyrics   = options.getBoolean("lyrics");
+		spec.seed     = options.getInteger("seed");
+		BenchScore score;
+		generateScore(score, spec);
+		input.humdrum.push_back(makeHumdrum(score));
+		input.musicxml.push_back(makeMusicXml(score));
+		input.mei.push_back(makeMei(score));
+		input.musedata.push_back(makeMuseData(score));
+		stringstream description;
+		description << "synthetic parts=" << spec.parts
+		            << " measures=" << spec.measures
+		            << " splits=" << spec.splits
+		            << " chords=" << spec.chords
+		            << " lyrics=" << (spec.lyrics ? 1 : 0)
+		            << " seed=" << spec.seed;
+		input.description = description.str();
+		if (options.getBoolean("save")) {
+			string prefix = options.getString("save");
+			ofstream(prefix + ".krn") << input.humdrum[0];
+			ofstream(prefix + ".musicxml") << input.musicxml[0];
+			ofstream(prefix + ".mei") << input.mei[0];
+			ofstream(prefix + ".md2") << input.musedata[0];
+		}
+	}
+
+	vector<BenchResult> results;
+	runBenchmarks(results, input, options);
+	printResults(cout, results, input, options.getBoolean("json"));
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////
+
+
+
+//////////////////////////////
+//
+// runBenchmarks -- Time the main code paths on the input data.
+//
+
+void runBenchmarks(vector<BenchResult>& results, const BenchInput& input,
+		Options& options) {
+	const vector<string>& humdrum = input.humdrum;
+	long long tokens = countTokens(humdrum);
+
+	if (!humdrum.empty()) {
+		addBenchmark(results, options, "read", "file", tokens, "tokens",
+			[&](BenchTimer& timer) {
+				for (int i=0; i<(int)humdrum.size(); i++) {
+					HumdrumFile infile;
+					timer.start();
+					infile.readString(humdrum[i]);
+					timer.stop();
+				}
+			});
+
+		addBenchmark(results, options, "readNoRhythm", "file", tokens, "tokens",
+			[&](BenchTimer& timer) {
+				for (int i=0; i<(int)humdrum.size(); i++) {
+					HumdrumFile infile;
+					timer.start();
+					infile.readStringNoRhythm(humdrum[i]);
+					timer.stop();
+				}
+			});
+
+		addBenchmark(results, options, "analyzeStructure", "structure", tokens, "tokens",
+			[&](BenchTimer& timer) {
+				for (int i=0; i<(int)humdrum.size(); i++) {
+					HumdrumFile infile;
+					infile.readStringNoRhythm(humdrum[i]);
+					timer.start();
+					infile.analyzeStructure();
+					timer.stop();
+				}
+			});
+
+		// Content analyses: the passes which an analysis depends on
+		// are run before the timer is started.
+		vector<pair<string, HumFileAnalysis::Pass>> passes = {
+			{"analyzeOttavas",         HumFileAnalysis::PASS_OTTAVAS},
+			{"analyzeKernAccidentals", HumFileAnalysis::PASS_KERN_ACCIDENTALS},
+			{"analyzeSlurs",           HumFileAnalysis::PASS_SLURS},
+			{"analyzeBeams",           HumFileAnalysis::PASS_BEAMS},
+			{"analyzePhrasings",       HumFileAnalysis::PASS_PHRASES},
+			{"analyzeKernTies",        HumFileAnalysis::PASS_TIES},
+			{"analyzeBarlines",        HumFileAnalysis::PASS_BARLINES},
+			{"analyzeMeasureIndex",    HumFileAnalysis::PASS_MEASURES},
+			{"analyzeRestPositions",   HumFileAnalysis::PASS_REST_POSITIONS}
+		};
+		for (int p=0; p<(int)passes.size(); p++) {
+			HumFileAnalysis::Pass pass = passes[p].second;
+			addBenchmark(results, options, passes[p].first, "content", tokens, "tokens",
+				[&humdrum, pass](BenchTimer& timer) {
+					unsigned int dependencies = HumFileAnalysis::getDependencies(pass);
+					for (int i=0; i<(int)humdrum.size(); i++) {
+						HumdrumFile infile;
+						infile.readString(humdrum[i]);
+						for (int j=0; j<HumFileAnalysis::PASS_COUNT; j++) {
+							if (dependencies & (1u << j)) {
+								infile.requireAnalysis((HumFileAnalysis::Pass)j);
+							}
+						}
+						timer.start();
+						infile.requireAnalysis(pass);
+						timer.stop();
+					}
+				});
+		}
+
+		// Content analyses which are not managed by the pass registry:
+		vector<pair<string, function<void(HumdrumFile&)>>> analyses = {
+			{"analyzeTextRepetition",  [](HumdrumFile& infile) { infile.analyzeTextRepetition(); }},
+			{"analyzeKernStemLengths", [](HumdrumFile& infile) { infile.analyzeKernStemLengths(); }},
+			{"analyzeCrossStaffStemDirections",
+			                           [](HumdrumFile& infile) { infile.analyzeCrossStaffStemDirections(); }}
+		};
+		for (int a=0; a<(int)analyses.size(); a++) {
+			function<void(HumdrumFile&)> analysis = analyses[a].second;
+			addBenchmark(results, options, analyses[a].first, "content", tokens, "tokens",
+				[&humdrum, analysis](BenchTimer& timer) {
+					for (int i=0; i<(int)humdrum.size(); i++) {
+						HumdrumFile infile;
+						infile.readString(humdrum[i]);
+						timer.start();
+						analysis(infile);
+						timer.stop();
+					}
+				});
+		}
+
+		addBenchmark(results, options, "NoteGrid", "grid", tokens, "tokens",
+			[&](BenchTimer& timer) {
+				for (int i=0; i<(int)humdrum.size(); i++) {
+					HumdrumFile infile;
+					infile.readString(humdrum[i]);
+					timer.start();
+					NoteGrid grid(infile);
+					timer.stop();
+				}
+			});
+
+		addToolBenchmark<Tool_autobeam>(results, options, humdrum, tokens, "autobeam");
+		addToolBenchmark<Tool_binroll>(results, options, humdrum, tokens, "binroll");
+		addToolBenchmark<Tool_cint>(results, options, humdrum, tokens, "cint");
+		addToolBenchmark<Tool_dissonant>(results, options, humdrum, tokens, "dissonant");
+		addToolBenchmark<Tool_extract>(results, options, humdrum, tokens, "extract -s 1");
+		addToolBenchmark<Tool_imitation>(results, options, humdrum, tokens, "imitation");
+		addToolBenchmark<Tool_msearch>(results, options, humdrum, tokens, "msearch -p cde");
+		addToolBenchmark<Tool_myank>(results, options, humdrum, tokens, "myank -m 1-8");
+		addToolBenchmark<Tool_prange>(results, options, humdrum, tokens, "prange");
+		addToolBenchmark<Tool_recip>(results, options, humdrum, tokens, "recip -c");
+		addToolBenchmark<Tool_slurcheck>(results, options, humdrum, tokens, "slurcheck");
+		addToolBenchmark<Tool_tie>(results, options, humdrum, tokens, "tie -m");
+		addToolBenchmark<Tool_transpose>(results, options, humdrum, tokens, "transpose -t P5");
+	}
+
+	if (!input.musicxml.empty()) {
+		const vector<string>& musicxml = input.musicxml;
+		addBenchmark(results, options, "musicxml2hum", "convert", countBytes(musicxml), "bytes",
+			[&](BenchTimer& timer) {
+				for (int i=0; i<(int)musicxml.size(); i++) {
+					Tool_musicxml2hum converter;
+					stringstream out;
+					timer.start();
+					converter.convert(out, musicxml[i].c_str());
+					timer.stop();
+				}
+			});
+	}
+
+	if (!input.mei.empty()) {
+		const vector<string>& mei = input.mei;
+		addBenchmark(results, options, "mei2hum", "convert", countBytes(mei), "bytes",
+			[&](BenchTimer& timer) {
+				for (int i=0; i<(int)mei.size(); i++) {
+					Tool_mei2hum converter;
+					stringstream out;
+					timer.start();
+					converter.convert(out, mei[i].c_str());
+					timer.stop();
+				}
+			});
+	}
+
+	if (!input.musedata.empty()) {
+		const vector<string>& musedata = input.musedata;
+		addBenchmark(results, options, "musedata2hum", "convert", countBytes(musedata), "bytes",
+			[&](BenchTimer& timer) {
+				for (int i=0; i<(int)musedata.size(); i++) {
+					Tool_musedata2hum converter;
+					stringstream out;
+					timer.start();
+					converter.convertString(out, musedata[i]);
+					timer.stop();
+				}
+			});
+	}
+}
+
+
+
+//////////////////////////////
+//
+// addToolBenchmark -- Time a tool running on already-read input files.
+//
+
+template <class TOOL>
+void addToolBenchmark(vector<BenchResult>& results, Options& options,
+		const vector<string>& humdrum, long long tokens, const string& command) {
+	string name = "tool:" + command;
+	addBenchmark(results, options, name, "tool", tokens, "tokens",
+		[&humdrum, command](BenchTimer& timer) {
+			for (int i=0; i<(int)humdrum.size(); i++) {
+				HumdrumFile infile;
+				infile.readString(humdrum[i]);
+				TOOL tool;
+				tool.process(command);
+				timer.start();
+				tool.run(infile);
+				timer.stop();
+			}
+		});
+}
+
+
+
+//////////////////////////////
+//
+// addBenchmark -- Run a benchmark the requested number of times and
+//    store the best and median times as well as the peak memory usage.
+//
+
+void addBenchmark(vector<BenchResult>& results, Options& options,
+		const string& name, const string& group, long long items,
+		const string& unit, const BenchFunction& function) {
+	if (options.getBoolean("benchmark")) {
+		if (name.find(options.getString("benchmark")) == string::npos) {
+			return;
+		}
+	}
+	int iterations = max(1, options.getInteger("repeat"));
+
+	// Warnings printed by the converters and tools are not of interest here:
+	stringstream messages;
+	streambuf* errorbuffer = cerr.rdbuf(messages.rdbuf());
+
+	resetPeakRss();
+	vector<double> times;
+	BenchTimer timer;
+	for (int i=0; i<iterations; i++) {
+		timer.clear();
+		function(timer);
+		times.push_back(timer.elapsed());
+		messages.str("");
+	}
+	sort(times.begin(), times.end());
+	cerr.rdbuf(errorbuffer);
+
+	BenchResult result;
+	result.name       = name;
+	result.group      = group;
+	result.iterations = iterations;
+	result.best       = times[0];
+	result.median     = times[times.size() / 2];
+	result.items      = items;
+	result.unit       = unit;
+	result.peakRss    = getPeakRss();
+	results.push_back(result);
+}
+
+
+
+//////////////////////////////
+//
+// printResults -- Print the results as tab-separated values or as JSON
+//    lines.  Throughput is calculated from the median time.
+//
+
+void printResults(ostream& out, const vector<BenchResult>& results,
+		const BenchInput& input, bool jsonQ) {
+	if (!jsonQ) {
+		out << "#input\t" << input.description << "\n";
+		out << "#benchmark\tgroup\titerations\tbest_seconds\tmedian_seconds"
+		    << "\titems\tunit\titems_per_second\tpeak_rss_kb\n";
+	}
+	for (int i=0; i<(int)results.size(); i++) {
+		const BenchResult& result = results[i];
+		double rate = result.median > 0.0 ? result.items / result.median : 0.0;
+		if (jsonQ) {
+			out << "{\"benchmark\":\"" << result.name << "\""
+			    << ",\"group\":\"" << result.group << "\""
+			    << ",\"input\":\"" << input.description << "\""
+			    << ",\"iterations\":" << result.iterations
+			    << ",\"best_seconds\":" << result.best
+			    << ",\"median_seconds\":" << result.median
+			    << ",\"items\":" << result.items
+			    << ",\"unit\":\"" << result.unit << "\""
+			    << ",\"items_per_second\":" << (long long)rate
+			    << ",\"peak_rss_kb\":" << result.peakRss
+			    << "}\n";
+		} else {
+			out << result.name
+			    << "\t" << result.group
+			    << "\t" << result.iterations
+			    << "\t" << result.best
+			    << "\t" << result.median
+			    << "\t" << result.items
+			    << "\t" << result.unit
+			    << "\t" << (long long)rate
+			    << "\t" << result.peakRss
+			    << "\n";
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// compareResults -- Print the ratio of the median times of two result
+//    files.  Returns 1 if any benchmark is slower than the threshold
+//    percentage, otherwise 0.
+//
+
+int compareResults(ostream& out, const string& oldfile, const string& newfile,
+		double threshold) {
+	map<string, BenchResult> oldresults;
+	map<string, BenchResult> newresults;
+	vector<string> oldorder;
+	vector<string> neworder;
+	readResults(oldresults, oldorder, oldfile);
+	readResults(newresults, neworder, newfile);
+
+	int status = 0;
+	out << "#benchmark\told_median_seconds\tnew_median_seconds\tratio"
+	    << "\told_peak_rss_kb\tnew_peak_rss_kb\tstatus\n";
+	for (int i=0; i<(int)neworder.size(); i++) {
+		auto it = oldresults.find(neworder[i]);
+		if (it == oldresults.end()) {
+			continue;
+		}
+		const BenchResult& oldresult = it->second;
+		const BenchResult& newresult = newresults[neworder[i]];
+		double ratio = oldresult.median > 0.0 ? newresult.median / oldresult.median : 0.0;
+		string label = "ok";
+		if (ratio > 1.0 + threshold / 100.0) {
+			label = "slower";
+			status = 1;
+		} else if ((ratio > 0.0) && (ratio < 1.0 - threshold / 100.0)) {
+			label = "faster";
+		}
+		out << neworder[i]
+		    << "\t" << oldresult.median
+		    << "\t" << newresult.median
+		    << "\t" << ratio
+		    << "\t" << oldresult.peakRss
+		    << "\t" << newresult.peakRss
+		    << "\t" << label
+		    << "\n";
+	}
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// readResults -- Read a tab-separated results file.
+//
+
+void readResults(map<string, BenchResult>& results, vector<string>& order,
+		const string& filename) {
+	ifstream infile(filename);
+	if (!infile.is_open()) {
+		cerr << "Error: cannot read " << filename << endl;
+		exit(1);
+	}
+	string line;
+	while (getline(infile, line)) {
+		if (line.empty() || (line[0] == '#')) {
+			continue;
+		}
+		vector<string> fields;
+		stringstream ss(line);
+		string field;
+		while (getline(ss, field, '\t')) {
+			fields.push_back(field);
+		}
+		if (fields.size() < 9) {
+			continue;
+		}
+		BenchResult result;
+		result.name       = fields[0];
+		result.group      = fields[1];
+		result.iterations = atoi(fields[2].c_str());
+		result.best       = atof(fields[3].c_str());
+		result.median     = atof(fields[4].c_str());
+		result.items      = atoll(fields[5].c_str());
+		result.unit       = fields[6];
+		result.peakRss    = atol(fields[8].c_str());
+		if (results.find(result.name) == results.end()) {
+			order.push_back(result.name);
+		}
+		results[result.name] = result;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// loadCorpus -- Read the files given on the command line.  The format
+//    is determined from the filename extension; all other files are
+//    treated as Humdrum data.
+//
+
+void loadCorpus(BenchInput& input, Options& options) {
+	for (int i=1; i<=options.getArgCount(); i++) {
+		string filename = options.getArg(i);
+		string contents = readFileContents(filename);
+		string extension;
+		auto pos = filename.rfind('.');
+		if (pos != string::npos) {
+			extension = filename.substr(pos + 1);
+		}
+		if ((extension == "xml") || (extension == "musicxml")) {
+			input.musicxml.push_back(contents);
+		} else if (extension == "mei") {
+			input.mei.push_back(contents);
+		} else if ((extension == "md2") || (extension == "msd")) {
+			input.musedata.push_back(contents);
+		} else {
+			input.humdrum.push_back(contents);
+		}
+	}
+	stringstream description;
+	description << "corpus humdrum=" << input.humdrum.size()
+	            << " musicxml=" << input.musicxml.size()
+	            << " mei=" << input.mei.size()
+	            << " musedata=" << input.musedata.size();
+	input.description = description.str();
+}
+
+
+
+//////////////////////////////
+//
+// readFileContents -- Return the contents of a file.
+//
+
+string readFileContents(const string& filename) {
+	ifstream infile(filename, ios::binary);
+	if (!infile.is_open()) {
+		cerr << "Error: cannot read " << filename << endl;
+		exit(1);
+	}
+	stringstream buffer;
+	buffer << infile.rdbuf();
+	return buffer.str();
+}
+
+
+
+//////////////////////////////
+//
+// countTokens -- Return the number of tokens in a list of Humdrum files.
+//
+
+long long countTokens(const vector<string>& contents) {
+	long long output = 0;
+	for (int i=0; i<(int)contents.size(); i++) {
+		HumdrumFile infile;
+		infile.readStringNoRhythm(contents[i]);
+		for (int j=0; j<infile.getLineCount(); j++) {
+			output += infile[j].getFieldCount();
+		}
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// countBytes -- Return the total size of a list of files.
+//
+
+long long countBytes(const vector<string>& contents) {
+	long long output = 0;
+	for (int i=0; i<(int)contents.size(); i++) {
+		output += contents[i].size();
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// resetPeakRss -- Reset the peak resident set size of the process so
+//    that the memory usage of each benchmark can be measured separately.
+//    This is only possible on Linux; on other systems the peak for the
+//    whole process is reported.
+//
+
+void resetPeakRss(void) {
+	ofstream clear("/proc/self/clear_refs");
+	if (clear.is_open()) {
+		clear << "5" << endl;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// getPeakRss -- Return the peak resident set size in kilobytes.
+//
+
+long getPeakRss(void) {
+	ifstream status("/proc/self/status");
+	string line;
+	while (getline(status, line)) {
+		if (line.compare(0, 6, "VmHWM:") == 0) {
+			return atol(line.c_str() + 6);
+		}
+	}
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+	return usage.ru_maxrss / 1024;
+#else
+	return usage.ru_maxrss;
+#endif
+}
+
+
+
+//////////////////////////////
+//
+// getVoiceCount -- Parts are split into two voices every "splits"
+//     measures, with the split measures staggered between parts.  The
+//     first measure is never split.
+//
+
+int getVoiceCount(const BenchSpec& spec, int part, int measure) {
+	if ((spec.splits <= 0) || (measure == 0)) {
+		return 1;
+	}
+	return ((measure + part) % spec.splits == spec.splits - 1) ? 2 : 1;
+}
+
+
+
+//////////////////////////////
+//
+// generateScore -- Create the notes of a synthetic score.  The music is
+//    random, but the same seed always generates the same score.
+//
+
+void generateScore(BenchScore& score, const BenchSpec& spec) {
+	score.spec = spec;
+	score.parts.clear();
+	score.parts.resize(spec.parts);
+	mt19937 rng(spec.seed);
+	for (int p=0; p<spec.parts; p++) {
+		// Parts are ordered from lowest to highest:
+		int center = 7 * 3 + 3 * (p % 5);
+		int pendingTie = -1;
+		int syllable = 0;
+		score.parts[p].resize(spec.measures);
+		for (int m=0; m<spec.measures; m++) {
+			int vcount = getVoiceCount(spec, p, m);
+			bool allowTie = (vcount == 1) && (m < spec.measures - 1) &&
+					(getVoiceCount(spec, p, m + 1) == 1);
+			score.parts[p][m].resize(vcount);
+			for (int v=0; v<vcount; v++) {
+				int dummyTie = -1;
+				generateVoice(score.parts[p][m][v], rng, center + 4 * v, spec,
+						v == 0 ? pendingTie : dummyTie, (v == 0) && allowTie,
+						(v == 0) && spec.lyrics, syllable);
+			}
+		}
+	}
+
+	// Assign xml:ids for MEI:
+	for (int p=0; p<(int)score.parts.size(); p++) {
+		for (int m=0; m<(int)score.parts[p].size(); m++) {
+			for (int v=0; v<(int)score.parts[p][m].size(); v++) {
+				BenchVoice& voice = score.parts[p][m][v];
+				for (int e=0; e<(int)voice.size(); e++) {
+					voice[e].id = "n" + to_string(p + 1) + "m" + to_string(m + 1)
+							+ "v" + to_string(v + 1) + "e" + to_string(e + 1);
+				}
+			}
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// generateVoice -- Fill one voice of a measure with eighth-note-based
+//     rhythms and a random walk of pitches.  pendingTie is the pitch
+//     tied from the previous measure (or -1).
+//
+
+void generateVoice(BenchVoice& voice, mt19937& rng, int center,
+		const BenchSpec& spec, int& pendingTie, bool allowTie, bool lyrics,
+		int& syllable) {
+	static const vector<string> syllables = {"la", "mi", "re", "do", "sol",
+			"fa", "ti", "na", "ve", "ro"};
+	const int lengths[5] = {1, 1, 2, 3, 4};
+	int position = 0;
+	int diatonic = center;
+	voice.clear();
+	while (position < 8) {
+		BenchEvent event;
+		event.start = position;
+		event.length = lengths[rng() % 5];
+		if (position + event.length > 8) {
+			event.length = 8 - position;
+		}
+		if (event.length == 3 && (position % 2)) {
+			event.length = 1;
+		}
+		position += event.length;
+
+		if (pendingTie >= 0) {
+			event.pitches.push_back(pendingTie);
+			event.tieEnd = true;
+			pendingTie = -1;
+			voice.push_back(event);
+			continue;
+		}
+		if (rng() % 20 == 0) {
+			// rest
+			voice.push_back(event);
+			continue;
+		}
+		diatonic += (int)(rng() % 5) - 2;
+		if (diatonic > center + 5) {
+			diatonic = center + 3;
+		} else if (diatonic < center - 5) {
+			diatonic = center - 3;
+		}
+		int accid = 0;
+		int choice = rng() % 10;
+		if (choice == 0) {
+			accid = 1;
+		} else if (choice == 1) {
+			accid = -1;
+		}
+		event.pitches.push_back(diatonic * 10 + accid + 5);
+		if ((spec.chords > 0) && ((int)(rng() % 100) < spec.chords)) {
+			event.pitches.push_back((diatonic + 2) * 10 + 5);
+			if (rng() % 2) {
+				event.pitches.push_back((diatonic + 4) * 10 + 5);
+			}
+		}
+		voice.push_back(event);
+	}
+
+	// Ties across the barline:
+	BenchEvent& last = voice.back();
+	if (allowTie && !last.pitches.empty() && (last.pitches.size() == 1) &&
+			!last.tieEnd && (rng() % 8 == 0)) {
+		last.tieStart = true;
+		pendingTie = last.pitches[0];
+	}
+
+	// Beams on pairs of eighth notes on the beat:
+	for (int i=0; i<(int)voice.size() - 1; i++) {
+		if ((voice[i].length == 1) && (voice[i+1].length == 1) &&
+				(voice[i].start % 2 == 0) && !voice[i].pitches.empty() &&
+				!voice[i+1].pitches.empty()) {
+			voice[i].beam = 1;
+			voice[i+1].beam = 2;
+			i++;
+		}
+	}
+
+	// A slur over the notes of the measure:
+	int first = -1;
+	int lastnote = -1;
+	for (int i=0; i<(int)voice.size(); i++) {
+		if (!voice[i].pitches.empty()) {
+			if (first < 0) {
+				first = i;
+			}
+			lastnote = i;
+		}
+	}
+	if ((first >= 0) && (lastnote > first) && (rng() % 3 == 0)) {
+		voice[first].slurStart = true;
+		voice[lastnote].slurEnd = true;
+	}
+
+	if (!lyrics) {
+		return;
+	}
+	// Words of one to three syllables on the attacked notes:
+	int wordlength = 0;
+	int wordindex = 0;
+	for (int i=0; i<(int)voice.size(); i++) {
+		if (voice[i].pitches.empty() || voice[i].tieEnd) {
+			continue;
+		}
+		if (wordindex >= wordlength) {
+			wordlength = 1 + rng() % 3;
+			wordindex = 0;
+		}
+		voice[i].syllable = syllables[syllable++ % syllables.size()];
+		if (wordlength == 1) {
+			voice[i].wordpos = 0;
+		} else if (wordindex == 0) {
+			voice[i].wordpos = 1;
+		} else if (wordindex == wordlength - 1) {
+			voice[i].wordpos = 3;
+		} else {
+			voice[i].wordpos = 2;
+		}
+		wordindex++;
+	}
+	// Do not leave a word unfinished at the end of the measure:
+	for (int i=(int)voice.size() - 1; i>=0; i--) {
+		if (voice[i].syllable.empty()) {
+			continue;
+		}
+		if (voice[i].wordpos == 1) {
+			voice[i].wordpos = 0;
+		} else if (voice[i].wordpos == 2) {
+			voice[i].wordpos = 3;
+		}
+		break;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// getKernPitch -- Convert a generated pitch into **kern.
+//
+
+string getKernPitch(int pitch) {
+	int diatonic = pitch / 10;
+	int accid = pitch % 10 - 5;
+	int octave = diatonic / 7;
+	char letter = "cdefgab"[diatonic % 7];
+	string output;
+	if (octave >= 4) {
+		output.append(octave - 3, letter);
+	} else {
+		output.append(4 - octave, toupper(letter));
+	}
+	if (accid > 0) {
+		output += '#';
+	} else if (accid < 0) {
+		output += '-';
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// getKernToken -- Convert a note, chord or rest into a **kern token.
+//
+
+string getKernToken(const BenchEvent& event) {
+	static const char* recip[5] = {"", "8", "4", "4.", "2"};
+	if (event.pitches.empty()) {
+		return string(recip[event.length]) + "r";
+	}
+	string output;
+	for (int i=0; i<(int)event.pitches.size(); i++) {
+		if (i > 0) {
+			output += ' ';
+		}
+		if (i == 0 && event.slurStart) {
+			output += '(';
+		}
+		if (event.tieStart) {
+			output += '[';
+		}
+		output += recip[event.length];
+		output += getKernPitch(event.pitches[i]);
+		if (event.tieEnd) {
+			output += ']';
+		}
+		if (i == 0 && event.slurEnd) {
+			output += ')';
+		}
+		if (i == 0 && event.beam == 1) {
+			output += 'L';
+		} else if (i == 0 && event.beam == 2) {
+			output += 'J';
+		}
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// makeHumdrum -- Print the synthetic score as Humdrum data, with the
+//    lowest part on the left.
+//
+
+string makeHumdrum(const BenchScore& score) {
+	const BenchSpec& spec = score.spec;
+	stringstream out;
+	int pcount = (int)score.parts.size();
+
+	auto printInterp = [&](const string& kern, const string& text) {
+		for (int p=0; p<pcount; p++) {
+			out << (p ? "\t" : "") << kern;
+			if (spec.lyrics) {
+				out << "\t" << text;
+			}
+		}
+		out << "\n";
+	};
+
+	out << "!!!COM: Synthetic\n";
+	out << "!!!OTL: humlib benchmark score\n";
+	printInterp("**kern", "**text");
+	for (int p=0; p<pcount; p++) {
+		out << (p ? "\t" : "") << "*staff" << (pcount - p);
+		if (spec.lyrics) {
+			out << "\t*staff" << (pcount - p);
+		}
+	}
+	out << "\n";
+	for (int p=0; p<pcount; p++) {
+		out << (p ? "\t" : "") << (p == 0 ? "*clefF4" : "*clefG2");
+		if (spec.lyrics) {
+			out << "\t*";
+		}
+	}
+	out << "\n";
+	printInterp("*k[]", "*");
+	printInterp("*M4/4", "*");
+
+	for (int m=0; m<spec.measures; m++) {
+		printInterp("=" + to_string(m + 1), "=" + to_string(m + 1));
+
+		bool hasSplit = false;
+		for (int p=0; p<pcount; p++) {
+			hasSplit |= score.parts[p][m].size() > 1;
+		}
+		if (hasSplit) {
+			for (int p=0; p<pcount; p++) {
+				out << (p ? "\t" : "") << (score.parts[p][m].size() > 1 ? "*^" : "*");
+				if (spec.lyrics) {
+					out << "\t*";
+				}
+			}
+			out << "\n";
+		}
+
+		for (int slice=0; slice<8; slice++) {
+			for (int p=0; p<pcount; p++) {
+				string text = ".";
+				for (int v=0; v<(int)score.parts[p][m].size(); v++) {
+					string token = ".";
+					const BenchVoice& voice = score.parts[p][m][v];
+					for (int e=0; e<(int)voice.size(); e++) {
+						if (voice[e].start == slice) {
+							token = getKernToken(voice[e]);
+							if (!voice[e].syllable.empty()) {
+								text = voice[e].syllable;
+								if ((voice[e].wordpos == 2) || (voice[e].wordpos == 3)) {
+									text = "-" + text;
+								}
+								if ((voice[e].wordpos == 1) || (voice[e].wordpos == 2)) {
+									text += "-";
+								}
+							}
+							break;
+						}
+					}
+					out << ((p || v) ? "\t" : "") << token;
+				}
+				if (spec.lyrics) {
+					out << "\t" << text;
+				}
+			}
+			out << "\n";
+		}
+
+		if (hasSplit) {
+			for (int p=0; p<pcount; p++) {
+				out << (p ? "\t" : "") << (score.parts[p][m].size() > 1 ? "*v\t*v" : "*");
+				if (spec.lyrics) {
+					out << "\t*";
+				}
+			}
+			out << "\n";
+		}
+	}
+
+	printInterp("==", "==");
+	printInterp("*-", "*-");
+	return out.str();
+}
+
+
+
+//////////////////////////////
+//
+// makeMusicXml -- Print the synthetic score as partwise MusicXML, with
+//    the highest part first.  There are two divisions per quarter note.
+//
+
+string makeMusicXml(const BenchScore& score) {
+	static const char* types[5] = {"", "eighth", "quarter", "quarter", "half"};
+	static const char* wordpos[4] = {"single", "begin", "middle", "end"};
+	const BenchSpec& spec = score.spec;
+	int pcount = (int)score.parts.size();
+	stringstream out;
+	out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+	out << "<score-partwise version=\"3.1\">\n";
+	out << "<work><work-title>humlib benchmark score</work-title></work>\n";
+	out << "<part-list>\n";
+	for (int p=pcount-1; p>=0; p--) {
+		out << "<score-part id=\"P" << (pcount - p) << "\"><part-name>Part "
+		    << (pcount - p) << "</part-name></score-part>\n";
+	}
+	out << "</part-list>\n";
+
+	for (int p=pcount-1; p>=0; p--) {
+		out << "<part id=\"P" << (pcount - p) << "\">\n";
+		for (int m=0; m<spec.measures; m++) {
+			out << "<measure number=\"" << (m + 1) << "\">\n";
+			if (m == 0) {
+				out << "<attributes><divisions>2</divisions>"
+				    << "<key><fifths>0</fifths></key>"
+				    << "<time><beats>4</beats><beat-type>4</beat-type></time>"
+				    << (p == 0 ? "<clef><sign>F</sign><line>4</line></clef>"
+				               : "<clef><sign>G</sign><line>2</line></clef>")
+				    << "</attributes>\n";
+			}
+			for (int v=0; v<(int)score.parts[p][m].size(); v++) {
+				if (v > 0) {
+					out << "<backup><duration>8</duration></backup>\n";
+				}
+				const BenchVoice& voice = score.parts[p][m][v];
+				for (int e=0; e<(int)voice.size(); e++) {
+					const BenchEvent& event = voice[e];
+					int count = max(1, (int)event.pitches.size());
+					for (int i=0; i<count; i++) {
+						out << "<note>";
+						if (i > 0) {
+							out << "<chord/>";
+						}
+						int accid = 0;
+						if (event.pitches.empty()) {
+							out << "<rest/>";
+						} else {
+							int diatonic = event.pitches[i] / 10;
+							accid = event.pitches[i] % 10 - 5;
+							out << "<pitch><step>" << "CDEFGAB"[diatonic % 7] << "</step>";
+							if (accid) {
+								out << "<alter>" << accid << "</alter>";
+							}
+							out << "<octave>" << (diatonic / 7) << "</octave></pitch>";
+						}
+						out << "<duration>" << event.length << "</duration>";
+						if (event.tieEnd) {
+							out << "<tie type=\"stop\"/>";
+						}
+						if (event.tieStart) {
+							out << "<tie type=\"start\"/>";
+						}
+						out << "<voice>" << (v + 1) << "</voice>";
+						out << "<type>" << types[event.length] << "</type>";
+						if (event.length == 3) {
+							out << "<dot/>";
+						}
+						if (accid) {
+							out << "<accidental>" << (accid > 0 ? "sharp" : "flat") << "</accidental>";
+						}
+						if (i == 0 && event.beam) {
+							out << "<beam number=\"1\">" << (event.beam == 1 ? "begin" : "end") << "</beam>";
+						}
+						if (event.tieStart || event.tieEnd || (i == 0 && (event.slurStart || event.slurEnd))) {
+							out << "<notations>";
+							if (event.tieEnd) {
+								out << "<tied type=\"stop\"/>";
+							}
+							if (event.tieStart) {
+								out << "<tied type=\"start\"/>";
+							}
+							if (i == 0 && event.slurStart) {
+								out << "<slur type=\"start\" number=\"1\"/>";
+							}
+							if (i == 0 && event.slurEnd) {
+								out << "<slur type=\"stop\" number=\"1\"/>";
+							}
+							out << "</notations>";
+						}
+						if (i == 0 && !event.syllable.empty()) {
+							out << "<lyric number=\"1\"><syllabic>" << wordpos[event.wordpos]
+							    << "</syllabic><text>" << event.syllable << "</text></lyric>";
+						}
+						out << "</note>\n";
+					}
+				}
+			}
+			if (m == spec.measures - 1) {
+				out << "<barline location=\"right\"><bar-style>light-heavy</bar-style></barline>\n";
+			}
+			out << "</measure>\n";
+		}
+		out << "</part>\n";
+	}
+	out << "</score-partwise>\n";
+	return out.str();
+}
+
+
+
+//////////////////////////////
+//
+// makeMei -- Print the synthetic score as MEI, with the highest part
+//    as the first staff.
+//
+
+string makeMei(const BenchScore& score) {
+	static const char* durs[5] = {"", "8", "4", "4", "2"};
+	static const char* wordpos[4] = {"", "i", "m", "t"};
+	const BenchSpec& spec = score.spec;
+	int pcount = (int)score.parts.size();
+	stringstream out;
+	out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+	out << "<mei xmlns=\"http://www.music-encoding.org/ns/mei\" meiversion=\"4.0.0\">\n";
+	out << "<meiHead><fileDesc><titleStmt><title>humlib benchmark score</title>"
+	    << "</titleStmt><pubStmt/></fileDesc></meiHead>\n";
+	out << "<music><body><mdiv><score>\n";
+	out << "<scoreDef meter.count=\"4\" meter.unit=\"4\" key.sig=\"0\">\n";
+	out << "<staffGrp>\n";
+	for (int p=pcount-1; p>=0; p--) {
+		out << "<staffDef n=\"" << (pcount - p) << "\" lines=\"5\" "
+		    << (p == 0 ? "clef.shape=\"F\" clef.line=\"4\"" : "clef.shape=\"G\" clef.line=\"2\"")
+		    << "/>\n";
+	}
+	out << "</staffGrp>\n";
+	out << "</scoreDef>\n";
+	out << "<section>\n";
+
+	auto printNote = [&](const BenchEvent& event, int pitch, bool chordnote) {
+		int diatonic = pitch / 10;
+		int accid = pitch % 10 - 5;
+		out << "<note";
+		if (!chordnote) {
+			out << " xml:id=\"" << event.id << "\" dur=\"" << durs[event.length] << "\"";
+			if (event.length == 3) {
+				out << " dots=\"1\"";
+			}
+		}
+		out << " pname=\"" << "cdefgab"[diatonic % 7] << "\" oct=\"" << (diatonic / 7) << "\"";
+		if (accid) {
+			out << " accid=\"" << (accid > 0 ? "s" : "f") << "\"";
+		}
+		if (event.tieStart && event.tieEnd) {
+			out << " tie=\"m\"";
+		} else if (event.tieStart) {
+			out << " tie=\"i\"";
+		} else if (event.tieEnd) {
+			out << " tie=\"t\"";
+		}
+		if ((pitch == event.pitches[0]) && !event.syllable.empty()) {
+			out << "><verse n=\"1\"><syl";
+			if (event.wordpos) {
+				out << " wordpos=\"" << wordpos[event.wordpos] << "\"";
+				if (event.wordpos != 3) {
+					out << " con=\"d\"";
+				}
+			}
+			out << ">" << event.syllable << "</syl></verse></note>";
+		} else {
+			out << "/>";
+		}
+	};
+
+	for (int m=0; m<spec.measures; m++) {
+		out << "<measure n=\"" << (m + 1) << "\""
+		    << (m == spec.measures - 1 ? " right=\"end\"" : "") << ">\n";
+		for (int p=pcount-1; p>=0; p--) {
+			out << "<staff n=\"" << (pcount - p) << "\">";
+			for (int v=0; v<(int)score.parts[p][m].size(); v++) {
+				out << "<layer n=\"" << (v + 1) << "\">";
+				const BenchVoice& voice = score.parts[p][m][v];
+				for (int e=0; e<(int)voice.size(); e++) {
+					const BenchEvent& event = voice[e];
+					if (event.beam == 1) {
+						out << "<beam>";
+					}
+					if (event.pitches.empty()) {
+						out << "<rest xml:id=\"" << event.id << "\" dur=\"" << durs[event.length] << "\""
+						    << (event.length == 3 ? " dots=\"1\"" : "") << "/>";
+					} else if (event.pitches.size() == 1) {
+						printNote(event, event.pitches[0], false);
+					} else {
+						out << "<chord xml:id=\"" << event.id << "\" dur=\"" << durs[event.length] << "\""
+						    << (event.length == 3 ? " dots=\"1\"" : "") << ">";
+						for (int i=0; i<(int)event.pitches.size(); i++) {
+							printNote(event, event.pitches[i], true);
+						}
+						out << "</chord>";
+					}
+					if (event.beam == 2) {
+						out << "</beam>";
+					}
+				}
+				out << "</layer>";
+			}
+			out << "</staff>\n";
+		}
+		// Slurs in this measure:
+		for (int p=pcount-1; p>=0; p--) {
+			for (int v=0; v<(int)score.parts[p][m].size(); v++) {
+				const BenchVoice& voice = score.parts[p][m][v];
+				string startid;
+				for (int e=0; e<(int)voice.size(); e++) {
+					if (voice[e].slurStart) {
+						startid = voice[e].id;
+					}
+					if (voice[e].slurEnd && !startid.empty()) {
+						out << "<slur staff=\"" << (pcount - p) << "\" startid=\"#"
+						    << startid << "\" endid=\"#" << voice[e].id << "\"/>\n";
+					}
+				}
+			}
+		}
+		out << "</measure>\n";
+	}
+
+	out << "</section>\n";
+	out << "</score></mdiv></body></music>\n";
+	out << "</mei>\n";
+	return out.str();
+}
+
+
+
+//////////////////////////////
+//
+// makeMuseData -- Print the synthetic score as MuseData stage 2 files
+//    (one after another, with the highest part first).  There are two
+//    divisions per quarter note.
+//
+
+string makeMuseData(const BenchScore& score) {
+	static const char* types[5] = {"", "e", "q", "q", "h"};
+	const BenchSpec& spec = score.spec;
+	int pcount = (int)score.parts.size();
+	stringstream out;
+
+	// Set the columns of a fixed-width record:
+	auto setColumn = [](string& record, int column, const string& value) {
+		if ((int)record.size() < column - 1 + (int)value.size()) {
+			record.resize(column - 1 + value.size(), ' ');
+		}
+		record.replace(column - 1, value.size(), value);
+	};
+
+	for (int p=pcount-1; p>=0; p--) {
+		out << "(C) 2026 humlib\n";
+		out << "\n";
+		out << "\n";
+		out << "10/18/26 humlib benchmark\n";
+		out << "WK#:1 MV#:1\n";
+		out << "humlib\n";
+		out << "humlib benchmark score\n";
+		out << "Synthetic\n";
+		out << "Part " << (pcount - p) << "\n";
+		out << "0 0\n";
+		out << "Group memberships: score\n";
+		out << "score: part " << (pcount - p) << " of " << pcount << "\n";
+		out << "$ K:0   Q:2   T:4/4   C:" << (p == 0 ? "22" : "4") << "\n";
+
+		for (int m=0; m<spec.measures; m++) {
+			if (m > 0) {
+				out << "measure " << (m + 1) << "\n";
+			}
+			for (int v=0; v<(int)score.parts[p][m].size(); v++) {
+				if (v > 0) {
+					out << "back   8\n";
+				}
+				const BenchVoice& voice = score.parts[p][m][v];
+				for (int e=0; e<(int)voice.size(); e++) {
+					const BenchEvent& event = voice[e];
+					int count = max(1, (int)event.pitches.size());
+					for (int i=0; i<count; i++) {
+						string record;
+						string duration = to_string(event.length);
+						duration = string(3 - duration.size(), ' ') + duration;
+						if (event.pitches.empty()) {
+							setColumn(record, 1, "rest");
+						} else {
+							int diatonic = event.pitches[i] / 10;
+							int accid = event.pitches[i] % 10 - 5;
+							string pitch(1, "CDEFGAB"[diatonic % 7]);
+							if (accid > 0) {
+								pitch += '#';
+							} else if (accid < 0) {
+								pitch += 'f';
+							}
+							pitch += to_string(diatonic / 7);
+							setColumn(record, i > 0 ? 2 : 1, pitch);
+						}
+						if (i > 0) {
+							record[0] = ' ';
+						}
+						setColumn(record, 6, duration);
+						if (event.tieStart) {
+							setColumn(record, 9, "-");
+						}
+						setColumn(record, 15, to_string(v + 1));
+						setColumn(record, 17, types[event.length]);
+						if (event.length == 3) {
+							setColumn(record, 18, ".");
+						}
+						if (!event.pitches.empty()) {
+							setColumn(record, 23, v == 0 ? "u" : "d");
+						}
+						if (event.beam == 1) {
+							setColumn(record, 26, "[");
+						} else if (event.beam == 2) {
+							setColumn(record, 26, "]");
+						}
+						if (i == 0 && event.slurStart) {
+							setColumn(record, 32, "(");
+						} else if (i == 0 && event.slurEnd) {
+							setColumn(record, 32, ")");
+						}
+						if (i == 0 && !event.syllable.empty()) {
+							string text = event.syllable;
+							if ((event.wordpos == 1) || (event.wordpos == 2)) {
+								text += "-";
+							}
+							setColumn(record, 44, text);
+						}
+						out << record << "\n";
+					}
+				}
+			}
+		}
+		out << "mheavy2\n";
+		out << "/END\n";
+		out << "/eof\n";
+	}
+	out << "//\n";
+	return out.str();
+}
+
+
+
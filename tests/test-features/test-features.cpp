@@ -0,0 +1,168 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 20:33:18 PDT 2026
+// Last Modified: Sun Oct 18 23:59:58 PDT 2026
+// Filename:      tests/test-features/test-features.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/tests/test-features/test-features.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Check the feature extractor against the sonority table
+//                (one row for each note attack), and check that feature
+//                tables are unchanged when written in the binary format and
+//                read back, either by copying or in place with
+//                HumFeatureView.
+//
+// Usage:         bin/test-features tests/files/*.krn
+//
+
+#include "humlib.h"
+#include "../TestCheck.h"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace hum;
+using namespace std;
+
+TestCheck Test("notes");
+
+
+//////////////////////////////
+//
+// sameTable -- Compare a table to the view of its binary form.
+//
+
+bool sameTable(HumFeatureTable& table, HumFeatureView& view) {
+	if ((table.getColumnCount() != view.getColumnCount()) ||
+			(table.getRowCount() != view.getRowCount())) {
+		return false;
+	}
+	for (int i=0; i<table.getColumnCount(); i++) {
+		if ((table.getColumnName(i) != view.getColumnName(i)) ||
+				(table.getColumnType(i) != view.getColumnType(i))) {
+			return false;
+		}
+		for (int64_t r=0; r<table.getRowCount(); r++) {
+			switch (table.getColumnType(i)) {
+				case HumFeatureTable::TYPE_FLOAT64: {
+					double a = table.getFloat(r, i);
+					double b = view.getFloatColumn(i)[r];
+					if ((a != b) && !(std::isnan(a) && std::isnan(b))) {
+						return false;
+					}
+					break;
+				}
+				case HumFeatureTable::TYPE_STRING:
+					if (table.getString(r, i) != view.getString(r, i)) {
+						return false;
+					}
+					break;
+				default:
+					if (table.getInt(r, i) != view.getIntColumn(i)[r]) {
+						return false;
+					}
+			}
+		}
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// getTsv --
+//
+
+string getTsv(HumFeatureTable& table) {
+	stringstream output;
+	table.printTsv(output);
+	return output.str();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+	Options options;
+	options.process(argc, argv);
+
+	HumFeatureExtractor extractor;
+	HumFeatureTable corpus;
+	string expected;
+	for (int a=1; a<=options.getArgCount(); a++) {
+		string filename = options.getArg(a);
+		HumdrumFile infile;
+		if (!infile.read(filename)) {
+			cerr << "Cannot read " << filename << endl;
+			return 1;
+		}
+		HumFeatureTable table;
+		extractor.extract(infile, table, filename);
+
+		// One row for each attack in the sonority table:
+		int attacks = 0;
+		for (HumSonority slice : infile.getSonorities()) {
+			attacks += slice.getAttackCount();
+		}
+		Test.check(table.getRowCount() == attacks, "row count", filename);
+		Test.addCount(attacks);
+
+		int midi = table.getColumnIndex("midi");
+		int base40 = table.getColumnIndex("base40");
+		int interval = table.getColumnIndex("interval");
+		for (int64_t r=0; r<table.getRowCount(); r++) {
+			if (table.getInt(r, midi) != Convert::base40ToMidiNoteNumber(table.getInt(r, base40))) {
+				Test.fail() << "midi column on " << filename << endl;
+				break;
+			}
+			int i = table.getInt(r, interval);
+			if ((i != HumFeatureTable::MISSING_INT) && ((i < -127) || (i > 127))) {
+				Test.fail() << "interval column on " << filename << endl;
+				break;
+			}
+		}
+
+		// The binary form read in place and copied back:
+		stringstream binary;
+		Test.check(table.write(binary), "write", filename);
+		string data = binary.str();
+		vector<uint64_t> buffer((data.size() + 7) / 8);
+		memcpy(buffer.data(), data.data(), data.size());
+		HumFeatureView view;
+		Test.check(view.open((const char*)buffer.data(), data.size()), "view open", filename);
+		Test.check(sameTable(table, view), "view contents", filename);
+		HumFeatureTable copy;
+		Test.check(copy.read((const char*)buffer.data(), data.size()), "read", filename);
+		Test.check(getTsv(copy) == getTsv(table), "read contents", filename);
+
+		// Truncated data is rejected:
+		if (data.size() > 48) {
+			Test.check(!view.open((const char*)buffer.data(), data.size() - 8), "truncated view", filename);
+		}
+
+		Test.check(corpus.append(table), "append", filename);
+		string tsv = getTsv(table);
+		if (expected.empty()) {
+			expected = tsv;
+		} else {
+			expected += tsv.substr(tsv.find('\n') + 1);
+		}
+	}
+
+	// Appended tables are the concatenation of the tables for each file:
+	if (options.getArgCount() > 0) {
+		Test.check(getTsv(corpus) == expected, "appended tables", "all files");
+	}
+
+	return Test.report();
+}
+
+
+
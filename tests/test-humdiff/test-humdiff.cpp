@@ -0,0 +1,260 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 23:31:52 PDT 2026
+// Last Modified: Sun Oct 18 23:31:52 PDT 2026
+// Filename:      tests/test-humdiff/test-humdiff.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/tests/test-humdiff/test-humdiff.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Check the sequence alignment used by "humdiff -a" against
+//                a dynamic-programming longest common subsequence, including
+//                sequences with insertions and deletions and sequences with
+//                too many differences to align.  Then check which notes are
+//                marked when comparing scores with an inserted, deleted
+//                or changed measure.
+//
+// Usage:         bin/test-humdiff
+//
+
+#include "humlib.h"
+#include "../TestCheck.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace hum;
+using namespace std;
+
+TestCheck Test("alignments");
+
+
+// Tool_humdiff_test: access to the protected alignment function.
+
+class Tool_humdiff_test : public Tool_humdiff {
+	public:
+		using Tool_humdiff::diffSequences;
+};
+
+
+//////////////////////////////
+//
+// getLcsLength -- Length of the longest common subsequence of a and b.
+//
+
+int getLcsLength(const vector<int>& a, const vector<int>& b) {
+	vector<vector<int>> table(a.size() + 1, vector<int>(b.size() + 1, 0));
+	for (int i=1; i<=(int)a.size(); i++) {
+		for (int j=1; j<=(int)b.size(); j++) {
+			if (a[i-1] == b[j-1]) {
+				table[i][j] = table[i-1][j-1] + 1;
+			} else {
+				table[i][j] = max(table[i-1][j], table[i][j-1]);
+			}
+		}
+	}
+	return table[a.size()][b.size()];
+}
+
+
+
+//////////////////////////////
+//
+// isValidMatch -- True if the matches are increasing index pairs of
+//     equal elements.
+//
+
+bool isValidMatch(const vector<pair<int, int>>& matches, const vector<int>& a,
+		const vector<int>& b) {
+	for (int i=0; i<(int)matches.size(); i++) {
+		int x = matches[i].first;
+		int y = matches[i].second;
+		if ((x < 0) || (x >= (int)a.size()) || (y < 0) || (y >= (int)b.size())) {
+			return false;
+		}
+		if (a[x] != b[y]) {
+			return false;
+		}
+		if ((i > 0) && ((x <= matches[i-1].first) || (y <= matches[i-1].second))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// checkDiff -- Align two sequences, and compare the number of matches to
+//     the longest common subsequence.
+//
+
+void checkDiff(const string& label, const vector<int>& a, const vector<int>& b) {
+	Tool_humdiff_test tool;
+	vector<pair<int, int>> matches;
+	Test.addCount();
+	bool status = tool.diffSequences(matches, a, 0, (int)a.size(), b, 0, (int)b.size());
+	Test.check(status, "alignment status", label);
+	Test.check(isValidMatch(matches, a, b), "matched elements", label);
+	Test.check((int)matches.size() == getLcsLength(a, b), "match count", label);
+}
+
+
+
+//////////////////////////////
+//
+// checkFallback -- Sequences with more differences than the alignment
+//     allows only have their common prefix and suffix matched.
+//
+
+void checkFallback(void) {
+	vector<int> a;
+	vector<int> b;
+	int prefix = 10;
+	int suffix = 20;
+	for (int i=0; i<prefix; i++) {
+		a.push_back(i);
+		b.push_back(i);
+	}
+	for (int i=0; i<1500; i++) {
+		a.push_back(1000 + i);
+		b.push_back(5000 + i);
+	}
+	for (int i=0; i<suffix; i++) {
+		a.push_back(9000 + i);
+		b.push_back(9000 + i);
+	}
+
+	Tool_humdiff_test tool;
+	vector<pair<int, int>> matches;
+	Test.addCount();
+	bool status = tool.diffSequences(matches, a, 0, (int)a.size(), b, 0, (int)b.size());
+	Test.check(!status, "fallback status", "unrelated sequences");
+	Test.check(isValidMatch(matches, a, b), "fallback matched elements", "unrelated sequences");
+	Test.check((int)matches.size() == prefix + suffix, "fallback match count", "unrelated sequences");
+
+	// A smaller region in the same position is still aligned:
+	a.resize(prefix + 100);
+	b.resize(prefix + 100);
+	a[prefix + 50] = b[prefix + 50];
+	checkDiff("small unrelated region", a, b);
+}
+
+
+
+//////////////////////////////
+//
+// makeScore -- Make a one-voice score with a measure of four quarter notes
+//     for each string of pitches.
+//
+
+string makeScore(const vector<string>& measures) {
+	string output = "**kern\n*M4/4\n";
+	for (int i=0; i<(int)measures.size(); i++) {
+		output += "=" + to_string(i + 1) + "\n";
+		string pitches = measures[i];
+		for (int j=0; j<(int)pitches.size(); j++) {
+			output += "4";
+			output += pitches[j];
+			output += "\n";
+		}
+	}
+	output += "==\n*-\n";
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// getMarkedNotes -- Run "humdiff -a" and return the marked notes of the
+//     reference, separated by spaces.
+//
+
+string getMarkedNotes(const string& reference, const string& alternate) {
+	HumdrumFileSet infiles;
+	infiles.readAppendString(reference);
+	infiles.readAppendString(alternate);
+	Tool_humdiff tool;
+	vector<string> args = { "humdiff", "-a" };
+	tool.process(args);
+	tool.run(infiles);
+	HumdrumFile outfile;
+	outfile.readString(tool.getHumdrumText());
+	string output;
+	for (int i=0; i<outfile.getLineCount(); i++) {
+		if (!outfile[i].isData()) {
+			continue;
+		}
+		string token = *outfile.token(i, 0);
+		if (token.find('@') != string::npos) {
+			if (!output.empty()) {
+				output += " ";
+			}
+			output += token;
+		}
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// checkMarks -- Check the notes marked by "humdiff -a".
+//
+
+void checkMarks(const string& label, const vector<string>& reference,
+		const vector<string>& alternate, const string& expected) {
+	Test.addCount();
+	string marked = getMarkedNotes(makeScore(reference), makeScore(alternate));
+	if (marked != expected) {
+		Test.fail() << label << ": marked \"" << marked << "\", expected \""
+		     << expected << "\"" << endl;
+	}
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+	vector<int> a = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	checkDiff("identical", a, a);
+	checkDiff("empty reference", {}, a);
+	checkDiff("empty alternate", a, {});
+	checkDiff("insertion", a, { 1, 2, 3, 10, 11, 4, 5, 6, 7, 8 });
+	checkDiff("deletion", a, { 1, 2, 5, 6, 7, 8 });
+	checkDiff("insertion and deletion", a, { 0, 1, 3, 4, 9, 5, 6, 8, 12 });
+	checkDiff("replacement", a, { 1, 2, 9, 9, 5, 6, 9, 8 });
+
+	srand(1);
+	for (int i=0; i<200; i++) {
+		vector<int> x(rand() % 40);
+		vector<int> y(rand() % 40);
+		for (int j=0; j<(int)x.size(); j++) {
+			x[j] = rand() % 4;
+		}
+		for (int j=0; j<(int)y.size(); j++) {
+			y[j] = rand() % 4;
+		}
+		checkDiff("random sequences " + to_string(i), x, y);
+	}
+
+	checkFallback();
+
+	vector<string> score = { "cdef", "gabc", "gfed", "cccc" };
+	checkMarks("same score", score, score, "");
+	checkMarks("inserted measure", score, { "cdef", "gabc", "aaaa", "gfed", "cccc" }, "");
+	checkMarks("deleted measure", score, { "cdef", "gfed", "cccc" }, "4g@ 4a@ 4b@ 4c@");
+	checkMarks("changed note", score, { "cdef", "gabc", "gfEd", "cccc" }, "4e@");
+
+	return Test.report();
+}
+
+
+
@@ -0,0 +1,498 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 21:49:30 PDT 2026
+// Last Modified: Sun Oct 18 23:59:58 PDT 2026
+// Filename:      tests/test-json/test-json.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/tests/test-json/test-json.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Check that HumJsonWriter output is valid JSON that
+//                matches the tokens, spine links and slurs of each
+//                file, that the CBOR output has the same contents, that
+//                unselected sections are not written, and that analyses
+//                are written from the analysis tables when analysis hash
+//                values are not stored.
+//
+// Usage:         bin/test-json tests/files/*.krn
+//
+
+#include "humlib.h"
+#include "../TestCheck.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace hum;
+using namespace std;
+
+TestCheck Test("tokens");
+
+// Value: parsed JSON or CBOR data item.
+
+class Value {
+	public:
+		enum Type { NUL, BOOL, INT, STRING, ARRAY, OBJECT };
+		Type               type = NUL;
+		long long          number = 0;
+		string             text;
+		vector<string>     keys;   // keys of an object
+		vector<Value>      items;  // array elements or object values
+
+		const Value* get(const string& key) const {
+			for (int i=0; i<(int)keys.size(); i++) {
+				if (keys[i] == key) {
+					return &items[i];
+				}
+			}
+			return NULL;
+		}
+};
+
+
+//////////////////////////////
+//
+// parseJson -- Parse a JSON value, returning false if the text is not
+//     valid JSON.
+//
+
+bool parseJson(const string& s, size_t& i, Value& value) {
+	while ((i < s.size()) && isspace((unsigned char)s[i])) {
+		i++;
+	}
+	if (i >= s.size()) {
+		return false;
+	}
+	if (s[i] == '{' || s[i] == '[') {
+		bool object = (s[i] == '{');
+		char close = object ? '}' : ']';
+		value.type = object ? Value::OBJECT : Value::ARRAY;
+		i++;
+		while ((i < s.size()) && isspace((unsigned char)s[i])) {
+			i++;
+		}
+		if ((i < s.size()) && (s[i] == close)) {
+			i++;
+			return true;
+		}
+		while (true) {
+			if (object) {
+				Value key;
+				if (!parseJson(s, i, key) || (key.type != Value::STRING) ||
+						(i >= s.size()) || (s[i] != ':')) {
+					return false;
+				}
+				i++;
+				value.keys.push_back(key.text);
+			}
+			value.items.emplace_back();
+			if (!parseJson(s, i, value.items.back())) {
+				return false;
+			}
+			while ((i < s.size()) && isspace((unsigned char)s[i])) {
+				i++;
+			}
+			if (i >= s.size()) {
+				return false;
+			}
+			if (s[i] == close) {
+				i++;
+				return true;
+			}
+			if (s[i] != ',') {
+				return false;
+			}
+			i++;
+		}
+	}
+	if (s[i] == '"') {
+		value.type = Value::STRING;
+		for (i++; i<s.size(); i++) {
+			if (s[i] == '"') {
+				i++;
+				return true;
+			}
+			if ((unsigned char)s[i] < 0x20) {
+				return false;
+			}
+			if (s[i] != '\\') {
+				value.text += s[i];
+				continue;
+			}
+			i++;
+			if (i >= s.size()) {
+				return false;
+			}
+			switch (s[i]) {
+				case '"':  value.text += '"';  break;
+				case '\\': value.text += '\\'; break;
+				case 'n':  value.text += '\n'; break;
+				case 'r':  value.text += '\r'; break;
+				case 't':  value.text += '\t'; break;
+				case 'u':
+					if (i + 4 >= s.size()) {
+						return false;
+					}
+					value.text += (char)stoi(s.substr(i + 1, 4), NULL, 16);
+					i += 4;
+					break;
+				default: return false;
+			}
+		}
+		return false;
+	}
+	if (s.compare(i, 4, "null") == 0) {
+		i += 4;
+		return true;
+	}
+	if (s.compare(i, 4, "true") == 0) {
+		value.type = Value::BOOL;
+		value.number = 1;
+		i += 4;
+		return true;
+	}
+	if (s.compare(i, 5, "false") == 0) {
+		value.type = Value::BOOL;
+		i += 5;
+		return true;
+	}
+	size_t start = i;
+	if (s[i] == '-') {
+		i++;
+	}
+	while ((i < s.size()) && isdigit((unsigned char)s[i])) {
+		i++;
+	}
+	if ((i == start) || (s[i-1] == '-')) {
+		return false;
+	}
+	value.type = Value::INT;
+	value.number = stoll(s.substr(start, i - start));
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// parseCbor -- Parse a CBOR data item (only the types written by
+//     HumJsonWriter).
+//
+
+bool parseCbor(const string& s, size_t& i, Value& value) {
+	if (i >= s.size()) {
+		return false;
+	}
+	unsigned char head = (unsigned char)s[i++];
+	int major = head >> 5;
+	int info = head & 0x1f;
+	if ((head == 0x9f) || (head == 0xbf)) {
+		bool object = (head == 0xbf);
+		value.type = object ? Value::OBJECT : Value::ARRAY;
+		while ((i < s.size()) && ((unsigned char)s[i] != 0xff)) {
+			if (object) {
+				Value key;
+				if (!parseCbor(s, i, key) || (key.type != Value::STRING)) {
+					return false;
+				}
+				value.keys.push_back(key.text);
+			}
+			value.items.emplace_back();
+			if (!parseCbor(s, i, value.items.back())) {
+				return false;
+			}
+		}
+		if (i >= s.size()) {
+			return false;
+		}
+		i++;
+		return true;
+	}
+	if (head == 0xf6) {
+		return true;
+	}
+	unsigned long long number = info;
+	if (info >= 24) {
+		int size = 1 << (info - 24);
+		if ((info > 27) || (i + size > s.size())) {
+			return false;
+		}
+		number = 0;
+		for (int j=0; j<size; j++) {
+			number = (number << 8) | (unsigned char)s[i++];
+		}
+	}
+	if (major == 0) {
+		value.type = Value::INT;
+		value.number = (long long)number;
+	} else if (major == 1) {
+		value.type = Value::INT;
+		value.number = -1 - (long long)number;
+	} else if (major == 3) {
+		if (i + number > s.size()) {
+			return false;
+		}
+		value.type = Value::STRING;
+		value.text = s.substr(i, number);
+		i += number;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// isEqual -- Return true if two values have the same contents.
+//
+
+bool isEqual(const Value& a, const Value& b) {
+	if ((a.type != b.type) || (a.number != b.number) || (a.text != b.text) ||
+			(a.keys != b.keys) || (a.items.size() != b.items.size())) {
+		return false;
+	}
+	for (int i=0; i<(int)a.items.size(); i++) {
+		if (!isEqual(a.items[i], b.items[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// isReference -- Return true if a value is a [line, field] reference to
+//     the given token.
+//
+
+bool isReference(const Value* value, HTp token) {
+	if (!value || !token) {
+		return value && !token && (value->type == Value::NUL);
+	}
+	return (value->type == Value::ARRAY) && (value->items.size() == 2) &&
+			(value->items[0].number == token->getLineIndex()) &&
+			(value->items[1].number == token->getFieldIndex());
+}
+
+
+
+//////////////////////////////
+//
+// hasKey -- Return true if any object in a value has the key.
+//
+
+bool hasKey(const Value& value, const string& key) {
+	if (value.get(key)) {
+		return true;
+	}
+	for (const Value& item : value.items) {
+		if (hasKey(item, key)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+
+
+//////////////////////////////
+//
+// write -- Write a file with the given format and sections, and parse the
+//     output.
+//
+
+bool write(HumdrumFile& infile, HumJsonWriter::Format format,
+		const string& sections, Value& value, string& text) {
+	HumJsonWriter writer;
+	writer.setFormat(format);
+	writer.setSections(sections);
+	stringstream output;
+	if (!writer.write(output, infile)) {
+		return false;
+	}
+	text = output.str();
+	size_t i = 0;
+	bool status;
+	if (format == HumJsonWriter::FORMAT_JSON) {
+		status = parseJson(text, i, value);
+		while ((i < text.size()) && isspace((unsigned char)text[i])) {
+			i++;
+		}
+	} else {
+		status = parseCbor(text, i, value);
+	}
+	return status && (i == text.size());
+}
+
+
+
+//////////////////////////////
+//
+// checkTables -- Check that ties, phrases and the accidentals of large
+//     chords are written from the analysis tables, so that the output
+//     does not depend on whether analysis hash values are stored.
+//
+
+void checkTables(void) {
+	// A chord of 33 C's and an F#:
+	string chord = "1c";
+	for (int i=1; i<33; i++) {
+		chord += " 1c";
+	}
+	chord += " 1f#";
+	string contents =
+		"!!!RDF**kern: @ = linked\n"
+		"**kern\t**kern\n"
+		"*M4/4\t*M4/4\n"
+		"=1\t=1\n"
+		"{4c\t4e@[\n"
+		"4d}\t4f\n"
+		"{{4e\t4g\n"
+		"4f}}\t4e@]\n"
+		"=2\t=2\n"
+		+ chord + "\t1r\n"
+		"==\t==\n"
+		"*-\t*-\n";
+	string sections = "ties,phrases,accidentals";
+
+	HumdrumFile withhash;
+	withhash.readString(contents);
+	Value expected;
+	string text;
+	Test.check(write(withhash, HumJsonWriter::FORMAT_JSON, sections, expected, text),
+			"JSON syntax", "tables");
+
+	HumdrumFile infile;
+	infile.setAnalysisHashValues(false);
+	infile.readString(contents);
+	Value json;
+	Test.check(write(infile, HumJsonWriter::FORMAT_JSON, sections, json, text),
+			"JSON syntax", "tables without hash values");
+	Test.check(isEqual(json, expected), "same output without hash values", "tables");
+	Test.check(hasKey(json, "ties"), "ties", "tables");
+	Test.check(hasKey(json, "phrases"), "phrases", "tables");
+
+	// Phrase and tie links:
+	HTp start = infile.token(4, 0);
+	Test.check(start->getPhraseEndToken(1) == infile.token(5, 0), "phrase end", "tables");
+	Test.check(infile.token(5, 0)->getPhraseStartToken(1) == start, "phrase start", "tables");
+	HTp inner = infile.token(6, 0);
+	Test.check((inner->getPhraseEndToken(1) == infile.token(7, 0)) &&
+			(inner->getPhraseEndToken(2) == infile.token(7, 0)), "elided phrases", "tables");
+	HumSpanTable& ties = infile.getAnalysisTables().getTies();
+	int tieid = infile.getAnalysisTables().getTokenId(infile.token(4, 1));
+	Test.check(ties.getEndToken(tieid) == infile.token(7, 1), "linked tie", "tables");
+
+	// Accidentals of notes after the 32nd note of a chord:
+	HTp chordtok = infile.token(9, 0);
+	Test.check(chordtok->hasVisibleAccidental(33) == 1, "accidental of 34th note", "tables");
+	Test.check(chordtok->hasVisibleAccidental(32) == 0, "accidental of 33rd note", "tables");
+	Test.addCount();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+	Options options;
+	options.process(argc, argv);
+
+	for (int a=1; a<=options.getArgCount(); a++) {
+		string filename = options.getArg(a);
+		HumdrumFile infile;
+		if (!infile.read(filename)) {
+			cerr << "Cannot read " << filename << endl;
+			return 1;
+		}
+
+		Value json;
+		string text;
+		if (!write(infile, HumJsonWriter::FORMAT_JSON, "all", json, text)) {
+			Test.fail() << "JSON syntax on " << filename << endl;
+			continue;
+		}
+
+		// Same contents in CBOR:
+		Value cbor;
+		string data;
+		Test.check(write(infile, HumJsonWriter::FORMAT_CBOR, "all", cbor, data), "CBOR syntax", filename);
+		Test.check(isEqual(json, cbor), "CBOR contents", filename);
+
+		// Lines and tokens:
+		const Value* lines = json.get("lines");
+		if (!lines || ((int)lines->items.size() != infile.getLineCount())) {
+			Test.fail() << "line count on " << filename << endl;
+			continue;
+		}
+		for (int i=0; i<infile.getLineCount(); i++) {
+			const Value* tokens = lines->items[i].get("tokens");
+			if (!tokens || ((int)tokens->items.size() != infile[i].getFieldCount())) {
+				Test.fail() << "field count on " << filename << endl;
+				continue;
+			}
+			for (int j=0; j<infile[i].getFieldCount(); j++) {
+				HTp token = infile.token(i, j);
+				const Value& jtok = tokens->items[j];
+				Test.addCount();
+				const Value* jtext = jtok.get("text");
+				const Value* jtrack = jtok.get("track");
+				const Value* jsubtrack = jtok.get("subtrack");
+				Test.check(jtext && (jtext->text == *token), "token text", filename);
+				Test.check(jtrack && (jtrack->number == token->getTrack()), "track", filename);
+				Test.check(jsubtrack && (jsubtrack->number == token->getSubtrack()), "subtrack", filename);
+				const Value* next = jtok.get("next");
+				if (!next || ((int)next->items.size() != token->getNextTokenCount())) {
+					Test.fail() << "next count on " << filename << endl;
+				} else {
+					for (int k=0; k<token->getNextTokenCount(); k++) {
+						Test.check(isReference(&next->items[k], token->getNextToken(k)), "next token", filename);
+					}
+				}
+
+				// Slur ends given as references:
+				HTp slurend = token->getSlurEndToken(1);
+				if (slurend) {
+					const Value* slurs = jtok.get("slurs");
+					bool found = false;
+					for (int k=0; slurs && (k<(int)slurs->items.size()); k++) {
+						const Value* number = slurs->items[k].get("number");
+						if (number && (number->number == 1)) {
+							found = isReference(slurs->items[k].get("end"), slurend);
+						}
+					}
+					Test.check(found, "slur end", filename);
+				}
+			}
+		}
+
+		// Unselected sections are not written:
+		Value limited;
+		Test.check(write(infile, HumJsonWriter::FORMAT_JSON, "none", limited, text), "limited JSON", filename);
+		Test.check(!hasKey(limited, "next") && !hasKey(limited, "duration") &&
+				!hasKey(limited, "parameters") && !hasKey(limited, "resolve") &&
+				!hasKey(limited, "slurs") && !hasKey(limited, "beams") &&
+				!hasKey(limited, "accidentals") && !hasKey(limited, "restPosition"),
+				"no sections", filename);
+		Test.check(write(infile, HumJsonWriter::FORMAT_JSON, "slurs", limited, text), "slur JSON", filename);
+		Test.check((text.find("\"tieEnd\"") == string::npos) &&
+				(text.find("\"beams\"") == string::npos), "slurs only", filename);
+	}
+
+	checkTables();
+
+	HumJsonWriter writer;
+	Test.check(!writer.setSections("slurs,unknown"), "unknown section", "setSections");
+	Test.check(writer.getSections() == HumJsonWriter::SECTION_ALL, "sections unchanged", "setSections");
+
+	return Test.report();
+}
+
+
+
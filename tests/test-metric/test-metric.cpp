@@ -0,0 +1,188 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 21:18:02 PDT 2026
+// Last Modified: Sun Oct 18 23:59:58 PDT 2026
+// Filename:      tests/test-metric/test-metric.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/tests/test-metric/test-metric.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Check the metric grid against metric positions calculated
+//                by scanning the time signatures of each track line by
+//                line.
+//
+// Usage:         bin/test-metric tests/files/*.krn
+//
+
+#include "humlib.h"
+#include "../TestCheck.h"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace hum;
+using namespace std;
+
+
+//////////////////////////////
+//
+// getExpectedLevels -- Calculate metric levels for a track in the same
+//     way as HumdrumFileContent::getMetricLevels() did before it used
+//     the metric grid.
+//
+
+vector<double> getExpectedLevels(HumdrumFile& infile, int track) {
+	vector<double> output(infile.getLineCount(), NAN);
+	int top = 1;
+	int bot = 4;
+	bool compoundQ = false;
+	HumNum beatdur(4, bot);
+	for (int i=0; i<infile.getLineCount(); i++) {
+		if (infile[i].isInterpretation()) {
+			for (int j=0; j<infile[i].getFieldCount(); j++) {
+				HTp token = infile.token(i, j);
+				if (token->getTrack() != track) {
+					continue;
+				}
+				if (sscanf(token->c_str(), "*M%d/%d", &top, &bot) == 2) {
+					beatdur.setValue(4, bot);
+					compoundQ = (top % 3 == 0) && (top != 3);
+					if (compoundQ) {
+						beatdur *= 3;
+					}
+					break;
+				}
+			}
+		}
+		if (!infile[i].isData()) {
+			continue;
+		}
+		HumNum measurepos = infile[i].getDurationFromBarline() / beatdur;
+		int denominator = measurepos.getDenominator();
+		if (compoundQ) {
+			output[i] = Convert::nearIntQuantize(log(denominator) / log(3.0));
+			if ((output[i] != 0.0) && (output[i] != 1.0)) {
+				HumNum commeasurepos = infile[i].getDurationFromBarline() / HumNum(4, bot);
+				output[i] = 1.0 + log(commeasurepos.getDenominator()) / log(2.0);
+			}
+		} else {
+			output[i] = Convert::nearIntQuantize(log(denominator) / log(2.0));
+		}
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// getExpectedBeats -- Calculate the beat duration of each line for a
+//     track from the time signatures and *beat: interpretations.
+//
+
+vector<HumNum> getExpectedBeats(HumdrumFile& infile, int track) {
+	vector<HumNum> output(infile.getLineCount(), 1);
+	HumNum meterbeat = 1;
+	HumNum beat = 1;
+	HumRegex hre;
+	for (int i=0; i<infile.getLineCount(); i++) {
+		if (infile[i].isInterpretation()) {
+			bool found = false;
+			for (int j=0; j<infile[i].getFieldCount(); j++) {
+				HTp token = infile.token(i, j);
+				if (token->getTrack() != track) {
+					continue;
+				}
+				if (!found && hre.search(token, "^\\*M(\\d+)/(\\d+)")) {
+					int top = hre.getMatchInt(1);
+					meterbeat.setValue(4, hre.getMatchInt(2));
+					if ((top % 3 == 0) && (top != 3)) {
+						meterbeat *= 3;
+					}
+					beat = meterbeat;
+					found = true;
+				} else if (hre.search(token, "^\\*beat:\\s*([\\d.%]+)\\s*$")) {
+					beat = Convert::recipToDuration(hre.getMatch(1));
+					if (beat <= 0) {
+						beat = meterbeat;
+					}
+				}
+			}
+		}
+		output[i] = beat;
+	}
+	return output;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+	Options options;
+	options.process(argc, argv);
+
+	TestCheck test("positions");
+	for (int a=1; a<=options.getArgCount(); a++) {
+		HumdrumFile infile;
+		if (!infile.read(options.getArg(a))) {
+			cerr << "Cannot read " << options.getArg(a) << endl;
+			return 1;
+		}
+		const HumMetricTable& grid = infile.getMetricGrid();
+		if ((grid.getLineCount() != infile.getLineCount()) ||
+				(grid.getTrackCount() != infile.getMaxTrack())) {
+			test.fail() << options.getArg(a) << " table size" << endl;
+			continue;
+		}
+		for (int track=1; track<=infile.getMaxTrack(); track++) {
+			vector<double> levels = getExpectedLevels(infile, track);
+			vector<HumNum> beats = getExpectedBeats(infile, track);
+			for (int i=0; i<infile.getLineCount(); i++) {
+				if (!infile[i].isData()) {
+					if (grid.hasPosition(i, track)) {
+						test.fail() << options.getArg(a) << " line " << i + 1
+						     << " is not data" << endl;
+					}
+					continue;
+				}
+				test.addCount();
+				HumNum position = infile[i].getDurationFromBarline();
+				HumNum beatpos = position / beats[i];
+				int beat = (int)floor(beatpos.getFloat()) + 1;
+				HumNum fraction = beatpos - (beat - 1);
+				double level = grid.getMetricLevel(i, track);
+				if ((grid.getBeatDuration(i, track) != beats[i]) ||
+						(grid.getBeat(i, track) != beat) ||
+						(grid.getBeatFraction(i, track) != fraction) ||
+						(grid.getMeasurePosition(i) != position) ||
+						((level != levels[i]) && !(std::isnan(level) && std::isnan(levels[i])))) {
+					test.fail() << options.getArg(a) << " line " << i + 1
+					     << " track " << track << ": " << infile[i] << endl;
+				}
+			}
+		}
+
+		// The levels of getMetricLevels() come from the grid:
+		vector<double> levels;
+		infile.getMetricLevels(levels);
+		int track = 1;
+		vector<HTp> kernspines = infile.getKernSpineStartList();
+		if (!kernspines.empty()) {
+			track = kernspines[0]->getTrack();
+		}
+		for (int i=0; i<infile.getLineCount(); i++) {
+			double level = grid.getMetricLevel(i, track);
+			if ((level != levels[i]) && !(std::isnan(level) && std::isnan(levels[i]))) {
+				test.fail() << options.getArg(a) << " getMetricLevels line "
+				     << i + 1 << endl;
+			}
+		}
+	}
+
+	return test.report();
+}
+
+
+
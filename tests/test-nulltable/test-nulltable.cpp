@@ -0,0 +1,98 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 18:31:40 PDT 2026
+// Last Modified: Sun Oct 18 23:59:58 PDT 2026
+// Filename:      tests/test-nulltable/test-nulltable.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/tests/test-nulltable/test-nulltable.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Check the null-token resolution table against resolutions
+//                found by following the previous-token links of each token.
+//
+// Usage:         bin/test-nulltable tests/files/*.krn
+//
+
+#include "humlib.h"
+#include "../TestCheck.h"
+
+#include <iostream>
+
+using namespace hum;
+using namespace std;
+
+
+//////////////////////////////
+//
+// findResolution -- Follow previous tokens in the spine to the last non-null
+//     data token.
+//
+
+HTp findResolution(HTp token) {
+	while (token) {
+		if (token->isData() && !token->isNull()) {
+			return token;
+		}
+		token = token->getPreviousToken(0);
+	}
+	return NULL;
+}
+
+
+
+//////////////////////////////
+//
+// findAttackLine -- Follow ties back to the first note of a tie group.
+//
+
+int findAttackLine(HTp token) {
+	HTp note = findResolution(token);
+	if (!note) {
+		return -1;
+	}
+	while (note->isSecondaryTiedNote()) {
+		HTp previous = findResolution(note->getPreviousToken(0));
+		if (!previous) {
+			break;
+		}
+		note = previous;
+	}
+	return note->getLineIndex();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+	Options options;
+	options.process(argc, argv);
+
+	TestCheck test("tokens");
+	for (int a=1; a<=options.getArgCount(); a++) {
+		HumdrumFile infile;
+		if (!infile.read(options.getArg(a))) {
+			cerr << "Cannot read " << options.getArg(a) << endl;
+			return 1;
+		}
+		infile.analyzeNullResolution();
+		for (int i=0; i<infile.getLineCount(); i++) {
+			for (int j=0; j<infile[i].getFieldCount(); j++) {
+				HTp token = infile.token(i, j);
+				HTp expected = findResolution(token);
+				HTp resolved = infile.getResolvedToken(i, j);
+				int attack = infile.getAttackLine(i, j);
+				test.addCount();
+				if ((resolved != expected) || (attack != findAttackLine(token))) {
+					test.fail() << options.getArg(a) << " line " << i + 1
+					     << " field " << j + 1 << ": " << token << endl;
+				}
+			}
+		}
+	}
+
+	return test.report();
+}
+
+
+
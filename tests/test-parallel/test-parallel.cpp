@@ -0,0 +1,185 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 23:55:36 PDT 2026
+// Last Modified: Sun Oct 18 23:55:36 PDT 2026
+// Filename:      tests/test-parallel/test-parallel.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/tests/test-parallel/test-parallel.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Check that the slur, beam and accidental analyses give
+//                the same tables and "auto" parameters when the spines
+//                are analyzed in parallel as when they are analyzed one
+//                after another.  A built-in score with slurs and beams in
+//                several spines is checked along with any input files.
+//
+// Usage:         bin/test-parallel tests/files/*.krn
+//
+
+#include "humlib.h"
+#include "../TestCheck.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace hum;
+using namespace std;
+
+TestCheck Test("files");
+
+string SpanScore =
+	"**kern\t**kern\t**kern\n"
+	"*M4/4\t*M4/4\t*M4/4\n"
+	"*k[b-]\t*k[]\t*k[f#]\n"
+	"=1\t=1\t=1\n"
+	"(8cL\t(4e\t8ffL\n"
+	"8d#J\t.\t8gg#J\n"
+	"8eL\t4f)\t(4aa\n"
+	"8BJ)\t.\t.\n"
+	"*\t*^\t*\n"
+	"(8dL\t8eL\t8gL\t4bb)\n"
+	"8cJ\t8fJ\t8a#J\t.\n"
+	"4d)\t4g\t4g\t4ff\n"
+	"*\t*v\t*v\t*\n"
+	"=2\t=2\t=2\n"
+	"[4c\t&(8eL\t(2ff\n"
+	".\t8fJ\t.\n"
+	"4c]\t4g&)\t.\n"
+	"2cn\t2a\t2ff#\n"
+	"==\t==\t==\n"
+	"*-\t*-\t*-\n";
+
+
+//////////////////////////////
+//
+// getPosition -- Return the line and field of a token as a string.
+//
+
+string getPosition(HTp token) {
+	if (!token) {
+		return "-";
+	}
+	return to_string(token->getLineIndex()) + "." + to_string(token->getFieldIndex());
+}
+
+
+
+//////////////////////////////
+//
+// describeSpans -- Print the links and states of a token in a span table.
+//
+
+void describeSpans(ostream& out, HumSpanTable& spans, int id) {
+	out << " spans:" << spans.getStartCount(id) << "/" << spans.getEndCount(id);
+	for (int n=1; n<=spans.getStartCount(id); n++) {
+		out << " >" << getPosition(spans.getEndToken(id, n)) << ":"
+		    << spans.getEndNumber(id, n) << ":" << spans.getDuration(id, n);
+	}
+	for (int n=1; n<=spans.getEndCount(id); n++) {
+		out << " <" << getPosition(spans.getStartToken(id, n)) << ":"
+		    << spans.getStartNumber(id, n);
+	}
+	out << " " << spans.getHangingSide(id) << spans.getOpenIndex(id)
+	    << spans.isEndingBack(id) << spans.isSpanStart(id) << spans.isSpanEnd(id)
+	    << " " << getPosition(spans.getSpanStart(id));
+}
+
+
+
+//////////////////////////////
+//
+// describeParameters -- Print the parameters of a token, replacing token
+//     addresses with token positions so that two copies of a file can be
+//     compared.
+//
+
+string describeParameters(HTp token) {
+	stringstream hash;
+	hash << *static_cast<HumHash*>(token);
+	string text = hash.str();
+	HumRegex hre;
+	while (hre.search(text, "HT_(\\d+)")) {
+		HTp target = (HTp)stoll(hre.getMatch(1));
+		hre.replaceDestructive(text, getPosition(target), "HT_" + hre.getMatch(1));
+	}
+	return text;
+}
+
+
+
+//////////////////////////////
+//
+// analyze -- Run the spine analyses with the given number of threads,
+//     and return a description of the results for each token.
+//
+
+string analyze(const string& contents, int threads) {
+	HumdrumFile infile;
+	infile.setAnalysisThreadCount(threads);
+	infile.readString(contents);
+	infile.analyzeSlurs();
+	infile.analyzeBeams();
+	infile.analyzeKernAccidentals();
+	infile.analyzeMensAccidentals();
+
+	HumAnalysisTables& tables = infile.getAnalysisTables();
+	stringstream out;
+	for (int i=0; i<infile.getLineCount(); i++) {
+		for (int j=0; j<infile[i].getFieldCount(); j++) {
+			HTp token = infile.token(i, j);
+			int id = tables.getTokenId(token);
+			out << i << "." << j << " " << id;
+			if (id >= 0) {
+				describeSpans(out, tables.getSlurs(), id);
+				describeSpans(out, tables.getBeams(), id);
+				out << " accid:";
+				for (int k=0; k<token->getSubtokenCount(); k++) {
+					out << tables.getAccidentalFlags(id, k);
+				}
+			}
+			out << "\n" << describeParameters(token);
+		}
+	}
+	return out.str();
+}
+
+
+
+//////////////////////////////
+//
+// checkThreads -- Compare serial and parallel analyses of a file.
+//
+
+void checkThreads(const string& contents, const string& filename) {
+	Test.addCount();
+	string serial = analyze(contents, 1);
+	Test.check(analyze(contents, 4) == serial, "4 threads", filename);
+	Test.check(analyze(contents, 0) == serial, "one thread per core", filename);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+	Options options;
+	options.process(argc, argv);
+
+	checkThreads(SpanScore, "built-in score");
+	for (int i=1; i<=options.getArgCount(); i++) {
+		HumdrumFile infile;
+		if (!infile.read(options.getArg(i))) {
+			cerr << "Cannot read " << options.getArg(i) << endl;
+			return 1;
+		}
+		stringstream contents;
+		contents << infile;
+		checkThreads(contents.str(), options.getArg(i));
+	}
+
+	return Test.report();
+}
+
+
+
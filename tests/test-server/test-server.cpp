@@ -0,0 +1,183 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 23:59:48 PDT 2026
+// Last Modified: Sun Oct 18 23:59:48 PDT 2026
+// Filename:      tests/test-server/test-server.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/tests/test-server/test-server.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Check the request and response framing of HumToolServer.
+//                Each input file is sent as framed requests through
+//                HumToolServer::serve() with a job queue that is smaller
+//                than the number of requests, and every response must
+//                match the result of running the same request directly.
+//                Malformed frames must give an error response and stop
+//                the reading of requests.
+//
+// Usage:         bin/test-server tests/files/*.krn
+//
+
+#include "humlib.h"
+#include "../TestCheck.h"
+
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace hum;
+using namespace std;
+
+TestCheck Test("streams");
+
+
+//////////////////////////////
+//
+// serveRequests -- Send the requests through a server, and return the
+//     responses indexed by id.  The status of serve() is stored in status.
+//
+
+map<string, HumToolResponse> serveRequests(const string& frames, bool& status) {
+	HumToolServer server(2);
+	server.setQueueSize(1);
+	stringstream input(frames);
+	stringstream output;
+	status = server.serve(input, output);
+
+	map<string, HumToolResponse> responses;
+	HumToolResponse response;
+	string error;
+	while (HumToolServer::readResponse(output, response, error) > 0) {
+		responses[response.id] = response;
+	}
+	if (!error.empty()) {
+		Test.fail() << "cannot read response: " << error;
+	}
+	return responses;
+}
+
+
+
+//////////////////////////////
+//
+// isSameResponse -- True if the two responses have the same contents.
+//
+
+bool isSameResponse(const HumToolResponse& a, const HumToolResponse& b) {
+	return (a.status == b.status) && (a.humdrum == b.humdrum) && (a.json == b.json)
+			&& (a.text == b.text) && (a.warning == b.warning) && (a.error == b.error);
+}
+
+
+
+//////////////////////////////
+//
+// checkRoundTrip -- Send several requests for a file through the server,
+//     and compare each response with a direct run of the request.
+//
+
+void checkRoundTrip(const string& contents, const string& filename) {
+	vector<pair<string, string>> commands = {
+		{ "thru", "" }, { "transpose", "-t M2" }, { "transpose", "-t -m3" },
+		{ "extract", "-f 1" }, { "autobeam", "" }, { "recip", "" }
+	};
+	vector<HumToolRequest> requests;
+	stringstream frames;
+	for (int i=0; i<4; i++) {
+		for (auto& command : commands) {
+			HumToolRequest request;
+			request.id = to_string(requests.size());
+			request.tool = command.first;
+			request.options = command.second;
+			request.input = contents;
+			HumToolServer::writeRequest(frames, request);
+			requests.push_back(request);
+		}
+	}
+
+	Test.addCount();
+	bool status;
+	map<string, HumToolResponse> responses = serveRequests(frames.str(), status);
+	Test.check(status, "serve status", filename);
+	Test.check(responses.size() == requests.size(), "response count", filename);
+
+	HumToolServer server(1);
+	for (auto& request : requests) {
+		HumToolResponse expected;
+		server.run(request, expected);
+		auto found = responses.find(request.id);
+		if (found == responses.end()) {
+			continue;
+		}
+		if (!isSameResponse(found->second, expected)) {
+			Test.fail() << filename << ": response for \"" << request.tool << " "
+			     << request.options << "\" does not match a direct run" << endl;
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// checkMalformed -- A malformed request gives an error response, and
+//     the requests before it are still answered.
+//
+
+void checkMalformed(const string& label, const string& frame, const string& message) {
+	HumToolRequest request;
+	request.id = "1";
+	request.tool = "thru";
+	request.input = "**kern\n4c\n*-\n";
+	stringstream frames;
+	HumToolServer::writeRequest(frames, request);
+	frames << frame;
+
+	Test.addCount();
+	bool status;
+	map<string, HumToolResponse> responses = serveRequests(frames.str(), status);
+	Test.check(!status, "serve status", label);
+	if (responses.size() != 2) {
+		Test.fail() << label << ": " << responses.size() << " responses, expected 2" << endl;
+		return;
+	}
+	Test.check(responses["1"].status && (responses["1"].humdrum == "**kern\n*thru\n4c\n*-\n"),
+			"response before error", label);
+	// The id of the malformed request is not known if its header is invalid:
+	responses.erase("1");
+	HumToolResponse& response = responses.begin()->second;
+	Test.check(!response.status, "error status", label);
+	Test.check(response.error.find(message) != string::npos, "error message", label);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+	Options options;
+	options.process(argc, argv);
+
+	checkMalformed("header without colon", "id: 2\ntool thru\n\n", "Invalid header line");
+	checkMalformed("invalid length", "id: 2\ntool: thru\nlength: 1x\n\n", "Invalid length");
+	checkMalformed("short data", "id: 2\ntool: thru\nlength: 100\n\n**kern\n", "Input ended");
+	checkMalformed("missing tool", "id: 2\nlength: 0\n\n", "Missing tool");
+
+	for (int i=1; i<=options.getArgCount(); i++) {
+		HumdrumFile infile;
+		if (!infile.read(options.getArg(i))) {
+			cerr << "Cannot read " << options.getArg(i) << endl;
+			return 1;
+		}
+		stringstream contents;
+		contents << infile;
+		checkRoundTrip(contents.str(), options.getArg(i));
+	}
+
+	return Test.report();
+}
+
+
+
@@ -0,0 +1,159 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 18:10:14 PDT 2026
+// Last Modified: Sun Oct 18 23:59:58 PDT 2026
+// Filename:      tests/test-sink/test-sink.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/tests/test-sink/test-sink.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Check that tool output written to each type of
+//                HumOutputSink matches the output stored in the tool.
+//
+// Usage:         bin/test-sink tests/files/*.krn
+//
+
+#include "humlib.h"
+#include "../TestCheck.h"
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace hum;
+using namespace std;
+
+TestCheck Test("files");
+
+
+//////////////////////////////
+//
+// getToolOutput -- Run transpose on the file, and return either the
+//     text of the tool or the modified input file.
+//
+
+string getToolOutput(HumdrumFile& infile, Tool_transpose& tool, HumOutputSink* sink) {
+	tool.clearOutput();
+	tool.setOutputSink(sink);
+	tool.run(infile);
+	bool hasText = tool.hasAnyText();
+	tool.clearOutputSinks();
+	if (sink) {
+		if (!hasText) {
+			sink->writeFile(infile);
+			sink->flush();
+		}
+		return "";
+	}
+	stringstream output;
+	if (hasText) {
+		tool.getAllText(output);
+	} else {
+		output << infile;
+	}
+	return output.str();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+	Options options;
+	options.process(argc, argv);
+
+	for (int i=1; i<=options.getArgCount(); i++) {
+		string filename = options.getArg(i);
+		Test.addCount();
+		Tool_transpose tool;
+		vector<string> args = { "transpose", "-k", "e-" };
+		tool.process(args);
+
+		HumdrumFile original;
+		if (!original.read(filename)) {
+			cerr << "Cannot read " << filename << endl;
+			return 1;
+		}
+		stringstream contents;
+		contents << original;
+
+		HumdrumFile infile;
+		infile.readString(contents.str());
+		string expected = getToolOutput(infile, tool, NULL);
+
+		// Printing the stored text a second time gives the same result:
+		stringstream again;
+		tool.getAllText(again);
+		if (tool.hasAnyText()) {
+			Test.check(again.str() == expected, "repeated getAllText", filename);
+		}
+
+		string output;
+		infile.readString(contents.str());
+		{
+			HumStringSink sink(output);
+			getToolOutput(infile, tool, &sink);
+		}
+		Test.check(output == expected, "HumStringSink", filename);
+
+		stringstream stream;
+		infile.readString(contents.str());
+		{
+			HumStreamSink sink(stream);
+			getToolOutput(infile, tool, &sink);
+		}
+		Test.check(stream.str() == expected, "HumStreamSink", filename);
+
+		output.clear();
+		infile.readString(contents.str());
+		{
+			HumCallbackSink sink([&output](const char* data, size_t size) {
+				output.append(data, size);
+				return true;
+			});
+			getToolOutput(infile, tool, &sink);
+		}
+		Test.check(output == expected, "HumCallbackSink", filename);
+
+		vector<char> buffer(expected.size() + 10);
+		infile.readString(contents.str());
+		{
+			HumBufferSink sink(buffer.data(), buffer.size());
+			getToolOutput(infile, tool, &sink);
+			Test.check(string(sink.getData(), sink.getSize()) == expected,
+					"HumBufferSink", filename);
+		}
+
+		// A buffer which is too small is reported:
+		if (expected.size() > 1) {
+			infile.readString(contents.str());
+			HumBufferSink sink(buffer.data(), expected.size() / 2);
+			getToolOutput(infile, tool, &sink);
+			Test.check(sink.isFailed(), "small HumBufferSink not failed", filename);
+		}
+
+		FILE* temp = tmpfile();
+		if (temp) {
+			infile.readString(contents.str());
+			{
+				HumFdSink sink(fileno(temp));
+				getToolOutput(infile, tool, &sink);
+			}
+			rewind(temp);
+			output.clear();
+			char block[4096];
+			size_t count;
+			while ((count = fread(block, 1, sizeof(block), temp)) > 0) {
+				output.append(block, count);
+			}
+			fclose(temp);
+			Test.check(output == expected, "HumFdSink", filename);
+		}
+	}
+
+	return Test.report();
+}
+
+
+
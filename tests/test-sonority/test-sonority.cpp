@@ -0,0 +1,148 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 18:45:08 PDT 2026
+// Last Modified: Sun Oct 18 23:59:58 PDT 2026
+// Filename:      tests/test-sonority/test-sonority.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/tests/test-sonority/test-sonority.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Check the sonority table against the pitches found by
+//                parsing the resolved tokens of each **kern spine on a line,
+//                and check that the table follows lines added to the file.
+//
+// Usage:         bin/test-sonority tests/files/*.krn
+//
+
+#include "humlib.h"
+#include "../TestCheck.h"
+
+#include <iostream>
+#include <vector>
+
+using namespace hum;
+using namespace std;
+
+
+//////////////////////////////
+//
+// getExpectedPitches -- Return the base-40 pitches sounding on a line,
+//     with negative values for sustained notes.  Null tokens are resolved
+//     with the null-token resolution table (checked by test-nulltable).
+//
+
+vector<int> getExpectedPitches(HumdrumFile& infile, int line) {
+	vector<int> output;
+	if (!infile[line].isData()) {
+		return output;
+	}
+	for (int j=0; j<infile[line].getFieldCount(); j++) {
+		HTp token = infile.token(line, j);
+		if (!token->isKern()) {
+			continue;
+		}
+		HTp resolved = infile.getResolvedToken(line, j);
+		if (!resolved) {
+			continue;
+		}
+		bool sustainQ = (resolved != token);
+		token = resolved;
+		for (int k=0; k<token->getSubtokenCount(); k++) {
+			string subtok = token->getSubtoken(k);
+			if (subtok.find('r') != string::npos) {
+				continue;
+			}
+			int base40 = Convert::kernToBase40(subtok);
+			if (base40 < 0) {
+				continue;
+			}
+			bool tiedQ = (subtok.find('_') != string::npos) ||
+					(subtok.find(']') != string::npos);
+			output.push_back((sustainQ || tiedQ) ? -base40 : base40);
+		}
+	}
+	return output;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+	Options options;
+	options.process(argc, argv);
+
+	TestCheck test("sonorities");
+	for (int a=1; a<=options.getArgCount(); a++) {
+		HumdrumFile infile;
+		if (!infile.read(options.getArg(a))) {
+			cerr << "Cannot read " << options.getArg(a) << endl;
+			return 1;
+		}
+		int slices = 0;
+		for (HumSonority slice : infile.getSonorities()) {
+			int i = slice.getLineIndex();
+			slices++;
+			vector<int> pitches;
+			uint64_t pcs = 0;
+			uint64_t attacks = 0;
+			for (int k=0; k<slice.getNoteCount(); k++) {
+				int base40 = slice.getBase40(k);
+				pitches.push_back(slice.isAttack(k) ? base40 : -base40);
+				pcs |= (uint64_t)1 << (base40 % 40);
+				if (slice.isAttack(k)) {
+					attacks |= (uint64_t)1 << (base40 % 40);
+				}
+			}
+			test.addCount();
+			int lowest = slice.getLowestIndex();
+			bool lowestQ = true;
+			for (int k=0; k<slice.getNoteCount(); k++) {
+				if (slice.getMidiPitch(k) < slice.getMidiPitch(lowest)) {
+					lowestQ = false;
+				}
+			}
+			if ((pitches != getExpectedPitches(infile, i)) ||
+					(pcs != slice.getPitchClassSet()) ||
+					(attacks != slice.getAttackPitchClassSet()) ||
+					(slice.getNoteCount() && !lowestQ)) {
+				test.fail() << options.getArg(a) << " line " << i + 1
+				     << ": " << infile[i] << endl;
+			}
+		}
+		int datalines = 0;
+		for (int i=0; i<infile.getLineCount(); i++) {
+			if (infile[i].isData()) {
+				datalines++;
+			} else if (!infile.getSonority(i).isEmpty()) {
+				test.fail() << options.getArg(a) << " line " << i + 1
+				     << " is not data" << endl;
+			}
+		}
+		if (datalines != slices) {
+			test.fail() << options.getArg(a) << " has " << slices
+			     << " slices for " << datalines << " data lines" << endl;
+		}
+
+		// The table is recalculated after a line is added:
+		vector<int> counts;
+		for (int i=0; i<infile.getLineCount(); i++) {
+			counts.push_back(infile.getSonority(i).getNoteCount());
+		}
+		infile.insertLine(0, "!! added line");
+		test.check(infile.getSonorities().getLineCount() == infile.getLineCount(),
+				"line count after insertLine", options.getArg(a));
+		for (int i=0; i<(int)counts.size(); i++) {
+			if (infile.getSonority(i + 1).getNoteCount() != counts[i]) {
+				test.fail() << options.getArg(a) << " line " << i + 1
+				     << " after insertLine" << endl;
+				break;
+			}
+		}
+	}
+
+	return test.report();
+}
+
+
+
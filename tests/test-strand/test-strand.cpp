@@ -0,0 +1,83 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 22:00:12 PDT 2026
+// Last Modified: Sun Oct 18 23:59:58 PDT 2026
+// Filename:      tests/test-strand/test-strand.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/tests/test-strand/test-strand.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Check the strand table against the tokens found by
+//                following getNextToken() from the start to the end of
+//                each strand.
+//
+// Usage:         bin/test-strand tests/files/*.krn
+//
+
+#include "humlib.h"
+#include "../TestCheck.h"
+
+#include <iostream>
+
+using namespace hum;
+using namespace std;
+
+TestCheck Test("tokens");
+
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+	Options options;
+	options.process(argc, argv);
+
+	for (int a=1; a<=options.getArgCount(); a++) {
+		string filename = options.getArg(a);
+		HumdrumFile infile;
+		if (!infile.read(filename)) {
+			cerr << "Cannot read " << filename << endl;
+			return 1;
+		}
+		const HumStrandTable& strands = infile.getStrandTable();
+		Test.check(strands.getStrandCount() == infile.getStrandCount(), "strand count", filename);
+		Test.check(strands.getLineCount() == infile.getLineCount(), "line count", filename);
+
+		int total = 0;
+		int strand = 0;
+		for (int s=0; s<infile.getSpineCount(); s++) {
+			for (int k=0; k<infile.getStrandCount(s); k++, strand++) {
+				Test.check(strands.getStrandSpine(strand) == s, "spine", filename);
+				Test.check(strands.getStrandOffset(strand) == total, "offset", filename);
+				HTp current = infile.getStrandStart(strand);
+				HTp send = infile.getStrandEnd(strand);
+				Test.check(strands.getStrandTrack(strand) == current->getTrack(), "track", filename);
+				int entry = strands.getStrandOffset(strand);
+				int size = 0;
+				while (current) {
+					Test.check(strands.getToken(entry) == current, "token", filename);
+					Test.check(strands.getLine(entry) == current->getLineIndex(), "line", filename);
+					Test.check(strands.getField(entry) == current->getFieldIndex(), "field", filename);
+					Test.check(strands.getStartTime(entry) == current->getDurationFromStart(), "start time", filename);
+					Test.check(strands.isData(entry) == current->isData(), "data", filename);
+					Test.check(strands.isNull(entry) == (current->isData() && current->isNull()), "null", filename);
+					Test.check(strands.getStropheStart(strands.getStrophe(entry)) == current->getStrophe(), "strophe", filename);
+					Test.addCount();
+					entry++;
+					size++;
+					if (current == send) {
+						break;
+					}
+					current = current->getNextToken();
+				}
+				Test.check(strands.getStrandSize(strand) == size, "size", filename);
+				total += size;
+			}
+		}
+		Test.check(strands.getEntryCount() == total, "entry count", filename);
+	}
+
+	return Test.report();
+}
+
+
+
@@ -0,0 +1,256 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 21:40:05 PDT 2026
+// Last Modified: Sun Oct 18 23:59:58 PDT 2026
+// Filename:      tests/test-text/test-text.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/tests/test-text/test-text.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Check the text table against words and melismas found by
+//                walking each lyric spine, and check that the text index
+//                finds every word and phrase of the files, is unchanged when
+//                written and read back, and is the same when built in parts
+//                and appended.
+//
+// Usage:         bin/test-text tests/files/*.krn
+//
+
+#include "humlib.h"
+#include "../TestCheck.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace hum;
+using namespace std;
+
+TestCheck Test("words");
+
+
+//////////////////////////////
+//
+// getExpectedWords -- Assemble the words of a lyric spine in the same way
+//     as Tool_msearch did before it used the text table.
+//
+
+void getExpectedWords(HTp start, vector<string>& words, vector<HTp>& tokens) {
+	words.clear();
+	tokens.clear();
+	for (HTp tok = start->getNextToken(); tok; tok = tok->getNextToken()) {
+		if (tok->empty() || tok->isNull() || !tok->isData()) {
+			continue;
+		}
+		string text = *tok;
+		if ((text[0] == '-') && !words.empty()) {
+			words.back() += text.substr(1);
+		} else {
+			if (text[0] == '-') {
+				text = text.substr(1);
+			}
+			words.push_back(text);
+			tokens.push_back(tok);
+		}
+		if ((!words.back().empty()) && (words.back().back() == '-')) {
+			words.back().pop_back();
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// getExpectedNotes -- Count the notes of a syllable in the same way as
+//     Tool_melisma did before it used the text table (but ending the last
+//     syllable of a spine at the end of the spine, as Tool_textdur did).
+//
+
+int getExpectedNotes(HTp token, int endline, HumNum& endtime) {
+	endtime = token->getDurationFromStart();
+	HTp current = token->getPreviousFieldToken();
+	while (current && !current->isKern()) {
+		current = current->getPreviousFieldToken();
+	}
+	int output = 0;
+	while (current) {
+		if (!current->isData() || current->isNull() || current->isRest()) {
+			current = current->getNextToken();
+			continue;
+		}
+		if (!current->isNoteAttack()) {
+			endtime = current->getDurationFromStart() + current->getDuration();
+			current = current->getNextToken();
+			continue;
+		}
+		if (current->getLineIndex() >= endline) {
+			break;
+		}
+		endtime = current->getDurationFromStart() + current->getDuration();
+		output++;
+		current = current->getNextToken();
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// hasPosting -- Return true if a list of postings contains the given file
+//     and token position.
+//
+
+bool hasPosting(const vector<HumTextPosting>* postings, int file, HTp token) {
+	if (!postings) {
+		return false;
+	}
+	for (const HumTextPosting& p : *postings) {
+		if ((p.file == file) && (p.line == token->getLineIndex()) &&
+				(p.field == token->getFieldIndex())) {
+			return true;
+		}
+	}
+	return false;
+}
+
+
+
+//////////////////////////////
+//
+// getText -- Return the text form of an index.
+//
+
+string getText(HumTextIndex& index) {
+	stringstream output;
+	index.write(output);
+	return output.str();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+	Options options;
+	options.process(argc, argv);
+
+	int count = options.getArgCount();
+	vector<HumdrumFile> infiles(count);
+	HumTextIndex index;
+	HumTextIndex first;
+	HumTextIndex second;
+	for (int a=0; a<count; a++) {
+		string filename = options.getArg(a + 1);
+		HumdrumFile& infile = infiles[a];
+		if (!infile.read(filename)) {
+			cerr << "Cannot read " << filename << endl;
+			return 1;
+		}
+		const HumTextTable& table = infile.getTextTable();
+		index.addFile(infile, filename);
+		if (a < count / 2) {
+			first.addFile(infile, filename);
+		} else {
+			second.addFile(infile, filename);
+		}
+
+		// One spine in the table for each lyric spine:
+		vector<HTp> starts;
+		infile.getSpineStartList(starts);
+		int spine = 0;
+		for (int i=0; i<(int)starts.size(); i++) {
+			if (!(starts[i]->isDataType("**text") || starts[i]->isDataType("**silbe") ||
+					starts[i]->isDataType("**sylb") || starts[i]->isDataType("**sylba"))) {
+				continue;
+			}
+			if (table.getSpineStart(spine) != starts[i]) {
+				Test.fail() << "spine start on " << filename << endl;
+				break;
+			}
+
+			vector<string> expected;
+			vector<HTp> tokens;
+			getExpectedWords(starts[i], expected, tokens);
+			int wstart = table.getSpineWordStart(spine);
+			Test.check((int)expected.size() == table.getSpineWordCount(spine), "word count", filename);
+			for (int j=0; j<(int)expected.size() && j<table.getSpineWordCount(spine); j++) {
+				int w = wstart + j;
+				Test.addCount();
+				Test.check(table.getWordText(w) == expected[j], "word text", filename);
+				Test.check(table.getWordToken(w) == tokens[j], "word token", filename);
+				int notes = 0;
+				int sstart = table.getWordSyllableStart(w);
+				for (int k=sstart; k<sstart+table.getWordSyllableCount(w); k++) {
+					Test.check(table.getSyllableWord(k) == w, "syllable word", filename);
+					notes += table.getNoteCount(k);
+				}
+				Test.check(notes == table.getWordNoteCount(w), "word notes", filename);
+
+				// Each part of the word is in the index:
+				stringstream parts(table.getNormalizedWord(w));
+				string part;
+				while (parts >> part) {
+					Test.check(hasPosting(index.find(part), a, tokens[j]), "index " + part, filename);
+				}
+
+				// Two-word phrases are found:
+				if ((j > 0) && !table.getNormalizedWord(w - 1).empty() &&
+						!table.getNormalizedWord(w).empty()) {
+					vector<HumTextPosting> matches;
+					string phrase = table.getNormalizedWord(w - 1) + " " + table.getNormalizedWord(w);
+					index.search(matches, phrase);
+					bool found = false;
+					for (HumTextPosting& p : matches) {
+						if ((p.file == a) && (p.line == tokens[j-1]->getLineIndex()) &&
+								(p.field == tokens[j-1]->getFieldIndex())) {
+							found = true;
+						}
+					}
+					Test.check(found, "phrase " + phrase, filename);
+				}
+			}
+
+			// Melismas of the syllables, which end at the next syllable or
+			// at the end of the spine:
+			HTp ending = starts[i];
+			while (ending->getNextToken()) {
+				ending = ending->getNextToken();
+			}
+			int sstart = table.getSpineSyllableStart(spine);
+			int scount = table.getSpineSyllableCount(spine);
+			for (int k=sstart; k<sstart+scount; k++) {
+				int endline = ending->getLineIndex();
+				if (k < sstart + scount - 1) {
+					endline = table.getSyllableToken(k + 1)->getLineIndex();
+				}
+				HumNum endtime;
+				int notes = getExpectedNotes(table.getSyllableToken(k), endline, endtime);
+				Test.check(table.getNoteCount(k) == notes, "melisma", filename);
+				Test.check(table.getEndTime(k) == endtime, "end time", filename);
+			}
+			spine++;
+		}
+		Test.check(spine == table.getSpineCount(), "spine count", filename);
+	}
+
+	// Index written and read back:
+	string text = getText(index);
+	stringstream input(text);
+	HumTextIndex copy;
+	Test.check(copy.read(input), "read", "index");
+	Test.check(getText(copy) == text, "read contents", "index");
+	stringstream bad("!!!HUMTEXTINDEX: 1\nword\t0:1:2:3:4:5:6\n");
+	Test.check(!copy.read(bad), "bad file number", "index");
+
+	// Index built in two parts:
+	first.append(second);
+	Test.check(getText(first) == text, "appended index", "index");
+
+	return Test.report();
+}
+
+
+
@@ -0,0 +1,347 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 18:02:31 PDT 2026
+// Last Modified: Sun Oct 18 21:41:30 PDT 2026
+// Filename:      tests/test-threads/test-threads.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/tests/test-threads/test-threads.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Stress test for running tools concurrently.  A set of
+//                tool commands is run on each input file serially, and then
+//                all of the (command, file) pairs are run again many times
+//                on several threads at once, in a different order for each
+//                thread.  Each thread reads its own copy of the input files
+//                and uses its own tool objects, so the output of every
+//                concurrent run must match the output of the serial run.
+//
+// Usage:         make threadtest
+//                bin/test-threads -t 8 -r 4 tests/files/*.krn
+//                bin/test-threads -T imitation
+//
+
+#include "humlib.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace hum;
+using namespace std;
+
+
+//////////////////////////////
+//
+// ThreadInput -- Input file for the test.
+//
+
+class ThreadInput {
+	public:
+		string name;
+		string contents;
+};
+
+
+//////////////////////////////
+//
+// ThreadJob -- A tool command to run on an input file, along with the
+//     output from the serial run.
+//
+
+class ThreadJob {
+	public:
+		int    input = 0;
+		string tool;
+		string options;
+		string expected;
+};
+
+
+// Commands which are run on every input file.  The tools which had shared
+// state between instances are included (imitation, deg, cmr, tandeminfo,
+// prange, thru) as well as a selection of commonly used tools.
+
+static const vector<pair<string, string>> Commands = {
+	{ "autobeam",    ""                   },
+	{ "autostem",    ""                   },
+	{ "chord",       ""                   },
+	{ "cint",        ""                   },
+	{ "cmr",         ""                   },
+	{ "cmr",         "--syncopation-weight 2 --leap-weight 3 -r" },
+	{ "deg",         ""                   },
+	{ "deg",         "-t -z -o"           },
+	{ "deg",         "--forced-key c:"    },
+	{ "extract",     "-f 1"               },
+	{ "extract",     "-i kern -r"         },
+	{ "hproof",      ""                   },
+	{ "humsheet",    ""                   },
+	{ "imitation",   ""                   },
+	{ "imitation",   "-t 2 -m"            },
+	{ "melisma",     "-w"                 },
+	{ "meter",       ""                   },
+	{ "metlev",      ""                   },
+	{ "msearch",     "-p cde"             },
+	{ "msearch",     "-t la"              },
+	{ "myank",       "-m 1-2"             },
+	{ "pnum",        ""                   },
+	{ "prange",      ""                   },
+	{ "prange",      "-r c4:c5"           },
+	{ "recip",       ""                   },
+	{ "rid",         "-GLId"              },
+	{ "semitones",   ""                   },
+	{ "shed",        "-e s/4/8/g -x kern" },
+	{ "synco",       ""                   },
+	{ "tandeminfo",  ""                   },
+	{ "textdur",     ""                   },
+	{ "textdur",     "-m"                 },
+	{ "thru",        ""                   },
+	{ "thru",        "-v long"            },
+	{ "tie",         "-s"                 },
+	{ "timebase",    "-t 8"               },
+	{ "transpose",   "-k e-"              },
+	{ "transpose",   "-b 3"               },
+	{ "vcross",      ""                   }
+};
+
+
+// Score used when no input files are given.  It contains key and meter
+// changes, imitation between the voices, ties, slurs, rests, chords,
+// instruments, expansion labels and lyrics.
+
+static const string DefaultScore = R"(!!!COM: Test
+!!!OTL: Thread test
+**kern	**text	**kern	**text
+*ICklav	*	*Ivox	*
+*>[A,A,B]	*>[A,A,B]	*>[A,A,B]	*>[A,A,B]
+*>long[A,A,B,B]	*>long[A,A,B,B]	*>long[A,A,B,B]	*>long[A,A,B,B]
+*>A	*>A	*>A	*>A
+*clefF4	*	*clefG2	*
+*k[b-]	*	*k[b-]	*
+*F:	*	*F:	*
+*M4/4	*	*M4/4	*
+=1	=1	=1	=1
+2F	la	4r	.
+.	.	4f	la
+4G	la	4g	la
+4A	-ment	4a	la
+=2	=2	=2	=2
+4B-(	O	2b-(	-ment
+4A	.	.	.
+4G)	.	4a	O
+4F	a-	4g)	.
+=3	=3	=3	=3
+2C	-men	4f	a-
+.	.	4e	.
+4r	.	2f	-men
+4c	.	.	.
+*>B	*>B	*>B	*>B
+*k[]	*	*k[]	*
+*a:	*	*a:	*
+*M3/4	*	*M3/4	*
+=4	=4	=4	=4
+4A[	do	4.cc	do
+4A]	.	.	.
+.	.	8b	.
+4G#	re	4a	re
+=5	=5	=5	=5
+4E	mi	2e	mi
+4C	fa	.	.
+4D	sol	(4dd	sol
+=6	=6	=6	=6
+2.A; (AA E	la	2.cc#;)	la
+==	==	==	==
+*-	*-	*-	*-
+)";
+
+
+
+//////////////////////////////
+//
+// NullStreamBuf -- Discard anything that the tools print directly to cout.
+//
+
+class NullStreamBuf : public streambuf {
+	protected:
+		int overflow(int ch) {
+			return traits_type::not_eof(ch);
+		}
+};
+
+
+
+//////////////////////////////
+//
+// readInput -- Read an input file into a string.
+//
+
+bool readInput(const string& filename, ThreadInput& input) {
+	ifstream infile(filename, ios::binary);
+	if (!infile.is_open()) {
+		return false;
+	}
+	stringstream contents;
+	contents << infile.rdbuf();
+	input.name = filename;
+	input.contents = contents.str();
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// runJob -- Run a tool command on an input file.  The HumToolServer keeps
+//     a separate set of tool objects for each thread, and the input is
+//     parsed into a new HumdrumFile for each run.
+//
+
+string runJob(HumToolServer& server, const ThreadJob& job,
+		const vector<ThreadInput>& inputs) {
+	HumToolRequest request;
+	request.tool    = job.tool;
+	request.options = job.options;
+	request.input   = inputs[job.input].contents;
+	HumToolResponse response;
+	server.run(request, response);
+	string output;
+	output += response.status ? "ok\n" : "error\n";
+	output += response.humdrum;
+	output += response.json;
+	output += response.text;
+	output += response.warning;
+	output += response.error;
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// printMismatch -- Show where the output of a concurrent run differs from
+//     the serial run.
+//
+
+void printMismatch(const ThreadJob& job, const vector<ThreadInput>& inputs,
+		const string& output) {
+	cerr << "MISMATCH: " << job.tool << " " << job.options << " on "
+	     << inputs[job.input].name << endl;
+	size_t index = 0;
+	while ((index < output.size()) && (index < job.expected.size())
+			&& (output[index] == job.expected[index])) {
+		index++;
+	}
+	cerr << "\tfirst difference at character " << index << endl;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+	Options options;
+	options.define("t|threads=i:8", "number of concurrent threads");
+	options.define("r|rounds=i:4", "number of times each thread runs all jobs");
+	options.define("s|seed=i:1", "random number seed for the job orders");
+	options.define("T|tool=s", "only run the commands for the given tool");
+	options.define("v|verbose=b", "print the serial output size of each job");
+	options.process(argc, argv);
+
+	int threadCount = options.getInteger("threads");
+	int rounds = options.getInteger("rounds");
+	if (threadCount < 1) {
+		threadCount = 1;
+	}
+	if (rounds < 1) {
+		rounds = 1;
+	}
+
+	vector<ThreadInput> inputs;
+	if (options.getArgCount() == 0) {
+		ThreadInput input;
+		input.name = "default score";
+		input.contents = DefaultScore;
+		inputs.push_back(input);
+	}
+	for (int i=1; i<=options.getArgCount(); i++) {
+		ThreadInput input;
+		if (!readInput(options.getArg(i), input)) {
+			cerr << "Cannot read " << options.getArg(i) << endl;
+			return 1;
+		}
+		inputs.push_back(input);
+	}
+
+	// Some tools print directly to cout, which is not part of the response:
+	ostream output(cout.rdbuf());
+	NullStreamBuf nullbuf;
+	cout.rdbuf(&nullbuf);
+
+	// Serial run to get the expected output of each job:
+	vector<ThreadJob> jobs;
+	HumToolServer server;
+	for (int i=0; i<(int)inputs.size(); i++) {
+		for (const auto& command : Commands) {
+			if (options.getBoolean("tool") && (command.first != options.getString("tool"))) {
+				continue;
+			}
+			ThreadJob job;
+			job.input   = i;
+			job.tool    = command.first;
+			job.options = command.second;
+			job.expected = runJob(server, job, inputs);
+			if (options.getBoolean("verbose")) {
+				cerr << job.tool << " " << job.options << " on " << inputs[i].name
+				     << ": " << job.expected.size() << " bytes" << endl;
+			}
+			jobs.push_back(job);
+		}
+	}
+
+	// Concurrent runs:
+	atomic<int> runs(0);
+	atomic<int> mismatches(0);
+	mutex printMutex;
+	vector<thread> threads;
+	for (int t=0; t<threadCount; t++) {
+		unsigned seed = options.getInteger("seed") + t;
+		threads.emplace_back([&, seed](void) {
+			vector<int> order(jobs.size());
+			for (int i=0; i<(int)order.size(); i++) {
+				order[i] = i;
+			}
+			mt19937 generator(seed);
+			for (int r=0; r<rounds; r++) {
+				shuffle(order.begin(), order.end(), generator);
+				for (int i=0; i<(int)order.size(); i++) {
+					const ThreadJob& job = jobs[order[i]];
+					string output = runJob(server, job, inputs);
+					runs++;
+					if (output != job.expected) {
+						mismatches++;
+						lock_guard<mutex> lock(printMutex);
+						printMismatch(job, inputs, output);
+					}
+				}
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	output << (mismatches ? "FAILED" : "PASSED") << ": " << runs << " runs of "
+	       << jobs.size() << " jobs on " << threadCount << " threads, "
+	       << mismatches << " mismatches" << endl;
+	cout.rdbuf(output.rdbuf());
+	return mismatches ? 1 : 0;
+}
+
+
+